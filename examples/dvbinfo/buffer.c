@@ -35,19 +35,48 @@
 #include <sys/types.h>
 #include <assert.h>
 
+#if defined(HAVE_LINUX_FUTEX_H)
+#   include <unistd.h>
+#   include <sys/syscall.h>
+#   include <linux/futex.h>
+#endif
+
 typedef int64_t mtime_t;
 
 #include "buffer.h"
 
-struct fifo_s
+#define RING_CACHE_LINE 64
+#define RING_BATCH      8   /* buffers queued before the producer publishes */
+
+struct ring_s
 {
+    /* read-only after ring_new() */
+    buffer_t  *p_slots;     /* i_mask + 1 buffer headers */
+    uint8_t   *p_data;      /* i_mask + 1 buffers of i_size bytes */
+    uint32_t   i_mask;
+    size_t     i_size;
+
+    /* producer */
+    uint8_t    pad0[RING_CACHE_LINE];
+    uint32_t   i_head;      /* published write index */
+    uint32_t   i_write;     /* next write index, >= i_head */
+    uint32_t   i_tail_cache;
+    uint32_t   i_write_seq; /* futex word the producer sleeps on */
+    uint32_t   b_write_wait;
+
+    /* consumer */
+    uint8_t    pad1[RING_CACHE_LINE];
+    uint32_t   i_tail;      /* read index */
+    uint32_t   i_head_cache;
+    uint32_t   i_read_seq;  /* futex word the consumer sleeps on */
+    uint32_t   b_read_wait;
+
+    uint8_t    pad2[RING_CACHE_LINE];
+    uint32_t   b_closed;
+#if !defined(HAVE_LINUX_FUTEX_H)
     pthread_mutex_t lock;
     pthread_cond_t  wait;
-    bool       b_force_wake;
-    ssize_t    i_count;
-    size_t     i_size; /* fifo size in bytes */
-    buffer_t  *p_first;
-    buffer_t **pp_last;
+#endif
 };
 
 /* */
@@ -57,6 +86,7 @@ buffer_t *buffer_new(size_t i_size)
     if (buffer == NULL) return NULL;
     buffer->i_size = i_size;
     buffer->i_date = 0;
+    buffer->i_arrival = 0;
     buffer->p_next = NULL;
     buffer->p_data = (uint8_t*)((uint8_t *)buffer + sizeof(buffer_t));
     return buffer;
@@ -68,133 +98,219 @@ void buffer_free(buffer_t *buffer)
     buffer = NULL;
 }
 
-/* Fifo */
-fifo_t *fifo_new(void)
+/* Ring */
+static inline uint32_t ring_load(const uint32_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void ring_store(uint32_t *p, uint32_t i_value)
 {
-    fifo_t *fifo = (fifo_t *) malloc(sizeof(fifo_t));
-    if (fifo == NULL) return NULL;
+    __atomic_store_n(p, i_value, __ATOMIC_RELEASE);
+}
 
-    fifo->i_count = 0;
-    fifo->i_size = 0;
-    fifo->b_force_wake = false;
-    fifo->p_first = NULL;
-    fifo->pp_last = &fifo->p_first;
-    pthread_mutex_init(&fifo->lock, NULL);
-    pthread_cond_init(&fifo->wait, NULL);
-    return fifo;
+/* Block while *p_seq == i_seq, the waker changes *p_seq before ring_wake() */
+static void ring_wait(ring_t *ring, uint32_t *p_seq, uint32_t i_seq)
+{
+#if defined(HAVE_LINUX_FUTEX_H)
+    (void)ring;
+    syscall(SYS_futex, p_seq, FUTEX_WAIT_PRIVATE, i_seq, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&ring->lock);
+    while (__atomic_load_n(p_seq, __ATOMIC_SEQ_CST) == i_seq)
+        pthread_cond_wait(&ring->wait, &ring->lock);
+    pthread_mutex_unlock(&ring->lock);
+#endif
 }
 
-void fifo_free(fifo_t *fifo)
+static void ring_wake(ring_t *ring, uint32_t *p_seq)
 {
-    if (fifo == NULL)
-        return;
+    __atomic_add_fetch(p_seq, 1, __ATOMIC_SEQ_CST);
+#if defined(HAVE_LINUX_FUTEX_H)
+    (void)ring;
+    syscall(SYS_futex, p_seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->wait);
+    pthread_mutex_unlock(&ring->lock);
+#endif
+}
 
-    pthread_mutex_lock(&fifo->lock);
-    buffer_t *p = fifo->p_first;
-    if (p != NULL)
+ring_t *ring_new(size_t i_count, size_t i_size)
+{
+    ring_t *ring = (ring_t *) calloc(1, sizeof(ring_t));
+    if (ring == NULL) return NULL;
+
+    /* power of two, so indices can wrap freely */
+    size_t i_slots = 2;
+    while ((i_slots < i_count) && (i_slots < (1u << 31)))
+        i_slots <<= 1;
+
+    ring->i_mask = (uint32_t)(i_slots - 1);
+    ring->i_size = i_size;
+    ring->p_slots = (buffer_t *) calloc(i_slots, sizeof(buffer_t));
+    /* Untouched pages of a large allocation are not committed, so memory
+     * use grows with the ring depth actually reached. */
+    ring->p_data = (uint8_t *) malloc(i_slots * i_size);
+    if ((ring->p_slots == NULL) || (ring->p_data == NULL))
     {
-        fifo->i_count = 0;
-        fifo->p_first = NULL;
-        fifo->pp_last = &fifo->p_first;
+        free(ring->p_slots);
+        free(ring->p_data);
+        free(ring);
+        return NULL;
     }
-    pthread_mutex_unlock(&fifo->lock);
 
-    while (p != NULL)
+    for (size_t i = 0; i < i_slots; i++)
     {
-        buffer_t *buffer;
-
-        buffer = p->p_next;
-        buffer_free(p);
-        p = buffer;
+        ring->p_slots[i].i_size = i_size;
+        ring->p_slots[i].p_data = ring->p_data + i * i_size;
     }
-
-    pthread_cond_destroy(&fifo->wait);
-    pthread_mutex_destroy(&fifo->lock);
-
-    free(fifo);
-    fifo = NULL;
+#if !defined(HAVE_LINUX_FUTEX_H)
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->wait, NULL);
+#endif
+    return ring;
 }
 
-void fifo_wake(fifo_t *fifo)
+void ring_free(ring_t *ring)
 {
-    pthread_mutex_lock(&fifo->lock);
-    if (fifo->p_first == NULL)
-        fifo->b_force_wake = true;
-    pthread_cond_broadcast(&fifo->wait);
-    pthread_mutex_unlock(&fifo->lock);
-}
+    if (ring == NULL)
+        return;
 
-ssize_t fifo_count(fifo_t *fifo)
-{
-    pthread_mutex_lock(&fifo->lock);
-    ssize_t count = fifo->i_count;
-    pthread_mutex_unlock(&fifo->lock);
-    return count;
+#if !defined(HAVE_LINUX_FUTEX_H)
+    pthread_cond_destroy(&ring->wait);
+    pthread_mutex_destroy(&ring->lock);
+#endif
+    free(ring->p_slots);
+    free(ring->p_data);
+    free(ring);
+    ring = NULL;
 }
 
-size_t fifo_size(fifo_t *fifo)
+size_t ring_count(ring_t *ring)
 {
-    pthread_mutex_lock(&fifo->lock);
-    size_t size = fifo->i_size;
-    pthread_mutex_unlock(&fifo->lock);
-    return size;
+    return ring_load(&ring->i_head) - ring_load(&ring->i_tail);
 }
 
-void fifo_push(fifo_t *fifo, buffer_t *buffer)
+unsigned int ring_acquire_batch(ring_t *ring, buffer_t **pp_buffers,
+                                unsigned int i_count, bool b_wait)
 {
-    buffer_t *p_last;
-    size_t i_depth = 0;
+    uint32_t i_free;
 
-    if (buffer == NULL)
-        return;
+    for (;;)
+    {
+        if (ring_load(&ring->b_closed))
+            return 0;
+
+        i_free = ring->i_mask + 1 - (ring->i_write - ring->i_tail_cache);
+        if (i_free > 0)
+            break;
+        ring->i_tail_cache = ring_load(&ring->i_tail);
+        i_free = ring->i_mask + 1 - (ring->i_write - ring->i_tail_cache);
+        if (i_free > 0)
+            break;
+
+        /* full: make queued buffers visible before giving up or sleeping */
+        ring_flush(ring);
+        if (!b_wait)
+            return 0;
+
+        uint32_t i_seq = __atomic_load_n(&ring->i_write_seq, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&ring->b_write_wait, 1, __ATOMIC_SEQ_CST);
+        if ((ring->i_write - __atomic_load_n(&ring->i_tail, __ATOMIC_SEQ_CST) > ring->i_mask) &&
+            !__atomic_load_n(&ring->b_closed, __ATOMIC_SEQ_CST))
+            ring_wait(ring, &ring->i_write_seq, i_seq);
+        __atomic_store_n(&ring->b_write_wait, 0, __ATOMIC_RELAXED);
+    }
 
-    pthread_mutex_lock(&fifo->lock);
-    for (p_last = buffer; ; p_last = p_last->p_next)
+    if (i_count > i_free)
+        i_count = i_free;
+    for (unsigned int i = 0; i < i_count; i++)
     {
-         i_depth ++;
-         if (!p_last->p_next)
-             break;
+        buffer_t *buffer = &ring->p_slots[(ring->i_write + i) & ring->i_mask];
+        buffer->i_size = ring->i_size;
+        buffer->i_date = 0;
+        buffer->i_arrival = 0;
+        pp_buffers[i] = buffer;
     }
+    return i_count;
+}
 
-    *fifo->pp_last = buffer;
-    fifo->pp_last = &p_last->p_next;
-    fifo->i_count += i_depth;
-    fifo->i_size += buffer->i_size;
+buffer_t *ring_acquire(ring_t *ring, bool b_wait)
+{
+    buffer_t *buffer;
+    if (ring_acquire_batch(ring, &buffer, 1, b_wait) == 0)
+        return NULL;
+    return buffer;
+}
 
-    assert(fifo->p_first != NULL);
-    assert(fifo->pp_last  != NULL);
+void ring_flush(ring_t *ring)
+{
+    if (ring->i_head == ring->i_write)
+        return;
 
-    pthread_cond_signal(&fifo->wait);
-    pthread_mutex_unlock(&fifo->lock);
+    __atomic_store_n(&ring->i_head, ring->i_write, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->b_read_wait, __ATOMIC_SEQ_CST))
+        ring_wake(ring, &ring->i_read_seq);
 }
 
-buffer_t *fifo_pop(fifo_t *fifo)
+void ring_push_batch(ring_t *ring, unsigned int i_count)
 {
-    buffer_t *buffer;
+    assert(ring->i_write + i_count - ring->i_tail_cache <= ring->i_mask + 1);
 
-    pthread_mutex_lock(&fifo->lock);
+    ring->i_write += i_count;
+    if ((ring->i_write - ring->i_head >= RING_BATCH) ||
+        __atomic_load_n(&ring->b_read_wait, __ATOMIC_SEQ_CST))
+        ring_flush(ring);
+}
 
-    while ((fifo->p_first == NULL) && !fifo->b_force_wake)
-        pthread_cond_wait(&fifo->wait, &fifo->lock);
+void ring_push(ring_t *ring)
+{
+    ring_push_batch(ring, 1);
+}
 
-    buffer = fifo->p_first;
-    fifo->b_force_wake = false;
-    if (buffer == NULL)
+buffer_t *ring_pop(ring_t *ring)
+{
+    for (;;)
     {
-        pthread_mutex_unlock(&fifo->lock);
-        return NULL;
+        if (ring->i_head_cache != ring->i_tail)
+            break;
+        ring->i_head_cache = ring_load(&ring->i_head);
+        if (ring->i_head_cache != ring->i_tail)
+            break;
+
+        uint32_t i_seq = __atomic_load_n(&ring->i_read_seq, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&ring->b_read_wait, 1, __ATOMIC_SEQ_CST);
+        ring->i_head_cache = __atomic_load_n(&ring->i_head, __ATOMIC_SEQ_CST);
+        if (ring->i_head_cache == ring->i_tail)
+        {
+            if (__atomic_load_n(&ring->b_closed, __ATOMIC_SEQ_CST))
+            {
+                /* the producer flushes before ring_close() */
+                ring->i_head_cache = ring_load(&ring->i_head);
+                __atomic_store_n(&ring->b_read_wait, 0, __ATOMIC_RELAXED);
+                if (ring->i_head_cache != ring->i_tail)
+                    break;
+                return NULL;
+            }
+            ring_wait(ring, &ring->i_read_seq, i_seq);
+        }
+        __atomic_store_n(&ring->b_read_wait, 0, __ATOMIC_RELAXED);
     }
 
-    fifo->p_first = buffer->p_next;
-    fifo->i_count--;
-    fifo->i_size -= buffer->i_size;
+    return &ring->p_slots[ring->i_tail & ring->i_mask];
+}
 
-    if (fifo->p_first == NULL)
-    {
-        fifo->pp_last = &fifo->p_first;
-    }
-    pthread_mutex_unlock(&fifo->lock);
+void ring_release(ring_t *ring)
+{
+    __atomic_store_n(&ring->i_tail, ring->i_tail + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->b_write_wait, __ATOMIC_SEQ_CST))
+        ring_wake(ring, &ring->i_write_seq);
+}
 
-    buffer->p_next = NULL;
-    return buffer;
+void ring_close(ring_t *ring)
+{
+    __atomic_store_n(&ring->b_closed, 1, __ATOMIC_SEQ_CST);
+    ring_wake(ring, &ring->i_read_seq);
+    ring_wake(ring, &ring->i_write_seq);
 }
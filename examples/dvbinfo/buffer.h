@@ -29,11 +29,12 @@ struct buffer_s
 {
     size_t   i_size;    /* size of buffer data */
     mtime_t  i_date;    /* timestamp */
+    int64_t  i_arrival; /* kernel arrival time in ns, 0 if unknown */
     buffer_t *p_next;   /* pointer to next buffer_t */
     uint8_t  *p_data;   /* actuall buffer data */
 };
 
-typedef struct fifo_s fifo_t;
+typedef struct ring_s ring_t;
 
 /* Buffer management:
  * buffer_new()  - create new buffer of size i_size + plus header structure
@@ -42,21 +43,42 @@ typedef struct fifo_s fifo_t;
 buffer_t *buffer_new(size_t i_size);
 void buffer_free(buffer_t *buffer);
 
-/* Fifo:
- * fifo_new()  - create a new fifo holding buffer_t pointers
- * fifo_free() - release fifo and all buffers contained therein
- * fifo_count()- number of buffers in fifo_t
- * fifo_size() - total size of buffers in fifo_t
- * fifo_push() - push buffer at end of fifo
- * fifo_pop()  - pop buffer from start of fifo
- * fifo_wake() - wake up fifo listeners
+/* Ring:
+ * Lock-free ring of preallocated buffers for exactly one producer thread
+ * and one consumer thread. Threads only block (futex on Linux) when the
+ * ring is full or empty. The producer publishes in batches; a consumer
+ * going to sleep forces the next ring_push() to publish immediately.
+ * A producer that is about to block outside the ring (a socket read) must
+ * call ring_flush() first, or the consumer may wait for buffers that were
+ * pushed but not yet published.
+ *
+ * ring_new()     - create a ring of at least i_count buffers of i_size bytes
+ * ring_free()    - release ring and all buffers contained therein
+ * ring_count()   - number of buffers published to the consumer
+ * ring_acquire() - producer: get the next free buffer, NULL when the ring
+ *                  is full and b_wait is false, or when the ring is closed
+ * ring_acquire_batch() - producer: get up to i_count consecutive free
+ *                  buffers, returns how many, 0 like ring_acquire() NULL
+ * ring_push()    - producer: queue the acquired buffer for the consumer
+ * ring_push_batch() - producer: queue the first i_count acquired buffers
+ * ring_flush()   - producer: publish all queued buffers now
+ * ring_pop()     - consumer: get the oldest buffer, waits while the ring is
+ *                  empty, NULL when the ring is closed and drained
+ * ring_release() - consumer: hand the popped buffer back to the producer
+ * ring_close()   - make both sides return NULL once drained, either thread
+ *                  may call it, the producer calls ring_flush() first
  */
-fifo_t *fifo_new(void);
-void fifo_free(fifo_t *fifo);
-ssize_t fifo_count(fifo_t *fifo);
-size_t fifo_size(fifo_t *fifo);
-void fifo_push(fifo_t *fifo, buffer_t *buffer);
-buffer_t *fifo_pop(fifo_t *fifo);
-void fifo_wake(fifo_t *fifo);
+ring_t *ring_new(size_t i_count, size_t i_size);
+void ring_free(ring_t *ring);
+size_t ring_count(ring_t *ring);
+buffer_t *ring_acquire(ring_t *ring, bool b_wait);
+unsigned int ring_acquire_batch(ring_t *ring, buffer_t **pp_buffers,
+                                unsigned int i_count, bool b_wait);
+void ring_push(ring_t *ring);
+void ring_push_batch(ring_t *ring, unsigned int i_count);
+void ring_flush(ring_t *ring);
+buffer_t *ring_pop(ring_t *ring);
+void ring_release(ring_t *ring);
+void ring_close(ring_t *ring);
 
 #endif
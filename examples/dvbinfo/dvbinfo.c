@@ -70,11 +70,16 @@
 #include "dvbinfo.h"
 #include "libdvbpsi.h"
 #include "buffer.h"
+#include "file.h"
+#include "metrics.h"
 
 #ifdef HAVE_SYS_SOCKET_H
 #   include "udp.h"
 #   include "tcp.h"
 #endif
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_EPOLL_H)
+#   include "pool.h"
+#endif
 
 #if __APPLE__
 #undef daemon
@@ -82,11 +87,16 @@ extern int daemon(int, int);
 #endif
 
 #define FIFO_THRESHOLD_SIZE (400 * 1024 * 1024) /* threshold in bytes */
+#define RING_MAX_BUFFERS    (64 * 1024)         /* caps the ring depth */
+#define UDP_RCVBUF_SIZE     (4 * 1024 * 1024)   /* 100 Mb/s during 1/3s */
+#define METRICS_POLL        100                 /* ms between metrics socket polls */
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
 #ifdef HAVE_SYS_SOCKET_H
-static const int   i_summary_mode[] = { SUM_BANDWIDTH, SUM_TABLE, SUM_PACKET, SUM_WIRE };
-static const char *psz_summary_mode[] = { "bandwidth", "table", "packet", "wire" };
+static const int   i_summary_mode[] = { SUM_BANDWIDTH, SUM_TABLE, SUM_PACKET, SUM_WIRE,
+                                        SUM_JSON, SUM_OPENMETRICS };
+static const char *psz_summary_mode[] = { "bandwidth", "table", "packet", "wire",
+                                          "json", "openmetrics" };
 #endif
 
 /*****************************************************************************
@@ -94,12 +104,9 @@ static const char *psz_summary_mode[] = { "bandwidth", "table", "packet", "wire"
  *****************************************************************************/
 typedef struct dvbinfo_capture_s
 {
-    fifo_t  *fifo;
-    fifo_t  *empty;
-
-    pthread_mutex_t lock;
-    pthread_cond_t  fifo_full;
-    bool     b_fifo_full;
+    ring_t   *ring;     /* capture thread -> processing thread */
+    buffer_t *discard;  /* read target while the ring is full */
+    file_t   *file;     /* file input, read in place without capture thread */
 
     size_t   size;  /* prefered capture size */
 
@@ -114,7 +121,7 @@ static void usage(void)
 {
 #ifdef HAVE_SYS_SOCKET_H
     printf("Usage: dvbinfo [-h] [-d <debug>] [-f <filename> | -m | -c <bufsize> | [[-u|-t] -a <mcast_interface> -i <ipaddress:port>] -o <outputfile>\n");
-    printf("               [-s [bandwidth|table|packet] --summary-file <file> --summary-period <ms>]\n");
+    printf("               [-s [bandwidth|table|packet|json|openmetrics] --summary-file <file> --summary-period <ms>]\n");
 #else
     printf("Usage: dvbinfo [-h] [-d <debug>] [-f|\n");
 #endif
@@ -123,8 +130,14 @@ static void usage(void)
     printf(" -h | --help           : help information\n");
     printf("\nInputs: \n");
     printf(" -f | --file           : filename\n");
+    printf(" -w | --workers        : analyse a file with n threads, sharded by PID (default: 1)\n");
+    printf("                         or monitor --inputs with n threads (default: one per core)\n");
 #ifdef HAVE_SYS_SOCKET_H
     printf(" -i | --ipadddress     : hostname or ipaddress\n");
+#ifdef HAVE_SYS_EPOLL_H
+    printf(" -l | --inputs         : file listing udp inputs, one [<mcast_interface>@]<ipaddress:port>\n");
+    printf("                         per line, monitored together by a pool of worker threads\n");
+#endif
     printf(" -a | --miface         : multicast interface to use\n");
     printf(" -t | --tcp            : tcp network transport\n");
     printf(" -u | --udp            : udp network transport\n");
@@ -137,10 +150,15 @@ static void usage(void)
     printf("                         table  = tables and descriptors\n");
     printf("                         packet = decode packets and print structs\n");
 //    printf("                         wire = print arrival time per packet (wireshark like)\n");
+    printf("                         json   = metrics snapshot as JSON\n");
+    printf("                         openmetrics = metrics snapshot in OpenMetrics text format\n");
     printf(" -j | --summary-file   : file to write summary information to (default: stdout)\n");
     printf(" -p | --summary-period : refresh summary file every n milliseconds (default: 1000ms)\n");
+    printf(" -M | --metrics-socket : serve a metrics snapshot to every client connecting to this\n");
+    printf("                         unix socket (json if --summary=json, else openmetrics)\n");
     printf("\nTuning options: \n");
     printf(" -c | --capture buffer size : number of bytes in capture buffer (default: %d bytes)\n", FIFO_THRESHOLD_SIZE);
+    printf(" -r | --rcvbuf         : udp socket receive buffer in bytes (default: %d bytes)\n", UDP_RCVBUF_SIZE);
 #endif
     exit(EXIT_FAILURE);
 }
@@ -204,6 +222,8 @@ static params_t *params_init(void)
 
     /* tuning options */
     param->threshold = FIFO_THRESHOLD_SIZE;
+    param->rcvbuf = UDP_RCVBUF_SIZE;
+    param->jobs = 0;
 
     /* statistics */
     param->b_summary = false;
@@ -222,8 +242,10 @@ static void params_free(params_t *param)
 {
     free(param->mcast_interface);
     free(param->input);
+    free(param->inputs);
     free(param->output);
     free(param->summary.file);
+    free(param->summary.socket);
     free(param);
     param = NULL;
 }
@@ -256,7 +278,8 @@ static void dvbinfo_open(params_t *param)
     }
     if (param->input && param->b_udp)
     {
-        param->fd_in = udp_open(param->mcast_interface, param->input, param->port);
+        param->fd_in = udp_open(param->mcast_interface, param->input, param->port,
+                                param->rcvbuf);
         if (param->fd_in < 0)
             goto error;
     }
@@ -282,6 +305,61 @@ error:
     exit(EXIT_FAILURE);
 }
 
+#ifdef HAVE_SYS_SOCKET_H
+/* Receive a batch of datagrams straight into ring buffers,
+ * returns false once the ring is closed or on socket errors */
+static bool dvbinfo_capture_udp(dvbinfo_capture_t *capture)
+{
+    const params_t *param = capture->params;
+    buffer_t *buffers[UDP_BATCH_MAX];
+    udp_datagram_t datagrams[UDP_BATCH_MAX];
+
+    unsigned int count = ring_acquire_batch(capture->ring, buffers, UDP_BATCH_MAX, false);
+    if (count == 0)
+    {
+        buffer_t *buffer = capture->discard;
+        if (param->pf_read(param->fd_in, buffer->p_data, capture->size) < 0)
+            return false;
+        libdvbpsi_log(capture->params, DVBINFO_LOG_ERROR,
+                      "error fifo full discarding buffer\n");
+        return true;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        datagrams[i].p_data = buffers[i]->p_data;
+        datagrams[i].i_size = buffers[i]->i_size;
+    }
+
+    /* take what is queued, publish the pending buffers before blocking */
+    int received = udp_read_batch(param->fd_in, datagrams, count, false);
+    if (received == 0)
+    {
+        ring_flush(capture->ring);
+        received = udp_read_batch(param->fd_in, datagrams, count, true);
+    }
+    if (received < 0)
+        return false;
+
+    mtime_t now = 0;
+    for (int i = 0; i < received; i++)
+    {
+        buffers[i]->i_size = datagrams[i].i_length;
+        buffers[i]->i_arrival = datagrams[i].i_arrival;
+        if (datagrams[i].i_arrival > 0) /* same clock as mdate() */
+            buffers[i]->i_date = datagrams[i].i_arrival / 1000000;
+        else
+        {
+            if (now == 0)
+                now = mdate();
+            buffers[i]->i_date = now;
+        }
+    }
+    ring_push_batch(capture->ring, received);
+    return true;
+}
+#endif
+
 static void *dvbinfo_capture(void *data)
 {
     dvbinfo_capture_t *capture = (dvbinfo_capture_t *)data;
@@ -290,75 +368,108 @@ static void *dvbinfo_capture(void *data)
 
     while (capture->b_alive && !b_eof)
     {
-        buffer_t *buffer;
-
-        if (fifo_count(capture->empty) == 0)
-            buffer = buffer_new(capture->size);
-        else
-            buffer = fifo_pop(capture->empty);
-
-        if (buffer == NULL) /* out of memory */
-            break;
+#ifdef HAVE_SYS_SOCKET_H
+        if (param->b_udp)
+        {
+            b_eof = !dvbinfo_capture_udp(capture);
+            continue;
+        }
+#endif
+        /* files wait for the consumer, live inputs must keep reading */
+        buffer_t *buffer = ring_acquire(capture->ring, param->b_file);
+        bool b_discard = (buffer == NULL);
+        if (b_discard)
+        {
+            if (param->b_file) /* ring closed */
+                break;
+            buffer = capture->discard;
+            buffer->i_size = capture->size;
+        }
 
+        /* a live read may block, publish the pending buffers first */
+        if (!param->b_file)
+            ring_flush(capture->ring);
         ssize_t size = param->pf_read(param->fd_in, buffer->p_data, buffer->i_size);
         if (size < 0) /* short read ? */
-        {
-            fifo_push(capture->empty, buffer);
             continue;
-        }
         else if (size == 0)
         {
-            fifo_push(capture->empty, buffer);
             b_eof = true;
             continue;
         }
 
+        if (b_discard)
+        {
+            libdvbpsi_log(capture->params, DVBINFO_LOG_ERROR,
+                          "error fifo full discarding buffer\n");
+            continue;
+        }
+
         /* if file then use current fileoffset */
         if (param->b_file)
             buffer->i_date = lseek(param->fd_in, 0, SEEK_CUR);
         else
             buffer->i_date = mdate();
-
-        /* check fifo size */
-        if (fifo_size(capture->fifo) >= param->threshold)
-        {
-            pthread_mutex_lock(&capture->lock);
-            capture->b_fifo_full = true;
-            pthread_mutex_unlock(&capture->lock);
-
-            if (param->b_file)
-            {
-                /* wait till buffer becomes smaller again */
-                pthread_mutex_lock(&capture->lock);
-                while(capture->b_fifo_full)
-                    pthread_cond_wait(&capture->fifo_full, &capture->lock);
-                pthread_mutex_unlock(&capture->lock);
-            }
-            else
-            {
-                libdvbpsi_log(capture->params, DVBINFO_LOG_ERROR,
-                          "error fifo full discarding buffer\n");
-                fifo_push(capture->empty, buffer);
-                continue;
-            }
-        }
+        buffer->i_size = size;
 
         /* store buffer */
-        fifo_push(capture->fifo, buffer);
-        buffer = NULL;
+        ring_push(capture->ring);
     }
 
+    ring_flush(capture->ring);
+    ring_close(capture->ring);
     capture->b_alive = false;
-    fifo_wake(capture->fifo);
     return NULL;
 }
 
+/* Summary in the selected mode, metrics modes go through a snapshot */
+static bool dvbinfo_summary(FILE *fd, ts_stream_t *stream, ts_metrics_t *metrics,
+                            const int mode, const params_t *param)
+{
+    if ((mode != SUM_JSON) && (mode != SUM_OPENMETRICS))
+    {
+        libdvbpsi_summary(fd, stream, mode);
+        return true;
+    }
+    if (!libdvbpsi_metrics(stream, metrics))
+        return false;
+    return metrics_write(fd, mode, &metrics, NULL, 1, !param->b_file);
+}
+
+#ifdef HAVE_SYS_SOCKET_H
+/* Answer the clients waiting on the metrics socket */
+static void dvbinfo_metrics_serve(metrics_server_t *server, ts_stream_t *stream,
+                                  ts_metrics_t *metrics, const params_t *param)
+{
+    const int mode = (param->summary.mode == SUM_JSON) ? SUM_JSON : SUM_OPENMETRICS;
+    int fd;
+    while ((fd = metrics_accept(server)) >= 0)
+    {
+        char *p_data = NULL;
+        size_t i_size = 0;
+        FILE *mem = open_memstream(&p_data, &i_size);
+        if (mem)
+        {
+            dvbinfo_summary(mem, stream, metrics, mode, param);
+            fclose(mem);
+        }
+        metrics_send(fd, p_data, mem ? i_size : 0);
+        free(p_data);
+    }
+}
+#endif
+
 static int dvbinfo_process(dvbinfo_capture_t *capture)
 {
     int err = -1;
     bool b_error = false;
     params_t *param = capture->params;
     buffer_t *buffer = NULL;
+    ts_metrics_t *metrics = NULL;
+#ifdef HAVE_SYS_SOCKET_H
+    metrics_server_t *server = NULL;
+    mtime_t poll = 0;
+#endif
 
     char *psz_temp = NULL;
     mtime_t deadline = 0;
@@ -376,28 +487,67 @@ static int dvbinfo_process(dvbinfo_capture_t *capture)
     ts_stream_t *stream = libdvbpsi_init(param->debug, &libdvbpsi_log, (void *)param);
     if (!stream)
         goto out;
+    metrics = libdvbpsi_metrics_new();
+    if (!metrics)
+        goto out;
+#ifdef HAVE_SYS_SOCKET_H
+    if (param->summary.socket)
+    {
+        server = metrics_listen(param->summary.socket);
+        if (server == NULL)
+        {
+            libdvbpsi_log(param, DVBINFO_LOG_ERROR, "failed opening metrics socket %s\n",
+                          param->summary.socket);
+            goto out;
+        }
+    }
+#endif
 
     while (!b_error)
     {
-        /* Wait till fifo has emptied */
-        if (!capture->b_alive && (fifo_count(capture->fifo) == 0))
-            break;
+        uint8_t *p_data;
+        size_t   i_size;
+        mtime_t  i_date;
 
-        /* Wait for data to arrive */
-        buffer = fifo_pop(capture->fifo);
-        if (buffer == NULL)
-            continue;
+        if (capture->file)
+        {
+            int64_t i_offset;
+            ssize_t size = file_read(capture->file, &p_data, &i_offset);
+            if (size <= 0)
+            {
+                b_error = (size < 0);
+                break;
+            }
+            i_size = size;
+            i_date = i_offset;
+            libdvbpsi_arrival(stream, 0);
+        }
+        else
+        {
+            /* Wait for data to arrive, NULL once the capture thread is done
+             * and the ring has emptied */
+            buffer = ring_pop(capture->ring);
+            if (buffer == NULL)
+                break;
+            p_data = buffer->p_data;
+            i_size = buffer->i_size;
+            i_date = buffer->i_date;
+            if (buffer->i_arrival > 0)
+                libdvbpsi_arrival(stream, buffer->i_arrival);
+            else /* file offset or capture time in ms */
+                libdvbpsi_arrival(stream, param->b_file ? 0 : i_date * 1000000);
+        }
 
         if (param->output)
         {
-            ssize_t size = param->pf_write(param->fd_out, buffer->p_data, buffer->i_size);
+            ssize_t size = param->pf_write(param->fd_out, p_data, i_size);
             if (size < 0) /* error writing */
             {
                 libdvbpsi_log(param, DVBINFO_LOG_ERROR,
                               "error (%d) writing to %s\n", errno, param->output);
                 break;
             }
-            else if ((size_t)size < buffer->i_size) /* short writing disk full? */
+            else if ((size_t)size < i_size) /* short writing disk full? */
             {
                 libdvbpsi_log(param, DVBINFO_LOG_ERROR,
                               "error writing to %s (disk full?)\n", param->output);
@@ -405,7 +555,12 @@ static int dvbinfo_process(dvbinfo_capture_t *capture)
             }
         }
 
-        if (!libdvbpsi_process(stream, buffer->p_data, buffer->i_size, buffer->i_date))
+        if (capture->file && (param->jobs > 1))
+        {
+            if (!libdvbpsi_process_parallel(stream, p_data, i_size, i_date, param->jobs))
+                b_error = true;
+        }
+        else if (!libdvbpsi_process(stream, p_data, i_size, i_date))
             b_error = true;
 
         /* summary statistics */
@@ -416,7 +571,7 @@ static int dvbinfo_process(dvbinfo_capture_t *capture)
                 FILE *fd = fopen(psz_temp, "w+");
                 if (fd)
                 {
-                    libdvbpsi_summary(fd, stream, param->summary.mode);
+                    dvbinfo_summary(fd, stream, metrics, param->summary.mode, param);
                     fflush(fd);
                     fclose(fd);
                     unlink(param->summary.file);
@@ -437,30 +592,32 @@ static int dvbinfo_process(dvbinfo_capture_t *capture)
                 deadline = mdate() + param->summary.period;
             }
         }
+#ifdef HAVE_SYS_SOCKET_H
+        if (server && (mdate() >= poll))
+        {
+            dvbinfo_metrics_serve(server, stream, metrics, param);
+            poll = mdate() + METRICS_POLL;
+        }
+#endif
 
         /* reuse buffer */
-        fifo_push(capture->empty, buffer);
+        if (buffer)
+            ring_release(capture->ring);
         buffer = NULL;
-
-        /* check fifo size */
-        if (fifo_size(capture->fifo) < param->threshold)
-        {
-            pthread_mutex_lock(&capture->lock);
-            capture->b_fifo_full = false;
-            pthread_cond_signal(&capture->fifo_full);
-            pthread_mutex_unlock(&capture->lock);
-        }
     }
 
-    assert(fifo_count(capture->fifo) == 0);
-    libdvbpsi_exit(stream);
     err = 0;
 
 out:
     if (b_error)
         libdvbpsi_log(param, DVBINFO_LOG_ERROR, "error while processing\n" );
 
-    if (buffer) buffer_free(buffer);
+#ifdef HAVE_SYS_SOCKET_H
+    metrics_close(server);
+#endif
+    libdvbpsi_metrics_delete(metrics);
+    if (stream)
+        libdvbpsi_exit(stream);
     free(psz_temp);
     return err;
 }
@@ -487,11 +644,9 @@ int main(int argc, char **pp_argv)
         exit(EXIT_FAILURE);
     }
     capture.params = param;
-    capture.fifo = fifo_new();
-    capture.empty = fifo_new();
-    capture.b_fifo_full = false;
-    pthread_mutex_init(&capture.lock, NULL);
-    pthread_cond_init(&capture.fifo_full, NULL);
+    capture.ring = NULL;
+    capture.discard = NULL;
+    capture.file = NULL;
 
     static const struct option long_options[] =
     {
@@ -499,8 +654,10 @@ int main(int argc, char **pp_argv)
         { "help",      no_argument,       NULL, 'h' },
         /* - inputs - */
         { "file",      required_argument, NULL, 'f' },
+        { "workers",   required_argument, NULL, 'w' },
 #ifdef HAVE_SYS_SOCKET_H
         { "ipaddress", required_argument, NULL, 'i' },
+        { "inputs",    required_argument, NULL, 'l' },
         { "miface",    required_argument, NULL, 'a' },
         { "tcp",       no_argument,       NULL, 't' },
         { "udp",       no_argument,       NULL, 'u' },
@@ -512,15 +669,17 @@ int main(int argc, char **pp_argv)
         { "summary",        required_argument, NULL, 's' },
         { "summary-file",   required_argument, NULL, 'j' },
         { "summary-period", required_argument, NULL, 'p' },
+        { "metrics-socket", required_argument, NULL, 'M' },
         /* - tuning options - */
         { "capturesize",    required_argument, NULL, 'c' },
+        { "rcvbuf",         required_argument, NULL, 'r' },
 #endif
         { NULL, 0, NULL, 0 }
     };
 #ifdef HAVE_SYS_SOCKET_H
-    while ((c = getopt_long(argc, pp_argv, "a:c:d:f:i:j:ho:p:ms:tu", long_options, NULL)) != -1)
+    while ((c = getopt_long(argc, pp_argv, "a:c:d:f:i:j:hl:M:o:p:mr:s:tuw:", long_options, NULL)) != -1)
 #else
-    while ((c = getopt_long(argc, pp_argv, "d:f:h", long_options, NULL)) != -1)
+    while ((c = getopt_long(argc, pp_argv, "d:f:hw:", long_options, NULL)) != -1)
 #endif
     {
         switch(c)
@@ -553,6 +712,20 @@ int main(int argc, char **pp_argv)
                 }
                 break;
 
+            case 'w':
+                if (optarg)
+                {
+                    long jobs = strtol(optarg, NULL, 10);
+                    if ((jobs < 1) || (jobs > 1024))
+                    {
+                        fprintf(stderr, "Option --workers has invalid content %s\n", optarg);
+                        params_free(param);
+                        usage();
+                    }
+                    param->jobs = jobs;
+                }
+                break;
+
 #ifdef HAVE_SYS_SOCKET_H
             case 'a':
                 if (optarg)
@@ -583,6 +756,18 @@ int main(int argc, char **pp_argv)
                 }
                 break;
 
+            case 'l':
+                if (optarg)
+                {
+                    if (asprintf(&param->inputs, "%s", optarg) < 0)
+                    {
+                        fprintf(stderr, "error: out of memory\n");
+                        params_free(param);
+                        usage();
+                    }
+                }
+                break;
+
             case 'm':
                 param->b_monitor = true;
                 break;
@@ -626,6 +811,19 @@ int main(int argc, char **pp_argv)
                 }
                 break;
 
+            case 'r':
+                if (optarg)
+                {
+                    param->rcvbuf = strtol(optarg, NULL, 10);
+                    if (param->rcvbuf <= 0)
+                    {
+                        fprintf(stderr, "Option --rcvbuf has invalid content %s\n", optarg);
+                        params_free(param);
+                        usage();
+                    }
+                }
+                break;
+
             /* - Statistics */
             case 's':
             {
@@ -662,6 +860,17 @@ int main(int argc, char **pp_argv)
                 }
                 break;
 
+            case 'M':
+                if (optarg)
+                {
+                    if (asprintf(&param->summary.socket, "%s", optarg) < 0)
+                    {
+                        params_free(param);
+                        usage();
+                    }
+                }
+                break;
+
             case 'p':
                 if (optarg)
                 {
@@ -714,6 +923,29 @@ int main(int argc, char **pp_argv)
     }
 #endif
 
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_EPOLL_H)
+    if (param->inputs)
+    {
+        int err = -1;
+        if (param->input || param->output || param->b_tcp)
+            libdvbpsi_log(param, DVBINFO_LOG_ERROR,
+                          "--inputs does not combine with other inputs or --output\n");
+        else
+        {
+            pool_t *pool = pool_new(param, &libdvbpsi_log, param->jobs);
+            if (pool == NULL)
+                libdvbpsi_log(param, DVBINFO_LOG_ERROR, "failed creating worker pool\n");
+            else if (pool_add_list(pool, param->inputs))
+                err = pool_run(pool);
+            pool_free(pool);
+        }
+        if (param->b_monitor)
+            closelog();
+        params_free(param);
+        exit((err < 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+#endif
+
     if (param->input == NULL)
     {
         libdvbpsi_log(param, DVBINFO_LOG_ERROR, "No source given\n");
@@ -740,36 +972,62 @@ int main(int argc, char **pp_argv)
                       param->input);
     }
 
-    /* Capture thread */
     dvbinfo_open(param);
-    pthread_t handle;
-    capture.b_alive = true;
-    if (pthread_create(&handle, NULL, dvbinfo_capture, (void *)&capture) < 0)
+
+    /* Regular files are scanned in place, no copies and no capture thread */
+    if (param->b_file)
+        capture.file = file_open(param->fd_in);
+
+    int err;
+    if (capture.file)
+        err = dvbinfo_process(&capture);
+    else
     {
-        libdvbpsi_log(param, DVBINFO_LOG_ERROR, "failed creating thread\n");
-        dvbinfo_close(param);
+        /* Ring of capture buffers, about param->threshold bytes deep */
+        size_t i_buffers = param->threshold / capture.size;
+        if (i_buffers > RING_MAX_BUFFERS)
+            i_buffers = RING_MAX_BUFFERS;
+        capture.ring = ring_new(i_buffers, capture.size);
+        capture.discard = buffer_new(capture.size);
+        if ((capture.ring == NULL) || (capture.discard == NULL))
+        {
+            printf("dvbinfo: out of memory\n");
+            ring_free(capture.ring);
+            buffer_free(capture.discard);
+            dvbinfo_close(param);
+            params_free(param);
+            exit(EXIT_FAILURE);
+        }
+
+        /* Capture thread */
+        pthread_t handle;
+        capture.b_alive = true;
+        if (pthread_create(&handle, NULL, dvbinfo_capture, (void *)&capture) < 0)
+        {
+            libdvbpsi_log(param, DVBINFO_LOG_ERROR, "failed creating thread\n");
+            dvbinfo_close(param);
+            ring_free(capture.ring);
+            buffer_free(capture.discard);
 #ifdef HAVE_SYS_SOCKET_H
-        if (param->b_monitor)
-            closelog();
+            if (param->b_monitor)
+                closelog();
 #endif
-        params_free(param);
-        exit(EXIT_FAILURE);
+            params_free(param);
+            exit(EXIT_FAILURE);
+        }
+        err = dvbinfo_process(&capture);
+        capture.b_alive = false;     /* stop thread */
+        ring_close(capture.ring);
+        if (pthread_join(handle, NULL) < 0)
+            libdvbpsi_log(param, DVBINFO_LOG_ERROR, "error joining capture thread\n");
     }
-    int err = dvbinfo_process(&capture);
-    capture.b_alive = false;     /* stop thread */
-    if (pthread_join(handle, NULL) < 0)
-        libdvbpsi_log(param, DVBINFO_LOG_ERROR, "error joining capture thread\n");
     dvbinfo_close(param);
 
     /* cleanup */
-    fifo_wake((&capture)->fifo);
-    fifo_wake((&capture)->empty);
-
-    fifo_free((&capture)->fifo);
-    fifo_free((&capture)->empty);
-
-    pthread_mutex_destroy(&capture.lock);
-    pthread_cond_destroy(&capture.fifo_full);
+    file_close(capture.file);
+    ring_free(capture.ring);
+    if (capture.discard)
+        buffer_free(capture.discard);
 
 #ifdef HAVE_SYS_SOCKET_H
     if (param->b_monitor)
@@ -37,6 +37,7 @@ typedef struct params_s
     /* parameters */
     char *output;
     char *input;
+    char *inputs;     /* file listing udp inputs for the worker pool */
 
     int  port;
     char *mcast_interface;
@@ -47,6 +48,8 @@ typedef struct params_s
 
     /* tuning options */
     size_t threshold; /* capture fifo threshold */
+    int    rcvbuf;    /* udp socket receive buffer in bytes */
+    unsigned int jobs; /* worker threads, 0 for the default */
 
     /* */
     int  fd_in;
@@ -63,6 +66,7 @@ typedef struct params_s
         int64_t period; /* summary period in ms */
         char *file;     /* summary file name    */
         FILE *fd;       /* summary file descriptor */
+        char *socket;   /* unix socket serving metrics snapshots */
     } summary;
 
     /* read data from file of socket */
@@ -0,0 +1,198 @@
+/*****************************************************************************
+ * file.c: file input
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <assert.h>
+
+#include "file.h"
+
+/* lcm(188, 192, 204) = 153408, times 64 is a multiple of the 4096 byte
+ * alignment O_DIRECT needs as well: 9.4 MB */
+#define FILE_CHUNK_SIZE (153408 * 64)
+#define FILE_ALIGN      4096
+
+struct file_s
+{
+    int      fd;
+    int64_t  i_offset;  /* offset of the next chunk */
+
+    /* mapped file */
+    uint8_t *p_map;
+    size_t   i_size;
+
+    /* read() fallback */
+    uint8_t *p_buffer;  /* FILE_CHUNK_SIZE bytes, FILE_ALIGN aligned */
+    bool     b_direct;
+};
+
+static bool file_map(file_t *file, const struct stat *st)
+{
+    if ((st->st_size <= 0) || ((uint64_t)st->st_size > SIZE_MAX))
+        return false;
+
+    void *p_map = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (p_map == MAP_FAILED)
+        return false;
+
+    file->p_map = (uint8_t *)p_map;
+    file->i_size = (size_t)st->st_size;
+
+    /* hints only, failures are harmless */
+    madvise(file->p_map, file->i_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(file->p_map, file->i_size, MADV_HUGEPAGE);
+#endif
+    return true;
+}
+
+file_t *file_open(int fd)
+{
+    struct stat st;
+
+    if ((fstat(fd, &st) < 0) || !S_ISREG(st.st_mode))
+        return NULL;
+
+    file_t *file = (file_t *) calloc(1, sizeof(file_t));
+    if (file == NULL) return NULL;
+    file->fd = fd;
+
+    if (file_map(file, &st))
+        return file;
+
+    /* too big for the address space: read it in aligned chunks */
+    if (posix_memalign((void **)&file->p_buffer, FILE_ALIGN, FILE_CHUNK_SIZE) != 0)
+    {
+        free(file);
+        return NULL;
+    }
+#ifdef O_DIRECT
+    int flags = fcntl(fd, F_GETFL);
+    if ((flags != -1) && (fcntl(fd, F_SETFL, flags | O_DIRECT) == 0))
+        file->b_direct = true;
+#endif
+    return file;
+}
+
+void file_close(file_t *file)
+{
+    if (file == NULL)
+        return;
+
+    if (file->p_map)
+        munmap(file->p_map, file->i_size);
+    free(file->p_buffer);
+    free(file);
+    file = NULL;
+}
+
+static ssize_t file_read_mapped(file_t *file, uint8_t **pp_data)
+{
+    if ((uint64_t)file->i_offset >= file->i_size)
+        return 0;
+
+    size_t i_offset = (size_t)file->i_offset;
+    size_t i_length = file->i_size - i_offset;
+    if (i_length > FILE_CHUNK_SIZE)
+        i_length = FILE_CHUNK_SIZE;
+
+    /* the previous chunk is done with, keep the mapping's footprint small */
+    if (i_offset >= FILE_CHUNK_SIZE)
+        madvise(file->p_map + i_offset - FILE_CHUNK_SIZE, FILE_CHUNK_SIZE, MADV_DONTNEED);
+    /* and start reading ahead the next one */
+    if (i_offset + i_length < file->i_size)
+    {
+        size_t i_next = file->i_size - (i_offset + i_length);
+        if (i_next > FILE_CHUNK_SIZE)
+            i_next = FILE_CHUNK_SIZE;
+        madvise(file->p_map + i_offset + i_length, i_next, MADV_WILLNEED);
+    }
+
+    *pp_data = file->p_map + i_offset;
+    return (ssize_t)i_length;
+}
+
+static ssize_t file_read_direct(file_t *file, uint8_t **pp_data)
+{
+    size_t i_length = 0;
+
+    while (i_length < FILE_CHUNK_SIZE)
+    {
+        ssize_t size = read(file->fd, file->p_buffer + i_length, FILE_CHUNK_SIZE - i_length);
+        if (size < 0)
+        {
+            if (errno == EINTR)
+                continue;
+#ifdef O_DIRECT
+            /* filesystem without O_DIRECT support */
+            if ((errno == EINVAL) && file->b_direct && (i_length == 0))
+            {
+                int flags = fcntl(file->fd, F_GETFL);
+                if ((flags != -1) && (fcntl(file->fd, F_SETFL, flags & ~O_DIRECT) == 0))
+                {
+                    file->b_direct = false;
+                    continue;
+                }
+            }
+#endif
+            fprintf(stderr, "read error: %s\n", strerror(errno));
+            return -1;
+        }
+        if (size == 0)
+            break;
+        i_length += size;
+        /* O_DIRECT reads stay aligned, a short read means end of file */
+        if (file->b_direct && (i_length % FILE_ALIGN))
+            break;
+    }
+
+    *pp_data = file->p_buffer;
+    return (ssize_t)i_length;
+}
+
+ssize_t file_read(file_t *file, uint8_t **pp_data, int64_t *pi_offset)
+{
+    ssize_t size = file->p_map ? file_read_mapped(file, pp_data)
+                               : file_read_direct(file, pp_data);
+    if (size > 0)
+        file->i_offset += size;
+    *pi_offset = file->i_offset;
+    return size;
+}
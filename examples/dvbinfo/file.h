@@ -0,0 +1,45 @@
+/*****************************************************************************
+ * file.h: file input
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+
+#ifndef DVBINFO_FILE_H_
+#define DVBINFO_FILE_H_
+
+typedef struct file_s file_t;
+
+/* File input without a capture thread:
+ * file_open()  - map the regular file opened as fd, or fall back to large
+ *                aligned O_DIRECT reads when it cannot be mapped, NULL if fd
+ *                is not a regular file
+ * file_read()  - next chunk of the file in *pp_data, valid until the next
+ *                call, *pi_offset is the file offset after the chunk,
+ *                returns the chunk size, 0 at end of file, -1 on error
+ * file_close() - unmap and release, does not close fd
+ *
+ * Chunks are a multiple of 188, 192 and 204 bytes so packet lattices
+ * never straddle two chunks of an aligned capture.
+ */
+file_t *file_open(int fd);
+ssize_t file_read(file_t *file, uint8_t **pp_data, int64_t *pi_offset);
+void file_close(file_t *file);
+
+#endif
@@ -43,12 +43,14 @@
 #endif
 
 #include <assert.h>
+#include <pthread.h>
 
 /* The libdvbpsi distribution defines DVBPSI_DIST */
 #ifdef DVBPSI_DIST
 #   include "../../src/dvbpsi.h"
 #   include "../../src/psi.h"
 #   include "../../src/chain.h"
+#   include "../../src/ts.h"
 #   include "../../src/descriptor.h"
 #   include "../../src/tables/pat.h"
 #   include "../../src/tables/pmt.h"
@@ -60,6 +62,7 @@
 #   include "../../src/tables/tot.h"
 #   include "../../src/tables/rst.h"
 #   include "../../src/descriptors/dr.h"
+#   include "../../src/section_cache.h"
 /*  ATSC PSI Tables */
 #   include "../../src/tables/atsc_eit.h"
 #   include "../../src/tables/atsc_ett.h"
@@ -70,6 +73,7 @@
 #   include <dvbpsi/dvbpsi.h>
 #   include <dvbpsi/psi.h>
 #   include <dvbpsi/chain.h>
+#   include <dvbpsi/ts.h>
 #   include <dvbpsi/descriptor.h>
 #   include <dvbpsi/pat.h>
 #   include <dvbpsi/pmt.h>
@@ -81,6 +85,7 @@
 #   include <dvbpsi/tot.h>
 #   include <dvbpsi/rst.h>
 #   include <dvbpsi/dr.h>
+#   include <dvbpsi/section_cache.h>
 /*  ATSC PSI Tables */
 #   include <dvbpsi/atsc_eit.h>
 #   include <dvbpsi/atsc_ett.h>
@@ -90,6 +95,8 @@
 #endif
 
 #include "libdvbpsi.h"
+#include "pcr.h"
+#include "tr290.h"
 
 /* DVB CUEI Descriptors */
 /* SIS support (SCTE 35 2004) */
@@ -106,15 +113,18 @@
 /*****************************************************************************
  * Data structures
  *****************************************************************************/
-typedef struct ts_pid_s ts_pid_t;
-struct ts_pid_s
+/* Per packet state of a PID, one cache line. Kept in stream->hot for the
+ * first TS_HOT_SLOTS PIDs seen, so the packet loop stays in a few kB. */
+typedef struct ts_pid_hot_s
 {
-    ts_pid_t    *pid_pmt;
+    uint64_t    i_packets;    /* number of packets for this pid */
+    mtime_t     i_prev_received; /* capture time of previous packet for this pid */
+    mtime_t     i_received;   /* last capture time for packet of this pid */
+    mtime_t     i_pcr;        /* last know PCR value */
+    uint64_t    i_cc_errors;  /* continuity counter discontinuities */
 
     /* TS header fields */
-    int         i_pid;
-    int         i_cc;   /* countinuity counter */
-
+    int8_t      i_cc;   /* countinuity counter */
     bool        b_seen;
 
     /* flags */
@@ -123,10 +133,31 @@ struct ts_pid_s
     bool        b_transport_priority;
     uint8_t     i_transport_scrambling_control;
 
-    /* adaptation field: indicators and flags */
+    /* adaptation field: indicators */
     bool        b_adaptation_field;
     bool        b_discontinuity_indicator;
     bool        b_random_access_indicator;
+} __attribute__((aligned(64))) ts_pid_hot_t;
+
+#define TS_HOT_SLOTS 254    /* stream->ai_slot: 0 none yet, 255 see ts_pid_t.hot */
+#define TS_SLOT_FAR  255
+
+#define TS_BATCH 64         /* packet headers decoded in one go */
+
+/* Everything else about a PID: PSI links, rarely set adaptation field
+ * details and PCR timing */
+typedef struct ts_pid_s ts_pid_t;
+struct ts_pid_s
+{
+    ts_pid_t    *pid_pmt;
+    ts_pid_hot_t *hot;  /* NULL until the first packet */
+
+    int         i_pid;
+
+    bool        b_active; /* listed in stream->ai_active */
+    bool        b_psi;  /* handled by the PSI pass of libdvbpsi_process_parallel() */
+
+    /* adaptation field: flags */
     bool        b_elementary_stream_priority_indicator;
     bool        b_transport_private_data;
     bool        b_splicing_point;
@@ -136,7 +167,6 @@ struct ts_pid_s
 
     bool        b_opcr;
     bool        b_pcr;  /* this PID is the PCR_PID */
-    mtime_t     i_pcr;  /* last know PCR value */
 
     /* adaptation field extension */
     bool        b_adaptation_field_extension;
@@ -149,12 +179,13 @@ struct ts_pid_s
     bool        b_seamless_splice;
 
     /* statistics */
-    uint64_t    i_packets;    /* number of packets for this pid */
     mtime_t     i_first_pcr;  /* first pcr seen for this pid */
     mtime_t     i_prev_pcr;   /* previous pcr seen for this pid */
     mtime_t     i_last_pcr;   /* last pcr seen for this pid */
-    mtime_t     i_prev_received; /* capture time of previous packet for this pid */
-    mtime_t     i_received;   /* last capture time for packet of this pid */
+    pcr_t       *pcr;         /* analysis, from the first PCR on */
+    unsigned int i_tables;    /* PAT, PMT or CAT tables decoded on this pid */
+    int         i_version;    /* version of the last one */
+    uint64_t    i_version_changes;
 };
 
 typedef struct
@@ -272,6 +303,11 @@ struct ts_stream_t
 
     /* pid */
     ts_pid_t    pid[8192];
+    uint16_t    ai_active[8192]; /* PIDs seen so far, in ascending order */
+    unsigned int i_active;
+    uint8_t     ai_slot[8192];   /* PID -> stream->hot slot */
+    ts_pid_hot_t *hot;           /* TS_HOT_SLOTS + 1, slot 0 spare */
+    unsigned int i_slots;
 
     enum dvbpsi_msg_level level;
 
@@ -279,6 +315,28 @@ struct ts_stream_t
     uint64_t    i_packets;
     uint64_t    i_null_packets;
     uint64_t    i_lost_bytes;
+    unsigned int i_stride;      /* 188, 192 (M2TS) or 204, 0 when not synced */
+    mtime_t     i_date;         /* date of the last buffer */
+    int64_t     i_arrival;      /* capture time of the buffer in ns, 0 if unknown */
+    uint64_t    i_bytes;        /* bytes before the buffer */
+    const uint8_t *p_buf;       /* the buffer, for byte positions of packets */
+    unsigned int i_pcrs;        /* PIDs with a PCR analysis */
+
+    /* TR 101 290 checks */
+    tr290_t     *tr290;
+    int64_t     i_psi_time;     /* ns, of the packet in the PSI decoders */
+    int64_t     i_tick;         /* ns, next tr290_tick() */
+    double      f_ns_per_byte;  /* file input: multiplex rate, 0 if unknown */
+    uint64_t    i_clock_bytes;  /* file input: byte position of i_clock_time */
+    int64_t     i_clock_time;   /* ns */
+
+    /* headers of the packets being processed, see ts.h */
+    dvbpsi_ts_headers_t headers;
+    uint32_t    ai_offset[TS_BATCH];
+    uint16_t    ai_pid[TS_BATCH];
+    uint8_t     ai_flags[TS_BATCH];
+    uint8_t     ai_cc[TS_BATCH];
+    uint8_t     ai_payload[TS_BATCH];
 
     /* logging */
     ts_stream_log_cb pf_log;
@@ -309,6 +367,21 @@ static const char *AACProfileToString(dvbpsi_aac_profile_and_level_t profile);
 
 static void DeleteTableDecoder(dvbpsi_t *p_dvbpsi, uint8_t i_table, uint16_t i_extension);
 
+/* Hot state of a PID that has been seen, through the slot map */
+static inline ts_pid_hot_t *ts_pid_hot(ts_stream_t *stream, const uint16_t i_pid)
+{
+    const uint8_t i_slot = stream->ai_slot[i_pid];
+    assert(i_slot != 0);
+    return (i_slot != TS_SLOT_FAR) ? &stream->hot[i_slot] : stream->pid[i_pid].hot;
+}
+
+/* Hot state of any PID, all zero for one never seen */
+static const ts_pid_hot_t *ts_pid_hot_of(const ts_pid_t *pid)
+{
+    static const ts_pid_hot_t unseen;
+    return pid->hot ? pid->hot : &unseen;
+}
+
 /*****************************************************************************
  * mdate: current time in milliseconds
  *****************************************************************************/
@@ -381,25 +454,27 @@ static void ts_hexdump(FILE *fd, const uint8_t * const data, const uint32_t leng
 
 static void ts_header_dump(FILE *fd, ts_pid_t *ts)
 {
+    const ts_pid_hot_t *hot = ts_pid_hot_of(ts);
+
     fprintf(fd, "\n\tPID 0x%x seen %s\n",
-           ts->i_pid, ts->b_seen ? "yes" : "no");
-    fprintf(fd, "\tContinuity counter: %d\n", ts->i_cc);
+           ts->i_pid, hot->b_seen ? "yes" : "no");
+    fprintf(fd, "\tContinuity counter: %d\n", hot->i_cc);
     fprintf(fd, "\tTransport Error indicator: %s\n",
-           ts->b_transport_error_indicator ? "yes" : "no");
+           hot->b_transport_error_indicator ? "yes" : "no");
     fprintf(fd, "\tPayload unit start indicator: %s\n",
-           ts->b_payload_unit_start_indicator ? "yes" : "no");
+           hot->b_payload_unit_start_indicator ? "yes" : "no");
     fprintf(fd, "\tScrambling control: %s\n",
-           (ts->i_transport_scrambling_control != 0x0) ? "yes" : "no");
-    if (ts->i_transport_scrambling_control > 0x0)
-        fprintf(fd, "\tScrambling control word: 0x%x\n", ts->i_transport_scrambling_control);
+           (hot->i_transport_scrambling_control != 0x0) ? "yes" : "no");
+    if (hot->i_transport_scrambling_control > 0x0)
+        fprintf(fd, "\tScrambling control word: 0x%x\n", hot->i_transport_scrambling_control);
     fprintf(fd, "\tAdaptation field control: %s\n",
-           ts->b_adaptation_field ? "yes" : "no");
-    if (ts->b_adaptation_field)
+           hot->b_adaptation_field ? "yes" : "no");
+    if (hot->b_adaptation_field)
     {
         fprintf(fd, "\tDiscontinuity indicator: %s\n",
-           ts->b_discontinuity_indicator ? "yes" : "no");
+           hot->b_discontinuity_indicator ? "yes" : "no");
         fprintf(fd, "\tRandom access indicator: %s\n",
-           ts->b_random_access_indicator ? "yes" : "no");
+           hot->b_random_access_indicator ? "yes" : "no");
         fprintf(fd, "\tElementary stream priority indicator: %s\n",
            ts->b_elementary_stream_priority_indicator ? "yes" : "no");
         fprintf(fd, "\tTransport private data: %s\n",
@@ -416,7 +491,7 @@ static void ts_header_dump(FILE *fd, ts_pid_t *ts)
         fprintf(fd, "\tOriginal PCR: %s\n", ts->b_opcr ? "yes" : "no");
         fprintf(fd, "\tPCR PID: %s\n", ts->b_pcr ? "yes" : "no");
         if (ts->b_pcr)
-            fprintf(fd, "\tPCR: %"PRId64"\n", ts->i_pcr);
+            fprintf(fd, "\tPCR: %"PRId64"\n", hot->i_pcr);
 
         /* adaptation field extension */
         if (ts->b_adaptation_field_extension &&
@@ -470,9 +545,9 @@ static void ts_dump_packet_details(FILE *fd, ts_stream_t *stream, const uint8_t
 {
     fprintf(fd, "\n\t---------------------------------------------------------\n");
     fprintf(fd, "\tTS Packet number %"PRId64", ES number %"PRId64", pid %d (0x%x)\n",
-       stream->i_packets, stream->pid[i_pid].i_packets, i_pid, i_pid);
+       stream->i_packets, ts_pid_hot(stream, i_pid)->i_packets, i_pid, i_pid);
 #if defined(HAVE_SYS_TIME_H)
-    fprintf(fd, "\tReceived time: %"PRId64" ms\n", stream->pid[i_pid].i_received);
+    fprintf(fd, "\tReceived time: %"PRId64" ms\n", ts_pid_hot(stream, i_pid)->i_received);
 #endif
     ts_header_dump(fd, &stream->pid[i_pid]);
     ts_hexdump(fd, data, 188);
@@ -482,6 +557,46 @@ static void ts_dump_packet_details(FILE *fd, ts_stream_t *stream, const uint8_t
 /*****************************************************************************
  * Summary: Bandwidth, Packet, Table
  *****************************************************************************/
+static void summary_histogram(FILE *fd, const char *psz_name, const pcr_histogram_t *histogram)
+{
+    fprintf(fd, "\t%-9s: max %.3f ms, 50%% below %.3f ms, 99%% below %.3f ms\n", psz_name,
+            (double)histogram->i_max / 1000000.0,
+            (double)pcr_histogram_percentile(histogram, 0.50) / 1000000.0,
+            (double)pcr_histogram_percentile(histogram, 0.99) / 1000000.0);
+}
+
+static void summary_pcr(FILE *fd, const pcr_t *pcr)
+{
+    fprintf(fd, "PCR analysis: %"PRIu64" PCRs, errors: repetition %"PRIu64
+                ", discontinuity %"PRIu64", accuracy %"PRIu64"\n",
+            pcr->i_pcrs, pcr->i_repetition_errors, pcr->i_discontinuity_errors,
+            pcr->i_accuracy_errors);
+    if (pcr->interval.i_count > 0)
+        summary_histogram(fd, "interval", &pcr->interval);
+    if (pcr->accuracy.i_count > 0)
+        summary_histogram(fd, "accuracy", &pcr->accuracy);
+    if (pcr->jitter.i_count > 0)
+        summary_histogram(fd, "jitter", &pcr->jitter);
+}
+
+static void summary_tr290(FILE *fd, const ts_stream_t *stream)
+{
+    tr290_counter_t counters[TR290_CHECKS];
+
+    tr290_get(stream->tr290, counters);
+    fprintf(fd, "\n---------------------------------------------------------\n");
+    fprintf(fd, "\nTR 101 290: priority, errors, first and last (s into the stream)\n");
+    for (int i = 0; i < TR290_CHECKS; i++)
+    {
+        fprintf(fd, "%d %-34s %8"PRIu64, tr290_priority(i), tr290_name(i),
+                counters[i].i_count);
+        if (counters[i].i_first >= 0)
+            fprintf(fd, "  %.3f  %.3f", (double)counters[i].i_first / 1000000000.0,
+                    (double)counters[i].i_last / 1000000000.0);
+        fprintf(fd, "\n");
+    }
+}
+
 static void summary(FILE *fd, ts_stream_t *stream)
 {
     uint64_t i_packets = 0;
@@ -510,34 +625,38 @@ static void summary(FILE *fd, ts_stream_t *stream)
         {
             start = stream->pid[i_pmt_pid].i_first_pcr;
             end = stream->pid[i_pmt_pid].i_last_pcr;
-            if (stream->pid[i_pmt_pid].b_discontinuity_indicator)
+            if (ts_pid_hot_of(&stream->pid[i_pmt_pid])->b_discontinuity_indicator)
             {
                 fprintf(fd, "PCR discontinuity was signalled for PID: %4d (0x%4x)\n",
                         i_pmt_pid, i_pmt_pid);
             }
+            if (stream->pid[i_pmt_pid].pcr)
+                summary_pcr(fd, stream->pid[i_pmt_pid].pcr);
         }
 
         /* */
-        for (int i_pid = 0; i_pid < 8192; i_pid++)
+        for (unsigned int i = 0; i < stream->i_active; i++)
         {
+            int i_pid = stream->ai_active[i];
+            const ts_pid_hot_t *hot = ts_pid_hot_of(&stream->pid[i_pid]);
             if ((stream->pid[i_pid].pid_pmt == pmt->pid_pmt) &&
-                 stream->pid[i_pid].b_seen )
+                 hot->b_seen )
             {
                 fprintf(fd, "Found PID: %4d (0x%4x), DRM: %s,", i_pid, i_pid,
-                        (stream->pid[i_pid].i_transport_scrambling_control != 0x00) ? "yes" : " no" );
+                        (hot->i_transport_scrambling_control != 0x00) ? "yes" : " no" );
 
                 double bitrate = 0;
                 if ((end - start) > 0)
                 {
-                    bitrate = (double) (stream->pid[i_pid].i_packets * 188 * 8) /
+                    bitrate = (double) (hot->i_packets * 188 * 8) /
                               ((double)(end - start)/1000.0);
                 }
                 fprintf(fd, " bitrate %0.4f kbit/s,", bitrate);
                 fprintf(fd, " seen %"PRId64" packets",
-                        stream->pid[i_pid].i_packets);
+                        hot->i_packets);
                 fprintf(fd, "\n");
 
-                i_packets += stream->pid[i_pid].i_packets;
+                i_packets += hot->i_packets;
                 if (i_first_pcr == 0)
                     i_first_pcr = start;
                 else
@@ -557,6 +676,7 @@ static void summary(FILE *fd, ts_stream_t *stream)
         /* Next PMT */
         pmt = pmt->p_next;
     }
+    summary_tr290(fd, stream);
     fprintf(fd, "\n=========================================================\n");
 }
 
@@ -739,6 +859,14 @@ static void handle_subtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_e
     }
 }
 
+/* Count version changes of the tables decoded on a pid */
+static void ts_table_version(ts_pid_t *pid, const int i_version)
+{
+    if ((pid->i_tables++ > 0) && (pid->i_version != i_version))
+        pid->i_version_changes++;
+    pid->i_version = i_version;
+}
+
 /*****************************************************************************
  * handle_PAT
  *****************************************************************************/
@@ -748,6 +876,7 @@ static void handle_PAT(void* p_data, dvbpsi_pat_t* p_pat)
     ts_stream_t* p_stream = (ts_stream_t*) p_data;
 
     p_stream->pat.i_pat_version = p_pat->i_version;
+    ts_table_version(p_stream->pat.pid, p_pat->i_version);
     p_stream->pat.i_ts_id = p_pat->i_ts_id;
 
     printf("\n");
@@ -755,9 +884,10 @@ static void handle_PAT(void* p_data, dvbpsi_pat_t* p_pat)
     printf("\tTransport stream id : %d\n", p_pat->i_ts_id);
     printf("\tVersion number : %d\n", p_pat->i_version);
     printf("\tCurrent next   : %s\n", p_pat->b_current_next ? "yes" : "no");
-    if (p_stream->pat.pid->i_prev_received > 0)
+    const ts_pid_hot_t *hot = ts_pid_hot_of(p_stream->pat.pid);
+    if (hot->i_prev_received > 0)
         printf("\tLast received  : %"PRId64" ms ago\n",
-               (mtime_t)(p_stream->pat.pid->i_received - p_stream->pat.pid->i_prev_received));
+               (mtime_t)(hot->i_received - hot->i_prev_received));
     printf("\t\t| program_number @ [NIT|PMT]_PID\n");
     while (p_program)
     {
@@ -794,6 +924,12 @@ static void handle_PAT(void* p_data, dvbpsi_pat_t* p_pat)
             p_stream->pmt = p_pmt;
             p_stream->i_pmt++;
             assert(p_stream->pmt);
+
+            /* program 0 points at the NIT */
+            if ((p_program->i_number != 0) &&
+                !tr290_reference(p_stream->tr290, p_program->i_pid, true,
+                                 p_stream->i_psi_time))
+                fprintf(stderr, "dvbinfo: Failed to watch PMT PID %d\n", p_program->i_pid);
         }
         else
             fprintf(stderr, "dvbinfo: Failed create new PMT decoder\n");
@@ -2531,6 +2667,7 @@ static void handle_PMT(void* p_data, dvbpsi_pmt_t* p_pmt)
     assert(p);
 
     p->i_pmt_version = p_pmt->i_version;
+    ts_table_version(p->pid_pmt, p_pmt->i_version);
     p->pid_pcr = &p_stream->pid[p_pmt->i_pcr_pid];
     p_stream->pid[p_pmt->i_pcr_pid].b_pcr = true;
 
@@ -2545,6 +2682,8 @@ static void handle_PMT(void* p_data, dvbpsi_pmt_t* p_pmt)
     while(p_es)
     {
         p_stream->pid[p_es->i_pid].pid_pmt = p->pid_pmt;
+        if (!tr290_reference(p_stream->tr290, p_es->i_pid, false, p_stream->i_psi_time))
+            fprintf(stderr, "dvbinfo: Failed to watch elementary PID %d\n", p_es->i_pid);
         printf("\t| 0x%02x @ pid 0x%x (%d): %s\n",
                  p_es->i_type, p_es->i_pid, p_es->i_pid,
                  GetTypeName(p_es->i_type) );
@@ -2562,6 +2701,7 @@ static void handle_CAT(void *p_data, dvbpsi_cat_t *p_cat)
     ts_stream_t* p_stream = (ts_stream_t*) p_data;
 
     p_stream->cat.i_version = p_cat->i_version;
+    ts_table_version(p_stream->cat.pid, p_cat->i_version);
 
     printf("\n" );
     printf("  CAT: Conditional Access Table\n" );
@@ -2680,6 +2820,30 @@ ts_stream_t *libdvbpsi_init(int debug, ts_stream_log_cb pf_log, void *cb_data)
         stream->cb_data = cb_data;
     }
 
+    void *p_hot = NULL;
+    if (posix_memalign(&p_hot, sizeof(ts_pid_hot_t),
+                       (TS_HOT_SLOTS + 1) * sizeof(ts_pid_hot_t)) != 0)
+    {
+        free(stream);
+        return NULL;
+    }
+    memset(p_hot, 0, (TS_HOT_SLOTS + 1) * sizeof(ts_pid_hot_t));
+    stream->hot = (ts_pid_hot_t *)p_hot;
+
+    stream->headers.pi_offset = stream->ai_offset;
+    stream->headers.pi_pid = stream->ai_pid;
+    stream->headers.pi_flags = stream->ai_flags;
+    stream->headers.pi_cc = stream->ai_cc;
+    stream->headers.pi_payload = stream->ai_payload;
+
+    stream->tr290 = tr290_new(0);
+    if (stream->tr290 == NULL)
+    {
+        free(stream->hot);
+        free(stream);
+        return NULL;
+    }
+
     /* print PSI tables debug anyway, unless no debug is wanted at all */
     switch (debug)
     {
@@ -2806,11 +2970,21 @@ error:
     if (stream->atsc.handle)
         dvbpsi_delete(stream->atsc.handle);
 
+    tr290_delete(stream->tr290);
+    free(stream->hot);
     free(stream);
 
     return NULL;
 }
 
+void libdvbpsi_section_cache(ts_stream_t *stream, dvbpsi_section_cache_t *cache)
+{
+    /* SDT other, BAT and EIT other are the same on every transport stream of
+     * a network */
+    dvbpsi_section_cache_attach(stream->sdt.handle, cache);
+    dvbpsi_section_cache_attach(stream->eit.handle, cache);
+}
+
 void libdvbpsi_exit(ts_stream_t *stream)
 {
    summary(stdout, stream);
@@ -2879,273 +3053,1026 @@ void libdvbpsi_exit(ts_stream_t *stream)
    if (stream->atsc.handle)
        dvbpsi_delete(stream->atsc.handle);
 
+   for (unsigned int i = 0; i < stream->i_active; i++)
+   {
+       const uint16_t i_pid = stream->ai_active[i];
+       free(stream->pid[i_pid].pcr);
+       if ((stream->ai_slot[i_pid] == TS_SLOT_FAR) &&
+           (stream->pid[i_pid].hot != &stream->hot[0]))
+           free(stream->pid[i_pid].hot);
+   }
+   tr290_delete(stream->tr290);
+   free(stream->hot);
    free(stream);
    stream = NULL;
 }
 
-static ssize_t check_sync_word(uint8_t *buf, ssize_t length)
+/* Number of sync bytes at packet stride needed to (re)lock */
+#define TS_SYNC_HITS 3
+
+/* Move *pi to the next packet: keep the lattice while sync bytes show up,
+ * resync otherwise. Adds skipped bytes to *pi_lost, returns false when no
+ * whole packet is left in buf */
+static bool ts_sync_step(const uint8_t *buf, const size_t length, size_t *pi,
+                         unsigned int *pi_stride, uint64_t *pi_lost)
 {
-    ssize_t i_lost = 0;
+    size_t i = *pi;
 
-    for (i_lost = 0; i_lost < length; i_lost++)
+    /* Still aligned on the previous lattice? */
+    if ((*pi_stride == 0) || (buf[i] != 0x47))
     {
-        if (buf[i_lost] == 0x47)
-            break;
+        dvbpsi_ts_sync_t sync;
+
+        /* Ask for fewer hits when the buffer cannot hold them, eg. 188 byte reads */
+        unsigned int i_hits = TS_SYNC_HITS;
+        while ((i_hits > 1) && ((i_hits - 1) * 204 + 188 > length - i))
+            i_hits--;
+
+        if (!dvbpsi_ts_sync(&buf[i], length - i, i_hits, &sync))
+        {
+            *pi_stride = 0;
+            *pi_lost += length - i;
+            *pi = length;
+            return false;
+        }
+        *pi_stride = sync.i_stride;
+        *pi_lost += sync.i_lost;
+        i += sync.i_offset;
     }
 
-    if ((length - i_lost) < 188)
-        i_lost = length;
+    if (i + 188 > length)
+    {
+        /* truncated packet */
+        *pi_lost += length - i;
+        *pi = length;
+        return false;
+    }
+    *pi = i;
+    return true;
+}
 
-    return i_lost;
+/* PCR of a packet that carries one, 27 MHz */
+static inline int64_t ts_pcr_27(const uint8_t *p_tmp)
+{
+    int64_t i_base = ((int64_t)p_tmp[6] << 25) | ((int64_t)p_tmp[7] << 17) |
+                     ((int64_t)p_tmp[8] << 9) | ((int64_t)p_tmp[9] << 1) |
+                     ((int64_t)(p_tmp[10] & 0x80) >> 7);
+    return i_base * 300 + ((((int64_t)p_tmp[10] & 0x01) << 8) | p_tmp[11]);
 }
 
-bool libdvbpsi_process(ts_stream_t *stream, uint8_t *buf, ssize_t length, mtime_t date)
+/* Multiplex rate in bit/s between the first two PCRs of a PID in buf, 0 if
+ * there are none */
+static double ts_rate_probe(const uint8_t *buf, const size_t length, unsigned int i_stride)
 {
-    mtime_t  i_prev_pcr = 0;  /* 33 bits */
-    int      i_old_cc = -1;
+    pcr_t pcr;
+    int i_pcr_pid = -1;
+    size_t i = 0;
+    uint64_t i_lost = 0;
 
-    for (ssize_t i = 0; i < length; i += 188)
+    while ((i < length) && ts_sync_step(buf, length, &i, &i_stride, &i_lost))
     {
-        /* check sync */
-        ssize_t i_lost = check_sync_word(buf+i, length - i);
-        if (i_lost > 0)
+        const uint8_t *p_tmp = &buf[i];
+        const uint16_t i_pid = ((uint16_t)(p_tmp[1] & 0x1f) << 8) + p_tmp[2];
+        i += i_stride;
+
+        if (!(p_tmp[3] & 0x20) || (p_tmp[4] < 7) || !(p_tmp[5] & 0x10))
+            continue;
+        if (i_pcr_pid < 0)
         {
-            stream->i_lost_bytes += i_lost;
-            i += i_lost;
-            stream->pf_log(stream->cb_data, 0,
-                           "dvbinfo: %"PRId64": lost %"PRId64" bytes out of %"PRId64" in buffer\n",
-                           date, (int64_t) i_lost, (int64_t)length);
-            if (i >= length)
-                return true;
+            pcr_init(&pcr, i_pid);
+            i_pcr_pid = i_pid;
         }
+        else if (i_pid != i_pcr_pid)
+            continue;
 
-        assert(buf[i] == 0x47);
+        pcr_update(&pcr, ts_pcr_27(p_tmp), p_tmp - buf, 0, false);
+        double f_rate = pcr_rate(&pcr);
+        if (f_rate > 0.0)
+            return f_rate;
+    }
+    return 0.0;
+}
+
+/* Time in ns of the byte at i_position for the TR 101 290 checks: the
+ * capture time of the buffer, or for files the position at the multiplex
+ * rate. -1 if unknown. */
+static int64_t ts_byte_time(const ts_stream_t *stream, const uint64_t i_position)
+{
+    if (stream->i_arrival > 0)
+        return stream->i_arrival;
+    if (stream->f_ns_per_byte <= 0.0)
+        return -1;
+    return stream->i_clock_time +
+           (int64_t)((double)(i_position - stream->i_clock_bytes) * stream->f_ns_per_byte);
+}
+
+static inline int64_t ts_packet_time(const ts_stream_t *stream, const uint8_t *p_tmp)
+{
+    return ts_byte_time(stream, stream->i_bytes + (p_tmp - stream->p_buf));
+}
+
+/* File input has no capture times, take the rate the PCR analysis measured
+ * so far, or the one of the first PCRs in the buffer. Runs before a buffer
+ * is processed, the clock goes on from where the previous rate left it. */
+static void ts_clock_update(ts_stream_t *stream, const uint8_t *buf, const size_t length)
+{
+    if (stream->i_arrival > 0)
+        return;
+
+    double f_rate = 0.0;
+    for (unsigned int i = 0; (i < stream->i_active) && (f_rate <= 0.0); i++)
+    {
+        const pcr_t *pcr = stream->pid[stream->ai_active[i]].pcr;
+        if (pcr)
+            f_rate = pcr_rate(pcr);
+    }
+    if ((f_rate <= 0.0) && (stream->f_ns_per_byte <= 0.0))
+        f_rate = ts_rate_probe(buf, length, stream->i_stride);
+    if (f_rate <= 0.0)
+        return;
+
+    double f_ns_per_byte = 8000000000.0 / f_rate;
+    stream->i_clock_time = (stream->f_ns_per_byte > 0.0) ?
+                           ts_byte_time(stream, stream->i_bytes) :
+                           (int64_t)((double)stream->i_bytes * f_ns_per_byte);
+    stream->i_clock_bytes = stream->i_bytes;
+    stream->f_ns_per_byte = f_ns_per_byte;
+}
+
+/* TR 101 290 checks of the repetition of PSI and PIDs need a regular look,
+ * at most every TS_TICK ns of stream time */
+#define TS_TICK 100000000
+
+static void ts_tick(ts_stream_t *stream)
+{
+    int64_t i_time = ts_byte_time(stream, stream->i_bytes);
+    if ((i_time < 0) || (i_time < stream->i_tick))
+        return;
+    tr290_tick(stream->tr290, i_time);
+    stream->i_tick = i_time + TS_TICK;
+}
+
+/* Push packet k of headers into a PSI decoder, CRC_32 errors go to
+ * TR 101 290 */
+static void ts_psi_push(ts_stream_t *stream, dvbpsi_t *handle, const uint8_t *buf,
+                        const dvbpsi_ts_headers_t *headers, const size_t k)
+{
+    dvbpsi_errors_t before, after;
+
+    dvbpsi_errors_get(handle, &before);
+    dvbpsi_ts_packet_push(handle, buf, headers, k);
+    dvbpsi_errors_get(handle, &after);
+    tr290_report(stream->tr290, TR290_CRC_ERROR, stream->i_psi_time,
+                 after.i_crc_errors - before.i_crc_errors);
+}
+
+/* Hand packet k of headers to the PSI decoders listening on its PID, buf is
+ * the buffer the headers were decoded from */
+static void ts_packet_psi(ts_stream_t *stream, const uint8_t *buf,
+                          const dvbpsi_ts_headers_t *headers, const size_t k)
+{
+    const uint16_t i_pid = headers->pi_pid[k];
 
-        /* parse packet */
-        uint8_t  *p_tmp = &buf[i];
-        uint16_t i_pid = ((uint16_t)(p_tmp[1] & 0x1f) << 8) + p_tmp[2];
-        int      i_cc = (p_tmp[3] & 0x0f);
-        bool     b_discontinuity_seen = false;
-
-        /* keep track nr of packets for this ES */
-        stream->pid[i_pid].i_packets++;
-        stream->i_packets++;
-
-        /* received times */
-        stream->pid[i_pid].i_prev_received = stream->pid[i_pid].i_received;
-        stream->pid[i_pid].i_received = date;
-
-        if (stream->level < DVBPSI_MSG_DEBUG)
-            stream->pf_log(stream->cb_data, 3,
-                           "dvbinfo: %"PRId64" packet %"PRId64" pid %u (0x%x) cc %d\n",
-                           date, stream->i_packets, i_pid, i_pid, i_cc);
-
-        if (i_pid == 0x0) /* PAT */
-            dvbpsi_packet_push(stream->pat.handle, p_tmp);
-        else if (i_pid == 0x01) /* CAT */
-            dvbpsi_packet_push(stream->cat.handle, p_tmp);
-        else if (i_pid == 0x02) /* Transport Stream Description Table */
-            dvbpsi_packet_push(stream->tdt.handle, p_tmp);
+    stream->i_psi_time = ts_packet_time(stream, &buf[headers->pi_offset[k]]);
+
+    if (i_pid == 0x0) /* PAT */
+        ts_psi_push(stream, stream->pat.handle, buf, headers, k);
+    else if (i_pid == 0x01) /* CAT */
+        ts_psi_push(stream, stream->cat.handle, buf, headers, k);
+    else if (i_pid == 0x02) /* Transport Stream Description Table */
+        ts_psi_push(stream, stream->tdt.handle, buf, headers, k);
 #if 0
-        else if (i_pid == 0x03) /* IPMP Control Information Table */
-            dvbpsi_packet_push(stream->ipmp.handle, p_tmp);
+    else if (i_pid == 0x03) /* IPMP Control Information Table */
+        ts_psi_push(stream, stream->ipmp.handle, buf, headers, k);
 #endif
-        else if (i_pid == 0x11) /* SDT/BAT/NIT */
-            dvbpsi_packet_push(stream->sdt.handle, p_tmp);
-        else if (i_pid == 0x12) /* EIT */
-            dvbpsi_packet_push(stream->eit.handle, p_tmp);
-        else if (i_pid == 0x13) /* RST */
-            dvbpsi_packet_push(stream->rst.handle, p_tmp);
-        else if (i_pid == 0x14) /* TDT/TOT */
-            dvbpsi_packet_push(stream->tdt.handle, p_tmp);
-        else if (i_pid == 0x1FFB) /* ATSC tables */
-            dvbpsi_packet_push(stream->atsc.handle, p_tmp);
+    else if (i_pid == 0x11) /* SDT/BAT/NIT */
+        ts_psi_push(stream, stream->sdt.handle, buf, headers, k);
+    else if (i_pid == 0x12) /* EIT */
+        ts_psi_push(stream, stream->eit.handle, buf, headers, k);
+    else if (i_pid == 0x13) /* RST */
+        ts_psi_push(stream, stream->rst.handle, buf, headers, k);
+    else if (i_pid == 0x14) /* TDT/TOT */
+        ts_psi_push(stream, stream->tdt.handle, buf, headers, k);
+    else if (i_pid == 0x1FFB) /* ATSC tables */
+        ts_psi_push(stream, stream->atsc.handle, buf, headers, k);
+    else
+    {
+        ts_pmt_t *p = stream->pmt;
+        while(p)
+        {
+            if (p->pid_pmt->i_pid == i_pid)
+                ts_psi_push(stream, p->handle, buf, headers, k);
+            p = p->p_next;
+        }
+
+        ts_atsc_eit_t *p_atsc_eit = stream->atsc_eit;
+        while (p_atsc_eit)
+        {
+            if (p_atsc_eit->pid->i_pid == i_pid)
+                ts_psi_push(stream, p_atsc_eit->handle, buf, headers, k);
+            p_atsc_eit = p_atsc_eit->p_next;
+        }
+    }
+}
+
+/* Add a PID to the list of PIDs seen, kept sorted so walking it gives the
+ * same order as walking all 8192 */
+static void ts_pid_activate(ts_stream_t *stream, const uint16_t i_pid)
+{
+    ts_pid_t *pid = &stream->pid[i_pid];
+    if (pid->b_active)
+        return;
+
+    /* hot state in the next slot, or on its own past TS_HOT_SLOTS PIDs */
+    if (stream->i_slots < TS_HOT_SLOTS)
+    {
+        stream->ai_slot[i_pid] = ++stream->i_slots;
+        pid->hot = &stream->hot[stream->i_slots];
+    }
+    else
+    {
+        void *p_hot = NULL;
+        if (posix_memalign(&p_hot, sizeof(ts_pid_hot_t), sizeof(ts_pid_hot_t)) == 0)
+            memset(p_hot, 0, sizeof(ts_pid_hot_t));
         else
         {
-            ts_pmt_t *p = stream->pmt;
-            while(p)
+            /* counts of this PID end up mixed with other failed ones */
+            if (stream->pf_log)
+                stream->pf_log(stream->cb_data, 0,
+                               "dvbinfo: out of memory for pid %u statistics\n", i_pid);
+            p_hot = &stream->hot[0];
+        }
+        stream->ai_slot[i_pid] = TS_SLOT_FAR;
+        pid->hot = (ts_pid_hot_t *)p_hot;
+    }
+    pid->b_active = true;
+
+    unsigned int i = stream->i_active++;
+    for (; (i > 0) && (stream->ai_active[i - 1] > i_pid); i--)
+        stream->ai_active[i] = stream->ai_active[i - 1];
+    stream->ai_active[i] = i_pid;
+}
+
+/* Per PID accounting of a packet, only touches stream->pid[i_pid] */
+static void ts_packet_received(ts_stream_t *stream, const uint16_t i_pid, mtime_t date)
+{
+    ts_pid_hot_t *hot = ts_pid_hot(stream, i_pid);
+
+    /* keep track nr of packets for this ES */
+    hot->i_packets++;
+
+    /* received times */
+    hot->i_prev_received = hot->i_received;
+    hot->i_received = date;
+}
+
+/* Continuity counter, adaptation field and PCR of a packet, only touches
+ * stream->pid[i_pid] and may run concurrently for different PIDs */
+static void ts_packet_stats(ts_stream_t *stream, uint8_t *p_tmp, const uint16_t i_pid)
+{
+    ts_pid_hot_t *hot = ts_pid_hot(stream, i_pid);
+    ts_pid_t *pid = &stream->pid[i_pid];
+    mtime_t  i_prev_pcr = 0;  /* 33 bits */
+    int      i_old_cc = -1;
+    int      i_cc = (p_tmp[3] & 0x0f);
+    bool     b_discontinuity_seen = false;
+    int64_t  i_time = ts_packet_time(stream, p_tmp);
+
+    tr290_packet(stream->tr290, p_tmp, i_time);
+
+    /* Remember PID */
+    if (!hot->b_seen)
+    {
+        pid->i_pid = i_pid;
+        hot->b_seen = true;
+        i_old_cc = i_cc;
+        hot->i_cc = i_cc;
+    }
+    else
+    {
+        /* Check continuity counter */
+        int i_diff = 0;
+
+        i_diff = i_cc - (hot->i_cc+1)%16;
+        b_discontinuity_seen = (i_diff != 0);
+
+        /* Update CC */
+        i_old_cc = hot->i_cc;
+        hot->i_cc = i_cc;
+    }
+
+    if (i_pid == 0x1FFF)
+    {
+        /* NULL packet - skip it */
+        goto dump_packet;
+    }
+
+    /* */
+    hot->b_transport_error_indicator = ((p_tmp[1] & 0x80) == 0x80);
+    hot->b_payload_unit_start_indicator = ((p_tmp[1] & 0x40) == 0x40);
+    hot->b_transport_priority = ((p_tmp[1] & 0x20) == 0x20);
+    hot->i_transport_scrambling_control = ((p_tmp[3] & 0xC0) >> 6);
+    hot->b_adaptation_field = (p_tmp[3] & 0x20);
+
+    /* Handle discontinuities if they occurred,
+     * according to ISO/IEC 13818-1: DIS pages 20-22 */
+    if (hot->b_adaptation_field && (p_tmp[4] > 0))
+    {
+        bool b_pcr  = (p_tmp[5]&0x10) == 0x10;  /* PCR flag */
+        bool b_opcr = (p_tmp[5]&0x08) == 0x08;  /* OPCR flag */
+
+        hot->b_discontinuity_indicator = (p_tmp[5]&0x80) == 0x80;
+        hot->b_random_access_indicator = (p_tmp[5]&0x40) == 0x40;
+        pid->b_elementary_stream_priority_indicator = (p_tmp[5]&0x20) == 0x20;
+        pid->b_splicing_point = (p_tmp[5]&0x04) == 0x04;
+        pid->b_transport_private_data = (p_tmp[5]&0x02) == 0x02;
+        pid->b_adaptation_field_extension = (p_tmp[5]&0x01) == 0x01;
+
+        uint32_t i_ext = 5;
+
+        if (b_pcr) i_ext += 6;
+
+        /* PCR */
+        if (b_pcr && (p_tmp[4] >= 7))
+        {
+            int64_t i_pcr_27 = ts_pcr_27(p_tmp);
+            mtime_t i_pcr = i_pcr_27 / 300 * 100 / 9; /* 33 bits */
+            i_prev_pcr = hot->i_pcr;
+            hot->i_pcr = i_pcr;
+
+            if (pid->i_first_pcr == 0)
+                pid->i_first_pcr = i_pcr;
+            if (i_pcr < pid->i_last_pcr)
             {
-                if (p->pid_pmt->i_pid == i_pid)
-                    dvbpsi_packet_push(p->handle, p_tmp);
-                p = p->p_next;
+                if (b_discontinuity_seen)
+                    stream->pf_log(stream->cb_data, 2,
+                                   "dvbinfo: Warning wrapping PCR on discontinuity\n");
+                else
+                    stream->pf_log(stream->cb_data, 2,
+                                   "dvbinfo: Warning wrapping PCR\n");
             }
+            pid->i_prev_pcr = i_prev_pcr;
+            pid->i_last_pcr = i_pcr;
 
-            ts_atsc_eit_t *p_atsc_eit = stream->atsc_eit;
-            while (p_atsc_eit)
+            if (pid->pcr == NULL)
+            {
+                pid->pcr = (pcr_t *)malloc(sizeof(pcr_t));
+                if (pid->pcr)
+                {
+                    pcr_init(pid->pcr, i_pid);
+                    __atomic_add_fetch(&stream->i_pcrs, 1, __ATOMIC_RELAXED);
+                }
+            }
+            if (pid->pcr)
             {
-                if (p_atsc_eit->pid->i_pid == i_pid)
-                    dvbpsi_packet_push(p_atsc_eit->handle, p_tmp);
-                p_atsc_eit = p_atsc_eit->p_next;
+                pcr_t *pcr = pid->pcr;
+                uint64_t i_repetition = pcr->i_repetition_errors;
+                uint64_t i_discontinuity = pcr->i_discontinuity_errors;
+                uint64_t i_accuracy = pcr->i_accuracy_errors;
+
+                pcr_update(pcr, i_pcr_27, stream->i_bytes + (p_tmp - stream->p_buf),
+                           stream->i_arrival, hot->b_discontinuity_indicator);
+                tr290_report(stream->tr290, TR290_PCR_REPETITION_ERROR, i_time,
+                             pcr->i_repetition_errors - i_repetition);
+                tr290_report(stream->tr290, TR290_PCR_DISCONTINUITY_ERROR, i_time,
+                             pcr->i_discontinuity_errors - i_discontinuity);
+                tr290_report(stream->tr290, TR290_PCR_ACCURACY_ERROR, i_time,
+                             pcr->i_accuracy_errors - i_accuracy);
             }
-        }
 
-        /* Remember PID */
-        if (!stream->pid[i_pid].b_seen)
-        {
-            stream->pid[i_pid].i_pid = i_pid;
-            stream->pid[i_pid].b_seen = true;
-            i_old_cc = i_cc;
-            stream->pid[i_pid].i_cc = i_cc;
+            if (hot->b_discontinuity_indicator)
+            {
+                /* cc discontinuity is expected */
+                stream->pf_log(stream->cb_data, 2,
+                               "dvbinfo: Server signalled the continuity counter discontinuity\n");
+
+                /* Discontinuity has been handled */
+                b_discontinuity_seen = false;
+            }
         }
-        else
-        {
-            /* Check continuity counter */
-            int i_diff = 0;
 
-            i_diff = i_cc - (stream->pid[i_pid].i_cc+1)%16;
-            b_discontinuity_seen = (i_diff != 0);
+        if (b_opcr) i_ext += 6;
 
-            /* Update CC */
-            i_old_cc = stream->pid[i_pid].i_cc;
-            stream->pid[i_pid].i_cc = i_cc;
+        if (pid->b_splicing_point)
+        {
+            i_ext++;
+            /* calculate tcimsbf */
+            pid->i_splice_countdown = ((p_tmp[i_ext] & 0x80) == 0x80) ?
+                                    -1 * (p_tmp[i_ext] & 0x7f) : (p_tmp[i_ext] & 0x7f);
         }
 
-        if (i_pid == 0x1FFF)
+        if (pid->b_transport_private_data)
         {
-            stream->i_null_packets++;
-            /* NULL packet - skip it */
-            goto dump_packet;
+            i_ext++;
+            pid->i_transport_private_data_length = p_tmp[i_ext];
+            i_ext += pid->i_transport_private_data_length;
         }
 
-        /* */
-        stream->pid[i_pid].b_transport_error_indicator = ((p_tmp[1] & 0x80) == 0x80);
-        stream->pid[i_pid].b_payload_unit_start_indicator = ((p_tmp[1] & 0x40) == 0x40);
-        stream->pid[i_pid].b_transport_priority = ((p_tmp[1] & 0x20) == 0x20);
-        stream->pid[i_pid].i_transport_scrambling_control = ((p_tmp[3] & 0xC0) >> 6);
-        stream->pid[i_pid].b_adaptation_field = (p_tmp[3] & 0x20);
-
-        /* Handle discontinuities if they occurred,
-         * according to ISO/IEC 13818-1: DIS pages 20-22 */
-        if (stream->pid[i_pid].b_adaptation_field && (p_tmp[4] > 0))
+        if (pid->b_adaptation_field_extension)
         {
-            bool b_pcr  = (p_tmp[5]&0x10) == 0x10;  /* PCR flag */
-            bool b_opcr = (p_tmp[5]&0x08) == 0x08;  /* OPCR flag */
-
-            stream->pid[i_pid].b_discontinuity_indicator = (p_tmp[5]&0x80) == 0x80;
-            stream->pid[i_pid].b_random_access_indicator = (p_tmp[5]&0x40) == 0x40;
-            stream->pid[i_pid].b_elementary_stream_priority_indicator = (p_tmp[5]&0x20) == 0x20;
-            stream->pid[i_pid].b_splicing_point = (p_tmp[5]&0x04) == 0x04;
-            stream->pid[i_pid].b_transport_private_data = (p_tmp[5]&0x02) == 0x02;
-            stream->pid[i_pid].b_adaptation_field_extension = (p_tmp[5]&0x01) == 0x01;
+            /* i_ext is start of adaptation_extension field */
+            i_ext++;
+            uint8_t *p_ext = &p_tmp[i_ext];
+            uint32_t i_seamless_splice = i_ext;
 
-            uint32_t i_ext = 5;
+            pid->i_adaptation_field_extension_length = p_ext[0];
 
-            if (b_pcr) i_ext += 6;
-
-            /* PCR */
-            if (b_pcr && (p_tmp[4] >= 7))
+            if (pid->i_adaptation_field_extension_length > 0)
             {
-                mtime_t i_pcr;  /* 33 bits */
-
-                i_pcr = (( (mtime_t)p_tmp[6] << 25 ) |
-                         ( (mtime_t)p_tmp[7] << 17 ) |
-                         ( (mtime_t)p_tmp[8] << 9 ) |
-                         ( (mtime_t)p_tmp[9] << 1 ) |
-                         ( (mtime_t)(p_tmp[10]&0x80) >> 7 ));
-                i_pcr = i_pcr * 100 / 9;
-                i_prev_pcr = stream->pid[i_pid].i_pcr;
-                stream->pid[i_pid].i_pcr = i_pcr;
-
-                if (stream->pid[i_pid].i_first_pcr == 0)
-                    stream->pid[i_pid].i_first_pcr = i_pcr;
-                if (i_pcr < stream->pid[i_pid].i_last_pcr)
+                pid->b_ltw = (p_ext[1]&0x80) == 0x80;
+                pid->b_piecewise_rate = (p_ext[1]&0x40) == 0x40;
+                pid->b_seamless_splice = (p_ext[1]&0x20) == 0x20;
+
+                if (pid->b_ltw)
                 {
-                    if (b_discontinuity_seen)
-                        stream->pf_log(stream->cb_data, 2,
-                                       "dvbinfo: Warning wrapping PCR on discontinuity\n");
-                    else
-                        stream->pf_log(stream->cb_data, 2,
-                                       "dvbinfo: Warning wrapping PCR\n");
+                    pid->b_ltw_valid = ((p_ext[2]&0x80) == 0x80);
+                    pid->i_ltw_offset = ((uint16_t)p_ext[2]&0x7F);
+                    i_seamless_splice += 2;
                 }
-                stream->pid[i_pid].i_prev_pcr = i_prev_pcr;
-                stream->pid[i_pid].i_last_pcr = i_pcr;
 
-                if (stream->pid[i_pid].b_discontinuity_indicator)
+                if (pid->b_piecewise_rate)
                 {
-                    /* cc discontinuity is expected */
-                    stream->pf_log(stream->cb_data, 2,
-                                   "dvbinfo: Server signalled the continuity counter discontinuity\n");
+                    pid->i_piecewise_rate =
+                      (((uint32_t)p_ext[i_seamless_splice] & 0x3F) << 16) |
+                      (((uint32_t)p_ext[i_seamless_splice + 1]) << 8) |
+                       ((uint32_t)p_ext[i_seamless_splice + 2]);
+                    i_seamless_splice += 3;
+                }
 
-                    /* Discontinuity has been handled */
-                    b_discontinuity_seen = false;
+                if (pid->b_seamless_splice)
+                {
+                    pid->i_splice_type =
+                        (p_tmp[i_seamless_splice]&0xF0);
                 }
             }
+        } /* end of adaptation_extension_field */
+    }
 
-            if (b_opcr) i_ext += 6;
+    if (b_discontinuity_seen)
+    {
+        hot->i_cc_errors++;
+        stream->pf_log(stream->cb_data, 2,
+                       "dvbinfo: Continuity counter discontinuity (pid %u 0x%x found %d expected %d)\n",
+                       i_pid, i_pid, hot->i_cc, i_old_cc+1);
 
-            if (stream->pid[i_pid].b_splicing_point)
-            {
-                i_ext++;
-                /* calculate tcimsbf */
-                stream->pid[i_pid].i_splice_countdown = ((p_tmp[i_ext] & 0x80) == 0x80) ?
-                                        -1 * (p_tmp[i_ext] & 0x7f) : (p_tmp[i_ext] & 0x7f);
-            }
+        /* Discontinuity has been handled */
+        b_discontinuity_seen = false;
+    }
+
+dump_packet:
+    if (stream->level >= DVBPSI_MSG_DEBUG)
+    {
+        ts_dump_packet_details(stdout, stream, p_tmp, i_pid);
+    }
+}
+
+void libdvbpsi_arrival(ts_stream_t *stream, int64_t i_arrival)
+{
+    stream->i_arrival = i_arrival;
+}
+
+bool libdvbpsi_process(ts_stream_t *stream, uint8_t *buf, ssize_t length, mtime_t date)
+{
+    size_t i = 0;
+
+    stream->i_date = date;
+    stream->p_buf = buf;
+    ts_clock_update(stream, buf, length);
+    ts_tick(stream);
+
+    bool b_sync_loss = false;
+    while (i < (size_t)length)
+    {
+        /* check sync */
+        uint64_t i_lost = 0;
+        bool b_packet = ts_sync_step(buf, length, &i, &stream->i_stride, &i_lost);
+        if (i_lost > 0)
+        {
+            /* once per buffer, as for the parallel walk */
+            if (!b_sync_loss)
+                tr290_report(stream->tr290, TR290_SYNC_LOSS, ts_byte_time(stream, stream->i_bytes), 1);
+            b_sync_loss = true;
+            stream->i_lost_bytes += i_lost;
+            stream->pf_log(stream->cb_data, 0,
+                           "dvbinfo: %"PRId64": lost %"PRId64" bytes out of %"PRId64" in buffer\n",
+                           date, (int64_t) i_lost, (int64_t)length);
+        }
+        if (!b_packet)
+            break;
+
+        assert(buf[i] == 0x47);
+
+        /* parse the headers of the packets up to the next sync byte miss */
+        dvbpsi_ts_headers_t *headers = &stream->headers;
+        size_t i_count = dvbpsi_ts_headers_parse(&buf[i], length - i, stream->i_stride,
+                                                 TS_BATCH, headers);
+        assert(i_count > 0);
+
+        for (size_t k = 0; k < i_count; k++)
+        {
+            uint8_t  *p_tmp = &buf[i + headers->pi_offset[k]];
+            uint16_t i_pid = headers->pi_pid[k];
+
+            ts_pid_activate(stream, i_pid);
+            ts_packet_received(stream, i_pid, date);
+            stream->i_packets++;
+            if (i_pid == 0x1FFF)
+                stream->i_null_packets++;
+
+            if (stream->level < DVBPSI_MSG_DEBUG)
+                stream->pf_log(stream->cb_data, 3,
+                               "dvbinfo: %"PRId64" packet %"PRId64" pid %u (0x%x) cc %d\n",
+                               date, stream->i_packets, i_pid, i_pid, headers->pi_cc[k]);
+
+            ts_packet_psi(stream, &buf[i], headers, k);
+            ts_packet_stats(stream, p_tmp, i_pid);
+        }
+        i += i_count * stream->i_stride;
+    }
+
+    stream->i_bytes += length;
+    return true;
+}
+
+/*****************************************************************************
+ * libdvbpsi_process_parallel
+ *****************************************************************************
+ * The buffer is processed in four phases:
+ * 1. each job finds the packets starting in its slice of the buffer,
+ * 2. each job scatters its packets into per PID lists (file order kept),
+ * 3. one thread runs the PSI PIDs in file order through the decoders,
+ *    PIDs announced by a PAT or MGT on the way join this pass,
+ * 4. the remaining PIDs are split over the jobs, each PID owned by one job.
+ * PSI callbacks may look at any stream->pid[] entry so phases 3 and 4 do not
+ * overlap. Per PID state is updated in file order, so the outcome matches
+ * libdvbpsi_process() whatever the number of jobs; only the order of log
+ * lines from phase 4 differs.
+ *****************************************************************************/
+#define TS_MAX_JOBS 64
+
+typedef struct
+{
+    ts_stream_t  *stream;
+    uint8_t      *buf;
+    size_t        i_length;
+    size_t        i_start;  /* slice owned by this job */
+    size_t        i_end;
+    mtime_t       date;
+
+    /* phase 1 */
+    uint32_t     *p_offsets;    /* packet offsets in buf */
+    uint16_t     *p_strides;    /* lattice stride when the packet was taken */
+    uint64_t     *p_lost;       /* i_lost when the packet was taken */
+    size_t        i_packets;
+    size_t        i_next;       /* walk position after the slice */
+    unsigned int  i_stride;     /* lattice stride at start, then after the slice */
+    uint64_t      i_lost;       /* bytes skipped by the walk */
+    bool          b_done;       /* no packet left in buf after this slice */
+    uint32_t      ai_count[8192];
+
+    /* phase 2 */
+    uint32_t     *p_pid_offsets;    /* offsets grouped by PID */
+    const size_t *pi_base;          /* per PID start in p_pid_offsets */
+
+    /* phase 4 */
+    uint16_t     *p_pids;           /* PIDs owned by this job */
+    size_t        i_pids;
+    uint64_t      i_load;
+} ts_job_t;
+
+static size_t ts_packet_pid(const uint8_t *p)
+{
+    return ((size_t)(p[1] & 0x1f) << 8) + p[2];
+}
+
+/* Phase 1: walk the slice like libdvbpsi_process() would, had it been in
+ * state (i_start, i_stride) there */
+static void ts_job_walk(ts_job_t *job, size_t i, unsigned int i_stride)
+{
+    job->i_packets = 0;
+    job->i_lost = 0;
+    job->b_done = false;
+    memset(job->ai_count, 0, sizeof(job->ai_count));
+
+    while (i < job->i_end)
+    {
+        if (!ts_sync_step(job->buf, job->i_length, &i, &i_stride, &job->i_lost))
+        {
+            job->b_done = true;
+            break;
+        }
+        if (i >= job->i_end) /* resynced past the slice */
+            break;
+
+        job->p_offsets[job->i_packets] = (uint32_t)i;
+        job->p_strides[job->i_packets] = (uint16_t)i_stride;
+        job->p_lost[job->i_packets] = job->i_lost;
+        job->i_packets++;
+        job->ai_count[ts_packet_pid(&job->buf[i])]++;
+        i += i_stride;
+    }
+    job->i_next = i;
+    job->i_stride = i_stride;
+}
+
+static void *ts_job_scan(void *data)
+{
+    ts_job_t *job = (ts_job_t *)data;
+    ts_job_walk(job, job->i_start, job->i_stride);
+    return NULL;
+}
+
+/* Phase 1, serial: a job other than the first guessed how the walk
+ * enters its slice. Walk again from where the previous job really left,
+ * until meeting a packet the job took with the same stride: from there on
+ * both walks are the same. p_tmp has room for the slice's packets. */
+static void ts_job_fixup(ts_job_t *job, const ts_job_t *prev, uint32_t *p_tmp)
+{
+    size_t i = prev->i_next;
+    unsigned int i_stride = prev->i_stride;
+    uint64_t i_lost = 0;
+    size_t i_new = 0, k = 0;
+
+    if (prev->b_done)
+    {
+        /* the previous walk accounted for the rest of buf */
+        job->i_packets = 0;
+        job->i_lost = 0;
+        job->b_done = true;
+        job->i_next = i;
+        job->i_stride = i_stride;
+        return;
+    }
+
+    while (i < job->i_end)
+    {
+        if (!ts_sync_step(job->buf, job->i_length, &i, &i_stride, &i_lost))
+        {
+            job->b_done = true;
+            break;
+        }
+        if (i >= job->i_end)
+            break;
+
+        while ((k < job->i_packets) && (job->p_offsets[k] < i))
+            k++;
+        if ((k < job->i_packets) && (job->p_offsets[k] == i) &&
+            (job->p_strides[k] == i_stride))
+        {
+            /* converged: keep the job's packets from k on */
+            for (size_t n = 0; n < k; n++)
+                job->ai_count[ts_packet_pid(&job->buf[job->p_offsets[n]])]--;
+            for (size_t n = 0; n < i_new; n++)
+                job->ai_count[ts_packet_pid(&job->buf[p_tmp[n]])]++;
+            job->i_lost = i_lost + job->i_lost - job->p_lost[k];
+            memmove(&job->p_offsets[i_new], &job->p_offsets[k],
+                    (job->i_packets - k) * sizeof(uint32_t));
+            memcpy(job->p_offsets, p_tmp, i_new * sizeof(uint32_t));
+            job->i_packets = i_new + job->i_packets - k;
+            return;
+        }
+        p_tmp[i_new++] = (uint32_t)i;
+        i += i_stride;
+    }
+
+    /* left the slice without meeting the job's walk */
+    memset(job->ai_count, 0, sizeof(job->ai_count));
+    for (size_t n = 0; n < i_new; n++)
+        job->ai_count[ts_packet_pid(&job->buf[p_tmp[n]])]++;
+    memcpy(job->p_offsets, p_tmp, i_new * sizeof(uint32_t));
+    job->i_packets = i_new;
+    job->i_lost = i_lost;
+    job->i_next = i;
+    job->i_stride = i_stride;
+}
+
+/* Phase 2: copy the offsets into their PID list */
+static void *ts_job_scatter(void *data)
+{
+    ts_job_t *job = (ts_job_t *)data;
+    size_t ai_pos[8192];
+
+    memcpy(ai_pos, job->pi_base, sizeof(ai_pos));
+    for (size_t i = 0; i < job->i_packets; i++)
+    {
+        size_t i_pid = ts_packet_pid(&job->buf[job->p_offsets[i]]);
+        job->p_pid_offsets[ai_pos[i_pid]++] = job->p_offsets[i];
+    }
+    return NULL;
+}
+
+/* Phase 4: accounting of the PIDs owned by this job */
+static void *ts_job_stats(void *data)
+{
+    ts_job_t *job = (ts_job_t *)data;
+
+    for (size_t p = 0; p < job->i_pids; p++)
+    {
+        uint16_t i_pid = job->p_pids[p];
+        for (size_t i = job->pi_base[i_pid]; i < job->pi_base[i_pid + 1]; i++)
+        {
+            uint8_t *p_tmp = &job->buf[job->p_pid_offsets[i]];
+            ts_packet_received(job->stream, i_pid, job->date);
+            ts_packet_stats(job->stream, p_tmp, i_pid);
+        }
+    }
+    return NULL;
+}
+
+static bool ts_jobs_run(ts_job_t *jobs, unsigned int i_jobs, void *(*pf_run)(void *))
+{
+    pthread_t threads[TS_MAX_JOBS];
+    unsigned int i_started = 1;
+    bool b_ok = true;
+
+    /* job 0 runs on the calling thread */
+    for (; i_started < i_jobs; i_started++)
+    {
+        if (pthread_create(&threads[i_started], NULL, pf_run, &jobs[i_started]) != 0)
+            break;
+    }
+    pf_run(&jobs[0]);
+    /* jobs that did not get a thread run here */
+    for (unsigned int i = i_started; i < i_jobs; i++)
+        pf_run(&jobs[i]);
+    for (unsigned int i = 1; i < i_started; i++)
+    {
+        if (pthread_join(threads[i], NULL) != 0)
+            b_ok = false;
+    }
+    return b_ok;
+}
+
+/* Mark PIDs the PSI decoders listen on, returns true if any was new */
+static bool ts_psi_pids_update(ts_stream_t *stream)
+{
+    bool b_new = false;
+
+    for (ts_pmt_t *p = stream->pmt; p != NULL; p = p->p_next)
+    {
+        if (!p->pid_pmt->b_psi)
+            b_new = p->pid_pmt->b_psi = true;
+    }
+    for (ts_atsc_eit_t *p = stream->atsc_eit; p != NULL; p = p->p_next)
+    {
+        if (!p->pid->b_psi)
+            b_new = p->pid->b_psi = true;
+    }
+    return b_new;
+}
+
+/* Phase 3: PSI PIDs in file order, as libdvbpsi_process() would */
+static void ts_psi_pass(ts_stream_t *stream, uint8_t *buf, const uint32_t *p_pid_offsets,
+                        const size_t *pi_base, mtime_t date)
+{
+    size_t ai_cursor[8192];
+    uint16_t ai_pids[8192];
+    size_t i_pids = 0;
+    int i_pmt = -1, i_atsc_eit = -1;
 
-            if (stream->pid[i_pid].b_transport_private_data)
+    for (;;)
+    {
+        /* a new PMT or ATSC EIT decoder: pick up its PID from the packet
+         * after the current one on, earlier packets only get accounted */
+        if ((stream->i_pmt != i_pmt) || (stream->i_atsc_eit != i_atsc_eit))
+        {
+            uint32_t i_now = 0;
+            for (size_t k = 0; k < i_pids; k++)
             {
-                i_ext++;
-                stream->pid[i_pid].i_transport_private_data_length = p_tmp[i_ext];
-                i_ext += stream->pid[i_pid].i_transport_private_data_length;
+                uint16_t i_pid = ai_pids[k];
+                if (ai_cursor[i_pid] > pi_base[i_pid])
+                {
+                    uint32_t i_last = p_pid_offsets[ai_cursor[i_pid] - 1];
+                    if (i_last > i_now)
+                        i_now = i_last;
+                }
             }
 
-            if (stream->pid[i_pid].b_adaptation_field_extension)
+            i_pmt = stream->i_pmt;
+            i_atsc_eit = stream->i_atsc_eit;
+            ts_psi_pids_update(stream);
+            for (size_t i_pid = 0; i_pid < 8192; i_pid++)
             {
-                /* i_ext is start of adaptation_extension field */
-                i_ext++;
-                uint8_t *p_ext = &p_tmp[i_ext];
-                uint32_t i_seamless_splice = i_ext;
-
-                stream->pid[i_pid].i_adaptation_field_extension_length = p_ext[0];
-
-                if (stream->pid[i_pid].i_adaptation_field_extension_length > 0)
+                if (!stream->pid[i_pid].b_psi || (pi_base[i_pid] == pi_base[i_pid + 1]))
+                    continue;
+                bool b_known = false;
+                for (size_t k = 0; (k < i_pids) && !b_known; k++)
+                    b_known = (ai_pids[k] == i_pid);
+                if (b_known)
+                    continue;
+
+                size_t i = pi_base[i_pid];
+                for (; (i < pi_base[i_pid + 1]) && (p_pid_offsets[i] < i_now); i++)
                 {
-                    stream->pid[i_pid].b_ltw = (p_ext[1]&0x80) == 0x80;
-                    stream->pid[i_pid].b_piecewise_rate = (p_ext[1]&0x40) == 0x40;
-                    stream->pid[i_pid].b_seamless_splice = (p_ext[1]&0x20) == 0x20;
-
-                    if (stream->pid[i_pid].b_ltw)
-                    {
-                        stream->pid[i_pid].b_ltw_valid = ((p_ext[2]&0x80) == 0x80);
-                        stream->pid[i_pid].i_ltw_offset = ((uint16_t)p_ext[2]&0x7F);
-                        i_seamless_splice += 2;
-                    }
-
-                    if (stream->pid[i_pid].b_piecewise_rate)
-                    {
-                        stream->pid[i_pid].i_piecewise_rate =
-                          (((uint32_t)p_ext[i_seamless_splice] & 0x3F) << 16) |
-                          (((uint32_t)p_ext[i_seamless_splice + 1]) << 8) |
-                           ((uint32_t)p_ext[i_seamless_splice + 2]);
-                        i_seamless_splice += 3;
-                    }
-
-                    if (stream->pid[i_pid].b_seamless_splice)
-                    {
-                        stream->pid[i_pid].i_splice_type =
-                            (p_tmp[i_seamless_splice]&0xF0);
-                    }
+                    ts_packet_received(stream, i_pid, date);
+                    ts_packet_stats(stream, &buf[p_pid_offsets[i]], i_pid);
                 }
-            } /* end of adaptation_extension_field */
+                ai_cursor[i_pid] = i;
+                ai_pids[i_pids++] = i_pid;
+            }
         }
 
-        if (b_discontinuity_seen)
+        /* next packet in file order */
+        size_t i_best = 0;
+        uint32_t i_offset = UINT32_MAX;
+        for (size_t k = 0; k < i_pids; k++)
         {
-            stream->pf_log(stream->cb_data, 2,
-                           "dvbinfo: Continuity counter discontinuity (pid %u 0x%x found %d expected %d)\n",
-                           i_pid, i_pid, stream->pid[i_pid].i_cc, i_old_cc+1);
-
-            /* Discontinuity has been handled */
-            b_discontinuity_seen = false;
+            uint16_t i_pid = ai_pids[k];
+            if ((ai_cursor[i_pid] < pi_base[i_pid + 1]) &&
+                (p_pid_offsets[ai_cursor[i_pid]] < i_offset))
+            {
+                i_offset = p_pid_offsets[ai_cursor[i_pid]];
+                i_best = i_pid;
+            }
         }
+        if (i_offset == UINT32_MAX)
+            break;
 
-dump_packet:
-        if (stream->level >= DVBPSI_MSG_DEBUG)
+        ai_cursor[i_best]++;
+        ts_packet_received(stream, i_best, date);
+        dvbpsi_ts_headers_parse(&buf[i_offset], DVBPSI_TS_PACKET_SIZE, DVBPSI_TS_PACKET_SIZE,
+                                1, &stream->headers);
+        ts_packet_psi(stream, &buf[i_offset], &stream->headers, 0);
+        ts_packet_stats(stream, &buf[i_offset], i_best);
+    }
+}
+
+bool libdvbpsi_process_parallel(ts_stream_t *stream, uint8_t *buf, ssize_t length,
+                                mtime_t date, unsigned int jobs)
+{
+    /* per packet debug output must stay in order */
+    if ((jobs <= 1) || (stream->level >= DVBPSI_MSG_DEBUG) ||
+        (length < 188) || ((uint64_t)length > UINT32_MAX))
+        return libdvbpsi_process(stream, buf, length, date);
+    if (jobs > TS_MAX_JOBS)
+        jobs = TS_MAX_JOBS;
+
+    size_t i_length = (size_t)length;
+    size_t i_max_packets = i_length / 188 + 1;
+    bool b_ok = false;
+
+    stream->i_date = date;
+    stream->p_buf = buf;
+    ts_clock_update(stream, buf, i_length);
+    ts_tick(stream);
+
+    /* PIDs that always carry PSI */
+    for (uint16_t i_pid = 0x00; i_pid <= 0x1F; i_pid++)
+        stream->pid[i_pid].b_psi = true;
+    stream->pid[0x1FFB].b_psi = true;
+
+    ts_job_t *p_jobs = (ts_job_t *)calloc(jobs, sizeof(ts_job_t));
+    size_t *pi_base = (size_t *)malloc(8193 * sizeof(size_t));
+    uint32_t *p_pid_offsets = (uint32_t *)malloc(i_max_packets * sizeof(uint32_t));
+    uint16_t *p_pids = (uint16_t *)malloc(8192 * sizeof(uint16_t));
+    if (!p_jobs || !pi_base || !p_pid_offsets || !p_pids)
+        goto out;
+
+    /* Phase 1: slices on packet boundaries of an aligned buffer */
+    size_t i_slice = (i_length / jobs + 187) / 188 * 188;
+    for (unsigned int j = 0; j < jobs; j++)
+    {
+        ts_job_t *job = &p_jobs[j];
+        job->stream = stream;
+        job->buf = buf;
+        job->i_length = i_length;
+        job->date = date;
+        job->i_start = (j * i_slice < i_length) ? j * i_slice : i_length;
+        job->i_end = ((j + 1) * i_slice < i_length) ? (j + 1) * i_slice : i_length;
+        size_t i_room = (job->i_end - job->i_start) / 188 + 2;
+        job->p_offsets = (uint32_t *)malloc(i_room * sizeof(uint32_t));
+        job->p_strides = (uint16_t *)malloc(i_room * sizeof(uint16_t));
+        job->p_lost = (uint64_t *)malloc(i_room * sizeof(uint64_t));
+        if (!job->p_offsets || !job->p_strides || !job->p_lost)
+            goto out;
+    }
+    /* the first job continues on the lattice of the previous buffer,
+     * the others guess and get fixed up in order afterwards */
+    p_jobs[0].i_stride = stream->i_stride;
+    if (!ts_jobs_run(p_jobs, jobs, ts_job_scan))
+        goto out;
+    uint32_t *p_tmp = (uint32_t *)malloc((i_slice / 188 + 2) * sizeof(uint32_t));
+    if (p_tmp == NULL)
+        goto out;
+    uint64_t i_lost = p_jobs[0].i_lost;
+    for (unsigned int j = 1; j < jobs; j++)
+    {
+        ts_job_fixup(&p_jobs[j], &p_jobs[j - 1], p_tmp);
+        i_lost += p_jobs[j].i_lost;
+    }
+    free(p_tmp);
+    stream->i_stride = p_jobs[jobs - 1].i_stride;
+    if (i_lost > 0)
+    {
+        tr290_report(stream->tr290, TR290_SYNC_LOSS, ts_byte_time(stream, stream->i_bytes), 1);
+        stream->i_lost_bytes += i_lost;
+        stream->pf_log(stream->cb_data, 0,
+                       "dvbinfo: %"PRId64": lost %"PRId64" bytes out of %"PRId64" in buffer\n",
+                       date, (int64_t) i_lost, (int64_t)length);
+    }
+
+    /* Phase 2: per PID lists, job order is file order */
+    size_t i_total = 0;
+    for (size_t i_pid = 0; i_pid < 8192; i_pid++)
+    {
+        pi_base[i_pid] = i_total;
+        for (unsigned int j = 0; j < jobs; j++)
+            i_total += p_jobs[j].ai_count[i_pid];
+    }
+    pi_base[8192] = i_total;
+    for (size_t i_pid = 0; i_pid < 8192; i_pid++)
+    {
+        if (pi_base[i_pid + 1] > pi_base[i_pid])
+            ts_pid_activate(stream, i_pid);
+    }
+
+    size_t *p_job_base = (size_t *)malloc(jobs * 8192 * sizeof(size_t));
+    if (p_job_base == NULL)
+        goto out;
+    for (size_t i_pid = 0; i_pid < 8192; i_pid++)
+    {
+        size_t i_pos = pi_base[i_pid];
+        for (unsigned int j = 0; j < jobs; j++)
         {
-            ts_dump_packet_details(stdout, stream, &buf[i], i_pid);
+            p_job_base[j * 8192 + i_pid] = i_pos;
+            i_pos += p_jobs[j].ai_count[i_pid];
         }
     }
+    for (unsigned int j = 0; j < jobs; j++)
+    {
+        p_jobs[j].p_pid_offsets = p_pid_offsets;
+        p_jobs[j].pi_base = &p_job_base[j * 8192];
+    }
+    b_ok = ts_jobs_run(p_jobs, jobs, ts_job_scatter);
+    free(p_job_base);
+    if (!b_ok)
+        goto out;
+    b_ok = false;
+
+    /* Phase 3 */
+    for (unsigned int j = 0; j < jobs; j++)
+        p_jobs[j].pi_base = pi_base;
+    ts_psi_pass(stream, buf, p_pid_offsets, pi_base, date);
+
+    /* Phase 4: biggest PIDs first, each to the least loaded job */
+    size_t i_pids = 0;
+    for (size_t i_pid = 0; i_pid < 8192; i_pid++)
+    {
+        if (!stream->pid[i_pid].b_psi && (pi_base[i_pid + 1] > pi_base[i_pid]))
+            p_pids[i_pids++] = i_pid;
+    }
+    for (size_t i = 1; i < i_pids; i++) /* insertion sort, stable */
+    {
+        uint16_t i_pid = p_pids[i];
+        size_t i_count = pi_base[i_pid + 1] - pi_base[i_pid];
+        size_t k = i;
+        for (; (k > 0) && (pi_base[p_pids[k - 1] + 1] - pi_base[p_pids[k - 1]] < i_count); k--)
+            p_pids[k] = p_pids[k - 1];
+        p_pids[k] = i_pid;
+    }
+    uint16_t *p_owned = (uint16_t *)malloc(jobs * 8192 * sizeof(uint16_t));
+    if (p_owned == NULL)
+        goto out;
+    for (unsigned int j = 0; j < jobs; j++)
+    {
+        p_jobs[j].p_pids = &p_owned[j * 8192];
+        p_jobs[j].i_pids = 0;
+        p_jobs[j].i_load = 0;
+    }
+    for (size_t i = 0; i < i_pids; i++)
+    {
+        unsigned int i_min = 0;
+        for (unsigned int j = 1; j < jobs; j++)
+        {
+            if (p_jobs[j].i_load < p_jobs[i_min].i_load)
+                i_min = j;
+        }
+        ts_job_t *job = &p_jobs[i_min];
+        job->p_pids[job->i_pids++] = p_pids[i];
+        job->i_load += pi_base[p_pids[i] + 1] - pi_base[p_pids[i]];
+    }
+    b_ok = ts_jobs_run(p_jobs, jobs, ts_job_stats);
+    free(p_owned);
 
-    return true;
+    stream->i_packets += i_total;
+    stream->i_null_packets += pi_base[0x1FFF + 1] - pi_base[0x1FFF];
+
+out:
+    if (p_jobs)
+    {
+        for (unsigned int j = 0; j < jobs; j++)
+        {
+            free(p_jobs[j].p_offsets);
+            free(p_jobs[j].p_strides);
+            free(p_jobs[j].p_lost);
+        }
+    }
+    free(p_jobs);
+    free(pi_base);
+    free(p_pid_offsets);
+    free(p_pids);
+    stream->i_bytes += i_length;
+    return b_ok;
 }
 
 void libdvbpsi_summary(FILE *fd, ts_stream_t *stream, const int summary_mode)
@@ -3169,3 +4096,91 @@ void libdvbpsi_summary(FILE *fd, ts_stream_t *stream, const int summary_mode)
             break;
     }
 }
+
+/*****************************************************************************
+ * Metrics
+ *****************************************************************************/
+ts_metrics_t *libdvbpsi_metrics_new(void)
+{
+    return (ts_metrics_t *)calloc(1, sizeof(ts_metrics_t));
+}
+
+void libdvbpsi_metrics_delete(ts_metrics_t *metrics)
+{
+    if (metrics)
+    {
+        free(metrics->p_pids);
+        free(metrics->p_pcrs);
+        free(metrics->p_tr290);
+    }
+    free(metrics);
+}
+
+bool libdvbpsi_metrics(ts_stream_t *stream, ts_metrics_t *metrics)
+{
+    if (metrics->i_max < stream->i_active)
+    {
+        ts_pid_metrics_t *p_pids = (ts_pid_metrics_t *)realloc(metrics->p_pids,
+                                        stream->i_active * sizeof(ts_pid_metrics_t));
+        if (p_pids == NULL)
+            return false;
+        metrics->p_pids = p_pids;
+        metrics->i_max = stream->i_active;
+    }
+    if (metrics->i_pcr_max < stream->i_pcrs)
+    {
+        pcr_t *p_pcrs = (pcr_t *)realloc(metrics->p_pcrs, stream->i_pcrs * sizeof(pcr_t));
+        if (p_pcrs == NULL)
+            return false;
+        metrics->p_pcrs = p_pcrs;
+        metrics->i_pcr_max = stream->i_pcrs;
+    }
+    if (metrics->p_tr290 == NULL)
+    {
+        metrics->p_tr290 = (tr290_counter_t *)malloc(TR290_CHECKS * sizeof(tr290_counter_t));
+        if (metrics->p_tr290 == NULL)
+            return false;
+    }
+    tr290_get(stream->tr290, metrics->p_tr290);
+
+    metrics->i_date = stream->i_date;
+    metrics->i_packets = stream->i_packets;
+    metrics->i_null_packets = stream->i_null_packets;
+    metrics->i_lost_bytes = stream->i_lost_bytes;
+    metrics->i_pids = stream->i_active;
+    metrics->i_pcrs = 0;
+
+    for (unsigned int i = 0; i < stream->i_active; i++)
+    {
+        ts_pid_t *pid = &stream->pid[stream->ai_active[i]];
+        ts_pid_metrics_t *p = &metrics->p_pids[i];
+
+        p->i_pid = stream->ai_active[i];
+        p->i_pmt_pid = pid->pid_pmt ? pid->pid_pmt->i_pid : 0;
+        p->b_scrambled = (pid->hot->i_transport_scrambling_control != 0x00);
+        p->i_packets = pid->hot->i_packets;
+        p->i_cc_errors = pid->hot->i_cc_errors;
+        p->i_version_changes = pid->i_version_changes;
+        p->i_pcr_interval_max = 0;
+        p->i_pcr_jitter_max = 0;
+        if (pid->pcr && (metrics->i_pcrs < metrics->i_pcr_max))
+        {
+            p->i_pcr_interval_max = pid->pcr->interval.i_max / 1000;
+            p->i_pcr_jitter_max = pid->pcr->jitter.i_max / 1000;
+            metrics->p_pcrs[metrics->i_pcrs++] = *pid->pcr;
+        }
+
+        /* same as the bandwidth summary: over the PCR span of the program */
+        p->f_bitrate = 0;
+        for (ts_pmt_t *pmt = stream->pmt; pid->pid_pmt && pmt; pmt = pmt->p_next)
+        {
+            if ((pmt->pid_pmt != pid->pid_pmt) || !pmt->pid_pcr || !pmt->pid_pcr->b_pcr)
+                continue;
+            mtime_t i_span = pmt->pid_pcr->i_last_pcr - pmt->pid_pcr->i_first_pcr;
+            if (i_span > 0)
+                p->f_bitrate = (double)(pid->hot->i_packets * 188 * 8) / ((double)i_span / 1000000.0);
+            break;
+        }
+    }
+    return true;
+}
@@ -34,6 +34,8 @@ mtime_t mdate(void);
 #define SUM_TABLE     1
 #define SUM_PACKET    2
 #define SUM_WIRE      3
+#define SUM_JSON      4 /* metrics snapshot, see metrics.h */
+#define SUM_OPENMETRICS 5
 
 /* MPEG-TS PSI decoders */
 typedef struct ts_stream_t ts_stream_t;
@@ -42,7 +44,53 @@ typedef void (* ts_stream_log_cb)(void *data, const int level, const char *msg,
 /* */
 ts_stream_t *libdvbpsi_init(int debug, ts_stream_log_cb pf_log, void *cb_data);
 bool libdvbpsi_process(ts_stream_t *stream, uint8_t *buf, ssize_t length, mtime_t date);
+/* Capture time in ns of the buffers that follow, 0 when the date is not a
+ * capture time; PCR jitter is measured against it */
+void libdvbpsi_arrival(ts_stream_t *stream, int64_t i_arrival);
+/* Same result as libdvbpsi_process(), with the PIDs of buf spread over jobs threads */
+bool libdvbpsi_process_parallel(ts_stream_t *stream, uint8_t *buf, ssize_t length,
+                                mtime_t date, unsigned int jobs);
 void libdvbpsi_summary(FILE *fd, ts_stream_t *stream, const int summary_mode);
+
+/* Metrics snapshot: counters of the PIDs seen so far, in PID order */
+typedef struct ts_pid_metrics_s
+{
+    uint16_t i_pid;
+    uint16_t i_pmt_pid;         /* PMT listing this PID, 0 if none */
+    bool     b_scrambled;
+    uint64_t i_packets;
+    uint64_t i_cc_errors;       /* continuity counter errors */
+    uint64_t i_version_changes; /* PAT, PMT or CAT version changes on this PID */
+    double   f_bitrate;         /* bit/s over the PCR span of its program, 0 if unknown */
+    mtime_t  i_pcr_interval_max;/* us between two PCRs, 0 if no PCR */
+    mtime_t  i_pcr_jitter_max;  /* us, PCR overall jitter */
+} ts_pid_metrics_t;
+
+typedef struct ts_metrics_s
+{
+    mtime_t  i_date;            /* date of the last buffer processed */
+    uint64_t i_packets;
+    uint64_t i_null_packets;
+    uint64_t i_lost_bytes;
+    unsigned int i_pids;
+    unsigned int i_max;         /* room in p_pids */
+    ts_pid_metrics_t *p_pids;
+    unsigned int i_pcrs;        /* PCR analysis of the PCR PIDs, see pcr.h */
+    unsigned int i_pcr_max;
+    struct pcr_s *p_pcrs;
+    struct tr290_counter_s *p_tr290; /* TR290_CHECKS counters, see tr290.h */
+} ts_metrics_t;
+
+/* libdvbpsi_metrics() fills metrics from the stream, growing p_pids as
+ * needed, in time proportional to the number of PIDs seen */
+ts_metrics_t *libdvbpsi_metrics_new(void);
+bool libdvbpsi_metrics(ts_stream_t *stream, ts_metrics_t *metrics);
+void libdvbpsi_metrics_delete(ts_metrics_t *metrics);
+
+/* Share the verified SI sections of streams pushed by several threads,
+ * see section_cache.h; NULL detaches */
+struct dvbpsi_section_cache_s;
+void libdvbpsi_section_cache(ts_stream_t *stream, struct dvbpsi_section_cache_s *cache);
 void libdvbpsi_exit(ts_stream_t *stream);
 
 #endif
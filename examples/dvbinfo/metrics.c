@@ -0,0 +1,485 @@
+/*****************************************************************************
+ * metrics.c: machine readable metrics export
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
+
+#include <sys/types.h>
+#ifdef HAVE_SYS_SOCKET_H
+#   include <sys/socket.h>
+#   include <sys/un.h>
+#endif
+#include <assert.h>
+
+#include "libdvbpsi.h"
+#include "pcr.h"
+#include "tr290.h"
+#include "metrics.h"
+
+/*****************************************************************************
+ * JSON
+ *****************************************************************************/
+/* Input names are host:port or file names, escape what JSON needs */
+static void json_string(FILE *fd, const char *psz)
+{
+    fputc('"', fd);
+    for (; *psz; psz++)
+    {
+        if ((*psz == '"') || (*psz == '\\'))
+            fprintf(fd, "\\%c", *psz);
+        else if ((unsigned char)*psz < 0x20)
+            fprintf(fd, "\\u%04x", (unsigned char)*psz);
+        else
+            fputc(*psz, fd);
+    }
+    fputc('"', fd);
+}
+
+/* bucket i counts the values in [2^(i-1), 2^i) ns, see pcr.h */
+static void json_histogram(FILE *fd, const char *psz_name, const pcr_histogram_t *histogram)
+{
+    fprintf(fd, ",\"%s\":{\"count\":%"PRIu64",\"sum_ns\":%"PRIu64",\"max_ns\":%"PRIu64
+                ",\"buckets\":[", psz_name, histogram->i_count, histogram->i_sum,
+            histogram->i_max);
+    for (unsigned int i = 0; i < PCR_HISTOGRAM_BUCKETS; i++)
+        fprintf(fd, "%s%"PRIu64, (i > 0) ? "," : "", histogram->ai_bucket[i]);
+    fprintf(fd, "]}");
+}
+
+static void json_pcr(FILE *fd, const pcr_t *pcr, const bool b_arrival)
+{
+    fprintf(fd, "{\"pid\":%u,\"pcrs\":%"PRIu64",\"repetition_errors\":%"PRIu64
+                ",\"discontinuity_errors\":%"PRIu64",\"accuracy_errors\":%"PRIu64,
+            pcr->i_pid, pcr->i_pcrs, pcr->i_repetition_errors,
+            pcr->i_discontinuity_errors, pcr->i_accuracy_errors);
+    json_histogram(fd, "interval", &pcr->interval);
+    json_histogram(fd, "accuracy", &pcr->accuracy);
+    if (b_arrival)
+        json_histogram(fd, "jitter", &pcr->jitter);
+    fprintf(fd, "}");
+}
+
+static void json_metrics(FILE *fd, const ts_metrics_t *metrics, const char *psz_name,
+                         const bool b_arrival)
+{
+    fprintf(fd, "{");
+    if (psz_name)
+    {
+        fprintf(fd, "\"input\":");
+        json_string(fd, psz_name);
+        fprintf(fd, ",");
+    }
+    fprintf(fd, "\"date\":%"PRId64",\"packets\":%"PRIu64",\"null_packets\":%"PRIu64
+                ",\"lost_bytes\":%"PRIu64",\"pids\":[",
+            metrics->i_date, metrics->i_packets, metrics->i_null_packets,
+            metrics->i_lost_bytes);
+
+    for (unsigned int i = 0; i < metrics->i_pids; i++)
+    {
+        const ts_pid_metrics_t *p = &metrics->p_pids[i];
+        fprintf(fd, "%s\n{\"pid\":%u,\"pmt_pid\":%u,\"scrambled\":%s,\"packets\":%"PRIu64
+                    ",\"bitrate\":%.0f,\"cc_errors\":%"PRIu64",\"version_changes\":%"PRIu64
+                    ",\"pcr_interval_max_us\":%"PRId64,
+                (i > 0) ? "," : "", p->i_pid, p->i_pmt_pid,
+                p->b_scrambled ? "true" : "false", p->i_packets, p->f_bitrate,
+                p->i_cc_errors, p->i_version_changes, p->i_pcr_interval_max);
+        if (b_arrival)
+            fprintf(fd, ",\"pcr_jitter_max_us\":%"PRId64, p->i_pcr_jitter_max);
+        fprintf(fd, "}");
+    }
+    fprintf(fd, "],\"pcr\":[");
+    for (unsigned int i = 0; i < metrics->i_pcrs; i++)
+    {
+        fprintf(fd, "%s\n", (i > 0) ? "," : "");
+        json_pcr(fd, &metrics->p_pcrs[i], b_arrival);
+    }
+    fprintf(fd, "],\"tr101290\":[");
+    for (int i = 0; metrics->p_tr290 && (i < TR290_CHECKS); i++)
+    {
+        const tr290_counter_t *counter = &metrics->p_tr290[i];
+        fprintf(fd, "%s\n{\"check\":\"%s\",\"priority\":%d,\"errors\":%"PRIu64,
+                (i > 0) ? "," : "", tr290_name(i), tr290_priority(i), counter->i_count);
+        if (counter->i_first >= 0)
+            fprintf(fd, ",\"first_ns\":%"PRId64",\"last_ns\":%"PRId64,
+                    counter->i_first, counter->i_last);
+        fprintf(fd, "}");
+    }
+    fprintf(fd, "]}");
+}
+
+/*****************************************************************************
+ * OpenMetrics text format: all samples of a family together, so families
+ * are the outer loop and inputs the inner one
+ *****************************************************************************/
+typedef struct
+{
+    const char *psz_name;
+    const char *psz_type;
+    const char *psz_unit;
+    const char *psz_help;
+    bool        b_pid;      /* one sample per PID */
+    bool        b_pcr;      /* only PIDs carrying a PCR */
+    bool        b_arrival;  /* needs capture times */
+} metrics_family_t;
+
+static const metrics_family_t families[] =
+{
+    { "dvbinfo_packets", "counter", NULL, "Transport stream packets", false, false, false },
+    { "dvbinfo_null_packets", "counter", NULL, "Stuffing packets (PID 0x1FFF)", false, false, false },
+    { "dvbinfo_lost_bytes", "counter", NULL, "Bytes skipped to regain sync", false, false, false },
+    { "dvbinfo_pid_packets", "counter", NULL, "Packets per PID", true, false, false },
+    { "dvbinfo_pid_cc_errors", "counter", NULL, "Continuity counter errors per PID", true, false, false },
+    { "dvbinfo_pid_version_changes", "counter", NULL, "PAT, PMT and CAT version changes per PID", true, false, false },
+    { "dvbinfo_pid_bitrate_bits_per_second", "gauge", "bits_per_second", "Bitrate per PID over the PCR span of its program", true, false, false },
+    { "dvbinfo_pid_pcr_interval_max_seconds", "gauge", "seconds", "Longest time between two PCRs", true, true, false },
+    { "dvbinfo_pid_pcr_jitter_max_seconds", "gauge", "seconds", "Largest PCR overall jitter", true, true, true },
+};
+
+/* PCR analysis, per PCR PID */
+static const metrics_family_t pcr_families[] =
+{
+    { "dvbinfo_pcr_repetition_errors", "counter", NULL, "PCR intervals above 40 ms (TR 101 290 2.3a)", true, true, false },
+    { "dvbinfo_pcr_discontinuity_errors", "counter", NULL, "PCR jumps without discontinuity_indicator (TR 101 290 2.3b)", true, true, false },
+    { "dvbinfo_pcr_accuracy_errors", "counter", NULL, "PCR inaccuracies above 500 ns (TR 101 290 2.4)", true, true, false },
+    { "dvbinfo_pcr_interval_seconds", "histogram", "seconds", "Time between two PCRs", true, true, false },
+    { "dvbinfo_pcr_accuracy_seconds", "histogram", "seconds", "Absolute PCR accuracy against the multiplex rate", true, true, false },
+    { "dvbinfo_pcr_jitter_seconds", "histogram", "seconds", "Absolute PCR overall jitter against arrival time", true, true, true },
+};
+
+/* TR 101 290 checks, per input */
+static const metrics_family_t tr290_family =
+    { "dvbinfo_tr101290_errors", "counter", NULL, "TR 101 290 priority 1 and 2 errors", false, false, false };
+
+/* OpenMetrics label values only know the \\, \" and \n escapes */
+static void om_string(FILE *fd, const char *psz)
+{
+    fputc('"', fd);
+    for (; *psz; psz++)
+    {
+        if ((*psz == '"') || (*psz == '\\'))
+            fprintf(fd, "\\%c", *psz);
+        else if (*psz == '\n')
+            fputs("\\n", fd);
+        else
+            fputc(*psz, fd);
+    }
+    fputc('"', fd);
+}
+
+static void om_labels(FILE *fd, const char *psz_name, const int i_pid, const char *psz_le)
+{
+    if (!psz_name && (i_pid < 0) && !psz_le)
+        return;
+    const char *psz_sep = "";
+    fputc('{', fd);
+    if (psz_name)
+    {
+        fprintf(fd, "input=");
+        om_string(fd, psz_name);
+        psz_sep = ",";
+    }
+    if (i_pid >= 0)
+    {
+        fprintf(fd, "%spid=\"%d\"", psz_sep, i_pid);
+        psz_sep = ",";
+    }
+    if (psz_le)
+        fprintf(fd, "%sle=\"%s\"", psz_sep, psz_le);
+    fputc('}', fd);
+}
+
+static void om_header(FILE *fd, const metrics_family_t *family)
+{
+    fprintf(fd, "# TYPE %s %s\n", family->psz_name, family->psz_type);
+    if (family->psz_unit)
+        fprintf(fd, "# UNIT %s %s\n", family->psz_name, family->psz_unit);
+    fprintf(fd, "# HELP %s %s.\n", family->psz_name, family->psz_help);
+}
+
+static void om_histogram(FILE *fd, const char *psz_family, const char *psz_name,
+                         const int i_pid, const pcr_histogram_t *histogram)
+{
+    uint64_t i_cumulative = 0;
+    for (unsigned int i = 0; i < PCR_HISTOGRAM_BUCKETS; i++)
+    {
+        char psz_le[32];
+        uint64_t i_le = pcr_histogram_le(i);
+        if (i_le == UINT64_MAX)
+            strcpy(psz_le, "+Inf");
+        else
+            snprintf(psz_le, sizeof(psz_le), "%.9f", (double)i_le / 1000000000.0);
+        i_cumulative += histogram->ai_bucket[i];
+        fprintf(fd, "%s_bucket", psz_family);
+        om_labels(fd, psz_name, i_pid, psz_le);
+        fprintf(fd, " %"PRIu64"\n", i_cumulative);
+    }
+    fprintf(fd, "%s_count", psz_family);
+    om_labels(fd, psz_name, i_pid, NULL);
+    fprintf(fd, " %"PRIu64"\n", histogram->i_count);
+    fprintf(fd, "%s_sum", psz_family);
+    om_labels(fd, psz_name, i_pid, NULL);
+    fprintf(fd, " %.9f\n", (double)histogram->i_sum / 1000000000.0);
+}
+
+static void om_pcr(FILE *fd, const size_t i_family, const char *psz_name, const pcr_t *pcr)
+{
+    const char *psz_family = pcr_families[i_family].psz_name;
+    const uint64_t ai_errors[] = { pcr->i_repetition_errors, pcr->i_discontinuity_errors,
+                                   pcr->i_accuracy_errors };
+    const pcr_histogram_t *histograms[] = { &pcr->interval, &pcr->accuracy, &pcr->jitter };
+
+    if (i_family < ARRAY_SIZE(ai_errors))
+    {
+        fprintf(fd, "%s_total", psz_family);
+        om_labels(fd, psz_name, pcr->i_pid, NULL);
+        fprintf(fd, " %"PRIu64"\n", ai_errors[i_family]);
+    }
+    else
+    {
+        assert(i_family - ARRAY_SIZE(ai_errors) < ARRAY_SIZE(histograms));
+        om_histogram(fd, psz_family, psz_name, pcr->i_pid,
+                     histograms[i_family - ARRAY_SIZE(ai_errors)]);
+    }
+}
+
+static void om_tr290(FILE *fd, const char *psz_name, const tr290_counter_t *p_counters)
+{
+    for (int i = 0; p_counters && (i < TR290_CHECKS); i++)
+    {
+        fprintf(fd, "%s_total{", tr290_family.psz_name);
+        if (psz_name)
+        {
+            fprintf(fd, "input=");
+            om_string(fd, psz_name);
+            fputc(',', fd);
+        }
+        fprintf(fd, "check=\"%s\",priority=\"%d\"} %"PRIu64"\n",
+                tr290_name(i), tr290_priority(i), p_counters[i].i_count);
+    }
+}
+
+static void om_sample(FILE *fd, const size_t i_family, const ts_metrics_t *metrics,
+                      const ts_pid_metrics_t *p)
+{
+    switch (i_family)
+    {
+        case 0: fprintf(fd, " %"PRIu64"\n", metrics->i_packets); break;
+        case 1: fprintf(fd, " %"PRIu64"\n", metrics->i_null_packets); break;
+        case 2: fprintf(fd, " %"PRIu64"\n", metrics->i_lost_bytes); break;
+        case 3: fprintf(fd, " %"PRIu64"\n", p->i_packets); break;
+        case 4: fprintf(fd, " %"PRIu64"\n", p->i_cc_errors); break;
+        case 5: fprintf(fd, " %"PRIu64"\n", p->i_version_changes); break;
+        case 6: fprintf(fd, " %.0f\n", p->f_bitrate); break;
+        case 7: fprintf(fd, " %.6f\n", (double)p->i_pcr_interval_max / 1000000.0); break;
+        case 8: fprintf(fd, " %.6f\n", (double)p->i_pcr_jitter_max / 1000000.0); break;
+        default: assert(0);
+    }
+}
+
+static void om_metrics(FILE *fd, ts_metrics_t *const *pp_metrics, const char *const *pp_names,
+                       const size_t i_count, const bool b_arrival)
+{
+    for (size_t f = 0; f < ARRAY_SIZE(families); f++)
+    {
+        const metrics_family_t *family = &families[f];
+        if (family->b_arrival && !b_arrival)
+            continue;
+
+        om_header(fd, family);
+
+        const char *psz_suffix = (strcmp(family->psz_type, "counter") == 0) ? "_total" : "";
+        for (size_t n = 0; n < i_count; n++)
+        {
+            const ts_metrics_t *metrics = pp_metrics[n];
+            const char *psz_name = pp_names ? pp_names[n] : NULL;
+            if (!family->b_pid)
+            {
+                fprintf(fd, "%s%s", family->psz_name, psz_suffix);
+                om_labels(fd, psz_name, -1, NULL);
+                om_sample(fd, f, metrics, NULL);
+                continue;
+            }
+            for (unsigned int i = 0; i < metrics->i_pids; i++)
+            {
+                const ts_pid_metrics_t *p = &metrics->p_pids[i];
+                if (family->b_pcr && (p->i_pcr_interval_max == 0))
+                    continue;
+                fprintf(fd, "%s%s", family->psz_name, psz_suffix);
+                om_labels(fd, psz_name, p->i_pid, NULL);
+                om_sample(fd, f, metrics, p);
+            }
+        }
+    }
+    for (size_t f = 0; f < ARRAY_SIZE(pcr_families); f++)
+    {
+        if (pcr_families[f].b_arrival && !b_arrival)
+            continue;
+        om_header(fd, &pcr_families[f]);
+        for (size_t n = 0; n < i_count; n++)
+        {
+            for (unsigned int i = 0; i < pp_metrics[n]->i_pcrs; i++)
+                om_pcr(fd, f, pp_names ? pp_names[n] : NULL, &pp_metrics[n]->p_pcrs[i]);
+        }
+    }
+    om_header(fd, &tr290_family);
+    for (size_t n = 0; n < i_count; n++)
+        om_tr290(fd, pp_names ? pp_names[n] : NULL, pp_metrics[n]->p_tr290);
+    fprintf(fd, "# EOF\n");
+}
+
+bool metrics_write(FILE *fd, const int mode, ts_metrics_t *const *pp_metrics,
+                   const char *const *pp_names, const size_t i_count, const bool b_arrival)
+{
+    switch (mode)
+    {
+        case SUM_JSON:
+            if (pp_names == NULL)
+            {
+                assert(i_count == 1);
+                json_metrics(fd, pp_metrics[0], NULL, b_arrival);
+            }
+            else
+            {
+                fprintf(fd, "{\"inputs\":[");
+                for (size_t n = 0; n < i_count; n++)
+                {
+                    fprintf(fd, "%s\n", (n > 0) ? "," : "");
+                    json_metrics(fd, pp_metrics[n], pp_names[n], b_arrival);
+                }
+                fprintf(fd, "]}");
+            }
+            fprintf(fd, "\n");
+            break;
+        case SUM_OPENMETRICS:
+            om_metrics(fd, pp_metrics, pp_names, i_count, b_arrival);
+            break;
+        default:
+            return false;
+    }
+    return (ferror(fd) == 0);
+}
+
+/*****************************************************************************
+ * Unix socket: every client that connects gets one snapshot
+ *****************************************************************************/
+#ifdef HAVE_SYS_SOCKET_H
+struct metrics_server_s
+{
+    int   fd;
+    char *psz_path;
+};
+
+metrics_server_t *metrics_listen(const char *psz_path)
+{
+    struct sockaddr_un addr;
+    if (strlen(psz_path) >= sizeof(addr.sun_path))
+        return NULL;
+
+    metrics_server_t *server = (metrics_server_t *)calloc(1, sizeof(metrics_server_t));
+    if (server == NULL)
+        return NULL;
+    server->psz_path = strdup(psz_path);
+    server->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if ((server->psz_path == NULL) || (server->fd < 0))
+        goto error;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, psz_path);
+    unlink(psz_path);
+    if ((bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (listen(server->fd, 16) < 0))
+    {
+        perror("metrics socket error");
+        goto error;
+    }
+    return server;
+
+error:
+    if (server->fd >= 0)
+        close(server->fd);
+    free(server->psz_path);
+    free(server);
+    return NULL;
+}
+
+int metrics_accept(metrics_server_t *server)
+{
+    int fd = accept(server->fd, NULL, NULL);
+    if (fd < 0)
+        return -1;
+
+    /* the analysis thread never waits for a client */
+    int flags = fcntl(fd, F_GETFL);
+    if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void metrics_send(int fd, const char *p_data, size_t i_size)
+{
+    /* room for the whole snapshot, the kernel caps it at wmem_max */
+    int i_sndbuf = (i_size < INT_MAX / 2) ? (int)i_size : INT_MAX / 2;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &i_sndbuf, sizeof(i_sndbuf));
+
+    while (i_size > 0)
+    {
+        ssize_t i_sent = send(fd, p_data, i_size, MSG_NOSIGNAL);
+        if (i_sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break; /* EAGAIN: a client that does not keep up is dropped */
+        }
+        p_data += i_sent;
+        i_size -= i_sent;
+    }
+    close(fd);
+}
+
+void metrics_close(metrics_server_t *server)
+{
+    if (server == NULL)
+        return;
+    close(server->fd);
+    unlink(server->psz_path);
+    free(server->psz_path);
+    free(server);
+}
+#endif
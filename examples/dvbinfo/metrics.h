@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * metrics.h: machine readable metrics export
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef DVBINFO_METRICS_H_
+#define DVBINFO_METRICS_H_
+
+typedef struct metrics_server_s metrics_server_t;
+
+/* Metrics export:
+ * metrics_write()  - write i_count snapshots as SUM_JSON or SUM_OPENMETRICS,
+ *                    pp_names labels each snapshot with its input, NULL
+ *                    for a single unlabelled one. b_arrival tells whether
+ *                    dates are capture times, PCR jitter is left out if not.
+ * metrics_listen() - listen on a unix stream socket at psz_path, replacing
+ *                    a stale socket file
+ * metrics_accept() - non-blocking, the next client waiting for a snapshot,
+ *                    -1 if none
+ * metrics_send()   - write a snapshot to a client and close it, never
+ *                    blocks: what does not fit in the socket buffer of a
+ *                    client that is not reading is dropped
+ * metrics_close()  - stop listening and remove the socket file
+ */
+bool metrics_write(FILE *fd, const int mode, ts_metrics_t *const *pp_metrics,
+                   const char *const *pp_names, const size_t i_count, const bool b_arrival);
+
+metrics_server_t *metrics_listen(const char *psz_path);
+int metrics_accept(metrics_server_t *server);
+void metrics_send(int fd, const char *p_data, size_t i_size);
+void metrics_close(metrics_server_t *server);
+
+#endif
@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * pcr.c: PCR repetition, accuracy and jitter analysis
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
+
+#include "pcr.h"
+
+#define PCR_WRAP ((INT64_C(1) << 33) * 300) /* 27 MHz ticks */
+
+/* Tracking filter of the arrival against PCR time offset, an alpha-beta
+ * filter that follows a constant clock drift without lag */
+#define PCR_ALPHA (1.0 / 32.0)
+#define PCR_BETA  (PCR_ALPHA * PCR_ALPHA / (2.0 - PCR_ALPHA))
+
+static inline int64_t pcr_to_ns(int64_t i_ticks)
+{
+    return i_ticks * 1000 / 27;
+}
+
+static inline uint64_t pcr_abs(int64_t i_ns)
+{
+    return (i_ns < 0) ? (uint64_t)-i_ns : (uint64_t)i_ns;
+}
+
+void pcr_histogram_add(pcr_histogram_t *histogram, uint64_t i_ns)
+{
+    unsigned int i_bucket = (i_ns == 0) ? 0 : 64 - __builtin_clzll(i_ns);
+    if (i_bucket >= PCR_HISTOGRAM_BUCKETS)
+        i_bucket = PCR_HISTOGRAM_BUCKETS - 1;
+
+    histogram->ai_bucket[i_bucket]++;
+    histogram->i_count++;
+    histogram->i_sum += i_ns;
+    if (i_ns > histogram->i_max)
+        histogram->i_max = i_ns;
+}
+
+uint64_t pcr_histogram_le(unsigned int i_bucket)
+{
+    if (i_bucket >= PCR_HISTOGRAM_BUCKETS - 1)
+        return UINT64_MAX;
+    return (i_bucket == 0) ? 0 : (UINT64_C(1) << i_bucket) - 1;
+}
+
+uint64_t pcr_histogram_percentile(const pcr_histogram_t *histogram, double f_fraction)
+{
+    if (histogram->i_count == 0)
+        return 0;
+
+    uint64_t i_rank = (uint64_t)(f_fraction * (double)histogram->i_count);
+    if (i_rank >= histogram->i_count)
+        i_rank = histogram->i_count - 1;
+
+    uint64_t i_seen = 0;
+    for (unsigned int i = 0; i < PCR_HISTOGRAM_BUCKETS; i++)
+    {
+        i_seen += histogram->ai_bucket[i];
+        if (i_seen > i_rank)
+        {
+            uint64_t i_le = pcr_histogram_le(i);
+            return (i_le < histogram->i_max) ? i_le : histogram->i_max;
+        }
+    }
+    return histogram->i_max;
+}
+
+void pcr_init(pcr_t *pcr, uint16_t i_pid)
+{
+    memset(pcr, 0, sizeof(pcr_t));
+    pcr->i_pid = i_pid;
+}
+
+/* Forget the time base, the histograms and counters stay */
+static void pcr_restart(pcr_t *pcr, int64_t i_pcr, uint64_t i_position, int64_t i_arrival)
+{
+    pcr->b_last = true;
+    pcr->i_last = i_pcr;
+    pcr->i_last_position = i_position;
+    pcr->i_first_position = i_position;
+    pcr->i_elapsed = 0;
+    pcr->i_first_arrival = i_arrival;
+    pcr->b_tracking = false;
+}
+
+void pcr_update(pcr_t *pcr, int64_t i_pcr, uint64_t i_position, int64_t i_arrival,
+                bool b_discontinuity)
+{
+    pcr->i_pcrs++;
+    if (!pcr->b_last || b_discontinuity)
+    {
+        pcr_restart(pcr, i_pcr, i_position, i_arrival);
+        return;
+    }
+
+    int64_t i_ticks = (i_pcr - pcr->i_last + PCR_WRAP) % PCR_WRAP;
+    if (i_ticks > PCR_WRAP / 2)
+        i_ticks -= PCR_WRAP;
+    int64_t i_interval = pcr_to_ns(i_ticks);
+
+    /* 2.3b, a jump that was not signalled */
+    if ((i_interval <= 0) || (i_interval > PCR_DISCONTINUITY_MAX))
+    {
+        pcr->i_discontinuity_errors++;
+        pcr_restart(pcr, i_pcr, i_position, i_arrival);
+        return;
+    }
+
+    /* 2.3a */
+    pcr_histogram_add(&pcr->interval, (uint64_t)i_interval);
+    if (i_interval > PCR_REPETITION_MAX)
+        pcr->i_repetition_errors++;
+
+    /* 2.4, against the rate up to the previous PCR */
+    uint64_t i_bytes = i_position - pcr->i_last_position;
+    uint64_t i_span = pcr->i_last_position - pcr->i_first_position;
+    if ((i_span > 0) && (pcr->i_elapsed > 0))
+    {
+        double f_expected = (double)i_bytes * (double)pcr_to_ns(pcr->i_elapsed) / (double)i_span;
+        uint64_t i_accuracy = pcr_abs((int64_t)((double)i_interval - f_expected));
+        pcr_histogram_add(&pcr->accuracy, i_accuracy);
+        if (i_accuracy > PCR_ACCURACY_MAX)
+            pcr->i_accuracy_errors++;
+    }
+    pcr->i_elapsed += i_ticks;
+
+    /* overall jitter */
+    if ((i_arrival > 0) && (pcr->i_first_arrival > 0))
+    {
+        double f_offset = (double)(i_arrival - pcr->i_first_arrival - pcr_to_ns(pcr->i_elapsed));
+        if (!pcr->b_tracking)
+        {
+            pcr->f_offset = f_offset;
+            pcr->f_drift = 0.0;
+            pcr->b_tracking = true;
+        }
+        else
+        {
+            double f_predicted = pcr->f_offset + pcr->f_drift * (double)i_interval;
+            double f_jitter = f_offset - f_predicted;
+            pcr->f_offset = f_predicted + PCR_ALPHA * f_jitter;
+            pcr->f_drift += PCR_BETA * f_jitter / (double)i_interval;
+            pcr_histogram_add(&pcr->jitter, pcr_abs((int64_t)f_jitter));
+        }
+    }
+
+    pcr->i_last = i_pcr;
+    pcr->i_last_position = i_position;
+}
+
+double pcr_rate(const pcr_t *pcr)
+{
+    uint64_t i_span = pcr->i_last_position - pcr->i_first_position;
+    if (!pcr->b_last || (i_span == 0) || (pcr->i_elapsed <= 0))
+        return 0.0;
+    return (double)i_span * 8.0 * 27000000.0 / (double)pcr->i_elapsed;
+}
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ * pcr.h: PCR repetition, accuracy and jitter analysis
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef DVBINFO_PCR_H_
+#define DVBINFO_PCR_H_
+
+/* Log2 histogram of durations in ns: bucket 0 holds 0, bucket i holds
+ * [2^(i-1), 2^i) ns and the last bucket everything from 2^38 ns on */
+#define PCR_HISTOGRAM_BUCKETS 40
+
+typedef struct pcr_histogram_s
+{
+    uint64_t i_count;
+    uint64_t i_sum;     /* ns */
+    uint64_t i_max;     /* ns */
+    uint64_t ai_bucket[PCR_HISTOGRAM_BUCKETS];
+} pcr_histogram_t;
+
+/* TR 101 290 priority 2 limits */
+#define PCR_REPETITION_MAX  40000000  /* ns */
+#define PCR_DISCONTINUITY_MAX 100000000 /* ns */
+#define PCR_ACCURACY_MAX    500       /* ns */
+
+typedef struct pcr_s
+{
+    uint16_t i_pid;
+
+    uint64_t i_pcrs;
+    uint64_t i_repetition_errors;   /* more than PCR_REPETITION_MAX between PCRs */
+    uint64_t i_discontinuity_errors;/* jump back or beyond PCR_DISCONTINUITY_MAX,
+                                       not signalled */
+    uint64_t i_accuracy_errors;     /* |PCR_AC| above PCR_ACCURACY_MAX */
+
+    pcr_histogram_t interval;       /* PCR repetition interval */
+    pcr_histogram_t accuracy;       /* |PCR_AC| against the multiplex rate */
+    pcr_histogram_t jitter;         /* |PCR_OJ| against arrival times */
+
+    /* since the last (signalled) discontinuity */
+    bool     b_last;
+    int64_t  i_last;                /* 27 MHz */
+    uint64_t i_last_position;       /* bytes */
+    int64_t  i_elapsed;             /* 27 MHz */
+    uint64_t i_first_position;
+    int64_t  i_first_arrival;       /* ns, 0 if unknown */
+    bool     b_tracking;
+    double   f_offset;              /* filtered arrival - PCR time, ns */
+    double   f_drift;               /* of the receiver clock against the PCRs */
+} pcr_t;
+
+/* PCR analysis of one PCR PID, all in place and O(1) per PCR:
+ * pcr_init()   - start afresh for PID i_pid
+ * pcr_update() - account one PCR (27 MHz, base * 300 + extension). i_position
+ *                is the byte offset of its packet in the multiplex, i_arrival
+ *                the capture time in ns (0 if unknown, no jitter then) and
+ *                b_discontinuity the discontinuity_indicator of the packet.
+ *                PCR_AC compares the PCR with the one predicted from the
+ *                previous PCR and the multiplex rate measured so far; PCR_OJ
+ *                is the arrival time against a tracking filter of the PCR
+ *                clock, so drift between sender and receiver clocks is not
+ *                counted as jitter.
+ * pcr_rate()   - multiplex rate in bit/s measured since the last discontinuity,
+ *                0 until two PCRs in a row were seen
+ * pcr_histogram_add() - account one duration in ns
+ * pcr_histogram_le() - upper bound of a bucket in ns, UINT64_MAX for the last
+ * pcr_histogram_percentile() - upper bound of the bucket holding the given
+ *                fraction (0..1) of the values, capped to the maximum
+ */
+void pcr_init(pcr_t *pcr, uint16_t i_pid);
+void pcr_update(pcr_t *pcr, int64_t i_pcr, uint64_t i_position, int64_t i_arrival,
+                bool b_discontinuity);
+double pcr_rate(const pcr_t *pcr);
+
+void pcr_histogram_add(pcr_histogram_t *histogram, uint64_t i_ns);
+uint64_t pcr_histogram_le(unsigned int i_bucket);
+uint64_t pcr_histogram_percentile(const pcr_histogram_t *histogram, double f_fraction);
+
+#endif
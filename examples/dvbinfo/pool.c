@@ -0,0 +1,768 @@
+/*****************************************************************************
+ * pool.c: many udp inputs on a fixed pool of worker threads
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <assert.h>
+
+#ifdef DVBPSI_DIST
+#   include "../../src/dvbpsi.h"
+#   include "../../src/section_cache.h"
+#else
+#   include <dvbpsi/dvbpsi.h>
+#   include <dvbpsi/section_cache.h>
+#endif
+
+#include "dvbinfo.h"
+#include "libdvbpsi.h"
+#include "udp.h"
+#include "metrics.h"
+#include "pool.h"
+
+#define POOL_DATAGRAM_SIZE  (7 * 188) /* same as a single udp input */
+#define POOL_EVENTS_MAX     64        /* epoll events per wakeup */
+#define POOL_READS_MAX      4         /* batches per input per wakeup, keeps inputs fair */
+#define POOL_WAIT           100       /* ms, workers look for moved inputs this often */
+#define POOL_REBALANCE      5000      /* ms between load measurements */
+#define POOL_CACHE_SLOTS    8192      /* SI sections shared by the inputs */
+
+typedef struct pool_input_s
+{
+    pool_t      *pool;
+    char        *psz_name;  /* host:port as given */
+    int          fd;
+    ts_stream_t *stream;    /* only touched by the owning worker */
+
+    unsigned int i_worker;  /* owner, written by the owner when handing over */
+    unsigned int i_target;  /* worker to move to, written by pool_run() */
+    uint64_t     i_busy;    /* ns spent receiving and parsing, written by the owner */
+    bool         b_closed;  /* socket error, no owner anymore */
+
+    /* pool_run() only */
+    uint64_t     i_busy_last;
+    uint64_t     i_load;
+
+    /* last summary or metrics snapshot, written by the owner, read by pool_run() */
+    pthread_mutex_t lock;
+    char        *p_summary;
+    size_t       i_summary;
+    ts_metrics_t *metrics;
+} pool_input_t;
+
+typedef struct pool_worker_s
+{
+    pool_t      *pool;
+    unsigned int i_id;
+    int          epfd;
+    pthread_t    handle;
+    bool         b_started;
+    bool         b_move;    /* set by pool_run() when inputs should move */
+    uint8_t     *p_data;    /* UDP_BATCH_MAX datagrams */
+
+    /* pool_run() only */
+    uint64_t     i_load;
+} pool_worker_t;
+
+struct pool_s
+{
+    params_t        *param;
+    ts_stream_log_cb pf_log;
+
+    pool_input_t   **pp_inputs;
+    size_t           i_inputs;
+    size_t           i_open;    /* inputs not closed yet */
+
+    pool_worker_t   *p_workers;
+    unsigned int     i_workers;
+    bool             b_alive;
+
+    bool             b_metrics; /* summary or socket wants metrics snapshots */
+
+    dvbpsi_section_cache_t *cache; /* SI sections common to the inputs */
+};
+
+static bool pool_metrics_mode(const int mode)
+{
+    return (mode == SUM_JSON) || (mode == SUM_OPENMETRICS);
+}
+
+/* Log with the name of the input in front */
+static void pool_log(void *data, const int level, const char *format, ...)
+{
+    pool_input_t *input = (pool_input_t *)data;
+    char *msg = NULL;
+    va_list ap;
+
+    va_start(ap, format);
+    int err = vasprintf(&msg, format, ap);
+    va_end(ap);
+    if (err < 0)
+        return;
+
+    input->pool->pf_log(input->pool->param, level, "%s: %s", input->psz_name, msg);
+    free(msg);
+}
+
+static uint64_t pool_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+/*****************************************************************************
+ * Workers
+ *****************************************************************************/
+static void pool_input_close(pool_worker_t *worker, pool_input_t *input)
+{
+    pool_t *pool = worker->pool;
+
+    epoll_ctl(worker->epfd, EPOLL_CTL_DEL, input->fd, NULL);
+    udp_close(input->fd);
+    input->fd = -1;
+    pool_log(input, DVBINFO_LOG_ERROR, "input closed\n");
+
+    __atomic_store_n(&input->b_closed, true, __ATOMIC_RELEASE);
+    if (__atomic_sub_fetch(&pool->i_open, 1, __ATOMIC_ACQ_REL) == 0)
+        __atomic_store_n(&pool->b_alive, false, __ATOMIC_RELEASE);
+}
+
+/* Drain a readable socket, at most POOL_READS_MAX batches at a time, epoll
+ * is level triggered and reports it again when more is queued */
+static void pool_input_read(pool_worker_t *worker, pool_input_t *input,
+                            udp_datagram_t *p_datagrams)
+{
+    uint64_t i_start = pool_clock();
+
+    for (int n = 0; n < POOL_READS_MAX; n++)
+    {
+        int received = udp_read_batch(input->fd, p_datagrams, UDP_BATCH_MAX, false);
+        if (received < 0)
+        {
+            pool_input_close(worker, input);
+            break;
+        }
+
+        mtime_t now = 0;
+        for (int i = 0; i < received; i++)
+        {
+            mtime_t i_date;
+            if (p_datagrams[i].i_arrival > 0) /* same clock as mdate() */
+            {
+                i_date = p_datagrams[i].i_arrival / 1000000;
+                libdvbpsi_arrival(input->stream, p_datagrams[i].i_arrival);
+            }
+            else
+            {
+                if (now == 0)
+                    now = mdate();
+                i_date = now;
+                libdvbpsi_arrival(input->stream, now * 1000000);
+            }
+            if (!libdvbpsi_process(input->stream, p_datagrams[i].p_data,
+                                   p_datagrams[i].i_length, i_date))
+                pool_log(input, DVBINFO_LOG_ERROR, "error while processing\n");
+        }
+        if (received < UDP_BATCH_MAX)
+            break;
+    }
+
+    __atomic_add_fetch(&input->i_busy, pool_clock() - i_start, __ATOMIC_RELAXED);
+}
+
+/* Hand the inputs pool_run() moved elsewhere over to their new worker */
+static void pool_worker_move(pool_worker_t *worker)
+{
+    pool_t *pool = worker->pool;
+
+    for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        if ((__atomic_load_n(&input->i_worker, __ATOMIC_ACQUIRE) != worker->i_id) ||
+            __atomic_load_n(&input->b_closed, __ATOMIC_ACQUIRE))
+            continue;
+        unsigned int i_target = __atomic_load_n(&input->i_target, __ATOMIC_ACQUIRE);
+        if (i_target == worker->i_id)
+            continue;
+
+        /* once removed here no event for this input is pending on this
+         * worker, adding it to the target's set publishes the stream */
+        epoll_ctl(worker->epfd, EPOLL_CTL_DEL, input->fd, NULL);
+        __atomic_store_n(&input->i_worker, i_target, __ATOMIC_RELEASE);
+
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = input };
+        if (epoll_ctl(pool->p_workers[i_target].epfd, EPOLL_CTL_ADD, input->fd, &event) < 0)
+        {
+            pool_log(input, DVBINFO_LOG_ERROR, "failed moving to worker %u (%s)\n",
+                     i_target, strerror(errno));
+            __atomic_store_n(&input->i_worker, worker->i_id, __ATOMIC_RELEASE);
+            __atomic_store_n(&input->i_target, worker->i_id, __ATOMIC_RELEASE);
+            epoll_ctl(worker->epfd, EPOLL_CTL_ADD, input->fd, &event);
+        }
+    }
+}
+
+/* Summaries are taken by the owner, the stream is not shared */
+static void pool_worker_summary(pool_worker_t *worker)
+{
+    pool_t *pool = worker->pool;
+
+    for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        if ((__atomic_load_n(&input->i_worker, __ATOMIC_ACQUIRE) != worker->i_id) ||
+            __atomic_load_n(&input->b_closed, __ATOMIC_ACQUIRE))
+            continue;
+
+        if (pool->b_metrics)
+        {
+            pthread_mutex_lock(&input->lock);
+            libdvbpsi_metrics(input->stream, input->metrics);
+            pthread_mutex_unlock(&input->lock);
+        }
+        if (!pool->param->b_summary || pool_metrics_mode(pool->param->summary.mode))
+            continue;
+
+        char *p_summary = NULL;
+        size_t i_summary = 0;
+        FILE *fd = open_memstream(&p_summary, &i_summary);
+        if (fd == NULL)
+            continue;
+        libdvbpsi_summary(fd, input->stream, pool->param->summary.mode);
+        fclose(fd);
+
+        pthread_mutex_lock(&input->lock);
+        free(input->p_summary);
+        input->p_summary = p_summary;
+        input->i_summary = i_summary;
+        pthread_mutex_unlock(&input->lock);
+    }
+}
+
+static void *pool_worker(void *data)
+{
+    pool_worker_t *worker = (pool_worker_t *)data;
+    pool_t *pool = worker->pool;
+    const params_t *param = pool->param;
+    struct epoll_event events[POOL_EVENTS_MAX];
+    udp_datagram_t datagrams[UDP_BATCH_MAX];
+
+    for (unsigned int i = 0; i < UDP_BATCH_MAX; i++)
+    {
+        datagrams[i].p_data = &worker->p_data[i * POOL_DATAGRAM_SIZE];
+        datagrams[i].i_size = POOL_DATAGRAM_SIZE;
+    }
+
+    mtime_t deadline = mdate() + param->summary.period;
+    while (__atomic_load_n(&pool->b_alive, __ATOMIC_ACQUIRE))
+    {
+        int count = epoll_wait(worker->epfd, events, POOL_EVENTS_MAX, POOL_WAIT);
+        if ((count < 0) && (errno != EINTR))
+        {
+            pool->pf_log(pool->param, DVBINFO_LOG_ERROR, "worker %u: epoll error (%s)\n",
+                         worker->i_id, strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            pool_input_t *input = (pool_input_t *)events[i].data.ptr;
+            if (input->fd >= 0)
+                pool_input_read(worker, input, datagrams);
+        }
+
+        if (__atomic_exchange_n(&worker->b_move, false, __ATOMIC_ACQ_REL))
+            pool_worker_move(worker);
+
+        if ((param->b_summary || pool->b_metrics) && (mdate() >= deadline))
+        {
+            pool_worker_summary(worker);
+            deadline = mdate() + param->summary.period;
+        }
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * Pool
+ *****************************************************************************/
+pool_t *pool_new(params_t *param, ts_stream_log_cb pf_log, unsigned int i_workers)
+{
+    if (i_workers == 0)
+    {
+        long i_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        i_workers = (i_cores > 0) ? (unsigned int)i_cores : 1;
+    }
+
+    pool_t *pool = (pool_t *)calloc(1, sizeof(pool_t));
+    if (pool == NULL)
+        return NULL;
+    pool->param = param;
+    pool->pf_log = pf_log;
+
+    pool->p_workers = (pool_worker_t *)calloc(i_workers, sizeof(pool_worker_t));
+    if (pool->p_workers == NULL)
+    {
+        free(pool);
+        return NULL;
+    }
+    pool->i_workers = i_workers;
+    for (unsigned int i = 0; i < i_workers; i++)
+        pool->p_workers[i].epfd = -1;
+
+    pool->cache = dvbpsi_section_cache_new(POOL_CACHE_SLOTS);
+    if (pool->cache == NULL)
+    {
+        pool_free(pool);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < i_workers; i++)
+    {
+        pool_worker_t *worker = &pool->p_workers[i];
+        worker->pool = pool;
+        worker->i_id = i;
+        worker->epfd = epoll_create1(EPOLL_CLOEXEC);
+        worker->p_data = (uint8_t *)malloc(UDP_BATCH_MAX * POOL_DATAGRAM_SIZE);
+        if ((worker->epfd < 0) || (worker->p_data == NULL))
+        {
+            pool_free(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+bool pool_add(pool_t *pool, const char *interface, const char *ipaddress, int port)
+{
+    pool_input_t **pp_inputs = (pool_input_t **)realloc(pool->pp_inputs,
+                                        (pool->i_inputs + 1) * sizeof(pool_input_t *));
+    if (pp_inputs == NULL)
+        return false;
+    pool->pp_inputs = pp_inputs;
+
+    pool_input_t *input = (pool_input_t *)calloc(1, sizeof(pool_input_t));
+    if (input == NULL)
+        return false;
+    input->pool = pool;
+    input->fd = -1;
+    pthread_mutex_init(&input->lock, NULL);
+    if (asprintf(&input->psz_name, "%s:%d", ipaddress, port) < 0)
+    {
+        input->psz_name = NULL;
+        goto error;
+    }
+
+    input->fd = udp_open(interface, ipaddress, port, pool->param->rcvbuf);
+    if (input->fd < 0)
+    {
+        pool->pf_log(pool->param, DVBINFO_LOG_ERROR, "%s: failed opening input\n",
+                     input->psz_name);
+        goto error;
+    }
+    int flags = fcntl(input->fd, F_GETFL);
+    if ((flags < 0) || (fcntl(input->fd, F_SETFL, flags | O_NONBLOCK) < 0))
+        goto error;
+
+    input->stream = libdvbpsi_init(pool->param->debug, &pool_log, (void *)input);
+    input->metrics = libdvbpsi_metrics_new();
+    if ((input->stream == NULL) || (input->metrics == NULL))
+        goto error;
+    libdvbpsi_section_cache(input->stream, pool->cache);
+
+    /* round robin until the first load measurement */
+    input->i_worker = input->i_target = pool->i_inputs % pool->i_workers;
+    pool->pp_inputs[pool->i_inputs++] = input;
+    pool->i_open++;
+    return true;
+
+error:
+    if (input->fd >= 0)
+        udp_close(input->fd);
+    if (input->stream)
+        libdvbpsi_exit(input->stream);
+    libdvbpsi_metrics_delete(input->metrics);
+    pthread_mutex_destroy(&input->lock);
+    free(input->psz_name);
+    free(input);
+    return false;
+}
+
+bool pool_add_list(pool_t *pool, const char *psz_list)
+{
+    FILE *fd = fopen(psz_list, "r");
+    if (fd == NULL)
+    {
+        pool->pf_log(pool->param, DVBINFO_LOG_ERROR, "failed opening input list %s\n",
+                     psz_list);
+        return false;
+    }
+
+    bool b_ok = true;
+    char *psz_line = NULL;
+    size_t i_line = 0;
+    unsigned int i_number = 0;
+    while (b_ok && (getline(&psz_line, &i_line, fd) >= 0))
+    {
+        i_number++;
+        char *psz_end = strpbrk(psz_line, "#\r\n");
+        if (psz_end)
+            *psz_end = '\0';
+
+        char *psz_save = NULL;
+        char *psz_input = strtok_r(psz_line, " \t", &psz_save);
+        if (psz_input == NULL) /* empty line */
+            continue;
+
+        char *psz_interface = NULL;
+        char *psz_host = strchr(psz_input, '@');
+        if (psz_host)
+        {
+            *psz_host++ = '\0';
+            psz_interface = psz_input;
+        }
+        else
+            psz_host = psz_input;
+
+        char *psz_port = strrchr(psz_host, ':');
+        int port = psz_port ? (int)strtol(psz_port + 1, NULL, 10) : 0;
+        if ((psz_port == NULL) || (port <= 0) || (port > 65535))
+        {
+            pool->pf_log(pool->param, DVBINFO_LOG_ERROR, "%s:%u: expected [interface@]host:port\n",
+                         psz_list, i_number);
+            b_ok = false;
+            break;
+        }
+        *psz_port = '\0';
+
+        b_ok = pool_add(pool, psz_interface, psz_host, port);
+    }
+    free(psz_line);
+    fclose(fd);
+    return b_ok;
+}
+
+/* Spread the load of the last period over the workers, biggest inputs first
+ * to the least loaded worker. Inputs only move when that lowers the busiest
+ * worker's load by a tenth, so measurement noise does not shuffle them. */
+static void pool_rebalance(pool_t *pool)
+{
+    size_t *p_order = (size_t *)malloc(pool->i_inputs * sizeof(size_t));
+    unsigned int *p_target = (unsigned int *)malloc(pool->i_inputs * sizeof(unsigned int));
+    if ((p_order == NULL) || (p_target == NULL))
+        goto out;
+
+    uint64_t i_max = 0;
+    for (unsigned int j = 0; j < pool->i_workers; j++)
+        pool->p_workers[j].i_load = 0;
+    size_t i_count = 0;
+    for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        uint64_t i_busy = __atomic_load_n(&input->i_busy, __ATOMIC_RELAXED);
+        input->i_load = i_busy - input->i_busy_last;
+        input->i_busy_last = i_busy;
+        if (__atomic_load_n(&input->b_closed, __ATOMIC_ACQUIRE))
+            continue;
+
+        pool_worker_t *worker = &pool->p_workers[input->i_target];
+        worker->i_load += input->i_load;
+        if (worker->i_load > i_max)
+            i_max = worker->i_load;
+
+        size_t k = i_count++; /* insertion sort, stable */
+        for (; (k > 0) && (pool->pp_inputs[p_order[k - 1]]->i_load < input->i_load); k--)
+            p_order[k] = p_order[k - 1];
+        p_order[k] = i;
+    }
+
+    uint64_t i_new_max = 0;
+    for (unsigned int j = 0; j < pool->i_workers; j++)
+        pool->p_workers[j].i_load = 0;
+    for (size_t i = 0; i < i_count; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[p_order[i]];
+        unsigned int i_min = input->i_target; /* stay on ties */
+        for (unsigned int j = 0; j < pool->i_workers; j++)
+        {
+            if (pool->p_workers[j].i_load < pool->p_workers[i_min].i_load)
+                i_min = j;
+        }
+        pool_worker_t *worker = &pool->p_workers[i_min];
+        worker->i_load += input->i_load;
+        if (worker->i_load > i_new_max)
+            i_new_max = worker->i_load;
+        p_target[p_order[i]] = i_min;
+    }
+    if (i_new_max * 10 >= i_max * 9)
+        goto out;
+
+    for (size_t i = 0; i < i_count; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[p_order[i]];
+        unsigned int i_target = p_target[p_order[i]];
+        if (i_target == input->i_target)
+            continue;
+        unsigned int i_owner = __atomic_load_n(&input->i_worker, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&input->i_target, i_target, __ATOMIC_RELEASE);
+        __atomic_store_n(&pool->p_workers[i_owner].b_move, true, __ATOMIC_RELEASE);
+    }
+    pool->pf_log(pool->param, DVBINFO_LOG_INFO,
+                 "rebalanced inputs, busiest worker %"PRIu64" ms -> %"PRIu64" ms per %d ms\n",
+                 i_max / 1000000, i_new_max / 1000000, POOL_REBALANCE);
+
+out:
+    free(p_order);
+    free(p_target);
+}
+
+/* All inputs' last snapshots as one document, labelled by input */
+static void pool_metrics(pool_t *pool, FILE *fd, const int mode)
+{
+    ts_metrics_t **pp_metrics = (ts_metrics_t **)malloc(pool->i_inputs * sizeof(ts_metrics_t *));
+    const char **pp_names = (const char **)malloc(pool->i_inputs * sizeof(char *));
+    if (pp_metrics && pp_names)
+    {
+        for (size_t i = 0; i < pool->i_inputs; i++)
+        {
+            pthread_mutex_lock(&pool->pp_inputs[i]->lock);
+            pp_metrics[i] = pool->pp_inputs[i]->metrics;
+            pp_names[i] = pool->pp_inputs[i]->psz_name;
+        }
+        metrics_write(fd, mode, pp_metrics, pp_names, pool->i_inputs, true);
+        for (size_t i = 0; i < pool->i_inputs; i++)
+            pthread_mutex_unlock(&pool->pp_inputs[i]->lock);
+    }
+    free(pp_metrics);
+    free(pp_names);
+}
+
+/* Answer the clients waiting on the metrics socket */
+static void pool_metrics_serve(pool_t *pool, metrics_server_t *server)
+{
+    const int mode = (pool->param->summary.mode == SUM_JSON) ? SUM_JSON : SUM_OPENMETRICS;
+    int fd;
+    while ((fd = metrics_accept(server)) >= 0)
+    {
+        char *p_data = NULL;
+        size_t i_size = 0;
+        FILE *mem = open_memstream(&p_data, &i_size);
+        if (mem)
+        {
+            pool_metrics(pool, mem, mode);
+            fclose(mem);
+        }
+        metrics_send(fd, p_data, mem ? i_size : 0);
+        free(p_data);
+    }
+}
+
+/* Gather the inputs' last summaries into one file, renamed in place */
+static void pool_summary(pool_t *pool, const char *psz_temp)
+{
+    params_t *param = pool->param;
+    FILE *fd = fopen(psz_temp, "w+");
+    if (fd == NULL)
+    {
+        pool->pf_log(param, DVBINFO_LOG_ERROR,
+                     "failed opening summary file (disabling summary logging)\n");
+        param->b_summary = false;
+        return;
+    }
+
+    if (pool_metrics_mode(param->summary.mode))
+        pool_metrics(pool, fd, param->summary.mode);
+    else for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        fprintf(fd, "input: %s%s\n", input->psz_name,
+                __atomic_load_n(&input->b_closed, __ATOMIC_ACQUIRE) ? " (closed)" : "");
+        pthread_mutex_lock(&input->lock);
+        if (input->p_summary)
+            fwrite(input->p_summary, 1, input->i_summary, fd);
+        pthread_mutex_unlock(&input->lock);
+        fprintf(fd, "\n");
+    }
+    fflush(fd);
+    fclose(fd);
+
+    unlink(param->summary.file);
+    if (rename(psz_temp, param->summary.file) < 0)
+    {
+        pool->pf_log(param, DVBINFO_LOG_ERROR,
+                     "failed renaming summary file (disabling summary logging)\n");
+        param->b_summary = false;
+    }
+}
+
+int pool_run(pool_t *pool)
+{
+    params_t *param = pool->param;
+    metrics_server_t *server = NULL;
+    char *psz_temp = NULL;
+    int err = -1;
+
+    if (pool->i_inputs == 0)
+    {
+        pool->pf_log(param, DVBINFO_LOG_ERROR, "no inputs\n");
+        return err;
+    }
+    if (param->b_summary && (asprintf(&psz_temp, "%s.part", param->summary.file) < 0))
+    {
+        pool->pf_log(param, DVBINFO_LOG_ERROR, "Could not create temporary summary file %s\n",
+                     param->summary.file);
+        return err;
+    }
+    if (param->summary.socket)
+    {
+        server = metrics_listen(param->summary.socket);
+        if (server == NULL)
+        {
+            pool->pf_log(param, DVBINFO_LOG_ERROR, "failed opening metrics socket %s\n",
+                         param->summary.socket);
+            free(psz_temp);
+            return err;
+        }
+    }
+    pool->b_metrics = server || (param->b_summary && pool_metrics_mode(param->summary.mode));
+
+    for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = input };
+        if (epoll_ctl(pool->p_workers[input->i_worker].epfd, EPOLL_CTL_ADD,
+                      input->fd, &event) < 0)
+            goto out;
+    }
+
+    long i_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    pool->b_alive = true;
+    for (unsigned int j = 0; j < pool->i_workers; j++)
+    {
+        pool_worker_t *worker = &pool->p_workers[j];
+        if (pthread_create(&worker->handle, NULL, pool_worker, (void *)worker) != 0)
+        {
+            pool->pf_log(param, DVBINFO_LOG_ERROR, "failed creating thread\n");
+            __atomic_store_n(&pool->b_alive, false, __ATOMIC_RELEASE);
+            break;
+        }
+        worker->b_started = true;
+#ifdef __linux__
+        /* one worker per core, the scheduler is free to ignore this */
+        if (i_cores > 0)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(j % i_cores, &cpus);
+            pthread_setaffinity_np(worker->handle, sizeof(cpus), &cpus);
+        }
+#endif
+    }
+    pool->pf_log(param, DVBINFO_LOG_INFO, "monitoring %zu inputs with %u workers\n",
+                 pool->i_inputs, pool->i_workers);
+
+    mtime_t rebalance = mdate() + POOL_REBALANCE;
+    mtime_t deadline = mdate() + param->summary.period;
+    while (__atomic_load_n(&pool->b_alive, __ATOMIC_ACQUIRE))
+    {
+        nanosleep(&(struct timespec){ 0, POOL_WAIT * 1000000 }, NULL);
+
+        mtime_t now = mdate();
+        if ((pool->i_workers > 1) && (now >= rebalance))
+        {
+            pool_rebalance(pool);
+            rebalance = now + POOL_REBALANCE;
+        }
+        /* workers refresh their part each period, publish it a period later */
+        if (param->b_summary && (now >= deadline))
+        {
+            pool_summary(pool, psz_temp);
+            deadline = now + param->summary.period;
+        }
+        if (server)
+            pool_metrics_serve(pool, server);
+    }
+    err = 0;
+
+out:
+    __atomic_store_n(&pool->b_alive, false, __ATOMIC_RELEASE);
+    for (unsigned int j = 0; j < pool->i_workers; j++)
+    {
+        pool_worker_t *worker = &pool->p_workers[j];
+        if (worker->b_started && (pthread_join(worker->handle, NULL) != 0))
+            pool->pf_log(param, DVBINFO_LOG_ERROR, "error joining worker thread\n");
+        worker->b_started = false;
+    }
+    metrics_close(server);
+    free(psz_temp);
+    return err;
+}
+
+void pool_free(pool_t *pool)
+{
+    if (pool == NULL)
+        return;
+
+    for (size_t i = 0; i < pool->i_inputs; i++)
+    {
+        pool_input_t *input = pool->pp_inputs[i];
+        if (input->fd >= 0)
+            udp_close(input->fd);
+        libdvbpsi_exit(input->stream);
+        libdvbpsi_metrics_delete(input->metrics);
+        pthread_mutex_destroy(&input->lock);
+        free(input->p_summary);
+        free(input->psz_name);
+        free(input);
+    }
+    free(pool->pp_inputs);
+
+    for (unsigned int j = 0; j < pool->i_workers; j++)
+    {
+        if (pool->p_workers[j].epfd >= 0)
+            close(pool->p_workers[j].epfd);
+        free(pool->p_workers[j].p_data);
+    }
+    free(pool->p_workers);
+    dvbpsi_section_cache_delete(pool->cache);
+    free(pool);
+}
@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * pool.h: many udp inputs on a fixed pool of worker threads
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef DVBINFO_POOL_H_
+#define DVBINFO_POOL_H_
+
+typedef struct pool_s pool_t;
+
+/* Worker pool:
+ * Each input is a non-blocking udp socket with its own ts_stream_t, owned
+ * by exactly one worker thread at a time. Workers wait on their own epoll
+ * set and are pinned one per core. Every few seconds the time spent per
+ * input is measured and inputs are moved from busy to idle workers.
+ *
+ * pool_new()  - pool of i_workers threads (0: one per online core), using
+ *               the debug level, rcvbuf and summary settings of param
+ * pool_add()  - open one input, returns false when it cannot be opened
+ * pool_add_list() - open the inputs listed in a file, one per line as
+ *               [interface@]host:port, '#' starts a comment
+ * pool_run()  - run until every input is closed, writes the summary of all
+ *               inputs to param->summary.file every summary period
+ * pool_free() - close all inputs and release the pool
+ */
+pool_t *pool_new(params_t *param, ts_stream_log_cb pf_log, unsigned int i_workers);
+bool pool_add(pool_t *pool, const char *interface, const char *ipaddress, int port);
+bool pool_add_list(pool_t *pool, const char *psz_list);
+int pool_run(pool_t *pool);
+void pool_free(pool_t *pool);
+
+#endif
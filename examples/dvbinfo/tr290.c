@@ -0,0 +1,345 @@
+/*****************************************************************************
+ * tr290.c: TR 101 290 priority 1 and 2 checks
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
+
+#include "tr290.h"
+
+/* ai_cc[]: last continuity counter, or one of these */
+#define TR290_CC_NONE   0xff
+#define TR290_CC_DUP    0x10    /* or'ed in once a duplicate was seen */
+
+/* Section or packet repetition watched on a PID */
+typedef struct
+{
+    uint16_t i_pid;
+    bool     b_section;     /* a PAT or PMT section must start, not any packet */
+    bool     b_late;        /* counted already for the current gap */
+    int64_t  i_limit;       /* ns */
+    int64_t  i_last;        /* ns, last occurrence, < 0 not yet */
+} tr290_watch_t;
+
+struct tr290_s
+{
+    tr290_counter_t counters[TR290_CHECKS];
+
+    int64_t  i_pid_timeout;
+    bool     b_cat;             /* a CAT section was seen */
+    bool     b_cat_missing;     /* counted scrambling without CAT */
+
+    uint8_t  ai_cc[8192];
+    uint16_t ai_watch[8192];    /* index + 1 in p_watch, 0 if not watched */
+    tr290_watch_t *p_watch;
+    unsigned int i_watch;
+    unsigned int i_watch_max;
+};
+
+static const struct
+{
+    const char *psz_name;
+    int         i_priority;
+} checks[TR290_CHECKS] =
+{
+    [TR290_SYNC_LOSS]               = { "TS_sync_loss", 1 },
+    [TR290_PAT_ERROR]               = { "PAT_error_2", 1 },
+    [TR290_CC_ERROR]                = { "Continuity_count_error", 1 },
+    [TR290_PMT_ERROR]               = { "PMT_error_2", 1 },
+    [TR290_PID_ERROR]               = { "PID_error", 1 },
+    [TR290_TRANSPORT_ERROR]         = { "Transport_error", 2 },
+    [TR290_CRC_ERROR]               = { "CRC_error", 2 },
+    [TR290_PCR_REPETITION_ERROR]    = { "PCR_repetition_error", 2 },
+    [TR290_PCR_DISCONTINUITY_ERROR] = { "PCR_discontinuity_indicator_error", 2 },
+    [TR290_PCR_ACCURACY_ERROR]      = { "PCR_accuracy_error", 2 },
+    [TR290_CAT_ERROR]               = { "CAT_error", 2 },
+};
+
+const char *tr290_name(const tr290_check_t check)
+{
+    assert(check < TR290_CHECKS);
+    return checks[check].psz_name;
+}
+
+int tr290_priority(const tr290_check_t check)
+{
+    assert(check < TR290_CHECKS);
+    return checks[check].i_priority;
+}
+
+/* Counters are shared by the threads running tr290_packet(), the first and
+ * last times are the smallest and largest reported whatever the order */
+static void tr290_count(tr290_t *tr290, const tr290_check_t check, const int64_t i_time,
+                        const uint64_t i_count)
+{
+    tr290_counter_t *counter = &tr290->counters[check];
+
+    __atomic_add_fetch(&counter->i_count, i_count, __ATOMIC_RELAXED);
+    if (i_time < 0)
+        return;
+
+    int64_t i_first = __atomic_load_n(&counter->i_first, __ATOMIC_RELAXED);
+    while (((i_first < 0) || (i_time < i_first)) &&
+           !__atomic_compare_exchange_n(&counter->i_first, &i_first, i_time, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    int64_t i_last = __atomic_load_n(&counter->i_last, __ATOMIC_RELAXED);
+    while ((i_time > i_last) &&
+           !__atomic_compare_exchange_n(&counter->i_last, &i_last, i_time, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+tr290_t *tr290_new(const int64_t i_pid_timeout)
+{
+    tr290_t *tr290 = (tr290_t *)calloc(1, sizeof(tr290_t));
+    if (tr290 == NULL)
+        return NULL;
+
+    for (int i = 0; i < TR290_CHECKS; i++)
+    {
+        tr290->counters[i].i_first = -1;
+        tr290->counters[i].i_last = -1;
+    }
+    tr290->i_pid_timeout = (i_pid_timeout > 0) ? i_pid_timeout : TR290_PID_TIMEOUT;
+    memset(tr290->ai_cc, TR290_CC_NONE, sizeof(tr290->ai_cc));
+
+    /* PAT sections are always expected */
+    if (!tr290_reference(tr290, 0x00, true, -1))
+    {
+        tr290_delete(tr290);
+        return NULL;
+    }
+    return tr290;
+}
+
+void tr290_delete(tr290_t *tr290)
+{
+    if (tr290)
+        free(tr290->p_watch);
+    free(tr290);
+}
+
+bool tr290_reference(tr290_t *tr290, const uint16_t i_pid, const bool b_pmt,
+                     const int64_t i_time)
+{
+    assert(i_pid < 8192);
+    if (tr290->ai_watch[i_pid] != 0)
+    {
+        /* a PMT PID listed as elementary stream too keeps its section check */
+        tr290_watch_t *watch = &tr290->p_watch[tr290->ai_watch[i_pid] - 1];
+        if (b_pmt && !watch->b_section)
+        {
+            watch->b_section = true;
+            watch->i_limit = TR290_SECTION_INTERVAL;
+        }
+        return true;
+    }
+
+    if (tr290->i_watch == tr290->i_watch_max)
+    {
+        unsigned int i_max = tr290->i_watch_max ? 2 * tr290->i_watch_max : 16;
+        tr290_watch_t *p_watch = (tr290_watch_t *)realloc(tr290->p_watch,
+                                                           i_max * sizeof(tr290_watch_t));
+        if (p_watch == NULL)
+            return false;
+        tr290->p_watch = p_watch;
+        tr290->i_watch_max = i_max;
+    }
+
+    tr290_watch_t *watch = &tr290->p_watch[tr290->i_watch++];
+    watch->i_pid = i_pid;
+    watch->b_section = b_pmt;
+    watch->b_late = false;
+    watch->i_limit = b_pmt ? TR290_SECTION_INTERVAL : tr290->i_pid_timeout;
+    watch->i_last = i_time;     /* the wait starts now */
+    tr290->ai_watch[i_pid] = tr290->i_watch;
+    return true;
+}
+
+/* An occurrence at i_time, late if the previous one is too long ago. Packets
+ * from before the watch started are ignored, whatever order they come in. */
+static void tr290_seen(tr290_t *tr290, tr290_watch_t *watch, const int64_t i_time)
+{
+    if ((i_time < 0) || (i_time < watch->i_last))
+        return;
+    if ((watch->i_last >= 0) && !watch->b_late &&
+        (i_time - watch->i_last > watch->i_limit))
+    {
+        tr290_check_t check = (watch->i_pid == 0x00) ? TR290_PAT_ERROR :
+                              watch->b_section ? TR290_PMT_ERROR : TR290_PID_ERROR;
+        tr290_count(tr290, check, watch->i_last + watch->i_limit, 1);
+    }
+    watch->i_last = i_time;
+    watch->b_late = false;
+}
+
+/* table_id of the section starting in the packet, -1 if none */
+static int tr290_table_id(const uint8_t *p_packet)
+{
+    if (!(p_packet[1] & 0x40) || !(p_packet[3] & 0x10))
+        return -1;
+    unsigned int i_pos = 4;
+    if (p_packet[3] & 0x20)
+        i_pos += 1 + p_packet[4];
+    if (i_pos >= 188)
+        return -1;
+    i_pos += 1 + p_packet[i_pos];   /* pointer_field */
+    return (i_pos < 188) ? p_packet[i_pos] : -1;
+}
+
+static void tr290_cc(tr290_t *tr290, const uint8_t *p_packet, const uint16_t i_pid,
+                     const int64_t i_time)
+{
+    const uint8_t i_cc = p_packet[3] & 0x0f;
+    const bool b_payload = (p_packet[3] & 0x10);
+    const bool b_discontinuity = (p_packet[3] & 0x20) && (p_packet[4] > 0) &&
+                                 (p_packet[5] & 0x80);
+    const uint8_t i_last = tr290->ai_cc[i_pid];
+
+    if ((i_last == TR290_CC_NONE) || b_discontinuity)
+    {
+        tr290->ai_cc[i_pid] = i_cc;
+        return;
+    }
+
+    const uint8_t i_prev = i_last & 0x0f;
+    if (!b_payload)
+    {
+        /* no increment without payload */
+        if (i_cc != i_prev)
+            tr290_count(tr290, TR290_CC_ERROR, i_time, 1);
+        tr290->ai_cc[i_pid] = i_cc;
+    }
+    else if (i_cc == i_prev)
+    {
+        /* one duplicate packet is allowed */
+        if (i_last & TR290_CC_DUP)
+            tr290_count(tr290, TR290_CC_ERROR, i_time, 1);
+        tr290->ai_cc[i_pid] = i_cc | TR290_CC_DUP;
+    }
+    else
+    {
+        if (i_cc != ((i_prev + 1) & 0x0f))
+            tr290_count(tr290, TR290_CC_ERROR, i_time, 1);
+        tr290->ai_cc[i_pid] = i_cc;
+    }
+}
+
+void tr290_packet(tr290_t *tr290, const uint8_t *p_packet, const int64_t i_time)
+{
+    const uint16_t i_pid = ((uint16_t)(p_packet[1] & 0x1f) << 8) | p_packet[2];
+    const bool b_scrambled = (p_packet[3] & 0xc0);
+
+    if (i_pid == 0x1fff)
+        return;
+
+    if (p_packet[1] & 0x80)
+        tr290_count(tr290, TR290_TRANSPORT_ERROR, i_time, 1);
+    tr290_cc(tr290, p_packet, i_pid, i_time);
+
+    if (i_pid == 0x01)
+    {
+        int i_table_id = tr290_table_id(p_packet);
+        if (i_table_id == 0x01)
+            __atomic_store_n(&tr290->b_cat, true, __ATOMIC_RELAXED);
+        else if (i_table_id >= 0)
+            tr290_count(tr290, TR290_CAT_ERROR, i_time, 1);
+    }
+    else if (b_scrambled && !__atomic_load_n(&tr290->b_cat, __ATOMIC_RELAXED) &&
+             !__atomic_load_n(&tr290->b_cat_missing, __ATOMIC_RELAXED))
+    {
+        /* counted once, this packet may run in any thread */
+        if (!__atomic_exchange_n(&tr290->b_cat_missing, true, __ATOMIC_RELAXED))
+            tr290_count(tr290, TR290_CAT_ERROR, i_time, 1);
+    }
+
+    const uint16_t i_watch = tr290->ai_watch[i_pid];
+    if (i_watch == 0)
+        return;
+
+    tr290_watch_t *watch = &tr290->p_watch[i_watch - 1];
+    if (!watch->b_section)
+    {
+        tr290_seen(tr290, watch, i_time);
+        return;
+    }
+
+    const tr290_check_t check = (i_pid == 0x00) ? TR290_PAT_ERROR : TR290_PMT_ERROR;
+    if (b_scrambled)
+        tr290_count(tr290, check, i_time, 1);
+
+    int i_table_id = tr290_table_id(p_packet);
+    if (i_table_id < 0)
+        return;
+    if (i_table_id == ((i_pid == 0x00) ? 0x00 : 0x02))
+        tr290_seen(tr290, watch, i_time);
+    else if (i_pid == 0x00)
+        tr290_count(tr290, TR290_PAT_ERROR, i_time, 1);
+}
+
+void tr290_report(tr290_t *tr290, const tr290_check_t check, const int64_t i_time,
+                  const uint64_t i_count)
+{
+    assert(check < TR290_CHECKS);
+    if (i_count > 0)
+        tr290_count(tr290, check, i_time, i_count);
+}
+
+void tr290_tick(tr290_t *tr290, const int64_t i_time)
+{
+    if (i_time < 0)
+        return;
+
+    for (unsigned int i = 0; i < tr290->i_watch; i++)
+    {
+        tr290_watch_t *watch = &tr290->p_watch[i];
+        if (watch->i_last < 0)
+            watch->i_last = i_time;     /* time became known */
+        else if (!watch->b_late && (i_time - watch->i_last > watch->i_limit))
+        {
+            tr290_check_t check = (watch->i_pid == 0x00) ? TR290_PAT_ERROR :
+                                  watch->b_section ? TR290_PMT_ERROR : TR290_PID_ERROR;
+            tr290_count(tr290, check, watch->i_last + watch->i_limit, 1);
+            watch->b_late = true;
+        }
+    }
+}
+
+void tr290_get(const tr290_t *tr290, tr290_counter_t *p_counters)
+{
+    for (int i = 0; i < TR290_CHECKS; i++)
+    {
+        p_counters[i].i_count = __atomic_load_n(&tr290->counters[i].i_count, __ATOMIC_RELAXED);
+        p_counters[i].i_first = __atomic_load_n(&tr290->counters[i].i_first, __ATOMIC_RELAXED);
+        p_counters[i].i_last = __atomic_load_n(&tr290->counters[i].i_last, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************
+ * tr290.h: TR 101 290 priority 1 and 2 checks
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef DVBINFO_TR290_H_
+#define DVBINFO_TR290_H_
+
+typedef enum
+{
+    /* priority 1 */
+    TR290_SYNC_LOSS = 0,        /* 1.1 */
+    TR290_PAT_ERROR,            /* 1.3a */
+    TR290_CC_ERROR,             /* 1.4 */
+    TR290_PMT_ERROR,            /* 1.5a */
+    TR290_PID_ERROR,            /* 1.6 */
+    /* priority 2 */
+    TR290_TRANSPORT_ERROR,      /* 2.1 */
+    TR290_CRC_ERROR,            /* 2.2 */
+    TR290_PCR_REPETITION_ERROR, /* 2.3a */
+    TR290_PCR_DISCONTINUITY_ERROR, /* 2.3b */
+    TR290_PCR_ACCURACY_ERROR,   /* 2.4 */
+    TR290_CAT_ERROR,            /* 2.6 */
+    TR290_CHECKS
+} tr290_check_t;
+
+/* Times in ns on the clock of the caller, negative if unknown */
+typedef struct tr290_counter_s
+{
+    uint64_t i_count;
+    int64_t  i_first;           /* time of the first error */
+    int64_t  i_last;            /* time of the latest error */
+} tr290_counter_t;
+
+#define TR290_SECTION_INTERVAL 500000000    /* ns, PAT and PMT */
+#define TR290_PID_TIMEOUT      5000000000LL /* ns, default for referenced PIDs */
+
+typedef struct tr290_s tr290_t;
+
+/* TR 101 290 conformance checks of one transport stream:
+ * tr290_new()     - engine with all counters at zero, i_pid_timeout is how
+ *                   long a referenced PID may be missing (0: TR290_PID_TIMEOUT)
+ * tr290_reference() - i_pid carries a PMT (b_pmt) or an elementary stream
+ *                   of one, its repetition is checked from i_time on
+ * tr290_packet()  - check one packet: transport error, continuity counter,
+ *                   table_id and scrambling on PAT, CAT and PMT PIDs, and the
+ *                   repetition of PAT and PMT sections and referenced PIDs.
+ *                   May run concurrently for distinct PIDs.
+ * tr290_report()  - account i_count errors found elsewhere (sync loss, CRC,
+ *                   PCR checks)
+ * tr290_tick()    - flag PAT, PMT and referenced PIDs missing since before
+ *                   i_time, call it regularly and never concurrently with
+ *                   tr290_packet() or tr290_reference()
+ * tr290_get()     - copy of the TR290_CHECKS counters
+ * tr290_name()    - TR 101 290 name of a check
+ * tr290_priority() - its priority, 1 or 2
+ *
+ * Missing sections and PIDs are counted once per gap, at the time the gap
+ * went beyond its limit, whether the next packet or tr290_tick() finds it.
+ */
+tr290_t *tr290_new(const int64_t i_pid_timeout);
+void tr290_delete(tr290_t *tr290);
+
+bool tr290_reference(tr290_t *tr290, const uint16_t i_pid, const bool b_pmt,
+                     const int64_t i_time);
+void tr290_packet(tr290_t *tr290, const uint8_t *p_packet, const int64_t i_time);
+void tr290_report(tr290_t *tr290, const tr290_check_t check, const int64_t i_time,
+                  const uint64_t i_count);
+void tr290_tick(tr290_t *tr290, const int64_t i_time);
+
+void tr290_get(const tr290_t *tr290, tr290_counter_t *p_counters);
+const char *tr290_name(const tr290_check_t check);
+int tr290_priority(const tr290_check_t check);
+
+#endif
@@ -28,6 +28,13 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
+
+#if defined(HAVE_INTTYPES_H)
+#   include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#   include <stdint.h>
+#endif
 
 #include <sys/time.h>
 #include <sys/types.h>
@@ -65,6 +72,8 @@
 
 #include "udp.h"
 
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
 #ifdef HAVE_SYS_SOCKET_H
 static bool is_multicast(const struct sockaddr_storage *saddr, socklen_t len)
 {
@@ -207,7 +216,7 @@ int udp_close(int fd)
     return result;
 }
 
-int udp_open(const char *interface, const char *ipaddress, int port)
+int udp_open(const char *interface, const char *ipaddress, int port, int rcvbuf)
 {
     int s_ctl = -1;
     int result = -1;
@@ -262,11 +271,27 @@ int udp_open(const char *interface, const char *ipaddress, int port)
         }
 #endif
 
-        /* Increase the receive buffer size to 1/2MB (8Mb/s during 1/2s)
-         * to avoid packet loss caused in case of scheduling hiccups */
+        /* Increase the receive buffer size to avoid packet loss caused
+         * in case of scheduling hiccups, the kernel caps it at rmem_max */
         if (setsockopt (s_ctl, SOL_SOCKET, SO_RCVBUF,
-                    (void *)&(int){ 0x80000 }, sizeof (int)) < 0)
+                    (void *)&rcvbuf, sizeof (int)) < 0)
             perror("udp setsockopt error");
+        else
+        {
+            int actual = 0;
+            socklen_t optlen = sizeof(actual);
+            /* linux reports twice the requested size (bookkeeping overhead) */
+            if ((getsockopt(s_ctl, SOL_SOCKET, SO_RCVBUF, &actual, &optlen) == 0) &&
+                (actual < rcvbuf))
+                fprintf(stderr, "udp warning: receive buffer limited to %d bytes "
+                        "(requested %d), raise net.core.rmem_max\n", actual, rcvbuf);
+        }
+
+#ifdef SO_TIMESTAMPNS
+        /* kernel arrival time per datagram */
+        if (setsockopt (s_ctl, SOL_SOCKET, SO_TIMESTAMPNS, &(int){ 1 }, sizeof (int)) < 0)
+            perror("udp setsockopt error");
+#endif
 
         if (setsockopt (s_ctl, SOL_SOCKET, SO_SNDBUF,
                     (void *)&(int){ 0x80000 }, sizeof (int)) < 0)
@@ -329,4 +354,91 @@ again:
     }
     return err;
 }
+
+static int64_t udp_arrival(struct msghdr *msg)
+{
+#ifdef SO_TIMESTAMPNS
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+        {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return (int64_t)ts.tv_sec * INT64_C(1000000000) + ts.tv_nsec;
+        }
+    }
+#else
+    (void)msg;
+#endif
+    return 0;
+}
+
+#define UDP_CMSG_SIZE CMSG_SPACE(sizeof(struct timespec))
+
+int udp_read_batch(int fd, udp_datagram_t *p_datagrams, unsigned int i_count, bool b_wait)
+{
+    struct iovec iov[UDP_BATCH_MAX];
+    union {
+        struct cmsghdr align;
+        uint8_t data[UDP_CMSG_SIZE];
+    } control[UDP_BATCH_MAX];
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+#else
+    struct { struct msghdr msg_hdr; unsigned int msg_len; } msgs[1];
+#endif
+    int err;
+
+    if (i_count > ARRAY_SIZE(msgs))
+        i_count = ARRAY_SIZE(msgs);
+    if (i_count == 0)
+        return 0;
+
+    memset(msgs, 0, i_count * sizeof(msgs[0]));
+    for (unsigned int i = 0; i < i_count; i++)
+    {
+        iov[i].iov_base = p_datagrams[i].p_data;
+        iov[i].iov_len = p_datagrams[i].i_size;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i].data;
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i].data);
+    }
+
+again:
+#ifdef HAVE_RECVMMSG
+    /* block for the first datagram, then take what is queued */
+    err = recvmmsg(fd, msgs, i_count, b_wait ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+#else
+    err = recvmsg(fd, &msgs[0].msg_hdr, b_wait ? 0 : MSG_DONTWAIT);
+    if (err >= 0)
+    {
+        msgs[0].msg_len = err;
+        err = 1;
+    }
+#endif
+    if (err < 0)
+    {
+        switch(errno)
+        {
+            case EAGAIN:
+                if (!b_wait)
+                    return 0;
+                /* fall through */
+            case EINTR:
+                goto again;
+            default:
+                fprintf(stderr, "recv error: %s\n", strerror(errno));
+                return -1;
+        }
+    }
+
+    for (int i = 0; i < err; i++)
+    {
+        p_datagrams[i].i_length = msgs[i].msg_len;
+        p_datagrams[i].i_arrival = udp_arrival(&msgs[i].msg_hdr);
+    }
+    return err;
+}
 #endif
@@ -24,9 +24,29 @@
 #ifndef DVBINFO_UDP_H_
 #define DVBINFO_UDP_H_
 
-int udp_open(const char *interface, const char *ipaddress, int port);
+#define UDP_BATCH_MAX 64    /* datagrams per udp_read_batch() call */
+
+/* Datagram slot for udp_read_batch() */
+typedef struct udp_datagram_s
+{
+    void    *p_data;    /* where to receive the datagram */
+    size_t   i_size;    /* size of p_data */
+    size_t   i_length;  /* received bytes */
+    int64_t  i_arrival; /* kernel arrival time in ns since epoch, 0 if unknown */
+} udp_datagram_t;
+
+/* udp_open()       - bind (and join multicast), rcvbuf bytes of receive buffer
+ * udp_close()      - close socket
+ * udp_read()       - receive one datagram
+ * udp_read_batch() - receive up to i_count datagrams with one syscall (recvmmsg),
+ *                    waits for the first one only if b_wait, returns the number
+ *                    received, 0 when nothing is queued and b_wait is false
+ */
+int udp_open(const char *interface, const char *ipaddress, int port, int rcvbuf);
 int udp_close(int fd);
 ssize_t udp_read(int fd, void *buf, size_t count);
+int udp_read_batch(int fd, udp_datagram_t *p_datagrams, unsigned int i_count,
+                   bool b_wait);
 
 #endif
 
@@ -0,0 +1,819 @@
+/*****************************************************************************
+ * bench_dvbpsi.c: throughput of the PSI decoders, generators and CRC_32
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id: $
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ * Synthetic PAT, PMT, SDT, NIT and EIT tables are built with the
+ * *_sections_generate() functions, packetized and pushed through a chain
+ * demux over and over, alternating two versions so that every round is a
+ * new table for the decoder. Results are printed as a table, or as JSON
+ * with -j to keep track of regressions between releases.
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include <assert.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* The libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/chain.h"
+#include "../src/trace.h"
+#ifdef HAVE_PTHREAD_H
+#include "../src/executor.h"
+#endif
+#include "../src/descriptor.h"
+#include "../src/tables/pat.h"
+#include "../src/tables/pmt.h"
+#include "../src/tables/sdt.h"
+#include "../src/tables/nit.h"
+#include "../src/tables/eit.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/chain.h>
+#include <dvbpsi/trace.h>
+#ifdef HAVE_PTHREAD_H
+#include <dvbpsi/executor.h>
+#endif
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/pat.h>
+#include <dvbpsi/pmt.h>
+#include <dvbpsi/sdt.h>
+#include <dvbpsi/nit.h>
+#include <dvbpsi/eit.h>
+#endif
+
+/*****************************************************************************
+ * Allocation counting: with glibc the library's malloc() calls resolve to
+ * these, which forward to the C library. Counted per thread, the -p workers
+ * allocate too.
+ *****************************************************************************/
+#if defined(__GLIBC__)
+#define BENCH_ALLOCS 1
+
+extern void *__libc_malloc(size_t i_size);
+extern void *__libc_calloc(size_t i_count, size_t i_size);
+extern void *__libc_realloc(void *p, size_t i_size);
+
+static __thread uint64_t i_allocs = 0;
+
+void *malloc(size_t i_size)
+{
+    i_allocs++;
+    return __libc_malloc(i_size);
+}
+
+void *calloc(size_t i_count, size_t i_size)
+{
+    i_allocs++;
+    return __libc_calloc(i_count, i_size);
+}
+
+void *realloc(void *p, size_t i_size)
+{
+    i_allocs++;
+    return __libc_realloc(p, i_size);
+}
+#else
+static uint64_t i_allocs = 0; /* not counted */
+#endif
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+    /* errors would make the figures meaningless */
+    if (level == DVBPSI_MSG_ERROR)
+        fprintf(stderr, "Error: %s\n", msg);
+}
+
+/*****************************************************************************
+ * Synthetic tables
+ *****************************************************************************/
+static uint8_t ai_language[] = { 'e', 'n', 'g', 0x00 };                    /* 0x0a */
+static uint8_t ai_service[] = { 0x01, 0x04, 'b', 'e', 'n', 'c',
+                                0x08, 's', 'e', 'r', 'v', 'i', 'c', 'e', 's' }; /* 0x48 */
+static uint8_t ai_service_list[] = { 0x00, 0x01, 0x01, 0x00, 0x02, 0x01,
+                                     0x00, 0x03, 0x01, 0x00, 0x04, 0x02 };  /* 0x41 */
+static uint8_t ai_short_event[] = { 'e', 'n', 'g', 0x0a, 'B', 'e', 'n', 'c', 'h',
+                                    'm', 'a', 'r', 'k', 's', 0x0e, 'A', 'n', ' ',
+                                    'e', 'v', 'e', 'n', 't', ' ', 'o', 'f', ' ',
+                                    't', 'h', 'e', ' ', 'd', 'a', 'y' };    /* 0x4d */
+
+static void *pat_new(const int i_entries, const uint8_t i_version)
+{
+    dvbpsi_pat_t *p_pat = dvbpsi_pat_new(1, i_version, true);
+    for (int i = 0; p_pat && (i < i_entries); i++)
+        dvbpsi_pat_program_add(p_pat, i + 1, 0x100 + i);
+    return p_pat;
+}
+
+static dvbpsi_psi_section_t *pat_generate(dvbpsi_t *p_dvbpsi, void *p_table)
+{
+    return dvbpsi_pat_sections_generate(p_dvbpsi, (dvbpsi_pat_t *)p_table, 253);
+}
+
+static void pat_delete(void *p_table)
+{
+    dvbpsi_pat_delete((dvbpsi_pat_t *)p_table);
+}
+
+static void *pmt_new(const int i_entries, const uint8_t i_version)
+{
+    dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(1, i_version, true, 0x101);
+    for (int i = 0; p_pmt && (i < i_entries); i++)
+    {
+        dvbpsi_pmt_es_t *p_es = dvbpsi_pmt_es_add(p_pmt, (i == 0) ? 0x1b : 0x04, 0x101 + i);
+        if (p_es && (i > 0))
+            dvbpsi_pmt_es_descriptor_add(p_es, 0x0a, sizeof(ai_language), ai_language);
+    }
+    return p_pmt;
+}
+
+static dvbpsi_psi_section_t *pmt_generate(dvbpsi_t *p_dvbpsi, void *p_table)
+{
+    return dvbpsi_pmt_sections_generate(p_dvbpsi, (dvbpsi_pmt_t *)p_table);
+}
+
+static void pmt_delete(void *p_table)
+{
+    dvbpsi_pmt_delete((dvbpsi_pmt_t *)p_table);
+}
+
+static void *sdt_new(const int i_entries, const uint8_t i_version)
+{
+    dvbpsi_sdt_t *p_sdt = dvbpsi_sdt_new(0x42, 1, i_version, true, 1);
+    for (int i = 0; p_sdt && (i < i_entries); i++)
+    {
+        dvbpsi_sdt_service_t *p_service = dvbpsi_sdt_service_add(p_sdt, i + 1, true,
+                                                                 true, 4, false);
+        if (p_service)
+            dvbpsi_sdt_service_descriptor_add(p_service, 0x48, sizeof(ai_service), ai_service);
+    }
+    return p_sdt;
+}
+
+static dvbpsi_psi_section_t *sdt_generate(dvbpsi_t *p_dvbpsi, void *p_table)
+{
+    return dvbpsi_sdt_sections_generate(p_dvbpsi, (dvbpsi_sdt_t *)p_table);
+}
+
+static void sdt_delete(void *p_table)
+{
+    dvbpsi_sdt_delete((dvbpsi_sdt_t *)p_table);
+}
+
+static void *nit_new(const int i_entries, const uint8_t i_version)
+{
+    dvbpsi_nit_t *p_nit = dvbpsi_nit_new(0x40, 1, 1, i_version, true);
+    for (int i = 0; p_nit && (i < i_entries); i++)
+    {
+        dvbpsi_nit_ts_t *p_ts = dvbpsi_nit_ts_add(p_nit, i + 1, 1);
+        if (p_ts)
+            dvbpsi_nit_ts_descriptor_add(p_ts, 0x41, sizeof(ai_service_list), ai_service_list);
+    }
+    return p_nit;
+}
+
+static dvbpsi_psi_section_t *nit_generate(dvbpsi_t *p_dvbpsi, void *p_table)
+{
+    return dvbpsi_nit_sections_generate(p_dvbpsi, (dvbpsi_nit_t *)p_table, 0x40);
+}
+
+static void nit_delete(void *p_table)
+{
+    dvbpsi_nit_delete((dvbpsi_nit_t *)p_table);
+}
+
+static void *eit_new(const int i_entries, const uint8_t i_version)
+{
+    dvbpsi_eit_t *p_eit = dvbpsi_eit_new(0x50, 1, i_version, true, 1, 1, 0, 0x50);
+    for (int i = 0; p_eit && (i < i_entries); i++)
+    {
+        /* one hour events from 2015-01-01 00:00 UTC on, MJD 57023 */
+        uint64_t i_start = ((uint64_t)57023 << 24) | ((uint64_t)(i % 24) / 10 << 20) |
+                           ((uint64_t)(i % 24) % 10 << 16);
+        dvbpsi_eit_event_t *p_event = dvbpsi_eit_event_add(p_eit, i + 1, i_start, 0x010000,
+                                                           1, false, 0);
+        if (p_event)
+            dvbpsi_eit_event_descriptor_add(p_event, 0x4d, sizeof(ai_short_event),
+                                            ai_short_event);
+    }
+    return p_eit;
+}
+
+static dvbpsi_psi_section_t *eit_generate(dvbpsi_t *p_dvbpsi, void *p_table)
+{
+    return dvbpsi_eit_sections_generate(p_dvbpsi, (dvbpsi_eit_t *)p_table, 0x50);
+}
+
+static void eit_delete(void *p_table)
+{
+    dvbpsi_eit_delete((dvbpsi_eit_t *)p_table);
+}
+
+typedef struct
+{
+    const char *psz_name;
+    uint16_t    i_pid;
+    int         i_entries;  /* programs, streams, services, transport streams, events */
+    void *(*pf_new)(const int i_entries, const uint8_t i_version);
+    dvbpsi_psi_section_t *(*pf_generate)(dvbpsi_t *p_dvbpsi, void *p_table);
+    void (*pf_delete)(void *p_table);
+} bench_table_t;
+
+static const bench_table_t tables[] =
+{
+    { "PAT", 0x00, 64, pat_new, pat_generate, pat_delete },
+    { "PMT", 0x100, 8, pmt_new, pmt_generate, pmt_delete },
+    { "SDT", 0x11, 32, sdt_new, sdt_generate, sdt_delete },
+    { "NIT", 0x10, 16, nit_new, nit_generate, nit_delete },
+    { "EIT", 0x12, 64, eit_new, eit_generate, eit_delete },
+};
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+/*****************************************************************************
+ * Decoders: one chain demux per handle, tables are counted in the uint64_t
+ * given to the chain demux and dropped
+ *****************************************************************************/
+static uint64_t i_tables = 0;
+
+static void table_pat(void *p_priv, dvbpsi_pat_t *p_pat)
+{
+    (*(uint64_t *)p_priv)++;
+    dvbpsi_pat_delete(p_pat);
+}
+
+static void table_pmt(void *p_priv, dvbpsi_pmt_t *p_pmt)
+{
+    (*(uint64_t *)p_priv)++;
+    dvbpsi_pmt_delete(p_pmt);
+}
+
+static void table_sdt(void *p_priv, dvbpsi_sdt_t *p_sdt)
+{
+    (*(uint64_t *)p_priv)++;
+    dvbpsi_sdt_delete(p_sdt);
+}
+
+static void table_nit(void *p_priv, dvbpsi_nit_t *p_nit)
+{
+    (*(uint64_t *)p_priv)++;
+    dvbpsi_nit_delete(p_nit);
+}
+
+static void table_eit(void *p_priv, dvbpsi_eit_t *p_eit)
+{
+    (*(uint64_t *)p_priv)++;
+    dvbpsi_eit_delete(p_eit);
+}
+
+static void NewSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
+                        void *p_priv)
+{
+    bool b_ok = true;
+    if (i_table_id == 0x00)
+        b_ok = dvbpsi_pat_attach(p_dvbpsi, i_table_id, i_extension, table_pat, p_priv);
+    else if (i_table_id == 0x02)
+        b_ok = dvbpsi_pmt_attach(p_dvbpsi, i_table_id, i_extension, table_pmt, p_priv);
+    else if (i_table_id == 0x42)
+        b_ok = dvbpsi_sdt_attach(p_dvbpsi, i_table_id, i_extension, table_sdt, p_priv);
+    else if (i_table_id == 0x40)
+        b_ok = dvbpsi_nit_attach(p_dvbpsi, i_table_id, i_extension, table_nit, p_priv);
+    else if ((i_table_id >= 0x4e) && (i_table_id <= 0x6f))
+        b_ok = dvbpsi_eit_attach(p_dvbpsi, i_table_id, i_extension, table_eit, p_priv);
+    if (!b_ok)
+        fprintf(stderr, "Error: failed to attach decoder for table 0x%02x\n", i_table_id);
+}
+
+static void DelSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    if (i_table_id == 0x00)
+        dvbpsi_pat_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x02)
+        dvbpsi_pmt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x42)
+        dvbpsi_sdt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x40)
+        dvbpsi_nit_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id >= 0x4e) && (i_table_id <= 0x6f))
+        dvbpsi_eit_detach(p_dvbpsi, i_table_id, i_extension);
+}
+
+/*****************************************************************************
+ * Packetization: each section starts a packet, as gen_pat does
+ *****************************************************************************/
+typedef struct
+{
+    uint8_t *p_packets;
+    size_t   i_packets;
+    unsigned int i_sections;
+} bench_ts_t;
+
+static bool bench_packetize(dvbpsi_psi_section_t *p_sections, const uint16_t i_pid,
+                            bench_ts_t *ts)
+{
+    size_t i_packets = 0;
+    unsigned int i_sections = 0;
+    for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+    {
+        size_t i_size = p->p_payload_end - p->p_data + (p->b_syntax_indicator ? 4 : 0);
+        i_packets += (i_size + 1 + 183) / 184;
+        i_sections++;
+    }
+
+    ts->p_packets = (uint8_t *)malloc(i_packets * 188);
+    if (ts->p_packets == NULL)
+        return false;
+    ts->i_packets = i_packets;
+    ts->i_sections = i_sections;
+
+    uint8_t *p_packet = ts->p_packets;
+    for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+    {
+        const uint8_t *p_byte = p->p_data;
+        const uint8_t *p_end = p->p_payload_end + (p->b_syntax_indicator ? 4 : 0);
+        bool b_start = true;
+        while (p_byte < p_end)
+        {
+            uint8_t *p_pos = p_packet + 4;
+            p_packet[0] = 0x47;
+            p_packet[1] = (b_start ? 0x40 : 0x00) | (i_pid >> 8);
+            p_packet[2] = i_pid & 0xff;
+            p_packet[3] = 0x10; /* continuity_counter set when pushed */
+            if (b_start)
+                *p_pos++ = 0x00; /* pointer_field */
+            while ((p_pos < p_packet + 188) && (p_byte < p_end))
+                *p_pos++ = *p_byte++;
+            memset(p_pos, 0xff, p_packet + 188 - p_pos);
+            p_packet += 188;
+            b_start = false;
+        }
+    }
+    assert(p_packet == ts->p_packets + i_packets * 188);
+    return true;
+}
+
+/* Both versions of a table */
+static bool bench_versions(const bench_table_t *table, dvbpsi_t *p_dvbpsi, bench_ts_t ts[2])
+{
+    for (int v = 0; v < 2; v++)
+    {
+        void *p_table = table->pf_new(table->i_entries, v);
+        if (p_table == NULL)
+            return false;
+        dvbpsi_psi_section_t *p_sections = table->pf_generate(p_dvbpsi, p_table);
+        table->pf_delete(p_table);
+        if (p_sections == NULL)
+            return false;
+        bool b_packetized = bench_packetize(p_sections, table->i_pid, &ts[v]);
+        dvbpsi_DeletePSISections(p_sections);
+        if (!b_packetized)
+            return false;
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * Output
+ *****************************************************************************/
+static bool b_json = false;
+static bool b_first = true;
+static bool b_latency = false;
+static dvbpsi_trace_histogram_t latency;
+
+static void output_section(const char *psz_name)
+{
+    if (b_json)
+    {
+        fprintf(stdout, "%s\"%s\":[", b_first ? "" : "],\n", psz_name);
+        b_first = true;
+    }
+    else
+        fprintf(stdout, "\n%s\n", psz_name);
+}
+
+static void output_item(const char *psz_format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+static void output_item(const char *psz_format, ...)
+{
+    va_list args;
+    if (b_json)
+        fprintf(stdout, "%s\n{", b_first ? "" : ",");
+    va_start(args, psz_format);
+    vfprintf(stdout, psz_format, args);
+    va_end(args);
+    fprintf(stdout, b_json ? "}" : "\n");
+    b_first = false;
+}
+
+/*****************************************************************************
+ * dvbpsi_packet_push throughput, end to end: section assembly, CRC_32,
+ * table decoding and the callback
+ *****************************************************************************/
+static bool bench_push(const bench_table_t *table, const double f_min)
+{
+    bench_ts_t ts[2] = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+    bool b_ok = false;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_ERROR);
+    if (p_dvbpsi == NULL)
+        return false;
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, DelSubtable, &i_tables))
+        goto out;
+    if (b_latency)
+    {
+        dvbpsi_trace_t trace;
+        dvbpsi_trace_histogram_init(&latency, &trace);
+        if (!dvbpsi_trace_set(p_dvbpsi, &trace))
+        {
+            fprintf(stderr, "Error: libdvbpsi was built without --enable-trace\n");
+            goto out;
+        }
+    }
+
+    if (!bench_versions(table, p_dvbpsi, ts))
+        goto out;
+
+    uint64_t i_rounds = 0, i_packets = 0, i_sections = 0;
+    uint8_t i_cc = 0;
+    const uint64_t i_tables_start = i_tables;
+    const uint64_t i_allocs_start = i_allocs;
+    const double f_start = bench_now();
+    double f_elapsed = 0.0;
+    while (f_elapsed < f_min)
+    {
+        for (int r = 0; r < 64; r++, i_rounds++)
+        {
+            bench_ts_t *p_ts = &ts[i_rounds & 1];
+            for (size_t i = 0; i < p_ts->i_packets; i++)
+            {
+                uint8_t *p_packet = &p_ts->p_packets[i * 188];
+                p_packet[3] = 0x10 | (i_cc++ & 0x0f);
+                dvbpsi_packet_push(p_dvbpsi, p_packet);
+            }
+            i_packets += p_ts->i_packets;
+            i_sections += p_ts->i_sections;
+        }
+        f_elapsed = bench_now() - f_start;
+    }
+    const uint64_t i_decoded = i_tables - i_tables_start;
+    const uint64_t i_allocated = i_allocs - i_allocs_start;
+
+    if (i_decoded != i_rounds)
+        fprintf(stderr, "Error: %s: %"PRIu64" tables decoded out of %"PRIu64"\n",
+                table->psz_name, i_decoded, i_rounds);
+
+    /* Percentiles of each stage with -l */
+    char psz_latency[DVBPSI_TRACE_STAGES * 64] = "";
+    for (int s = 0; b_latency && b_json && s < DVBPSI_TRACE_STAGES; s++)
+    {
+        size_t i_len = strlen(psz_latency);
+        snprintf(psz_latency + i_len, sizeof(psz_latency) - i_len,
+                 ",\"%s_p50_ns\":%"PRIu64",\"%s_p99_ns\":%"PRIu64,
+                 dvbpsi_trace_stage_name(s), dvbpsi_trace_histogram_percentile(&latency, s, 50),
+                 dvbpsi_trace_stage_name(s), dvbpsi_trace_histogram_percentile(&latency, s, 99));
+    }
+
+    if (b_json)
+        output_item("\"table\":\"%s\",\"entries\":%d,\"sections_per_table\":%u"
+                    ",\"packets_per_s\":%.0f,\"sections_per_s\":%.0f,\"ns_per_section\":%.1f"
+                    ",\"ns_per_table\":%.1f,\"allocs_per_section\":%.2f%s",
+                    table->psz_name, table->i_entries, ts[0].i_sections,
+                    i_packets / f_elapsed, i_sections / f_elapsed,
+                    f_elapsed * 1e9 / i_sections, f_elapsed * 1e9 / i_rounds,
+                    BENCH_ALLOCS ? (double)i_allocated / i_sections : -1.0, psz_latency);
+    else
+        output_item("%-4s %4d entries %3u sections %10.0f packets/s %10.0f sections/s"
+                    " %8.1f ns/section %9.1f ns/table %6.2f allocs/section",
+                    table->psz_name, table->i_entries, ts[0].i_sections,
+                    i_packets / f_elapsed, i_sections / f_elapsed,
+                    f_elapsed * 1e9 / i_sections, f_elapsed * 1e9 / i_rounds,
+                    BENCH_ALLOCS ? (double)i_allocated / i_sections : -1.0);
+    if (b_latency && !b_json)
+        dvbpsi_trace_histogram_dump(&latency, stdout);
+    b_ok = (i_decoded == i_rounds);
+
+out:
+    free(ts[0].p_packets);
+    free(ts[1].p_packets);
+    dvbpsi_chain_demux_delete(p_dvbpsi);
+    dvbpsi_delete(p_dvbpsi);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor throughput: independent streams, each with its own chain
+ * demux, pushed by i_workers threads
+ *****************************************************************************/
+#define BENCH_STREAMS 64
+
+#ifdef HAVE_PTHREAD_H
+typedef struct
+{
+    dvbpsi_t    *p_dvbpsi;
+    uint64_t     i_tables;
+    uint8_t      i_cc;
+} bench_stream_t;
+
+static void parallel_push(void *p_data, const uint8_t *p_packets, size_t i_packets)
+{
+    bench_stream_t *p_stream = (bench_stream_t *)p_data;
+    for (size_t i = 0; i < i_packets; i++)
+        dvbpsi_packet_push(p_stream->p_dvbpsi, &p_packets[i * 188]);
+}
+
+static bool bench_parallel(const bench_table_t *table, const unsigned int i_workers,
+                           const double f_min, double *pf_rate)
+{
+    bench_ts_t ts[2] = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+    bench_stream_t streams[BENCH_STREAMS];
+    dvbpsi_executor_batch_t batches[BENCH_STREAMS];
+    bool b_ok = false;
+
+    memset(streams, 0, sizeof(streams));
+    dvbpsi_executor_t *p_executor = dvbpsi_executor_new(i_workers, BENCH_STREAMS);
+    if (p_executor == NULL)
+        return false;
+    for (int i = 0; i < BENCH_STREAMS; i++)
+    {
+        streams[i].p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_ERROR);
+        if (streams[i].p_dvbpsi == NULL)
+            goto out;
+        if (!dvbpsi_chain_demux_new(streams[i].p_dvbpsi, NewSubtable, DelSubtable,
+                                    &streams[i].i_tables))
+        {
+            dvbpsi_delete(streams[i].p_dvbpsi);
+            streams[i].p_dvbpsi = NULL;
+            goto out;
+        }
+        if (dvbpsi_executor_stream_add(p_executor, parallel_push, &streams[i]) != i)
+            goto out;
+    }
+    if (!bench_versions(table, streams[0].p_dvbpsi, ts))
+        goto out;
+
+    /* Batches are copied when submitted, so one buffer serves every stream */
+    uint64_t i_rounds = 0, i_sections = 0;
+    const double f_start = bench_now();
+    double f_elapsed = 0.0;
+    while (f_elapsed < f_min)
+    {
+        for (int r = 0; r < 16; r++, i_rounds++)
+        {
+            bench_ts_t *p_ts = &ts[i_rounds & 1];
+            for (int i = 0; i < BENCH_STREAMS; i++)
+            {
+                for (size_t p = 0; p < p_ts->i_packets; p++)
+                    p_ts->p_packets[p * 188 + 3] = 0x10 | (streams[i].i_cc++ & 0x0f);
+                batches[i].i_stream = i;
+                batches[i].p_packets = p_ts->p_packets;
+                batches[i].i_packets = p_ts->i_packets;
+                if (!dvbpsi_executor_submit(p_executor, &batches[i], 1))
+                    goto out;
+            }
+            i_sections += (uint64_t)p_ts->i_sections * BENCH_STREAMS;
+        }
+        dvbpsi_executor_wait(p_executor);
+        f_elapsed = bench_now() - f_start;
+    }
+
+    b_ok = true;
+    for (int i = 0; i < BENCH_STREAMS; i++)
+        b_ok &= (streams[i].i_tables == i_rounds);
+    if (!b_ok)
+        fprintf(stderr, "Error: %s: tables lost with %u workers\n", table->psz_name, i_workers);
+    *pf_rate = i_sections / f_elapsed;
+
+out:
+    dvbpsi_executor_delete(p_executor);
+    for (int i = 0; i < BENCH_STREAMS; i++)
+    {
+        if (streams[i].p_dvbpsi == NULL)
+            break;
+        dvbpsi_chain_demux_delete(streams[i].p_dvbpsi);
+        dvbpsi_delete(streams[i].p_dvbpsi);
+    }
+    free(ts[0].p_packets);
+    free(ts[1].p_packets);
+    return b_ok;
+}
+
+/* One worker, then i_workers, to give the speedup */
+static bool bench_scaling(const bench_table_t *table, const unsigned int i_workers,
+                          const double f_min)
+{
+    double f_single = 0.0, f_rate = 0.0;
+    if (!bench_parallel(table, 1, f_min, &f_single) ||
+        !bench_parallel(table, i_workers, f_min, &f_rate))
+        return false;
+
+    if (b_json)
+        output_item("\"table\":\"%s\",\"streams\":%d,\"workers\":%u"
+                    ",\"sections_per_s\":%.0f,\"speedup\":%.2f",
+                    table->psz_name, BENCH_STREAMS, i_workers, f_rate, f_rate / f_single);
+    else
+        output_item("%-4s %3d streams %3u workers %10.0f sections/s %6.2fx",
+                    table->psz_name, BENCH_STREAMS, i_workers, f_rate, f_rate / f_single);
+    return true;
+}
+#endif
+
+/*****************************************************************************
+ * *_sections_generate time
+ *****************************************************************************/
+static bool bench_generate(const bench_table_t *table, const double f_min)
+{
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_ERROR);
+    if (p_dvbpsi == NULL)
+        return false;
+    void *p_table = table->pf_new(table->i_entries, 0);
+    if (p_table == NULL)
+    {
+        dvbpsi_delete(p_dvbpsi);
+        return false;
+    }
+
+    uint64_t i_rounds = 0, i_sections = 0;
+    const uint64_t i_allocs_start = i_allocs;
+    const double f_start = bench_now();
+    double f_elapsed = 0.0;
+    while (f_elapsed < f_min)
+    {
+        for (int r = 0; r < 64; r++, i_rounds++)
+        {
+            dvbpsi_psi_section_t *p_sections = table->pf_generate(p_dvbpsi, p_table);
+            for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+                i_sections++;
+            dvbpsi_DeletePSISections(p_sections);
+        }
+        f_elapsed = bench_now() - f_start;
+    }
+    const uint64_t i_allocated = i_allocs - i_allocs_start;
+
+    if (b_json)
+        output_item("\"table\":\"%s\",\"entries\":%d,\"ns_per_table\":%.1f"
+                    ",\"ns_per_section\":%.1f,\"allocs_per_table\":%.2f",
+                    table->psz_name, table->i_entries, f_elapsed * 1e9 / i_rounds,
+                    f_elapsed * 1e9 / i_sections,
+                    BENCH_ALLOCS ? (double)i_allocated / i_rounds : -1.0);
+    else
+        output_item("%-4s %4d entries %9.1f ns/table %8.1f ns/section %6.2f allocs/table",
+                    table->psz_name, table->i_entries, f_elapsed * 1e9 / i_rounds,
+                    f_elapsed * 1e9 / i_sections,
+                    BENCH_ALLOCS ? (double)i_allocated / i_rounds : -1.0);
+
+    table->pf_delete(p_table);
+    dvbpsi_delete(p_dvbpsi);
+    return true;
+}
+
+/*****************************************************************************
+ * CRC_32 throughput per section size
+ *****************************************************************************/
+static bool bench_crc(const int i_size, const double f_min)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(i_size);
+    if (p_section == NULL)
+        return false;
+
+    /* i_size bytes including the CRC_32 */
+    for (int i = 0; i < i_size - 4; i++)
+        p_section->p_data[i] = (uint8_t)(i * 31 + 7);
+    p_section->p_payload_end = p_section->p_data + i_size - 4;
+
+    uint64_t i_rounds = 0;
+    const double f_start = bench_now();
+    double f_elapsed = 0.0;
+    while (f_elapsed < f_min)
+    {
+        for (int r = 0; r < 1024; r++, i_rounds++)
+            dvbpsi_CalculateCRC32(p_section);
+        f_elapsed = bench_now() - f_start;
+    }
+    bool b_valid = dvbpsi_ValidPSISection(p_section);
+
+    if (b_json)
+        output_item("\"bytes\":%d,\"mbytes_per_s\":%.1f,\"ns_per_section\":%.1f",
+                    i_size, (double)i_rounds * i_size / f_elapsed / 1e6,
+                    f_elapsed * 1e9 / i_rounds);
+    else
+        output_item("%4d bytes %8.1f MB/s %9.1f ns/section",
+                    i_size, (double)i_rounds * i_size / f_elapsed / 1e6,
+                    f_elapsed * 1e9 / i_rounds);
+
+    dvbpsi_DeletePSISections(p_section);
+    return b_valid;
+}
+
+/*****************************************************************************
+ * Usage
+ *****************************************************************************/
+static void usage(const char *psz_name)
+{
+    fprintf(stderr, "Usage: %s [-j] [-l] [-p workers] [-t ms]\n", psz_name);
+    fprintf(stderr, "  -j     print the results as JSON\n");
+    fprintf(stderr, "  -l     latency of each push stage, needs a library built with\n"
+                    "         --enable-trace, the hooks slow the push figures down\n");
+    fprintf(stderr, "  -p n   also push %d streams through a dvbpsi_executor of n\n"
+                    "         workers, 0 for one per core, and compare with 1 worker\n",
+                    BENCH_STREAMS);
+    fprintf(stderr, "  -t ms  minimum run time of each benchmark (default 200)\n");
+}
+
+int main(int i_argc, char *pa_argv[])
+{
+    static const int ai_crc_sizes[] = { 16, 64, 256, 1024, 4096 };
+    double f_min = 0.2;
+    int i_workers = -1;
+    int c;
+
+    while ((c = getopt(i_argc, pa_argv, "jlp:t:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'j': b_json = true; break;
+            case 'l': b_latency = true; break;
+            case 'p': i_workers = atoi(optarg); break;
+            case 't': f_min = atoi(optarg) / 1000.0; break;
+            default:
+                usage(pa_argv[0]);
+                return (c == 'h') ? 0 : 1;
+        }
+    }
+
+    bool b_ok = true;
+    if (b_json)
+        fprintf(stdout, "{\"version\":\"%s\",\"allocs_counted\":%s,\n",
+                VERSION, BENCH_ALLOCS ? "true" : "false");
+
+    output_section("push");
+    for (size_t i = 0; i < ARRAY_SIZE(tables); i++)
+        b_ok &= bench_push(&tables[i], f_min);
+
+    if (i_workers == 0)
+        i_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (i_workers > 0)
+    {
+#ifdef HAVE_PTHREAD_H
+        output_section("parallel");
+        for (size_t i = 0; i < ARRAY_SIZE(tables); i++)
+            b_ok &= bench_scaling(&tables[i], i_workers, f_min);
+#else
+        fprintf(stderr, "Error: libdvbpsi was built without threads, no -p\n");
+        b_ok = false;
+#endif
+    }
+
+    output_section("generate");
+    for (size_t i = 0; i < ARRAY_SIZE(tables); i++)
+        b_ok &= bench_generate(&tables[i], f_min);
+
+    output_section("crc32");
+    for (size_t i = 0; i < ARRAY_SIZE(ai_crc_sizes); i++)
+        b_ok &= bench_crc(ai_crc_sizes[i], f_min);
+
+    if (b_json)
+        fprintf(stdout, "]}\n");
+    return b_ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+<?xml version="1.0" encoding="iso-8859-1" ?>
+<xsl:stylesheet xmlns:xsl="http://www.w3.org/1999/XSL/Transform" version="1.0">
+
+<xsl:output method="text" omit-xml-declaration="yes" indent="no" encoding="iso-8859-1" />
+
+<!--             -->
+<!-- entry point -->
+<!--             -->
+
+<xsl:template match="/dr">/* This file is generated by applying the dr_codec.xsl stylesheet to the
+ * dr.xml description file. DO NOT EDIT !!! */
+
+/* Field codecs for the descriptors marked layout="fixed" in dr.xml. The
+ * whole payload is read with one big endian load and every field is then
+ * extracted with a shift and a mask known at compile time. Reserved bits
+ * are written as 1s. The caller checks the descriptor length. */
+
+#ifndef DVBPSI_DR_CODEC_H
+#define DVBPSI_DR_CODEC_H
+
+#include "dr.h"
+
+static inline uint64_t dvbpsi_dr_load_be(const uint8_t *p_data, unsigned i_len)
+{
+    uint64_t i_bits = 0;
+    for (unsigned i = 0; i &lt; i_len; i++)
+        i_bits = (i_bits &lt;&lt; 8) | p_data[i];
+    return i_bits;
+}
+
+static inline void dvbpsi_dr_store_be(uint8_t *p_data, unsigned i_len, uint64_t i_bits)
+{
+    while (i_len--)
+    {
+        p_data[i_len] = (uint8_t)i_bits;
+        i_bits &gt;&gt;= 8;
+    }
+}
+
+#define DVBPSI_DR_MASK(n) ((UINT64_C(1) &lt;&lt; (n)) - 1)
+<xsl:apply-templates select="descriptor[@layout = 'fixed']" />
+#undef DVBPSI_DR_MASK
+
+#endif
+</xsl:template>
+
+<!--                      -->
+<!-- fixed layout codecs  -->
+<!--                      -->
+
+<xsl:template match="descriptor">
+  <xsl:variable name="total" select="count(boolean) + sum(integer/@bitcount) + sum(reserved/@bitcount)" />
+  <xsl:variable name="uname" select="translate(@sname, 'abcdefghijklmnopqrstuvwxyz', 'ABCDEFGHIJKLMNOPQRSTUVWXYZ')" />
+/* <xsl:value-of select="@name" /> (<xsl:value-of select="@tag" />) */
+<xsl:if test="$total mod 8 != 0 or $total &gt; 64">#error "<xsl:value-of select="@sname" />: fixed layout must be whole bytes and at most 64 bits"
+</xsl:if>#define DVBPSI_<xsl:value-of select="$uname" />_DR_LEN <xsl:value-of select="$total div 8" />
+
+static inline void dvbpsi_<xsl:value-of select="@sname" />_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_<xsl:value-of select="@sname" />_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_<xsl:value-of select="$uname" />_DR_LEN);
+<xsl:apply-templates select="integer | boolean" mode="unpack"><xsl:with-param name="total" select="$total" /></xsl:apply-templates>}
+
+static inline void dvbpsi_<xsl:value-of select="@sname" />_dr_pack(const dvbpsi_<xsl:value-of select="@sname" />_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+<xsl:apply-templates select="integer | boolean | reserved" mode="pack"><xsl:with-param name="total" select="$total" /></xsl:apply-templates>    dvbpsi_dr_store_be(p_data, DVBPSI_<xsl:value-of select="$uname" />_DR_LEN, i_bits);
+}
+</xsl:template>
+
+<!-- number of bits between the end of a field and the end of the payload -->
+<xsl:template name="shift">
+  <xsl:param name="total" />
+  <xsl:param name="width" />
+  <xsl:value-of select="$total - $width - count(preceding-sibling::boolean) - sum(preceding-sibling::integer/@bitcount) - sum(preceding-sibling::reserved/@bitcount)" />
+</xsl:template>
+
+<xsl:template match="integer" mode="unpack">
+  <xsl:param name="total" />
+  <xsl:text>    p_decoded-></xsl:text><xsl:value-of select="@name" /> = (i_bits &gt;&gt; <xsl:call-template name="shift"><xsl:with-param name="total" select="$total" /><xsl:with-param name="width" select="@bitcount" /></xsl:call-template>) &amp; DVBPSI_DR_MASK(<xsl:value-of select="@bitcount" />);
+</xsl:template>
+
+<xsl:template match="boolean" mode="unpack">
+  <xsl:param name="total" />
+  <xsl:text>    p_decoded-></xsl:text><xsl:value-of select="@name" /> = (i_bits &gt;&gt; <xsl:call-template name="shift"><xsl:with-param name="total" select="$total" /><xsl:with-param name="width" select="1" /></xsl:call-template>) &amp; 1;
+</xsl:template>
+
+<xsl:template match="integer" mode="pack">
+  <xsl:param name="total" />
+  <xsl:text>    i_bits |= ((uint64_t)p_decoded-></xsl:text><xsl:value-of select="@name" /> &amp; DVBPSI_DR_MASK(<xsl:value-of select="@bitcount" />)) &lt;&lt; <xsl:call-template name="shift"><xsl:with-param name="total" select="$total" /><xsl:with-param name="width" select="@bitcount" /></xsl:call-template>;
+</xsl:template>
+
+<xsl:template match="boolean" mode="pack">
+  <xsl:param name="total" />
+  <xsl:text>    i_bits |= (uint64_t)(p_decoded-></xsl:text><xsl:value-of select="@name" /> ? 1 : 0) &lt;&lt; <xsl:call-template name="shift"><xsl:with-param name="total" select="$total" /><xsl:with-param name="width" select="1" /></xsl:call-template>;
+</xsl:template>
+
+<xsl:template match="reserved" mode="pack">
+  <xsl:param name="total" />
+  <xsl:text>    i_bits |= DVBPSI_DR_MASK(</xsl:text><xsl:value-of select="@bitcount" />) &lt;&lt; <xsl:call-template name="shift"><xsl:with-param name="total" select="$total" /><xsl:with-param name="width" select="@bitcount" /></xsl:call-template>;
+</xsl:template>
+
+</xsl:stylesheet>
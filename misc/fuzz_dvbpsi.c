@@ -0,0 +1,939 @@
+/*****************************************************************************
+ * fuzz_dvbpsi.c: fuzzing entry points for packets, sections and descriptors
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id: $
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ * LLVMFuzzerTestOneInput() takes the first input byte as the target:
+ *   0  TS packets pushed into a chain demux that attaches every table decoder
+ *   1  sections handed to one *_sections_decode(), selected by the 2nd byte
+ *   2  a descriptor payload handed to one dvbpsi_decode_*_dr(), selected by
+ *      the 2nd byte
+ * Sections in target 1 skip the CRC_32 check but are otherwise built and
+ * checked as dvbpsi_packet_push() and the table gathers do.
+ *
+ * Every input is also timed against a CPU budget per input byte, so inputs
+ * hitting a quadratic path abort() like a crash would. The budget is set
+ * with DVBPSI_FUZZ_NS_PER_BYTE (nanoseconds, 0 disables it).
+ *
+ * libFuzzer:  clang -DDVBPSI_FUZZ_LIBFUZZER -fsanitize=fuzzer,address ...
+ * AFL:        afl-fuzz -i seeds -o findings -- ./fuzz_dvbpsi
+ * Otherwise the program runs the files given on the command line, or
+ * stdin, and -w dir writes a seed corpus built with the generators.
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* The libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/chain.h"
+#include "../src/descriptor.h"
+#include "../src/tables/pat.h"
+#include "../src/tables/cat.h"
+#include "../src/tables/pmt.h"
+#include "../src/tables/nit.h"
+#include "../src/tables/sdt.h"
+#include "../src/tables/bat.h"
+#include "../src/tables/eit.h"
+#include "../src/tables/tot.h"
+#include "../src/tables/rst.h"
+#include "../src/tables/sis.h"
+#include "../src/tables/atsc_mgt.h"
+#include "../src/tables/atsc_vct.h"
+#include "../src/tables/atsc_eit.h"
+#include "../src/tables/atsc_ett.h"
+#include "../src/tables/atsc_stt.h"
+#include "../src/tables/pat_private.h"
+#include "../src/tables/cat_private.h"
+#include "../src/tables/pmt_private.h"
+#include "../src/tables/nit_private.h"
+#include "../src/tables/sdt_private.h"
+#include "../src/tables/bat_private.h"
+#include "../src/tables/eit_private.h"
+#include "../src/tables/tot_private.h"
+#include "../src/tables/rst_private.h"
+#include "../src/tables/sis_private.h"
+#include "../src/descriptors/dr.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/chain.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/pat.h>
+#include <dvbpsi/cat.h>
+#include <dvbpsi/pmt.h>
+#include <dvbpsi/nit.h>
+#include <dvbpsi/sdt.h>
+#include <dvbpsi/bat.h>
+#include <dvbpsi/eit.h>
+#include <dvbpsi/tot.h>
+#include <dvbpsi/rst.h>
+#include <dvbpsi/sis.h>
+#include <dvbpsi/atsc_mgt.h>
+#include <dvbpsi/atsc_vct.h>
+#include <dvbpsi/atsc_eit.h>
+#include <dvbpsi/atsc_ett.h>
+#include <dvbpsi/atsc_stt.h>
+#include "../src/tables/pat_private.h"
+#include "../src/tables/cat_private.h"
+#include "../src/tables/pmt_private.h"
+#include "../src/tables/nit_private.h"
+#include "../src/tables/sdt_private.h"
+#include "../src/tables/bat_private.h"
+#include "../src/tables/eit_private.h"
+#include "../src/tables/tot_private.h"
+#include "../src/tables/rst_private.h"
+#include "../src/tables/sis_private.h"
+#include <dvbpsi/dr.h>
+#endif
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+int LLVMFuzzerTestOneInput(const uint8_t *p_data, size_t i_size);
+
+/*****************************************************************************
+ * Target 0: TS packets through a chain demux
+ *****************************************************************************/
+#define FUZZ_TABLE_CB(name) \
+static void table_##name(void *p_priv, dvbpsi_##name##_t *p_table) \
+{ \
+    (void)p_priv; \
+    dvbpsi_##name##_delete(p_table); \
+}
+
+FUZZ_TABLE_CB(pat)
+FUZZ_TABLE_CB(cat)
+FUZZ_TABLE_CB(pmt)
+FUZZ_TABLE_CB(nit)
+FUZZ_TABLE_CB(sdt)
+FUZZ_TABLE_CB(bat)
+FUZZ_TABLE_CB(eit)
+FUZZ_TABLE_CB(tot)
+FUZZ_TABLE_CB(rst)
+FUZZ_TABLE_CB(sis)
+FUZZ_TABLE_CB(atsc_mgt)
+FUZZ_TABLE_CB(atsc_vct)
+FUZZ_TABLE_CB(atsc_eit)
+FUZZ_TABLE_CB(atsc_ett)
+FUZZ_TABLE_CB(atsc_stt)
+
+static void NewSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
+                        void *p_priv)
+{
+    (void)p_priv;
+    if (i_table_id == 0x00)
+        dvbpsi_pat_attach(p_dvbpsi, i_table_id, i_extension, table_pat, NULL);
+    else if (i_table_id == 0x01)
+        dvbpsi_cat_attach(p_dvbpsi, i_table_id, i_extension, table_cat, NULL);
+    else if (i_table_id == 0x02)
+        dvbpsi_pmt_attach(p_dvbpsi, i_table_id, i_extension, table_pmt, NULL);
+    else if ((i_table_id == 0x40) || (i_table_id == 0x41))
+        dvbpsi_nit_attach(p_dvbpsi, i_table_id, i_extension, table_nit, NULL);
+    else if ((i_table_id == 0x42) || (i_table_id == 0x46))
+        dvbpsi_sdt_attach(p_dvbpsi, i_table_id, i_extension, table_sdt, NULL);
+    else if (i_table_id == 0x4a)
+        dvbpsi_bat_attach(p_dvbpsi, i_table_id, i_extension, table_bat, NULL);
+    else if ((i_table_id >= 0x4e) && (i_table_id <= 0x6f))
+        dvbpsi_eit_attach(p_dvbpsi, i_table_id, i_extension, table_eit, NULL);
+    else if ((i_table_id == 0x70) || (i_table_id == 0x73))
+        dvbpsi_tot_attach(p_dvbpsi, i_table_id, i_extension, table_tot, NULL);
+    else if (i_table_id == 0x71)
+        dvbpsi_rst_attach(p_dvbpsi, i_table_id, i_extension, table_rst, NULL);
+    else if (i_table_id == 0xc7)
+        dvbpsi_atsc_mgt_attach(p_dvbpsi, i_table_id, i_extension, table_atsc_mgt, NULL);
+    else if ((i_table_id == 0xc8) || (i_table_id == 0xc9))
+        dvbpsi_atsc_vct_attach(p_dvbpsi, i_table_id, i_extension, table_atsc_vct, NULL);
+    else if (i_table_id == 0xcb)
+        dvbpsi_atsc_eit_attach(p_dvbpsi, i_table_id, i_extension, table_atsc_eit, NULL);
+    else if (i_table_id == 0xcc)
+        dvbpsi_atsc_ett_attach(p_dvbpsi, i_table_id, i_extension, table_atsc_ett, NULL);
+    else if (i_table_id == 0xcd)
+        dvbpsi_atsc_stt_attach(p_dvbpsi, i_table_id, i_extension, table_atsc_stt, NULL);
+    else if (i_table_id == 0xfc)
+        dvbpsi_sis_attach(p_dvbpsi, i_table_id, i_extension, table_sis, NULL);
+}
+
+static void DelSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    if (i_table_id == 0x00)
+        dvbpsi_pat_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x01)
+        dvbpsi_cat_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x02)
+        dvbpsi_pmt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id == 0x40) || (i_table_id == 0x41))
+        dvbpsi_nit_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id == 0x42) || (i_table_id == 0x46))
+        dvbpsi_sdt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x4a)
+        dvbpsi_bat_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id >= 0x4e) && (i_table_id <= 0x6f))
+        dvbpsi_eit_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id == 0x70) || (i_table_id == 0x73))
+        dvbpsi_tot_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0x71)
+        dvbpsi_rst_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0xc7)
+        dvbpsi_atsc_mgt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if ((i_table_id == 0xc8) || (i_table_id == 0xc9))
+        dvbpsi_atsc_vct_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0xcb)
+        dvbpsi_atsc_eit_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0xcc)
+        dvbpsi_atsc_ett_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0xcd)
+        dvbpsi_atsc_stt_detach(p_dvbpsi, i_table_id, i_extension);
+    else if (i_table_id == 0xfc)
+        dvbpsi_sis_detach(p_dvbpsi, i_table_id, i_extension);
+}
+
+static void fuzz_packets(const uint8_t *p_data, size_t i_size)
+{
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(NULL, DVBPSI_MSG_NONE);
+    if (p_dvbpsi == NULL)
+        return;
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, DelSubtable, NULL))
+    {
+        dvbpsi_delete(p_dvbpsi);
+        return;
+    }
+
+    /* The sync byte is forced, a short last packet is stuffed */
+    uint8_t packet[188];
+    while (i_size > 0)
+    {
+        size_t i_len = (i_size < 188) ? i_size : 188;
+        memcpy(packet, p_data, i_len);
+        memset(packet + i_len, 0xff, 188 - i_len);
+        packet[0] = 0x47;
+        dvbpsi_packet_push(p_dvbpsi, packet);
+        p_data += i_len;
+        i_size -= i_len;
+    }
+
+    dvbpsi_chain_demux_delete(p_dvbpsi);
+    dvbpsi_delete(p_dvbpsi);
+}
+
+/*****************************************************************************
+ * Target 1: *_sections_decode
+ *****************************************************************************/
+static void sections_pat(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_pat_t *p_pat = dvbpsi_pat_new(p_section->i_extension, p_section->i_version,
+                                         p_section->b_current_next);
+    if (p_pat == NULL)
+        return;
+    dvbpsi_pat_sections_decode(p_pat, p_section);
+    dvbpsi_pat_delete(p_pat);
+}
+
+static void sections_cat(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_cat_t *p_cat = dvbpsi_cat_new(p_section->i_version, p_section->b_current_next);
+    if (p_cat == NULL)
+        return;
+    dvbpsi_cat_sections_decode(p_cat, p_section);
+    dvbpsi_cat_delete(p_cat);
+}
+
+static void sections_pmt(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(p_section->i_extension, p_section->i_version,
+                                         p_section->b_current_next, 0x1fff);
+    if (p_pmt == NULL)
+        return;
+    dvbpsi_pmt_sections_decode(p_pmt, p_section);
+    dvbpsi_pmt_delete(p_pmt);
+}
+
+static void sections_nit(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_nit_t *p_nit = dvbpsi_nit_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_extension, p_section->i_version,
+                                         p_section->b_current_next);
+    if (p_nit == NULL)
+        return;
+    dvbpsi_nit_sections_decode(p_nit, p_section);
+    dvbpsi_nit_delete(p_nit);
+}
+
+static void sections_sdt(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_sdt_t *p_sdt = dvbpsi_sdt_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_version, p_section->b_current_next, 0);
+    if (p_sdt == NULL)
+        return;
+    dvbpsi_sdt_sections_decode(p_sdt, p_section);
+    dvbpsi_sdt_delete(p_sdt);
+}
+
+static void sections_bat(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_bat_t *p_bat = dvbpsi_bat_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_version, p_section->b_current_next);
+    if (p_bat == NULL)
+        return;
+    dvbpsi_bat_sections_decode(p_bat, p_section);
+    dvbpsi_bat_delete(p_bat);
+}
+
+static void sections_eit(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    dvbpsi_eit_t *p_eit = dvbpsi_eit_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_version, p_section->b_current_next,
+                                         0, 0, p_section->i_last_number,
+                                         p_section->i_table_id);
+    if (p_eit == NULL)
+        return;
+    dvbpsi_eit_sections_decode(p_dvbpsi, p_eit, p_section);
+    dvbpsi_eit_delete(p_eit);
+}
+
+static void sections_tot(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    /* as dvbpsi_tot_section_valid() */
+    if ((p_section->i_table_id == 0x70) && (p_section->i_length != 5))
+        return;
+    dvbpsi_tot_t *p_tot = dvbpsi_tot_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_version, p_section->b_current_next, 0);
+    if (p_tot == NULL)
+        return;
+    dvbpsi_tot_sections_decode(p_dvbpsi, p_tot, p_section);
+    dvbpsi_tot_delete(p_tot);
+}
+
+static void sections_rst(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    (void)p_dvbpsi;
+    dvbpsi_rst_t *p_rst = dvbpsi_rst_new();
+    if (p_rst == NULL)
+        return;
+    dvbpsi_rst_sections_decode(p_rst, p_section);
+    dvbpsi_rst_delete(p_rst);
+}
+
+static void sections_sis(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+    dvbpsi_sis_t *p_sis = dvbpsi_sis_new(p_section->i_table_id, p_section->i_extension,
+                                         p_section->i_version, p_section->b_current_next, 0);
+    if (p_sis == NULL)
+        return;
+    dvbpsi_sis_sections_decode(p_dvbpsi, p_sis, p_section);
+    dvbpsi_sis_delete(p_sis);
+}
+
+typedef struct
+{
+    const char *psz_name;
+    uint8_t     i_first_id;     /* accepted table_id range */
+    uint8_t     i_last_id;
+    bool        b_syntax;       /* section_syntax_indicator the gather wants */
+    int         i_max_size;     /* as passed to dvbpsi_decoder_new() */
+    void     (* pf_decode)(dvbpsi_t *, dvbpsi_psi_section_t *);
+} fuzz_table_t;
+
+static const fuzz_table_t tables[] =
+{
+    { "PAT", 0x00, 0x00, true,  1024, sections_pat },
+    { "CAT", 0x01, 0x01, true,  1024, sections_cat },
+    { "PMT", 0x02, 0x02, true,  1024, sections_pmt },
+    { "NIT", 0x40, 0x41, true,  4096, sections_nit },
+    { "SDT", 0x42, 0x42, true,  4096, sections_sdt },
+    { "SDT", 0x46, 0x46, true,  4096, sections_sdt },
+    { "BAT", 0x4a, 0x4a, true,  4096, sections_bat },
+    { "EIT", 0x4e, 0x6f, true,  4096, sections_eit },
+    { "TDT", 0x70, 0x70, false, 4096, sections_tot },
+    { "TOT", 0x73, 0x73, false, 4096, sections_tot },
+    { "RST", 0x71, 0x71, false, 4096, sections_rst },
+    { "SIS", 0xfc, 0xfc, true,  4096, sections_sis },
+};
+
+/* Cut the input into sections the way dvbpsi_packet_push() completes them */
+static dvbpsi_psi_section_t *fuzz_sections_build(const fuzz_table_t *table,
+                                                 const uint8_t *p_data, size_t i_size)
+{
+    dvbpsi_psi_section_t *p_first = NULL, **pp_last = &p_first;
+    while (i_size >= 3)
+    {
+        size_t i_length = ((size_t)(p_data[1] & 0x0f) << 8) | p_data[2];
+        if ((i_length > (size_t)table->i_max_size - 3) || (i_length + 3 > i_size))
+            break;
+
+        dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(table->i_max_size);
+        if (p_section == NULL)
+            break;
+        memcpy(p_section->p_data, p_data, i_length + 3);
+        p_section->i_length = i_length;
+        p_section->p_payload_end = p_section->p_data + i_length + 3;
+        p_section->i_table_id = p_data[0];
+        p_section->b_syntax_indicator = p_data[1] & 0x80;
+        p_section->b_private_indicator = p_data[1] & 0x40;
+        if (p_section->b_syntax_indicator || dvbpsi_has_CRC32(p_section))
+            p_section->p_payload_end -= 4;
+        if (p_section->b_syntax_indicator)
+        {
+            p_section->i_extension = ((uint16_t)p_data[3] << 8) | p_data[4];
+            p_section->i_version = (p_data[5] & 0x3e) >> 1;
+            p_section->b_current_next = p_data[5] & 0x1;
+            p_section->i_number = p_data[6];
+            p_section->i_last_number = p_data[7];
+            p_section->p_payload_start = p_section->p_data + 8;
+        }
+        else
+        {
+            p_section->b_current_next = true;
+            p_section->p_payload_start = p_section->p_data + 3;
+        }
+        p_data += i_length + 3;
+        i_size -= i_length + 3;
+
+        /* as dvbpsi_CheckPSISection() in the gather */
+        if ((p_section->i_table_id < table->i_first_id) ||
+            (p_section->i_table_id > table->i_last_id) ||
+            (p_section->b_syntax_indicator != table->b_syntax))
+        {
+            dvbpsi_DeletePSISections(p_section);
+            continue;
+        }
+        *pp_last = p_section;
+        pp_last = &p_section->p_next;
+    }
+    return p_first;
+}
+
+static void fuzz_sections(const uint8_t *p_data, size_t i_size)
+{
+    if (i_size < 1)
+        return;
+    const fuzz_table_t *table = &tables[p_data[0] % ARRAY_SIZE(tables)];
+    dvbpsi_psi_section_t *p_sections = fuzz_sections_build(table, p_data + 1, i_size - 1);
+    if (p_sections == NULL)
+        return;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(NULL, DVBPSI_MSG_NONE);
+    if (p_dvbpsi != NULL)
+    {
+        table->pf_decode(p_dvbpsi, p_sections);
+        dvbpsi_delete(p_dvbpsi);
+    }
+    dvbpsi_DeletePSISections(p_sections);
+}
+
+/*****************************************************************************
+ * Target 2: dvbpsi_decode_*_dr
+ *****************************************************************************/
+#define FUZZ_DESCRIPTORS(X) \
+    X(0x02, mpeg_vstream) \
+    X(0x03, mpeg_astream) \
+    X(0x04, mpeg_hierarchy) \
+    X(0x05, mpeg_registration) \
+    X(0x06, mpeg_ds_alignment) \
+    X(0x07, mpeg_target_bg_grid) \
+    X(0x08, mpeg_vwindow) \
+    X(0x09, mpeg_ca) \
+    X(0x0a, mpeg_iso639) \
+    X(0x0b, mpeg_system_clock) \
+    X(0x0c, mpeg_mx_buff_utilization) \
+    X(0x0d, mpeg_copyright) \
+    X(0x0e, mpeg_max_bitrate) \
+    X(0x0f, mpeg_private_data) \
+    X(0x10, mpeg_smoothing_buffer) \
+    X(0x11, mpeg_std) \
+    X(0x12, mpeg_ibp) \
+    X(0x13, mpeg_carousel_id) \
+    X(0x14, mpeg_association_tag) \
+    X(0x1b, mpeg_mpeg4_video) \
+    X(0x1c, mpeg_mpeg4_audio) \
+    X(0x1d, mpeg_iod) \
+    X(0x1e, mpeg_sl) \
+    X(0x1f, mpeg_fmc) \
+    X(0x20, mpeg_ext_es_id) \
+    X(0x23, mpeg_mux_buf) \
+    X(0x24, mpeg_content_labelling) \
+    X(0x40, dvb_network_name) \
+    X(0x41, dvb_service_list) \
+    X(0x42, dvb_stuffing) \
+    X(0x43, dvb_sat_deliv_sys) \
+    X(0x44, dvb_cable_deliv_sys) \
+    X(0x45, dvb_vbi) \
+    X(0x47, dvb_bouquet_name) \
+    X(0x48, dvb_service) \
+    X(0x49, dvb_country_availability) \
+    X(0x4a, dvb_linkage) \
+    X(0x4b, dvb_nvod_ref) \
+    X(0x4c, dvb_tshifted_service) \
+    X(0x4d, dvb_short_event) \
+    X(0x4e, dvb_extended_event) \
+    X(0x4f, dvb_tshifted_ev) \
+    X(0x50, dvb_component) \
+    X(0x52, dvb_stream_identifier) \
+    X(0x53, dvb_ca_identifier) \
+    X(0x54, dvb_content) \
+    X(0x55, dvb_parental_rating) \
+    X(0x56, dvb_teletext) \
+    X(0x58, dvb_local_time_offset) \
+    X(0x59, dvb_subtitling) \
+    X(0x5a, dvb_terr_deliv_sys) \
+    X(0x62, dvb_frequency_list) \
+    X(0x65, dvb_scrambling) \
+    X(0x66, dvb_data_broadcast_id) \
+    X(0x67, dvb_transport_stream) \
+    X(0x69, dvb_PDC) \
+    X(0x73, dvb_default_authority) \
+    X(0x76, dvb_content_id) \
+    X(0x7c, dvb_aac) \
+    X(0x81, atsc_ac3_audio) \
+    X(0x83, eacem_lcn) \
+    X(0x86, atsc_caption_service) \
+    X(0x8a, scte_cuei) \
+    X(0xa0, atsc_extended_channel_name) \
+    X(0xa1, atsc_service_location)
+
+/* Wrappers keep the calls type correct for -fsanitize=function */
+#define FUZZ_DR_DECODE(tag, name) \
+static bool decode_##name(dvbpsi_descriptor_t *p_descriptor) \
+{ \
+    return dvbpsi_decode_##name##_dr(p_descriptor) != NULL; \
+}
+FUZZ_DESCRIPTORS(FUZZ_DR_DECODE)
+
+typedef struct
+{
+    uint8_t     i_tag;
+    const char *psz_name;
+    bool     (* pf_decode)(dvbpsi_descriptor_t *);
+} fuzz_descriptor_t;
+
+#define FUZZ_DR_ENTRY(tag, name) { tag, #name, decode_##name },
+static const fuzz_descriptor_t descriptors[] =
+{
+    FUZZ_DESCRIPTORS(FUZZ_DR_ENTRY)
+};
+
+/* The decoded structures that own buffers of their own, which
+ * dvbpsi_DeleteDescriptors() leaves to the caller */
+static void descriptor_release(dvbpsi_descriptor_t *p_descriptor)
+{
+    switch (p_descriptor->i_tag)
+    {
+        case 0x24:
+        {
+            dvbpsi_mpeg_content_labelling_dr_t *p_decoded = p_descriptor->p_decoded;
+            free(p_decoded->p_content_reference_id);
+            free(p_decoded->p_time_base_association_data);
+            free(p_decoded->p_private_data);
+            break;
+        }
+        case 0x50:
+        {
+            dvbpsi_dvb_component_dr_t *p_decoded = p_descriptor->p_decoded;
+            free(p_decoded->i_text);
+            break;
+        }
+    }
+}
+
+static void fuzz_descriptor(const uint8_t *p_data, size_t i_size)
+{
+    if (i_size < 1)
+        return;
+    const fuzz_descriptor_t *descriptor = &descriptors[p_data[0] % ARRAY_SIZE(descriptors)];
+    size_t i_length = (i_size - 1 > 255) ? 255 : i_size - 1;
+
+    /* The payload is copied so that over-reads land past a heap block */
+    dvbpsi_descriptor_t *p_descriptor =
+            dvbpsi_NewDescriptor(descriptor->i_tag, i_length, NULL);
+    if (p_descriptor == NULL)
+        return;
+    memcpy(p_descriptor->p_data, p_data + 1, i_length);
+    if (descriptor->pf_decode(p_descriptor))
+        descriptor_release(p_descriptor);
+    dvbpsi_DeleteDescriptors(p_descriptor);
+}
+
+/*****************************************************************************
+ * Slow input detector
+ *****************************************************************************/
+static int64_t i_ns_per_byte = -1;
+
+static int64_t cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void slow_check(int64_t i_spent, size_t i_size)
+{
+    if (i_ns_per_byte < 0)
+    {
+        const char *psz = getenv("DVBPSI_FUZZ_NS_PER_BYTE");
+        i_ns_per_byte = psz ? strtoll(psz, NULL, 0) : 20000;
+    }
+    /* A fixed allowance covers handle setup on tiny inputs */
+    if ((i_ns_per_byte > 0) &&
+        (i_spent > 2000000 + i_ns_per_byte * (int64_t)i_size))
+    {
+        fprintf(stderr, "fuzz_dvbpsi: slow input, %"PRId64" ns for %zu bytes "
+                        "(budget %"PRId64" ns per byte)\n",
+                i_spent, i_size, i_ns_per_byte);
+        abort();
+    }
+}
+
+/*****************************************************************************
+ * Entry point
+ *****************************************************************************/
+int LLVMFuzzerTestOneInput(const uint8_t *p_data, size_t i_size)
+{
+    if (i_size < 1)
+        return 0;
+
+    int64_t i_start = cpu_ns();
+    switch (p_data[0] % 3)
+    {
+        case 0: fuzz_packets(p_data + 1, i_size - 1); break;
+        case 1: fuzz_sections(p_data + 1, i_size - 1); break;
+        case 2: fuzz_descriptor(p_data + 1, i_size - 1); break;
+    }
+    slow_check(cpu_ns() - i_start, i_size);
+    return 0;
+}
+
+#ifndef DVBPSI_FUZZ_LIBFUZZER
+/*****************************************************************************
+ * Seed corpus, built from the table generators
+ *****************************************************************************/
+static uint8_t ai_language[] = { 'e', 'n', 'g', 0x00 };
+static uint8_t ai_ca[] = { 0x0b, 0x00, 0xe1, 0x00 };
+static uint8_t ai_service[] = { 0x01, 0x04, 'f', 'u', 'z', 'z', 0x04, 'z', 'z', 'u', 'f' };
+static uint8_t ai_service_list[] = { 0x00, 0x01, 0x01, 0x00, 0x02, 0x01 };
+static uint8_t ai_short_event[] = { 'e', 'n', 'g', 0x04, 'F', 'u', 'z', 'z',
+                                    0x04, 'S', 'e', 'e', 'd' };
+
+static dvbpsi_psi_section_t *seed_sections(dvbpsi_t *p_dvbpsi, uint8_t i_table_id)
+{
+    dvbpsi_psi_section_t *p_sections = NULL;
+    switch (i_table_id)
+    {
+        case 0x00: {
+            dvbpsi_pat_t *p_pat = dvbpsi_pat_new(1, 0, true);
+            if (p_pat == NULL)
+                break;
+            for (int i = 1; i <= 3; i++)
+                dvbpsi_pat_program_add(p_pat, i, 0x100 + i);
+            p_sections = dvbpsi_pat_sections_generate(p_dvbpsi, p_pat, 253);
+            dvbpsi_pat_delete(p_pat);
+            break;
+        }
+        case 0x01: {
+            dvbpsi_cat_t *p_cat = dvbpsi_cat_new(0, true);
+            if (p_cat == NULL)
+                break;
+            dvbpsi_cat_descriptor_add(p_cat, 0x09, sizeof(ai_ca), ai_ca);
+            p_sections = dvbpsi_cat_sections_generate(p_dvbpsi, p_cat);
+            dvbpsi_cat_delete(p_cat);
+            break;
+        }
+        case 0x02: {
+            dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(1, 0, true, 0x101);
+            if (p_pmt == NULL)
+                break;
+            dvbpsi_pmt_descriptor_add(p_pmt, 0x09, sizeof(ai_ca), ai_ca);
+            dvbpsi_pmt_es_add(p_pmt, 0x1b, 0x101);
+            dvbpsi_pmt_es_t *p_es = dvbpsi_pmt_es_add(p_pmt, 0x04, 0x102);
+            if (p_es)
+                dvbpsi_pmt_es_descriptor_add(p_es, 0x0a, sizeof(ai_language), ai_language);
+            p_sections = dvbpsi_pmt_sections_generate(p_dvbpsi, p_pmt);
+            dvbpsi_pmt_delete(p_pmt);
+            break;
+        }
+        case 0x40: {
+            dvbpsi_nit_t *p_nit = dvbpsi_nit_new(0x40, 1, 1, 0, true);
+            if (p_nit == NULL)
+                break;
+            dvbpsi_nit_ts_t *p_ts = dvbpsi_nit_ts_add(p_nit, 1, 1);
+            if (p_ts)
+                dvbpsi_nit_ts_descriptor_add(p_ts, 0x41, sizeof(ai_service_list),
+                                             ai_service_list);
+            p_sections = dvbpsi_nit_sections_generate(p_dvbpsi, p_nit, 0x40);
+            dvbpsi_nit_delete(p_nit);
+            break;
+        }
+        case 0x42: {
+            dvbpsi_sdt_t *p_sdt = dvbpsi_sdt_new(0x42, 1, 0, true, 1);
+            if (p_sdt == NULL)
+                break;
+            dvbpsi_sdt_service_t *p_service = dvbpsi_sdt_service_add(p_sdt, 1, true, true,
+                                                                     4, false);
+            if (p_service)
+                dvbpsi_sdt_service_descriptor_add(p_service, 0x48, sizeof(ai_service),
+                                                  ai_service);
+            p_sections = dvbpsi_sdt_sections_generate(p_dvbpsi, p_sdt);
+            dvbpsi_sdt_delete(p_sdt);
+            break;
+        }
+        case 0x4a: {
+            dvbpsi_bat_t *p_bat = dvbpsi_bat_new(0x4a, 1, 0, true);
+            if (p_bat == NULL)
+                break;
+            dvbpsi_bat_ts_t *p_ts = dvbpsi_bat_ts_add(p_bat, 1, 1);
+            if (p_ts)
+                dvbpsi_bat_ts_descriptor_add(p_ts, 0x41, sizeof(ai_service_list),
+                                             ai_service_list);
+            p_sections = dvbpsi_bat_sections_generate(p_dvbpsi, p_bat);
+            dvbpsi_bat_delete(p_bat);
+            break;
+        }
+        case 0x4e: {
+            dvbpsi_eit_t *p_eit = dvbpsi_eit_new(0x4e, 1, 0, true, 1, 1, 1, 0x4e);
+            if (p_eit == NULL)
+                break;
+            for (int i = 0; i < 2; i++)
+            {
+                /* 2015-01-01, MJD 57023 */
+                dvbpsi_eit_event_t *p_event = dvbpsi_eit_event_add(p_eit, i + 1,
+                                    ((uint64_t)57023 << 24) | ((uint64_t)i << 16),
+                                    0x010000, 4 - 2 * i, false, 0);
+                if (p_event)
+                    dvbpsi_eit_event_descriptor_add(p_event, 0x4d, sizeof(ai_short_event),
+                                                    ai_short_event);
+            }
+            p_sections = dvbpsi_eit_sections_generate(p_dvbpsi, p_eit, 0x4e);
+            dvbpsi_eit_delete(p_eit);
+            break;
+        }
+        case 0x70: {
+            dvbpsi_tot_t *p_tot = dvbpsi_tot_new(0x70, 0, 0, true,
+                                                 ((uint64_t)57023 << 24) | 0x120000);
+            if (p_tot == NULL)
+                break;
+            p_sections = dvbpsi_tot_sections_generate(p_dvbpsi, p_tot);
+            dvbpsi_tot_delete(p_tot);
+            break;
+        }
+        case 0x71: {
+            dvbpsi_rst_t *p_rst = dvbpsi_rst_new();
+            if (p_rst == NULL)
+                break;
+            dvbpsi_rst_event_add(p_rst, 1, 1, 1, 1, 4);
+            p_sections = dvbpsi_rst_sections_generate(p_dvbpsi, p_rst);
+            dvbpsi_rst_delete(p_rst);
+            break;
+        }
+    }
+    return p_sections;
+}
+
+static bool seed_write(const char *psz_dir, const char *psz_name, int i_index,
+                       const uint8_t *p_data, size_t i_size)
+{
+    char psz_path[1024];
+    snprintf(psz_path, sizeof(psz_path), "%s/%s-%d", psz_dir, psz_name, i_index);
+    FILE *f = fopen(psz_path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "fuzz_dvbpsi: cannot write %s\n", psz_path);
+        return false;
+    }
+    bool b_ok = fwrite(p_data, 1, i_size, f) == i_size;
+    return (fclose(f) == 0) && b_ok;
+}
+
+static bool seeds_write(const char *psz_dir)
+{
+    static uint8_t buffer[2 + 4096 * 4];
+    static uint8_t packets[1 + 188 * 64];
+    if ((mkdir(psz_dir, 0755) != 0) && (errno != EEXIST))
+    {
+        fprintf(stderr, "fuzz_dvbpsi: cannot create %s\n", psz_dir);
+        return false;
+    }
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(NULL, DVBPSI_MSG_NONE);
+    if (p_dvbpsi == NULL)
+        return false;
+
+    bool b_ok = true;
+    size_t i_packets = 0;
+    uint8_t i_cc = 0;
+    for (size_t t = 0; t < ARRAY_SIZE(tables); t++)
+    {
+        dvbpsi_psi_section_t *p_sections = seed_sections(p_dvbpsi, tables[t].i_first_id);
+        if (p_sections == NULL)
+            continue;
+
+        /* Target 1: the table index, then the sections back to back */
+        size_t i_size = 0;
+        buffer[i_size++] = 1;
+        buffer[i_size++] = t;
+        for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+        {
+            size_t i_len = p->p_payload_end - p->p_data + (p->b_syntax_indicator ? 4 : 0);
+            if (i_size + i_len > sizeof(buffer))
+                break;
+            memcpy(buffer + i_size, p->p_data, i_len);
+            i_size += i_len;
+        }
+        dvbpsi_DeletePSISections(p_sections);
+        b_ok &= seed_write(psz_dir, "sections", t, buffer, i_size);
+
+        /* Target 0: all the tables packetized one after the other on one pid */
+        const uint8_t *p_byte = buffer + 2, *p_end = buffer + i_size;
+        while ((p_byte < p_end) && (1 + (i_packets + 1) * 188 <= sizeof(packets)))
+        {
+            uint8_t *p_packet = packets + 1 + i_packets++ * 188;
+            uint8_t *p_pos = p_packet + 4;
+            bool b_start = (p_byte == buffer + 2);
+            p_packet[0] = 0x47;
+            p_packet[1] = b_start ? 0x40 : 0x00;
+            p_packet[2] = 0x00;
+            p_packet[3] = 0x10 | (i_cc++ & 0x0f);
+            if (b_start)
+                *p_pos++ = 0x00; /* pointer_field */
+            while ((p_pos < p_packet + 188) && (p_byte < p_end))
+                *p_pos++ = *p_byte++;
+            memset(p_pos, 0xff, p_packet + 188 - p_pos);
+        }
+    }
+    packets[0] = 0;
+    b_ok &= seed_write(psz_dir, "packets", 0, packets, 1 + i_packets * 188);
+
+    /* Target 2: a ramp payload of a few lengths for every decoder */
+    static const size_t ai_lengths[] = { 1, 4, 16, 64 };
+    for (size_t d = 0; d < ARRAY_SIZE(descriptors); d++)
+    {
+        for (size_t l = 0; l < ARRAY_SIZE(ai_lengths); l++)
+        {
+            buffer[0] = 2;
+            buffer[1] = d;
+            for (size_t i = 0; i < ai_lengths[l]; i++)
+                buffer[2 + i] = i;
+            b_ok &= seed_write(psz_dir, descriptors[d].psz_name, l, buffer,
+                               2 + ai_lengths[l]);
+        }
+    }
+
+    dvbpsi_delete(p_dvbpsi);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * Standalone driver
+ *****************************************************************************/
+static bool run_file(FILE *f, const char *psz_name)
+{
+    size_t i_alloc = 65536, i_size = 0;
+    uint8_t *p_data = (uint8_t *)malloc(i_alloc);
+    while (p_data)
+    {
+        i_size += fread(p_data + i_size, 1, i_alloc - i_size, f);
+        if (i_size < i_alloc)
+            break;
+        uint8_t *p_new = (uint8_t *)realloc(p_data, i_alloc * 2);
+        if (p_new == NULL)
+        {
+            free(p_data);
+            p_data = NULL;
+            break;
+        }
+        p_data = p_new;
+        i_alloc *= 2;
+    }
+    if (p_data == NULL)
+    {
+        fprintf(stderr, "fuzz_dvbpsi: out of memory reading %s\n", psz_name);
+        return false;
+    }
+    LLVMFuzzerTestOneInput(p_data, i_size);
+    free(p_data);
+    return true;
+}
+
+static void usage(const char *psz_name)
+{
+    fprintf(stderr, "Usage: %s [-w dir] [file ...]\n", psz_name);
+    fprintf(stderr, "  -w dir  write a seed corpus into dir and exit\n");
+    fprintf(stderr, "  file    inputs to run, stdin when none is given\n");
+}
+
+int main(int i_argc, char *pa_argv[])
+{
+    int c;
+    while ((c = getopt(i_argc, pa_argv, "w:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'w': return seeds_write(optarg) ? 0 : 1;
+            default:
+                usage(pa_argv[0]);
+                return (c == 'h') ? 0 : 1;
+        }
+    }
+
+    if (optind == i_argc)
+    {
+#ifdef __AFL_LOOP
+        while (__AFL_LOOP(1000))
+#endif
+            if (!run_file(stdin, "stdin"))
+                return 1;
+        return 0;
+    }
+
+    bool b_ok = true;
+    for (int i = optind; i < i_argc; i++)
+    {
+        FILE *f = fopen(pa_argv[i], "rb");
+        if (f == NULL)
+        {
+            fprintf(stderr, "fuzz_dvbpsi: cannot open %s\n", pa_argv[i]);
+            b_ok = false;
+            continue;
+        }
+        b_ok &= run_file(f, pa_argv[i]);
+        fclose(f);
+    }
+    return b_ok ? 0 : 1;
+}
+#endif
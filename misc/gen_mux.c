@@ -0,0 +1,1417 @@
+/*****************************************************************************
+ * gen_mux.c: synthetic DVB or ATSC multiplex generator
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id: $
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ * Builds a complete SI set with the library's generators: PAT and PMTs,
+ * then either NIT, SDT, BAT, EIT present/following and schedule and TDT
+ * (DVB) or MGT, TVCT, STT and EIT-0..EIT-n (ATSC), optionally SCTE-35
+ * splice_insert cues. Every table is a carousel with its own repetition
+ * period, carousels are multiplexed earliest deadline first into a constant
+ * bitrate TS, the remaining packets carry the elementary streams with PCRs.
+ *
+ * The same seed gives the same output byte for byte. CC gaps, bad CRC_32
+ * and truncated sections can be injected at a per mille rate of sections.
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* The libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/descriptor.h"
+#include "../src/tables/pat.h"
+#include "../src/tables/pmt.h"
+#include "../src/tables/nit.h"
+#include "../src/tables/sdt.h"
+#include "../src/tables/bat.h"
+#include "../src/tables/eit.h"
+#include "../src/tables/tot.h"
+#include "../src/tables/atsc_mgt.h"
+#include "../src/tables/atsc_vct.h"
+#include "../src/tables/atsc_stt.h"
+#include "../src/tables/atsc_eit.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/pat.h>
+#include <dvbpsi/pmt.h>
+#include <dvbpsi/nit.h>
+#include <dvbpsi/sdt.h>
+#include <dvbpsi/bat.h>
+#include <dvbpsi/eit.h>
+#include <dvbpsi/tot.h>
+#include <dvbpsi/atsc_mgt.h>
+#include <dvbpsi/atsc_vct.h>
+#include <dvbpsi/atsc_stt.h>
+#include <dvbpsi/atsc_eit.h>
+#endif
+
+#define TS_SIZE 188
+
+#define TS_ID          1
+#define NETWORK_ID     1
+#define BOUQUET_ID     1
+#define PID_NIT        0x10
+#define PID_SDT        0x11  /* and BAT */
+#define PID_EIT        0x12
+#define PID_TDT        0x14
+#define PID_PSIP       0x1ffb
+#define PID_PMT(i)     (0x100 + (i))        /* service index i, from 0 */
+#define PID_VIDEO(i)   (0x1000 + 2 * (i))
+#define PID_AUDIO(i)   (0x1000 + 2 * (i) + 1)
+#define PID_CUE        0x0fff               /* SCTE-35, first service only */
+#define PID_ATSC_EIT   0x1d00               /* EIT-k on PID_ATSC_EIT + k */
+#define PID_NULL       0x1fff
+
+#define MAX_SERVICES   1000
+#define GPS_UTC_OFFSET 16                   /* leap seconds as of 2015 */
+
+/*****************************************************************************
+ * Deterministic random numbers, xorshift64*
+ *****************************************************************************/
+static uint64_t rng_next(uint64_t *p_state)
+{
+    uint64_t x = *p_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *p_state = x;
+    return x * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+/* uniform in [0, i_range) */
+static unsigned int rng_range(uint64_t *p_state, unsigned int i_range)
+{
+    return (unsigned int)((rng_next(p_state) >> 32) % i_range);
+}
+
+/*****************************************************************************
+ * Repetition periods in ms, defaults after ETSI TR 101 211 and ATSC A/65
+ *****************************************************************************/
+typedef enum
+{
+    REPEAT_PAT = 0,
+    REPEAT_PMT,
+    REPEAT_NIT,
+    REPEAT_SDT,
+    REPEAT_BAT,
+    REPEAT_EIT_PF,    /* DVB EIT p/f, ATSC EIT-0..EIT-3 */
+    REPEAT_EIT_SCHED, /* DVB EIT schedule, ATSC EIT-4 and up */
+    REPEAT_TDT,
+    REPEAT_MGT,
+    REPEAT_VCT,
+    REPEAT_STT,
+    REPEAT_TABLES
+} repeat_t;
+
+static const struct
+{
+    const char *psz_name;
+    int i_default;
+} repeats[REPEAT_TABLES] =
+{
+    { "pat", 100 }, { "pmt", 100 }, { "nit", 2000 }, { "sdt", 2000 },
+    { "bat", 2000 }, { "eit-pf", 2000 }, { "eit-sched", 10000 }, { "tdt", 1000 },
+    { "mgt", 150 }, { "vct", 400 }, { "stt", 1000 },
+};
+
+typedef struct
+{
+    const char *psz_output;
+    uint64_t i_seed;
+    bool     b_atsc;
+    int      i_services;
+    int      i_days;
+    int      i_transports;  /* NIT and BAT transport stream loops */
+    int64_t  i_start;       /* unix time of the first schedule day */
+    uint64_t i_rate;        /* bit/s */
+    double   f_duration;    /* s */
+    int      i_cue_period;  /* ms, 0 for none */
+    int      ai_repeat[REPEAT_TABLES];
+    int      i_cc_errors;   /* per mille of sections */
+    int      i_crc_errors;
+    int      i_truncated;
+    bool     b_realtime;
+} params_t;
+
+/*****************************************************************************
+ * Carousels: packetized sections of one table, repeated every i_period
+ *****************************************************************************/
+typedef struct mux_s mux_t;
+typedef struct carousel_s carousel_t;
+
+struct carousel_s
+{
+    char     psz_name[24];
+    uint16_t i_pid;
+    int64_t  i_period;      /* ns */
+    int64_t  i_due;         /* ns, next section */
+
+    uint8_t *p_packets;     /* each section starts a packet */
+    size_t   i_packets;
+    size_t  *pi_section;    /* first packet of each section, i_sections + 1 */
+    size_t   i_sections;
+    size_t   i_section;     /* next section to send */
+
+    /* built at the start of every cycle */
+    bool   (*pf_refresh)(mux_t *mux, carousel_t *carousel, int64_t i_time);
+
+    uint64_t i_cycles;
+    uint64_t i_sent;        /* sections */
+};
+
+struct mux_s
+{
+    params_t  *params;
+    dvbpsi_t  *p_dvbpsi;
+    uint64_t   i_rng;       /* content */
+    uint64_t   i_rng_errors;
+
+    carousel_t *p_carousels;
+    size_t      i_carousels;
+    carousel_t **pp_heap;   /* min heap on i_due */
+    size_t      i_heap;
+
+    uint16_t   *pi_es;      /* filler PIDs */
+    size_t      i_es;
+    size_t      i_es_next;
+
+    uint8_t     ai_cc[8192];
+    uint32_t    i_cue_event;
+
+    /* section in flight */
+    carousel_t *p_current;
+    size_t      i_packet;
+    size_t      i_packet_end;
+    size_t      i_crc_packet; /* packet and offset of a corrupted byte */
+    size_t      i_crc_offset;
+    bool        b_crc_error;
+    bool        b_length_error; /* section_length beyond the first packet */
+
+    uint64_t    i_cc_errors;
+    uint64_t    i_crc_errors;
+    uint64_t    i_truncated;
+    uint64_t    i_filler;
+};
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+    switch(level)
+    {
+        case DVBPSI_MSG_ERROR: fprintf(stderr, "Error: "); break;
+        case DVBPSI_MSG_WARN:  fprintf(stderr, "Warning: "); break;
+        default: /* do nothing */
+            return;
+    }
+    fprintf(stderr, "%s\n", msg);
+}
+
+static size_t section_size(const dvbpsi_psi_section_t *p_section)
+{
+    return 3 + (((p_section->p_data[1] & 0x0f) << 8) | p_section->p_data[2]);
+}
+
+/* Packetize p_sections into the carousel, replacing what it carried */
+static bool carousel_load(carousel_t *carousel, dvbpsi_psi_section_t *p_sections)
+{
+    size_t i_packets = 0, i_sections = 0;
+    for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+    {
+        i_packets += (section_size(p) + 1 + TS_SIZE - 5) / (TS_SIZE - 4);
+        i_sections++;
+    }
+
+    uint8_t *p_packets = realloc(carousel->p_packets, i_packets * TS_SIZE);
+    if (!p_packets && i_packets)
+        return false;
+    carousel->p_packets = p_packets;
+    size_t *pi_section = realloc(carousel->pi_section, (i_sections + 1) * sizeof(size_t));
+    if (!pi_section)
+        return false;
+    carousel->pi_section = pi_section;
+    carousel->i_packets = i_packets;
+    carousel->i_sections = i_sections;
+
+    uint8_t *p_packet = carousel->p_packets;
+    size_t i_section = 0;
+    for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+    {
+        const uint8_t *p_byte = p->p_data;
+        const uint8_t *p_end = p->p_data + section_size(p);
+        bool b_start = true;
+
+        carousel->pi_section[i_section++] = (p_packet - carousel->p_packets) / TS_SIZE;
+        while (p_byte < p_end)
+        {
+            uint8_t *p_pos = p_packet + 4;
+            p_packet[0] = 0x47;
+            p_packet[1] = (b_start ? 0x40 : 0x00) | (carousel->i_pid >> 8);
+            p_packet[2] = carousel->i_pid & 0xff;
+            p_packet[3] = 0x10; /* continuity_counter set when sent */
+            if (b_start)
+                *p_pos++ = 0x00; /* pointer_field */
+            size_t i_copy = p_packet + TS_SIZE - p_pos;
+            if (i_copy > (size_t)(p_end - p_byte))
+                i_copy = p_end - p_byte;
+            memcpy(p_pos, p_byte, i_copy);
+            p_pos += i_copy;
+            p_byte += i_copy;
+            memset(p_pos, 0xff, p_packet + TS_SIZE - p_pos);
+            p_packet += TS_SIZE;
+            b_start = false;
+        }
+    }
+    carousel->pi_section[i_section] = i_packets;
+    return true;
+}
+
+static carousel_t *carousel_add(mux_t *mux, const char *psz_name, uint16_t i_pid,
+                                int i_period_ms, dvbpsi_psi_section_t *p_sections)
+{
+    if (p_sections == NULL)
+    {
+        fprintf(stderr, "Error: %s generation failed\n", psz_name);
+        return NULL;
+    }
+
+    carousel_t *carousel = &mux->p_carousels[mux->i_carousels];
+    memset(carousel, 0, sizeof(carousel_t));
+    snprintf(carousel->psz_name, sizeof(carousel->psz_name), "%s", psz_name);
+    carousel->i_pid = i_pid;
+    carousel->i_period = (int64_t)i_period_ms * 1000000;
+
+    bool b_ok = carousel_load(carousel, p_sections);
+    dvbpsi_DeletePSISections(p_sections);
+    if (!b_ok)
+    {
+        free(carousel->p_packets);
+        free(carousel->pi_section);
+        fprintf(stderr, "Error: out of memory\n");
+        return NULL;
+    }
+    mux->i_carousels++;
+    return carousel;
+}
+
+/*****************************************************************************
+ * Deadline heap
+ *****************************************************************************/
+static void heap_push(mux_t *mux, carousel_t *carousel)
+{
+    size_t i = mux->i_heap++;
+    while (i > 0)
+    {
+        size_t i_parent = (i - 1) / 2;
+        if (mux->pp_heap[i_parent]->i_due <= carousel->i_due)
+            break;
+        mux->pp_heap[i] = mux->pp_heap[i_parent];
+        i = i_parent;
+    }
+    mux->pp_heap[i] = carousel;
+}
+
+static carousel_t *heap_pop(mux_t *mux)
+{
+    carousel_t *p_top = mux->pp_heap[0];
+    carousel_t *p_last = mux->pp_heap[--mux->i_heap];
+    size_t i = 0;
+    for (;;)
+    {
+        size_t i_child = 2 * i + 1;
+        if (i_child >= mux->i_heap)
+            break;
+        if ((i_child + 1 < mux->i_heap) &&
+            (mux->pp_heap[i_child + 1]->i_due < mux->pp_heap[i_child]->i_due))
+            i_child++;
+        if (p_last->i_due <= mux->pp_heap[i_child]->i_due)
+            break;
+        mux->pp_heap[i] = mux->pp_heap[i_child];
+        i = i_child;
+    }
+    if (mux->i_heap > 0)
+        mux->pp_heap[i] = p_last;
+    return p_top;
+}
+
+/*****************************************************************************
+ * Content helpers
+ *****************************************************************************/
+static const char *const ppsz_words[] =
+{
+    "News", "Sport", "Movie", "Kids", "Music", "Weather", "Nature", "History",
+    "Cooking", "Drama", "Comedy", "Science", "Travel", "Classic", "Live", "Night",
+    "Morning", "World", "Local", "Cinema", "Series", "Documentary", "Quiz", "Arts",
+};
+#define WORDS (sizeof(ppsz_words) / sizeof(ppsz_words[0]))
+
+/* "Word Word" in at most i_max bytes, not terminated, returns the length */
+static uint8_t random_name(uint64_t *p_rng, uint8_t *p_name, size_t i_max)
+{
+    char psz_name[64];
+    int i_len = snprintf(psz_name, sizeof(psz_name), "%s %s",
+                         ppsz_words[rng_range(p_rng, WORDS)],
+                         ppsz_words[rng_range(p_rng, WORDS)]);
+    if ((size_t)i_len > i_max)
+        i_len = i_max;
+    memcpy(p_name, psz_name, i_len);
+    return (uint8_t)i_len;
+}
+
+static uint8_t to_bcd(int i_value)
+{
+    return (uint8_t)(((i_value / 10) << 4) | (i_value % 10));
+}
+
+/* 40 bit MJD + BCD UTC time of a unix time */
+static uint64_t dvb_time(int64_t i_time)
+{
+    uint64_t i_mjd = (uint64_t)(i_time / 86400 + 40587);
+    int i_seconds = (int)(i_time % 86400);
+    return (i_mjd << 24) | ((uint64_t)to_bcd(i_seconds / 3600) << 16) |
+           ((uint64_t)to_bcd((i_seconds / 60) % 60) << 8) | to_bcd(i_seconds % 60);
+}
+
+static uint32_t dvb_duration(int i_seconds)
+{
+    return ((uint32_t)to_bcd(i_seconds / 3600) << 16) |
+           ((uint32_t)to_bcd((i_seconds / 60) % 60) << 8) | to_bcd(i_seconds % 60);
+}
+
+static uint32_t gps_time(int64_t i_time)
+{
+    return (uint32_t)(i_time - 315964800 + GPS_UTC_OFFSET);
+}
+
+/* Events of one service, back to back over the schedule */
+typedef struct
+{
+    uint16_t i_id;
+    int64_t  i_start;   /* unix time */
+    int      i_duration;/* s */
+    uint8_t  ai_title[32];
+    uint8_t  i_title;
+    uint8_t  i_genre;
+} event_t;
+
+static event_t *service_events(mux_t *mux, size_t *pi_events)
+{
+    const params_t *params = mux->params;
+    const int64_t i_end = params->i_start + (int64_t)params->i_days * 86400;
+    size_t i_max = (size_t)params->i_days * 96 + 1; /* 15 minutes at least */
+    event_t *p_events = malloc(i_max * sizeof(event_t));
+    if (!p_events)
+        return NULL;
+
+    size_t i = 0;
+    for (int64_t i_time = params->i_start; (i_time < i_end) && (i < i_max); i++)
+    {
+        event_t *p_event = &p_events[i];
+        p_event->i_id = (uint16_t)(i + 1);
+        p_event->i_start = i_time;
+        p_event->i_duration = (3 + rng_range(&mux->i_rng, 22)) * 300; /* 15 to 120 minutes */
+        p_event->i_title = random_name(&mux->i_rng, p_event->ai_title, sizeof(p_event->ai_title));
+        p_event->i_genre = (uint8_t)((1 + rng_range(&mux->i_rng, 11)) << 4);
+        i_time += p_event->i_duration;
+    }
+    *pi_events = i;
+    return p_events;
+}
+
+/* Renumber a generated section and rebuild its header and CRC_32 */
+static void section_number(mux_t *mux, dvbpsi_psi_section_t *p_section, uint8_t i_number,
+                           uint8_t i_last, int i_segment_last)
+{
+    p_section->i_number = i_number;
+    p_section->i_last_number = i_last;
+    if (i_segment_last >= 0)
+        p_section->p_data[12] = (uint8_t)i_segment_last;
+    dvbpsi_BuildPSISection(mux->p_dvbpsi, p_section);
+}
+
+static dvbpsi_psi_section_t *section_append(dvbpsi_psi_section_t **pp_first,
+                                            dvbpsi_psi_section_t *p_last,
+                                            dvbpsi_psi_section_t *p_sections)
+{
+    if (!p_sections)
+        return p_last;
+    if (p_last)
+        p_last->p_next = p_sections;
+    else
+        *pp_first = p_sections;
+    while (p_sections->p_next)
+        p_sections = p_sections->p_next;
+    return p_sections;
+}
+
+/*****************************************************************************
+ * PAT and PMTs, common to DVB and ATSC
+ *****************************************************************************/
+static bool build_psi(mux_t *mux)
+{
+    const params_t *params = mux->params;
+
+    dvbpsi_pat_t *p_pat = dvbpsi_pat_new(TS_ID, 0, true);
+    if (!p_pat)
+        return false;
+    if (!params->b_atsc)
+        dvbpsi_pat_program_add(p_pat, 0, PID_NIT);
+    for (int i = 0; i < params->i_services; i++)
+        dvbpsi_pat_program_add(p_pat, i + 1, PID_PMT(i));
+    carousel_t *carousel = carousel_add(mux, "PAT", 0x00, params->ai_repeat[REPEAT_PAT],
+                                        dvbpsi_pat_sections_generate(mux->p_dvbpsi, p_pat, 253));
+    dvbpsi_pat_delete(p_pat);
+    if (!carousel)
+        return false;
+
+    for (int i = 0; i < params->i_services; i++)
+    {
+        dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(i + 1, 0, true, PID_VIDEO(i));
+        if (!p_pmt)
+            return false;
+        uint8_t ai_language[4] = { 'e', 'n', 'g', 0x00 };
+        dvbpsi_pmt_es_add(p_pmt, (i % 2) ? 0x1b : 0x02, PID_VIDEO(i));
+        dvbpsi_pmt_es_t *p_es = dvbpsi_pmt_es_add(p_pmt, params->b_atsc ? 0x81 : 0x04,
+                                                  PID_AUDIO(i));
+        if (p_es)
+            dvbpsi_pmt_es_descriptor_add(p_es, 0x0a, sizeof(ai_language), ai_language);
+        if ((i == 0) && (params->i_cue_period > 0))
+        {
+            uint8_t ai_cuei[4] = { 'C', 'U', 'E', 'I' };
+            dvbpsi_pmt_descriptor_add(p_pmt, 0x05, sizeof(ai_cuei), ai_cuei);
+            dvbpsi_pmt_es_add(p_pmt, 0x86, PID_CUE);
+        }
+
+        char psz_name[24];
+        snprintf(psz_name, sizeof(psz_name), "PMT %d", i + 1);
+        carousel = carousel_add(mux, psz_name, PID_PMT(i), params->ai_repeat[REPEAT_PMT],
+                                dvbpsi_pmt_sections_generate(mux->p_dvbpsi, p_pmt));
+        dvbpsi_pmt_delete(p_pmt);
+        if (!carousel)
+            return false;
+
+        mux->pi_es[mux->i_es++] = PID_VIDEO(i);
+        mux->pi_es[mux->i_es++] = PID_AUDIO(i);
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * DVB: NIT, SDT, BAT, EIT and TDT
+ *****************************************************************************/
+/* service_list_descriptor(s) for n services from i_first on */
+static void service_list_add(dvbpsi_nit_ts_t *p_nit_ts, dvbpsi_bat_ts_t *p_bat_ts,
+                             uint16_t i_first, int i_services)
+{
+    uint8_t ai_list[255];
+    while (i_services > 0)
+    {
+        int i_count = (i_services > 85) ? 85 : i_services;
+        for (int i = 0; i < i_count; i++)
+        {
+            ai_list[3 * i] = (uint8_t)((i_first + i) >> 8);
+            ai_list[3 * i + 1] = (uint8_t)(i_first + i);
+            ai_list[3 * i + 2] = 0x01; /* digital television */
+        }
+        if (p_nit_ts)
+            dvbpsi_nit_ts_descriptor_add(p_nit_ts, 0x41, 3 * i_count, ai_list);
+        if (p_bat_ts)
+            dvbpsi_bat_ts_descriptor_add(p_bat_ts, 0x41, 3 * i_count, ai_list);
+        i_first += i_count;
+        i_services -= i_count;
+    }
+}
+
+static bool build_nit_bat(mux_t *mux)
+{
+    const params_t *params = mux->params;
+    uint8_t ai_name[32];
+    uint8_t i_name;
+
+    dvbpsi_nit_t *p_nit = dvbpsi_nit_new(0x40, NETWORK_ID, NETWORK_ID, 0, true);
+    dvbpsi_bat_t *p_bat = dvbpsi_bat_new(0x4a, BOUQUET_ID, 0, true);
+    if (!p_nit || !p_bat)
+    {
+        if (p_nit) dvbpsi_nit_delete(p_nit);
+        if (p_bat) dvbpsi_bat_delete(p_bat);
+        return false;
+    }
+
+    i_name = random_name(&mux->i_rng, ai_name, sizeof(ai_name));
+    dvbpsi_nit_descriptor_add(p_nit, 0x40, i_name, ai_name);
+    i_name = random_name(&mux->i_rng, ai_name, sizeof(ai_name));
+    dvbpsi_bat_bouquet_descriptor_add(p_bat, 0x47, i_name, ai_name);
+
+    for (int t = 0; t < params->i_transports; t++)
+    {
+        uint16_t i_ts_id = TS_ID + t;
+        dvbpsi_nit_ts_t *p_nit_ts = dvbpsi_nit_ts_add(p_nit, i_ts_id, NETWORK_ID);
+        dvbpsi_bat_ts_t *p_bat_ts = dvbpsi_bat_ts_add(p_bat, i_ts_id, NETWORK_ID);
+        if (!p_nit_ts || !p_bat_ts)
+            continue;
+
+        /* terrestrial_delivery_system_descriptor, 474 MHz + 8 MHz per TS */
+        uint32_t i_frequency = (474000000 + (uint32_t)(t % 48) * 8000000) / 10;
+        uint8_t ai_delivery[11] = { i_frequency >> 24, i_frequency >> 16, i_frequency >> 8,
+                                    i_frequency, 0x1f, 0x83, 0x0a, 0xff, 0xff, 0xff, 0xff };
+        dvbpsi_nit_ts_descriptor_add(p_nit_ts, 0x5a, sizeof(ai_delivery), ai_delivery);
+
+        if (t == 0)
+            service_list_add(p_nit_ts, p_bat_ts, 1, params->i_services);
+        else
+            service_list_add(p_nit_ts, p_bat_ts, (uint16_t)(t * 100 + 1),
+                             4 + rng_range(&mux->i_rng, 13));
+    }
+
+    bool b_ok = carousel_add(mux, "NIT", PID_NIT, params->ai_repeat[REPEAT_NIT],
+                    dvbpsi_nit_sections_generate(mux->p_dvbpsi, p_nit, 0x40)) != NULL;
+    b_ok &= carousel_add(mux, "BAT", PID_SDT, params->ai_repeat[REPEAT_BAT],
+                    dvbpsi_bat_sections_generate(mux->p_dvbpsi, p_bat)) != NULL;
+    dvbpsi_nit_delete(p_nit);
+    dvbpsi_bat_delete(p_bat);
+    return b_ok;
+}
+
+static bool build_sdt(mux_t *mux)
+{
+    const params_t *params = mux->params;
+    dvbpsi_sdt_t *p_sdt = dvbpsi_sdt_new(0x42, TS_ID, 0, true, NETWORK_ID);
+    if (!p_sdt)
+        return false;
+
+    for (int i = 0; i < params->i_services; i++)
+    {
+        dvbpsi_sdt_service_t *p_service = dvbpsi_sdt_service_add(p_sdt, i + 1, true, true,
+                                                                 4, false);
+        if (!p_service)
+            continue;
+        /* service_descriptor: type, provider, name */
+        uint8_t ai_service[2 + 2 * 32 + 1];
+        ai_service[0] = 0x01;
+        ai_service[1] = random_name(&mux->i_rng, &ai_service[2], 32);
+        uint8_t *p_name = &ai_service[2 + ai_service[1]];
+        p_name[0] = random_name(&mux->i_rng, &p_name[1], 32);
+        dvbpsi_sdt_service_descriptor_add(p_service, 0x48, 3 + ai_service[1] + p_name[0],
+                                          ai_service);
+    }
+
+    bool b_ok = carousel_add(mux, "SDT", PID_SDT, params->ai_repeat[REPEAT_SDT],
+                    dvbpsi_sdt_sections_generate(mux->p_dvbpsi, p_sdt)) != NULL;
+    dvbpsi_sdt_delete(p_sdt);
+    return b_ok;
+}
+
+static void eit_event_add(dvbpsi_eit_t *p_eit, const event_t *p_event, uint8_t i_running)
+{
+    dvbpsi_eit_event_t *p_eit_event = dvbpsi_eit_event_add(p_eit, p_event->i_id,
+                                          dvb_time(p_event->i_start),
+                                          dvb_duration(p_event->i_duration),
+                                          i_running, false, 0);
+    if (!p_eit_event)
+        return;
+
+    /* short_event_descriptor and content_descriptor */
+    uint8_t ai_short[3 + 1 + 32 + 1 + 32];
+    memcpy(ai_short, "eng", 3);
+    ai_short[3] = p_event->i_title;
+    memcpy(&ai_short[4], p_event->ai_title, p_event->i_title);
+    uint8_t *p_text = &ai_short[4 + p_event->i_title];
+    p_text[0] = p_event->i_title;
+    memcpy(&p_text[1], p_event->ai_title, p_event->i_title);
+    dvbpsi_eit_event_descriptor_add(p_eit_event, 0x4d, 5 + 2 * p_event->i_title, ai_short);
+
+    uint8_t ai_content[2] = { p_event->i_genre, 0x00 };
+    dvbpsi_eit_event_descriptor_add(p_eit_event, 0x54, sizeof(ai_content), ai_content);
+}
+
+/* EIT p/f: present event in section 0, following in section 1 */
+static dvbpsi_psi_section_t *eit_pf(mux_t *mux, uint16_t i_service, const event_t *p_events,
+                                    size_t i_events)
+{
+    dvbpsi_psi_section_t *p_first = NULL, *p_last = NULL;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dvbpsi_eit_t *p_eit = dvbpsi_eit_new(0x4e, i_service, 0, true, TS_ID, NETWORK_ID,
+                                             1, 0x4e);
+        if (!p_eit)
+            break;
+        if (i < i_events)
+            eit_event_add(p_eit, &p_events[i], (i == 0) ? 4 : 1);
+        dvbpsi_psi_section_t *p_section = dvbpsi_eit_sections_generate(mux->p_dvbpsi,
+                                                                       p_eit, 0x4e);
+        dvbpsi_eit_delete(p_eit);
+        if (!p_section)
+            break;
+        section_number(mux, p_section, i, 1, 1);
+        p_last = section_append(&p_first, p_last, p_section);
+    }
+    return p_first;
+}
+
+/* EIT schedule: 3 hour segments of 8 sections, 4 days per table_id */
+static dvbpsi_psi_section_t *eit_schedule(mux_t *mux, uint16_t i_service,
+                                          const event_t *p_events, size_t i_events)
+{
+    const params_t *params = mux->params;
+    const uint8_t i_last_table_id = 0x50 + (params->i_days - 1) / 4;
+    dvbpsi_psi_section_t *p_first = NULL, *p_last = NULL;
+    size_t e = 0;
+
+    for (uint8_t i_table_id = 0x50; i_table_id <= i_last_table_id; i_table_id++)
+    {
+        dvbpsi_psi_section_t *p_table = NULL, *p_table_last = NULL;
+        uint8_t i_last_number = 0;
+        int i_day = (i_table_id - 0x50) * 4;
+
+        for (int i_segment = 0; (i_segment < 32) && (i_day + i_segment / 8 < params->i_days);
+             i_segment++)
+        {
+            int64_t i_end = params->i_start + (int64_t)i_day * 86400 + (i_segment + 1) * 10800;
+            dvbpsi_eit_t *p_eit = dvbpsi_eit_new(i_table_id, i_service, 0, true, TS_ID,
+                                                 NETWORK_ID, 0, i_last_table_id);
+            if (!p_eit)
+                break;
+            for (; (e < i_events) && (p_events[e].i_start < i_end); e++)
+                eit_event_add(p_eit, &p_events[e], 1);
+            dvbpsi_psi_section_t *p_sections = dvbpsi_eit_sections_generate(mux->p_dvbpsi,
+                                                                p_eit, i_table_id);
+            dvbpsi_eit_delete(p_eit);
+
+            uint8_t i_count = 0;
+            for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+                i_count++;
+            if (i_count > 8)
+                i_count = 8; /* more than a segment holds, only with huge events */
+            uint8_t i_number = (uint8_t)(i_segment * 8);
+            for (dvbpsi_psi_section_t *p = p_sections; p; p = p->p_next)
+            {
+                p->i_number = i_number++;
+                p->p_data[12] = (uint8_t)(i_segment * 8 + i_count - 1);
+            }
+            if (i_count > 0)
+                i_last_number = (uint8_t)(i_segment * 8 + i_count - 1);
+            p_table_last = section_append(&p_table, p_table_last, p_sections);
+        }
+
+        for (dvbpsi_psi_section_t *p = p_table; p; p = p->p_next)
+            section_number(mux, p, p->i_number, i_last_number, -1);
+        p_last = section_append(&p_first, p_last, p_table);
+    }
+    return p_first;
+}
+
+static bool tdt_refresh(mux_t *mux, carousel_t *carousel, int64_t i_time)
+{
+    dvbpsi_tot_t *p_tdt = dvbpsi_tot_new(0x70, 0, 0, true,
+                                         dvb_time(mux->params->i_start + i_time / 1000000000));
+    if (!p_tdt)
+        return false;
+    dvbpsi_psi_section_t *p_section = dvbpsi_tot_sections_generate(mux->p_dvbpsi, p_tdt);
+    dvbpsi_tot_delete(p_tdt);
+    if (!p_section)
+        return false;
+    bool b_ok = carousel_load(carousel, p_section);
+    dvbpsi_DeletePSISections(p_section);
+    return b_ok;
+}
+
+static bool build_dvb(mux_t *mux)
+{
+    const params_t *params = mux->params;
+    dvbpsi_psi_section_t *p_pf = NULL, *p_pf_last = NULL;
+    dvbpsi_psi_section_t *p_sched = NULL, *p_sched_last = NULL;
+
+    if (!build_nit_bat(mux) || !build_sdt(mux))
+        return false;
+
+    for (int i = 0; i < params->i_services; i++)
+    {
+        size_t i_events;
+        event_t *p_events = service_events(mux, &i_events);
+        if (!p_events)
+            break;
+        p_pf_last = section_append(&p_pf, p_pf_last, eit_pf(mux, i + 1, p_events, i_events));
+        if (params->i_days > 0)
+            p_sched_last = section_append(&p_sched, p_sched_last,
+                                          eit_schedule(mux, i + 1, p_events, i_events));
+        free(p_events);
+    }
+
+    if (!carousel_add(mux, "EIT p/f", PID_EIT, params->ai_repeat[REPEAT_EIT_PF], p_pf))
+        return false;
+    if (p_sched && !carousel_add(mux, "EIT schedule", PID_EIT,
+                                 params->ai_repeat[REPEAT_EIT_SCHED], p_sched))
+        return false;
+
+    carousel_t *carousel = &mux->p_carousels[mux->i_carousels];
+    memset(carousel, 0, sizeof(carousel_t));
+    snprintf(carousel->psz_name, sizeof(carousel->psz_name), "TDT");
+    carousel->i_pid = PID_TDT;
+    carousel->i_period = (int64_t)params->ai_repeat[REPEAT_TDT] * 1000000;
+    carousel->pf_refresh = tdt_refresh;
+    mux->i_carousels++;
+    return true;
+}
+
+/*****************************************************************************
+ * ATSC: MGT, TVCT, STT and EIT-k
+ *****************************************************************************/
+static bool stt_refresh(mux_t *mux, carousel_t *carousel, int64_t i_time)
+{
+    dvbpsi_atsc_stt_t *p_stt = dvbpsi_atsc_stt_new(0xcd, 0, 0, true);
+    if (!p_stt)
+        return false;
+    p_stt->i_system_time = gps_time(mux->params->i_start + i_time / 1000000000);
+    p_stt->i_gps_utc_offset = GPS_UTC_OFFSET;
+    p_stt->i_daylight_savings = 0x6000; /* not in daylight saving time */
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_stt_sections_generate(mux->p_dvbpsi, p_stt);
+    dvbpsi_atsc_stt_delete(p_stt);
+    if (!p_section)
+        return false;
+    bool b_ok = carousel_load(carousel, p_section);
+    dvbpsi_DeletePSISections(p_section);
+    return b_ok;
+}
+
+static uint32_t sections_bytes(const dvbpsi_psi_section_t *p_sections)
+{
+    uint32_t i_bytes = 0;
+    for (; p_sections; p_sections = p_sections->p_next)
+        i_bytes += section_size(p_sections);
+    return i_bytes;
+}
+
+static bool build_atsc(mux_t *mux)
+{
+    const params_t *params = mux->params;
+    int i_eits = params->i_days * 8;
+    if (i_eits < 4)
+        i_eits = 4;
+    if (i_eits > 128)
+        i_eits = 128;
+
+    dvbpsi_atsc_mgt_t *p_mgt = dvbpsi_atsc_mgt_new(0xc7, 0, 0, 0, true);
+    dvbpsi_atsc_vct_t *p_vct = dvbpsi_atsc_vct_new(0xc8, TS_ID, 0, false, 0, true);
+    if (!p_mgt || !p_vct)
+    {
+        if (p_mgt) dvbpsi_atsc_mgt_delete(p_mgt);
+        if (p_vct) dvbpsi_atsc_vct_delete(p_vct);
+        return false;
+    }
+
+    for (int i = 0; i < params->i_services; i++)
+    {
+        /* 7 UTF-16BE characters */
+        uint8_t ai_name[8], ai_short[14];
+        uint8_t i_name = random_name(&mux->i_rng, ai_name, sizeof(ai_name) - 1);
+        memset(ai_short, 0, sizeof(ai_short));
+        for (int c = 0; (c < i_name) && (c < 7); c++)
+            ai_short[2 * c + 1] = ai_name[c];
+        dvbpsi_atsc_vct_channel_add(p_vct, ai_short, 2 + i / 100, 1 + i % 100, 0x04, 0,
+                                    TS_ID, i + 1, 0, false, false, false, false, false,
+                                    0x02, i + 1);
+    }
+    dvbpsi_psi_section_t *p_vct_sections = dvbpsi_atsc_vct_sections_generate(mux->p_dvbpsi,
+                                                                            p_vct);
+    dvbpsi_atsc_vct_delete(p_vct);
+    dvbpsi_atsc_mgt_table_add(p_mgt, 0x0000, PID_PSIP, 0, sections_bytes(p_vct_sections));
+    if (!carousel_add(mux, "TVCT", PID_PSIP, params->ai_repeat[REPEAT_VCT], p_vct_sections))
+    {
+        dvbpsi_atsc_mgt_delete(p_mgt);
+        return false;
+    }
+
+    /* EIT-k covers the 3 hours from start + 3k hours, one table per source */
+    event_t **pp_events = calloc(params->i_services, sizeof(event_t *));
+    size_t *pi_events = calloc(params->i_services, sizeof(size_t));
+    size_t *pi_next = calloc(params->i_services, sizeof(size_t));
+    bool b_ok = pp_events && pi_events && pi_next;
+    for (int i = 0; b_ok && (i < params->i_services); i++)
+        b_ok = (pp_events[i] = service_events(mux, &pi_events[i])) != NULL;
+
+    for (int k = 0; b_ok && (k < i_eits); k++)
+    {
+        const int64_t i_end = params->i_start + (int64_t)(k + 1) * 10800;
+        dvbpsi_psi_section_t *p_first = NULL, *p_last = NULL;
+        for (int i = 0; i < params->i_services; i++)
+        {
+            dvbpsi_atsc_eit_t *p_eit = dvbpsi_atsc_eit_new(0xcb, i + 1, 0, 0, i + 1, true);
+            if (!p_eit)
+                continue;
+            for (; (pi_next[i] < pi_events[i]) && (pp_events[i][pi_next[i]].i_start < i_end);
+                 pi_next[i]++)
+            {
+                const event_t *p_event = &pp_events[i][pi_next[i]];
+                /* multiple_string_structure, one uncompressed English string */
+                uint8_t ai_title[8 + 32];
+                ai_title[0] = 1;
+                memcpy(&ai_title[1], "eng", 3);
+                ai_title[4] = 1;
+                ai_title[5] = 0;
+                ai_title[6] = 0;
+                ai_title[7] = p_event->i_title;
+                memcpy(&ai_title[8], p_event->ai_title, p_event->i_title);
+                dvbpsi_atsc_eit_event_add(p_eit, p_event->i_id & 0x3fff,
+                                          gps_time(p_event->i_start), 0,
+                                          p_event->i_duration, 8 + p_event->i_title, ai_title);
+            }
+            p_last = section_append(&p_first, p_last,
+                                    dvbpsi_atsc_eit_sections_generate(mux->p_dvbpsi, p_eit));
+            dvbpsi_atsc_eit_delete(p_eit);
+        }
+
+        char psz_name[24];
+        snprintf(psz_name, sizeof(psz_name), "EIT-%d", k);
+        dvbpsi_atsc_mgt_table_add(p_mgt, 0x0100 + k, PID_ATSC_EIT + k, 0, sections_bytes(p_first));
+        b_ok = carousel_add(mux, psz_name, PID_ATSC_EIT + k,
+                            params->ai_repeat[(k < 4) ? REPEAT_EIT_PF : REPEAT_EIT_SCHED],
+                            p_first) != NULL;
+    }
+
+    for (int i = 0; pp_events && (i < params->i_services); i++)
+        free(pp_events[i]);
+    free(pp_events);
+    free(pi_events);
+    free(pi_next);
+
+    if (b_ok)
+        b_ok = carousel_add(mux, "MGT", PID_PSIP, params->ai_repeat[REPEAT_MGT],
+                            dvbpsi_atsc_mgt_sections_generate(mux->p_dvbpsi, p_mgt)) != NULL;
+    dvbpsi_atsc_mgt_delete(p_mgt);
+    if (!b_ok)
+        return false;
+
+    carousel_t *carousel = &mux->p_carousels[mux->i_carousels];
+    memset(carousel, 0, sizeof(carousel_t));
+    snprintf(carousel->psz_name, sizeof(carousel->psz_name), "STT");
+    carousel->i_pid = PID_PSIP;
+    carousel->i_period = (int64_t)params->ai_repeat[REPEAT_STT] * 1000000;
+    carousel->pf_refresh = stt_refresh;
+    mux->i_carousels++;
+    return true;
+}
+
+/*****************************************************************************
+ * SCTE-35 splice_insert, 4 s ahead of the mux time with a 30 s break
+ *****************************************************************************/
+static bool cue_refresh(mux_t *mux, carousel_t *carousel, int64_t i_time)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(64);
+    if (!p_section)
+        return false;
+
+    uint64_t i_pts = ((uint64_t)(i_time / 1000000 + 4000) * 90) & UINT64_C(0x1ffffffff);
+    uint64_t i_duration = 30 * 90000;
+    uint32_t i_event = ++mux->i_cue_event;
+    uint8_t *p = p_section->p_data;
+
+    p_section->i_table_id = 0xfc;
+    p_section->b_syntax_indicator = false;
+    p_section->b_private_indicator = false;
+    p_section->i_length = 37;
+    p[0] = 0xfc;
+    p[1] = 0x30;                /* section_length */
+    p[2] = 37;
+    p[3] = 0x00;                /* protocol_version */
+    memset(&p[4], 0, 5);        /* not encrypted, pts_adjustment 0 */
+    p[9] = 0x00;                /* cw_index */
+    p[10] = 0xff;               /* tier 0xfff */
+    p[11] = 0xf0;               /* splice_command_length 20 */
+    p[12] = 20;
+    p[13] = 0x05;               /* splice_insert */
+    p[14] = i_event >> 24;
+    p[15] = i_event >> 16;
+    p[16] = i_event >> 8;
+    p[17] = i_event;
+    p[18] = 0x7f;               /* not cancelled */
+    p[19] = 0xef;               /* out of network, program splice, duration */
+    p[20] = 0xfe | (uint8_t)(i_pts >> 32);
+    p[21] = i_pts >> 24;
+    p[22] = i_pts >> 16;
+    p[23] = i_pts >> 8;
+    p[24] = i_pts;
+    p[25] = 0xfe | (uint8_t)(i_duration >> 32); /* auto_return */
+    p[26] = i_duration >> 24;
+    p[27] = i_duration >> 16;
+    p[28] = i_duration >> 8;
+    p[29] = i_duration;
+    p[30] = 0x00;               /* unique_program_id */
+    p[31] = 0x01;
+    p[32] = 0x00;               /* avail_num */
+    p[33] = 0x00;               /* avails_expected */
+    p[34] = 0x00;               /* descriptor_loop_length */
+    p[35] = 0x00;
+    p_section->p_payload_start = p + 14;
+    p_section->p_payload_end = p + 36;
+    dvbpsi_CalculateCRC32(p_section);
+
+    bool b_ok = carousel_load(carousel, p_section);
+    dvbpsi_DeletePSISections(p_section);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * Multiplexing
+ *****************************************************************************/
+static bool mux_refresh(mux_t *mux, carousel_t *carousel, int64_t i_time)
+{
+    if (!carousel->pf_refresh)
+        return true;
+    return carousel->pf_refresh(mux, carousel, i_time);
+}
+
+/* Start sending the next section of carousel, deciding on injected errors */
+static void section_start(mux_t *mux, carousel_t *carousel)
+{
+    const params_t *params = mux->params;
+    size_t i_first = carousel->pi_section[carousel->i_section];
+    size_t i_end = carousel->pi_section[carousel->i_section + 1];
+
+    mux->p_current = carousel;
+    mux->i_packet = i_first;
+    mux->i_packet_end = i_end;
+    mux->b_crc_error = false;
+    mux->b_length_error = false;
+
+    if (params->i_cc_errors &&
+        ((int)rng_range(&mux->i_rng_errors, 1000) < params->i_cc_errors))
+    {
+        mux->ai_cc[carousel->i_pid]++;
+        mux->i_cc_errors++;
+    }
+
+    const uint8_t *p_packet = &carousel->p_packets[i_first * TS_SIZE];
+    if (params->i_crc_errors && (p_packet[5] != 0x70) &&
+        ((int)rng_range(&mux->i_rng_errors, 1000) < params->i_crc_errors))
+    {
+        /* last byte of the CRC_32 */
+        size_t i_byte = 3 + (((p_packet[6] & 0x0f) << 8) | p_packet[7]) - 1;
+        if (i_byte < TS_SIZE - 5)
+        {
+            mux->i_crc_packet = i_first;
+            mux->i_crc_offset = 5 + i_byte;
+        }
+        else
+        {
+            i_byte -= TS_SIZE - 5;
+            mux->i_crc_packet = i_first + 1 + i_byte / (TS_SIZE - 4);
+            mux->i_crc_offset = 4 + i_byte % (TS_SIZE - 4);
+        }
+        mux->b_crc_error = true;
+        mux->i_crc_errors++;
+    }
+
+    if (params->i_truncated &&
+        ((int)rng_range(&mux->i_rng_errors, 1000) < params->i_truncated))
+    {
+        /* drop all but the first packet, the next section on the PID
+         * cuts it short; a single packet section announces more bytes */
+        mux->i_packet_end = i_first + 1;
+        mux->b_length_error = (i_end == i_first + 1);
+        mux->i_truncated++;
+    }
+}
+
+static void section_packet(mux_t *mux, uint8_t *p_out)
+{
+    carousel_t *carousel = mux->p_current;
+    memcpy(p_out, &carousel->p_packets[mux->i_packet * TS_SIZE], TS_SIZE);
+    p_out[3] = 0x10 | (mux->ai_cc[carousel->i_pid]++ & 0x0f);
+    if (mux->b_crc_error && (mux->i_crc_packet == mux->i_packet))
+        p_out[mux->i_crc_offset] ^= 0x01;
+    if (mux->b_length_error)
+    {
+        unsigned int i_length = (((p_out[6] & 0x0f) << 8) | p_out[7]) + TS_SIZE - 4;
+        if (i_length > 0xffd)
+            i_length = 0xffd;
+        p_out[6] = (p_out[6] & 0xf0) | (i_length >> 8);
+        p_out[7] = i_length & 0xff;
+    }
+    mux->i_packet++;
+}
+
+static void filler_packet(mux_t *mux, uint8_t *p_out, int64_t i_time)
+{
+    uint16_t i_pid = PID_NULL;
+    if (mux->i_es > 0)
+    {
+        i_pid = mux->pi_es[mux->i_es_next];
+        mux->i_es_next = (mux->i_es_next + 1) % mux->i_es;
+    }
+
+    p_out[0] = 0x47;
+    p_out[1] = i_pid >> 8;
+    p_out[2] = i_pid & 0xff;
+    p_out[3] = 0x10 | (mux->ai_cc[i_pid]++ & 0x0f);
+    memset(&p_out[4], 0xff, TS_SIZE - 4);
+    if ((i_pid >= PID_VIDEO(0)) && !(i_pid & 1))
+    {
+        /* PCR on every video packet */
+        uint64_t i_pcr = (uint64_t)(i_time * 27 / 1000);
+        uint64_t i_base = (i_pcr / 300) & UINT64_C(0x1ffffffff);
+        unsigned int i_ext = i_pcr % 300;
+        p_out[3] |= 0x20;
+        p_out[4] = 7;
+        p_out[5] = 0x10;
+        p_out[6] = i_base >> 25;
+        p_out[7] = i_base >> 17;
+        p_out[8] = i_base >> 9;
+        p_out[9] = i_base >> 1;
+        p_out[10] = ((i_base & 1) << 7) | 0x7e | (i_ext >> 8);
+        p_out[11] = i_ext & 0xff;
+    }
+    if (i_pid == PID_NULL)
+        p_out[3] = 0x10;
+    mux->i_filler++;
+}
+
+static void sleep_until(const struct timespec *p_start, int64_t i_time)
+{
+    struct timespec ts = *p_start;
+    ts.tv_sec += i_time / 1000000000;
+    ts.tv_nsec += i_time % 1000000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+#define MUX_CHUNK 64 /* packets per write */
+
+static bool mux_run(mux_t *mux, FILE *p_out)
+{
+    const params_t *params = mux->params;
+    const double f_packet_ns = TS_SIZE * 8 * 1e9 / (double)params->i_rate;
+    const uint64_t i_total = (uint64_t)(params->f_duration * 1e9 / f_packet_ns);
+    uint8_t ai_chunk[MUX_CHUNK * TS_SIZE];
+    size_t i_chunk = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < mux->i_carousels; i++)
+        heap_push(mux, &mux->p_carousels[i]);
+
+    for (uint64_t n = 0; n < i_total; n++)
+    {
+        const int64_t i_now = (int64_t)((double)n * f_packet_ns);
+        uint8_t *p_packet = &ai_chunk[i_chunk * TS_SIZE];
+
+        if (!mux->p_current && (mux->i_heap > 0) && (mux->pp_heap[0]->i_due <= i_now))
+        {
+            carousel_t *carousel = heap_pop(mux);
+            if ((carousel->i_section == 0) && !mux_refresh(mux, carousel, i_now))
+                return false;
+            section_start(mux, carousel);
+        }
+
+        if (mux->p_current)
+        {
+            section_packet(mux, p_packet);
+            if (mux->i_packet >= mux->i_packet_end)
+            {
+                carousel_t *carousel = mux->p_current;
+                carousel->i_sent++;
+                carousel->i_due += carousel->i_period / (int64_t)carousel->i_sections;
+                if (++carousel->i_section >= carousel->i_sections)
+                {
+                    carousel->i_section = 0;
+                    carousel->i_cycles++;
+                }
+                mux->p_current = NULL;
+                heap_push(mux, carousel);
+            }
+        }
+        else
+            filler_packet(mux, p_packet, i_now);
+
+        if (++i_chunk == MUX_CHUNK)
+        {
+            if (params->b_realtime)
+                sleep_until(&start, i_now);
+            if (fwrite(ai_chunk, TS_SIZE, i_chunk, p_out) != i_chunk)
+            {
+                fprintf(stderr, "Error: write failed (%s)\n", strerror(errno));
+                return false;
+            }
+            i_chunk = 0;
+        }
+    }
+    if (i_chunk && (fwrite(ai_chunk, TS_SIZE, i_chunk, p_out) != i_chunk))
+    {
+        fprintf(stderr, "Error: write failed (%s)\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void mux_report(const mux_t *mux, uint64_t i_total)
+{
+    const params_t *params = mux->params;
+    double f_booked = 0.0;
+    size_t i_pmts = 0;
+    uint64_t i_pmt_sent = 0;
+
+    fprintf(stderr, "%-14s %6s %8s %8s %8s %7s %12s\n", "table", "pid", "sections",
+            "packets", "period", "cycles", "bit/s");
+    for (size_t i = 0; i < mux->i_carousels; i++)
+    {
+        const carousel_t *carousel = &mux->p_carousels[i];
+        double f_rate = (double)carousel->i_packets * TS_SIZE * 8 * 1e9 / carousel->i_period;
+        f_booked += f_rate;
+        if (strncmp(carousel->psz_name, "PMT ", 4) == 0)
+        {
+            /* one line for all PMTs */
+            i_pmts++;
+            i_pmt_sent += carousel->i_sent;
+            continue;
+        }
+        fprintf(stderr, "%-14s 0x%04x %8zu %8zu %6"PRId64"ms %7"PRIu64" %12.0f\n",
+                carousel->psz_name, carousel->i_pid, carousel->i_sections,
+                carousel->i_packets, carousel->i_period / 1000000,
+                carousel->i_cycles, f_rate);
+    }
+    fprintf(stderr, "%zu PMTs, %"PRIu64" sections sent\n", i_pmts, i_pmt_sent);
+    fprintf(stderr, "SI %.0f bit/s of %"PRIu64", %.1f%% filler packets\n", f_booked,
+            params->i_rate, i_total ? 100.0 * mux->i_filler / i_total : 0.0);
+    if (f_booked > (double)params->i_rate)
+        fprintf(stderr, "Warning: tables need more than the mux rate, "
+                        "repetition periods are not met\n");
+    if (params->i_cc_errors || params->i_crc_errors || params->i_truncated)
+        fprintf(stderr, "injected %"PRIu64" CC gaps, %"PRIu64" CRC errors, "
+                        "%"PRIu64" truncated sections\n",
+                mux->i_cc_errors, mux->i_crc_errors, mux->i_truncated);
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+static void usage(void)
+{
+    printf("Usage: gen_mux [-h] [-a] [-o <file>] [-s <seed>] [-n <services>] [-d <days>]\n");
+    printf("               [-b <bit/s>] [-t <seconds>] [-c <ms>] [-p <table>=<ms>] ...\n");
+    printf("\n");
+    printf(" -o | --output      : output file (default: stdout)\n");
+    printf(" -s | --seed        : random seed, same seed same stream (default: 1)\n");
+    printf(" -a | --atsc        : ATSC PSIP instead of DVB SI\n");
+    printf(" -n | --services    : number of services, 1 to %d (default: 16)\n", MAX_SERVICES);
+    printf(" -d | --days        : days of EIT schedule (default: 8)\n");
+    printf(" -x | --transports  : transport streams in the NIT and BAT (default: 32)\n");
+    printf(" -S | --start       : unix time of the first schedule day (default: 1420070400)\n");
+    printf(" -b | --bitrate     : mux rate in bit/s (default: 20000000)\n");
+    printf(" -t | --duration    : seconds of stream (default: 10)\n");
+    printf(" -c | --cues        : SCTE-35 splice_insert every n ms on the first service\n");
+    printf(" -p | --repeat      : repetition period of a table in ms, one of\n");
+    printf("                      ");
+    for (int i = 0; i < REPEAT_TABLES; i++)
+        printf("%s%s=%d", i ? ", " : "", repeats[i].psz_name, repeats[i].i_default);
+    printf("\n");
+    printf(" -r | --realtime    : write at the mux rate instead of as fast as possible\n");
+    printf("\nErrors, in per mille of sections:\n");
+    printf(" -C | --cc-errors   : continuity counter gaps\n");
+    printf(" -E | --crc-errors  : bad CRC_32\n");
+    printf(" -T | --truncated   : sections cut after their first packet\n");
+}
+
+static bool parse_repeat(params_t *params, const char *psz_arg)
+{
+    const char *psz_value = strchr(psz_arg, '=');
+    if (!psz_value)
+        return false;
+    for (int i = 0; i < REPEAT_TABLES; i++)
+    {
+        if ((strlen(repeats[i].psz_name) == (size_t)(psz_value - psz_arg)) &&
+            (strncmp(repeats[i].psz_name, psz_arg, psz_value - psz_arg) == 0))
+        {
+            int i_ms = atoi(psz_value + 1);
+            if (i_ms < 1)
+                return false;
+            params->ai_repeat[i] = i_ms;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int i_argc, char *pa_argv[])
+{
+    static const struct option long_options[] =
+    {
+        { "output",     required_argument, NULL, 'o' },
+        { "seed",       required_argument, NULL, 's' },
+        { "atsc",       no_argument,       NULL, 'a' },
+        { "services",   required_argument, NULL, 'n' },
+        { "days",       required_argument, NULL, 'd' },
+        { "transports", required_argument, NULL, 'x' },
+        { "start",      required_argument, NULL, 'S' },
+        { "bitrate",    required_argument, NULL, 'b' },
+        { "duration",   required_argument, NULL, 't' },
+        { "cues",       required_argument, NULL, 'c' },
+        { "repeat",     required_argument, NULL, 'p' },
+        { "realtime",   no_argument,       NULL, 'r' },
+        { "cc-errors",  required_argument, NULL, 'C' },
+        { "crc-errors", required_argument, NULL, 'E' },
+        { "truncated",  required_argument, NULL, 'T' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    params_t params =
+    {
+        .psz_output = NULL, .i_seed = 1, .b_atsc = false, .i_services = 16,
+        .i_days = 8, .i_transports = 32, .i_start = 1420070400, .i_rate = 20000000,
+        .f_duration = 10.0, .i_cue_period = 0,
+    };
+    for (int i = 0; i < REPEAT_TABLES; i++)
+        params.ai_repeat[i] = repeats[i].i_default;
+
+    int c;
+    while ((c = getopt_long(i_argc, pa_argv, "ab:c:C:d:E:ho:p:rs:S:t:T:n:x:",
+                            long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'o': params.psz_output = optarg; break;
+            case 's': params.i_seed = strtoull(optarg, NULL, 0); break;
+            case 'a': params.b_atsc = true; break;
+            case 'n': params.i_services = atoi(optarg); break;
+            case 'd': params.i_days = atoi(optarg); break;
+            case 'x': params.i_transports = atoi(optarg); break;
+            case 'S': params.i_start = strtoll(optarg, NULL, 0); break;
+            case 'b': params.i_rate = strtoull(optarg, NULL, 0); break;
+            case 't': params.f_duration = strtod(optarg, NULL); break;
+            case 'c': params.i_cue_period = atoi(optarg); break;
+            case 'r': params.b_realtime = true; break;
+            case 'C': params.i_cc_errors = atoi(optarg); break;
+            case 'E': params.i_crc_errors = atoi(optarg); break;
+            case 'T': params.i_truncated = atoi(optarg); break;
+            case 'p':
+                if (!parse_repeat(&params, optarg))
+                {
+                    fprintf(stderr, "Option --repeat has invalid content %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'h':
+                usage();
+                return 0;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if ((params.i_services < 1) || (params.i_services > MAX_SERVICES) ||
+        (params.i_days < 0) || (params.i_days > 8) ||
+        (params.i_transports < 1) || (params.i_transports > 255) ||
+        (params.i_rate < 100000) || (params.f_duration <= 0.0) ||
+        (params.i_cue_period < 0) ||
+        (params.i_cc_errors < 0) || (params.i_cc_errors > 1000) ||
+        (params.i_crc_errors < 0) || (params.i_crc_errors > 1000) ||
+        (params.i_truncated < 0) || (params.i_truncated > 1000))
+    {
+        fprintf(stderr, "Error: invalid arguments\n");
+        usage();
+        return 1;
+    }
+    /* schedule days start at midnight UTC */
+    params.i_start -= params.i_start % 86400;
+
+    mux_t mux;
+    memset(&mux, 0, sizeof(mux));
+    mux.params = &params;
+    mux.i_rng = params.i_seed ^ UINT64_C(0x9e3779b97f4a7c15);
+    mux.i_rng_errors = params.i_seed ^ UINT64_C(0xd1b54a32d192ed03);
+    if (!mux.i_rng) mux.i_rng = 1;
+    if (!mux.i_rng_errors) mux.i_rng_errors = 1;
+
+    /* PAT, PMTs, up to 8 DVB or 131 ATSC tables, the cue */
+    size_t i_max = 1 + params.i_services + 132 + 1;
+    mux.p_carousels = calloc(i_max, sizeof(carousel_t));
+    mux.pp_heap = calloc(i_max, sizeof(carousel_t *));
+    mux.pi_es = calloc(2 * params.i_services, sizeof(uint16_t));
+    mux.p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+
+    bool b_ok = mux.p_carousels && mux.pp_heap && mux.pi_es && mux.p_dvbpsi;
+    if (b_ok)
+        b_ok = build_psi(&mux);
+    if (b_ok)
+        b_ok = params.b_atsc ? build_atsc(&mux) : build_dvb(&mux);
+    if (b_ok && (params.i_cue_period > 0))
+    {
+        carousel_t *carousel = &mux.p_carousels[mux.i_carousels];
+        memset(carousel, 0, sizeof(carousel_t));
+        snprintf(carousel->psz_name, sizeof(carousel->psz_name), "SCTE-35");
+        carousel->i_pid = PID_CUE;
+        carousel->i_period = (int64_t)params.i_cue_period * 1000000;
+        carousel->pf_refresh = cue_refresh;
+        carousel->i_due = carousel->i_period; /* first cue after one period */
+        mux.i_carousels++;
+    }
+
+    FILE *p_out = stdout;
+    if (b_ok && params.psz_output)
+    {
+        p_out = fopen(params.psz_output, "wb");
+        if (!p_out)
+        {
+            fprintf(stderr, "Error: cannot open %s (%s)\n", params.psz_output, strerror(errno));
+            b_ok = false;
+        }
+    }
+
+    if (b_ok)
+    {
+        b_ok = mux_run(&mux, p_out);
+        mux_report(&mux, (uint64_t)(params.f_duration * params.i_rate / (TS_SIZE * 8)));
+    }
+    if (p_out && (p_out != stdout))
+        fclose(p_out);
+
+    for (size_t i = 0; i < mux.i_carousels; i++)
+    {
+        free(mux.p_carousels[i].p_packets);
+        free(mux.p_carousels[i].pi_section);
+    }
+    free(mux.p_carousels);
+    free(mux.pp_heap);
+    free(mux.pi_es);
+    if (mux.p_dvbpsi)
+        dvbpsi_delete(mux.p_dvbpsi);
+    return b_ok ? 0 : 1;
+}
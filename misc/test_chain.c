@@ -648,6 +648,256 @@ error:
 
 }
 
+/*****************************************************************************
+ * SECTION STORE TESTS
+ *****************************************************************************/
+static bool sections_sorted(dvbpsi_decoder_t *p_dec, const int count)
+{
+    int i = 0;
+    for (dvbpsi_psi_section_t *p = p_dec->p_sections; p; p = p->p_next, i++) {
+        if (p->i_number != i)
+            return false;
+    }
+    return (i == count);
+}
+
+static int run_section_store_test(void)
+{
+    dvbpsi_decoder_t *p_dec = dvbpsi_decoder_new(NULL, 1024, true, sizeof(dvbpsi_decoder_t));
+    if (p_dec == NULL)
+        return 1;
+    p_dec->i_last_section_number = 255;
+
+    /* Add all sections in a scrambled order, each one twice */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 256; i++) {
+            dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(1024);
+            if (p_section == NULL)
+                goto error;
+            p_section->i_number = (i * 167) & 0xff;
+            bool b_overwrite = dvbpsi_decoder_psi_section_add(p_dec, p_section);
+            if (b_overwrite != (pass == 1))
+                goto error;
+            if (dvbpsi_decoder_psi_sections_completed(p_dec) != ((pass == 1) || (i == 255)))
+                goto error;
+        }
+        if (!sections_sorted(p_dec, 256))
+            goto error;
+    }
+    TEST_PASSED("dvbpsi_decoder_psi_section_add");
+
+    /* A table with fewer sections completes without the trailing numbers */
+    dvbpsi_decoder_reset(p_dec, true);
+    if (p_dec->p_sections || dvbpsi_decoder_psi_sections_completed(p_dec))
+        goto error;
+    p_dec->i_last_section_number = 64;
+    for (int i = 64; i >= 0; i--) {
+        if (dvbpsi_decoder_psi_sections_completed(p_dec))
+            goto error;
+        dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(1024);
+        if (p_section == NULL)
+            goto error;
+        p_section->i_number = i;
+        dvbpsi_decoder_psi_section_add(p_dec, p_section);
+    }
+    if (!dvbpsi_decoder_psi_sections_completed(p_dec) || !sections_sorted(p_dec, 65))
+        goto error;
+    TEST_PASSED("dvbpsi_decoder_psi_sections_completed");
+
+    dvbpsi_decoder_delete(p_dec);
+    fprintf(stderr, "ALL SECTION STORE TESTS PASSED\n");
+    return 0;
+
+error:
+    TEST_FAILED("section store");
+    dvbpsi_decoder_delete(p_dec);
+    return 1;
+}
+
+/*****************************************************************************
+ * CHAIN BUDGET TESTS
+ *****************************************************************************/
+
+/* Push first section of a two section BAT, which never completes */
+static void push_incomplete_bat(dvbpsi_t *p_dvbpsi, uint16_t i_bouquet_id, uint8_t *p_cc,
+                                const bool b_bad_crc)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(1024);
+    assert(p_section);
+
+    p_section->i_table_id = 0x4a;
+    p_section->b_syntax_indicator = true;
+    p_section->b_private_indicator = false;
+    p_section->i_extension = i_bouquet_id;
+    p_section->i_version = 0;
+    p_section->b_current_next = true;
+    p_section->i_number = 0;
+    p_section->i_last_number = 1;
+    p_section->p_payload_start = p_section->p_data + 8;
+    p_section->p_payload_end += 8;
+    /* bouquet_descriptors_length and transport_stream_loop_length */
+    p_section->p_payload_end[0] = 0xf0;
+    p_section->p_payload_end[1] = 0x00;
+    p_section->p_payload_end[2] = 0xf0;
+    p_section->p_payload_end[3] = 0x00;
+    p_section->p_payload_end += 4;
+    p_section->i_length = 9 + 4;
+    dvbpsi_BuildPSISection(p_dvbpsi, p_section);
+
+    uint8_t pkt[188];
+    memset(pkt, 0xff, 188);
+    pkt[0] = 0x47;
+    pkt[1] = 0x40;
+    pkt[2] = 0x11;
+    pkt[3] = 0x10 | (*p_cc & 0x0f);
+    pkt[4] = 0x00; /* pointer_field */
+    memcpy(pkt + 5, p_section->p_data, p_section->p_payload_end - p_section->p_data + 4);
+    if (b_bad_crc)
+        pkt[5 + p_section->p_payload_end - p_section->p_data] ^= 0xff;
+    *p_cc = *p_cc + 1;
+
+    dvbpsi_packet_push(p_dvbpsi, pkt);
+    dvbpsi_DeletePSISections(p_section);
+}
+
+/* Leaves the BAT decoders attached while b_keep_subtables is set */
+static bool b_keep_subtables;
+static void KeepSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    if (!b_keep_subtables)
+        DelSubtable(p_dvbpsi, i_table_id, i_extension);
+}
+
+static int run_chain_budget_test(void)
+{
+    dvbpsi_budget_t budget;
+    uint8_t i_cc = 0;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    if (p_dvbpsi == NULL)
+        return 1;
+
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, DelSubtable, NULL))
+        goto error;
+
+    /* Subtable limit: each new bouquet evicts the oldest incomplete one */
+    dvbpsi_budget_set(p_dvbpsi, 0, 4);
+    for (int i = 0; i < 10; i++)
+        push_incomplete_bat(p_dvbpsi, i, &i_cc, false);
+
+    dvbpsi_budget_get(p_dvbpsi, &budget);
+    if ((budget.i_subtables != 4) || (budget.i_evictions != 6) ||
+        dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 5) ||
+        !dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 9)) {
+        TEST_FAILED("dvbpsi_budget_set subtables");
+        goto error;
+    }
+    TEST_PASSED("dvbpsi_budget_set subtables");
+
+    /* Byte limit: room for the sections of two subtables only */
+    dvbpsi_budget_set(p_dvbpsi, 2 * (sizeof(dvbpsi_psi_section_t) + 4096), 0);
+    for (int i = 10; i < 14; i++)
+        push_incomplete_bat(p_dvbpsi, i, &i_cc, false);
+
+    dvbpsi_budget_get(p_dvbpsi, &budget);
+    if ((budget.i_bytes > budget.i_max_bytes) || (budget.i_evictions < 6 + 2 + 2)) {
+        TEST_FAILED("dvbpsi_budget_set bytes");
+        goto error;
+    }
+    TEST_PASSED("dvbpsi_budget_set bytes");
+
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        goto error;
+
+    dvbpsi_budget_get(p_dvbpsi, &budget);
+    if ((budget.i_bytes != 0) || (budget.i_subtables != 0)) {
+        TEST_FAILED("dvbpsi_budget_get after dvbpsi_chain_demux_delete");
+        p_dvbpsi->p_decoder = NULL;
+        dvbpsi_delete(p_dvbpsi);
+        return 1;
+    }
+
+    /* Subtable limit with a pf_del callback which does not detach: the new
+     * subtables are refused */
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, KeepSubtable, NULL))
+        goto error;
+    const uint64_t i_evictions = budget.i_evictions;
+    b_keep_subtables = true;
+    dvbpsi_budget_set(p_dvbpsi, 0, 2);
+    for (int i = 0; i < 4; i++)
+        push_incomplete_bat(p_dvbpsi, i, &i_cc, false);
+    b_keep_subtables = false;
+
+    dvbpsi_budget_get(p_dvbpsi, &budget);
+    if ((budget.i_subtables != 2) || (budget.i_evictions != i_evictions) ||
+        !dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 1) ||
+        dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 3)) {
+        TEST_FAILED("dvbpsi_budget_set subtables with pf_del not detaching");
+        goto error;
+    }
+    TEST_PASSED("dvbpsi_budget_set subtables with pf_del not detaching");
+
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        goto error;
+
+    dvbpsi_delete(p_dvbpsi);
+    fprintf(stderr, "ALL CHAIN BUDGET TESTS PASSED\n");
+    return 0;
+
+error:
+    /* cleanup */
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        fprintf(stderr, "Failed to cleanup chain_demux after errors\n");
+    p_dvbpsi->p_decoder = NULL;
+    dvbpsi_delete(p_dvbpsi);
+    return 1;
+}
+
+/*****************************************************************************
+ * CHAIN ERROR COUNTER TESTS
+ *****************************************************************************/
+static int run_chain_errors_test(void)
+{
+    dvbpsi_errors_t errors;
+    uint8_t i_cc = 0;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_NONE);
+    if (p_dvbpsi == NULL)
+        return 1;
+
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, DelSubtable, NULL))
+        goto error;
+
+    push_incomplete_bat(p_dvbpsi, 1, &i_cc, false);
+    push_incomplete_bat(p_dvbpsi, 2, &i_cc, true);
+    i_cc++; /* skip one */
+    push_incomplete_bat(p_dvbpsi, 3, &i_cc, false);
+
+    dvbpsi_errors_get(p_dvbpsi, &errors);
+    if ((errors.i_crc_errors != 1) || (errors.i_cc_errors != 1) ||
+        (errors.i_length_errors != 0) ||
+        dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 2) ||
+        !dvbpsi_decoder_chain_get(p_dvbpsi, 0x4a, 3)) {
+        TEST_FAILED("dvbpsi_errors_get");
+        goto error;
+    }
+    TEST_PASSED("dvbpsi_errors_get");
+
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        goto error;
+    dvbpsi_delete(p_dvbpsi);
+    fprintf(stderr, "ALL CHAIN ERROR TESTS PASSED\n");
+    return 0;
+
+error:
+    /* cleanup */
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        fprintf(stderr, "Failed to cleanup chain_demux after errors\n");
+    p_dvbpsi->p_decoder = NULL;
+    dvbpsi_delete(p_dvbpsi);
+    return 1;
+}
+
 /*****************************************************************************
  * main
  *****************************************************************************/
@@ -658,6 +908,12 @@ int main(int i_argc, char* pa_argv[])
         return 1;
     if (run_chain_demux_test() < 0)
         return 1;
+    if (run_section_store_test() != 0)
+        return 1;
+    if (run_chain_budget_test() != 0)
+        return 1;
+    if (run_chain_errors_test() != 0)
+        return 1;
 
     return 0;
 }
@@ -0,0 +1,559 @@
+/*****************************************************************************
+ * test_epg.c: event schedule built from DVB EIT and ATSC EIT/ETT
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/descriptor.h"
+#include "../src/tables/eit.h"
+#include "../src/tables/atsc_eit.h"
+#include "../src/tables/atsc_ett.h"
+#include "../src/epg.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/eit.h>
+#include <dvbpsi/atsc_eit.h>
+#include <dvbpsi/atsc_ett.h>
+#include <dvbpsi/epg.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+/* 2015-01-01 00:00:00 UTC, MJD 57023 */
+#define T0              INT64_C(1420070400)
+#define T0_MJD          57023
+#define GPS_EPOCH       INT64_C(315964800)
+#define GPS_UTC_OFFSET  16
+
+#define NETWORK_ID      3
+#define TS_ID           2
+#define SERVICE_ID      7
+#define SOURCE_ID       5
+
+#define MAX_EVENTS      8
+
+/*****************************************************************************
+ * DVB EIT steps
+ *****************************************************************************
+ * Times are minutes after T0. Event lists end with a 0 duration, schedules
+ * with a 0 table_id. Every EIT also carries an NVOD reference event, which
+ * the EPG leaves out.
+ *****************************************************************************/
+typedef struct
+{
+    uint16_t    i_event_id;
+    int         i_start;
+    int         i_duration;
+} epg_spec_t;
+
+typedef struct
+{
+    uint16_t    i_event_id;
+    int         i_start;
+    uint8_t     i_table_id;
+} epg_entry_t;
+
+typedef struct
+{
+    const char *psz_name;
+    uint8_t     i_table_id;
+    uint8_t     i_version;
+    int         i_segment;      /* -1 for a whole sub-table */
+    epg_spec_t  events[4];
+    epg_entry_t schedule[MAX_EVENTS];   /* whole schedule afterwards */
+} epg_dvb_step_t;
+
+static const epg_dvb_step_t dvb_steps[] =
+{
+    { "schedule events sorted by start time", 0x50, 1, -1,
+      { { 3, 120, 60 }, { 1, 0, 60 }, { 2, 60, 60 } },
+      { { 1, 0, 0x50 }, { 2, 60, 0x50 }, { 3, 120, 0x50 } } },
+    { "present/following hides the schedule event", 0x4e, 5, -1,
+      { { 2, 70, 60 } },
+      { { 1, 0, 0x50 }, { 2, 70, 0x4e }, { 3, 120, 0x50 } } },
+    { "same version is ignored", 0x50, 1, -1,
+      { { 5, 600, 10 } },
+      { { 1, 0, 0x50 }, { 2, 70, 0x4e }, { 3, 120, 0x50 } } },
+    { "new version replaces the sub-table", 0x50, 2, -1,
+      { { 4, 300, 30 } },
+      { { 2, 70, 0x4e }, { 4, 300, 0x50 } } },
+    { "segment merged with the other tables", 0x51, 1, 0,
+      { { 10, 360, 60 } },
+      { { 2, 70, 0x4e }, { 4, 300, 0x50 }, { 10, 360, 0x51 } } },
+    { "second segment merged", 0x51, 1, 1,
+      { { 11, 540, 60 } },
+      { { 2, 70, 0x4e }, { 4, 300, 0x50 }, { 10, 360, 0x51 }, { 11, 540, 0x51 } } },
+    { "new version replaces one segment", 0x51, 2, 1,
+      { { 12, 570, 60 } },
+      { { 2, 70, 0x4e }, { 4, 300, 0x50 }, { 10, 360, 0x51 }, { 12, 570, 0x51 } } },
+    { "new present/following hides another event", 0x4e, 6, -1,
+      { { 4, 300, 30 } },
+      { { 4, 300, 0x4e }, { 10, 360, 0x51 }, { 12, 570, 0x51 } } },
+    { "whole sub-table replaces its segments", 0x51, 3, -1,
+      { { 13, 420, 30 } },
+      { { 4, 300, 0x4e }, { 13, 420, 0x51 } } },
+};
+
+/* Queries on the schedule left by dvb_steps, -1 for no event */
+typedef struct
+{
+    const char *psz_name;
+    int         i_time;
+    int         i_now;
+    int         i_next;
+} epg_now_next_t;
+
+static const epg_now_next_t now_next_cases[] =
+{
+    { "now/next before the first event",   0,   -1, 4 },
+    { "now/next during an event",          310, 4,  13 },
+    { "now/next at the end of an event",   330, -1, 13 },
+    { "now/next between two events",       400, -1, 13 },
+    { "now/next during the last event",    430, 13, -1 },
+    { "now/next after the last event",     500, -1, -1 },
+};
+
+typedef struct
+{
+    const char *psz_name;
+    int         i_from;
+    int         i_to;
+    uint16_t    ai_events[MAX_EVENTS];
+    size_t      i_events;
+} epg_range_t;
+
+static const epg_range_t range_cases[] =
+{
+    { "range of the whole day",             0,   1440, { 4, 13 }, 2 },
+    { "range between two events",           330, 420,  { 0 },     0 },
+    { "range overlapping two events",       329, 421,  { 4, 13 }, 2 },
+    { "range inside an event",              425, 426,  { 13 },    1 },
+};
+
+static uint8_t to_bcd(const int i_value)
+{
+    return ((i_value / 10) << 4) | (i_value % 10);
+}
+
+/* MJD and UTC of ETSI EN 300 468 annex C */
+static uint64_t dvb_time(const int i_minutes)
+{
+    const int i_day = i_minutes / 1440;
+    const int i_hour = (i_minutes % 1440) / 60;
+    return ((uint64_t)(T0_MJD + i_day) << 24) | ((uint64_t)to_bcd(i_hour) << 16)
+           | ((uint64_t)to_bcd(i_minutes % 60) << 8);
+}
+
+static uint32_t dvb_duration(const int i_minutes)
+{
+    return ((uint32_t)to_bcd(i_minutes / 60) << 16) | ((uint32_t)to_bcd(i_minutes % 60) << 8);
+}
+
+static void event_title(const uint16_t i_event_id, char *psz_title, const size_t i_size)
+{
+    snprintf(psz_title, i_size, "event %u", i_event_id);
+}
+
+static dvbpsi_eit_t *build_eit(const epg_dvb_step_t *p_step)
+{
+    const uint8_t i_last_section = p_step->i_segment < 0 ? 0 : 8 * p_step->i_segment;
+    dvbpsi_eit_t *p_eit = dvbpsi_eit_new(p_step->i_table_id, SERVICE_ID, p_step->i_version,
+                                         true, TS_ID, NETWORK_ID, i_last_section,
+                                         p_step->i_table_id);
+    if (p_eit == NULL)
+        return NULL;
+
+    for (int i = 0; p_step->events[i].i_duration; i++)
+    {
+        const epg_spec_t *p_spec = &p_step->events[i];
+        dvbpsi_eit_event_t *p_event = dvbpsi_eit_event_add(p_eit, p_spec->i_event_id,
+                                            dvb_time(p_spec->i_start),
+                                            dvb_duration(p_spec->i_duration), 4, false, 0);
+        if (p_event == NULL)
+            continue;
+
+        /* short event descriptor: language, event_name and text */
+        uint8_t data[32];
+        char psz_title[16];
+        event_title(p_spec->i_event_id, psz_title, sizeof(psz_title));
+        const size_t i_title = strlen(psz_title);
+        memcpy(data, "eng", 3);
+        data[3] = i_title;
+        memcpy(&data[4], psz_title, i_title);
+        data[4 + i_title] = 4;
+        memcpy(&data[5 + i_title], "text", 4);
+        dvbpsi_eit_event_descriptor_add(p_event, 0x4d, 9 + i_title, data);
+    }
+    dvbpsi_eit_nvod_event_add(p_eit, 0x3fff, dvb_duration(10), false, 0);
+    return p_eit;
+}
+
+static bool check_title(const dvbpsi_epg_event_t *p_event)
+{
+    char psz_title[16];
+    event_title(p_event->i_event_id, psz_title, sizeof(psz_title));
+    return (p_event->i_title_length == strlen(psz_title)) &&
+           !memcmp(p_event->p_title, psz_title, p_event->i_title_length) &&
+           (p_event->i_text_length == 4) && !memcmp(p_event->p_text, "text", 4) &&
+           !memcmp(p_event->i_language, "eng", 3) && (p_event->i_running_status == 4);
+}
+
+static bool check_schedule(dvbpsi_epg_service_t *p_service, const epg_entry_t *p_schedule)
+{
+    const dvbpsi_epg_event_t *pp_events[MAX_EVENTS];
+    size_t i_expected = 0;
+
+    while ((i_expected < MAX_EVENTS) && p_schedule[i_expected].i_table_id)
+        i_expected++;
+
+    const size_t i_events = dvbpsi_epg_range(p_service, INT64_MIN / 2, INT64_MAX / 2,
+                                             pp_events, MAX_EVENTS);
+    if (i_events != i_expected)
+    {
+        fprintf(stderr, "%zu events, %zu expected\n", i_events, i_expected);
+        return false;
+    }
+    for (size_t i = 0; i < i_events; i++)
+    {
+        const dvbpsi_epg_event_t *p_event = pp_events[i];
+        if ((p_event->i_event_id != p_schedule[i].i_event_id) ||
+            (p_event->i_start != T0 + 60 * p_schedule[i].i_start) ||
+            (p_event->i_table_id != p_schedule[i].i_table_id) || !check_title(p_event))
+        {
+            fprintf(stderr, "event %zu: id %u, start %"PRId64", table 0x%02x\n", i,
+                    p_event->i_event_id, p_event->i_start - T0, p_event->i_table_id);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_event(const dvbpsi_epg_event_t *p_event, const int i_event_id)
+{
+    if (i_event_id < 0)
+        return p_event == NULL;
+    return (p_event != NULL) && (p_event->i_event_id == i_event_id);
+}
+
+/*****************************************************************************
+ * run_epg_dvb_test
+ *****************************************************************************/
+static int run_epg_dvb_test(void)
+{
+    dvbpsi_epg_service_t *p_service = NULL;
+    int i_ret = 1;
+
+    dvbpsi_epg_t *p_epg = dvbpsi_epg_new();
+    if (p_epg == NULL)
+        return 1;
+
+    const int i_steps = sizeof(dvb_steps) / sizeof(dvb_steps[0]);
+    for (int i = 0; i < i_steps; i++)
+    {
+        const epg_dvb_step_t *p_step = &dvb_steps[i];
+        dvbpsi_eit_t *p_eit = build_eit(p_step);
+        bool b_added = false;
+
+        if (p_eit && (p_step->i_segment < 0))
+            b_added = dvbpsi_epg_eit_add(p_epg, p_eit);
+        else if (p_eit)
+            b_added = dvbpsi_epg_eit_segment_add(p_epg, p_eit, p_step->i_segment);
+
+        if (p_service == NULL)
+            p_service = dvbpsi_epg_service_find(p_epg, NETWORK_ID, TS_ID, SERVICE_ID);
+        if (!b_added || (p_service == NULL) || !check_schedule(p_service, p_step->schedule))
+        {
+            TEST_FAILED(p_step->psz_name);
+            goto out;
+        }
+        TEST_PASSED(p_step->psz_name);
+    }
+
+    if ((dvbpsi_epg_service_find(p_epg, NETWORK_ID, TS_ID, SERVICE_ID + 1) != NULL) ||
+        (dvbpsi_epg_service_find(p_epg, NETWORK_ID + 1, TS_ID, SERVICE_ID) != NULL) ||
+        (dvbpsi_epg_atsc_service_find(p_epg, SERVICE_ID) != NULL))
+    {
+        TEST_FAILED("dvbpsi_epg_service_find of unknown services");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_epg_service_find of unknown services");
+
+    const int i_now_next = sizeof(now_next_cases) / sizeof(now_next_cases[0]);
+    for (int i = 0; i < i_now_next; i++)
+    {
+        const epg_now_next_t *p_case = &now_next_cases[i];
+        const dvbpsi_epg_event_t *p_now = NULL, *p_next = NULL;
+
+        const bool b_found = dvbpsi_epg_now_next(p_service, T0 + 60 * p_case->i_time,
+                                                 &p_now, &p_next);
+        if ((b_found != ((p_case->i_now >= 0) || (p_case->i_next >= 0))) ||
+            !check_event(p_now, p_case->i_now) || !check_event(p_next, p_case->i_next))
+        {
+            TEST_FAILED(p_case->psz_name);
+            goto out;
+        }
+        TEST_PASSED(p_case->psz_name);
+    }
+
+    const int i_ranges = sizeof(range_cases) / sizeof(range_cases[0]);
+    for (int i = 0; i < i_ranges; i++)
+    {
+        const epg_range_t *p_case = &range_cases[i];
+        const dvbpsi_epg_event_t *pp_events[MAX_EVENTS];
+
+        size_t i_events = dvbpsi_epg_range(p_service, T0 + 60 * p_case->i_from,
+                                           T0 + 60 * p_case->i_to, pp_events, MAX_EVENTS);
+        bool b_ok = (i_events == p_case->i_events);
+        for (size_t j = 0; b_ok && (j < i_events); j++)
+            b_ok = (pp_events[j]->i_event_id == p_case->ai_events[j]);
+        /* with a smaller array, the count is the same */
+        if (b_ok && (i_events > 1))
+            b_ok = (dvbpsi_epg_range(p_service, T0 + 60 * p_case->i_from,
+                                     T0 + 60 * p_case->i_to, pp_events, 1) == i_events) &&
+                   (pp_events[0]->i_event_id == p_case->ai_events[0]);
+        if (!b_ok)
+        {
+            TEST_FAILED(p_case->psz_name);
+            goto out;
+        }
+        TEST_PASSED(p_case->psz_name);
+    }
+
+    i_ret = 0;
+out:
+    dvbpsi_epg_delete(p_epg);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * run_epg_search_test
+ *****************************************************************************
+ * A day of 10 minute slots holding 7 minute events, checked minute by minute
+ * against the slot arithmetic.
+ *****************************************************************************/
+#define SLOTS 144
+
+static int run_epg_search_test(void)
+{
+    int i_ret = 1;
+
+    dvbpsi_epg_t *p_epg = dvbpsi_epg_new();
+    dvbpsi_eit_t *p_eit = dvbpsi_eit_new(0x50, SERVICE_ID, 0, true, TS_ID, NETWORK_ID, 0, 0x50);
+    if ((p_epg == NULL) || (p_eit == NULL))
+    {
+        dvbpsi_eit_delete(p_eit);
+        goto out;
+    }
+    /* added in reverse order */
+    for (int i = SLOTS - 1; i >= 0; i--)
+        dvbpsi_eit_event_add(p_eit, 100 + i, dvb_time(10 * i), dvb_duration(7), 4, false, 0);
+    if (!dvbpsi_epg_eit_add(p_epg, p_eit))
+        goto out;
+    dvbpsi_epg_service_t *p_service = dvbpsi_epg_service_find(p_epg, NETWORK_ID, TS_ID,
+                                                              SERVICE_ID);
+    if (p_service == NULL)
+        goto out;
+
+    for (int m = 0; m < 10 * SLOTS; m++)
+    {
+        const dvbpsi_epg_event_t *p_now, *p_next, *pp_events[2];
+        const int i_slot = m / 10;
+        const int i_now = (m % 10) < 7 ? 100 + i_slot : -1;
+        const int i_next = i_slot + 1 < SLOTS ? 100 + i_slot + 1 : -1;
+
+        dvbpsi_epg_now_next(p_service, T0 + 60 * m, &p_now, &p_next);
+        const size_t i_events = dvbpsi_epg_range(p_service, T0 + 60 * m, T0 + 60 * m + 60,
+                                                 pp_events, 2);
+        if (!check_event(p_now, i_now) || !check_event(p_next, i_next) ||
+            (i_events != (i_now < 0 ? 0 : 1)) ||
+            ((i_events == 1) && (pp_events[0]->i_event_id != i_now)))
+        {
+            fprintf(stderr, "minute %d\n", m);
+            TEST_FAILED("now/next and range searches");
+            goto out;
+        }
+    }
+    TEST_PASSED("now/next and range searches");
+    i_ret = 0;
+
+out:
+    dvbpsi_epg_delete(p_epg);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * ATSC steps
+ *****************************************************************************
+ * The EIT holds events 33 and 34, the ETTs carry event or channel texts.
+ * NULL texts are expected absent, the events before the first EIT.
+ *****************************************************************************/
+typedef enum
+{
+    ATSC_EIT,
+    ATSC_EVENT_ETT,
+    ATSC_CHANNEL_ETT,
+} epg_atsc_op_t;
+
+typedef struct
+{
+    const char    *psz_name;
+    epg_atsc_op_t  i_op;
+    uint16_t       i_event_id;
+    uint8_t        i_version;
+    const char    *psz_text;
+    const char    *psz_text33;  /* texts expected afterwards */
+    const char    *psz_text34;
+} epg_atsc_step_t;
+
+static const epg_atsc_step_t atsc_steps[] =
+{
+    { "ATSC ETT before its event",      ATSC_EVENT_ETT,   33, 0, "first",   NULL,    NULL },
+    { "ATSC EIT joins the ETT",         ATSC_EIT,         0,  0, NULL,      "first", NULL },
+    { "ATSC ETT after its event",       ATSC_EVENT_ETT,   34, 0, "second",  "first", "second" },
+    { "ATSC channel ETT is ignored",    ATSC_CHANNEL_ETT, 0,  0, "channel", "first", "second" },
+    { "ATSC ETT same version ignored",  ATSC_EVENT_ETT,   33, 0, "ignored", "first", "second" },
+    { "ATSC ETT new version",           ATSC_EVENT_ETT,   33, 1, "third",   "third", "second" },
+    { "ATSC EIT new version keeps ETT", ATSC_EIT,         0,  1, NULL,      "third", "second" },
+};
+
+static bool add_atsc_step(dvbpsi_epg_t *p_epg, const epg_atsc_step_t *p_step)
+{
+    if (p_step->i_op == ATSC_EIT)
+    {
+        dvbpsi_atsc_eit_t *p_eit = dvbpsi_atsc_eit_new(0xcb, SOURCE_ID, p_step->i_version,
+                                                       0, SOURCE_ID, true);
+        if (p_eit == NULL)
+            return false;
+        /* GPS seconds, 1000 s after the GPS epoch in UTC */
+        dvbpsi_atsc_eit_event_add(p_eit, 33, 1000 + GPS_UTC_OFFSET, 1, 600,
+                                  5, (uint8_t *)"title");
+        dvbpsi_atsc_eit_event_add(p_eit, 34, 1600 + GPS_UTC_OFFSET, 1, 600,
+                                  2, (uint8_t *)"t2");
+        return dvbpsi_epg_atsc_eit_add(p_epg, p_eit, 0);
+    }
+
+    /* ETM_id: source_id, event_id and 0x2 for an event, 0x0 for a channel */
+    const uint32_t i_etm_id = ((uint32_t)SOURCE_ID << 16) |
+                              (p_step->i_op == ATSC_EVENT_ETT ?
+                               ((uint32_t)p_step->i_event_id << 2) | 0x2 : 0);
+    dvbpsi_atsc_ett_t *p_ett = dvbpsi_atsc_ett_new(0xcc, 0, p_step->i_version, 0,
+                                                   i_etm_id, true);
+    if (p_ett == NULL)
+        return false;
+    p_ett->i_etm_length = strlen(p_step->psz_text);
+    p_ett->p_etm_data = malloc(p_ett->i_etm_length);
+    if (p_ett->p_etm_data)
+        memcpy(p_ett->p_etm_data, p_step->psz_text, p_ett->i_etm_length);
+    return dvbpsi_epg_atsc_ett_add(p_epg, p_ett);
+}
+
+static bool check_text(const dvbpsi_epg_event_t *p_event, const char *psz_text)
+{
+    if (psz_text == NULL)
+        return p_event->p_text == NULL;
+    return (p_event->i_text_length == strlen(psz_text)) &&
+           !memcmp(p_event->p_text, psz_text, p_event->i_text_length);
+}
+
+/*****************************************************************************
+ * run_epg_atsc_test
+ *****************************************************************************/
+static int run_epg_atsc_test(void)
+{
+    bool b_events = false;
+    int i_ret = 1;
+
+    dvbpsi_epg_t *p_epg = dvbpsi_epg_new();
+    if (p_epg == NULL)
+        return 1;
+    dvbpsi_epg_gps_utc_offset_set(p_epg, GPS_UTC_OFFSET);
+
+    const int i_steps = sizeof(atsc_steps) / sizeof(atsc_steps[0]);
+    for (int i = 0; i < i_steps; i++)
+    {
+        const epg_atsc_step_t *p_step = &atsc_steps[i];
+        const dvbpsi_epg_event_t *p_now = NULL, *p_next = NULL;
+        bool b_ok = add_atsc_step(p_epg, p_step);
+
+        b_events |= (p_step->i_op == ATSC_EIT);
+        dvbpsi_epg_service_t *p_service = dvbpsi_epg_atsc_service_find(p_epg, SOURCE_ID);
+        if (b_ok && (p_service == NULL))
+            b_ok = false;
+        else if (b_ok)
+            dvbpsi_epg_now_next(p_service, GPS_EPOCH + 1005, &p_now, &p_next);
+
+        if (b_ok && b_events)
+            b_ok = check_event(p_now, 33) && check_event(p_next, 34) &&
+                   (p_now->i_start == GPS_EPOCH + 1000) && (p_now->i_duration == 600) &&
+                   (p_now->i_title_length == 5) && !memcmp(p_now->p_title, "title", 5) &&
+                   check_text(p_now, p_step->psz_text33) &&
+                   check_text(p_next, p_step->psz_text34);
+        else if (b_ok)
+            b_ok = (p_now == NULL) && (p_next == NULL);
+        if (!b_ok)
+        {
+            TEST_FAILED(p_step->psz_name);
+            goto out;
+        }
+        TEST_PASSED(p_step->psz_name);
+    }
+
+    i_ret = 0;
+out:
+    dvbpsi_epg_delete(p_epg);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_epg_dvb_test() != 0)
+        return 1;
+    if (run_epg_search_test() != 0)
+        return 1;
+    if (run_epg_atsc_test() != 0)
+        return 1;
+
+    fprintf(stderr, "ALL EPG TESTS PASSED\n");
+    return 0;
+}
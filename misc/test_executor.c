@@ -0,0 +1,324 @@
+/*****************************************************************************
+ * test_executor.c: streams on a pool of worker threads
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/executor.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/executor.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+#define WORKERS     4
+#define STREAMS     16
+#define ROUNDS      300
+#define MAX_BATCH   8
+#define POST_EVERY  16
+
+/* Packets carry their stream and sequence number, the push callback checks
+ * both and counts the workers running the stream at the same time */
+typedef struct
+{
+    dvbpsi_executor_t *p_executor;
+    unsigned int       i_stream;
+    uint32_t           i_next;          /* next sequence number expected */
+    uint32_t           i_sent;          /* sequence numbers submitted */
+    unsigned int       i_running;       /* workers pushing this stream */
+    unsigned int       i_overlaps;
+    unsigned int       i_misordered;
+    unsigned int       i_posted;        /* completions, posted by the workers */
+    uint32_t           i_last_completed;
+    unsigned int       i_completed;     /* and run on the main thread */
+    unsigned int       i_misordered_completions;
+} test_stream_t;
+
+/* Completion posted every POST_EVERY packets */
+typedef struct
+{
+    test_stream_t *p_stream;
+    uint32_t       i_sequence;
+} test_completion_t;
+
+static pthread_t main_thread;
+static unsigned int i_foreign_completions;
+
+static uint32_t test_rand_state = 1;
+static unsigned int test_rand(void)
+{
+    test_rand_state = test_rand_state * 1103515245 + 12345;
+    return (test_rand_state >> 16) & 0x7fff;
+}
+
+static void Complete(void *p_data)
+{
+    test_completion_t *p_completion = (test_completion_t *)p_data;
+    test_stream_t *p_stream = p_completion->p_stream;
+
+    if (!pthread_equal(pthread_self(), main_thread))
+        i_foreign_completions++;
+    /* posted by one worker at a time, so in sequence order */
+    if (p_stream->i_completed && (p_completion->i_sequence <= p_stream->i_last_completed))
+        p_stream->i_misordered_completions++;
+    p_stream->i_last_completed = p_completion->i_sequence;
+    p_stream->i_completed++;
+    free(p_completion);
+}
+
+static void Push(void *p_stream_data, const uint8_t *p_packets, size_t i_packets)
+{
+    test_stream_t *p_stream = (test_stream_t *)p_stream_data;
+
+    if (__atomic_add_fetch(&p_stream->i_running, 1, __ATOMIC_ACQ_REL) != 1)
+        __atomic_add_fetch(&p_stream->i_overlaps, 1, __ATOMIC_RELAXED);
+
+    for (size_t i = 0; i < i_packets; i++)
+    {
+        const uint8_t *p = &p_packets[188 * i];
+        const uint32_t i_sequence = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) |
+                                    ((uint32_t)p[6] << 8) | p[7];
+        if ((p[0] != 0x47) || (p[8] != p_stream->i_stream) ||
+            (i_sequence != p_stream->i_next))
+            p_stream->i_misordered++;
+        p_stream->i_next = i_sequence + 1;
+
+        if ((i_sequence % POST_EVERY) == 0)
+        {
+            test_completion_t *p_completion = malloc(sizeof(test_completion_t));
+            if (p_completion)
+            {
+                p_completion->p_stream = p_stream;
+                p_completion->i_sequence = i_sequence;
+                if (dvbpsi_executor_post(p_stream->p_executor, Complete, p_completion))
+                    p_stream->i_posted++;
+                else
+                    free(p_completion);
+            }
+        }
+    }
+
+    /* widen the window in which another worker could pick the stream up */
+    sched_yield();
+    __atomic_sub_fetch(&p_stream->i_running, 1, __ATOMIC_ACQ_REL);
+}
+
+/* Submit one batch of random size to every stream */
+static bool submit_round(dvbpsi_executor_t *p_executor, test_stream_t *p_streams,
+                         const int *pi_ids)
+{
+    static uint8_t packets[STREAMS][MAX_BATCH][188];
+    dvbpsi_executor_batch_t batches[STREAMS];
+
+    for (int s = 0; s < STREAMS; s++)
+    {
+        const size_t i_count = 1 + test_rand() % MAX_BATCH;
+        for (size_t i = 0; i < i_count; i++)
+        {
+            uint8_t *p = packets[s][i];
+            const uint32_t i_sequence = p_streams[s].i_sent++;
+
+            memset(p, 0xff, 188);
+            p[0] = 0x47;
+            p[1] = 0x1f;
+            p[2] = 0xff;
+            p[3] = 0x10;
+            p[4] = i_sequence >> 24;
+            p[5] = i_sequence >> 16;
+            p[6] = i_sequence >> 8;
+            p[7] = i_sequence;
+            p[8] = s;
+        }
+        batches[s].i_stream = pi_ids[s];
+        batches[s].p_packets = &packets[s][0][0];
+        batches[s].i_packets = i_count;
+    }
+    /* the packets are copied, the buffer is reused for the next round */
+    return dvbpsi_executor_submit(p_executor, batches, STREAMS);
+}
+
+static bool check_streams(const test_stream_t *p_streams, const bool b_drained)
+{
+    bool b_ok = true;
+
+    for (int s = 0; s < STREAMS; s++)
+    {
+        const test_stream_t *p_stream = &p_streams[s];
+        if ((p_stream->i_overlaps != 0) || (p_stream->i_misordered != 0) ||
+            (p_stream->i_next != p_stream->i_sent) ||
+            (p_stream->i_misordered_completions != 0) ||
+            (b_drained && (p_stream->i_completed != p_stream->i_posted)))
+        {
+            fprintf(stderr, "stream %d: %u overlaps, %u misordered, %u of %u packets, "
+                    "%u of %u completions\n", s, p_stream->i_overlaps,
+                    p_stream->i_misordered, p_stream->i_next, p_stream->i_sent,
+                    p_stream->i_completed, p_stream->i_posted);
+            b_ok = false;
+        }
+    }
+    return b_ok;
+}
+
+/*****************************************************************************
+ * EXECUTOR TESTS
+ *****************************************************************************/
+static int run_executor_test(void)
+{
+    test_stream_t streams[STREAMS];
+    int ai_ids[STREAMS];
+    int i_ret = 1;
+
+    main_thread = pthread_self();
+    memset(streams, 0, sizeof(streams));
+    dvbpsi_executor_t *p_executor = dvbpsi_executor_new(WORKERS, STREAMS);
+    if (p_executor == NULL)
+    {
+        TEST_FAILED("dvbpsi_executor_new");
+        return 1;
+    }
+
+    for (int s = 0; s < STREAMS; s++)
+    {
+        streams[s].p_executor = p_executor;
+        streams[s].i_stream = s;
+        ai_ids[s] = dvbpsi_executor_stream_add(p_executor, Push, &streams[s]);
+        if (ai_ids[s] < 0)
+        {
+            TEST_FAILED("dvbpsi_executor_stream_add");
+            goto out;
+        }
+    }
+    const uint8_t null_packet[188] = { 0x47, 0x1f, 0xff, 0x10 };
+    const dvbpsi_executor_batch_t unknown = { STREAMS, null_packet, 1 };
+    if ((dvbpsi_executor_stream_add(p_executor, Push, &streams[0]) != -1) ||
+        dvbpsi_executor_submit(p_executor, &unknown, 1))
+    {
+        TEST_FAILED("dvbpsi_executor_stream_add beyond i_max_streams");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_executor_stream_add");
+
+    /* A known stream before an unknown one: nothing is queued, stream 1
+     * would count the null packet as misordered */
+    const dvbpsi_executor_batch_t mixed[2] = { { ai_ids[1], null_packet, 1 },
+                                               { STREAMS, null_packet, 1 } };
+    if (dvbpsi_executor_submit(p_executor, mixed, 2))
+    {
+        TEST_FAILED("dvbpsi_executor_submit with an unknown stream");
+        goto out;
+    }
+    dvbpsi_executor_wait(p_executor);
+    if (!check_streams(streams, false))
+    {
+        TEST_FAILED("dvbpsi_executor_submit with an unknown stream");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_executor_submit with an unknown stream");
+
+    /* Submit, wait, then drain on this thread */
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        if (!submit_round(p_executor, streams, ai_ids))
+        {
+            TEST_FAILED("dvbpsi_executor_submit");
+            goto out;
+        }
+    }
+    dvbpsi_executor_wait(p_executor);
+    if (!check_streams(streams, false))
+    {
+        TEST_FAILED("dvbpsi_executor_submit order and exclusivity");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_executor_submit order and exclusivity");
+
+    size_t i_posted = 0;
+    for (int s = 0; s < STREAMS; s++)
+        i_posted += streams[s].i_posted;
+    const size_t i_drained = dvbpsi_executor_drain(p_executor);
+    if ((i_posted == 0) || (i_drained != i_posted) || (i_foreign_completions != 0) ||
+        (dvbpsi_executor_drain(p_executor) != 0) || !check_streams(streams, true))
+    {
+        fprintf(stderr, "%zu posted, %zu drained\n", i_posted, i_drained);
+        TEST_FAILED("dvbpsi_executor_drain");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_executor_drain");
+
+    /* Delete with batches and completions pending: it pushes the batches
+     * and runs the completions on this thread */
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        if (!submit_round(p_executor, streams, ai_ids))
+        {
+            TEST_FAILED("dvbpsi_executor_submit");
+            goto out;
+        }
+    }
+    dvbpsi_executor_delete(p_executor);
+    p_executor = NULL;
+    if (!check_streams(streams, true) || (i_foreign_completions != 0))
+    {
+        TEST_FAILED("dvbpsi_executor_delete with pending batches");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_executor_delete with pending batches");
+
+    i_ret = 0;
+    fprintf(stderr, "ALL EXECUTOR TESTS PASSED\n");
+
+out:
+    dvbpsi_executor_delete(p_executor);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_executor_test() != 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * test_section_cache.c: verified sections shared between handles
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/section_cache.h"
+#include "../src/tables/pat.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/section_cache.h>
+#include <dvbpsi/pat.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+#define CACHE_SLOTS 4096
+
+/* Variants of a one section PAT */
+enum
+{
+    PAT_GOOD = 0,       /* program 1 on PID 0x100 */
+    PAT_OTHER,          /* same version, program 1 on PID 0x200 */
+    PAT_BAD_PAYLOAD,    /* PAT_GOOD with a changed program, CRC_32 kept */
+    PAT_BAD_CRC,        /* PAT_GOOD with a changed CRC_32 */
+    PAT_VARIANTS
+};
+
+/* One packet pushed to a new handle sharing the cache */
+typedef struct
+{
+    const char *psz_name;
+    int         i_variant;
+    int         i_pmt_pid;      /* signalled, -1 for no PAT */
+    unsigned    i_hits;         /* counters expected after the packet */
+    unsigned    i_inserts;
+    unsigned    i_crc_errors;
+} cache_case_t;
+
+static const cache_case_t cache_cases[] =
+{
+    { "first handle inserts",               PAT_GOOD,        0x100, 0, 1, 0 },
+    { "second handle hits",                 PAT_GOOD,        0x100, 1, 1, 0 },
+    { "different content misses",           PAT_OTHER,       0x200, 1, 2, 0 },
+    { "bad payload is not served",          PAT_BAD_PAYLOAD, -1,    1, 2, 1 },
+    { "bad payload is not inserted",        PAT_BAD_PAYLOAD, -1,    1, 2, 1 },
+    { "bad CRC_32 is not inserted",         PAT_BAD_CRC,     -1,    1, 2, 1 },
+    { "good section still hits",            PAT_GOOD,        0x100, 2, 2, 0 },
+};
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+    switch(level)
+    {
+        case DVBPSI_MSG_ERROR: fprintf(stderr, "Error: "); break;
+        case DVBPSI_MSG_WARN:  fprintf(stderr, "Warning: "); break;
+        case DVBPSI_MSG_DEBUG: fprintf(stderr, "Debug: "); break;
+        default: /* do nothing */
+            return;
+    }
+    fprintf(stderr, "%s\n", msg);
+}
+
+static void GotPAT(void *p_data, dvbpsi_pat_t *p_pat)
+{
+    int *pi_pmt_pid = (int *)p_data;
+
+    if (p_pat->p_first_program)
+        *pi_pmt_pid = p_pat->p_first_program->i_pid;
+    dvbpsi_pat_delete(p_pat);
+}
+
+/* Packetize a PAT whose only program is carried on i_pmt_pid */
+static bool build_pat(dvbpsi_t *p_dvbpsi, const uint16_t i_pmt_pid, uint8_t *p_packet)
+{
+    dvbpsi_pat_t *p_pat = dvbpsi_pat_new(0x0001, 3, true);
+    if (p_pat == NULL)
+        return false;
+    dvbpsi_pat_program_add(p_pat, 1, i_pmt_pid);
+    dvbpsi_psi_section_t *p_section = dvbpsi_pat_sections_generate(p_dvbpsi, p_pat, 253);
+    dvbpsi_pat_delete(p_pat);
+    if (p_section == NULL)
+        return false;
+
+    const size_t i_size = p_section->p_payload_end - p_section->p_data + 4;
+    memset(p_packet, 0xff, 188);
+    p_packet[0] = 0x47;
+    p_packet[1] = 0x40;
+    p_packet[2] = 0x00;
+    p_packet[3] = 0x10;
+    p_packet[4] = 0x00; /* pointer_field */
+    memcpy(p_packet + 5, p_section->p_data, i_size);
+    dvbpsi_DeletePSISections(p_section);
+    return true;
+}
+
+/* Push a packet to a new handle sharing p_cache, returns the PMT PID
+ * signalled, -1 for none */
+static int push_to_new_handle(dvbpsi_section_cache_t *p_cache, const uint8_t *p_packet,
+                              uint64_t *pi_crc_errors)
+{
+    int i_pmt_pid = -1;
+
+    *pi_crc_errors = 0;
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_NONE);
+    if (p_dvbpsi == NULL)
+        return -1;
+    if (dvbpsi_pat_attach(p_dvbpsi, 0x00, 0x0001, GotPAT, &i_pmt_pid))
+    {
+        dvbpsi_section_cache_attach(p_dvbpsi, p_cache);
+        dvbpsi_packet_push(p_dvbpsi, p_packet);
+        dvbpsi_section_cache_attach(p_dvbpsi, NULL);
+        dvbpsi_pat_detach(p_dvbpsi, 0x00, 0x0001);
+    }
+    *pi_crc_errors = p_dvbpsi->errors.i_crc_errors;
+    dvbpsi_delete(p_dvbpsi);
+    return i_pmt_pid;
+}
+
+/*****************************************************************************
+ * SECTION CACHE TESTS
+ *****************************************************************************/
+static int run_section_cache_test(void)
+{
+    uint8_t packets[PAT_VARIANTS][188];
+    int i_ret = 1;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    dvbpsi_section_cache_t *p_cache = dvbpsi_section_cache_new(CACHE_SLOTS);
+    if ((p_dvbpsi == NULL) || (p_cache == NULL) ||
+        !build_pat(p_dvbpsi, 0x100, packets[PAT_GOOD]) ||
+        !build_pat(p_dvbpsi, 0x200, packets[PAT_OTHER]))
+    {
+        TEST_FAILED("section cache setup");
+        goto out;
+    }
+
+    /* PAT section at offset 5: 8 bytes of header, program_number, PID and
+     * CRC_32 */
+    memcpy(packets[PAT_BAD_PAYLOAD], packets[PAT_GOOD], 188);
+    packets[PAT_BAD_PAYLOAD][5 + 8 + 3] ^= 0x40;
+    memcpy(packets[PAT_BAD_CRC], packets[PAT_GOOD], 188);
+    packets[PAT_BAD_CRC][5 + 12 + 3] ^= 0x01;
+
+    const int i_cases = sizeof(cache_cases) / sizeof(cache_cases[0]);
+    for (int i = 0; i < i_cases; i++)
+    {
+        const cache_case_t *p_case = &cache_cases[i];
+        dvbpsi_section_cache_stats_t stats;
+        uint64_t i_crc_errors;
+
+        const int i_pmt_pid = push_to_new_handle(p_cache, packets[p_case->i_variant],
+                                                 &i_crc_errors);
+        dvbpsi_section_cache_stats(p_cache, &stats);
+        if ((i_pmt_pid != p_case->i_pmt_pid) || (stats.i_lookups != (uint64_t)i + 1) ||
+            (stats.i_hits != p_case->i_hits) || (stats.i_inserts != p_case->i_inserts) ||
+            (i_crc_errors != p_case->i_crc_errors))
+        {
+            fprintf(stderr, "PMT PID %d, %"PRIu64" lookups, %"PRIu64" hits, "
+                    "%"PRIu64" inserts, %"PRIu64" CRC_32 errors\n", i_pmt_pid,
+                    stats.i_lookups, stats.i_hits, stats.i_inserts, i_crc_errors);
+            TEST_FAILED(p_case->psz_name);
+            goto out;
+        }
+        TEST_PASSED(p_case->psz_name);
+    }
+
+    i_ret = 0;
+    fprintf(stderr, "ALL SECTION CACHE TESTS PASSED\n");
+
+out:
+    dvbpsi_section_cache_delete(p_cache);
+    if (p_dvbpsi)
+        dvbpsi_delete(p_dvbpsi);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_section_cache_test() != 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+/*****************************************************************************
+ * test_snapshot.c: tables published to other threads
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/snapshot.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/snapshot.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+#define TABLE_WORDS     16
+#define TABLE_FREED     0xdeadbeef
+#define STRESS_VERSIONS 100000
+
+/* A published table: every word holds its version, until it is freed */
+typedef struct
+{
+    uint32_t ai_words[TABLE_WORDS];
+} test_table_t;
+
+static unsigned int i_tables_freed;
+static unsigned int i_double_frees;
+
+static test_table_t *table_new(const uint32_t i_version)
+{
+    test_table_t *p_table = malloc(sizeof(test_table_t));
+    if (p_table)
+    {
+        for (int i = 0; i < TABLE_WORDS; i++)
+            p_table->ai_words[i] = i_version;
+    }
+    return p_table;
+}
+
+static void table_free(void *p_data)
+{
+    test_table_t *p_table = (test_table_t *)p_data;
+
+    if (p_table->ai_words[0] == TABLE_FREED)
+        __atomic_add_fetch(&i_double_frees, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < TABLE_WORDS; i++)
+        p_table->ai_words[i] = TABLE_FREED;
+    __atomic_add_fetch(&i_tables_freed, 1, __ATOMIC_RELAXED);
+    free(p_table);
+}
+
+/* Returns the version of a table, TABLE_FREED when it is torn or freed */
+static uint32_t table_version(const test_table_t *p_table)
+{
+    const uint32_t i_version = p_table->ai_words[0];
+    for (int i = 1; i < TABLE_WORDS; i++)
+    {
+        if (p_table->ai_words[i] != i_version)
+            return TABLE_FREED;
+    }
+    return i_version;
+}
+
+static bool publish(dvbpsi_snapshot_t *p_snapshot, const uint16_t i_extension,
+                    const uint32_t i_version)
+{
+    test_table_t *p_table = table_new(i_version);
+    if (p_table == NULL)
+        return false;
+    if (!dvbpsi_snapshot_publish(p_snapshot, 0x02, i_extension, p_table, table_free))
+    {
+        free(p_table);
+        return false;
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * SNAPSHOT TESTS
+ *****************************************************************************/
+static int run_snapshot_test(void)
+{
+    dvbpsi_snapshot_ref_t *p_ref, *p_held;
+    const test_table_t *p_table, *p_old;
+    int i_ret = 1;
+
+    i_tables_freed = i_double_frees = 0;
+    dvbpsi_snapshot_t *p_snapshot = dvbpsi_snapshot_new();
+    if (p_snapshot == NULL)
+        return 1;
+
+    /* Nothing published yet */
+    p_table = dvbpsi_snapshot_acquire(p_snapshot, 0x02, 1, &p_ref);
+    if ((p_table != NULL) || (p_ref != NULL))
+    {
+        TEST_FAILED("dvbpsi_snapshot_acquire of an empty store");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_acquire of an empty store");
+
+    /* Publish, then acquire the same table and only that one */
+    if (!publish(p_snapshot, 1, 1) || !publish(p_snapshot, 2, 100))
+        goto out;
+    p_table = dvbpsi_snapshot_acquire(p_snapshot, 0x02, 1, &p_ref);
+    if ((p_table == NULL) || (p_ref == NULL) || (table_version(p_table) != 1) ||
+        (dvbpsi_snapshot_acquire(p_snapshot, 0x02, 3, &p_held) != NULL) ||
+        (dvbpsi_snapshot_acquire(p_snapshot, 0x03, 1, &p_held) != NULL))
+    {
+        TEST_FAILED("dvbpsi_snapshot_publish");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_publish");
+
+    /* Replace while held: the reader keeps its version, new readers get the
+     * new one, the old one is freed once released and reclaimed */
+    p_held = p_ref;
+    p_old = p_table;
+    for (uint32_t v = 2; v <= 5; v++)
+    {
+        if (!publish(p_snapshot, 1, v))
+            goto out;
+        p_table = dvbpsi_snapshot_acquire(p_snapshot, 0x02, 1, &p_ref);
+        if ((p_table == NULL) || (table_version(p_table) != v) ||
+            (table_version(p_old) != 1))
+        {
+            TEST_FAILED("dvbpsi_snapshot_publish while held");
+            goto out;
+        }
+        dvbpsi_snapshot_release(p_ref);
+    }
+    /* a replaced version is freed on the second publish after it, version 1
+     * is still held */
+    if (i_tables_freed != 2)
+    {
+        fprintf(stderr, "%u tables freed\n", i_tables_freed);
+        TEST_FAILED("dvbpsi_snapshot_publish while held");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_publish while held");
+
+    dvbpsi_snapshot_release(p_held);
+    for (uint32_t v = 6; v <= 8; v++)
+    {
+        if (!publish(p_snapshot, 1, v))
+            goto out;
+    }
+    /* versions 1 to 6 are gone, 7 waits for the next publish */
+    if (i_tables_freed != 6)
+    {
+        fprintf(stderr, "%u tables freed\n", i_tables_freed);
+        TEST_FAILED("dvbpsi_snapshot_release");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_release");
+
+    /* Withdraw the table */
+    if (!dvbpsi_snapshot_publish(p_snapshot, 0x02, 2, NULL, NULL) ||
+        (dvbpsi_snapshot_acquire(p_snapshot, 0x02, 2, &p_ref) != NULL) ||
+        (p_ref != NULL))
+    {
+        TEST_FAILED("dvbpsi_snapshot_publish of NULL");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_publish of NULL");
+
+    /* Delete while held: the held table survives the store */
+    p_table = dvbpsi_snapshot_acquire(p_snapshot, 0x02, 1, &p_held);
+    dvbpsi_snapshot_delete(p_snapshot);
+    p_snapshot = NULL;
+    if ((p_table == NULL) || (table_version(p_table) != 8) || (i_tables_freed != 8))
+    {
+        fprintf(stderr, "%u tables freed\n", i_tables_freed);
+        TEST_FAILED("dvbpsi_snapshot_delete while held");
+        goto out;
+    }
+    dvbpsi_snapshot_release(p_held);
+    if ((i_tables_freed != 9) || (i_double_frees != 0))
+    {
+        fprintf(stderr, "%u tables freed, %u twice\n", i_tables_freed, i_double_frees);
+        TEST_FAILED("dvbpsi_snapshot_delete while held");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_delete while held");
+
+    i_ret = 0;
+    fprintf(stderr, "ALL SNAPSHOT TESTS PASSED\n");
+
+out:
+    dvbpsi_snapshot_delete(p_snapshot);
+    return i_ret;
+}
+
+#ifdef HAVE_PTHREAD_H
+/*****************************************************************************
+ * SNAPSHOT STRESS TEST
+ *****************************************************************************
+ * One thread publishes new versions as fast as it can while another one
+ * acquires them: the reader must never see a torn or freed table, nor a
+ * version older than one it already saw. Meant to run under
+ * -fsanitize=thread and -fsanitize=address too.
+ *****************************************************************************/
+typedef struct
+{
+    dvbpsi_snapshot_t *p_snapshot;
+    bool               b_done;
+    unsigned int       i_acquired;
+    unsigned int       i_errors;
+} stress_t;
+
+static void *stress_reader(void *p_data)
+{
+    stress_t *p_stress = (stress_t *)p_data;
+    uint32_t i_last = 0;
+
+    while (!__atomic_load_n(&p_stress->b_done, __ATOMIC_ACQUIRE))
+    {
+        dvbpsi_snapshot_ref_t *p_ref;
+        const test_table_t *p_table =
+                dvbpsi_snapshot_acquire(p_stress->p_snapshot, 0x02, 1, &p_ref);
+        if (p_table == NULL)
+            continue;
+
+        const uint32_t i_version = table_version(p_table);
+        if ((i_version == TABLE_FREED) || (i_version < i_last))
+            p_stress->i_errors++;
+        i_last = i_version;
+        p_stress->i_acquired++;
+        dvbpsi_snapshot_release(p_ref);
+    }
+    return NULL;
+}
+
+static int run_snapshot_stress_test(void)
+{
+    stress_t stress;
+    pthread_t reader;
+    int i_ret = 1;
+
+    i_tables_freed = i_double_frees = 0;
+    memset(&stress, 0, sizeof(stress));
+    stress.p_snapshot = dvbpsi_snapshot_new();
+    if (stress.p_snapshot == NULL)
+        return 1;
+    if (pthread_create(&reader, NULL, stress_reader, &stress) != 0)
+    {
+        dvbpsi_snapshot_delete(stress.p_snapshot);
+        return 1;
+    }
+
+    uint32_t v;
+    for (v = 1; v <= STRESS_VERSIONS; v++)
+    {
+        if (!publish(stress.p_snapshot, 1, v))
+            break;
+    }
+    __atomic_store_n(&stress.b_done, true, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+    dvbpsi_snapshot_delete(stress.p_snapshot);
+
+    if ((v <= STRESS_VERSIONS) || (stress.i_errors != 0) ||
+        (i_tables_freed != STRESS_VERSIONS) || (i_double_frees != 0))
+    {
+        fprintf(stderr, "%u published, %u acquired, %u errors, %u freed, %u twice\n",
+                v - 1, stress.i_acquired, stress.i_errors, i_tables_freed, i_double_frees);
+        TEST_FAILED("dvbpsi_snapshot_acquire versus dvbpsi_snapshot_publish");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_snapshot_acquire versus dvbpsi_snapshot_publish");
+    i_ret = 0;
+
+out:
+    return i_ret;
+}
+#endif
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_snapshot_test() != 0)
+        return 1;
+#ifdef HAVE_PTHREAD_H
+    if (run_snapshot_stress_test() != 0)
+        return 1;
+#endif
+
+    return 0;
+}
@@ -0,0 +1,1157 @@
+/*****************************************************************************
+ * test_tables.c: table generators round-tripped through the decoders
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/chain.h"
+#include "../src/descriptor.h"
+#include "../src/tables/atsc_stt.h"
+#include "../src/tables/atsc_mgt.h"
+#include "../src/tables/atsc_vct.h"
+#include "../src/tables/atsc_eit.h"
+#include "../src/tables/atsc_ett.h"
+#include "../src/tables/eit.h"
+#include "../src/tables/pmt.h"
+#include "../src/tables/nit.h"
+#include "../src/tables/bat.h"
+#include "../src/tables/sdt.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/chain.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/atsc_stt.h>
+#include <dvbpsi/atsc_mgt.h>
+#include <dvbpsi/atsc_vct.h>
+#include <dvbpsi/atsc_eit.h>
+#include <dvbpsi/atsc_ett.h>
+#include <dvbpsi/eit.h>
+#include <dvbpsi/pmt.h>
+#include <dvbpsi/nit.h>
+#include <dvbpsi/bat.h>
+#include <dvbpsi/sdt.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+/* Tables signalled by the decoders */
+typedef struct
+{
+    dvbpsi_atsc_stt_t *p_stt;
+    dvbpsi_atsc_mgt_t *p_mgt;
+    dvbpsi_atsc_vct_t *p_vct;
+    dvbpsi_atsc_eit_t *p_eit;
+    dvbpsi_atsc_ett_t *p_ett;
+    int                i_tables;
+} decoded_t;
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+    switch(level)
+    {
+        case DVBPSI_MSG_ERROR: fprintf(stderr, "Error: "); break;
+        case DVBPSI_MSG_WARN:  fprintf(stderr, "Warning: "); break;
+        default: /* do nothing */
+            return;
+    }
+    fprintf(stderr, "%s\n", msg);
+}
+
+static void GotSTT(void *p_data, dvbpsi_atsc_stt_t *p_stt)
+{
+    decoded_t *p_decoded = (decoded_t *)p_data;
+    if (p_decoded->p_stt)
+        dvbpsi_atsc_stt_delete(p_decoded->p_stt);
+    p_decoded->p_stt = p_stt;
+    p_decoded->i_tables++;
+}
+
+static void GotMGT(void *p_data, dvbpsi_atsc_mgt_t *p_mgt)
+{
+    decoded_t *p_decoded = (decoded_t *)p_data;
+    if (p_decoded->p_mgt)
+        dvbpsi_atsc_mgt_delete(p_decoded->p_mgt);
+    p_decoded->p_mgt = p_mgt;
+    p_decoded->i_tables++;
+}
+
+static void GotVCT(void *p_data, dvbpsi_atsc_vct_t *p_vct)
+{
+    decoded_t *p_decoded = (decoded_t *)p_data;
+    if (p_decoded->p_vct)
+        dvbpsi_atsc_vct_delete(p_decoded->p_vct);
+    p_decoded->p_vct = p_vct;
+    p_decoded->i_tables++;
+}
+
+static void GotEIT(void *p_data, dvbpsi_atsc_eit_t *p_eit)
+{
+    decoded_t *p_decoded = (decoded_t *)p_data;
+    if (p_decoded->p_eit)
+        dvbpsi_atsc_eit_delete(p_decoded->p_eit);
+    p_decoded->p_eit = p_eit;
+    p_decoded->i_tables++;
+}
+
+static void GotETT(void *p_data, dvbpsi_atsc_ett_t *p_ett)
+{
+    decoded_t *p_decoded = (decoded_t *)p_data;
+    if (p_decoded->p_ett)
+        dvbpsi_atsc_ett_delete(p_decoded->p_ett);
+    p_decoded->p_ett = p_ett;
+    p_decoded->i_tables++;
+}
+
+static void NewSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
+                        void *p_data)
+{
+    bool b_ok = true;
+    switch (i_table_id)
+    {
+    case 0xC7: b_ok = dvbpsi_atsc_mgt_attach(p_dvbpsi, i_table_id, i_extension, GotMGT, p_data); break;
+    case 0xC8: b_ok = dvbpsi_atsc_vct_attach(p_dvbpsi, i_table_id, i_extension, GotVCT, p_data); break;
+    case 0xCB: b_ok = dvbpsi_atsc_eit_attach(p_dvbpsi, i_table_id, i_extension, GotEIT, p_data); break;
+    case 0xCC: b_ok = dvbpsi_atsc_ett_attach(p_dvbpsi, i_table_id, i_extension, GotETT, p_data); break;
+    case 0xCD: b_ok = dvbpsi_atsc_stt_attach(p_dvbpsi, i_table_id, i_extension, GotSTT, p_data); break;
+    }
+    if (!b_ok)
+        fprintf(stderr, "Failed to attach decoder 0x%02x\n", i_table_id);
+}
+
+static void DelSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    switch (i_table_id)
+    {
+    case 0xC7: dvbpsi_atsc_mgt_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0xC8: dvbpsi_atsc_vct_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0xCB: dvbpsi_atsc_eit_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0xCC: dvbpsi_atsc_ett_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0xCD: dvbpsi_atsc_stt_detach(p_dvbpsi, i_table_id, i_extension); break;
+    }
+}
+
+/* Packetize a list of sections on PID 0x1FFB, each one starting a packet */
+static int push_sections(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section, uint8_t *p_cc)
+{
+    int i_sections = 0;
+
+    for (; p_section != NULL; p_section = p_section->p_next, i_sections++)
+    {
+        const uint8_t *p_data = p_section->p_data;
+        size_t i_size = p_section->p_payload_end - p_section->p_data + 4;
+        bool b_first = true;
+
+        while (i_size > 0)
+        {
+            uint8_t pkt[188];
+            size_t i_pos = 4;
+
+            memset(pkt, 0xff, sizeof(pkt));
+            pkt[0] = 0x47;
+            pkt[1] = (b_first ? 0x40 : 0x00) | 0x1f;
+            pkt[2] = 0xfb;
+            pkt[3] = 0x10 | (*p_cc & 0x0f);
+            if (b_first)
+                pkt[i_pos++] = 0x00; /* pointer_field */
+
+            size_t i_copy = sizeof(pkt) - i_pos;
+            if (i_copy > i_size)
+                i_copy = i_size;
+            memcpy(pkt + i_pos, p_data, i_copy);
+            p_data += i_copy;
+            i_size -= i_copy;
+
+            *p_cc = *p_cc + 1;
+            b_first = false;
+            dvbpsi_packet_push(p_dvbpsi, pkt);
+        }
+    }
+    return i_sections;
+}
+
+static bool descriptor_equal(const dvbpsi_descriptor_t *p_a, const dvbpsi_descriptor_t *p_b)
+{
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next)
+    {
+        if ((p_a->i_tag != p_b->i_tag) || (p_a->i_length != p_b->i_length) ||
+            memcmp(p_a->p_data, p_b->p_data, p_a->i_length))
+            return false;
+    }
+    return (p_a == NULL) && (p_b == NULL);
+}
+
+/*****************************************************************************
+ * STT
+ *****************************************************************************/
+static bool stt_round_trip(dvbpsi_t *p_dvbpsi, decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_ca[] = { 0x12, 0x34, 0x56 };
+    bool b_ok = false;
+
+    dvbpsi_atsc_stt_t *p_stt = dvbpsi_atsc_stt_new(0xCD, 0, 0, true);
+    if (p_stt == NULL)
+        return false;
+    p_stt->i_protocol = 1;
+    p_stt->i_system_time = 0x4b3c2d1e;
+    p_stt->i_gps_utc_offset = 18;
+    p_stt->i_daylight_savings = 0xc123;
+    dvbpsi_atsc_stt_descriptor_add(p_stt, 0xaa, sizeof(p_ca), p_ca);
+
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_stt_sections_generate(p_dvbpsi, p_stt);
+    if (p_section == NULL)
+        goto out;
+    push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+
+    dvbpsi_atsc_stt_t *p_got = p_decoded->p_stt;
+    b_ok = (p_got != NULL) &&
+           (p_got->i_protocol == p_stt->i_protocol) &&
+           (p_got->i_system_time == p_stt->i_system_time) &&
+           (p_got->i_gps_utc_offset == p_stt->i_gps_utc_offset) &&
+           (p_got->i_daylight_savings == p_stt->i_daylight_savings) &&
+           descriptor_equal(p_got->p_first_descriptor, p_stt->p_first_descriptor);
+out:
+    dvbpsi_atsc_stt_delete(p_stt);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * MGT
+ *****************************************************************************/
+static bool mgt_round_trip(dvbpsi_t *p_dvbpsi, decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[] = { 'm', 'g', 't' };
+    bool b_ok = false;
+
+    dvbpsi_atsc_mgt_t *p_mgt = dvbpsi_atsc_mgt_new(0xC7, 0, 3, 0, true);
+    if (p_mgt == NULL)
+        return false;
+    for (int i = 0; i < 8; i++)
+    {
+        dvbpsi_atsc_mgt_table_t *p_table =
+                dvbpsi_atsc_mgt_table_add(p_mgt, 0x0100 + i, 0x1d00 + i, i, 1000 * i);
+        if (p_table == NULL)
+            goto out;
+        if ((i & 1) && !dvbpsi_atsc_mgt_table_descriptor_add(p_table, 0x80 + i,
+                                                             sizeof(p_data), p_data))
+            goto out;
+    }
+    dvbpsi_atsc_mgt_descriptor_add(p_mgt, 0x81, sizeof(p_data), p_data);
+
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_mgt_sections_generate(p_dvbpsi, p_mgt);
+    if (p_section == NULL)
+        goto out;
+    push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+
+    dvbpsi_atsc_mgt_t *p_got = p_decoded->p_mgt;
+    if ((p_got == NULL) || (p_got->i_version != p_mgt->i_version) ||
+        !descriptor_equal(p_got->p_first_descriptor, p_mgt->p_first_descriptor))
+        goto out;
+
+    dvbpsi_atsc_mgt_table_t *p_a = p_mgt->p_first_table, *p_b = p_got->p_first_table;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next)
+    {
+        if ((p_a->i_table_type != p_b->i_table_type) ||
+            (p_a->i_table_type_pid != p_b->i_table_type_pid) ||
+            (p_a->i_table_type_version != p_b->i_table_type_version) ||
+            (p_a->i_number_bytes != p_b->i_number_bytes) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL);
+out:
+    dvbpsi_atsc_mgt_delete(p_mgt);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * VCT, enough channels for several sections
+ *****************************************************************************/
+#define VCT_CHANNELS (100)
+static bool vct_round_trip(dvbpsi_t *p_dvbpsi, decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[] = { 0x01, 0x02, 0x03, 0x04 };
+    bool b_ok = false;
+
+    dvbpsi_atsc_vct_t *p_vct = dvbpsi_atsc_vct_new(0xC8, 0x1234, 0, false, 5, true);
+    if (p_vct == NULL)
+        return false;
+    for (int i = 0; i < VCT_CHANNELS; i++)
+    {
+        uint8_t p_name[14] = { 0, 'C', 0, 'H', 0, '0' + i / 10, 0, '0' + i % 10 };
+        dvbpsi_atsc_vct_channel_t *p_channel =
+            dvbpsi_atsc_vct_channel_add(p_vct, p_name, 2 + i / 4, i % 4 + 1, 0x04,
+                                        0, 0x1234, i + 1, i % 3, i & 1, false,
+                                        false, false, i & 2, 0x02, 0x100 + i);
+        if (p_channel == NULL)
+            goto out;
+        if (!dvbpsi_atsc_vct_channel_descriptor_add(p_channel, 0xa0, sizeof(p_data), p_data))
+            goto out;
+    }
+
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_vct_sections_generate(p_dvbpsi, p_vct);
+    if (p_section == NULL)
+        goto out;
+    int i_sections = push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+    if (i_sections < 2)
+    {
+        fprintf(stderr, "VCT fits in %d section\n", i_sections);
+        goto out;
+    }
+
+    dvbpsi_atsc_vct_t *p_got = p_decoded->p_vct;
+    if ((p_got == NULL) || (p_got->i_extension != p_vct->i_extension) ||
+        (p_got->i_version != p_vct->i_version))
+        goto out;
+
+    int i_channels = 0;
+    dvbpsi_atsc_vct_channel_t *p_a = p_vct->p_first_channel, *p_b = p_got->p_first_channel;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_channels++)
+    {
+        if (memcmp(p_a->i_short_name, p_b->i_short_name, sizeof(p_a->i_short_name)) ||
+            (p_a->i_major_number != p_b->i_major_number) ||
+            (p_a->i_minor_number != p_b->i_minor_number) ||
+            (p_a->i_modulation != p_b->i_modulation) ||
+            (p_a->i_channel_tsid != p_b->i_channel_tsid) ||
+            (p_a->i_program_number != p_b->i_program_number) ||
+            (p_a->i_etm_location != p_b->i_etm_location) ||
+            (p_a->b_access_controlled != p_b->b_access_controlled) ||
+            (p_a->b_hide_guide != p_b->b_hide_guide) ||
+            (p_a->i_service_type != p_b->i_service_type) ||
+            (p_a->i_source_id != p_b->i_source_id) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_channels == VCT_CHANNELS);
+out:
+    dvbpsi_atsc_vct_delete(p_vct);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * EIT, enough events for several sections
+ *****************************************************************************/
+#define EIT_EVENTS (120)
+static bool eit_round_trip(dvbpsi_t *p_dvbpsi, decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_rating[] = { 0x01, 0x01, 0x01, 0x11 };
+    bool b_ok = false;
+
+    dvbpsi_atsc_eit_t *p_eit = dvbpsi_atsc_eit_new(0xCB, 0x0103, 7, 0, 0x0103, true);
+    if (p_eit == NULL)
+        return false;
+    for (int i = 0; i < EIT_EVENTS; i++)
+    {
+        /* multiple_string_structure: one "eng" string of one segment */
+        uint8_t p_title[40] = { 0x01, 'e', 'n', 'g', 0x01, 0x00, 0x00, 32 };
+        memset(p_title + 8, 'a' + i % 26, 32);
+
+        dvbpsi_atsc_eit_event_t *p_event =
+            dvbpsi_atsc_eit_event_add(p_eit, 0x2000 + i, 1000000000 + 1800 * i,
+                                      i % 3, 1800, sizeof(p_title), p_title);
+        if (p_event == NULL)
+            goto out;
+        if (!dvbpsi_atsc_eit_event_descriptor_add(p_event, 0x87, sizeof(p_rating), p_rating))
+            goto out;
+    }
+
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_eit_sections_generate(p_dvbpsi, p_eit);
+    if (p_section == NULL)
+        goto out;
+    int i_sections = push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+    if (i_sections < 2)
+    {
+        fprintf(stderr, "EIT fits in %d section\n", i_sections);
+        goto out;
+    }
+
+    dvbpsi_atsc_eit_t *p_got = p_decoded->p_eit;
+    if ((p_got == NULL) || (p_got->i_source_id != p_eit->i_source_id) ||
+        (p_got->i_version != p_eit->i_version))
+        goto out;
+
+    int i_events = 0;
+    dvbpsi_atsc_eit_event_t *p_a = p_eit->p_first_event, *p_b = p_got->p_first_event;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_events++)
+    {
+        if ((p_a->i_event_id != p_b->i_event_id) ||
+            (p_a->i_start_time != p_b->i_start_time) ||
+            (p_a->i_etm_location != p_b->i_etm_location) ||
+            (p_a->i_length_seconds != p_b->i_length_seconds) ||
+            (p_a->i_title_length != p_b->i_title_length) ||
+            memcmp(p_a->i_title, p_b->i_title, p_a->i_title_length) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_events == EIT_EVENTS);
+out:
+    dvbpsi_atsc_eit_delete(p_eit);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * EIT generator limits
+ *****************************************************************************/
+static int count_sections(dvbpsi_psi_section_t *p_section, uint8_t *pi_last_number)
+{
+    int i_sections = 0;
+
+    for (; p_section != NULL; p_section = p_section->p_next, i_sections++)
+    {
+        *pi_last_number = p_section->i_last_number;
+        if (p_section->i_number != i_sections)
+            return -1;
+    }
+    return i_sections;
+}
+
+static bool eit_limits(dvbpsi_t *p_dvbpsi)
+{
+    uint8_t p_data[255];
+    uint8_t i_last_number = 0;
+    bool b_ok = false;
+
+    memset(p_data, 0, sizeof(p_data));
+
+    /* An event larger than a section, after one that fits: it is left out
+     * without opening a section of its own */
+    dvbpsi_atsc_eit_t *p_eit = dvbpsi_atsc_eit_new(0xCB, 0x0104, 0, 0, 0x0104, true);
+    if (p_eit == NULL)
+        return false;
+    dvbpsi_atsc_eit_event_add(p_eit, 1, 1000, 0, 60, 0, p_data);
+    dvbpsi_atsc_eit_event_t *p_large = dvbpsi_atsc_eit_event_add(p_eit, 2, 2000, 0, 60,
+                                                                 0, p_data);
+    if (p_large == NULL)
+        goto out;
+    for (int i = 0; i < 300; i++)
+    {
+        if (!dvbpsi_atsc_eit_event_descriptor_add(p_large, 0x80, sizeof(p_data), p_data))
+            goto out;
+    }
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_eit_sections_generate(p_dvbpsi, p_eit);
+    const int i_sections = count_sections(p_section, &i_last_number);
+    const int i_events = p_section ? p_section->p_data[9] : -1;
+    dvbpsi_DeletePSISections(p_section);
+    if ((i_sections != 1) || (i_events != 1))
+    {
+        fprintf(stderr, "%d sections, %d events\n", i_sections, i_events);
+        goto out;
+    }
+    dvbpsi_atsc_eit_delete(p_eit);
+
+    /* More events than 256 sections of 255 events: section_number stops
+     * at 255 */
+    p_eit = dvbpsi_atsc_eit_new(0xCB, 0x0104, 0, 0, 0x0104, true);
+    if (p_eit == NULL)
+        return false;
+    dvbpsi_atsc_eit_event_t *p_last = NULL;
+    for (int i = 0; i < 256 * 255 + 1; i++)
+    {
+        /* appended after the last event, not walking the list */
+        dvbpsi_atsc_eit_event_t *p_event = calloc(1, sizeof(dvbpsi_atsc_eit_event_t));
+        if (p_event == NULL)
+            goto out;
+        p_event->i_event_id = i & 0x3fff;
+        if (p_last)
+            p_last->p_next = p_event;
+        else
+            p_eit->p_first_event = p_event;
+        p_last = p_event;
+    }
+    p_section = dvbpsi_atsc_eit_sections_generate(p_dvbpsi, p_eit);
+    b_ok = (count_sections(p_section, &i_last_number) == 256) && (i_last_number == 255);
+    dvbpsi_DeletePSISections(p_section);
+out:
+    dvbpsi_atsc_eit_delete(p_eit);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * ETT
+ *****************************************************************************/
+static bool ett_round_trip(dvbpsi_t *p_dvbpsi, decoded_t *p_decoded, uint8_t *p_cc)
+{
+    /* multiple_string_structure: "eng" and "fra" strings of one segment */
+    const uint8_t p_etm[] = { 0x02, 'e', 'n', 'g', 0x01, 0x00, 0x00, 4, 't', 'e', 'x', 't',
+                                    'f', 'r', 'a', 0x01, 0x00, 0x00, 5, 't', 'e', 'x', 't', 'e' };
+    bool b_ok = false;
+
+    /* ETM_id of event 0x2001 of source 0x0103 */
+    dvbpsi_atsc_ett_t *p_ett = dvbpsi_atsc_ett_new(0xCC, 0x0103, 5, 0,
+                                                   (0x0103 << 16) | (0x2001 << 2) | 0x2, true);
+    if (p_ett == NULL)
+        return false;
+    p_ett->p_etm_data = malloc(sizeof(p_etm));
+    if (p_ett->p_etm_data == NULL)
+        goto out;
+    memcpy(p_ett->p_etm_data, p_etm, sizeof(p_etm));
+    p_ett->i_etm_length = sizeof(p_etm);
+
+    dvbpsi_psi_section_t *p_section = dvbpsi_atsc_ett_sections_generate(p_dvbpsi, p_ett);
+    if (p_section == NULL)
+        goto out;
+    push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+
+    dvbpsi_atsc_ett_t *p_got = p_decoded->p_ett;
+    b_ok = (p_got != NULL) &&
+           (p_got->i_extension == p_ett->i_extension) &&
+           (p_got->i_version == p_ett->i_version) &&
+           (p_got->i_protocol == p_ett->i_protocol) &&
+           (p_got->i_etm_id == p_ett->i_etm_id) &&
+           (p_got->i_etm_length == p_ett->i_etm_length) &&
+           !memcmp(p_got->p_etm_data, p_ett->p_etm_data, p_ett->i_etm_length);
+out:
+    dvbpsi_atsc_ett_delete(p_ett);
+    return b_ok;
+}
+
+/*****************************************************************************
+ * ATSC round trip tests
+ *****************************************************************************/
+static int run_atsc_round_trip_test(void)
+{
+    decoded_t decoded = { NULL, NULL, NULL, NULL, NULL, 0 };
+    uint8_t i_cc = 0;
+    int i_ret = 1;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    if (p_dvbpsi == NULL)
+        return 1;
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewSubtable, DelSubtable, &decoded))
+    {
+        dvbpsi_delete(p_dvbpsi);
+        return 1;
+    }
+
+    if (!stt_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("ATSC STT round trip");
+        goto out;
+    }
+    TEST_PASSED("ATSC STT round trip");
+
+    if (!mgt_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("ATSC MGT round trip");
+        goto out;
+    }
+    TEST_PASSED("ATSC MGT round trip");
+
+    if (!vct_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("ATSC VCT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("ATSC VCT multi-section round trip");
+
+    if (!eit_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("ATSC EIT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("ATSC EIT multi-section round trip");
+
+    if (!eit_limits(p_dvbpsi)) {
+        TEST_FAILED("ATSC EIT generator limits");
+        goto out;
+    }
+    TEST_PASSED("ATSC EIT generator limits");
+
+    if (!ett_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("ATSC ETT round trip");
+        goto out;
+    }
+    TEST_PASSED("ATSC ETT round trip");
+
+    if (decoded.i_tables != 5) {
+        TEST_FAILED("ATSC tables signalled once");
+        goto out;
+    }
+    i_ret = 0;
+    fprintf(stderr, "ALL ATSC ROUND TRIP TESTS PASSED\n");
+
+out:
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        fprintf(stderr, "Failed to cleanup chain_demux\n");
+    dvbpsi_delete(p_dvbpsi);
+    if (decoded.p_stt) dvbpsi_atsc_stt_delete(decoded.p_stt);
+    if (decoded.p_mgt) dvbpsi_atsc_mgt_delete(decoded.p_mgt);
+    if (decoded.p_vct) dvbpsi_atsc_vct_delete(decoded.p_vct);
+    if (decoded.p_eit) dvbpsi_atsc_eit_delete(decoded.p_eit);
+    if (decoded.p_ett) dvbpsi_atsc_ett_delete(decoded.p_ett);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * DVB EIT segments
+ *****************************************************************************/
+#define EIT_SIGNALS (8)
+typedef struct
+{
+    int  i_signals;
+    int  ai_segment[EIT_SIGNALS];   /* segment signalled, -1 for the table */
+    int  ai_events[EIT_SIGNALS];    /* number of events signalled */
+    int  ai_first[EIT_SIGNALS];     /* event_id of the first event */
+    bool b_bad_events;              /* event out of its segment */
+} eit_signals_t;
+
+static void record_eit(eit_signals_t *p_signals, dvbpsi_eit_t *p_eit, int i_segment)
+{
+    int i_events = 0;
+
+    if (p_signals->i_signals >= EIT_SIGNALS)
+    {
+        p_signals->b_bad_events = true;
+        dvbpsi_eit_delete(p_eit);
+        return;
+    }
+    for (dvbpsi_eit_event_t *p_event = p_eit->p_first_event; p_event;
+         p_event = p_event->p_next, i_events++)
+    {
+        /* Each section carries one event whose event_id is its section_number */
+        if ((i_segment >= 0) && ((p_event->i_event_id >> 3) != i_segment))
+            p_signals->b_bad_events = true;
+    }
+    p_signals->ai_segment[p_signals->i_signals] = i_segment;
+    p_signals->ai_events[p_signals->i_signals] = i_events;
+    p_signals->ai_first[p_signals->i_signals] =
+            p_eit->p_first_event ? p_eit->p_first_event->i_event_id : -1;
+    p_signals->i_signals++;
+    dvbpsi_eit_delete(p_eit);
+}
+
+static void GotEITSegment(void *p_data, dvbpsi_eit_t *p_eit, uint8_t i_segment)
+{
+    record_eit((eit_signals_t *)p_data, p_eit, i_segment);
+}
+
+static void GotDVBEIT(void *p_data, dvbpsi_eit_t *p_eit)
+{
+    record_eit((eit_signals_t *)p_data, p_eit, -1);
+}
+
+static void NewEITSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
+                           void *p_data)
+{
+    if ((i_table_id != 0x50) ||
+        !dvbpsi_eit_attach(p_dvbpsi, i_table_id, i_extension, GotDVBEIT, p_data) ||
+        !dvbpsi_eit_segment_callback_set(p_dvbpsi, i_table_id, i_extension, GotEITSegment))
+        fprintf(stderr, "Failed to attach EIT decoder 0x%02x\n", i_table_id);
+}
+
+static void DelEITSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    if (i_table_id == 0x50)
+        dvbpsi_eit_detach(p_dvbpsi, i_table_id, i_extension);
+}
+
+/* One EIT schedule section holding a single event, event_id = section_number */
+static void push_eit_section(dvbpsi_t *p_dvbpsi, uint8_t *p_cc, uint8_t i_number,
+                             uint8_t i_last_number, uint8_t i_segment_last)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(4096);
+    if (p_section == NULL)
+        return;
+
+    p_section->i_table_id = 0x50;
+    p_section->b_syntax_indicator = true;
+    p_section->b_private_indicator = true;
+    p_section->i_extension = 0x0101;            /* service_id */
+    p_section->i_version = 4;
+    p_section->b_current_next = true;
+    p_section->i_number = i_number;
+    p_section->i_last_number = i_last_number;
+    p_section->p_payload_start = p_section->p_data + 8;
+    p_section->p_payload_end += 8;
+
+    uint8_t *p = p_section->p_payload_end;
+    p[0] = 0x00; p[1] = 0x01;                   /* transport_stream_id */
+    p[2] = 0x00; p[3] = 0x02;                   /* original_network_id */
+    p[4] = i_segment_last;                      /* segment_last_section_number */
+    p[5] = 0x50;                                /* last_table_id */
+    p[6] = 0x00; p[7] = i_number;               /* event_id */
+    p[8] = 0xe0; p[9] = 0x00;                   /* start_time */
+    p[10] = i_number; p[11] = 0x00; p[12] = 0x00;
+    p[13] = 0x00; p[14] = 0x30; p[15] = 0x00;   /* duration */
+    p[16] = 0x80; p[17] = 0x00;                 /* running, descriptors_loop_length */
+    p_section->p_payload_end += 18;
+    p_section->i_length = 5 + 4 + 18;
+
+    dvbpsi_BuildPSISection(p_dvbpsi, p_section);
+    push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+}
+
+static int run_eit_segment_test(void)
+{
+    /* Sparse schedule: segment 0 holds sections 0-1, segment 1 section 8,
+     * segment 2 section 16 and segment 3 sections 24-26. Table cases:
+     * section_number, segment_last_section_number */
+    static const uint8_t pi_sections[][2] = {
+        { 24, 26 }, { 0, 1 }, { 8, 8 }, { 25, 26 }, { 1, 1 }, { 16, 16 }, { 26, 26 },
+        { 0, 1 } /* repeated, must not be signalled again */
+    };
+    /* Expected signals: segment (-1 for the table), events, first event_id */
+    static const int pi_expected[][3] = {
+        { 1, 1, 8 }, { 0, 2, 0 }, { 2, 1, 16 }, { 3, 3, 24 }, { -1, 7, 0 }
+    };
+    const int i_expected = sizeof(pi_expected) / sizeof(pi_expected[0]);
+    eit_signals_t signals;
+    uint8_t i_cc = 0;
+    int i_ret = 1;
+
+    memset(&signals, 0, sizeof(signals));
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    if (p_dvbpsi == NULL)
+        return 1;
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewEITSubtable, DelEITSubtable, &signals))
+    {
+        dvbpsi_delete(p_dvbpsi);
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(pi_sections) / sizeof(pi_sections[0]); i++)
+    {
+        push_eit_section(p_dvbpsi, &i_cc, pi_sections[i][0], 26, pi_sections[i][1]);
+
+        /* The table is only signalled with its last section */
+        if ((i < 6) && (signals.i_signals > 0) &&
+            (signals.ai_segment[signals.i_signals - 1] == -1))
+        {
+            TEST_FAILED("EIT table signalled before its segments");
+            goto out;
+        }
+    }
+
+    if ((signals.i_signals != i_expected) || signals.b_bad_events) {
+        fprintf(stderr, "%d signals instead of %d\n", signals.i_signals, i_expected);
+        TEST_FAILED("EIT segment callbacks");
+        goto out;
+    }
+    for (int i = 0; i < i_expected; i++)
+    {
+        if ((signals.ai_segment[i] != pi_expected[i][0]) ||
+            (signals.ai_events[i] != pi_expected[i][1]) ||
+            (signals.ai_first[i] != pi_expected[i][2]))
+        {
+            fprintf(stderr, "signal %d: segment %d, %d events from %d\n", i,
+                    signals.ai_segment[i], signals.ai_events[i], signals.ai_first[i]);
+            TEST_FAILED("EIT segment callbacks");
+            goto out;
+        }
+    }
+    TEST_PASSED("EIT sparse segments signalled once each, before the table");
+    i_ret = 0;
+    fprintf(stderr, "ALL EIT SEGMENT TESTS PASSED\n");
+
+out:
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        fprintf(stderr, "Failed to cleanup chain_demux\n");
+    dvbpsi_delete(p_dvbpsi);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * DVB PMT, NIT, BAT and SDT, entries crossing the section limit
+ *****************************************************************************/
+#define DVB_ENTRIES     (24)
+#define DVB_DESCRIPTORS (4)
+
+/* Tables signalled by the decoders */
+typedef struct
+{
+    dvbpsi_pmt_t *p_pmt;
+    dvbpsi_nit_t *p_nit;
+    dvbpsi_bat_t *p_bat;
+    dvbpsi_sdt_t *p_sdt;
+    int           i_tables;
+} dvb_decoded_t;
+
+static void GotPMT(void *p_data, dvbpsi_pmt_t *p_pmt)
+{
+    dvb_decoded_t *p_decoded = (dvb_decoded_t *)p_data;
+    if (p_decoded->p_pmt)
+        dvbpsi_pmt_delete(p_decoded->p_pmt);
+    p_decoded->p_pmt = p_pmt;
+    p_decoded->i_tables++;
+}
+
+static void GotNIT(void *p_data, dvbpsi_nit_t *p_nit)
+{
+    dvb_decoded_t *p_decoded = (dvb_decoded_t *)p_data;
+    if (p_decoded->p_nit)
+        dvbpsi_nit_delete(p_decoded->p_nit);
+    p_decoded->p_nit = p_nit;
+    p_decoded->i_tables++;
+}
+
+static void GotBAT(void *p_data, dvbpsi_bat_t *p_bat)
+{
+    dvb_decoded_t *p_decoded = (dvb_decoded_t *)p_data;
+    if (p_decoded->p_bat)
+        dvbpsi_bat_delete(p_decoded->p_bat);
+    p_decoded->p_bat = p_bat;
+    p_decoded->i_tables++;
+}
+
+static void GotSDT(void *p_data, dvbpsi_sdt_t *p_sdt)
+{
+    dvb_decoded_t *p_decoded = (dvb_decoded_t *)p_data;
+    if (p_decoded->p_sdt)
+        dvbpsi_sdt_delete(p_decoded->p_sdt);
+    p_decoded->p_sdt = p_sdt;
+    p_decoded->i_tables++;
+}
+
+static void NewDVBSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
+                           void *p_data)
+{
+    bool b_ok = true;
+    switch (i_table_id)
+    {
+    case 0x02: b_ok = dvbpsi_pmt_attach(p_dvbpsi, i_table_id, i_extension, GotPMT, p_data); break;
+    case 0x40: b_ok = dvbpsi_nit_attach(p_dvbpsi, i_table_id, i_extension, GotNIT, p_data); break;
+    case 0x42: b_ok = dvbpsi_sdt_attach(p_dvbpsi, i_table_id, i_extension, GotSDT, p_data); break;
+    case 0x4A: b_ok = dvbpsi_bat_attach(p_dvbpsi, i_table_id, i_extension, GotBAT, p_data); break;
+    }
+    if (!b_ok)
+        fprintf(stderr, "Failed to attach decoder 0x%02x\n", i_table_id);
+}
+
+static void DelDVBSubtable(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension)
+{
+    switch (i_table_id)
+    {
+    case 0x02: dvbpsi_pmt_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0x40: dvbpsi_nit_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0x42: dvbpsi_sdt_detach(p_dvbpsi, i_table_id, i_extension); break;
+    case 0x4A: dvbpsi_bat_detach(p_dvbpsi, i_table_id, i_extension); break;
+    }
+}
+
+/* Descriptor j of entry i. Entries carry 12 to 884 bytes of descriptors,
+ * so most sections end before an entry that only fits in the next one. */
+static uint8_t entry_descriptor(int i, int j, uint8_t *p_data)
+{
+    uint8_t i_length = (i % 3 == 2) ? 1 : (uint8_t)(40 + (i * 61 + j * 17) % 180);
+    for (int k = 0; k < i_length; k++)
+        p_data[k] = (uint8_t)(i + j + k);
+    return i_length;
+}
+
+/* Checks the sections and the entry count, returns false on errors */
+static bool dvb_sections(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section,
+                         uint8_t *p_cc, const char *psz_table)
+{
+    uint8_t i_last_number = 0;
+    const int i_sections = count_sections(p_section, &i_last_number);
+
+    push_sections(p_dvbpsi, p_section, p_cc);
+    dvbpsi_DeletePSISections(p_section);
+    if ((i_sections < 3) || (i_last_number != i_sections - 1))
+    {
+        fprintf(stderr, "%s fits in %d sections\n", psz_table, i_sections);
+        return false;
+    }
+    return true;
+}
+
+static bool pmt_round_trip(dvbpsi_t *p_dvbpsi, dvb_decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[255];
+    bool b_ok = false;
+
+    dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(0x0105, 3, true, 0x0100);
+    if (p_pmt == NULL)
+        return false;
+    p_data[0] = 0x12;
+    if (!dvbpsi_pmt_descriptor_add(p_pmt, 0x09, 1, p_data))
+        goto out;
+    for (int i = 0; i < DVB_ENTRIES; i++)
+    {
+        dvbpsi_pmt_es_t *p_es = dvbpsi_pmt_es_add(p_pmt, 0x02 + i % 4, 0x0101 + i);
+        if (p_es == NULL)
+            goto out;
+        for (int j = 0; j < DVB_DESCRIPTORS; j++)
+        {
+            uint8_t i_length = entry_descriptor(i, j, p_data);
+            if (!dvbpsi_pmt_es_descriptor_add(p_es, 0x80 + j, i_length, p_data))
+                goto out;
+        }
+    }
+
+    if (!dvb_sections(p_dvbpsi, dvbpsi_pmt_sections_generate(p_dvbpsi, p_pmt), p_cc, "PMT"))
+        goto out;
+
+    dvbpsi_pmt_t *p_got = p_decoded->p_pmt;
+    if ((p_got == NULL) || (p_got->i_program_number != p_pmt->i_program_number) ||
+        (p_got->i_version != p_pmt->i_version) || (p_got->i_pcr_pid != p_pmt->i_pcr_pid) ||
+        !descriptor_equal(p_got->p_first_descriptor, p_pmt->p_first_descriptor))
+        goto out;
+
+    int i_entries = 0;
+    dvbpsi_pmt_es_t *p_a = p_pmt->p_first_es, *p_b = p_got->p_first_es;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_entries++)
+    {
+        if ((p_a->i_type != p_b->i_type) || (p_a->i_pid != p_b->i_pid) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_entries == DVB_ENTRIES);
+out:
+    dvbpsi_pmt_delete(p_pmt);
+    return b_ok;
+}
+
+static bool nit_round_trip(dvbpsi_t *p_dvbpsi, dvb_decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[255];
+    bool b_ok = false;
+
+    dvbpsi_nit_t *p_nit = dvbpsi_nit_new(0x40, 0x3001, 0x3001, 9, true);
+    if (p_nit == NULL)
+        return false;
+    memcpy(p_data, "network", 7);
+    if (!dvbpsi_nit_descriptor_add(p_nit, 0x40, 7, p_data))
+        goto out;
+    for (int i = 0; i < DVB_ENTRIES; i++)
+    {
+        dvbpsi_nit_ts_t *p_ts = dvbpsi_nit_ts_add(p_nit, 0x0201 + i, 0x3001);
+        if (p_ts == NULL)
+            goto out;
+        for (int j = 0; j < DVB_DESCRIPTORS; j++)
+        {
+            uint8_t i_length = entry_descriptor(i, j, p_data);
+            if (!dvbpsi_nit_ts_descriptor_add(p_ts, 0x80 + j, i_length, p_data))
+                goto out;
+        }
+    }
+
+    if (!dvb_sections(p_dvbpsi, dvbpsi_nit_sections_generate(p_dvbpsi, p_nit, 0x40), p_cc, "NIT"))
+        goto out;
+
+    dvbpsi_nit_t *p_got = p_decoded->p_nit;
+    if ((p_got == NULL) || (p_got->i_network_id != p_nit->i_network_id) ||
+        (p_got->i_version != p_nit->i_version) ||
+        !descriptor_equal(p_got->p_first_descriptor, p_nit->p_first_descriptor))
+        goto out;
+
+    int i_entries = 0;
+    dvbpsi_nit_ts_t *p_a = p_nit->p_first_ts, *p_b = p_got->p_first_ts;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_entries++)
+    {
+        if ((p_a->i_ts_id != p_b->i_ts_id) || (p_a->i_orig_network_id != p_b->i_orig_network_id) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_entries == DVB_ENTRIES);
+out:
+    dvbpsi_nit_delete(p_nit);
+    return b_ok;
+}
+
+static bool bat_round_trip(dvbpsi_t *p_dvbpsi, dvb_decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[255];
+    bool b_ok = false;
+
+    dvbpsi_bat_t *p_bat = dvbpsi_bat_new(0x4A, 0x4001, 2, true);
+    if (p_bat == NULL)
+        return false;
+    memcpy(p_data, "bouquet", 7);
+    if (!dvbpsi_bat_bouquet_descriptor_add(p_bat, 0x47, 7, p_data))
+        goto out;
+    for (int i = 0; i < DVB_ENTRIES; i++)
+    {
+        dvbpsi_bat_ts_t *p_ts = dvbpsi_bat_ts_add(p_bat, 0x0201 + i, 0x3001);
+        if (p_ts == NULL)
+            goto out;
+        for (int j = 0; j < DVB_DESCRIPTORS; j++)
+        {
+            uint8_t i_length = entry_descriptor(i, j, p_data);
+            if (!dvbpsi_bat_ts_descriptor_add(p_ts, 0x80 + j, i_length, p_data))
+                goto out;
+        }
+    }
+
+    if (!dvb_sections(p_dvbpsi, dvbpsi_bat_sections_generate(p_dvbpsi, p_bat), p_cc, "BAT"))
+        goto out;
+
+    dvbpsi_bat_t *p_got = p_decoded->p_bat;
+    if ((p_got == NULL) || (p_got->i_extension != p_bat->i_extension) ||
+        (p_got->i_version != p_bat->i_version) ||
+        !descriptor_equal(p_got->p_first_descriptor, p_bat->p_first_descriptor))
+        goto out;
+
+    int i_entries = 0;
+    dvbpsi_bat_ts_t *p_a = p_bat->p_first_ts, *p_b = p_got->p_first_ts;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_entries++)
+    {
+        if ((p_a->i_ts_id != p_b->i_ts_id) || (p_a->i_orig_network_id != p_b->i_orig_network_id) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_entries == DVB_ENTRIES);
+out:
+    dvbpsi_bat_delete(p_bat);
+    return b_ok;
+}
+
+static bool sdt_round_trip(dvbpsi_t *p_dvbpsi, dvb_decoded_t *p_decoded, uint8_t *p_cc)
+{
+    uint8_t p_data[255];
+    bool b_ok = false;
+
+    dvbpsi_sdt_t *p_sdt = dvbpsi_sdt_new(0x42, 0x0201, 6, true, 0x3001);
+    if (p_sdt == NULL)
+        return false;
+    for (int i = 0; i < DVB_ENTRIES; i++)
+    {
+        dvbpsi_sdt_service_t *p_service =
+            dvbpsi_sdt_service_add(p_sdt, 0x0301 + i, i & 1, i & 2, 4, false);
+        if (p_service == NULL)
+            goto out;
+        for (int j = 0; j < DVB_DESCRIPTORS; j++)
+        {
+            uint8_t i_length = entry_descriptor(i, j, p_data);
+            if (!dvbpsi_sdt_service_descriptor_add(p_service, 0x80 + j, i_length, p_data))
+                goto out;
+        }
+    }
+
+    if (!dvb_sections(p_dvbpsi, dvbpsi_sdt_sections_generate(p_dvbpsi, p_sdt), p_cc, "SDT"))
+        goto out;
+
+    dvbpsi_sdt_t *p_got = p_decoded->p_sdt;
+    if ((p_got == NULL) || (p_got->i_extension != p_sdt->i_extension) ||
+        (p_got->i_version != p_sdt->i_version) || (p_got->i_network_id != p_sdt->i_network_id))
+        goto out;
+
+    int i_entries = 0;
+    dvbpsi_sdt_service_t *p_a = p_sdt->p_first_service, *p_b = p_got->p_first_service;
+    for (; p_a && p_b; p_a = p_a->p_next, p_b = p_b->p_next, i_entries++)
+    {
+        if ((p_a->i_service_id != p_b->i_service_id) ||
+            (p_a->b_eit_schedule != p_b->b_eit_schedule) ||
+            (p_a->b_eit_present != p_b->b_eit_present) ||
+            (p_a->i_running_status != p_b->i_running_status) ||
+            !descriptor_equal(p_a->p_first_descriptor, p_b->p_first_descriptor))
+            goto out;
+    }
+    b_ok = (p_a == NULL) && (p_b == NULL) && (i_entries == DVB_ENTRIES);
+out:
+    dvbpsi_sdt_delete(p_sdt);
+    return b_ok;
+}
+
+static int run_dvb_round_trip_test(void)
+{
+    dvb_decoded_t decoded = { NULL, NULL, NULL, NULL, 0 };
+    uint8_t i_cc = 0;
+    int i_ret = 1;
+
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    if (p_dvbpsi == NULL)
+        return 1;
+    if (!dvbpsi_chain_demux_new(p_dvbpsi, NewDVBSubtable, DelDVBSubtable, &decoded))
+    {
+        dvbpsi_delete(p_dvbpsi);
+        return 1;
+    }
+
+    if (!pmt_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("PMT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("PMT multi-section round trip");
+
+    if (!nit_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("NIT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("NIT multi-section round trip");
+
+    if (!bat_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("BAT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("BAT multi-section round trip");
+
+    if (!sdt_round_trip(p_dvbpsi, &decoded, &i_cc)) {
+        TEST_FAILED("SDT multi-section round trip");
+        goto out;
+    }
+    TEST_PASSED("SDT multi-section round trip");
+
+    if (decoded.i_tables != 4) {
+        TEST_FAILED("DVB tables signalled once");
+        goto out;
+    }
+    i_ret = 0;
+    fprintf(stderr, "ALL DVB ROUND TRIP TESTS PASSED\n");
+
+out:
+    if (!dvbpsi_chain_demux_delete(p_dvbpsi))
+        fprintf(stderr, "Failed to cleanup chain_demux\n");
+    dvbpsi_delete(p_dvbpsi);
+    if (decoded.p_pmt) dvbpsi_pmt_delete(decoded.p_pmt);
+    if (decoded.p_nit) dvbpsi_nit_delete(decoded.p_nit);
+    if (decoded.p_bat) dvbpsi_bat_delete(decoded.p_bat);
+    if (decoded.p_sdt) dvbpsi_sdt_delete(decoded.p_sdt);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_atsc_round_trip_test() != 0)
+        return 1;
+    if (run_eit_segment_test() != 0)
+        return 1;
+    if (run_dvb_round_trip_test() != 0)
+        return 1;
+
+    return 0;
+}
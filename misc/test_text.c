@@ -0,0 +1,340 @@
+/*****************************************************************************
+ * test_text.c: DVB and ATSC strings converted to UTF-8
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/descriptor.h"
+#include "../src/text.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/text.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+#define OUT_SIZE 256
+
+/* A raw string and its UTF-8 conversion, NULL when the conversion fails */
+typedef struct
+{
+    const char *psz_name;
+    const char *p_raw;
+    size_t      i_length;
+    const char *psz_utf8;
+} text_case_t;
+
+#define RAW(s) (s), sizeof(s) - 1
+
+/* ETSI EN 300 468 annex A */
+static const text_case_t dvb_cases[] =
+{
+    { "ISO 6937 plain ASCII",
+      RAW("Hello World"), "Hello World" },
+    /* acute, cedilla, ring and a diaeresis on a digit, which has no
+     * precomposed form, then the euro sign, a soft hyphen, CR/LF and an
+     * emphasis */
+    { "ISO 6937 diacritic composition",
+      RAW("Caf\xc2" "e \xcb" "c \xca" "A \xc8" "1 \xa4\x8a\x86x\x87"),
+      "Caf\xc3\xa9 \xc3\xa7 \xc3\x85 1\xcc\x88 \xe2\x82\xac\nx" },
+    { "ISO 8859-5 selected by 0x01",
+      RAW("\x01\xb0\xb1"), "\xd0\x90\xd0\x91" },
+    { "ISO 8859-2 selected by 0x10 0x00 0x02",
+      RAW("\x10\x00\x02\xa1z"), "\xc4\x84z" },
+    { "ISO 8859-7 selected by 0x03",
+      RAW("\x03\xe1\xe2"), "\xce\xb1\xce\xb2" },
+    { "ISO 8859-12 does not exist",
+      RAW("\x10\x00\x0c\xa1"), NULL },
+    { "KS X 1001 is not supported",
+      RAW("\x12\x41"), NULL },
+    { "reserved table 0x08",
+      RAW("\x08\xa1"), NULL },
+    /* A, emphasis, B, CR/LF then U+1F600 as a surrogate pair */
+    { "ISO 10646 BMP with a surrogate pair",
+      RAW("\x11\x00\x41\xe0\x86\x00\x42\xe0\x8a\xd8\x3d\xde\x00"),
+      "AB\n\xf0\x9f\x98\x80" },
+    { "ISO 10646 BMP lone surrogate",
+      RAW("\x11\xd8\x3d\x00\x41"), "\xef\xbf\xbd" "A" },
+    { "UTF-8 with an emphasis and an invalid byte",
+      RAW("\x15" "a\xee\x82\x86\xc3\xa9\xff"), "a\xc3\xa9\xef\xbf\xbd" },
+    { "empty string",
+      RAW(""), "" },
+};
+
+/* ATSC A/65 multiple string structure: French then English, the English
+ * string in three segments: mode 0x00 Latin-1, mode 0x3f UTF-16 and mode
+ * 0x01 for the U+01xx page */
+static const uint8_t mss[] =
+{
+    2,
+    'f', 'r', 'a', 1, 0x00, 0x00, 3, 'a', 'b', 'c',
+    'e', 'n', 'g', 3, 0x00, 0x00, 2, 'h', 0xe9,
+                      0x00, 0x3f, 2, 0x20, 0xac,
+                      0x00, 0x01, 1, 0x10,
+};
+
+/* Huffman compressed segment, then an uncompressed one */
+static const uint8_t mss_huffman[] =
+{
+    1,
+    'e', 'n', 'g', 2, 0x01, 0x00, 1, 0x80,
+                      0x00, 0x00, 1, 'Z',
+};
+
+/* Latin-1 with bytes that are DVB control codes: C1 controls in ATSC */
+static const uint8_t mss_c1[] =
+{
+    1,
+    'e', 'n', 'g', 1, 0x00, 0x00, 4, 'a', 0x8a, 0x86, 'b',
+};
+
+/* Unsupported mode 0x40 */
+static const uint8_t mss_mode[] =
+{
+    1,
+    'e', 'n', 'g', 2, 0x00, 0x40, 1, 'a',
+                      0x00, 0x00, 1, 'Z',
+};
+
+typedef struct
+{
+    const char    *psz_name;
+    const uint8_t *p_mss;
+    size_t         i_length;
+    const char    *psz_language;
+    ssize_t        i_ret;
+    const char    *psz_utf8;
+} atsc_case_t;
+
+static const atsc_case_t atsc_cases[] =
+{
+    { "ATSC string of a language",      mss, sizeof(mss), "eng", 8,
+      "h\xc3\xa9\xe2\x82\xac\xc4\x90" },
+    { "ATSC first string",              mss, sizeof(mss), NULL,  3, "abc" },
+    { "ATSC missing language",          mss, sizeof(mss), "spa", 3, "abc" },
+    { "ATSC Huffman without tables",    mss_huffman, sizeof(mss_huffman), NULL, -1, "Z" },
+    { "ATSC mode 0x00 without DVB control codes", mss_c1, sizeof(mss_c1), NULL, 6,
+      "a\xc2\x8a\xc2\x86" "b" },
+    { "ATSC unsupported mode",          mss_mode, sizeof(mss_mode), NULL, -1, "Z" },
+    { "ATSC segment cut by the end",    mss, 9, NULL, 1, "a" },
+};
+
+static bool check_conversion(const char *psz_name, const ssize_t i_ret,
+                             const ssize_t i_expected_ret, const char *psz_out,
+                             const char *psz_expected)
+{
+    if ((i_ret != i_expected_ret) || (psz_expected && strcmp(psz_out, psz_expected)))
+    {
+        fprintf(stderr, "returned %zd, expected %zd\n", i_ret, i_expected_ret);
+        TEST_FAILED(psz_name);
+        return false;
+    }
+    TEST_PASSED(psz_name);
+    return true;
+}
+
+/*****************************************************************************
+ * run_text_dvb_test
+ *****************************************************************************/
+static int run_text_dvb_test(void)
+{
+    char out[OUT_SIZE];
+
+    const int i_cases = sizeof(dvb_cases) / sizeof(dvb_cases[0]);
+    for (int i = 0; i < i_cases; i++)
+    {
+        const text_case_t *p_case = &dvb_cases[i];
+        const ssize_t i_ret = dvbpsi_text_dvb_to_utf8((const uint8_t *)p_case->p_raw,
+                                                      p_case->i_length, out, sizeof(out));
+        const ssize_t i_expected = p_case->psz_utf8 ? (ssize_t)strlen(p_case->psz_utf8) : -1;
+        if (!check_conversion(p_case->psz_name, i_ret, i_expected, out, p_case->psz_utf8))
+            return 1;
+    }
+
+    /* Too small buffers cut between two characters */
+    if ((dvbpsi_text_dvb_to_utf8((const uint8_t *)"\xc2" "e\xc2" "e", 4, out, 4) != 2) ||
+        strcmp(out, "\xc3\xa9") ||
+        (dvbpsi_text_dvb_to_utf8((const uint8_t *)"abcdefghij", 10, out, 6) != 5) ||
+        strcmp(out, "abcde") ||
+        (dvbpsi_text_dvb_to_utf8((const uint8_t *)"ab", 2, NULL, 0) != 0))
+    {
+        TEST_FAILED("truncation");
+        return 1;
+    }
+    TEST_PASSED("truncation");
+    return 0;
+}
+
+/*****************************************************************************
+ * run_text_atsc_test
+ *****************************************************************************/
+static int run_text_atsc_test(void)
+{
+    char out[OUT_SIZE];
+
+    const int i_cases = sizeof(atsc_cases) / sizeof(atsc_cases[0]);
+    for (int i = 0; i < i_cases; i++)
+    {
+        const atsc_case_t *p_case = &atsc_cases[i];
+        const ssize_t i_ret = dvbpsi_text_atsc_to_utf8(NULL, p_case->p_mss, p_case->i_length,
+                                    (const uint8_t *)p_case->psz_language, out, sizeof(out));
+        if (!check_conversion(p_case->psz_name, i_ret, p_case->i_ret, out, p_case->psz_utf8))
+            return 1;
+    }
+
+    /* A decode tree shared by every prior symbol: node 0 is 'a' or node 1,
+     * node 1 'b' or node 2, node 2 the terminator or the escape */
+    uint8_t table[256 + 6];
+    for (int i = 0; i < 128; i++)
+    {
+        table[2 * i] = 0x01;
+        table[2 * i + 1] = 0x00;
+    }
+    table[256] = 0x80 | 'a';
+    table[257] = 1;
+    table[258] = 0x80 | 'b';
+    table[259] = 2;
+    table[260] = 0x80;
+    table[261] = 0x80 | 27;
+
+    /* a = 0, b = 10, escape = 111 then 0xe9, a = 0, terminator = 110 */
+    const uint8_t mss_tree[] = { 1, 'e', 'n', 'g', 1, 0x01, 0x00, 3, 0x5f, 0xa5, 0x80 };
+
+    int i_ret = 1;
+    dvbpsi_text_t *p_text = dvbpsi_text_new();
+    if (p_text == NULL)
+        return 1;
+    if (!dvbpsi_text_atsc_huffman_set(p_text, 0x01, table, sizeof(table)) ||
+        dvbpsi_text_atsc_huffman_set(p_text, 0x03, table, sizeof(table)) ||
+        dvbpsi_text_atsc_huffman_set(p_text, 0x01, table, 200))
+    {
+        TEST_FAILED("dvbpsi_text_atsc_huffman_set");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_text_atsc_huffman_set");
+
+    if (!check_conversion("ATSC Huffman with tables",
+                          dvbpsi_text_atsc_to_utf8(p_text, mss_tree, sizeof(mss_tree),
+                                                   NULL, out, sizeof(out)),
+                          5, out, "ab\xc3\xa9" "a"))
+        goto out;
+
+    i_ret = 0;
+out:
+    dvbpsi_text_delete(p_text);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * run_text_intern_test
+ *****************************************************************************/
+static int run_text_intern_test(void)
+{
+    dvbpsi_text_stats_t stats;
+    int i_ret = 1;
+
+    dvbpsi_text_t *p_text = dvbpsi_text_new();
+    if (p_text == NULL)
+        return 1;
+
+    const char *psz_first = dvbpsi_text_dvb_intern(p_text, (const uint8_t *)"\xc2" "ecole", 6);
+    for (int i = 0; i < 1000; i++)
+    {
+        char psz_title[16];
+        const int i_length = snprintf(psz_title, sizeof(psz_title), "title %d", i);
+        if (dvbpsi_text_dvb_intern(p_text, (const uint8_t *)psz_title, i_length) == NULL)
+            psz_first = NULL;
+    }
+    const char *psz_again = dvbpsi_text_dvb_intern(p_text, (const uint8_t *)"\xc2" "ecole", 6);
+    dvbpsi_text_stats(p_text, &stats);
+    if ((psz_first == NULL) || strcmp(psz_first, "\xc3\xa9" "cole") ||
+        (psz_again != psz_first) || (stats.i_hits != 1) || (stats.i_strings != 1001))
+    {
+        TEST_FAILED("dvbpsi_text_dvb_intern");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_text_dvb_intern");
+
+    /* The language is part of the key, undecodable strings are not held */
+    const char *psz_eng = dvbpsi_text_atsc_intern(p_text, mss, sizeof(mss),
+                                                  (const uint8_t *)"eng");
+    const char *psz_fra = dvbpsi_text_atsc_intern(p_text, mss, sizeof(mss), NULL);
+    if ((psz_eng == NULL) || (psz_fra == NULL) || strcmp(psz_fra, "abc") ||
+        (dvbpsi_text_atsc_intern(p_text, mss_huffman, sizeof(mss_huffman), NULL) != NULL) ||
+        (dvbpsi_text_dvb_intern(p_text, (const uint8_t *)"\x12x", 2) != NULL))
+    {
+        TEST_FAILED("dvbpsi_text_atsc_intern");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_text_atsc_intern");
+
+    dvbpsi_text_flush(p_text);
+    dvbpsi_text_stats(p_text, &stats);
+    if ((stats.i_strings != 0) ||
+        (dvbpsi_text_dvb_intern(p_text, (const uint8_t *)"x", 1) == NULL))
+    {
+        TEST_FAILED("dvbpsi_text_flush");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_text_flush");
+
+    i_ret = 0;
+out:
+    dvbpsi_text_delete(p_text);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_text_dvb_test() != 0)
+        return 1;
+    if (run_text_atsc_test() != 0)
+        return 1;
+    if (run_text_intern_test() != 0)
+        return 1;
+
+    fprintf(stderr, "ALL TEXT TESTS PASSED\n");
+    return 0;
+}
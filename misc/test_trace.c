@@ -0,0 +1,411 @@
+/*****************************************************************************
+ * test_trace.c: latency tracing hooks of dvbpsi_packet_push()
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/descriptor.h"
+#include "../src/trace.h"
+#include "../src/tables/pat.h"
+#include "../src/tables/pmt.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/trace.h>
+#include <dvbpsi/pat.h>
+#include <dvbpsi/pmt.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+/* automake's exit status of a skipped test */
+#define TEST_SKIPPED 77
+
+#define PAT_PID     0x0000
+#define PMT_PID     0x0100
+#define MAX_EVENTS  64
+
+/* One hook call */
+typedef struct
+{
+    bool                 b_end;
+    dvbpsi_trace_stage_t i_stage;
+    uint16_t             i_pid;
+    uint8_t              i_table_id;
+    uint16_t             i_extension;
+} trace_call_t;
+
+typedef struct
+{
+    trace_call_t calls[MAX_EVENTS];
+    int          i_calls;
+} trace_log_t;
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+    switch(level)
+    {
+        case DVBPSI_MSG_ERROR: fprintf(stderr, "Error: "); break;
+        case DVBPSI_MSG_WARN:  fprintf(stderr, "Warning: "); break;
+        case DVBPSI_MSG_DEBUG: fprintf(stderr, "Debug: "); break;
+        default: /* do nothing */
+            return;
+    }
+    fprintf(stderr, "%s\n", msg);
+}
+
+static void log_call(trace_log_t *p_log, const bool b_end, const dvbpsi_trace_event_t *p_event)
+{
+    if (p_log->i_calls >= MAX_EVENTS)
+        return;
+
+    trace_call_t *p_call = &p_log->calls[p_log->i_calls++];
+    p_call->b_end = b_end;
+    p_call->i_stage = p_event->i_stage;
+    p_call->i_pid = p_event->i_pid;
+    p_call->i_table_id = p_event->i_table_id;
+    p_call->i_extension = p_event->i_extension;
+}
+
+static void TraceBegin(void *p_cb_data, const dvbpsi_trace_event_t *p_event)
+{
+    log_call((trace_log_t *)p_cb_data, false, p_event);
+}
+
+static void TraceEnd(void *p_cb_data, const dvbpsi_trace_event_t *p_event)
+{
+    log_call((trace_log_t *)p_cb_data, true, p_event);
+}
+
+static void GotPAT(void *p_priv, dvbpsi_pat_t *p_pat)
+{
+    (*(int *)p_priv)++;
+    dvbpsi_pat_delete(p_pat);
+}
+
+static void GotPMT(void *p_priv, dvbpsi_pmt_t *p_pmt)
+{
+    (*(int *)p_priv)++;
+    dvbpsi_pmt_delete(p_pmt);
+}
+
+/* Packetize one section on a PID, returns the number of packets */
+static int packetize(const dvbpsi_psi_section_t *p_section, const uint16_t i_pid,
+                     uint8_t *p_cc, uint8_t p_packets[][188], const int i_max)
+{
+    const uint8_t *p_data = p_section->p_data;
+    size_t i_size = p_section->p_payload_end - p_section->p_data + 4;
+    int i_packets = 0;
+
+    while ((i_size > 0) && (i_packets < i_max))
+    {
+        uint8_t *p = p_packets[i_packets];
+        size_t i_pos = 4;
+
+        memset(p, 0xff, 188);
+        p[0] = 0x47;
+        p[1] = (i_packets == 0 ? 0x40 : 0x00) | (i_pid >> 8);
+        p[2] = i_pid & 0xff;
+        p[3] = 0x10 | (*p_cc & 0x0f);
+        if (i_packets == 0)
+            p[i_pos++] = 0x00; /* pointer_field */
+
+        size_t i_copy = 188 - i_pos;
+        if (i_copy > i_size)
+            i_copy = i_size;
+        memcpy(p + i_pos, p_data, i_copy);
+        p_data += i_copy;
+        i_size -= i_copy;
+
+        *p_cc = *p_cc + 1;
+        i_packets++;
+    }
+    return i_packets;
+}
+
+/* Stages of a complete section whose table completes, after its first packet */
+static const dvbpsi_trace_stage_t ai_section_stages[] =
+{
+    DVBPSI_TRACE_REASSEMBLY, DVBPSI_TRACE_CRC, DVBPSI_TRACE_CRC,
+    DVBPSI_TRACE_GATHER, DVBPSI_TRACE_DECODE, DVBPSI_TRACE_DECODE,
+    DVBPSI_TRACE_CALLBACK, DVBPSI_TRACE_CALLBACK, DVBPSI_TRACE_GATHER
+};
+static const bool ab_section_ends[] =
+{
+    true, false, true, false, false, true, false, true, true
+};
+
+/* Check calls[i_first...] against the stages of a complete table */
+static bool check_section(const trace_log_t *p_log, const int i_first,
+                          const uint16_t i_pid, const uint8_t i_table_id,
+                          const uint16_t i_extension)
+{
+    const int i_count = sizeof(ai_section_stages) / sizeof(ai_section_stages[0]);
+
+    if (i_first + i_count > p_log->i_calls)
+        return false;
+    for (int i = 0; i < i_count; i++)
+    {
+        const trace_call_t *p_call = &p_log->calls[i_first + i];
+        if ((p_call->b_end != ab_section_ends[i]) ||
+            (p_call->i_stage != ai_section_stages[i]) ||
+            (p_call->i_pid != i_pid) ||
+            (p_call->i_table_id != i_table_id) ||
+            (p_call->i_extension != i_extension))
+        {
+            fprintf(stderr, "call %d: %s %s pid 0x%x table 0x%x ext %d\n", i_first + i,
+                    p_call->b_end ? "end" : "begin", dvbpsi_trace_stage_name(p_call->i_stage),
+                    p_call->i_pid, p_call->i_table_id, p_call->i_extension);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_reassembly_begin(const trace_log_t *p_log, const int i_call,
+                                   const uint16_t i_pid)
+{
+    if (i_call >= p_log->i_calls)
+        return false;
+
+    const trace_call_t *p_call = &p_log->calls[i_call];
+    return !p_call->b_end && (p_call->i_stage == DVBPSI_TRACE_REASSEMBLY) &&
+           (p_call->i_pid == i_pid) && (p_call->i_table_id == 0xff) &&
+           (p_call->i_extension == 0);
+}
+
+static uint64_t histogram_count(const dvbpsi_trace_histogram_t *p_histogram,
+                                const dvbpsi_trace_stage_t i_stage)
+{
+    uint64_t i_count = 0;
+    for (unsigned int b = 0; b < DVBPSI_TRACE_BUCKETS; b++)
+        i_count += p_histogram->ai_count[i_stage][b];
+    return i_count;
+}
+
+/*****************************************************************************
+ * run_trace_test
+ *****************************************************************************
+ * A PAT on PID 0 pushed between the two packets of a PMT on PID 0x100, to
+ * two handles sharing the same hooks: the events of each table must come
+ * in stage order and carry the PID of the packet being pushed.
+ *****************************************************************************/
+static int run_trace_test(void)
+{
+    uint8_t pat_packets[2][188], pmt_packets[2][188], bad_packets[2][188];
+    int i_pats = 0, i_pmts = 0;
+    uint8_t i_pat_cc = 0, i_pmt_cc = 0;
+    trace_log_t log;
+    bool b_attached = false;
+    int i_ret = 1;
+
+    dvbpsi_t *p_pat_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    dvbpsi_t *p_pmt_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_WARN);
+    if ((p_pat_dvbpsi == NULL) || (p_pmt_dvbpsi == NULL))
+        goto out;
+
+    const dvbpsi_trace_t trace = { TraceBegin, TraceEnd, &log };
+    if (!dvbpsi_trace_set(p_pat_dvbpsi, &trace))
+    {
+        fprintf(stderr, "libdvbpsi built without --enable-trace\n");
+        i_ret = TEST_SKIPPED;
+        goto out;
+    }
+    dvbpsi_trace_set(p_pmt_dvbpsi, &trace);
+
+    if (!dvbpsi_pat_attach(p_pat_dvbpsi, 0x00, 0x0001, GotPAT, &i_pats) ||
+        !dvbpsi_pmt_attach(p_pmt_dvbpsi, 0x02, 0x0001, GotPMT, &i_pmts))
+    {
+        TEST_FAILED("decoders attach");
+        goto out;
+    }
+    b_attached = true;
+
+    /* Two versions of a PAT, the second one with a bad CRC_32, and a PMT
+     * long enough for two packets */
+    dvbpsi_psi_section_t *p_section;
+    int i_pat_packets = 0, i_bad_packets = 0, i_pmt_packets = 0;
+    for (int v = 0; v < 2; v++)
+    {
+        dvbpsi_pat_t *p_pat = dvbpsi_pat_new(0x0001, v, true);
+        dvbpsi_pat_program_add(p_pat, 1, PMT_PID);
+        p_section = dvbpsi_pat_sections_generate(p_pat_dvbpsi, p_pat, 253);
+        dvbpsi_pat_delete(p_pat);
+        if (p_section == NULL)
+            goto out;
+        if (v == 0)
+            i_pat_packets = packetize(p_section, PAT_PID, &i_pat_cc, pat_packets, 2);
+        else
+        {
+            p_section->p_payload_end[1] ^= 0x5a;
+            i_bad_packets = packetize(p_section, PAT_PID, &i_pat_cc, bad_packets, 2);
+        }
+        dvbpsi_DeletePSISections(p_section);
+    }
+
+    dvbpsi_pmt_t *p_pmt = dvbpsi_pmt_new(0x0001, 0, true, 0x101);
+    for (int i = 0; i < 40; i++)
+        dvbpsi_pmt_es_add(p_pmt, 0x1b, 0x101 + i);
+    p_section = dvbpsi_pmt_sections_generate(p_pmt_dvbpsi, p_pmt);
+    dvbpsi_pmt_delete(p_pmt);
+    if (p_section == NULL)
+        goto out;
+    i_pmt_packets = packetize(p_section, PMT_PID, &i_pmt_cc, pmt_packets, 2);
+    dvbpsi_DeletePSISections(p_section);
+
+    if ((i_pat_packets != 1) || (i_bad_packets != 1) || (i_pmt_packets != 2))
+    {
+        TEST_FAILED("test stream");
+        goto out;
+    }
+
+    /* Event sequence of interleaved PIDs */
+    memset(&log, 0, sizeof(log));
+    dvbpsi_packet_push(p_pmt_dvbpsi, pmt_packets[0]);
+    dvbpsi_packet_push(p_pat_dvbpsi, pat_packets[0]);
+    dvbpsi_packet_push(p_pmt_dvbpsi, pmt_packets[1]);
+
+    if ((i_pats != 1) || (i_pmts != 1) || (log.i_calls != 2 * 10) ||
+        !check_reassembly_begin(&log, 0, PMT_PID) ||
+        !check_reassembly_begin(&log, 1, PAT_PID) ||
+        !check_section(&log, 2, PAT_PID, 0x00, 0x0001) ||
+        !check_section(&log, 11, PMT_PID, 0x02, 0x0001))
+    {
+        fprintf(stderr, "%d PAT, %d PMT, %d calls\n", i_pats, i_pmts, log.i_calls);
+        TEST_FAILED("trace event sequence");
+        goto out;
+    }
+    TEST_PASSED("trace events in stage order, with the PID of each packet");
+
+    /* A bad CRC_32 stops after the CRC stage */
+    memset(&log, 0, sizeof(log));
+    dvbpsi_packet_push(p_pat_dvbpsi, bad_packets[0]);
+    if ((i_pats != 1) || (log.i_calls != 4) ||
+        !check_reassembly_begin(&log, 0, PAT_PID) ||
+        !log.calls[1].b_end || (log.calls[1].i_stage != DVBPSI_TRACE_REASSEMBLY) ||
+        log.calls[2].b_end || (log.calls[2].i_stage != DVBPSI_TRACE_CRC) ||
+        !log.calls[3].b_end || (log.calls[3].i_stage != DVBPSI_TRACE_CRC))
+    {
+        fprintf(stderr, "%d calls\n", log.i_calls);
+        TEST_FAILED("trace of a bad CRC_32");
+        goto out;
+    }
+    TEST_PASSED("trace of a bad CRC_32 stops at the CRC stage");
+
+    /* Removed hooks are not called any more */
+    memset(&log, 0, sizeof(log));
+    dvbpsi_trace_set(p_pat_dvbpsi, NULL);
+    bad_packets[0][3] = 0x10 | (i_pat_cc++ & 0x0f);
+    dvbpsi_packet_push(p_pat_dvbpsi, bad_packets[0]);
+    if (log.i_calls != 0)
+    {
+        TEST_FAILED("trace hooks removal");
+        goto out;
+    }
+    TEST_PASSED("trace hooks removal");
+
+    /* One histogram shared by both handles: the reassembly of the PMT is
+     * timed across the PAT because it is keyed by i_pid */
+    dvbpsi_trace_histogram_t *p_histogram = malloc(sizeof(dvbpsi_trace_histogram_t));
+    if (p_histogram == NULL)
+        goto out;
+    dvbpsi_trace_t histogram_trace;
+    dvbpsi_trace_histogram_init(p_histogram, &histogram_trace);
+    dvbpsi_trace_set(p_pat_dvbpsi, &histogram_trace);
+    dvbpsi_trace_set(p_pmt_dvbpsi, &histogram_trace);
+
+    for (int i = 0; i < 2; i++)
+    {
+        pat_packets[0][3] = 0x10 | (i_pat_cc++ & 0x0f);
+        pmt_packets[0][3] = 0x10 | (i_pmt_cc++ & 0x0f);
+        pmt_packets[1][3] = 0x10 | (i_pmt_cc++ & 0x0f);
+        dvbpsi_packet_push(p_pmt_dvbpsi, pmt_packets[0]);
+        dvbpsi_packet_push(p_pat_dvbpsi, pat_packets[0]);
+        dvbpsi_packet_push(p_pmt_dvbpsi, pmt_packets[1]);
+    }
+
+    /* Both tables were already signalled with the log hooks, the same
+     * versions do not reach the decode and callback stages again */
+    bool b_counted = (histogram_count(p_histogram, DVBPSI_TRACE_REASSEMBLY) == 4) &&
+                     (histogram_count(p_histogram, DVBPSI_TRACE_CRC) == 4) &&
+                     (histogram_count(p_histogram, DVBPSI_TRACE_GATHER) == 4) &&
+                     (histogram_count(p_histogram, DVBPSI_TRACE_DECODE) == 0) &&
+                     (histogram_count(p_histogram, DVBPSI_TRACE_CALLBACK) == 0);
+    if (!b_counted)
+        dvbpsi_trace_histogram_dump(p_histogram, stderr);
+    free(p_histogram);
+    if (!b_counted)
+    {
+        TEST_FAILED("trace histogram per PID");
+        goto out;
+    }
+    TEST_PASSED("trace histogram times each PID on its own");
+
+    i_ret = 0;
+    fprintf(stderr, "ALL TRACE TESTS PASSED\n");
+
+out:
+    if (b_attached)
+    {
+        dvbpsi_pat_detach(p_pat_dvbpsi, 0x00, 0x0001);
+        dvbpsi_pmt_detach(p_pmt_dvbpsi, 0x02, 0x0001);
+    }
+    if (p_pat_dvbpsi)
+        dvbpsi_delete(p_pat_dvbpsi);
+    if (p_pmt_dvbpsi)
+        dvbpsi_delete(p_pmt_dvbpsi);
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    int i_ret = run_trace_test();
+    if (i_ret == TEST_SKIPPED)
+        return TEST_SKIPPED;
+    if (i_ret != 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,542 @@
+/*****************************************************************************
+ * test_ts.c: TS packet helpers test
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+/* the libdvbpsi distribution defines DVBPSI_DIST */
+#ifdef DVBPSI_DIST
+#include "../src/dvbpsi.h"
+#include "../src/psi.h"
+#include "../src/ts.h"
+#include "../src/tables/pat.h"
+#else
+#include <dvbpsi/dvbpsi.h>
+#include <dvbpsi/psi.h>
+#include <dvbpsi/ts.h>
+#include <dvbpsi/pat.h>
+#endif
+
+#define TEST_PASSED(msg) fprintf(stderr, "test %s -- PASSED\n", (msg));
+#define TEST_FAILED(msg) fprintf(stderr, "test %s -- FAILED\n", (msg));
+
+/* Deterministic pseudo random numbers, the same on every platform */
+static uint32_t i_seed = 0x12345678;
+static uint32_t test_rand(void)
+{
+    i_seed = i_seed * 1103515245 + 12345;
+    return i_seed >> 8;
+}
+
+/* Fill with bytes that are never a sync byte */
+static void fill_noise(uint8_t *p_buf, const size_t i_length)
+{
+    for (size_t i = 0; i < i_length; i++)
+    {
+        p_buf[i] = test_rand();
+        if (p_buf[i] == 0x47)
+            p_buf[i] = 0x46;
+    }
+}
+
+/* Write i_count packets at i_stride from p_buf */
+static void fill_packets(uint8_t *p_buf, const size_t i_count, const unsigned int i_stride)
+{
+    for (size_t n = 0; n < i_count; n++)
+    {
+        uint8_t *p = p_buf + n * i_stride;
+        fill_noise(p, i_stride);
+        p[(i_stride == 192) ? 4 : 0] = 0x47;
+    }
+}
+
+/*****************************************************************************
+ * Scalar reference of dvbpsi_ts_sync()
+ *****************************************************************************/
+static const unsigned int ai_strides[] = { 188, 192, 204 };
+
+static bool ref_ts_sync(const uint8_t *p_buf, const size_t i_length,
+                        const unsigned int i_hits, dvbpsi_ts_sync_t *p_sync)
+{
+    const unsigned int i_n = (i_hits > 0) ? i_hits : 1;
+
+    for (size_t i = 0; i < i_length; i++)
+    {
+        for (unsigned int s = 0; s < 3; s++)
+        {
+            const unsigned int i_stride = ai_strides[s];
+            unsigned int k;
+
+            if (i + (size_t)(i_n - 1) * i_stride >= i_length)
+                break;
+            for (k = 0; k < i_n; k++)
+                if (p_buf[i + k * i_stride] != 0x47)
+                    break;
+            if (k == i_n)
+            {
+                p_sync->i_offset = i;
+                p_sync->i_stride = i_stride;
+                if (i_stride == 192)
+                    p_sync->i_lost = (i >= 4) ? i - 4 : 0;
+                else
+                    p_sync->i_lost = i;
+                return true;
+            }
+        }
+    }
+
+    const size_t i_span = (size_t)(i_n - 1) * 204;
+    p_sync->i_offset = (i_length > i_span) ? i_length - i_span : 0;
+    p_sync->i_stride = 0;
+    p_sync->i_lost = p_sync->i_offset;
+    return false;
+}
+
+static bool sync_equal(const dvbpsi_ts_sync_t *p_a, const dvbpsi_ts_sync_t *p_b)
+{
+    return (p_a->i_offset == p_b->i_offset) && (p_a->i_stride == p_b->i_stride) &&
+           (p_a->i_lost == p_b->i_lost);
+}
+
+/*****************************************************************************
+ * dvbpsi_ts_sync
+ *****************************************************************************/
+typedef struct
+{
+    const char   *psz_name;
+    size_t        i_length;     /* buffer length */
+    size_t        i_start;      /* offset of the first packet */
+    size_t        i_packets;    /* packets written from i_start */
+    unsigned int  i_stride;     /* stride of the packets */
+    size_t        i_false;      /* offset of a lone 0x47, 0 for none */
+    unsigned int  i_hits;
+    bool          b_found;      /* expected dvbpsi_ts_sync() result */
+    size_t        i_offset;     /* expected i_offset */
+    size_t        i_lost;       /* expected i_lost */
+} sync_case_t;
+
+static const sync_case_t sync_cases[] = {
+    { "sync at offset 0",            8 * 188,     0, 8, 188,   0, 3, true,    0,    0 },
+    { "sync mid-buffer",       77 + 8 * 188,     77, 8, 188,   0, 3, true,   77,   77 },
+    { "M2TS sync mid-buffer", 300 + 8 * 192,    300, 8, 192,   0, 3, true,  304,  300 },
+    { "204 byte sync",         33 + 8 * 204,     33, 8, 204,   0, 3, true,   33,   33 },
+    { "false 0x47 before sync", 500 + 8 * 188, 500, 8, 188,  20, 3, true,  500,  500 },
+    /* 3 hits need 2 strides after the sync byte, the tail only has one */
+    { "tail shorter than a lattice", 1000 + 300, 1000, 1, 188, 0, 3, false, 1300 - 408, 1300 - 408 },
+    { "tail shorter than a packet",  100,         0, 1, 188,   0, 2, false,    0,    0 },
+    { "no sync at all",              4096,        0, 0, 188,   0, 3, false, 4096 - 408, 4096 - 408 },
+};
+
+static int run_ts_sync_test(void)
+{
+    uint8_t p_buf[8192];
+    dvbpsi_ts_sync_t sync, ref;
+
+    for (size_t c = 0; c < sizeof(sync_cases) / sizeof(sync_cases[0]); c++)
+    {
+        const sync_case_t *p_case = &sync_cases[c];
+
+        fill_noise(p_buf, p_case->i_length);
+        if (p_case->i_packets)
+        {
+            size_t i_room = (p_case->i_length - p_case->i_start) / p_case->i_stride;
+            fill_packets(p_buf + p_case->i_start,
+                         (p_case->i_packets < i_room) ? p_case->i_packets : i_room,
+                         p_case->i_stride);
+            /* a truncated last packet still starts with its sync byte */
+            if (p_case->i_packets > i_room)
+                p_buf[p_case->i_start + i_room * p_case->i_stride] = 0x47;
+        }
+        if (p_case->i_false)
+            p_buf[p_case->i_false] = 0x47;
+
+        bool b_found = dvbpsi_ts_sync(p_buf, p_case->i_length, p_case->i_hits, &sync);
+        if ((b_found != p_case->b_found) ||
+            (sync.i_offset != p_case->i_offset) || (sync.i_lost != p_case->i_lost) ||
+            (b_found && (sync.i_stride != p_case->i_stride)) ||
+            (!b_found && (sync.i_stride != 0)))
+        {
+            fprintf(stderr, "found %d offset %zu stride %u lost %zu\n",
+                    b_found, sync.i_offset, sync.i_stride, sync.i_lost);
+            TEST_FAILED(p_case->psz_name);
+            return 1;
+        }
+        TEST_PASSED(p_case->psz_name);
+    }
+
+    /* Random buffers dense in 0x47, against the scalar reference: covers the
+     * vector blocks, the scalar tail and their boundary */
+    for (int i = 0; i < 20000; i++)
+    {
+        const size_t i_length = test_rand() % 2048;
+        const unsigned int i_hits = 1 + test_rand() % 5;
+        const unsigned int i_density = 2 + test_rand() % 60;
+
+        for (size_t k = 0; k < i_length; k++)
+            p_buf[k] = (test_rand() % i_density) ? 0x00 : 0x47;
+
+        bool b_found = dvbpsi_ts_sync(p_buf, i_length, i_hits, &sync);
+        bool b_ref = ref_ts_sync(p_buf, i_length, i_hits, &ref);
+        if ((b_found != b_ref) || !sync_equal(&sync, &ref))
+        {
+            fprintf(stderr, "length %zu hits %u: offset %zu/%zu stride %u/%u\n",
+                    i_length, i_hits, sync.i_offset, ref.i_offset,
+                    sync.i_stride, ref.i_stride);
+            TEST_FAILED("dvbpsi_ts_sync against the scalar reference");
+            return 1;
+        }
+    }
+    TEST_PASSED("dvbpsi_ts_sync against the scalar reference");
+
+    fprintf(stderr, "ALL TS SYNC TESTS PASSED\n");
+    return 0;
+}
+
+/*****************************************************************************
+ * dvbpsi_ts_headers_parse
+ *****************************************************************************/
+#define TS_BATCH (64)
+
+/* Scalar decoding of one header, straight from ISO/IEC 13818-1 */
+static void ref_ts_header(const uint8_t *p, uint16_t *pi_pid, uint8_t *pi_flags,
+                          uint8_t *pi_cc, uint8_t *pi_payload)
+{
+    uint8_t i_flags = 0;
+    unsigned int i_payload = 4;
+
+    if (p[1] & 0x80) i_flags |= DVBPSI_TS_TEI;
+    if (p[1] & 0x40) i_flags |= DVBPSI_TS_PUSI;
+    if (p[1] & 0x20) i_flags |= DVBPSI_TS_PRIORITY;
+    if ((p[3] >> 6) != 0) i_flags |= DVBPSI_TS_SCRAMBLED;
+    if (p[3] & 0x10) i_flags |= DVBPSI_TS_PAYLOAD;
+    if (p[3] & 0x20)
+    {
+        i_flags |= DVBPSI_TS_ADAPTATION;
+        i_payload = 5 + p[4];
+        if ((p[4] > 0) && (p[4] <= 183) && (p[5] & 0x80))
+            i_flags |= DVBPSI_TS_DISCONTINUITY;
+    }
+    if (!(i_flags & DVBPSI_TS_PAYLOAD) || (i_payload >= DVBPSI_TS_PACKET_SIZE))
+    {
+        i_flags &= ~DVBPSI_TS_PAYLOAD;
+        i_payload = DVBPSI_TS_PACKET_SIZE;
+    }
+
+    *pi_pid = ((p[1] & 0x1f) << 8) | p[2];
+    *pi_flags = i_flags;
+    *pi_cc = p[3] & 0x0f;
+    *pi_payload = i_payload;
+}
+
+static int run_ts_headers_test(void)
+{
+    static uint8_t p_buf[TS_BATCH * 204];
+    uint32_t ai_offset[TS_BATCH];
+    uint16_t ai_pid[TS_BATCH];
+    uint8_t ai_flags[TS_BATCH], ai_cc[TS_BATCH], ai_payload[TS_BATCH];
+    dvbpsi_ts_headers_t headers = { 0, ai_offset, ai_pid, ai_flags, ai_cc, ai_payload };
+
+    for (int i = 0; i < 5000; i++)
+    {
+        const unsigned int i_stride = ai_strides[i % 3];
+        const size_t i_packets = 1 + test_rand() % TS_BATCH;
+        /* the last packet may be cut, and one may have lost its sync byte */
+        const size_t i_length = i_packets * i_stride - ((i & 4) ? test_rand() % i_stride : 0);
+        const size_t i_broken = (i & 8) ? test_rand() % TS_BATCH : TS_BATCH;
+        const size_t i_max = (i & 16) ? test_rand() % TS_BATCH : TS_BATCH;
+
+        for (size_t n = 0; n < i_packets; n++)
+        {
+            uint8_t *p = &p_buf[n * i_stride];
+            for (unsigned int k = 0; k < 6; k++)
+                p[k] = test_rand();
+            /* mostly plausible adaptation_field_length values */
+            if (test_rand() & 1)
+                p[4] = p[4] % 184;
+            p[0] = (n == i_broken) ? 0x46 : 0x47;
+        }
+
+        size_t i_expected = 0;
+        while ((i_expected < i_max) && (i_expected * i_stride + 188 <= i_length) &&
+               (i_expected != i_broken))
+            i_expected++;
+
+        size_t i_count = dvbpsi_ts_headers_parse(p_buf, i_length, i_stride, i_max, &headers);
+        if ((i_count != i_expected) || (headers.i_count != i_count))
+        {
+            fprintf(stderr, "stride %u length %zu max %zu broken %zu: %zu packets instead of %zu\n",
+                    i_stride, i_length, i_max, i_broken, i_count, i_expected);
+            TEST_FAILED("dvbpsi_ts_headers_parse packet count");
+            return 1;
+        }
+
+        for (size_t n = 0; n < i_count; n++)
+        {
+            uint16_t i_pid;
+            uint8_t i_flags, i_cc, i_payload;
+
+            ref_ts_header(&p_buf[n * i_stride], &i_pid, &i_flags, &i_cc, &i_payload);
+            if ((ai_offset[n] != n * i_stride) || (ai_pid[n] != i_pid) ||
+                (ai_flags[n] != i_flags) || (ai_cc[n] != i_cc) || (ai_payload[n] != i_payload))
+            {
+                fprintf(stderr, "packet %zu: pid %u/%u flags 0x%02x/0x%02x cc %u/%u payload %u/%u\n",
+                        n, ai_pid[n], i_pid, ai_flags[n], i_flags, ai_cc[n], i_cc,
+                        ai_payload[n], i_payload);
+                TEST_FAILED("dvbpsi_ts_headers_parse against the scalar decode");
+                return 1;
+            }
+        }
+    }
+    TEST_PASSED("dvbpsi_ts_headers_parse against the scalar decode");
+
+    fprintf(stderr, "ALL TS HEADERS TESTS PASSED\n");
+    return 0;
+}
+
+/*****************************************************************************
+ * dvbpsi_ts_packet_push
+ *****************************************************************************/
+#define PAT_VERSIONS (12)
+typedef struct
+{
+    int  i_pats;
+    int  ai_version[PAT_VERSIONS * 2];
+    int  ai_programs[PAT_VERSIONS * 2];
+} pat_log_t;
+
+static void GotPAT(void *p_data, dvbpsi_pat_t *p_pat)
+{
+    pat_log_t *p_log = (pat_log_t *)p_data;
+    int i_programs = 0;
+
+    for (dvbpsi_pat_program_t *p = p_pat->p_first_program; p; p = p->p_next)
+        i_programs++;
+    if (p_log->i_pats < PAT_VERSIONS * 2)
+    {
+        p_log->ai_version[p_log->i_pats] = p_pat->i_version;
+        p_log->ai_programs[p_log->i_pats] = i_programs;
+    }
+    p_log->i_pats++;
+    dvbpsi_pat_delete(p_pat);
+}
+
+static void message(dvbpsi_t *handle, const dvbpsi_msg_level_t level, const char* msg)
+{
+}
+
+/* Packetize PATs on PID 0 with adaptation fields of random lengths, packets
+ * without payload, one CC error and one CRC_32 error. Returns the length. */
+static size_t build_pat_stream(uint8_t *p_buf, const size_t i_size)
+{
+    dvbpsi_t *p_dvbpsi = dvbpsi_new(&message, DVBPSI_MSG_NONE);
+    uint8_t i_cc = 0;
+    size_t i_length = 0;
+    bool b_jumped = false;
+
+    for (int v = 0; (v < PAT_VERSIONS) && p_dvbpsi; v++)
+    {
+        dvbpsi_pat_t *p_pat = dvbpsi_pat_new(1, v, true);
+        for (int i = 0; i < 20 + 15 * v; i++)
+            dvbpsi_pat_program_add(p_pat, i + 1, 0x100 + i);
+        dvbpsi_psi_section_t *p_section = dvbpsi_pat_sections_generate(p_dvbpsi, p_pat, 253);
+        dvbpsi_pat_delete(p_pat);
+        if (p_section == NULL)
+            break;
+
+        /* version 5 reaches the decoder with a bad CRC_32 */
+        if (v == 5)
+            p_section->p_payload_end[1] ^= 0x5a;
+
+        const uint8_t *p_data = p_section->p_data;
+        size_t i_left = p_section->p_payload_end - p_section->p_data + 4;
+        bool b_first = true;
+
+        while ((i_left > 0) && (i_length + 2 * 188 <= i_size))
+        {
+            uint8_t *p = &p_buf[i_length];
+            i_length += 188;
+            memset(p, 0xff, 188);
+            p[0] = 0x47;
+            p[1] = 0x00;
+            p[2] = 0x00;
+
+            /* a packet of adaptation field only; the decoders expect its CC
+             * to be incremented too */
+            if ((test_rand() % 5) == 0)
+            {
+                p[3] = 0x20 | (i_cc & 0x0f);
+                p[4] = 183;
+                p[5] = 0x00;
+                i_cc++;
+                p = &p_buf[i_length];
+                i_length += 188;
+                memset(p, 0xff, 188);
+                p[0] = 0x47;
+                p[2] = 0x00;
+            }
+
+            /* the CC jumps once, in the middle of version 8 */
+            if ((v == 8) && !b_first && !b_jumped)
+            {
+                i_cc += 3;
+                b_jumped = true;
+            }
+
+            size_t i_pos = 4;
+            p[1] = b_first ? 0x40 : 0x00;
+            unsigned int i_af = test_rand() % 3 ? 0 : test_rand() % 40;
+            p[3] = 0x10 | (i_cc & 0x0f);
+            i_cc++;
+            if (i_af)
+            {
+                p[3] |= 0x20;
+                p[4] = i_af - 1;
+                if (i_af > 1)
+                    p[5] = 0x00;
+                i_pos += i_af;
+            }
+            if (b_first)
+                p[i_pos++] = 0x00; /* pointer_field */
+
+            size_t i_copy = 188 - i_pos;
+            if (i_copy > i_left)
+                i_copy = i_left;
+            memcpy(p + i_pos, p_data, i_copy);
+            p_data += i_copy;
+            i_left -= i_copy;
+            b_first = false;
+        }
+        dvbpsi_DeletePSISections(p_section);
+    }
+    if (p_dvbpsi)
+        dvbpsi_delete(p_dvbpsi);
+    return i_length;
+}
+
+static int run_ts_packet_push_test(void)
+{
+    static uint8_t p_buf[2000 * 188];
+    uint32_t ai_offset[TS_BATCH];
+    uint16_t ai_pid[TS_BATCH];
+    uint8_t ai_flags[TS_BATCH], ai_cc[TS_BATCH], ai_payload[TS_BATCH];
+    dvbpsi_ts_headers_t headers = { 0, ai_offset, ai_pid, ai_flags, ai_cc, ai_payload };
+    pat_log_t log_push, log_batch;
+    dvbpsi_errors_t errors_push, errors_batch;
+    int i_ret = 1;
+
+    memset(&log_push, 0, sizeof(log_push));
+    memset(&log_batch, 0, sizeof(log_batch));
+
+    const size_t i_length = build_pat_stream(p_buf, sizeof(p_buf));
+
+    dvbpsi_t *p_push = dvbpsi_new(&message, DVBPSI_MSG_NONE);
+    dvbpsi_t *p_batch = dvbpsi_new(&message, DVBPSI_MSG_NONE);
+    if ((p_push == NULL) || (p_batch == NULL) ||
+        !dvbpsi_pat_attach(p_push, 0x00, 0x01, GotPAT, &log_push) ||
+        !dvbpsi_pat_attach(p_batch, 0x00, 0x01, GotPAT, &log_batch))
+    {
+        TEST_FAILED("dvbpsi_ts_packet_push setup");
+        goto out;
+    }
+
+    /* Reference: one packet at a time */
+    for (size_t i = 0; i < i_length; i += 188)
+        dvbpsi_packet_push(p_push, &p_buf[i]);
+
+    /* Batches of headers decoded ahead */
+    for (size_t i = 0; i < i_length; )
+    {
+        size_t i_count = dvbpsi_ts_headers_parse(&p_buf[i], i_length - i, 188,
+                                                 TS_BATCH, &headers);
+        if (i_count == 0)
+            break;
+        for (size_t k = 0; k < i_count; k++)
+            dvbpsi_ts_packet_push(p_batch, &p_buf[i], &headers, k);
+        i += i_count * 188;
+    }
+
+    dvbpsi_errors_get(p_push, &errors_push);
+    dvbpsi_errors_get(p_batch, &errors_batch);
+
+    /* Versions 5 (CRC_32) and 8 (CC) are lost */
+    if ((log_push.i_pats != PAT_VERSIONS - 2) ||
+        (errors_push.i_crc_errors != 1) || (errors_push.i_cc_errors == 0))
+    {
+        fprintf(stderr, "%d PATs, %"PRIu64" CRC errors, %"PRIu64" CC errors\n",
+                log_push.i_pats, errors_push.i_crc_errors, errors_push.i_cc_errors);
+        TEST_FAILED("dvbpsi_packet_push of the PAT stream");
+        goto out;
+    }
+    if ((log_batch.i_pats != log_push.i_pats) ||
+        memcmp(log_batch.ai_version, log_push.ai_version, sizeof(log_push.ai_version)) ||
+        memcmp(log_batch.ai_programs, log_push.ai_programs, sizeof(log_push.ai_programs)) ||
+        memcmp(&errors_batch, &errors_push, sizeof(errors_push)))
+    {
+        TEST_FAILED("dvbpsi_ts_packet_push against dvbpsi_packet_push");
+        goto out;
+    }
+    TEST_PASSED("dvbpsi_ts_packet_push against dvbpsi_packet_push");
+
+    i_ret = 0;
+    fprintf(stderr, "ALL TS PACKET PUSH TESTS PASSED\n");
+out:
+    if (p_push)
+    {
+        dvbpsi_pat_detach(p_push, 0x00, 0x01);
+        dvbpsi_delete(p_push);
+    }
+    if (p_batch)
+    {
+        dvbpsi_pat_detach(p_batch, 0x00, 0x01);
+        dvbpsi_delete(p_batch);
+    }
+    return i_ret;
+}
+
+/*****************************************************************************
+ * main
+ *****************************************************************************/
+int main(int i_argc, char* pa_argv[])
+{
+    if (run_ts_sync_test() != 0)
+        return 1;
+    if (run_ts_headers_test() != 0)
+        return 1;
+    if (run_ts_packet_push_test() != 0)
+        return 1;
+
+    return 0;
+}
@@ -148,6 +148,48 @@ out:
     /* Delete demux decoder */
     dvbpsi_decoder_delete(p_demux);
     p_dvbpsi->p_decoder = NULL;
+    p_dvbpsi->budget.i_subtables = 0;
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_decoder_chain_evict
+ *****************************************************************************
+ * Detach the least recently updated subtable decoder that never completed a
+ * table. Returns false if there is none or if it stayed attached.
+ *****************************************************************************/
+static bool dvbpsi_decoder_chain_evict(dvbpsi_t *p_dvbpsi)
+{
+    dvbpsi_decoder_t *p_demux = p_dvbpsi->p_decoder;
+    dvbpsi_decoder_t *p_lru = NULL;
+    dvbpsi_decoder_t *p = p_dvbpsi->p_decoder;
+    while (p) {
+        if ((p->pf_gather != &dvbpsi_decoder_chain_demux) && !p->b_current_valid &&
+            (!p_lru || (int32_t)(p->i_last_used - p_lru->i_last_used) < 0))
+            p_lru = p;
+        p = p->p_next;
+    }
+    if (!p_lru)
+        return false;
+
+    dvbpsi_warning(p_dvbpsi, "chain", "evicting incomplete subtable decoder (%d:%d)",
+                   p_lru->i_table_id, p_lru->i_extension);
+
+    if ((p_demux->pf_gather == &dvbpsi_decoder_chain_demux) && p_demux->pf_del) {
+        const unsigned int i_subtables = p_dvbpsi->budget.i_subtables;
+        p_demux->pf_del(p_dvbpsi, p_lru->i_table_id, p_lru->i_extension);
+        if (p_dvbpsi->budget.i_subtables >= i_subtables) {
+            dvbpsi_error(p_dvbpsi, "chain", "pf_del did not detach subtable decoder (%d:%d)",
+                         p_lru->i_table_id, p_lru->i_extension);
+            return false;
+        }
+    }
+    else if (dvbpsi_decoder_chain_remove(p_dvbpsi, p_lru))
+        dvbpsi_decoder_delete(p_lru);
+    else
+        return false;
+
+    p_dvbpsi->budget.i_evictions++;
     return true;
 }
 
@@ -156,11 +198,36 @@ out:
  *****************************************************************************
  * Add decoder to chain
  *****************************************************************************/
+static bool dvbpsi_decoder_chain_insert(dvbpsi_t *p_dvbpsi, dvbpsi_decoder_t *p_decoder);
+
 bool dvbpsi_decoder_chain_add(dvbpsi_t *p_dvbpsi, dvbpsi_decoder_t *p_decoder)
 {
     assert(p_decoder);
     assert(!p_decoder->p_next);
 
+    /* Make room for a new subtable decoder */
+    const unsigned int i_max = p_dvbpsi->budget.i_max_subtables;
+    while ((i_max > 0) && (p_dvbpsi->budget.i_subtables >= i_max) &&
+           !dvbpsi_decoder_chain_get(p_dvbpsi, p_decoder->i_table_id, p_decoder->i_extension)) {
+        if (!dvbpsi_decoder_chain_evict(p_dvbpsi)) {
+            dvbpsi_error(p_dvbpsi, "chain", "too many subtable decoders, (%d:%d) not added",
+                         p_decoder->i_table_id, p_decoder->i_extension);
+            return false;
+        }
+    }
+
+    if (!dvbpsi_decoder_chain_insert(p_dvbpsi, p_decoder))
+        return false;
+
+    p_decoder->p_owner = p_dvbpsi;
+    p_decoder->i_last_used = ++p_dvbpsi->budget.i_clock;
+    p_dvbpsi->budget.i_subtables++;
+    return true;
+}
+
+static bool dvbpsi_decoder_chain_insert(dvbpsi_t *p_dvbpsi, dvbpsi_decoder_t *p_decoder)
+{
+
     dvbpsi_decoder_t *p_list = (dvbpsi_decoder_t *) p_dvbpsi->p_decoder;
     while (p_list) {
         if (p_decoder->i_table_id == p_list->i_table_id) {
@@ -204,11 +271,13 @@ bool dvbpsi_decoder_chain_remove(dvbpsi_t *p_dvbpsi, const dvbpsi_decoder_t *p_d
     if (!p_decoder) return false;
 
     dvbpsi_decoder_t **pp_prev = &p_dvbpsi->p_decoder;
-    while (pp_prev) {
+    while (*pp_prev) {
         if ((p_decoder->i_table_id == (*pp_prev)->i_table_id) &&
             (p_decoder->i_extension == (*pp_prev)->i_extension)) {
             assert(*pp_prev == p_decoder);
             *pp_prev = p_decoder->p_next;
+            assert(p_dvbpsi->budget.i_subtables > 0);
+            p_dvbpsi->budget.i_subtables--;
             /* NOTE: caller must call dvbpsi_decoder_delete(p_decoder) */
             return true;
         }
@@ -103,6 +103,10 @@ bool dvbpsi_chain_demux_delete(dvbpsi_t *p_dvbpsi);
  * \param p_dvbpsi pointer to dvbpsi_t handle
  * \param p_decoder pointer to dvbpsi_decoder_t for adding to chain
  * \return true on success, false on failure
+ *
+ * The decoder's sections are charged to 'p_dvbpsi'. When the subtable limit
+ * set with @see dvbpsi_budget_set() is reached, an incomplete subtable
+ * decoder is evicted first; if there is none the decoder is not added.
  */
 bool dvbpsi_decoder_chain_add(dvbpsi_t *p_dvbpsi, dvbpsi_decoder_t *p_decoder);
 
@@ -104,22 +104,27 @@ dvbpsi_atsc_ac3_audio_dr_t *dvbpsi_decode_atsc_ac3_audio_dr(dvbpsi_descriptor_t
     p_decoded->b_text_code = 0X01 & buf[0];
     buf++;
 
+    /* The text and the language codes may claim more than is left */
+    uint8_t *p_end = p_descriptor->p_data + p_descriptor->i_length;
+    if (p_decoded->i_textlen > p_end - buf)
+        p_decoded->i_textlen = p_end - buf;
+
     memset(p_decoded->text, 0, sizeof(p_decoded->text));
     memcpy(p_decoded->text, buf, p_decoded->i_textlen);
     buf += p_decoded->i_textlen;
 
-    if (buf == p_descriptor->p_data + p_descriptor->i_length)
+    if (buf == p_end)
         return p_decoded;
 
     p_decoded->b_language_flag   = 0x01 & (buf[0] >> 7);
     p_decoded->b_language_flag_2 = 0x01 & (buf[0] >> 6);
     buf++;
 
-    if (p_decoded->b_language_flag) {
+    if (p_decoded->b_language_flag && p_end - buf >= 3) {
         memcpy(p_decoded->language, buf, 3);
         buf += 3;
     }
-    if (p_decoded->b_language_flag_2) {
+    if (p_decoded->b_language_flag_2 && p_end - buf >= 3) {
         memcpy(p_decoded->language_2, buf, 3);
         buf += 3;
     }
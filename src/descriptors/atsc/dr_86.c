@@ -66,6 +66,8 @@ dvbpsi_atsc_caption_service_dr_t *dvbpsi_decode_atsc_caption_service_dr(dvbpsi_d
     p_descriptor->p_decoded = (void*)p_decoded;
 
     p_decoded->i_number_of_services = 0x1f & buf[0];
+    if (p_decoded->i_number_of_services > (p_descriptor->i_length - 1) / 6)
+        p_decoded->i_number_of_services = (p_descriptor->i_length - 1) / 6;
     buf++;
 
     for (int i = 0; i < p_decoded->i_number_of_services; i++)
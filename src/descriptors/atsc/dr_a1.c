@@ -74,6 +74,8 @@ dvbpsi_decode_atsc_service_location_dr (dvbpsi_descriptor_t * p_descriptor)
 
     p_decoded->i_pcr_pid = ((uint16_t) (buf[0] & 0x1f) << 8) | buf[1];
     p_decoded->i_number_elements = buf[2];
+    if (p_decoded->i_number_elements > (p_descriptor->i_length - 3) / 6)
+        p_decoded->i_number_elements = (p_descriptor->i_length - 3) / 6;
 
     buf += 3;
 
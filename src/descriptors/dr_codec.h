@@ -0,0 +1,306 @@
+/* This file is generated by applying the dr_codec.xsl stylesheet to the
+ * dr.xml description file. DO NOT EDIT !!! */
+
+/* Field codecs for the descriptors marked layout="fixed" in dr.xml. The
+ * whole payload is read with one big endian load and every field is then
+ * extracted with a shift and a mask known at compile time. Reserved bits
+ * are written as 1s. The caller checks the descriptor length. */
+
+#ifndef DVBPSI_DR_CODEC_H
+#define DVBPSI_DR_CODEC_H
+
+#include "dr.h"
+
+static inline uint64_t dvbpsi_dr_load_be(const uint8_t *p_data, unsigned i_len)
+{
+    uint64_t i_bits = 0;
+    for (unsigned i = 0; i < i_len; i++)
+        i_bits = (i_bits << 8) | p_data[i];
+    return i_bits;
+}
+
+static inline void dvbpsi_dr_store_be(uint8_t *p_data, unsigned i_len, uint64_t i_bits)
+{
+    while (i_len--)
+    {
+        p_data[i_len] = (uint8_t)i_bits;
+        i_bits >>= 8;
+    }
+}
+
+#define DVBPSI_DR_MASK(n) ((UINT64_C(1) << (n)) - 1)
+
+/* hierarchy (0x04) */
+#define DVBPSI_MPEG_HIERARCHY_DR_LEN 4
+
+static inline void dvbpsi_mpeg_hierarchy_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_hierarchy_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_HIERARCHY_DR_LEN);
+    p_decoded->i_h_type = (i_bits >> 24) & DVBPSI_DR_MASK(4);
+    p_decoded->i_h_layer_index = (i_bits >> 16) & DVBPSI_DR_MASK(6);
+    p_decoded->i_h_embedded_layer = (i_bits >> 8) & DVBPSI_DR_MASK(6);
+    p_decoded->i_h_priority = (i_bits >> 0) & DVBPSI_DR_MASK(6);
+}
+
+static inline void dvbpsi_mpeg_hierarchy_dr_pack(const dvbpsi_mpeg_hierarchy_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= DVBPSI_DR_MASK(4) << 28;
+    i_bits |= ((uint64_t)p_decoded->i_h_type & DVBPSI_DR_MASK(4)) << 24;
+    i_bits |= DVBPSI_DR_MASK(2) << 22;
+    i_bits |= ((uint64_t)p_decoded->i_h_layer_index & DVBPSI_DR_MASK(6)) << 16;
+    i_bits |= DVBPSI_DR_MASK(2) << 14;
+    i_bits |= ((uint64_t)p_decoded->i_h_embedded_layer & DVBPSI_DR_MASK(6)) << 8;
+    i_bits |= DVBPSI_DR_MASK(2) << 6;
+    i_bits |= ((uint64_t)p_decoded->i_h_priority & DVBPSI_DR_MASK(6)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_HIERARCHY_DR_LEN, i_bits);
+}
+
+/* data stream alignment (0x06) */
+#define DVBPSI_MPEG_DS_ALIGNMENT_DR_LEN 1
+
+static inline void dvbpsi_mpeg_ds_alignment_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_ds_alignment_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_DS_ALIGNMENT_DR_LEN);
+    p_decoded->i_alignment_type = (i_bits >> 0) & DVBPSI_DR_MASK(8);
+}
+
+static inline void dvbpsi_mpeg_ds_alignment_dr_pack(const dvbpsi_mpeg_ds_alignment_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_alignment_type & DVBPSI_DR_MASK(8)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_DS_ALIGNMENT_DR_LEN, i_bits);
+}
+
+/* target background grid (0x07) */
+#define DVBPSI_MPEG_TARGET_BG_GRID_DR_LEN 4
+
+static inline void dvbpsi_mpeg_target_bg_grid_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_target_bg_grid_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_TARGET_BG_GRID_DR_LEN);
+    p_decoded->i_horizontal_size = (i_bits >> 18) & DVBPSI_DR_MASK(14);
+    p_decoded->i_vertical_size = (i_bits >> 4) & DVBPSI_DR_MASK(14);
+    p_decoded->i_pel_aspect_ratio = (i_bits >> 0) & DVBPSI_DR_MASK(4);
+}
+
+static inline void dvbpsi_mpeg_target_bg_grid_dr_pack(const dvbpsi_mpeg_target_bg_grid_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_horizontal_size & DVBPSI_DR_MASK(14)) << 18;
+    i_bits |= ((uint64_t)p_decoded->i_vertical_size & DVBPSI_DR_MASK(14)) << 4;
+    i_bits |= ((uint64_t)p_decoded->i_pel_aspect_ratio & DVBPSI_DR_MASK(4)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_TARGET_BG_GRID_DR_LEN, i_bits);
+}
+
+/* video window (0x08) */
+#define DVBPSI_MPEG_VWINDOW_DR_LEN 4
+
+static inline void dvbpsi_mpeg_vwindow_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_vwindow_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_VWINDOW_DR_LEN);
+    p_decoded->i_horizontal_offset = (i_bits >> 18) & DVBPSI_DR_MASK(14);
+    p_decoded->i_vertical_offset = (i_bits >> 4) & DVBPSI_DR_MASK(14);
+    p_decoded->i_window_priority = (i_bits >> 0) & DVBPSI_DR_MASK(4);
+}
+
+static inline void dvbpsi_mpeg_vwindow_dr_pack(const dvbpsi_mpeg_vwindow_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_horizontal_offset & DVBPSI_DR_MASK(14)) << 18;
+    i_bits |= ((uint64_t)p_decoded->i_vertical_offset & DVBPSI_DR_MASK(14)) << 4;
+    i_bits |= ((uint64_t)p_decoded->i_window_priority & DVBPSI_DR_MASK(4)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_VWINDOW_DR_LEN, i_bits);
+}
+
+/* multiplex buffer utilization (0x0c) */
+#define DVBPSI_MPEG_MX_BUFF_UTILIZATION_DR_LEN 3
+
+static inline void dvbpsi_mpeg_mx_buff_utilization_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_mx_buff_utilization_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_MX_BUFF_UTILIZATION_DR_LEN);
+    p_decoded->b_mdv_valid = (i_bits >> 23) & 1;
+    p_decoded->i_mx_delay_variation = (i_bits >> 8) & DVBPSI_DR_MASK(15);
+    p_decoded->i_mx_strategy = (i_bits >> 5) & DVBPSI_DR_MASK(3);
+}
+
+static inline void dvbpsi_mpeg_mx_buff_utilization_dr_pack(const dvbpsi_mpeg_mx_buff_utilization_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= (uint64_t)(p_decoded->b_mdv_valid ? 1 : 0) << 23;
+    i_bits |= ((uint64_t)p_decoded->i_mx_delay_variation & DVBPSI_DR_MASK(15)) << 8;
+    i_bits |= ((uint64_t)p_decoded->i_mx_strategy & DVBPSI_DR_MASK(3)) << 5;
+    i_bits |= DVBPSI_DR_MASK(5) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_MX_BUFF_UTILIZATION_DR_LEN, i_bits);
+}
+
+/* maximum bitrate (0x0e) */
+#define DVBPSI_MPEG_MAX_BITRATE_DR_LEN 3
+
+static inline void dvbpsi_mpeg_max_bitrate_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_max_bitrate_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_MAX_BITRATE_DR_LEN);
+    p_decoded->i_max_bitrate = (i_bits >> 0) & DVBPSI_DR_MASK(22);
+}
+
+static inline void dvbpsi_mpeg_max_bitrate_dr_pack(const dvbpsi_mpeg_max_bitrate_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= DVBPSI_DR_MASK(2) << 22;
+    i_bits |= ((uint64_t)p_decoded->i_max_bitrate & DVBPSI_DR_MASK(22)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_MAX_BITRATE_DR_LEN, i_bits);
+}
+
+/* smoothing buffer (0x10) */
+#define DVBPSI_MPEG_SMOOTHING_BUFFER_DR_LEN 6
+
+static inline void dvbpsi_mpeg_smoothing_buffer_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_smoothing_buffer_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_SMOOTHING_BUFFER_DR_LEN);
+    p_decoded->i_sb_leak_rate = (i_bits >> 24) & DVBPSI_DR_MASK(22);
+    p_decoded->i_sb_size = (i_bits >> 0) & DVBPSI_DR_MASK(22);
+}
+
+static inline void dvbpsi_mpeg_smoothing_buffer_dr_pack(const dvbpsi_mpeg_smoothing_buffer_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= DVBPSI_DR_MASK(2) << 46;
+    i_bits |= ((uint64_t)p_decoded->i_sb_leak_rate & DVBPSI_DR_MASK(22)) << 24;
+    i_bits |= DVBPSI_DR_MASK(2) << 22;
+    i_bits |= ((uint64_t)p_decoded->i_sb_size & DVBPSI_DR_MASK(22)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_SMOOTHING_BUFFER_DR_LEN, i_bits);
+}
+
+/* STD (0x11) */
+#define DVBPSI_MPEG_STD_DR_LEN 1
+
+static inline void dvbpsi_mpeg_std_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_std_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_STD_DR_LEN);
+    p_decoded->b_leak_valid_flag = (i_bits >> 0) & 1;
+}
+
+static inline void dvbpsi_mpeg_std_dr_pack(const dvbpsi_mpeg_std_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= DVBPSI_DR_MASK(7) << 1;
+    i_bits |= (uint64_t)(p_decoded->b_leak_valid_flag ? 1 : 0) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_STD_DR_LEN, i_bits);
+}
+
+/* IBP (0x12) */
+#define DVBPSI_MPEG_IBP_DR_LEN 2
+
+static inline void dvbpsi_mpeg_ibp_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_ibp_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_IBP_DR_LEN);
+    p_decoded->b_closed_gop_flag = (i_bits >> 15) & 1;
+    p_decoded->b_identical_gop_flag = (i_bits >> 14) & 1;
+    p_decoded->i_max_gop_length = (i_bits >> 0) & DVBPSI_DR_MASK(14);
+}
+
+static inline void dvbpsi_mpeg_ibp_dr_pack(const dvbpsi_mpeg_ibp_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= (uint64_t)(p_decoded->b_closed_gop_flag ? 1 : 0) << 15;
+    i_bits |= (uint64_t)(p_decoded->b_identical_gop_flag ? 1 : 0) << 14;
+    i_bits |= ((uint64_t)p_decoded->i_max_gop_length & DVBPSI_DR_MASK(14)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_IBP_DR_LEN, i_bits);
+}
+
+/* MultiplexBuffer (0x23) */
+#define DVBPSI_MPEG_MUX_BUF_DR_LEN 6
+
+static inline void dvbpsi_mpeg_mux_buf_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_mpeg_mux_buf_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_MPEG_MUX_BUF_DR_LEN);
+    p_decoded->i_mb_buf_size = (i_bits >> 24) & DVBPSI_DR_MASK(24);
+    p_decoded->i_tb_leak_rate = (i_bits >> 0) & DVBPSI_DR_MASK(24);
+}
+
+static inline void dvbpsi_mpeg_mux_buf_dr_pack(const dvbpsi_mpeg_mux_buf_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_mb_buf_size & DVBPSI_DR_MASK(24)) << 24;
+    i_bits |= ((uint64_t)p_decoded->i_tb_leak_rate & DVBPSI_DR_MASK(24)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_MPEG_MUX_BUF_DR_LEN, i_bits);
+}
+
+/* time shifted service (0x4c) */
+#define DVBPSI_DVB_TSHIFTED_SERVICE_DR_LEN 2
+
+static inline void dvbpsi_dvb_tshifted_service_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_dvb_tshifted_service_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_DVB_TSHIFTED_SERVICE_DR_LEN);
+    p_decoded->i_ref_service_id = (i_bits >> 0) & DVBPSI_DR_MASK(16);
+}
+
+static inline void dvbpsi_dvb_tshifted_service_dr_pack(const dvbpsi_dvb_tshifted_service_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_ref_service_id & DVBPSI_DR_MASK(16)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_DVB_TSHIFTED_SERVICE_DR_LEN, i_bits);
+}
+
+/* time shifted event (0x4f) */
+#define DVBPSI_DVB_TSHIFTED_EV_DR_LEN 4
+
+static inline void dvbpsi_dvb_tshifted_ev_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_dvb_tshifted_ev_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_DVB_TSHIFTED_EV_DR_LEN);
+    p_decoded->i_ref_service_id = (i_bits >> 16) & DVBPSI_DR_MASK(16);
+    p_decoded->i_ref_event_id = (i_bits >> 0) & DVBPSI_DR_MASK(16);
+}
+
+static inline void dvbpsi_dvb_tshifted_ev_dr_pack(const dvbpsi_dvb_tshifted_ev_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_ref_service_id & DVBPSI_DR_MASK(16)) << 16;
+    i_bits |= ((uint64_t)p_decoded->i_ref_event_id & DVBPSI_DR_MASK(16)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_DVB_TSHIFTED_EV_DR_LEN, i_bits);
+}
+
+/* stream identifier (0x52) */
+#define DVBPSI_DVB_STREAM_IDENTIFIER_DR_LEN 1
+
+static inline void dvbpsi_dvb_stream_identifier_dr_unpack(const uint8_t *p_data,
+                            dvbpsi_dvb_stream_identifier_dr_t *p_decoded)
+{
+    const uint64_t i_bits = dvbpsi_dr_load_be(p_data, DVBPSI_DVB_STREAM_IDENTIFIER_DR_LEN);
+    p_decoded->i_component_tag = (i_bits >> 0) & DVBPSI_DR_MASK(8);
+}
+
+static inline void dvbpsi_dvb_stream_identifier_dr_pack(const dvbpsi_dvb_stream_identifier_dr_t *p_decoded,
+                            uint8_t *p_data)
+{
+    uint64_t i_bits = 0;
+    i_bits |= ((uint64_t)p_decoded->i_component_tag & DVBPSI_DR_MASK(8)) << 0;
+    dvbpsi_dr_store_be(p_data, DVBPSI_DVB_STREAM_IDENTIFIER_DR_LEN, i_bits);
+}
+
+#undef DVBPSI_DR_MASK
+
+#endif
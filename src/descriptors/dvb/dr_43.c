@@ -57,6 +57,9 @@ dvbpsi_dvb_sat_deliv_sys_dr_t * dvbpsi_decode_dvb_sat_deliv_sys_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
+    if (p_descriptor->i_length < 11)
+        return NULL;
+
     /* Allocate memory */
     p_decoded = (dvbpsi_dvb_sat_deliv_sys_dr_t*)malloc(sizeof(dvbpsi_dvb_sat_deliv_sys_dr_t));
     if (!p_decoded)
@@ -77,10 +77,19 @@ dvbpsi_dvb_vbi_dr_t * dvbpsi_decode_dvb_vbi_dr(
     {
         uint8_t i_lines = 0, i_data_service_id;
 
+        /* Stop at the first service that does not fit */
+        if (3 * i + 3 >= p_descriptor->i_length)
+        {
+            p_decoded->i_services_number = i;
+            break;
+        }
+
         i_data_service_id = ((uint8_t)(p_descriptor->p_data[3 * i + 2 + i_lines]));
         p_decoded->p_services[i].i_data_service_id = i_data_service_id;
 
         i_lines = ((uint8_t)(p_descriptor->p_data[3 * i + 3]));
+        if (3 * i + 3 + i_lines > p_descriptor->i_length)
+            i_lines = p_descriptor->i_length - (3 * i + 3);
         p_decoded->p_services[i].i_lines = i_lines;
 
         for (uint8_t n = 0; n < i_lines; n++)
@@ -37,7 +37,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_4c.h"
+/* dr_codec.h pulls in dr_4c.h through dr.h */
+#include "../dr_codec.h"
 
 /*****************************************************************************
  * dvbpsi_decode_dvb_tshifted_service_dr
@@ -52,7 +53,7 @@ dvbpsi_dvb_tshifted_service_dr_t* dvbpsi_decode_dvb_tshifted_service_dr(dvbpsi_d
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length < 2)
+    if (p_descriptor->i_length < DVBPSI_DVB_TSHIFTED_SERVICE_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -62,8 +63,7 @@ dvbpsi_dvb_tshifted_service_dr_t* dvbpsi_decode_dvb_tshifted_service_dr(dvbpsi_d
         return NULL;
 
     /* Decode data */
-    p_decoded->i_ref_service_id = p_descriptor->p_data[0] << 8
-                                | p_descriptor->p_data[1];
+    dvbpsi_dvb_tshifted_service_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -77,13 +77,13 @@ dvbpsi_descriptor_t *dvbpsi_gen_dvb_tshifted_service_dr(dvbpsi_dvb_tshifted_serv
                                                     bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x4c, 2, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x4c, DVBPSI_DVB_TSHIFTED_SERVICE_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = p_decoded->i_ref_service_id >> 8;
-    p_descriptor->p_data[1] = p_decoded->i_ref_service_id;
+    dvbpsi_dvb_tshifted_service_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
@@ -70,17 +70,28 @@ dvbpsi_dvb_extended_event_dr_t * dvbpsi_decode_dvb_extended_event_dr(dvbpsi_desc
     memcpy( &p_decoded->i_iso_639_code[0], &p_descriptor->p_data[1], 3 );
     p_decoded->i_entry_count = 0;
     i_len = p_descriptor->p_data[4];
+    /* The items and the text length byte must fit in the descriptor */
+    if (5 + i_len + 1 > p_descriptor->i_length)
+    {
+        free(p_decoded);
+        return NULL;
+    }
     i_pos = 0;
     for( p = &p_descriptor->p_data[5]; p < &p_descriptor->p_data[5+i_len]; )
     {
         int idx = p_decoded->i_entry_count;
+        uint8_t *p_items_end = &p_descriptor->p_data[5+i_len];
 
+        if (p + 1 + p[0] >= p_items_end)
+            break;
         p_decoded->i_item_description_length[idx] = p[0];
         p_decoded->i_item_description[idx] = &p_decoded->i_buffer[i_pos];
         memcpy( &p_decoded->i_buffer[i_pos], &p[1], p[0] );
         i_pos += p[0];
         p += 1 + p[0];
 
+        if (p + 1 + p[0] > p_items_end)
+            break;
         p_decoded->i_item_length[idx] = p[0];
         p_decoded->i_item[idx] = &p_decoded->i_buffer[i_pos];
         memcpy( &p_decoded->i_buffer[i_pos], &p[1], p[0] );
@@ -91,6 +102,8 @@ dvbpsi_dvb_extended_event_dr_t * dvbpsi_decode_dvb_extended_event_dr(dvbpsi_desc
     }
 
     p_decoded->i_text_length = p_descriptor->p_data[5+i_len];
+    if (5 + i_len + 1 + p_decoded->i_text_length > p_descriptor->i_length)
+        p_decoded->i_text_length = p_descriptor->i_length - (5 + i_len + 1);
     if( p_decoded->i_text_length > 0 )
         memcpy( &p_decoded->i_buffer[i_pos],
                 &p_descriptor->p_data[5+i_len+1], p_decoded->i_text_length );
@@ -37,7 +37,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_4f.h"
+/* dr_codec.h pulls in dr_4f.h through dr.h */
+#include "../dr_codec.h"
 
 /*****************************************************************************
  * dvbpsi_decode_dvb_tshifted_ev_dr
@@ -52,7 +53,7 @@ dvbpsi_dvb_tshifted_ev_dr_t* dvbpsi_decode_dvb_tshifted_ev_dr(dvbpsi_descriptor_
         return p_descriptor->p_decoded;
 
     /* Check the length */
-    if (p_descriptor->i_length < 4)
+    if (p_descriptor->i_length < DVBPSI_DVB_TSHIFTED_EV_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -62,10 +63,7 @@ dvbpsi_dvb_tshifted_ev_dr_t* dvbpsi_decode_dvb_tshifted_ev_dr(dvbpsi_descriptor_
         return NULL;
 
     /* Decode data */
-    p_decoded->i_ref_service_id = p_descriptor->p_data[0] << 8
-                                | p_descriptor->p_data[1];
-    p_decoded->i_ref_event_id = p_descriptor->p_data[2] << 8
-                                | p_descriptor->p_data[3];
+    dvbpsi_dvb_tshifted_ev_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -79,15 +77,12 @@ dvbpsi_descriptor_t *dvbpsi_gen_dvb_tshifted_ev_dr(dvbpsi_dvb_tshifted_ev_dr_t *
                                                   bool b_duplicate) {
     /* Create the descriptor */
     dvbpsi_descriptor_t * p_descriptor =
-            dvbpsi_NewDescriptor(0x4f, 4, NULL);
+            dvbpsi_NewDescriptor(0x4f, DVBPSI_DVB_TSHIFTED_EV_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-	p_descriptor->p_data[0] = p_decoded->i_ref_service_id >> 8;
-    p_descriptor->p_data[1] = p_decoded->i_ref_service_id;
-	p_descriptor->p_data[2] = p_decoded->i_ref_event_id >> 8;
-    p_descriptor->p_data[3] = p_decoded->i_ref_event_id;
+    dvbpsi_dvb_tshifted_ev_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
@@ -37,7 +37,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_52.h"
+/* dr_codec.h pulls in dr_52.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -56,7 +57,7 @@ dvbpsi_dvb_stream_identifier_dr_t * dvbpsi_decode_dvb_stream_identifier_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length < 1)
+    if (p_descriptor->i_length < DVBPSI_DVB_STREAM_IDENTIFIER_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -64,7 +65,7 @@ dvbpsi_dvb_stream_identifier_dr_t * dvbpsi_decode_dvb_stream_identifier_dr(
     if (!p_decoded)
         return NULL;
 
-    p_decoded->i_component_tag = p_descriptor->p_data[0];
+    dvbpsi_dvb_stream_identifier_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -80,12 +81,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_dvb_stream_identifier_dr(
                                         bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x52, 1, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x52, DVBPSI_DVB_STREAM_IDENTIFIER_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = p_decoded->i_component_tag;
+    dvbpsi_dvb_stream_identifier_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
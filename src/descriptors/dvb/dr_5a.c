@@ -55,6 +55,9 @@ dvbpsi_dvb_terr_deliv_sys_dr_t * dvbpsi_decode_dvb_terr_deliv_sys_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
+    if (p_descriptor->i_length < 11)
+        return NULL;
+
     /* Allocate memory */
     dvbpsi_dvb_terr_deliv_sys_dr_t * p_decoded;
     p_decoded = (dvbpsi_dvb_terr_deliv_sys_dr_t*)malloc(sizeof(dvbpsi_dvb_terr_deliv_sys_dr_t));
@@ -28,7 +28,7 @@
  */
 
 #ifndef _DR_65_H
-#define _DR_66_H
+#define _DR_65_H
 
 /*****************************************************************************
  * dvbpsi_dvb_scrambling_dr_s
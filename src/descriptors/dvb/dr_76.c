@@ -76,9 +76,16 @@ dvbpsi_dvb_content_id_dr_t *dvbpsi_decode_dvb_content_id_dr(dvbpsi_descriptor_t
 
         if (entry->i_location == CRID_LOCATION_DESCRIPTOR)
         {
+            if (byte >= p_descriptor->i_length)
+            {
+                free(p_decoded);
+                return NULL;
+            }
             uint8_t len = p_descriptor->p_data[byte];
             if (len > 253)
                 len = 253;
+            if (byte + 1 + len > p_descriptor->i_length)
+                len = p_descriptor->i_length - byte - 1;
 
             unsigned int i;
             byte ++;
@@ -88,11 +95,16 @@ dvbpsi_dvb_content_id_dr_t *dvbpsi_decode_dvb_content_id_dr(dvbpsi_descriptor_t
             }
             byte += len;
             /* Properly terminate the string */
-            unsigned int last = (i < len) ? i : len - 1U;
+            unsigned int last = (i < len || len == 0) ? i : len - 1U;
             entry->value.path[last] = 0;
         }
         else if (entry->i_location == CRID_LOCATION_CIT)
         {
+            if (byte + 2 > p_descriptor->i_length)
+            {
+                free(p_decoded);
+                return NULL;
+            }
             entry->value.ref = (p_descriptor->p_data[byte] << 8) | p_descriptor->p_data[byte + 1];
             byte += 2;
         }
@@ -231,7 +231,7 @@ dvbpsi_dvb_aac_dr_t *dvbpsi_decode_dvb_aac_dr(dvbpsi_descriptor_t *p_descriptor)
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length == 0x01)
+    if (p_descriptor->i_length < 0x02)
         return NULL;
 
     /* Allocate memory */
@@ -246,6 +246,11 @@ dvbpsi_dvb_aac_dr_t *dvbpsi_decode_dvb_aac_dr(dvbpsi_descriptor_t *p_descriptor)
     p_decoded->i_profile_and_level = dvbpsi_aac_profile_and_level_lookup(p_descriptor->p_data[0]);
     if (p_descriptor->i_length > 1)
         p_decoded->b_type = ((p_descriptor->p_data[1]>>7) == 0x01);
+    if (p_decoded->b_type && p_descriptor->i_length < 3)
+    {
+        free(p_decoded);
+        return NULL;
+    }
     if (p_decoded->b_type)
         p_decoded->i_type = dvbpsi_aac_type_lookup(p_descriptor->p_data[2]);
 
@@ -259,6 +264,7 @@ dvbpsi_dvb_aac_dr_t *dvbpsi_decode_dvb_aac_dr(dvbpsi_descriptor_t *p_descriptor)
             free(p_decoded);
             return NULL;
         }
+        p_decoded = p_tmp;
         p_decoded->p_additional_info = ((uint8_t*)p_tmp + sizeof(dvbpsi_dvb_aac_dr_t));
         p_decoded->i_additional_info_length = i_info_length;
 
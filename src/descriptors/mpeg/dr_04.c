@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_04.h"
+/* dr_codec.h pulls in dr_04.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -62,16 +63,13 @@ dvbpsi_mpeg_hierarchy_dr_t * dvbpsi_decode_mpeg_hierarchy_dr(
   if(!p_decoded) return NULL;
 
   /* Decode data and check the length */
-  if(p_descriptor->i_length != 4)
+  if(p_descriptor->i_length != DVBPSI_MPEG_HIERARCHY_DR_LEN)
   {
     free(p_decoded);
     return NULL;
   }
 
-  p_decoded->i_h_type = p_descriptor->p_data[0] & 0x0f;
-  p_decoded->i_h_layer_index = p_descriptor->p_data[1] & 0x3f;
-  p_decoded->i_h_embedded_layer = p_descriptor->p_data[2] & 0x3f;
-  p_decoded->i_h_priority = p_descriptor->p_data[3] & 0x3f;
+  dvbpsi_mpeg_hierarchy_dr_unpack(p_descriptor->p_data, p_decoded);
 
   p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -86,15 +84,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_hierarchy_dr(dvbpsi_mpeg_hierarchy_dr_t *
                                             bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x04, 4, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x04, DVBPSI_MPEG_HIERARCHY_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = 0xf0 | p_decoded->i_h_type;
-    p_descriptor->p_data[1] = 0xc0 | p_decoded->i_h_layer_index;
-    p_descriptor->p_data[2] = 0xc0 | p_decoded->i_h_embedded_layer;
-    p_descriptor->p_data[3] = 0xc0 | p_decoded->i_h_priority;
+    dvbpsi_mpeg_hierarchy_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_06.h"
+/* dr_codec.h pulls in dr_06.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -57,14 +58,14 @@ dvbpsi_mpeg_ds_alignment_dr_t * dvbpsi_decode_mpeg_ds_alignment_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length != 1)
+    if (p_descriptor->i_length != DVBPSI_MPEG_DS_ALIGNMENT_DR_LEN)
         return NULL;
 
     /* Allocate memory */
     p_decoded = (dvbpsi_mpeg_ds_alignment_dr_t*) malloc(sizeof(dvbpsi_mpeg_ds_alignment_dr_t));
     if(!p_decoded) return NULL;
 
-    p_decoded->i_alignment_type = p_descriptor->p_data[0];
+    dvbpsi_mpeg_ds_alignment_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -80,12 +81,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_ds_alignment_dr(
                                         bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x06, 1, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x06, DVBPSI_MPEG_DS_ALIGNMENT_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = p_decoded->i_alignment_type;
+    dvbpsi_mpeg_ds_alignment_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
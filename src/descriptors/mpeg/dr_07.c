@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_07.h"
+/* dr_codec.h pulls in dr_07.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -57,7 +58,7 @@ dvbpsi_mpeg_target_bg_grid_dr_t * dvbpsi_decode_mpeg_target_bg_grid_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length != 4)
+    if (p_descriptor->i_length != DVBPSI_MPEG_TARGET_BG_GRID_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -65,13 +66,7 @@ dvbpsi_mpeg_target_bg_grid_dr_t * dvbpsi_decode_mpeg_target_bg_grid_dr(
     if (!p_decoded)
         return NULL;
 
-    p_decoded->i_horizontal_size =   ((uint16_t)(p_descriptor->p_data[0]) << 6)
-            | ((p_descriptor->p_data[1] & 0xfc) >> 2);
-    p_decoded->i_vertical_size =
-            ((uint16_t)(p_descriptor->p_data[1] & 0x03) << 12)
-            | ((uint16_t)(p_descriptor->p_data[2]) << 4)
-            | ((p_descriptor->p_data[3] & 0xf0) >> 4);
-    p_decoded->i_pel_aspect_ratio = p_descriptor->p_data[3] & 0x0f;
+    dvbpsi_mpeg_target_bg_grid_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -86,17 +81,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_target_bg_grid_dr(dvbpsi_mpeg_target_bg_gr
                                                bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x07, 4, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x07, DVBPSI_MPEG_TARGET_BG_GRID_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = p_decoded->i_horizontal_size >> 6;
-    p_descriptor->p_data[1] =   (((uint8_t)p_decoded->i_horizontal_size) << 2)
-            | (p_decoded->i_vertical_size >> 12);
-    p_descriptor->p_data[2] = p_decoded->i_vertical_size >> 4;
-    p_descriptor->p_data[3] =   (((uint8_t)p_decoded->i_vertical_size) << 4)
-            | (p_decoded->i_pel_aspect_ratio & 0x0f);
+    dvbpsi_mpeg_target_bg_grid_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_08.h"
+/* dr_codec.h pulls in dr_08.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -56,7 +57,7 @@ dvbpsi_mpeg_vwindow_dr_t * dvbpsi_decode_mpeg_vwindow_dr(dvbpsi_descriptor_t * p
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length != 4)
+    if (p_descriptor->i_length != DVBPSI_MPEG_VWINDOW_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -64,13 +65,7 @@ dvbpsi_mpeg_vwindow_dr_t * dvbpsi_decode_mpeg_vwindow_dr(dvbpsi_descriptor_t * p
     if (!p_decoded)
         return NULL;
 
-    p_decoded->i_horizontal_offset =   ((uint16_t)(p_descriptor->p_data[0]) << 6)
-            | ((p_descriptor->p_data[1] & 0xfc) >> 2);
-    p_decoded->i_vertical_offset =
-            ((uint16_t)(p_descriptor->p_data[1] & 0x03) << 12)
-            | ((uint16_t)(p_descriptor->p_data[2]) << 4)
-            | ((p_descriptor->p_data[3] & 0xf0) >> 4);
-    p_decoded->i_window_priority = p_descriptor->p_data[3] & 0x0f;
+    dvbpsi_mpeg_vwindow_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -85,18 +80,14 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_vwindow_dr(dvbpsi_mpeg_vwindow_dr_t * p_de
                                           bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x08, 4, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x08, DVBPSI_MPEG_VWINDOW_DR_LEN, NULL);
 
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = p_decoded->i_horizontal_offset >> 6;
-    p_descriptor->p_data[1] =   (((uint8_t)p_decoded->i_horizontal_offset) << 2)
-            | (p_decoded->i_vertical_offset >> 12);
-    p_descriptor->p_data[2] = p_decoded->i_vertical_offset >> 4;
-    p_descriptor->p_data[3] =   (((uint8_t)p_decoded->i_vertical_offset) << 4)
-            | (p_decoded->i_window_priority & 0x0f);
+    dvbpsi_mpeg_vwindow_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
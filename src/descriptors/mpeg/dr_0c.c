@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_0c.h"
+/* dr_codec.h pulls in dr_0c.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -57,7 +58,7 @@ dvbpsi_mpeg_mx_buff_utilization_dr_t * dvbpsi_decode_mpeg_mx_buff_utilization_dr
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length != 3)
+    if (p_descriptor->i_length != DVBPSI_MPEG_MX_BUFF_UTILIZATION_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -66,11 +67,7 @@ dvbpsi_mpeg_mx_buff_utilization_dr_t * dvbpsi_decode_mpeg_mx_buff_utilization_dr
     if (!p_decoded)
         return NULL;
 
-    p_decoded->b_mdv_valid = (p_descriptor->p_data[0] & 0x80) ? true : false;
-    p_decoded->i_mx_delay_variation =
-            ((uint16_t)(p_descriptor->p_data[0] & 0x7f) << 8)
-            | p_descriptor->p_data[1];
-    p_decoded->i_mx_strategy = (p_descriptor->p_data[2] & 0xe0) >> 5;
+    dvbpsi_mpeg_mx_buff_utilization_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -86,16 +83,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_mx_buff_utilization_dr(
                                 bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x0c, 3, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x0c, DVBPSI_MPEG_MX_BUFF_UTILIZATION_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = (p_decoded->i_mx_delay_variation >> 8) & 0x7f;
-    if(p_decoded->b_mdv_valid)
-        p_descriptor->p_data[0] |= 0x80;
-    p_descriptor->p_data[1] = p_decoded->i_mx_delay_variation;
-    p_descriptor->p_data[2] = 0x1f | p_decoded->i_mx_strategy << 5;
+    dvbpsi_mpeg_mx_buff_utilization_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
@@ -38,7 +38,8 @@
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_0e.h"
+/* dr_codec.h pulls in dr_0e.h through dr.h */
+#include "../dr_codec.h"
 
 
 /*****************************************************************************
@@ -57,7 +58,7 @@ dvbpsi_mpeg_max_bitrate_dr_t * dvbpsi_decode_mpeg_max_bitrate_dr(
     if (dvbpsi_IsDescriptorDecoded(p_descriptor))
         return p_descriptor->p_decoded;
 
-    if (p_descriptor->i_length != 3)
+    if (p_descriptor->i_length != DVBPSI_MPEG_MAX_BITRATE_DR_LEN)
         return NULL;
 
     /* Allocate memory */
@@ -65,10 +66,7 @@ dvbpsi_mpeg_max_bitrate_dr_t * dvbpsi_decode_mpeg_max_bitrate_dr(
     if (!p_decoded)
         return NULL;
 
-    p_decoded->i_max_bitrate =
-            ((uint32_t)(p_descriptor->p_data[0] & 0x3f) << 16)
-            | ((uint32_t)(p_descriptor->p_data[1]) << 8)
-            | p_descriptor->p_data[2];
+    dvbpsi_mpeg_max_bitrate_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -82,14 +80,13 @@ dvbpsi_descriptor_t * dvbpsi_gen_mpeg_max_bitrate_dr(dvbpsi_mpeg_max_bitrate_dr_
                                              bool b_duplicate)
 {
     /* Create the descriptor */
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x0e, 3, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x0e, DVBPSI_MPEG_MAX_BITRATE_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* Encode data */
-    p_descriptor->p_data[0] = 0xc0 | ((p_decoded->i_max_bitrate >> 16) & 0x3f);
-    p_descriptor->p_data[1] = p_decoded->i_max_bitrate >> 8;
-    p_descriptor->p_data[2] = p_decoded->i_max_bitrate;
+    dvbpsi_mpeg_max_bitrate_dr_pack(p_decoded, p_descriptor->p_data);
 
     if (b_duplicate)
     {
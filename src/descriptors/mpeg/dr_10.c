@@ -31,7 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_10.h"
+/* dr_codec.h pulls in dr_10.h through dr.h */
+#include "../dr_codec.h"
 
 dvbpsi_mpeg_smoothing_buffer_dr_t* dvbpsi_decode_mpeg_smoothing_buffer_dr(
                                       dvbpsi_descriptor_t * p_descriptor)
@@ -47,22 +48,14 @@ dvbpsi_mpeg_smoothing_buffer_dr_t* dvbpsi_decode_mpeg_smoothing_buffer_dr(
         return p_descriptor->p_decoded;
     
     /* all descriptors of this type have 6 bytes of payload. */
-    if (p_descriptor->i_length != 6)
+    if (p_descriptor->i_length != DVBPSI_MPEG_SMOOTHING_BUFFER_DR_LEN)
         return NULL;
     
     p_decoded = (dvbpsi_mpeg_smoothing_buffer_dr_t*)malloc(sizeof(*p_decoded));
     if (!p_decoded)
         return NULL;
     
-    p_decoded->i_sb_leak_rate =
-        (((uint32_t)p_descriptor->p_data[0] & 0x3f) << 16)
-        | ((uint32_t)p_descriptor->p_data[1] << 8)
-        | p_descriptor->p_data[2];
-    
-    p_decoded->i_sb_size =
-        (((uint32_t)p_descriptor->p_data[3] & 0x3f) << 16)
-        | ((uint32_t)p_descriptor->p_data[4] << 8)
-        | p_descriptor->p_data[5];
+    dvbpsi_mpeg_smoothing_buffer_dr_unpack(p_descriptor->p_data, p_decoded);
     
     p_descriptor->p_decoded = (void*)p_decoded;
     
@@ -72,18 +65,13 @@ dvbpsi_mpeg_smoothing_buffer_dr_t* dvbpsi_decode_mpeg_smoothing_buffer_dr(
 dvbpsi_descriptor_t * dvbpsi_gen_mpeg_smoothing_buffer_dr(
                                       dvbpsi_mpeg_smoothing_buffer_dr_t * p_decoded)
 {
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x10, 6, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x10, DVBPSI_MPEG_SMOOTHING_BUFFER_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
     
     /* encode the data, making sure the reserved fields are set to all ones. */
-    p_descriptor->p_data[0] = (p_decoded->i_sb_leak_rate >> 16) | 0xc0;
-    p_descriptor->p_data[1] = p_decoded->i_sb_leak_rate >> 8;
-    p_descriptor->p_data[2] = p_decoded->i_sb_leak_rate;
-    
-    p_descriptor->p_data[3] = (p_decoded->i_sb_size >> 16) | 0xc0;
-    p_descriptor->p_data[4] = p_decoded->i_sb_size >> 8;
-    p_descriptor->p_data[5] = p_decoded->i_sb_size;
+    dvbpsi_mpeg_smoothing_buffer_dr_pack(p_decoded, p_descriptor->p_data);
     
     return p_descriptor;
 }
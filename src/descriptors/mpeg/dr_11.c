@@ -31,7 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_11.h"
+/* dr_codec.h pulls in dr_11.h through dr.h */
+#include "../dr_codec.h"
 
 dvbpsi_mpeg_std_dr_t* dvbpsi_decode_mpeg_std_dr(dvbpsi_descriptor_t * p_descriptor)
 {
@@ -46,14 +47,14 @@ dvbpsi_mpeg_std_dr_t* dvbpsi_decode_mpeg_std_dr(dvbpsi_descriptor_t * p_descript
         return p_descriptor->p_decoded;
 
     /* all descriptors of this type have 1 byte of payload. */
-    if (p_descriptor->i_length != 1)
+    if (p_descriptor->i_length != DVBPSI_MPEG_STD_DR_LEN)
         return NULL;
 
     p_decoded = (dvbpsi_mpeg_std_dr_t*)malloc(sizeof(*p_decoded));
     if (!p_decoded)
         return NULL;
 
-    p_decoded->b_leak_valid_flag = p_descriptor->p_data[0] & 0x01;
+    dvbpsi_mpeg_std_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = (void*)p_decoded;
 
@@ -62,12 +63,13 @@ dvbpsi_mpeg_std_dr_t* dvbpsi_decode_mpeg_std_dr(dvbpsi_descriptor_t * p_descript
 
 dvbpsi_descriptor_t * dvbpsi_gen_mpeg_std_dr(dvbpsi_mpeg_std_dr_t * p_decoded)
 {
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x11, 1, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x11, DVBPSI_MPEG_STD_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* encode the data, making sure the reserved fields are set to all ones. */
-    p_descriptor->p_data[0] = (0xfe | p_decoded->b_leak_valid_flag);
+    dvbpsi_mpeg_std_dr_pack(p_decoded, p_descriptor->p_data);
 
     return p_descriptor;
 }
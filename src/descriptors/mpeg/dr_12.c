@@ -31,7 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_12.h"
+/* dr_codec.h pulls in dr_12.h through dr.h */
+#include "../dr_codec.h"
 
 dvbpsi_mpeg_ibp_dr_t* dvbpsi_decode_mpeg_ibp_dr(dvbpsi_descriptor_t * p_descriptor)
 {
@@ -46,18 +47,14 @@ dvbpsi_mpeg_ibp_dr_t* dvbpsi_decode_mpeg_ibp_dr(dvbpsi_descriptor_t * p_descript
         return p_descriptor->p_decoded;
     
     /* all descriptors of this type have 2 bytes of payload. */
-    if (p_descriptor->i_length != 2)
+    if (p_descriptor->i_length != DVBPSI_MPEG_IBP_DR_LEN)
         return NULL;
     
     p_decoded = (dvbpsi_mpeg_ibp_dr_t*)malloc(sizeof(*p_decoded));
     if (!p_decoded)
         return NULL;
     
-    p_decoded->b_closed_gop_flag = p_descriptor->p_data[0] & 0x80;
-    p_decoded->b_identical_gop_flag = p_descriptor->p_data[0] & 0x40;
-    p_decoded->i_max_gop_length = 
-        (((uint16_t)p_descriptor->p_data[0] & 0x3f) << 8)
-        | p_descriptor->p_data[1];
+    dvbpsi_mpeg_ibp_dr_unpack(p_descriptor->p_data, p_decoded);
     
     /* a value of 0 is forbidden for max_gop_length. */
     if(p_decoded->i_max_gop_length == 0)
@@ -73,16 +70,13 @@ dvbpsi_mpeg_ibp_dr_t* dvbpsi_decode_mpeg_ibp_dr(dvbpsi_descriptor_t * p_descript
 
 dvbpsi_descriptor_t * dvbpsi_gen_mpeg_ibp_dr(dvbpsi_mpeg_ibp_dr_t * p_decoded)
 {
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x12, 2, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x12, DVBPSI_MPEG_IBP_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
     
     /* encode the data. */
-    p_descriptor->p_data[0]  = p_decoded->b_closed_gop_flag << 7;
-    p_descriptor->p_data[0] |= p_decoded->b_identical_gop_flag << 6;
-    p_descriptor->p_data[0] |= p_decoded->i_max_gop_length >> 8;
-    
-    p_descriptor->p_data[1] = p_decoded->i_max_gop_length;
+    dvbpsi_mpeg_ibp_dr_pack(p_decoded, p_descriptor->p_data);
     
     return p_descriptor;
 }
@@ -31,7 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../../dvbpsi_private.h"
 #include "../../descriptor.h"
 
-#include "dr_23.h"
+/* dr_codec.h pulls in dr_23.h through dr.h */
+#include "../dr_codec.h"
 
 dvbpsi_mpeg_mux_buf_dr_t* dvbpsi_decode_mpeg_mux_buf_dr(
                                       dvbpsi_descriptor_t * p_descriptor)
@@ -47,20 +48,14 @@ dvbpsi_mpeg_mux_buf_dr_t* dvbpsi_decode_mpeg_mux_buf_dr(
         return p_descriptor->p_decoded;
 
     /* all descriptors of this type must have 6 bytes of payload. */
-    if (p_descriptor->i_length != 6)
+    if (p_descriptor->i_length != DVBPSI_MPEG_MUX_BUF_DR_LEN)
         return NULL;
 
     p_decoded = malloc(sizeof(*p_decoded));
     if (!p_decoded)
         return NULL;
 
-    p_decoded->i_mb_buf_size =  ((p_descriptor->p_data[0] & 0xff) << 16)
-                              | ((p_descriptor->p_data[1] & 0xff) << 8)
-                              | p_descriptor->p_data[2];
-
-    p_decoded->i_tb_leak_rate =  ((p_descriptor->p_data[3] & 0xff) << 16)
-                               | ((p_descriptor->p_data[4] & 0xff) << 8)
-                               | p_descriptor->p_data[5];
+    dvbpsi_mpeg_mux_buf_dr_unpack(p_descriptor->p_data, p_decoded);
 
     p_descriptor->p_decoded = p_decoded;
 
@@ -70,17 +65,13 @@ dvbpsi_mpeg_mux_buf_dr_t* dvbpsi_decode_mpeg_mux_buf_dr(
 dvbpsi_descriptor_t * dvbpsi_gen_mpeg_mux_buf_dr(
                                       dvbpsi_mpeg_mux_buf_dr_t * p_decoded)
 {
-    dvbpsi_descriptor_t * p_descriptor = dvbpsi_NewDescriptor(0x23, 6, NULL);
+    dvbpsi_descriptor_t * p_descriptor =
+            dvbpsi_NewDescriptor(0x23, DVBPSI_MPEG_MUX_BUF_DR_LEN, NULL);
     if (!p_descriptor)
         return NULL;
 
     /* encode the data. */
-    p_descriptor->p_data[0] = p_decoded->i_mb_buf_size >> 16;
-    p_descriptor->p_data[1] = p_decoded->i_mb_buf_size >> 8;
-    p_descriptor->p_data[2] = p_decoded->i_mb_buf_size;
-    p_descriptor->p_data[3] = p_decoded->i_tb_leak_rate >> 16;
-    p_descriptor->p_data[4] = p_decoded->i_tb_leak_rate >> 8;
-    p_descriptor->p_data[5] = p_decoded->i_tb_leak_rate;
+    dvbpsi_mpeg_mux_buf_dr_pack(p_decoded, p_descriptor->p_data);
 
     return p_descriptor;
 }
@@ -44,6 +44,7 @@
 #include "dvbpsi.h"
 #include "dvbpsi_private.h"
 #include "psi.h"
+#include "ts.h"
 
 /*****************************************************************************
  * dvbpsi_new
@@ -72,6 +73,128 @@ void dvbpsi_delete(dvbpsi_t *p_dvbpsi)
     free(p_dvbpsi);
 }
 
+/*****************************************************************************
+ * dvbpsi_budget_set
+ *****************************************************************************/
+void dvbpsi_budget_set(dvbpsi_t *p_dvbpsi, const size_t i_max_bytes,
+                       const unsigned int i_max_subtables)
+{
+    assert(p_dvbpsi);
+
+    p_dvbpsi->budget.i_max_bytes = i_max_bytes;
+    p_dvbpsi->budget.i_max_subtables = i_max_subtables;
+}
+
+/*****************************************************************************
+ * dvbpsi_budget_get
+ *****************************************************************************/
+void dvbpsi_budget_get(const dvbpsi_t *p_dvbpsi, dvbpsi_budget_t *p_budget)
+{
+    assert(p_dvbpsi);
+    assert(p_budget);
+
+    *p_budget = p_dvbpsi->budget;
+}
+
+/*****************************************************************************
+ * dvbpsi_errors_get
+ *****************************************************************************/
+void dvbpsi_errors_get(const dvbpsi_t *p_dvbpsi, dvbpsi_errors_t *p_errors)
+{
+    assert(p_dvbpsi);
+    assert(p_errors);
+
+    *p_errors = p_dvbpsi->errors;
+}
+
+/*****************************************************************************
+ * dvbpsi_trace_set
+ *****************************************************************************/
+bool dvbpsi_trace_set(dvbpsi_t *p_dvbpsi, const dvbpsi_trace_t *p_trace)
+{
+    assert(p_dvbpsi);
+
+    if (p_trace)
+        p_dvbpsi->trace = *p_trace;
+    else
+        memset(&p_dvbpsi->trace, 0, sizeof(dvbpsi_trace_t));
+#ifdef DVBPSI_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef DVBPSI_TRACE
+/*****************************************************************************
+ * dvbpsi_trace_emit
+ *****************************************************************************/
+void dvbpsi_trace_emit(dvbpsi_t *p_dvbpsi, const dvbpsi_trace_stage_t i_stage,
+                       const bool b_end, const uint8_t i_table_id,
+                       const uint16_t i_extension)
+{
+    const dvbpsi_trace_event_t event = {
+        .i_stage = i_stage,
+        .i_pid = p_dvbpsi->i_trace_pid,
+        .i_table_id = i_table_id,
+        .i_extension = i_extension,
+    };
+    if (b_end)
+        p_dvbpsi->trace.pf_end(p_dvbpsi->trace.p_cb_data, &event);
+    else
+        p_dvbpsi->trace.pf_begin(p_dvbpsi->trace.p_cb_data, &event);
+}
+#endif
+
+/*****************************************************************************
+ * dvbpsi_decoder_release
+ *****************************************************************************
+ * Return the bytes charged for the sections of a decoder to its handle.
+ *****************************************************************************/
+static void dvbpsi_decoder_release(dvbpsi_decoder_t *p_decoder)
+{
+    if (p_decoder->p_owner)
+    {
+        assert(p_decoder->p_owner->budget.i_bytes >= p_decoder->i_sections_size);
+        p_decoder->p_owner->budget.i_bytes -= p_decoder->i_sections_size;
+    }
+    p_decoder->i_sections_size = 0;
+}
+
+/*****************************************************************************
+ * dvbpsi_budget_reclaim
+ *****************************************************************************
+ * Drop sections of least recently updated incomplete subtables, other than
+ * p_keep, until i_size more bytes fit in the budget.
+ *****************************************************************************/
+static void dvbpsi_budget_reclaim(dvbpsi_t *p_dvbpsi, const dvbpsi_decoder_t *p_keep,
+                                  const size_t i_size)
+{
+    dvbpsi_budget_t *p_budget = &p_dvbpsi->budget;
+
+    while (p_budget->i_bytes + i_size > p_budget->i_max_bytes)
+    {
+        /* Decoders holding sections are waiting for their table to complete */
+        dvbpsi_decoder_t *p_lru = NULL;
+        dvbpsi_decoder_t *p = p_dvbpsi->p_decoder;
+        while (p)
+        {
+            if ((p != p_keep) && p->p_sections &&
+                (!p_lru || (int32_t)(p->i_last_used - p_lru->i_last_used) < 0))
+                p_lru = p;
+            p = p->p_next;
+        }
+        if (!p_lru)
+            break;
+
+        dvbpsi_warning(p_dvbpsi, "budget",
+                       "evicting incomplete subtable (table id: %u, extension: %u)",
+                       p_lru->i_table_id, p_lru->i_extension);
+        dvbpsi_decoder_reset(p_lru, false);
+        p_budget->i_evictions++;
+    }
+}
+
 /*****************************************************************************
  * dvbpsi_decoder_new
  *****************************************************************************/
@@ -105,9 +228,53 @@ void *dvbpsi_decoder_new(dvbpsi_callback_gather_t pf_gather,
     p_decoder->p_sections = NULL;
     p_decoder->b_complete_header = false;
 
+    p_decoder->pp_sections_slots = NULL;
+    memset(p_decoder->ai_sections_received, 0, sizeof(p_decoder->ai_sections_received));
+
+    p_decoder->p_owner = NULL;
+    p_decoder->i_sections_size = 0;
+    p_decoder->i_last_used = 0;
+
     return p_decoder;
 }
 
+/*****************************************************************************
+ * Received sections bitmap helpers
+ *****************************************************************************/
+#if defined(__GNUC__)
+#   define dvbpsi_popcount64(x) __builtin_popcountll(x)
+#   define dvbpsi_msb64(x)      (63 - __builtin_clzll(x))
+#else
+static inline int dvbpsi_popcount64(uint64_t x)
+{
+    int i_count = 0;
+    for (; x; x &= x - 1)
+        i_count++;
+    return i_count;
+}
+static inline int dvbpsi_msb64(uint64_t x)
+{
+    int i_msb = 0;
+    while (x >>= 1)
+        i_msb++;
+    return i_msb;
+}
+#endif
+
+/* Highest received section number below i_number, or -1 */
+static inline int dvbpsi_sections_prev(const uint64_t *p_received, const uint8_t i_number)
+{
+    int i_word = i_number >> 6;
+    uint64_t i_bits = p_received[i_word] & ((UINT64_C(1) << (i_number & 63)) - 1);
+    while (i_bits == 0)
+    {
+        if (--i_word < 0)
+            return -1;
+        i_bits = p_received[i_word];
+    }
+    return (i_word << 6) + dvbpsi_msb64(i_bits);
+}
+
 /*****************************************************************************
  * dvbpsi_decoder_reset
  *****************************************************************************/
@@ -120,8 +287,19 @@ void dvbpsi_decoder_reset(dvbpsi_decoder_t* p_decoder, const bool b_force)
         p_decoder->b_current_valid = false;
 
     /* Clear the section array */
+    if (p_decoder->pp_sections_slots)
+    {
+        dvbpsi_psi_section_t *p = p_decoder->p_sections;
+        while (p)
+        {
+            p_decoder->pp_sections_slots[p->i_number] = NULL;
+            p = p->p_next;
+        }
+    }
+    memset(p_decoder->ai_sections_received, 0, sizeof(p_decoder->ai_sections_received));
     dvbpsi_DeletePSISections(p_decoder->p_sections);
     p_decoder->p_sections = NULL;
+    dvbpsi_decoder_release(p_decoder);
 }
 
 /*****************************************************************************
@@ -131,22 +309,18 @@ bool dvbpsi_decoder_psi_sections_completed(dvbpsi_decoder_t* p_decoder)
 {
     assert(p_decoder);
 
-    bool b_complete = false;
+    /* Complete when sections 0 up to last_section_number have been received */
+    const unsigned int i_last = p_decoder->i_last_section_number;
+    const uint64_t *p_received = p_decoder->ai_sections_received;
+    unsigned int i_count = 0;
 
-    dvbpsi_psi_section_t *p = p_decoder->p_sections;
-    unsigned int prev_nr = 0;
-    while (p)
-    {
-        assert(prev_nr < 256);
-        if (prev_nr != p->i_number)
-            break;
-        if (p_decoder->i_last_section_number == p->i_number)
-            b_complete = true;
-        p = p->p_next;
-        prev_nr++;
-    }
+    for (unsigned int i_word = 0; i_word < (i_last >> 6); i_word++)
+        i_count += dvbpsi_popcount64(p_received[i_word]);
+    uint64_t i_mask = ((i_last & 63) == 63) ? UINT64_MAX
+                    : (UINT64_C(1) << ((i_last & 63) + 1)) - 1;
+    i_count += dvbpsi_popcount64(p_received[i_last >> 6] & i_mask);
 
-    return b_complete;
+    return (i_count == i_last + 1);
 }
 
 /*****************************************************************************
@@ -158,72 +332,72 @@ bool dvbpsi_decoder_psi_section_add(dvbpsi_decoder_t *p_decoder, dvbpsi_psi_sect
     assert(p_section);
     assert(p_section->p_next == NULL);
 
-    /* Empty list */
-    if (!p_decoder->p_sections)
+    /* Charge the section to the handle, making room for it if needed */
+    const size_t i_cost = sizeof(dvbpsi_psi_section_t) + p_decoder->i_section_max_size;
+    dvbpsi_t *p_owner = p_decoder->p_owner;
+    if (p_owner)
     {
-        p_decoder->p_sections = p_section;
-        p_section->p_next = NULL;
-        return false;
+        if (p_owner->budget.i_max_bytes > 0)
+            dvbpsi_budget_reclaim(p_owner, p_decoder, i_cost);
+        p_owner->budget.i_bytes += i_cost;
+        p_decoder->i_last_used = ++p_owner->budget.i_clock;
     }
+    p_decoder->i_sections_size += i_cost;
 
-    /* Insert in right place */
-    dvbpsi_psi_section_t *p = p_decoder->p_sections;
-    dvbpsi_psi_section_t *p_prev = NULL;
-    bool b_overwrite = false;
-
-    while (p)
+    /* Section slots are allocated on first use and kept until the decoder is
+     * deleted. Without them fall back to walking the sorted list. */
+    if (!p_decoder->pp_sections_slots)
     {
-        if (p->i_number == p_section->i_number)
+        p_decoder->pp_sections_slots = calloc(256, sizeof(dvbpsi_psi_section_t *));
+        dvbpsi_psi_section_t *p = p_decoder->pp_sections_slots ? p_decoder->p_sections : NULL;
+        while (p)
         {
-            /* Replace */
-            if (p_prev)
-            {
-                p_prev->p_next = p_section;
-                p_section->p_next = p->p_next;
-                p->p_next = NULL;
-                dvbpsi_DeletePSISections(p);
-                b_overwrite = true;
-            }
-            else
-            {
-                p_section->p_next = p->p_next;
-                p->p_next = NULL;
-                dvbpsi_DeletePSISections(p);
-                p = p_section;
-                p_decoder->p_sections = p;
-                b_overwrite = true;
-            }
-            goto out;
-        }
-        else if (p->i_number > p_section->i_number)
-        {
-            /* Insert before p */
-            if (p_prev)
-            {
-                p_prev->p_next = p_section;
-                p_section->p_next = p;
-            }
-            else
-            {
-                p_section->p_next = p;
-                p_decoder->p_sections = p_section;
-            }
-            goto out;
+            p_decoder->pp_sections_slots[p->i_number] = p;
+            p = p->p_next;
         }
+    }
 
-        p_prev = p;
-        p = p->p_next;
+    /* Find the link after which the section goes */
+    const uint8_t i_number = p_section->i_number;
+    const uint64_t i_bit = UINT64_C(1) << (i_number & 63);
+    const bool b_overwrite = p_decoder->ai_sections_received[i_number >> 6] & i_bit;
+    dvbpsi_psi_section_t **pp_link = &p_decoder->p_sections;
+    if (p_decoder->pp_sections_slots)
+    {
+        int i_prev = dvbpsi_sections_prev(p_decoder->ai_sections_received, i_number);
+        if (i_prev >= 0)
+            pp_link = &p_decoder->pp_sections_slots[i_prev]->p_next;
+    }
+    else
+    {
+        while (*pp_link && ((*pp_link)->i_number < i_number))
+            pp_link = &(*pp_link)->p_next;
     }
 
-    /* Add to end of list */
-    if (p_prev->i_number < p_section->i_number)
+    if (b_overwrite)
+    {
+        /* Replace */
+        dvbpsi_psi_section_t *p_old = *pp_link;
+        assert(p_old && (p_old->i_number == i_number));
+        p_section->p_next = p_old->p_next;
+        p_old->p_next = NULL;
+        dvbpsi_DeletePSISections(p_old);
+
+        /* The replaced section was charged too */
+        if (p_owner)
+            p_owner->budget.i_bytes -= i_cost;
+        p_decoder->i_sections_size -= i_cost;
+    }
+    else
     {
-        p_decoder->i_last_section_number = p_section->i_number;
-        p_prev->p_next = p_section;
-        p_section->p_next = NULL;
+        /* Insert */
+        p_section->p_next = *pp_link;
+        p_decoder->ai_sections_received[i_number >> 6] |= i_bit;
     }
+    *pp_link = p_section;
+    if (p_decoder->pp_sections_slots)
+        p_decoder->pp_sections_slots[i_number] = p_section;
 
-out:
     return b_overwrite;
 }
 
@@ -239,8 +413,10 @@ void dvbpsi_decoder_delete(dvbpsi_decoder_t *p_decoder)
         dvbpsi_DeletePSISections(p_decoder->p_sections);
         p_decoder->p_sections = NULL;
     }
+    dvbpsi_decoder_release(p_decoder);
 
     dvbpsi_DeletePSISections(p_decoder->p_current_section);
+    free(p_decoder->pp_sections_slots);
     free(p_decoder);
 }
 
@@ -256,11 +432,36 @@ bool dvbpsi_decoder_present(dvbpsi_t *p_dvbpsi)
 }
 
 /*****************************************************************************
- * dvbpsi_packet_push
+ * dvbpsi_section_check
  *****************************************************************************
- * Injection of a TS packet into a PSI decoder.
+ * CRC_32 check, skipped when the section cache holds the same bytes.
  *****************************************************************************/
-bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
+static bool dvbpsi_section_check(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section)
+{
+#ifdef HAVE_PTHREAD_H
+    if (p_dvbpsi->p_section_cache)
+    {
+        if (dvbpsi_section_cache_match(p_dvbpsi->p_section_cache, p_section))
+            return true;
+        if (!dvbpsi_ValidPSISection(p_section))
+            return false;
+        dvbpsi_section_cache_insert(p_dvbpsi->p_section_cache, p_section);
+        return true;
+    }
+#endif
+    return dvbpsi_ValidPSISection(p_section);
+}
+
+/*****************************************************************************
+ * dvbpsi_packet_push_header
+ *****************************************************************************
+ * Injection of a TS packet into a PSI decoder, the header fields it needs
+ * decoded already: DVBPSI_TS_PUSI and DVBPSI_TS_PAYLOAD flags, continuity
+ * counter and payload offset.
+ *****************************************************************************/
+static bool dvbpsi_packet_push_header(dvbpsi_t *p_dvbpsi, const uint8_t* p_data,
+                                      const uint8_t i_flags, const uint8_t i_cc,
+                                      const unsigned int i_payload)
 {
     uint8_t i_expected_counter;           /* Expected continuity counter */
     dvbpsi_psi_section_t* p_section;      /* Current section */
@@ -273,22 +474,16 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
 
     dvbpsi_decoder_t *p_decoder = p_dvbpsi->p_decoder;
     assert(p_decoder);
-
-    /* TS start code */
-    if (p_data[0] != 0x47)
-    {
-        dvbpsi_error(p_dvbpsi, "PSI decoder", "not a TS packet");
-        return false;
-    }
+    dvbpsi_trace_pid(p_dvbpsi, ((uint16_t)(p_data[1] & 0x1f) << 8) | p_data[2]);
 
     /* Continuity check */
     const bool b_first = (p_decoder->i_continuity_counter == DVBPSI_INVALID_CC);
     if (b_first)
-        p_decoder->i_continuity_counter = p_data[3] & 0xf;
+        p_decoder->i_continuity_counter = i_cc;
     else
     {
         i_expected_counter = (p_decoder->i_continuity_counter + 1) & 0xf;
-        p_decoder->i_continuity_counter = p_data[3] & 0xf;
+        p_decoder->i_continuity_counter = i_cc;
 
         if (i_expected_counter == ((p_decoder->i_continuity_counter + 1) & 0xf)
             && !p_decoder->b_discontinuity)
@@ -306,6 +501,7 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                      "TS discontinuity (received %d, expected %d) for PID %d",
                      p_decoder->i_continuity_counter, i_expected_counter,
                      ((uint16_t)(p_data[1] & 0x1f) << 8) | p_data[2]);
+            p_dvbpsi->errors.i_cc_errors++;
             p_decoder->b_discontinuity = true;
             if (p_decoder->p_current_section)
             {
@@ -316,17 +512,14 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
     }
 
     /* Return if no payload in the TS packet */
-    if (!(p_data[3] & 0x10))
+    if (!(i_flags & DVBPSI_TS_PAYLOAD))
         return false;
 
     /* Skip the adaptation_field if present */
-    if (p_data[3] & 0x20)
-        p_payload_pos = p_data + 5 + p_data[4];
-    else
-        p_payload_pos = p_data + 4;
+    p_payload_pos = p_data + i_payload;
 
     /* Payload unit start indicator -> skip the pointer_field and a new section begins */
-    if (p_data[1] & 0x40)
+    if (i_flags & DVBPSI_TS_PUSI)
     {
         p_new_pos = p_payload_pos + *p_payload_pos + 1;
         p_payload_pos += 1;
@@ -353,6 +546,7 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
             /* Just need the header to know how long is the section */
             p_decoder->i_need = 3;
             p_decoder->b_complete_header = false;
+            dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_REASSEMBLY, 0xff, 0);
         }
         else
         {
@@ -387,6 +581,7 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                 if (p_decoder->i_need > p_decoder->i_section_max_size - 3)
                 {
                     dvbpsi_error(p_dvbpsi, "PSI decoder", "PSI section too long");
+                    p_dvbpsi->errors.i_length_errors++;
                     dvbpsi_DeletePSISections(p_section);
                     p_decoder->p_current_section = NULL;
                     /* If there is a new section not being handled then go forward
@@ -402,6 +597,7 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                         p_new_pos = NULL;
                         p_decoder->i_need = 3;
                         p_decoder->b_complete_header = false;
+                        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_REASSEMBLY, 0xff, 0);
                         i_available = 188 + p_data - p_payload_pos;
                     }
                     else
@@ -419,6 +615,10 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                 p_section->i_table_id = p_section->p_data[0];
                 p_section->b_syntax_indicator = p_section->p_data[1] & 0x80;
                 p_section->b_private_indicator = p_section->p_data[1] & 0x40;
+                p_section->i_extension = p_section->b_syntax_indicator ?
+                                         (p_section->p_data[3] << 8) | p_section->p_data[4] : 0;
+                dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_REASSEMBLY,
+                                 p_section->i_table_id, p_section->i_extension);
 
                 /* Update the end of the payload if CRC_32 is present */
                 has_crc32 = dvbpsi_has_CRC32(p_section);
@@ -426,16 +626,18 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                     p_section->p_payload_end -= 4;
 
                 /* Check CRC32 if present */
+                dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CRC,
+                                   p_section->i_table_id, p_section->i_extension);
                 if (has_crc32)
-                    b_valid_crc32 = dvbpsi_ValidPSISection(p_section);
+                    b_valid_crc32 = dvbpsi_section_check(p_dvbpsi, p_section);
+                dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CRC,
+                                 p_section->i_table_id, p_section->i_extension);
 
                 if (!has_crc32 || b_valid_crc32)
                 {
                     /* PSI section is valid */
                     if (p_section->b_syntax_indicator)
                     {
-                        p_section->i_extension =  (p_section->p_data[3] << 8)
-                                                 | p_section->p_data[4];
                         p_section->i_version = (p_section->p_data[5] & 0x3e) >> 1;
                         p_section->b_current_next = p_section->p_data[5] & 0x1;
                         p_section->i_number = p_section->p_data[6];
@@ -444,22 +646,29 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                     }
                     else
                     {
-                        p_section->i_extension = 0;
                         p_section->i_version = 0;
                         p_section->b_current_next = true;
                         p_section->i_number = 0;
                         p_section->i_last_number = 0;
                         p_section->p_payload_start = p_section->p_data + 3;
                     }
+                    /* The gather function may free the section */
+                    const uint8_t i_table_id = p_section->i_table_id;
+                    const uint16_t i_extension = p_section->i_extension;
+                    dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_GATHER, i_table_id, i_extension);
                     if (p_decoder->pf_gather)
                         p_decoder->pf_gather(p_dvbpsi, p_section);
+                    dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_GATHER, i_table_id, i_extension);
                     p_decoder->p_current_section = NULL;
                 }
                 else
                 {
                     if (has_crc32 && !dvbpsi_ValidPSISection(p_section))
+                    {
                         dvbpsi_error(p_dvbpsi, "misc PSI", "Bad CRC_32 table 0x%x !!!",
                                                p_section->p_data[0]);
+                        p_dvbpsi->errors.i_crc_errors++;
+                    }
                     else
                         dvbpsi_error(p_dvbpsi, "misc PSI", "table 0x%x", p_section->p_data[0]);
 
@@ -487,6 +696,7 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
                     p_new_pos = NULL;
                     p_decoder->i_need = 3;
                     p_decoder->b_complete_header = false;
+                    dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_REASSEMBLY, 0xff, 0);
                     i_available = 188 + p_data - p_payload_pos;
                 }
                 else
@@ -507,6 +717,47 @@ bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
     }
     return true;
 }
+
+/*****************************************************************************
+ * dvbpsi_packet_push
+ *****************************************************************************
+ * Injection of a TS packet into a PSI decoder.
+ *****************************************************************************/
+bool dvbpsi_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t* p_data)
+{
+    /* TS start code */
+    if (p_data[0] != 0x47)
+    {
+        dvbpsi_error(p_dvbpsi, "PSI decoder", "not a TS packet");
+        return false;
+    }
+
+    uint8_t i_flags = p_data[1] & DVBPSI_TS_PUSI;
+    unsigned int i_payload = 4;
+    if (p_data[3] & 0x10)
+        i_flags |= DVBPSI_TS_PAYLOAD;
+    if (p_data[3] & 0x20)
+        i_payload += 1 + p_data[4];
+    /* a broken adaptation_field_length leaves no payload */
+    if (i_payload >= DVBPSI_TS_PACKET_SIZE)
+        i_flags &= ~DVBPSI_TS_PAYLOAD;
+
+    return dvbpsi_packet_push_header(p_dvbpsi, p_data, i_flags, p_data[3] & 0x0f, i_payload);
+}
+
+/*****************************************************************************
+ * dvbpsi_ts_packet_push
+ *****************************************************************************/
+bool dvbpsi_ts_packet_push(dvbpsi_t *p_dvbpsi, const uint8_t *p_buf,
+                           const dvbpsi_ts_headers_t *p_headers, const size_t i_packet)
+{
+    assert(i_packet < p_headers->i_count);
+
+    const uint8_t *p_data = &p_buf[p_headers->pi_offset[i_packet]];
+    return dvbpsi_packet_push_header(p_dvbpsi, p_data, p_headers->pi_flags[i_packet],
+                                     p_headers->pi_cc[i_packet],
+                                     p_headers->pi_payload[i_packet]);
+}
 #undef DVBPSI_INVALID_CC
 
 /*****************************************************************************
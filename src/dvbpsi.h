@@ -139,6 +139,113 @@ typedef struct dvbpsi_decoder_s dvbpsi_decoder_t;
  * \typedef struct dvbpsi_s dvbpsi_t
  * \brief dvbpsi_t type definition.
  */
+/*****************************************************************************
+ * dvbpsi_budget_t
+ *****************************************************************************/
+/*!
+ * \struct dvbpsi_budget_s
+ * \brief Resource limits and usage of a dvbpsi_t handle.
+ *
+ * Bounds the memory a (possibly hostile) stream can make the decoders hold.
+ * Only PSI sections waiting for their table to complete are counted, each
+ * at the section size of its decoder. @see dvbpsi_budget_set()
+ */
+/*!
+ * \typedef struct dvbpsi_budget_s dvbpsi_budget_t
+ * \brief dvbpsi_budget_t type definition.
+ */
+typedef struct dvbpsi_budget_s
+{
+    size_t       i_max_bytes;       /*!< Limit on buffered section bytes, 0 for none */
+    unsigned int i_max_subtables;   /*!< Limit on chained subtable decoders, 0 for none */
+
+    size_t       i_bytes;           /*!< Section bytes currently buffered */
+    unsigned int i_subtables;       /*!< Subtable decoders currently chained */
+    uint64_t     i_evictions;       /*!< Incomplete subtables evicted so far */
+    uint32_t     i_clock;           /*!< LRU clock, private */
+} dvbpsi_budget_t;
+
+/*****************************************************************************
+ * dvbpsi_errors_t
+ *****************************************************************************/
+/*!
+ * \struct dvbpsi_errors_s
+ * \brief Stream errors met by the decoders of a dvbpsi_t handle.
+ *
+ * Counted by dvbpsi_packet_push(), so a monitoring application can tell
+ * them apart without parsing log messages. @see dvbpsi_errors_get()
+ */
+/*!
+ * \typedef struct dvbpsi_errors_s dvbpsi_errors_t
+ * \brief dvbpsi_errors_t type definition.
+ */
+typedef struct dvbpsi_errors_s
+{
+    uint64_t     i_cc_errors;       /*!< TS continuity counter discontinuities */
+    uint64_t     i_crc_errors;      /*!< PSI sections dropped for a bad CRC_32 */
+    uint64_t     i_length_errors;   /*!< PSI sections dropped for being too long */
+} dvbpsi_errors_t;
+
+/*****************************************************************************
+ * dvbpsi_trace_t
+ *****************************************************************************/
+/*!
+ * \enum dvbpsi_trace_stage_e
+ * \brief Stages from the TS packets of a section to the table callback.
+ */
+/*!
+ * \typedef enum dvbpsi_trace_stage_e dvbpsi_trace_stage_t
+ * \brief dvbpsi_trace_stage_t type definition.
+ */
+typedef enum dvbpsi_trace_stage_e
+{
+    DVBPSI_TRACE_REASSEMBLY = 0, /*!< First packet of a section to its last byte */
+    DVBPSI_TRACE_CRC,            /*!< CRC_32 check of the complete section */
+    DVBPSI_TRACE_GATHER,         /*!< Table decoder gather function, includes the
+                                      next two stages when the table completes */
+    DVBPSI_TRACE_DECODE,         /*!< Decoding of the sections of a complete table */
+    DVBPSI_TRACE_CALLBACK,       /*!< Application table callback */
+    DVBPSI_TRACE_STAGES          /*!< Number of stages */
+} dvbpsi_trace_stage_t;
+
+/*!
+ * \struct dvbpsi_trace_event_s
+ * \brief Stage being entered or left.
+ */
+/*!
+ * \typedef struct dvbpsi_trace_event_s dvbpsi_trace_event_t
+ * \brief dvbpsi_trace_event_t type definition.
+ */
+typedef struct dvbpsi_trace_event_s
+{
+    dvbpsi_trace_stage_t i_stage;   /*!< Stage */
+    uint16_t     i_pid;             /*!< PID of the packet being pushed */
+    uint8_t      i_table_id;        /*!< table_id, 0xff when DVBPSI_TRACE_REASSEMBLY
+                                         begins as the section header is not read yet */
+    uint16_t     i_extension;       /*!< table_id_extension, 0 for short sections */
+} dvbpsi_trace_event_t;
+
+/*!
+ * \typedef void (* dvbpsi_trace_cb)(void *p_cb_data, const dvbpsi_trace_event_t *p_event)
+ * \brief Tracing hook, called from dvbpsi_packet_push() on the pushing thread.
+ */
+typedef void (* dvbpsi_trace_cb)(void *p_cb_data, const dvbpsi_trace_event_t *p_event);
+
+/*!
+ * \struct dvbpsi_trace_s
+ * \brief Tracing hooks of a dvbpsi_t handle. @see dvbpsi_trace_set()
+ */
+/*!
+ * \typedef struct dvbpsi_trace_s dvbpsi_trace_t
+ * \brief dvbpsi_trace_t type definition.
+ */
+typedef struct dvbpsi_trace_s
+{
+    dvbpsi_trace_cb pf_begin;       /*!< Called when a stage begins, may be NULL */
+    dvbpsi_trace_cb pf_end;         /*!< Called when it ends, may be NULL */
+    void           *p_cb_data;      /*!< First argument of both hooks */
+} dvbpsi_trace_t;
+
 struct dvbpsi_s
 {
     dvbpsi_decoder_t             *p_decoder;          /*!< private pointer to chain of decoders,
@@ -147,6 +254,19 @@ struct dvbpsi_s
     dvbpsi_message_cb             pf_message;           /*!< Log message callback */
     enum dvbpsi_msg_level         i_msg_level;          /*!< Log level */
 
+    /* Resource limits, @see dvbpsi_budget_set() */
+    dvbpsi_budget_t               budget;               /*!< Memory budget and usage */
+
+    /* Stream errors, @see dvbpsi_errors_get() */
+    dvbpsi_errors_t               errors;               /*!< Error counters */
+
+    /* Latency tracing, @see dvbpsi_trace_set() */
+    dvbpsi_trace_t                trace;                /*!< Tracing hooks */
+    uint16_t                      i_trace_pid;          /*!< PID of the packet being pushed */
+
+    /* Shared section cache, @see dvbpsi_section_cache_attach() */
+    struct dvbpsi_section_cache_s *p_section_cache;     /*!< Cache of verified sections */
+
     /* private data pointer for use by caller, not by libdvbpsi itself ! */
     void                         *p_sys;                /*!< pointer to private data
                                                           from caller. Do not use
@@ -184,6 +304,76 @@ dvbpsi_t *dvbpsi_new(dvbpsi_message_cb callback, enum dvbpsi_msg_level level);
  */
 void dvbpsi_delete(dvbpsi_t *p_dvbpsi);
 
+/*****************************************************************************
+ * dvbpsi_budget_set
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_budget_set(dvbpsi_t *p_dvbpsi, const size_t i_max_bytes,
+ *                            const unsigned int i_max_subtables)
+ * \brief Limit the resources decoders attached to a dvbpsi_t handle may use.
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param i_max_bytes maximum bytes of buffered PSI sections, 0 for no limit
+ * \param i_max_subtables maximum number of chained subtable decoders, 0 for no limit
+ * \return nothing
+ *
+ * When adding a section would exceed i_max_bytes, the sections of the least
+ * recently updated incomplete subtables are dropped; the subtable receiving
+ * the section is never evicted. When attaching a decoder would exceed
+ * i_max_subtables, the least recently updated subtable decoder which never
+ * completed a table is detached (through the chain demux pf_del callback if
+ * there is one), otherwise the attach fails. It also fails when pf_del does
+ * not detach that decoder. Both count as evictions.
+ *
+ * Only decoders added with dvbpsi_decoder_chain_add(), as every table attach
+ * function does, are charged. A decoder the application creates with
+ * dvbpsi_decoder_new() and never adds to the chain has no handle to charge
+ * and is not limited.
+ */
+void dvbpsi_budget_set(dvbpsi_t *p_dvbpsi, const size_t i_max_bytes,
+                       const unsigned int i_max_subtables);
+
+/*****************************************************************************
+ * dvbpsi_budget_get
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_budget_get(const dvbpsi_t *p_dvbpsi, dvbpsi_budget_t *p_budget)
+ * \brief Get the limits, usage and eviction counter of a dvbpsi_t handle.
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_budget pointer to structure that receives a copy of the budget
+ * \return nothing
+ */
+void dvbpsi_budget_get(const dvbpsi_t *p_dvbpsi, dvbpsi_budget_t *p_budget);
+
+/*****************************************************************************
+ * dvbpsi_errors_get
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_errors_get(const dvbpsi_t *p_dvbpsi, dvbpsi_errors_t *p_errors)
+ * \brief Get the error counters of a dvbpsi_t handle.
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_errors pointer to structure that receives a copy of the counters
+ * \return nothing
+ *
+ * The counters only grow, compare two copies to see what a packet caused.
+ */
+void dvbpsi_errors_get(const dvbpsi_t *p_dvbpsi, dvbpsi_errors_t *p_errors);
+
+/*****************************************************************************
+ * dvbpsi_trace_set
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_trace_set(dvbpsi_t *p_dvbpsi, const dvbpsi_trace_t *p_trace)
+ * \brief Install the hooks called around each stage of dvbpsi_packet_push().
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_trace hooks to copy, NULL to remove them
+ * \return false when the library was built without --enable-trace, in which
+ * case the hooks are never called.
+ *
+ * The hooks are compiled out of the library unless it is configured with
+ * --enable-trace. @see dvbpsi_trace_histogram_init() for a ready made pair.
+ */
+bool dvbpsi_trace_set(dvbpsi_t *p_dvbpsi, const dvbpsi_trace_t *p_trace);
+
 /*****************************************************************************
  * dvbpsi_packet_push
  *****************************************************************************/
@@ -278,7 +468,14 @@ typedef void (*dvbpsi_callback_del_t)(dvbpsi_t *p_dvbpsi,   /*!< pointer to dvbp
     dvbpsi_callback_del_t pf_del;  /*!< Del PSI table */                          \
     void     *p_priv;              /*!< Private decoder data */                   \
     /* pointer to next decoder in list */                                         \
-    dvbpsi_decoder_t *p_next;      /*!< Pointer to next decoder the list */
+    dvbpsi_decoder_t *p_next;      /*!< Pointer to next decoder the list */       \
+    /* Resource accounting, @see dvbpsi_budget_set() */                           \
+    dvbpsi_t *p_owner;             /*!< Handle charged for p_sections */          \
+    size_t   i_sections_size;      /*!< Bytes charged for p_sections */           \
+    uint32_t i_last_used;          /*!< LRU stamp of the last added section */    \
+    /* Section store, @see dvbpsi_decoder_psi_section_add() */                    \
+    dvbpsi_psi_section_t **pp_sections_slots; /*!< p_sections by section number */\
+    uint64_t ai_sections_received[4]; /*!< Bitmap of p_sections numbers */
 /**@}*/
 
 /*****************************************************************************
@@ -54,6 +54,44 @@ void dvbpsi_warning(dvbpsi_t *dvbpsi, const char *src, const char *fmt, ...);
 void dvbpsi_debug(dvbpsi_t *dvbpsi, const char *src, const char *fmt, ...);
 #endif
 
+/*****************************************************************************
+ * Latency tracing, @see dvbpsi_trace_set()
+ *
+ * Only built with --enable-trace (DVBPSI_TRACE), the macros expand to
+ * nothing otherwise.
+ *****************************************************************************/
+#ifdef DVBPSI_TRACE
+void dvbpsi_trace_emit(dvbpsi_t *p_dvbpsi, const dvbpsi_trace_stage_t i_stage,
+                       const bool b_end, const uint8_t i_table_id,
+                       const uint16_t i_extension);
+
+#  define dvbpsi_trace_pid(hnd, pid)                                    \
+        do { (hnd)->i_trace_pid = (pid); } while (0)
+#  define dvbpsi_trace_begin(hnd, stage, id, ext)                       \
+        do { if ((hnd)->trace.pf_begin)                                 \
+                 dvbpsi_trace_emit(hnd, stage, false, id, ext); } while (0)
+#  define dvbpsi_trace_end(hnd, stage, id, ext)                         \
+        do { if ((hnd)->trace.pf_end)                                   \
+                 dvbpsi_trace_emit(hnd, stage, true, id, ext); } while (0)
+#else
+#  define dvbpsi_trace_pid(hnd, pid)              do { (void)(pid); } while (0)
+#  define dvbpsi_trace_begin(hnd, stage, id, ext) do { (void)(id); (void)(ext); } while (0)
+#  define dvbpsi_trace_end(hnd, stage, id, ext)   do { (void)(id); (void)(ext); } while (0)
+#endif
+
+/*****************************************************************************
+ * Shared section cache, @see dvbpsi_section_cache_attach()
+ *
+ * Sections with a CRC_32, p_payload_end already excludes it. A match means
+ * the same bytes had a valid CRC_32.
+ *****************************************************************************/
+#ifdef HAVE_PTHREAD_H
+bool dvbpsi_section_cache_match(struct dvbpsi_section_cache_s *p_cache,
+                                const dvbpsi_psi_section_t *p_section);
+void dvbpsi_section_cache_insert(struct dvbpsi_section_cache_s *p_cache,
+                                 const dvbpsi_psi_section_t *p_section);
+#endif
+
 #else
 #error "Multiple inclusions of dvbpsi_private.h"
 #endif
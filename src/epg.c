@@ -0,0 +1,749 @@
+/*****************************************************************************
+ * epg.c: event schedule of the services, built from DVB EIT and ATSC EIT/ETT
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ * A service owns its events by part, one part per table, EIT segment or
+ * ATSC EIT-k, and indexes all of them in one array sorted by start time.
+ * Replacing a part filters its old events out of the array while merging
+ * the new ones in, sorted beforehand, in a single pass. Queries go back at
+ * most the longest duration of the service from their binary search, since
+ * no earlier event can still be running.
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#include "dvbpsi.h"
+#include "descriptor.h"
+#include "tables/eit.h"
+#include "tables/atsc_eit.h"
+#include "tables/atsc_ett.h"
+#include "epg.h"
+
+#define EPG_PART_ALL        0xff    /* whole DVB EIT sub-table */
+#define EPG_PF_MAX          4       /* present/following event_ids kept */
+#define EPG_ATSC_TABLE_ID   0xcb
+#define EPG_ATSC_KEY        (UINT64_C(1) << 48)
+
+/* Seconds from the Unix epoch to the GPS epoch, 6 January 1980 */
+#define EPG_GPS_EPOCH       INT64_C(315964800)
+/* Modified Julian Date of 1 January 1970 */
+#define EPG_MJD_EPOCH       40587
+
+typedef struct epg_part_s epg_part_t;
+
+typedef struct epg_event_s
+{
+    dvbpsi_epg_event_t  event;
+    epg_part_t         *p_part;
+    uint8_t            *p_title;        /* ATSC title copy */
+} epg_event_t;
+
+struct epg_part_s
+{
+    uint8_t             i_table_id;
+    uint8_t             i_part;         /* segment, EIT-k or EPG_PART_ALL */
+    uint8_t             i_version;
+    epg_event_t        *p_events;
+    size_t              i_events;
+
+    epg_part_t         *p_next;
+};
+
+typedef struct epg_ett_s
+{
+    uint16_t            i_event_id;
+    uint8_t             i_version;
+    uint8_t            *p_data;
+    size_t              i_length;
+} epg_ett_t;
+
+struct dvbpsi_epg_service_s
+{
+    uint64_t            i_key;
+    epg_part_t         *p_parts;
+
+    epg_event_t       **pp_events;      /* all parts, by start time */
+    size_t              i_events;
+    uint32_t            i_max_duration;
+
+    uint16_t            ai_pf[EPG_PF_MAX];
+    unsigned int        i_pf;
+
+    epg_ett_t          *p_etts;         /* by event_id */
+    size_t              i_etts;
+};
+
+struct dvbpsi_epg_s
+{
+    dvbpsi_epg_service_t **pp_services; /* by key */
+    size_t              i_services;
+    uint8_t             i_gps_utc_offset;
+};
+
+static bool epg_table_is_pf(const uint8_t i_table_id)
+{
+    return (i_table_id == 0x4e) || (i_table_id == 0x4f);
+}
+
+static unsigned int epg_bcd(const uint8_t i_bcd)
+{
+    return (i_bcd >> 4) * 10 + (i_bcd & 0xf);
+}
+
+/* 16 bit MJD then 6 BCD digits of UTC (ETSI EN 300 468 annex C) */
+static int64_t epg_dvb_time(const uint64_t i_time)
+{
+    const int64_t i_mjd = i_time >> 24;
+    return (i_mjd - EPG_MJD_EPOCH) * 86400 + epg_bcd((i_time >> 16) & 0xff) * 3600
+           + epg_bcd((i_time >> 8) & 0xff) * 60 + epg_bcd(i_time & 0xff);
+}
+
+static uint32_t epg_dvb_duration(const uint32_t i_duration)
+{
+    return epg_bcd((i_duration >> 16) & 0xff) * 3600
+           + epg_bcd((i_duration >> 8) & 0xff) * 60 + epg_bcd(i_duration & 0xff);
+}
+
+static bool epg_event_before(const epg_event_t *p_a, const epg_event_t *p_b)
+{
+    if (p_a->event.i_start != p_b->event.i_start)
+        return p_a->event.i_start < p_b->event.i_start;
+    return p_a->event.i_event_id < p_b->event.i_event_id;
+}
+
+static int epg_event_compare(const void *p_a, const void *p_b)
+{
+    if (epg_event_before(p_a, p_b))
+        return -1;
+    return epg_event_before(p_b, p_a) ? 1 : 0;
+}
+
+static void epg_events_free(epg_event_t *p_events, const size_t i_events)
+{
+    for (size_t i = 0; i < i_events; i++)
+    {
+        dvbpsi_DeleteDescriptors(p_events[i].event.p_first_descriptor);
+        free(p_events[i].p_title);
+    }
+    free(p_events);
+}
+
+static void epg_part_free(epg_part_t *p_part)
+{
+    epg_events_free(p_part->p_events, p_part->i_events);
+    free(p_part);
+}
+
+static void epg_service_free(dvbpsi_epg_service_t *p_service)
+{
+    epg_part_t *p_part = p_service->p_parts;
+    while (p_part)
+    {
+        epg_part_t *p_next = p_part->p_next;
+        epg_part_free(p_part);
+        p_part = p_next;
+    }
+    for (size_t i = 0; i < p_service->i_etts; i++)
+        free(p_service->p_etts[i].p_data);
+    free(p_service->p_etts);
+    free(p_service->pp_events);
+    free(p_service);
+}
+
+/* Index of the service with key i_key, or where to insert it */
+static size_t epg_service_search(const dvbpsi_epg_t *p_epg, const uint64_t i_key)
+{
+    size_t i_low = 0, i_high = p_epg->i_services;
+    while (i_low < i_high)
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if (p_epg->pp_services[i_mid]->i_key < i_key)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+static dvbpsi_epg_service_t *epg_service_get(dvbpsi_epg_t *p_epg, const uint64_t i_key,
+                                             const bool b_create)
+{
+    const size_t i = epg_service_search(p_epg, i_key);
+    if ((i < p_epg->i_services) && (p_epg->pp_services[i]->i_key == i_key))
+        return p_epg->pp_services[i];
+    if (!b_create)
+        return NULL;
+
+    dvbpsi_epg_service_t **pp_services = realloc(p_epg->pp_services,
+                                (p_epg->i_services + 1) * sizeof(dvbpsi_epg_service_t *));
+    if (pp_services == NULL)
+        return NULL;
+    p_epg->pp_services = pp_services;
+
+    dvbpsi_epg_service_t *p_service = calloc(1, sizeof(dvbpsi_epg_service_t));
+    if (p_service == NULL)
+        return NULL;
+    p_service->i_key = i_key;
+
+    memmove(&pp_services[i + 1], &pp_services[i],
+            (p_epg->i_services - i) * sizeof(dvbpsi_epg_service_t *));
+    pp_services[i] = p_service;
+    p_epg->i_services++;
+    return p_service;
+}
+
+/* True if the part was already added with this version */
+static bool epg_part_current(const dvbpsi_epg_service_t *p_service, const uint8_t i_table_id,
+                             const uint8_t i_part, const uint8_t i_version)
+{
+    for (const epg_part_t *p_part = p_service->p_parts; p_part; p_part = p_part->p_next)
+    {
+        if ((p_part->i_table_id == i_table_id) && (p_part->i_part == i_part))
+            return p_part->i_version == i_version;
+    }
+    return false;
+}
+
+/* A whole sub-table replaces all its segments, a segment the whole sub-table */
+static bool epg_part_replaces(const epg_part_t *p_old, const epg_part_t *p_new)
+{
+    if (p_old->i_table_id != p_new->i_table_id)
+        return false;
+    if (p_old->i_table_id == EPG_ATSC_TABLE_ID)
+        return p_old->i_part == p_new->i_part;
+    return (p_old->i_part == p_new->i_part) || (p_old->i_part == EPG_PART_ALL)
+           || (p_new->i_part == EPG_PART_ALL);
+}
+
+static void epg_service_update_pf(dvbpsi_epg_service_t *p_service)
+{
+    p_service->i_pf = 0;
+    for (const epg_part_t *p_part = p_service->p_parts; p_part; p_part = p_part->p_next)
+    {
+        if (!epg_table_is_pf(p_part->i_table_id))
+            continue;
+        for (size_t i = 0; (i < p_part->i_events) && (p_service->i_pf < EPG_PF_MAX); i++)
+            p_service->ai_pf[p_service->i_pf++] = p_part->p_events[i].event.i_event_id;
+    }
+}
+
+/* Schedule events are hidden by the present/following event with their id */
+static bool epg_event_visible(const dvbpsi_epg_service_t *p_service,
+                              const epg_event_t *p_event)
+{
+    if (epg_table_is_pf(p_event->event.i_table_id))
+        return true;
+    for (unsigned int i = 0; i < p_service->i_pf; i++)
+    {
+        if (p_service->ai_pf[i] == p_event->event.i_event_id)
+            return false;
+    }
+    return true;
+}
+
+/* Takes p_events over, even on failure */
+static bool epg_part_replace(dvbpsi_epg_service_t *p_service, const uint8_t i_table_id,
+                             const uint8_t i_part, const uint8_t i_version,
+                             epg_event_t *p_events, const size_t i_events)
+{
+    epg_part_t *p_new = malloc(sizeof(epg_part_t));
+    epg_event_t **pp_events = malloc((p_service->i_events + i_events + 1) * sizeof(epg_event_t *));
+    if ((p_new == NULL) || (pp_events == NULL))
+    {
+        free(p_new);
+        free(pp_events);
+        epg_events_free(p_events, i_events);
+        return false;
+    }
+    p_new->i_table_id = i_table_id;
+    p_new->i_part = i_part;
+    p_new->i_version = i_version;
+    p_new->p_events = p_events;
+    p_new->i_events = i_events;
+
+    qsort(p_events, i_events, sizeof(epg_event_t), epg_event_compare);
+    for (size_t i = 0; i < i_events; i++)
+        p_events[i].p_part = p_new;
+
+    /* Drop the replaced events and merge the new ones in */
+    size_t i_old = 0, i_add = 0, i_merged = 0;
+    uint32_t i_max_duration = 0;
+    for (;;)
+    {
+        while ((i_old < p_service->i_events)
+               && epg_part_replaces(p_service->pp_events[i_old]->p_part, p_new))
+            i_old++;
+
+        epg_event_t *p_next;
+        if ((i_old < p_service->i_events)
+            && ((i_add == i_events) || !epg_event_before(&p_events[i_add],
+                                                         p_service->pp_events[i_old])))
+            p_next = p_service->pp_events[i_old++];
+        else if (i_add < i_events)
+            p_next = &p_events[i_add++];
+        else
+            break;
+
+        if (p_next->event.i_duration > i_max_duration)
+            i_max_duration = p_next->event.i_duration;
+        pp_events[i_merged++] = p_next;
+    }
+    free(p_service->pp_events);
+    p_service->pp_events = pp_events;
+    p_service->i_events = i_merged;
+    p_service->i_max_duration = i_max_duration;
+
+    epg_part_t **pp_part = &p_service->p_parts;
+    while (*pp_part)
+    {
+        epg_part_t *p_part = *pp_part;
+        if (epg_part_replaces(p_part, p_new))
+        {
+            *pp_part = p_part->p_next;
+            epg_part_free(p_part);
+        }
+        else
+            pp_part = &p_part->p_next;
+    }
+    p_new->p_next = p_service->p_parts;
+    p_service->p_parts = p_new;
+
+    epg_service_update_pf(p_service);
+    return true;
+}
+
+/* Index of the ETT of i_event_id, or where to insert it */
+static size_t epg_ett_search(const dvbpsi_epg_service_t *p_service, const uint16_t i_event_id)
+{
+    size_t i_low = 0, i_high = p_service->i_etts;
+    while (i_low < i_high)
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if (p_service->p_etts[i_mid].i_event_id < i_event_id)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+static const epg_ett_t *epg_ett_find(const dvbpsi_epg_service_t *p_service,
+                                     const uint16_t i_event_id)
+{
+    const size_t i = epg_ett_search(p_service, i_event_id);
+    if ((i < p_service->i_etts) && (p_service->p_etts[i].i_event_id == i_event_id))
+        return &p_service->p_etts[i];
+    return NULL;
+}
+
+/* First event starting after i_time */
+static size_t epg_event_search(const dvbpsi_epg_service_t *p_service, const int64_t i_time)
+{
+    size_t i_low = 0, i_high = p_service->i_events;
+    while (i_low < i_high)
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if (p_service->pp_events[i_mid]->event.i_start <= i_time)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+static void epg_dvb_short_event(dvbpsi_epg_event_t *p_event)
+{
+    for (dvbpsi_descriptor_t *p_dr = p_event->p_first_descriptor; p_dr; p_dr = p_dr->p_next)
+    {
+        if ((p_dr->i_tag != 0x4d) || (p_dr->i_length < 5))
+            continue;
+
+        const uint8_t *p_data = p_dr->p_data;
+        const size_t i_name = p_data[3];
+        if (4 + i_name + 1 > p_dr->i_length)
+            continue;
+        size_t i_text = p_data[4 + i_name];
+        if (5 + i_name + i_text > p_dr->i_length)
+            i_text = p_dr->i_length - 5 - i_name;
+
+        memcpy(p_event->i_language, p_data, 3);
+        p_event->p_title = p_data + 4;
+        p_event->i_title_length = i_name;
+        p_event->p_text = p_data + 5 + i_name;
+        p_event->i_text_length = i_text;
+        return;
+    }
+}
+
+static bool epg_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit, const uint8_t i_part)
+{
+    const uint64_t i_key = ((uint64_t)p_eit->i_network_id << 32)
+                           | ((uint32_t)p_eit->i_ts_id << 16) | p_eit->i_extension;
+    dvbpsi_epg_service_t *p_service = epg_service_get(p_epg, i_key, true);
+    if (p_service == NULL)
+    {
+        dvbpsi_eit_delete(p_eit);
+        return false;
+    }
+    if (epg_part_current(p_service, p_eit->i_table_id, i_part, p_eit->i_version))
+    {
+        dvbpsi_eit_delete(p_eit);
+        return true;
+    }
+
+    size_t i_events = 0;
+    for (dvbpsi_eit_event_t *p = p_eit->p_first_event; p; p = p->p_next)
+        i_events++;
+    epg_event_t *p_events = calloc(i_events + 1, sizeof(epg_event_t));
+    if (p_events == NULL)
+    {
+        dvbpsi_eit_delete(p_eit);
+        return false;
+    }
+
+    i_events = 0;
+    for (dvbpsi_eit_event_t *p = p_eit->p_first_event; p; p = p->p_next)
+    {
+        if (p->b_nvod || (p->i_start_time == UINT64_C(0xffffffffff)))
+            continue;
+
+        dvbpsi_epg_event_t *p_event = &p_events[i_events++].event;
+        p_event->i_event_id = p->i_event_id;
+        p_event->i_start = epg_dvb_time(p->i_start_time);
+        p_event->i_duration = epg_dvb_duration(p->i_duration);
+        p_event->i_table_id = p_eit->i_table_id;
+        p_event->i_running_status = p->i_running_status;
+        p_event->b_free_ca = p->b_free_ca;
+        p_event->p_first_descriptor = p->p_first_descriptor;
+        p->p_first_descriptor = NULL;
+        epg_dvb_short_event(p_event);
+    }
+
+    const uint8_t i_table_id = p_eit->i_table_id;
+    const uint8_t i_version = p_eit->i_version;
+    dvbpsi_eit_delete(p_eit);
+    return epg_part_replace(p_service, i_table_id, i_part, i_version, p_events, i_events);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_new
+ *****************************************************************************/
+dvbpsi_epg_t *dvbpsi_epg_new(void)
+{
+    return calloc(1, sizeof(dvbpsi_epg_t));
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_delete
+ *****************************************************************************/
+void dvbpsi_epg_delete(dvbpsi_epg_t *p_epg)
+{
+    if (p_epg == NULL)
+        return;
+
+    for (size_t i = 0; i < p_epg->i_services; i++)
+        epg_service_free(p_epg->pp_services[i]);
+    free(p_epg->pp_services);
+    free(p_epg);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_gps_utc_offset_set
+ *****************************************************************************/
+void dvbpsi_epg_gps_utc_offset_set(dvbpsi_epg_t *p_epg, uint8_t i_gps_utc_offset)
+{
+    assert(p_epg);
+
+    p_epg->i_gps_utc_offset = i_gps_utc_offset;
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_eit_add
+ *****************************************************************************/
+bool dvbpsi_epg_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit)
+{
+    assert(p_epg);
+    assert(p_eit);
+
+    return epg_eit_add(p_epg, p_eit, EPG_PART_ALL);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_eit_segment_add
+ *****************************************************************************/
+bool dvbpsi_epg_eit_segment_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit,
+                                uint8_t i_segment)
+{
+    assert(p_epg);
+    assert(p_eit);
+    assert(i_segment < 32);
+
+    return epg_eit_add(p_epg, p_eit, i_segment);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_eit_add
+ *****************************************************************************/
+bool dvbpsi_epg_atsc_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_atsc_eit_t *p_eit,
+                             uint8_t i_index)
+{
+    assert(p_epg);
+    assert(p_eit);
+
+    dvbpsi_epg_service_t *p_service = epg_service_get(p_epg,
+                                            EPG_ATSC_KEY | p_eit->i_source_id, true);
+    if (p_service == NULL)
+    {
+        dvbpsi_atsc_eit_delete(p_eit);
+        return false;
+    }
+    if (epg_part_current(p_service, EPG_ATSC_TABLE_ID, i_index, p_eit->i_version))
+    {
+        dvbpsi_atsc_eit_delete(p_eit);
+        return true;
+    }
+
+    size_t i_events = 0;
+    for (dvbpsi_atsc_eit_event_t *p = p_eit->p_first_event; p; p = p->p_next)
+        i_events++;
+    epg_event_t *p_events = calloc(i_events + 1, sizeof(epg_event_t));
+    if (p_events == NULL)
+    {
+        dvbpsi_atsc_eit_delete(p_eit);
+        return false;
+    }
+
+    i_events = 0;
+    for (dvbpsi_atsc_eit_event_t *p = p_eit->p_first_event; p; p = p->p_next)
+    {
+        epg_event_t *p_epg_event = &p_events[i_events++];
+        dvbpsi_epg_event_t *p_event = &p_epg_event->event;
+        p_event->i_event_id = p->i_event_id;
+        p_event->i_start = (int64_t)p->i_start_time + EPG_GPS_EPOCH - p_epg->i_gps_utc_offset;
+        p_event->i_duration = p->i_length_seconds;
+        p_event->i_table_id = EPG_ATSC_TABLE_ID;
+        p_event->p_first_descriptor = p->p_first_descriptor;
+        p->p_first_descriptor = NULL;
+
+        if (p->i_title_length > 0)
+        {
+            p_epg_event->p_title = malloc(p->i_title_length);
+            if (p_epg_event->p_title)
+            {
+                memcpy(p_epg_event->p_title, p->i_title, p->i_title_length);
+                p_event->p_title = p_epg_event->p_title;
+                p_event->i_title_length = p->i_title_length;
+            }
+        }
+
+        const epg_ett_t *p_ett = epg_ett_find(p_service, p->i_event_id);
+        if (p_ett)
+        {
+            p_event->p_text = p_ett->p_data;
+            p_event->i_text_length = p_ett->i_length;
+        }
+    }
+
+    const uint8_t i_version = p_eit->i_version;
+    dvbpsi_atsc_eit_delete(p_eit);
+    return epg_part_replace(p_service, EPG_ATSC_TABLE_ID, i_index, i_version,
+                            p_events, i_events);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_ett_add
+ *****************************************************************************/
+bool dvbpsi_epg_atsc_ett_add(dvbpsi_epg_t *p_epg, dvbpsi_atsc_ett_t *p_ett)
+{
+    assert(p_epg);
+    assert(p_ett);
+
+    /* ETM_id: source_id, event_id and 0x2 for an event ETM (ATSC A/65) */
+    if ((p_ett->i_etm_id & 0x3) != 0x2)
+    {
+        dvbpsi_atsc_ett_delete(p_ett);
+        return true;
+    }
+    const uint16_t i_event_id = (p_ett->i_etm_id >> 2) & 0x3fff;
+
+    dvbpsi_epg_service_t *p_service = epg_service_get(p_epg,
+                                            EPG_ATSC_KEY | (p_ett->i_etm_id >> 16), true);
+    if (p_service == NULL)
+    {
+        dvbpsi_atsc_ett_delete(p_ett);
+        return false;
+    }
+
+    const size_t i = epg_ett_search(p_service, i_event_id);
+    epg_ett_t *p_slot = NULL;
+    if ((i < p_service->i_etts) && (p_service->p_etts[i].i_event_id == i_event_id))
+    {
+        p_slot = &p_service->p_etts[i];
+        if (p_slot->i_version == p_ett->i_version)
+        {
+            dvbpsi_atsc_ett_delete(p_ett);
+            return true;
+        }
+    }
+    else
+    {
+        epg_ett_t *p_etts = realloc(p_service->p_etts,
+                                    (p_service->i_etts + 1) * sizeof(epg_ett_t));
+        if (p_etts == NULL)
+        {
+            dvbpsi_atsc_ett_delete(p_ett);
+            return false;
+        }
+        memmove(&p_etts[i + 1], &p_etts[i], (p_service->i_etts - i) * sizeof(epg_ett_t));
+        p_service->p_etts = p_etts;
+        p_service->i_etts++;
+
+        p_slot = &p_etts[i];
+        p_slot->i_event_id = i_event_id;
+        p_slot->p_data = NULL;
+    }
+
+    free(p_slot->p_data);
+    p_slot->i_version = p_ett->i_version;
+    p_slot->p_data = p_ett->p_etm_data;
+    p_slot->i_length = p_slot->p_data ? p_ett->i_etm_length : 0;
+    p_ett->p_etm_data = NULL;
+    dvbpsi_atsc_ett_delete(p_ett);
+
+    for (size_t j = 0; j < p_service->i_events; j++)
+    {
+        dvbpsi_epg_event_t *p_event = &p_service->pp_events[j]->event;
+        if (p_event->i_event_id == i_event_id)
+        {
+            p_event->p_text = p_slot->p_data;
+            p_event->i_text_length = p_slot->i_length;
+        }
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_service_find
+ *****************************************************************************/
+dvbpsi_epg_service_t *dvbpsi_epg_service_find(dvbpsi_epg_t *p_epg,
+                                              uint16_t i_network_id, uint16_t i_ts_id,
+                                              uint16_t i_service_id)
+{
+    assert(p_epg);
+
+    const uint64_t i_key = ((uint64_t)i_network_id << 32)
+                           | ((uint32_t)i_ts_id << 16) | i_service_id;
+    return epg_service_get(p_epg, i_key, false);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_service_find
+ *****************************************************************************/
+dvbpsi_epg_service_t *dvbpsi_epg_atsc_service_find(dvbpsi_epg_t *p_epg,
+                                                   uint16_t i_source_id)
+{
+    assert(p_epg);
+
+    return epg_service_get(p_epg, EPG_ATSC_KEY | i_source_id, false);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_now_next
+ *****************************************************************************/
+bool dvbpsi_epg_now_next(dvbpsi_epg_service_t *p_service, int64_t i_time,
+                         const dvbpsi_epg_event_t **pp_now,
+                         const dvbpsi_epg_event_t **pp_next)
+{
+    assert(p_service);
+    assert(pp_now);
+    assert(pp_next);
+
+    const size_t i_after = epg_event_search(p_service, i_time);
+
+    *pp_now = NULL;
+    for (size_t i = i_after; i-- > 0;)
+    {
+        const epg_event_t *p_event = p_service->pp_events[i];
+        if (p_event->event.i_start + p_service->i_max_duration <= i_time)
+            break;
+        if ((p_event->event.i_start + p_event->event.i_duration > i_time)
+            && epg_event_visible(p_service, p_event))
+        {
+            *pp_now = &p_event->event;
+            break;
+        }
+    }
+
+    *pp_next = NULL;
+    for (size_t i = i_after; i < p_service->i_events; i++)
+    {
+        if (epg_event_visible(p_service, p_service->pp_events[i]))
+        {
+            *pp_next = &p_service->pp_events[i]->event;
+            break;
+        }
+    }
+
+    return (*pp_now != NULL) || (*pp_next != NULL);
+}
+
+/*****************************************************************************
+ * dvbpsi_epg_range
+ *****************************************************************************/
+size_t dvbpsi_epg_range(dvbpsi_epg_service_t *p_service, int64_t i_from, int64_t i_to,
+                        const dvbpsi_epg_event_t **pp_events, size_t i_max)
+{
+    assert(p_service);
+    assert(pp_events || i_max == 0);
+
+    /* Events starting earlier have ended before i_from */
+    size_t i_count = 0;
+    for (size_t i = epg_event_search(p_service, i_from - p_service->i_max_duration);
+         i < p_service->i_events; i++)
+    {
+        const epg_event_t *p_event = p_service->pp_events[i];
+        if (p_event->event.i_start >= i_to)
+            break;
+        if ((p_event->event.i_start + p_event->event.i_duration <= i_from)
+            || !epg_event_visible(p_service, p_event))
+            continue;
+        if (i_count < i_max)
+            pp_events[i_count] = &p_event->event;
+        i_count++;
+    }
+    return i_count;
+}
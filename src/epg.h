@@ -0,0 +1,269 @@
+/*****************************************************************************
+ * epg.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <epg.h>
+ * \brief Event schedule of the services, built from DVB EIT and ATSC EIT/ETT.
+ *
+ * The tables given to the EPG replace the events of the same part of the
+ * schedule: a whole EIT sub-table, one of its segments or one ATSC EIT-k.
+ * A part received again with the same version costs nothing, which makes it
+ * cheap to feed the EIT other of every transport stream of a network. Each
+ * service keeps its events sorted by start time, so "now/next" and time
+ * range queries are binary searches. Present/following events take over the
+ * schedule events with the same event_id, and ATSC ETT texts are joined to
+ * the events by ETM_id, whichever table comes first.
+ *
+ * Not thread safe: feed and query an EPG from the same thread, usually the
+ * one pushing the packets. Include descriptor.h, tables/eit.h,
+ * tables/atsc_eit.h and tables/atsc_ett.h before this header.
+ */
+
+#ifndef _DVBPSI_EPG_H_
+#define _DVBPSI_EPG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \typedef struct dvbpsi_epg_s dvbpsi_epg_t
+ * \brief Opaque EPG.
+ */
+typedef struct dvbpsi_epg_s dvbpsi_epg_t;
+
+/*!
+ * \typedef struct dvbpsi_epg_service_s dvbpsi_epg_service_t
+ * \brief Opaque service of an EPG.
+ */
+typedef struct dvbpsi_epg_service_s dvbpsi_epg_service_t;
+
+/*!
+ * \struct dvbpsi_epg_event_s
+ * \brief Event of an EPG.
+ *
+ * Titles and texts are left in the encoding of the broadcast: DVB strings
+ * (ETSI EN 300 468 annex A) or ATSC multiple string structures. An event
+ * and everything it points to belong to the EPG and stay valid until the
+ * next table is added.
+ */
+/*!
+ * \typedef struct dvbpsi_epg_event_s dvbpsi_epg_event_t
+ * \brief dvbpsi_epg_event_t type definition.
+ */
+typedef struct dvbpsi_epg_event_s
+{
+    uint16_t        i_event_id;         /*!< event_id */
+    int64_t         i_start;            /*!< start, seconds since the Epoch (UTC) */
+    uint32_t        i_duration;         /*!< duration in seconds */
+    uint8_t         i_table_id;         /*!< table the event comes from */
+    uint8_t         i_running_status;   /*!< running_status, 0 for ATSC */
+    bool            b_free_ca;          /*!< free_CA_mode, false for ATSC */
+
+    const uint8_t  *p_title;            /*!< DVB event_name of the first short
+                                             event descriptor or ATSC title */
+    size_t          i_title_length;     /*!< length of p_title */
+    const uint8_t  *p_text;             /*!< DVB text of the first short
+                                             event descriptor or ATSC ETT */
+    size_t          i_text_length;      /*!< length of p_text */
+    uint8_t         i_language[3];      /*!< ISO 639 language of the DVB
+                                             short event descriptor */
+
+    dvbpsi_descriptor_t *p_first_descriptor; /*!< descriptors of the event */
+} dvbpsi_epg_event_t;
+
+/*****************************************************************************
+ * dvbpsi_epg_new
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_epg_t *dvbpsi_epg_new(void)
+ * \brief Create an empty EPG.
+ * \return pointer to the EPG, NULL on allocation failure.
+ */
+dvbpsi_epg_t *dvbpsi_epg_new(void);
+
+/*****************************************************************************
+ * dvbpsi_epg_delete
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_epg_delete(dvbpsi_epg_t *p_epg)
+ * \brief Delete an EPG with all its services and events.
+ * \param p_epg EPG to delete
+ * \return nothing
+ */
+void dvbpsi_epg_delete(dvbpsi_epg_t *p_epg);
+
+/*****************************************************************************
+ * dvbpsi_epg_gps_utc_offset_set
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_epg_gps_utc_offset_set(dvbpsi_epg_t *p_epg,
+ *                                        uint8_t i_gps_utc_offset)
+ * \brief Set the GPS_UTC_offset of the ATSC STT, 0 until then.
+ * \param p_epg EPG
+ * \param i_gps_utc_offset seconds GPS time is ahead of UTC
+ * \return nothing
+ *
+ * Applies to the ATSC events added afterwards.
+ */
+void dvbpsi_epg_gps_utc_offset_set(dvbpsi_epg_t *p_epg, uint8_t i_gps_utc_offset);
+
+/*****************************************************************************
+ * dvbpsi_epg_eit_add
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_epg_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit)
+ * \brief Replace the events of a whole DVB EIT sub-table.
+ * \param p_epg EPG
+ * \param p_eit EIT given to the dvbpsi_eit_callback, the EPG takes it over
+ * \return false on allocation failure, the previous events are then kept.
+ *
+ * NVOD reference events and events without a start time are left out.
+ */
+bool dvbpsi_epg_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit);
+
+/*****************************************************************************
+ * dvbpsi_epg_eit_segment_add
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_epg_eit_segment_add(dvbpsi_epg_t *p_epg,
+ *                                     dvbpsi_eit_t *p_eit, uint8_t i_segment)
+ * \brief Replace the events of one segment of a DVB EIT schedule.
+ * \param p_epg EPG
+ * \param p_eit EIT given to the dvbpsi_eit_segment_callback, the EPG takes
+ * it over
+ * \param i_segment segment number given to the callback
+ * \return false on allocation failure, the previous events are then kept.
+ */
+bool dvbpsi_epg_eit_segment_add(dvbpsi_epg_t *p_epg, dvbpsi_eit_t *p_eit,
+                                uint8_t i_segment);
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_eit_add
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_epg_atsc_eit_add(dvbpsi_epg_t *p_epg,
+ *                                  dvbpsi_atsc_eit_t *p_eit, uint8_t i_index)
+ * \brief Replace the events of an ATSC EIT-k of a virtual channel.
+ * \param p_epg EPG
+ * \param p_eit EIT given to the dvbpsi_atsc_eit_callback, the EPG takes it
+ * over
+ * \param i_index k, from the MGT table_type 0x0100 + k of its PID
+ * \return false on allocation failure, the previous events are then kept.
+ */
+bool dvbpsi_epg_atsc_eit_add(dvbpsi_epg_t *p_epg, dvbpsi_atsc_eit_t *p_eit,
+                             uint8_t i_index);
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_ett_add
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_epg_atsc_ett_add(dvbpsi_epg_t *p_epg, dvbpsi_atsc_ett_t *p_ett)
+ * \brief Set the extended text of an ATSC event.
+ * \param p_epg EPG
+ * \param p_ett ETT given to the dvbpsi_atsc_ett_callback, the EPG takes it
+ * over
+ * \return false on allocation failure.
+ *
+ * The text is kept until its event arrives. Channel ETTs are ignored.
+ */
+bool dvbpsi_epg_atsc_ett_add(dvbpsi_epg_t *p_epg, dvbpsi_atsc_ett_t *p_ett);
+
+/*****************************************************************************
+ * dvbpsi_epg_service_find
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_epg_service_t *dvbpsi_epg_service_find(dvbpsi_epg_t *p_epg,
+ *                                                   uint16_t i_network_id,
+ *                                                   uint16_t i_ts_id,
+ *                                                   uint16_t i_service_id)
+ * \brief Find a DVB service.
+ * \param p_epg EPG
+ * \param i_network_id original_network_id
+ * \param i_ts_id transport_stream_id
+ * \param i_service_id service_id
+ * \return the service, NULL if no EIT was added for it.
+ */
+dvbpsi_epg_service_t *dvbpsi_epg_service_find(dvbpsi_epg_t *p_epg,
+                                              uint16_t i_network_id, uint16_t i_ts_id,
+                                              uint16_t i_service_id);
+
+/*****************************************************************************
+ * dvbpsi_epg_atsc_service_find
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_epg_service_t *dvbpsi_epg_atsc_service_find(dvbpsi_epg_t *p_epg,
+ *                                                        uint16_t i_source_id)
+ * \brief Find an ATSC virtual channel.
+ * \param p_epg EPG
+ * \param i_source_id source_id of the channel
+ * \return the service, NULL if no EIT or ETT was added for it.
+ */
+dvbpsi_epg_service_t *dvbpsi_epg_atsc_service_find(dvbpsi_epg_t *p_epg,
+                                                   uint16_t i_source_id);
+
+/*****************************************************************************
+ * dvbpsi_epg_now_next
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_epg_now_next(dvbpsi_epg_service_t *p_service, int64_t i_time,
+ *                              const dvbpsi_epg_event_t **pp_now,
+ *                              const dvbpsi_epg_event_t **pp_next)
+ * \brief Find the event running at a given time and the one following it.
+ * \param p_service service
+ * \param i_time seconds since the Epoch (UTC)
+ * \param pp_now receives the event running at i_time, or NULL
+ * \param pp_next receives the first event starting after i_time, or NULL
+ * \return true if at least one of them was found.
+ */
+bool dvbpsi_epg_now_next(dvbpsi_epg_service_t *p_service, int64_t i_time,
+                         const dvbpsi_epg_event_t **pp_now,
+                         const dvbpsi_epg_event_t **pp_next);
+
+/*****************************************************************************
+ * dvbpsi_epg_range
+ *****************************************************************************/
+/*!
+ * \fn size_t dvbpsi_epg_range(dvbpsi_epg_service_t *p_service,
+ *                             int64_t i_from, int64_t i_to,
+ *                             const dvbpsi_epg_event_t **pp_events,
+ *                             size_t i_max)
+ * \brief Find the events running between two times, by start time.
+ * \param p_service service
+ * \param i_from start of the range, seconds since the Epoch (UTC)
+ * \param i_to end of the range, excluded
+ * \param pp_events receives up to i_max events
+ * \param i_max size of pp_events
+ * \return number of events in the range, which may exceed i_max.
+ */
+size_t dvbpsi_epg_range(dvbpsi_epg_service_t *p_service, int64_t i_from, int64_t i_to,
+                        const dvbpsi_epg_event_t **pp_events, size_t i_max);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of epg.h"
+#endif
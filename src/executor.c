@@ -0,0 +1,504 @@
+/*****************************************************************************
+ * executor.c: many independent transport streams on a pool of worker threads
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ * A stream with queued batches is "scheduled": it sits in the deque of one
+ * worker, or is being run by one. Submitting to a scheduled stream only
+ * appends to its queue, so a stream never runs on two workers at once.
+ * Workers take streams from the front of their own deque and steal from
+ * the back of the others. A stream that still has batches after a run goes
+ * back to the deque of the worker that ran it.
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#include "dvbpsi.h"
+#include "executor.h"
+
+typedef struct executor_job_s
+{
+    struct executor_job_s *p_next;
+    size_t                 i_packets;
+    uint8_t                p_packets[];
+} executor_job_t;
+
+typedef struct executor_stream_s
+{
+    dvbpsi_executor_push_cb pf_push;
+    void                   *p_data;
+
+    pthread_mutex_t         lock;       /* protects the fields below */
+    executor_job_t         *p_first;
+    executor_job_t        **pp_last;
+    bool                    b_scheduled;
+    unsigned int            i_worker;   /* deque to queue the stream on */
+} executor_stream_t;
+
+typedef struct executor_worker_s
+{
+    dvbpsi_executor_t      *p_executor;
+    unsigned int            i_id;
+    pthread_t               handle;
+
+    pthread_mutex_t         lock;       /* protects the deque */
+    executor_stream_t     **pp_deque;   /* ring of i_max_streams entries */
+    unsigned int            i_head;
+    unsigned int            i_count;
+} executor_worker_t;
+
+typedef struct executor_completion_s
+{
+    struct executor_completion_s *p_next;
+    dvbpsi_executor_complete_cb   pf_complete;
+    void                         *p_data;
+} executor_completion_t;
+
+struct dvbpsi_executor_s
+{
+    executor_worker_t      *p_workers;
+    unsigned int            i_workers;
+    unsigned int            i_started;  /* threads to join */
+
+    executor_stream_t     **pp_streams;
+    unsigned int            i_max_streams;
+    unsigned int            i_streams;
+
+    pthread_mutex_t         lock;       /* sleeping workers and dvbpsi_executor_wait() */
+    pthread_cond_t          wake;
+    pthread_cond_t          idle;
+    unsigned int            i_ready;    /* streams waiting in a deque */
+    unsigned int            i_sleeping;
+    size_t                  i_pending;  /* batches not pushed yet */
+    bool                    b_quit;
+
+    pthread_mutex_t         completion_lock;
+    executor_completion_t  *p_completions;
+    executor_completion_t **pp_last_completion;
+};
+
+/*****************************************************************************
+ * Deques
+ *****************************************************************************/
+static void executor_schedule(dvbpsi_executor_t *p_executor, const unsigned int i_worker,
+                              executor_stream_t *p_stream)
+{
+    executor_worker_t *p_worker = &p_executor->p_workers[i_worker];
+
+    pthread_mutex_lock(&p_worker->lock);
+    assert(p_worker->i_count < p_executor->i_max_streams);
+    p_worker->pp_deque[(p_worker->i_head + p_worker->i_count) % p_executor->i_max_streams] = p_stream;
+    p_worker->i_count++;
+    pthread_mutex_unlock(&p_worker->lock);
+
+    /* Either the stream is seen by a worker going to sleep, or that worker
+     * is seen sleeping here and woken up */
+    __atomic_add_fetch(&p_executor->i_ready, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&p_executor->i_sleeping, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&p_executor->lock);
+        pthread_cond_signal(&p_executor->wake);
+        pthread_mutex_unlock(&p_executor->lock);
+    }
+}
+
+static executor_stream_t *executor_take(executor_worker_t *p_worker, const bool b_front)
+{
+    dvbpsi_executor_t *p_executor = p_worker->p_executor;
+    executor_stream_t *p_stream = NULL;
+
+    pthread_mutex_lock(&p_worker->lock);
+    if (p_worker->i_count > 0)
+    {
+        if (b_front)
+        {
+            p_stream = p_worker->pp_deque[p_worker->i_head];
+            p_worker->i_head = (p_worker->i_head + 1) % p_executor->i_max_streams;
+        }
+        else
+            p_stream = p_worker->pp_deque[(p_worker->i_head + p_worker->i_count - 1)
+                                          % p_executor->i_max_streams];
+        p_worker->i_count--;
+    }
+    pthread_mutex_unlock(&p_worker->lock);
+
+    if (p_stream)
+        __atomic_sub_fetch(&p_executor->i_ready, 1, __ATOMIC_SEQ_CST);
+    return p_stream;
+}
+
+/* Own deque first, then steal from the next workers */
+static executor_stream_t *executor_find(executor_worker_t *p_worker)
+{
+    dvbpsi_executor_t *p_executor = p_worker->p_executor;
+
+    executor_stream_t *p_stream = executor_take(p_worker, true);
+    for (unsigned int i = 1; !p_stream && (i < p_executor->i_workers); i++)
+        p_stream = executor_take(&p_executor->p_workers[(p_worker->i_id + i) % p_executor->i_workers],
+                                 false);
+    return p_stream;
+}
+
+/*****************************************************************************
+ * Workers
+ *****************************************************************************/
+static void executor_run(executor_worker_t *p_worker, executor_stream_t *p_stream)
+{
+    dvbpsi_executor_t *p_executor = p_worker->p_executor;
+
+    pthread_mutex_lock(&p_stream->lock);
+    executor_job_t *p_job = p_stream->p_first;
+    p_stream->p_first = NULL;
+    p_stream->pp_last = &p_stream->p_first;
+    p_stream->i_worker = p_worker->i_id;
+    pthread_mutex_unlock(&p_stream->lock);
+
+    size_t i_done = 0;
+    while (p_job)
+    {
+        executor_job_t *p_next = p_job->p_next;
+        p_stream->pf_push(p_stream->p_data, p_job->p_packets, p_job->i_packets);
+        free(p_job);
+        p_job = p_next;
+        i_done++;
+    }
+
+    /* Batches submitted meanwhile wait behind the other queued streams */
+    pthread_mutex_lock(&p_stream->lock);
+    const bool b_again = (p_stream->p_first != NULL);
+    p_stream->b_scheduled = b_again;
+    pthread_mutex_unlock(&p_stream->lock);
+    if (b_again)
+        executor_schedule(p_executor, p_worker->i_id, p_stream);
+
+    if (__atomic_sub_fetch(&p_executor->i_pending, i_done, __ATOMIC_ACQ_REL) == 0)
+    {
+        pthread_mutex_lock(&p_executor->lock);
+        pthread_cond_broadcast(&p_executor->idle);
+        pthread_mutex_unlock(&p_executor->lock);
+    }
+}
+
+static void *executor_worker(void *p_arg)
+{
+    executor_worker_t *p_worker = (executor_worker_t *)p_arg;
+    dvbpsi_executor_t *p_executor = p_worker->p_executor;
+
+    for (;;)
+    {
+        executor_stream_t *p_stream = executor_find(p_worker);
+        if (p_stream)
+        {
+            executor_run(p_worker, p_stream);
+            continue;
+        }
+
+        pthread_mutex_lock(&p_executor->lock);
+        __atomic_add_fetch(&p_executor->i_sleeping, 1, __ATOMIC_SEQ_CST);
+        while (!p_executor->b_quit &&
+               (__atomic_load_n(&p_executor->i_ready, __ATOMIC_SEQ_CST) == 0))
+            pthread_cond_wait(&p_executor->wake, &p_executor->lock);
+        __atomic_sub_fetch(&p_executor->i_sleeping, 1, __ATOMIC_SEQ_CST);
+        const bool b_quit = p_executor->b_quit;
+        pthread_mutex_unlock(&p_executor->lock);
+        if (b_quit)
+            break;
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_new
+ *****************************************************************************/
+dvbpsi_executor_t *dvbpsi_executor_new(unsigned int i_workers, unsigned int i_max_streams)
+{
+    if (i_max_streams == 0)
+        return NULL;
+    if (i_workers == 0)
+    {
+        long i_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        i_workers = (i_cores > 0) ? (unsigned int)i_cores : 1;
+    }
+
+    dvbpsi_executor_t *p_executor = calloc(1, sizeof(dvbpsi_executor_t));
+    if (p_executor == NULL)
+        return NULL;
+    p_executor->i_max_streams = i_max_streams;
+    p_executor->pp_last_completion = &p_executor->p_completions;
+    pthread_mutex_init(&p_executor->lock, NULL);
+    pthread_cond_init(&p_executor->wake, NULL);
+    pthread_cond_init(&p_executor->idle, NULL);
+    pthread_mutex_init(&p_executor->completion_lock, NULL);
+
+    p_executor->pp_streams = calloc(i_max_streams, sizeof(executor_stream_t *));
+    p_executor->p_workers = calloc(i_workers, sizeof(executor_worker_t));
+    if (!p_executor->pp_streams || !p_executor->p_workers)
+        goto error;
+
+    /* Every deque exists before any worker starts stealing */
+    for (unsigned int i = 0; i < i_workers; i++)
+    {
+        executor_worker_t *p_worker = &p_executor->p_workers[i];
+        p_worker->p_executor = p_executor;
+        p_worker->i_id = i;
+        p_worker->pp_deque = calloc(i_max_streams, sizeof(executor_stream_t *));
+        if (p_worker->pp_deque == NULL)
+            goto error;
+        pthread_mutex_init(&p_worker->lock, NULL);
+        p_executor->i_workers++;
+    }
+
+    for (unsigned int i = 0; i < i_workers; i++)
+    {
+        executor_worker_t *p_worker = &p_executor->p_workers[i];
+        if (pthread_create(&p_worker->handle, NULL, executor_worker, p_worker) != 0)
+            goto error;
+        p_executor->i_started++;
+    }
+    return p_executor;
+
+error:
+    dvbpsi_executor_delete(p_executor);
+    return NULL;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_delete
+ *****************************************************************************/
+void dvbpsi_executor_delete(dvbpsi_executor_t *p_executor)
+{
+    if (p_executor == NULL)
+        return;
+
+    dvbpsi_executor_wait(p_executor);
+
+    pthread_mutex_lock(&p_executor->lock);
+    p_executor->b_quit = true;
+    pthread_cond_broadcast(&p_executor->wake);
+    pthread_mutex_unlock(&p_executor->lock);
+
+    for (unsigned int i = 0; i < p_executor->i_started; i++)
+        pthread_join(p_executor->p_workers[i].handle, NULL);
+    for (unsigned int i = 0; i < p_executor->i_workers; i++)
+    {
+        pthread_mutex_destroy(&p_executor->p_workers[i].lock);
+        free(p_executor->p_workers[i].pp_deque);
+    }
+    free(p_executor->p_workers);
+
+    dvbpsi_executor_drain(p_executor);
+
+    for (unsigned int i = 0; i < p_executor->i_streams; i++)
+    {
+        pthread_mutex_destroy(&p_executor->pp_streams[i]->lock);
+        free(p_executor->pp_streams[i]);
+    }
+    free(p_executor->pp_streams);
+
+    pthread_mutex_destroy(&p_executor->completion_lock);
+    pthread_cond_destroy(&p_executor->idle);
+    pthread_cond_destroy(&p_executor->wake);
+    pthread_mutex_destroy(&p_executor->lock);
+    free(p_executor);
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_stream_add
+ *****************************************************************************/
+int dvbpsi_executor_stream_add(dvbpsi_executor_t *p_executor,
+                               dvbpsi_executor_push_cb pf_push, void *p_stream_data)
+{
+    assert(p_executor);
+    assert(pf_push);
+
+    executor_stream_t *p_stream = calloc(1, sizeof(executor_stream_t));
+    if (p_stream == NULL)
+        return -1;
+    p_stream->pf_push = pf_push;
+    p_stream->p_data = p_stream_data;
+    p_stream->pp_last = &p_stream->p_first;
+    pthread_mutex_init(&p_stream->lock, NULL);
+
+    pthread_mutex_lock(&p_executor->lock);
+    const unsigned int i_id = p_executor->i_streams;
+    if (i_id < p_executor->i_max_streams)
+    {
+        p_stream->i_worker = i_id % p_executor->i_workers;
+        p_executor->pp_streams[i_id] = p_stream;
+        __atomic_store_n(&p_executor->i_streams, i_id + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&p_executor->lock);
+
+    if (i_id >= p_executor->i_max_streams)
+    {
+        pthread_mutex_destroy(&p_stream->lock);
+        free(p_stream);
+        return -1;
+    }
+    return (int)i_id;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_submit
+ *****************************************************************************/
+bool dvbpsi_executor_submit(dvbpsi_executor_t *p_executor,
+                            const dvbpsi_executor_batch_t *p_batches, size_t i_batches)
+{
+    assert(p_executor);
+
+    /* Check and copy every batch before queuing any, so that a failure
+     * leaves nothing queued */
+    const unsigned int i_streams = __atomic_load_n(&p_executor->i_streams, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < i_batches; i++)
+    {
+        if (p_batches[i].i_stream >= i_streams)
+            return false;
+    }
+
+    executor_job_t *p_jobs = NULL, **pp_last = &p_jobs;
+    for (size_t i = 0; i < i_batches; i++)
+    {
+        const dvbpsi_executor_batch_t *p_batch = &p_batches[i];
+        if (p_batch->i_packets == 0)
+            continue;
+
+        executor_job_t *p_job = malloc(sizeof(executor_job_t) + p_batch->i_packets * 188);
+        if (p_job == NULL)
+        {
+            while (p_jobs)
+            {
+                executor_job_t *p_next = p_jobs->p_next;
+                free(p_jobs);
+                p_jobs = p_next;
+            }
+            return false;
+        }
+        p_job->p_next = NULL;
+        p_job->i_packets = p_batch->i_packets;
+        memcpy(p_job->p_packets, p_batch->p_packets, p_batch->i_packets * 188);
+        *pp_last = p_job;
+        pp_last = &p_job->p_next;
+    }
+
+    for (size_t i = 0; i < i_batches; i++)
+    {
+        const dvbpsi_executor_batch_t *p_batch = &p_batches[i];
+        if (p_batch->i_packets == 0)
+            continue;
+
+        executor_job_t *p_job = p_jobs;
+        p_jobs = p_job->p_next;
+        p_job->p_next = NULL;
+
+        __atomic_add_fetch(&p_executor->i_pending, 1, __ATOMIC_ACQ_REL);
+
+        executor_stream_t *p_stream = p_executor->pp_streams[p_batch->i_stream];
+        pthread_mutex_lock(&p_stream->lock);
+        *p_stream->pp_last = p_job;
+        p_stream->pp_last = &p_job->p_next;
+        const bool b_schedule = !p_stream->b_scheduled;
+        p_stream->b_scheduled = true;
+        const unsigned int i_worker = p_stream->i_worker;
+        pthread_mutex_unlock(&p_stream->lock);
+
+        if (b_schedule)
+            executor_schedule(p_executor, i_worker, p_stream);
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_wait
+ *****************************************************************************/
+void dvbpsi_executor_wait(dvbpsi_executor_t *p_executor)
+{
+    assert(p_executor);
+
+    pthread_mutex_lock(&p_executor->lock);
+    while (__atomic_load_n(&p_executor->i_pending, __ATOMIC_ACQUIRE) != 0)
+        pthread_cond_wait(&p_executor->idle, &p_executor->lock);
+    pthread_mutex_unlock(&p_executor->lock);
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_post
+ *****************************************************************************/
+bool dvbpsi_executor_post(dvbpsi_executor_t *p_executor,
+                          dvbpsi_executor_complete_cb pf_complete, void *p_data)
+{
+    assert(p_executor);
+    assert(pf_complete);
+
+    executor_completion_t *p_completion = malloc(sizeof(executor_completion_t));
+    if (p_completion == NULL)
+        return false;
+    p_completion->p_next = NULL;
+    p_completion->pf_complete = pf_complete;
+    p_completion->p_data = p_data;
+
+    pthread_mutex_lock(&p_executor->completion_lock);
+    *p_executor->pp_last_completion = p_completion;
+    p_executor->pp_last_completion = &p_completion->p_next;
+    pthread_mutex_unlock(&p_executor->completion_lock);
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_executor_drain
+ *****************************************************************************/
+size_t dvbpsi_executor_drain(dvbpsi_executor_t *p_executor)
+{
+    assert(p_executor);
+
+    pthread_mutex_lock(&p_executor->completion_lock);
+    executor_completion_t *p_completion = p_executor->p_completions;
+    p_executor->p_completions = NULL;
+    p_executor->pp_last_completion = &p_executor->p_completions;
+    pthread_mutex_unlock(&p_executor->completion_lock);
+
+    size_t i_count = 0;
+    while (p_completion)
+    {
+        executor_completion_t *p_next = p_completion->p_next;
+        p_completion->pf_complete(p_completion->p_data);
+        free(p_completion);
+        p_completion = p_next;
+        i_count++;
+    }
+    return i_count;
+}
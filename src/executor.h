@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * executor.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <executor.h>
+ * \brief Many independent transport streams on a pool of worker threads.
+ *
+ * Each stream owns its dvbpsi_t handles, which are fed by a push callback.
+ * Batches of TS packets submitted for a stream run in submission order, and
+ * never on two workers at the same time, so the handles of a stream need no
+ * locking. A stream is queued on the worker that ran it last and idle
+ * workers steal queued streams from busy ones. Table callbacks run on the
+ * worker; they can hand results to the application threads with
+ * dvbpsi_executor_post() and dvbpsi_executor_drain().
+ *
+ * Only available when the library is built with POSIX threads.
+ */
+
+#ifndef _DVBPSI_EXECUTOR_H_
+#define _DVBPSI_EXECUTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \typedef struct dvbpsi_executor_s dvbpsi_executor_t
+ * \brief Opaque executor.
+ */
+typedef struct dvbpsi_executor_s dvbpsi_executor_t;
+
+/*!
+ * \typedef void (* dvbpsi_executor_push_cb)(void *p_stream_data,
+ *                                           const uint8_t *p_packets,
+ *                                           size_t i_packets)
+ * \brief Pushes the packets of a batch into the handles of a stream, on a
+ * worker thread.
+ */
+typedef void (* dvbpsi_executor_push_cb)(void *p_stream_data,
+                                         const uint8_t *p_packets, size_t i_packets);
+
+/*!
+ * \typedef void (* dvbpsi_executor_complete_cb)(void *p_data)
+ * \brief Completion posted by a worker, run by dvbpsi_executor_drain().
+ */
+typedef void (* dvbpsi_executor_complete_cb)(void *p_data);
+
+/*!
+ * \struct dvbpsi_executor_batch_s
+ * \brief TS packets of one stream.
+ */
+/*!
+ * \typedef struct dvbpsi_executor_batch_s dvbpsi_executor_batch_t
+ * \brief dvbpsi_executor_batch_t type definition.
+ */
+typedef struct dvbpsi_executor_batch_s
+{
+    unsigned int   i_stream;        /*!< id from dvbpsi_executor_stream_add() */
+    const uint8_t *p_packets;       /*!< i_packets packets of 188 bytes */
+    size_t         i_packets;       /*!< number of packets */
+} dvbpsi_executor_batch_t;
+
+/*****************************************************************************
+ * dvbpsi_executor_new
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_executor_t *dvbpsi_executor_new(unsigned int i_workers,
+ *                                            unsigned int i_max_streams)
+ * \brief Start a pool of worker threads.
+ * \param i_workers number of threads, 0 for one per online core
+ * \param i_max_streams maximum number of streams
+ * \return pointer to the executor, NULL on error.
+ */
+dvbpsi_executor_t *dvbpsi_executor_new(unsigned int i_workers, unsigned int i_max_streams);
+
+/*****************************************************************************
+ * dvbpsi_executor_delete
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_executor_delete(dvbpsi_executor_t *p_executor)
+ * \brief Wait for the submitted batches, stop the workers and run the
+ * completions still queued on the calling thread.
+ * \param p_executor executor to delete
+ * \return nothing
+ *
+ * The stream data given to dvbpsi_executor_stream_add() are not freed.
+ */
+void dvbpsi_executor_delete(dvbpsi_executor_t *p_executor);
+
+/*****************************************************************************
+ * dvbpsi_executor_stream_add
+ *****************************************************************************/
+/*!
+ * \fn int dvbpsi_executor_stream_add(dvbpsi_executor_t *p_executor,
+ *                                    dvbpsi_executor_push_cb pf_push,
+ *                                    void *p_stream_data)
+ * \brief Declare a stream.
+ * \param p_executor executor
+ * \param pf_push callback pushing the packets of the stream
+ * \param p_stream_data first argument of pf_push, typically holding the
+ * dvbpsi_t handles of the stream
+ * \return id of the stream, -1 when i_max_streams is reached or on
+ * allocation failure.
+ */
+int dvbpsi_executor_stream_add(dvbpsi_executor_t *p_executor,
+                               dvbpsi_executor_push_cb pf_push, void *p_stream_data);
+
+/*****************************************************************************
+ * dvbpsi_executor_submit
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_executor_submit(dvbpsi_executor_t *p_executor,
+ *                                 const dvbpsi_executor_batch_t *p_batches,
+ *                                 size_t i_batches)
+ * \brief Queue batches of packets, of any streams, without waiting for them.
+ * \param p_executor executor
+ * \param p_batches batches to queue, the packets are copied
+ * \param i_batches number of batches
+ * \return false for an unknown stream id or on allocation failure, no
+ * batch is queued then.
+ *
+ * May be called from several threads, the batches of a stream are then
+ * processed in the order of the calls.
+ */
+bool dvbpsi_executor_submit(dvbpsi_executor_t *p_executor,
+                            const dvbpsi_executor_batch_t *p_batches, size_t i_batches);
+
+/*****************************************************************************
+ * dvbpsi_executor_wait
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_executor_wait(dvbpsi_executor_t *p_executor)
+ * \brief Wait until every submitted batch has been pushed.
+ * \param p_executor executor
+ * \return nothing
+ *
+ * Must not be called from a worker thread.
+ */
+void dvbpsi_executor_wait(dvbpsi_executor_t *p_executor);
+
+/*****************************************************************************
+ * dvbpsi_executor_post
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_executor_post(dvbpsi_executor_t *p_executor,
+ *                               dvbpsi_executor_complete_cb pf_complete,
+ *                               void *p_data)
+ * \brief Queue a completion, usually from a table callback on a worker.
+ * \param p_executor executor
+ * \param pf_complete function to run
+ * \param p_data its argument, for instance the new table
+ * \return false on allocation failure.
+ */
+bool dvbpsi_executor_post(dvbpsi_executor_t *p_executor,
+                          dvbpsi_executor_complete_cb pf_complete, void *p_data);
+
+/*****************************************************************************
+ * dvbpsi_executor_drain
+ *****************************************************************************/
+/*!
+ * \fn size_t dvbpsi_executor_drain(dvbpsi_executor_t *p_executor)
+ * \brief Run the queued completions on the calling thread, in posting order.
+ * \param p_executor executor
+ * \return number of completions run.
+ */
+size_t dvbpsi_executor_drain(dvbpsi_executor_t *p_executor);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of executor.h"
+#endif
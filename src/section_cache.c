@@ -0,0 +1,202 @@
+/*****************************************************************************
+ * section_cache.c: verified PSI sections shared between dvbpsi_t handles
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ * Direct mapped: the key of a section picks one slot, which holds the last
+ * verified section with that hash. Comparing all the bytes, CRC_32
+ * included, costs far less than computing the CRC_32 one byte at a time.
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#include "dvbpsi.h"
+#include "dvbpsi_private.h"
+#include "psi.h"
+#include "section_cache.h"
+
+typedef struct section_cache_slot_s
+{
+    pthread_mutex_t lock;
+    size_t          i_size;         /* 0 when empty */
+    size_t          i_capacity;
+    uint8_t        *p_data;
+} section_cache_slot_t;
+
+struct dvbpsi_section_cache_s
+{
+    section_cache_slot_t *p_slots;
+    unsigned int          i_slots;
+
+    uint64_t              i_lookups;
+    uint64_t              i_hits;
+    uint64_t              i_inserts;
+};
+
+/* Whole section with its CRC_32 */
+static size_t section_cache_size(const dvbpsi_psi_section_t *p_section)
+{
+    return p_section->p_payload_end + 4 - p_section->p_data;
+}
+
+/* table_id, table_id_extension, version, section_number and CRC_32 */
+static section_cache_slot_t *section_cache_slot(dvbpsi_section_cache_t *p_cache,
+                                                const dvbpsi_psi_section_t *p_section,
+                                                const size_t i_size)
+{
+    const uint8_t *p_data = p_section->p_data;
+    const uint8_t *p_crc = p_data + i_size - 4;
+    uint32_t i_key = ((uint32_t)p_crc[0] << 24) | (p_crc[1] << 16) | (p_crc[2] << 8) | p_crc[3];
+
+    i_key ^= ((uint32_t)p_data[0] << 24) | ((uint32_t)p_section->i_extension << 8);
+    if (i_size > 7)
+        i_key ^= (p_data[5] << 16) | p_data[6];
+    i_key *= UINT32_C(0x9e3779b1);
+    return &p_cache->p_slots[i_key % p_cache->i_slots];
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_new
+ *****************************************************************************/
+dvbpsi_section_cache_t *dvbpsi_section_cache_new(unsigned int i_slots)
+{
+    if (i_slots == 0)
+        return NULL;
+
+    dvbpsi_section_cache_t *p_cache = calloc(1, sizeof(dvbpsi_section_cache_t));
+    if (p_cache == NULL)
+        return NULL;
+    p_cache->p_slots = calloc(i_slots, sizeof(section_cache_slot_t));
+    if (p_cache->p_slots == NULL)
+    {
+        free(p_cache);
+        return NULL;
+    }
+    p_cache->i_slots = i_slots;
+    for (unsigned int i = 0; i < i_slots; i++)
+        pthread_mutex_init(&p_cache->p_slots[i].lock, NULL);
+    return p_cache;
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_delete
+ *****************************************************************************/
+void dvbpsi_section_cache_delete(dvbpsi_section_cache_t *p_cache)
+{
+    if (p_cache == NULL)
+        return;
+
+    for (unsigned int i = 0; i < p_cache->i_slots; i++)
+    {
+        pthread_mutex_destroy(&p_cache->p_slots[i].lock);
+        free(p_cache->p_slots[i].p_data);
+    }
+    free(p_cache->p_slots);
+    free(p_cache);
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_attach
+ *****************************************************************************/
+void dvbpsi_section_cache_attach(dvbpsi_t *p_dvbpsi, dvbpsi_section_cache_t *p_cache)
+{
+    assert(p_dvbpsi);
+
+    p_dvbpsi->p_section_cache = p_cache;
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_stats
+ *****************************************************************************/
+void dvbpsi_section_cache_stats(dvbpsi_section_cache_t *p_cache,
+                                dvbpsi_section_cache_stats_t *p_stats)
+{
+    assert(p_cache);
+    assert(p_stats);
+
+    p_stats->i_lookups = __atomic_load_n(&p_cache->i_lookups, __ATOMIC_RELAXED);
+    p_stats->i_hits = __atomic_load_n(&p_cache->i_hits, __ATOMIC_RELAXED);
+    p_stats->i_inserts = __atomic_load_n(&p_cache->i_inserts, __ATOMIC_RELAXED);
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_match
+ *****************************************************************************/
+bool dvbpsi_section_cache_match(dvbpsi_section_cache_t *p_cache,
+                                const dvbpsi_psi_section_t *p_section)
+{
+    const size_t i_size = section_cache_size(p_section);
+    section_cache_slot_t *p_slot = section_cache_slot(p_cache, p_section, i_size);
+
+    pthread_mutex_lock(&p_slot->lock);
+    const bool b_match = (p_slot->i_size == i_size) &&
+                         (memcmp(p_slot->p_data, p_section->p_data, i_size) == 0);
+    pthread_mutex_unlock(&p_slot->lock);
+
+    __atomic_add_fetch(&p_cache->i_lookups, 1, __ATOMIC_RELAXED);
+    if (b_match)
+        __atomic_add_fetch(&p_cache->i_hits, 1, __ATOMIC_RELAXED);
+    return b_match;
+}
+
+/*****************************************************************************
+ * dvbpsi_section_cache_insert
+ *****************************************************************************/
+void dvbpsi_section_cache_insert(dvbpsi_section_cache_t *p_cache,
+                                 const dvbpsi_psi_section_t *p_section)
+{
+    const size_t i_size = section_cache_size(p_section);
+    section_cache_slot_t *p_slot = section_cache_slot(p_cache, p_section, i_size);
+
+    pthread_mutex_lock(&p_slot->lock);
+    if (p_slot->i_capacity < i_size)
+    {
+        uint8_t *p_data = realloc(p_slot->p_data, i_size);
+        if (p_data == NULL)
+        {
+            pthread_mutex_unlock(&p_slot->lock);
+            return;
+        }
+        p_slot->p_data = p_data;
+        p_slot->i_capacity = i_size;
+    }
+    memcpy(p_slot->p_data, p_section->p_data, i_size);
+    p_slot->i_size = i_size;
+    pthread_mutex_unlock(&p_slot->lock);
+
+    __atomic_add_fetch(&p_cache->i_inserts, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * section_cache.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <section_cache.h>
+ * \brief Verified PSI sections shared between dvbpsi_t handles.
+ *
+ * The same NIT, BAT, SDT other or EIT other sections often arrive on many
+ * of the transport streams an application monitors. A section cache keeps
+ * a copy of the sections whose CRC_32 was checked, addressed by table_id,
+ * table_id_extension, version, section_number and CRC_32. A handle the
+ * cache is attached to compares each new section with the cached copy and
+ * only computes the CRC_32 when it differs.
+ *
+ * Thread safe: handles pushed from different threads may share a cache.
+ * Only available when the library is built with POSIX threads.
+ */
+
+#ifndef _DVBPSI_SECTION_CACHE_H_
+#define _DVBPSI_SECTION_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \typedef struct dvbpsi_section_cache_s dvbpsi_section_cache_t
+ * \brief Opaque section cache.
+ */
+typedef struct dvbpsi_section_cache_s dvbpsi_section_cache_t;
+
+/*!
+ * \struct dvbpsi_section_cache_stats_s
+ * \brief Section cache counters.
+ */
+/*!
+ * \typedef struct dvbpsi_section_cache_stats_s dvbpsi_section_cache_stats_t
+ * \brief dvbpsi_section_cache_stats_t type definition.
+ */
+typedef struct dvbpsi_section_cache_stats_s
+{
+    uint64_t     i_lookups;         /*!< Sections looked up */
+    uint64_t     i_hits;            /*!< Sections found, no CRC_32 computed */
+    uint64_t     i_inserts;         /*!< Sections stored, replacing older ones */
+} dvbpsi_section_cache_stats_t;
+
+/*****************************************************************************
+ * dvbpsi_section_cache_new
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_section_cache_t *dvbpsi_section_cache_new(unsigned int i_slots)
+ * \brief Create a section cache.
+ * \param i_slots number of sections kept, each holding up to 4096 bytes
+ * \return pointer to the cache, NULL on allocation failure.
+ *
+ * A section replaces the one in its slot, so the cache needs no eviction,
+ * but a few times more slots than distinct sections avoid most conflicts.
+ */
+dvbpsi_section_cache_t *dvbpsi_section_cache_new(unsigned int i_slots);
+
+/*****************************************************************************
+ * dvbpsi_section_cache_delete
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_section_cache_delete(dvbpsi_section_cache_t *p_cache)
+ * \brief Delete a section cache, after detaching it from every handle.
+ * \param p_cache cache to delete
+ * \return nothing
+ */
+void dvbpsi_section_cache_delete(dvbpsi_section_cache_t *p_cache);
+
+/*****************************************************************************
+ * dvbpsi_section_cache_attach
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_section_cache_attach(dvbpsi_t *p_dvbpsi,
+ *                                      dvbpsi_section_cache_t *p_cache)
+ * \brief Make a handle look up and store its sections in a cache.
+ * \param p_dvbpsi handle
+ * \param p_cache cache, NULL to detach
+ * \return nothing
+ */
+void dvbpsi_section_cache_attach(dvbpsi_t *p_dvbpsi, dvbpsi_section_cache_t *p_cache);
+
+/*****************************************************************************
+ * dvbpsi_section_cache_stats
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_section_cache_stats(dvbpsi_section_cache_t *p_cache,
+ *                                     dvbpsi_section_cache_stats_t *p_stats)
+ * \brief Get the counters of a cache.
+ * \param p_cache cache
+ * \param p_stats receives the counters
+ * \return nothing
+ */
+void dvbpsi_section_cache_stats(dvbpsi_section_cache_t *p_cache,
+                                dvbpsi_section_cache_stats_t *p_stats);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of section_cache.h"
+#endif
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ * snapshot.c: current tables shared with other threads
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ * Readers find a slot and take a reference on its current version between
+ * an increment and a decrement of one of two reader counters, the one of the
+ * parity of the current epoch. A version replaced by the publisher may still
+ * be in the hands of a reader that has not taken its reference yet, so the
+ * store keeps its own reference until two epoch flips later: an epoch only
+ * flips when the readers counted under the previous one are all gone, and
+ * the publisher never waits for that, it checks again on the next publish.
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#include "dvbpsi.h"
+#include "snapshot.h"
+
+struct dvbpsi_snapshot_ref_s
+{
+    void                   *p_table;
+    dvbpsi_snapshot_free_cb pf_free;
+    unsigned int            i_refs;
+
+    dvbpsi_snapshot_ref_t  *p_next;         /* retired versions, publisher only */
+};
+
+typedef struct dvbpsi_snapshot_slot_s
+{
+    uint8_t                 i_table_id;
+    uint16_t                i_extension;
+    dvbpsi_snapshot_ref_t  *p_current;
+
+    struct dvbpsi_snapshot_slot_s *p_next;  /* slots are never removed */
+} dvbpsi_snapshot_slot_t;
+
+struct dvbpsi_snapshot_s
+{
+    dvbpsi_snapshot_slot_t *p_slots;
+
+    unsigned int            i_epoch;
+    unsigned int            ai_readers[2];  /* readers by epoch parity */
+
+    dvbpsi_snapshot_ref_t  *p_retired;      /* replaced during this epoch */
+    dvbpsi_snapshot_ref_t  *p_expiring;     /* replaced during the previous one */
+};
+
+static void snapshot_unref(dvbpsi_snapshot_ref_t *p_ref)
+{
+    if (__atomic_sub_fetch(&p_ref->i_refs, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        p_ref->pf_free(p_ref->p_table);
+        free(p_ref);
+    }
+}
+
+static void snapshot_unref_list(dvbpsi_snapshot_ref_t *p_ref)
+{
+    while (p_ref)
+    {
+        dvbpsi_snapshot_ref_t *p_next = p_ref->p_next;
+        snapshot_unref(p_ref);
+        p_ref = p_next;
+    }
+}
+
+static dvbpsi_snapshot_slot_t *snapshot_find(dvbpsi_snapshot_t *p_snapshot,
+                                             const uint8_t i_table_id,
+                                             const uint16_t i_extension)
+{
+    dvbpsi_snapshot_slot_t *p_slot = __atomic_load_n(&p_snapshot->p_slots, __ATOMIC_ACQUIRE);
+    while (p_slot)
+    {
+        if ((p_slot->i_table_id == i_table_id) && (p_slot->i_extension == i_extension))
+            return p_slot;
+        p_slot = p_slot->p_next;
+    }
+    return NULL;
+}
+
+/* Drop the store references on the versions no reader can reach anymore */
+static void snapshot_reclaim(dvbpsi_snapshot_t *p_snapshot)
+{
+    const unsigned int i_previous = (p_snapshot->i_epoch + 1) & 1;
+
+    if (__atomic_load_n(&p_snapshot->ai_readers[i_previous], __ATOMIC_SEQ_CST) != 0)
+        return;
+
+    snapshot_unref_list(p_snapshot->p_expiring);
+    p_snapshot->p_expiring = p_snapshot->p_retired;
+    p_snapshot->p_retired = NULL;
+    __atomic_store_n(&p_snapshot->i_epoch, p_snapshot->i_epoch + 1, __ATOMIC_SEQ_CST);
+}
+
+/*****************************************************************************
+ * dvbpsi_snapshot_new
+ *****************************************************************************/
+dvbpsi_snapshot_t *dvbpsi_snapshot_new(void)
+{
+    return calloc(1, sizeof(dvbpsi_snapshot_t));
+}
+
+/*****************************************************************************
+ * dvbpsi_snapshot_delete
+ *****************************************************************************/
+void dvbpsi_snapshot_delete(dvbpsi_snapshot_t *p_snapshot)
+{
+    if (p_snapshot == NULL)
+        return;
+
+    dvbpsi_snapshot_slot_t *p_slot = p_snapshot->p_slots;
+    while (p_slot)
+    {
+        dvbpsi_snapshot_slot_t *p_next = p_slot->p_next;
+        if (p_slot->p_current)
+            snapshot_unref(p_slot->p_current);
+        free(p_slot);
+        p_slot = p_next;
+    }
+    snapshot_unref_list(p_snapshot->p_retired);
+    snapshot_unref_list(p_snapshot->p_expiring);
+    free(p_snapshot);
+}
+
+/*****************************************************************************
+ * dvbpsi_snapshot_publish
+ *****************************************************************************/
+bool dvbpsi_snapshot_publish(dvbpsi_snapshot_t *p_snapshot,
+                             const uint8_t i_table_id, const uint16_t i_extension,
+                             void *p_table, dvbpsi_snapshot_free_cb pf_free)
+{
+    assert(p_snapshot);
+    assert(p_table == NULL || pf_free);
+
+    dvbpsi_snapshot_slot_t *p_slot = snapshot_find(p_snapshot, i_table_id, i_extension);
+    if (p_slot == NULL)
+    {
+        if (p_table == NULL)
+            return true;
+
+        p_slot = calloc(1, sizeof(dvbpsi_snapshot_slot_t));
+        if (p_slot == NULL)
+            return false;
+        p_slot->i_table_id = i_table_id;
+        p_slot->i_extension = i_extension;
+        p_slot->p_next = p_snapshot->p_slots;
+        __atomic_store_n(&p_snapshot->p_slots, p_slot, __ATOMIC_RELEASE);
+    }
+
+    dvbpsi_snapshot_ref_t *p_ref = NULL;
+    if (p_table)
+    {
+        p_ref = malloc(sizeof(dvbpsi_snapshot_ref_t));
+        if (p_ref == NULL)
+            return false;
+        p_ref->p_table = p_table;
+        p_ref->pf_free = pf_free;
+        p_ref->i_refs = 1;
+        p_ref->p_next = NULL;
+    }
+
+    dvbpsi_snapshot_ref_t *p_old = __atomic_exchange_n(&p_slot->p_current, p_ref,
+                                                       __ATOMIC_SEQ_CST);
+    if (p_old)
+    {
+        p_old->p_next = p_snapshot->p_retired;
+        p_snapshot->p_retired = p_old;
+    }
+
+    snapshot_reclaim(p_snapshot);
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_snapshot_acquire
+ *****************************************************************************/
+const void *dvbpsi_snapshot_acquire(dvbpsi_snapshot_t *p_snapshot,
+                                    const uint8_t i_table_id, const uint16_t i_extension,
+                                    dvbpsi_snapshot_ref_t **pp_ref)
+{
+    assert(p_snapshot);
+    assert(pp_ref);
+
+    const unsigned int i_parity = __atomic_load_n(&p_snapshot->i_epoch, __ATOMIC_SEQ_CST) & 1;
+    __atomic_add_fetch(&p_snapshot->ai_readers[i_parity], 1, __ATOMIC_SEQ_CST);
+
+    dvbpsi_snapshot_ref_t *p_ref = NULL;
+    dvbpsi_snapshot_slot_t *p_slot = snapshot_find(p_snapshot, i_table_id, i_extension);
+    if (p_slot)
+        p_ref = __atomic_load_n(&p_slot->p_current, __ATOMIC_SEQ_CST);
+    if (p_ref)
+        __atomic_add_fetch(&p_ref->i_refs, 1, __ATOMIC_RELAXED);
+
+    __atomic_sub_fetch(&p_snapshot->ai_readers[i_parity], 1, __ATOMIC_RELEASE);
+
+    *pp_ref = p_ref;
+    return p_ref ? p_ref->p_table : NULL;
+}
+
+/*****************************************************************************
+ * dvbpsi_snapshot_release
+ *****************************************************************************/
+void dvbpsi_snapshot_release(dvbpsi_snapshot_ref_t *p_ref)
+{
+    if (p_ref)
+        snapshot_unref(p_ref);
+}
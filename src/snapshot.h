@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * snapshot.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <snapshot.h>
+ * \brief Current tables shared with other threads.
+ *
+ * A dvbpsi_t handle and its decoders belong to the thread pushing packets.
+ * A snapshot store lets that thread publish each new table from its table
+ * callback, while any other thread reads the current version of a table
+ * without taking a lock. A published table is never modified again, and it
+ * is freed only once the store and all readers have let go of it.
+ *
+ * Typical use, with one store per dvbpsi_t handle:
+ * - in the PMT callback (pushing thread):
+ *   dvbpsi_snapshot_publish(p_store, 0x02, p_pmt->i_program_number,
+ *                           p_pmt, pmt_free);
+ * - in any thread:
+ *   p_pmt = dvbpsi_snapshot_acquire(p_store, 0x02, i_program, &p_ref);
+ *   ... read p_pmt ...
+ *   dvbpsi_snapshot_release(p_ref);
+ */
+
+#ifndef _DVBPSI_SNAPSHOT_H_
+#define _DVBPSI_SNAPSHOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \typedef struct dvbpsi_snapshot_s dvbpsi_snapshot_t
+ * \brief Opaque snapshot store.
+ */
+typedef struct dvbpsi_snapshot_s dvbpsi_snapshot_t;
+
+/*!
+ * \typedef struct dvbpsi_snapshot_ref_s dvbpsi_snapshot_ref_t
+ * \brief Opaque reference to a published table, held by a reader.
+ */
+typedef struct dvbpsi_snapshot_ref_s dvbpsi_snapshot_ref_t;
+
+/*!
+ * \typedef void (* dvbpsi_snapshot_free_cb)(void *p_table)
+ * \brief Frees a published table, for instance by calling dvbpsi_pmt_delete().
+ * May be called from any thread that released the last reference.
+ */
+typedef void (* dvbpsi_snapshot_free_cb)(void *p_table);
+
+/*****************************************************************************
+ * dvbpsi_snapshot_new
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_snapshot_t *dvbpsi_snapshot_new(void)
+ * \brief Create an empty snapshot store.
+ * \return pointer to the store, NULL on allocation failure.
+ */
+dvbpsi_snapshot_t *dvbpsi_snapshot_new(void);
+
+/*****************************************************************************
+ * dvbpsi_snapshot_delete
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_snapshot_delete(dvbpsi_snapshot_t *p_snapshot)
+ * \brief Delete a store and the tables no reader holds anymore.
+ * \param p_snapshot store to delete
+ * \return nothing
+ *
+ * No thread may call dvbpsi_snapshot_acquire() on the store anymore. Tables
+ * still referenced are freed by their last dvbpsi_snapshot_release().
+ */
+void dvbpsi_snapshot_delete(dvbpsi_snapshot_t *p_snapshot);
+
+/*****************************************************************************
+ * dvbpsi_snapshot_publish
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_snapshot_publish(dvbpsi_snapshot_t *p_snapshot,
+ *                                  const uint8_t i_table_id,
+ *                                  const uint16_t i_extension,
+ *                                  void *p_table,
+ *                                  dvbpsi_snapshot_free_cb pf_free)
+ * \brief Make p_table the current version of a table.
+ * \param p_snapshot store
+ * \param i_table_id table_id of the table
+ * \param i_extension table_id_extension, 0 for short sections
+ * \param p_table complete table handed over to the store, NULL to withdraw
+ * the current version
+ * \param pf_free function freeing p_table
+ * \return false on allocation failure, p_table then still belongs to the
+ * caller.
+ *
+ * Never blocks. Only one thread at a time may publish to a store, normally
+ * the one pushing packets into the handle the tables come from. The previous
+ * version is freed later, once no reader can still be acquiring it.
+ */
+bool dvbpsi_snapshot_publish(dvbpsi_snapshot_t *p_snapshot,
+                             const uint8_t i_table_id, const uint16_t i_extension,
+                             void *p_table, dvbpsi_snapshot_free_cb pf_free);
+
+/*****************************************************************************
+ * dvbpsi_snapshot_acquire
+ *****************************************************************************/
+/*!
+ * \fn const void *dvbpsi_snapshot_acquire(dvbpsi_snapshot_t *p_snapshot,
+ *                                         const uint8_t i_table_id,
+ *                                         const uint16_t i_extension,
+ *                                         dvbpsi_snapshot_ref_t **pp_ref)
+ * \brief Get the current version of a table, from any thread.
+ * \param p_snapshot store
+ * \param i_table_id table_id of the table
+ * \param i_extension table_id_extension, 0 for short sections
+ * \param pp_ref receives the reference to give to dvbpsi_snapshot_release(),
+ * NULL when no version is published
+ * \return the table, which stays valid and unchanged until released, or
+ * NULL when no version is published.
+ *
+ * Lock free, it never waits for the publishing thread.
+ */
+const void *dvbpsi_snapshot_acquire(dvbpsi_snapshot_t *p_snapshot,
+                                    const uint8_t i_table_id, const uint16_t i_extension,
+                                    dvbpsi_snapshot_ref_t **pp_ref);
+
+/*****************************************************************************
+ * dvbpsi_snapshot_release
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_snapshot_release(dvbpsi_snapshot_ref_t *p_ref)
+ * \brief Let go of a table returned by dvbpsi_snapshot_acquire().
+ * \param p_ref reference to release, may be NULL
+ * \return nothing
+ */
+void dvbpsi_snapshot_release(dvbpsi_snapshot_ref_t *p_ref);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of snapshot.h"
+#endif
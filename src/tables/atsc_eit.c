@@ -55,19 +55,6 @@ typedef struct dvbpsi_atsc_eit_decoder_s
 } dvbpsi_atsc_eit_decoder_t;
 
 
-static dvbpsi_atsc_eit_event_t *dvbpsi_atsc_EITAddEvent(dvbpsi_atsc_eit_t* p_eit,
-                                            uint16_t i_event_id,
-                                            uint32_t i_start_time,
-                                            uint8_t  i_etm_location,
-                                            uint32_t i_length_seconds,
-                                            uint8_t i_title_length,
-                                            uint8_t *p_title);
-
-static dvbpsi_descriptor_t *dvbpsi_atsc_EITChannelAddDescriptor(
-                                               dvbpsi_atsc_eit_event_t *p_table,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
 static void dvbpsi_atsc_GatherEITSections(dvbpsi_t* p_dvbpsi,
                                           dvbpsi_psi_section_t* p_section);
 
@@ -218,11 +205,11 @@ void dvbpsi_atsc_eit_delete(dvbpsi_atsc_eit_t *p_eit)
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_EITAddChannel
+ * dvbpsi_atsc_eit_event_add
  *****************************************************************************
- * Add a Channel description at the end of the EIT.
+ * Add an event description at the end of the EIT.
  *****************************************************************************/
-static dvbpsi_atsc_eit_event_t *dvbpsi_atsc_EITAddEvent(dvbpsi_atsc_eit_t* p_eit,
+dvbpsi_atsc_eit_event_t *dvbpsi_atsc_eit_event_add(dvbpsi_atsc_eit_t* p_eit,
                                             uint16_t i_event_id,
                                             uint32_t i_start_time,
                                             uint8_t  i_etm_location,
@@ -262,11 +249,11 @@ static dvbpsi_atsc_eit_event_t *dvbpsi_atsc_EITAddEvent(dvbpsi_atsc_eit_t* p_eit
 }
 
 /*****************************************************************************
- * dvbpsi_EITTableAddDescriptor
+ * dvbpsi_atsc_eit_event_descriptor_add
  *****************************************************************************
- * Add a descriptor in the EIT table description.
+ * Add a descriptor in the EIT event description.
  *****************************************************************************/
-static dvbpsi_descriptor_t *dvbpsi_atsc_EITChannelAddDescriptor(
+dvbpsi_descriptor_t *dvbpsi_atsc_eit_event_descriptor_add(
                                                dvbpsi_atsc_eit_event_t *p_event,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
@@ -466,11 +453,19 @@ static void dvbpsi_atsc_GatherEITSections(dvbpsi_t *p_dvbpsi,
         p_eit_decoder->current_eit = *p_eit_decoder->p_building_eit;
         p_eit_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_atsc_DecodeEITSections(p_eit_decoder->p_building_eit,
                                       p_eit_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new EIT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_eit_decoder->pf_eit_callback(p_eit_decoder->p_priv,
                                        p_eit_decoder->p_building_eit);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitEIT(p_eit_decoder, false);
         assert(p_eit_decoder->p_sections == NULL);
@@ -510,7 +505,7 @@ static void dvbpsi_atsc_DecodeEITSections(dvbpsi_atsc_eit_t* p_eit,
         uint8_t  i_title_length      = p_byte[9];
 
         p_byte += 10;
-        p_event = dvbpsi_atsc_EITAddEvent(p_eit, i_event_id, i_start_time,
+        p_event = dvbpsi_atsc_eit_event_add(p_eit, i_event_id, i_start_time,
                                 i_etm_location, i_length_seconds, i_title_length,
                                 p_byte);
         p_byte += i_title_length;
@@ -524,8 +519,8 @@ static void dvbpsi_atsc_DecodeEITSections(dvbpsi_atsc_eit_t* p_eit,
         {
             uint8_t i_tag = p_byte[0];
             uint8_t i_len = p_byte[1];
-            if(i_len + 2 <= p_end - p_byte)
-              dvbpsi_atsc_EITChannelAddDescriptor(p_event, i_tag, i_len, p_byte + 2);
+            if(p_event && (i_len + 2 <= p_end - p_byte))
+              dvbpsi_atsc_eit_event_descriptor_add(p_event, i_tag, i_len, p_byte + 2);
             p_byte += 2 + i_len;
         }
     }
@@ -533,3 +528,151 @@ static void dvbpsi_atsc_DecodeEITSections(dvbpsi_atsc_eit_t* p_eit,
     p_section = p_section->p_next;
   }
 }
+
+/*****************************************************************************
+ * NewEITSection
+ *****************************************************************************
+ * Helper function which allocates and initializes an EIT section.
+ *****************************************************************************/
+static dvbpsi_psi_section_t *NewEITSection(dvbpsi_atsc_eit_t *p_eit, uint8_t i_section_number)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(4096);
+    if (p_section == NULL)
+        return NULL;
+
+    p_section->i_table_id = 0xCB;
+    p_section->b_syntax_indicator = true;
+    p_section->b_private_indicator = true;
+    p_section->i_length = 11;                   /* header + CRC_32 */
+    p_section->i_extension = p_eit->i_source_id;
+    p_section->i_version = p_eit->i_version;
+    p_section->b_current_next = p_eit->b_current_next;
+    p_section->i_number = i_section_number;
+    p_section->p_payload_end += 10;             /* just after num_events_in_section */
+    p_section->p_payload_start = p_section->p_data + 8;
+
+    /* protocol_version */
+    p_section->p_data[8] = p_eit->i_protocol;
+    /* num_events_in_section */
+    p_section->p_data[9] = 0;
+
+    return p_section;
+}
+
+/*****************************************************************************
+ * dvbpsi_atsc_eit_sections_generate
+ *****************************************************************************
+ * Generate EIT sections based on the dvbpsi_atsc_eit_t structure.
+ *****************************************************************************/
+dvbpsi_psi_section_t *dvbpsi_atsc_eit_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_eit_t *p_eit)
+{
+    dvbpsi_psi_section_t *p_result = NewEITSection(p_eit, 0);
+    dvbpsi_psi_section_t *p_current = p_result;
+    dvbpsi_psi_section_t *p_prev;
+    dvbpsi_atsc_eit_event_t *p_event = p_eit->p_first_event;
+    uint8_t i_count = 0;
+
+    if (p_current == NULL)
+    {
+        dvbpsi_error(p_dvbpsi, "ATSC EIT generator", "failed to allocate new PSI section");
+        return NULL;
+    }
+
+    while (p_event != NULL)
+    {
+        dvbpsi_descriptor_t *p_descriptor = p_event->p_first_descriptor;
+        uint8_t *p_event_start;
+        size_t i_event_length = 12 + p_event->i_title_length;
+        uint16_t i_desc_length = 0;
+
+        while (p_descriptor != NULL)
+        {
+            i_event_length += p_descriptor->i_length + 2;
+            p_descriptor = p_descriptor->p_next;
+        }
+
+        /* An event that does not fit in an empty section is left out */
+        if (10 + i_event_length > 4092)
+        {
+            dvbpsi_error(p_dvbpsi, "ATSC EIT generator",
+                         "event 0x%04x too large, skipped", p_event->i_event_id);
+            p_event = p_event->p_next;
+            continue;
+        }
+
+        /* Start a new section if the event doesn't fit in this one */
+        if ((i_count == 255) ||
+            ((i_count > 0) &&
+             ((p_current->p_payload_end - p_current->p_data) + i_event_length > 4092)))
+        {
+            if (p_current->i_number == 0xff)
+            {
+                dvbpsi_error(p_dvbpsi, "ATSC EIT generator", "too many events");
+                break;
+            }
+            p_prev = p_current;
+            p_current = NewEITSection(p_eit, p_prev->i_number + 1);
+            if (p_current == NULL)
+            {
+                dvbpsi_error(p_dvbpsi, "ATSC EIT generator", "failed to allocate new PSI section");
+                goto error;
+            }
+            p_prev->p_next = p_current;
+            i_count = 0;
+        }
+
+        p_event_start = p_current->p_payload_end;
+        /* reserved + event_id */
+        p_event_start[0] = 0xc0 | ((p_event->i_event_id >> 8) & 0x3f);
+        p_event_start[1] = p_event->i_event_id;
+        /* start_time */
+        p_event_start[2] = p_event->i_start_time >> 24;
+        p_event_start[3] = p_event->i_start_time >> 16;
+        p_event_start[4] = p_event->i_start_time >> 8;
+        p_event_start[5] = p_event->i_start_time;
+        /* reserved + ETM_location + length_in_seconds */
+        p_event_start[6] = 0xc0 | ((p_event->i_etm_location & 0x03) << 4)
+                                | ((p_event->i_length_seconds >> 16) & 0x0f);
+        p_event_start[7] = p_event->i_length_seconds >> 8;
+        p_event_start[8] = p_event->i_length_seconds;
+        /* title_text */
+        p_event_start[9] = p_event->i_title_length;
+        memcpy(p_event_start + 10, p_event->i_title, p_event->i_title_length);
+        p_current->p_payload_end += 12 + p_event->i_title_length;
+
+        /* event descriptors */
+        p_descriptor = p_event->p_first_descriptor;
+        while (p_descriptor != NULL)
+        {
+            p_current->p_payload_end[0] = p_descriptor->i_tag;
+            p_current->p_payload_end[1] = p_descriptor->i_length;
+            memcpy(p_current->p_payload_end + 2, p_descriptor->p_data, p_descriptor->i_length);
+            p_current->p_payload_end += p_descriptor->i_length + 2;
+            i_desc_length += p_descriptor->i_length + 2;
+            p_descriptor = p_descriptor->p_next;
+        }
+        /* reserved + descriptors_length */
+        p_event_start[10 + p_event->i_title_length] = 0xf0 | ((i_desc_length >> 8) & 0x0f);
+        p_event_start[11 + p_event->i_title_length] = i_desc_length;
+
+        p_current->i_length += i_event_length;
+        p_current->p_data[9] = ++i_count;
+
+        p_event = p_event->p_next;
+    }
+
+    /* Finalization */
+    p_prev = p_result;
+    while (p_prev != NULL)
+    {
+        p_prev->i_last_number = p_current->i_number;
+        dvbpsi_BuildPSISection(p_dvbpsi, p_prev);
+        p_prev = p_prev->p_next;
+    }
+    return p_result;
+
+error:
+    dvbpsi_DeletePSISections(p_result);
+    return NULL;
+}
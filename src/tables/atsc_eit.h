@@ -281,6 +281,64 @@ inline void dvbpsi_atsc_DeleteEIT(dvbpsi_atsc_eit_t *p_eit)
     dvbpsi_atsc_eit_delete(p_eit);
 }
 
+/*****************************************************************************
+ * dvbpsi_atsc_eit_event_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_atsc_eit_event_t *dvbpsi_atsc_eit_event_add(dvbpsi_atsc_eit_t* p_eit,
+                                            uint16_t i_event_id, uint32_t i_start_time,
+                                            uint8_t i_etm_location, uint32_t i_length_seconds,
+                                            uint8_t i_title_length, uint8_t *p_title)
+ * \brief Add an event description at the end of the EIT.
+ * \param p_eit pointer to the EIT structure
+ * \param i_event_id event ID (14 bits)
+ * \param i_start_time start time in GPS seconds
+ * \param i_etm_location Extended Text Message location
+ * \param i_length_seconds length of the event in seconds (20 bits)
+ * \param i_title_length length of the title in bytes
+ * \param p_title title in multiple string structure format
+ * \return a pointer to the added event.
+ */
+dvbpsi_atsc_eit_event_t *dvbpsi_atsc_eit_event_add(dvbpsi_atsc_eit_t* p_eit,
+                                            uint16_t i_event_id, uint32_t i_start_time,
+                                            uint8_t i_etm_location, uint32_t i_length_seconds,
+                                            uint8_t i_title_length, uint8_t *p_title);
+
+/*****************************************************************************
+ * dvbpsi_atsc_eit_event_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_eit_event_descriptor_add(dvbpsi_atsc_eit_event_t *p_event,
+                                                              uint8_t i_tag, uint8_t i_length,
+                                                              uint8_t *p_data)
+ * \brief Add a descriptor in the EIT event description.
+ * \param p_event pointer to the event structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_eit_event_descriptor_add(dvbpsi_atsc_eit_event_t *p_event,
+                                                          uint8_t i_tag, uint8_t i_length,
+                                                          uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_eit_sections_generate
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_psi_section_t *dvbpsi_atsc_eit_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                             dvbpsi_atsc_eit_t *p_eit)
+ * \brief EIT generator
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_eit EIT structure
+ * \return a pointer to the list of generated PSI sections.
+ *
+ * Generate EIT sections based on the dvbpsi_atsc_eit_t structure. The
+ * table_id_extension is taken from i_source_id.
+ */
+dvbpsi_psi_section_t *dvbpsi_atsc_eit_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_eit_t *p_eit);
+
 #ifdef __cplusplus
 };
 #endif
@@ -380,11 +380,19 @@ static void dvbpsi_atsc_GatherETTSections(dvbpsi_t* p_dvbpsi,
         p_ett_decoder->current_ett = *p_ett_decoder->p_building_ett;
         p_ett_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_atsc_DecodeETTSections(p_ett_decoder->p_building_ett,
                                       p_ett_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new ETT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_ett_decoder->pf_ett_callback(p_ett_decoder->p_priv,
                                        p_ett_decoder->p_building_ett);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitETT(p_ett_decoder, false);
         assert(p_ett_decoder->p_sections == NULL);
@@ -418,3 +426,54 @@ static void dvbpsi_atsc_DecodeETTSections(dvbpsi_atsc_ett_t* p_ett,
         p_section = p_section->p_next;
     }
 }
+
+/*****************************************************************************
+ * dvbpsi_atsc_ett_sections_generate
+ *****************************************************************************
+ * Generate ETT section based on the dvbpsi_atsc_ett_t structure.
+ *****************************************************************************/
+dvbpsi_psi_section_t *dvbpsi_atsc_ett_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_ett_t *p_ett)
+{
+    dvbpsi_psi_section_t *p_result;
+
+    /* header (8) + protocol_version (1) + ETM_id (4) + CRC_32 (4) */
+    if (p_ett->i_etm_length > 4096 - 17)
+    {
+        dvbpsi_error(p_dvbpsi, "ATSC ETT generator",
+                     "extended text message too large (%u bytes)", p_ett->i_etm_length);
+        return NULL;
+    }
+
+    p_result = dvbpsi_NewPSISection(4096);
+    if (p_result == NULL)
+        return NULL;
+
+    p_result->i_table_id = 0xCC;
+    p_result->b_syntax_indicator = true;
+    p_result->b_private_indicator = true;
+    p_result->i_length = 14 + p_ett->i_etm_length;
+    p_result->i_extension = p_ett->i_extension;
+    p_result->i_version = p_ett->i_version;
+    p_result->b_current_next = p_ett->b_current_next;
+    p_result->i_number = 0;                     /* ETT is a single section */
+    p_result->i_last_number = 0;
+    p_result->p_payload_end += 13;              /* just after ETM_id */
+    p_result->p_payload_start = p_result->p_data + 8;
+
+    /* protocol_version */
+    p_result->p_data[8] = p_ett->i_protocol;
+    /* ETM_id */
+    p_result->p_data[9] = p_ett->i_etm_id >> 24;
+    p_result->p_data[10] = p_ett->i_etm_id >> 16;
+    p_result->p_data[11] = p_ett->i_etm_id >> 8;
+    p_result->p_data[12] = p_ett->i_etm_id;
+    /* extended_text_message */
+    if (p_ett->i_etm_length > 0)
+        memcpy(p_result->p_payload_end, p_ett->p_etm_data, p_ett->i_etm_length);
+    p_result->p_payload_end += p_ett->i_etm_length;
+
+    /* Finalization */
+    dvbpsi_BuildPSISection(p_dvbpsi, p_result);
+    return p_result;
+}
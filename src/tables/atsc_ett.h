@@ -272,6 +272,23 @@ inline void dvbpsi_atsc_DeleteETT(dvbpsi_atsc_ett_t *p_ett)
     dvbpsi_atsc_ett_delete(p_ett);
 }
 
+/*****************************************************************************
+ * dvbpsi_atsc_ett_sections_generate
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_psi_section_t *dvbpsi_atsc_ett_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                             dvbpsi_atsc_ett_t *p_ett)
+ * \brief ETT generator
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_ett ETT structure
+ * \return a pointer to the generated PSI section.
+ *
+ * Generate an ETT section based on the dvbpsi_atsc_ett_t structure. p_etm_data
+ * holds the multiple string structure, copied as is.
+ */
+dvbpsi_psi_section_t *dvbpsi_atsc_ett_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_ett_t *p_ett);
+
 #ifdef __cplusplus
 };
 #endif
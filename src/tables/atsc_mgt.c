@@ -55,22 +55,6 @@ typedef struct dvbpsi_atsc_mgt_decoder_s
 
 } dvbpsi_atsc_mgt_decoder_t;
 
-static dvbpsi_descriptor_t *dvbpsi_atsc_MGTAddDescriptor(
-                                               dvbpsi_atsc_mgt_t *p_mgt,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
-static dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_MGTAddTable(dvbpsi_atsc_mgt_t* p_mgt,
-						 uint16_t i_table_type,
-						 uint16_t i_table_type_pid,
-						 uint8_t  i_table_type_version,
-						 uint32_t i_number_bytes);
-
-static dvbpsi_descriptor_t *dvbpsi_atsc_MGTTableAddDescriptor(
-                                               dvbpsi_atsc_mgt_table_t *p_table,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
 static void dvbpsi_atsc_GatherMGTSections(dvbpsi_t * p_dvbpsi,
                                           dvbpsi_psi_section_t * p_section);
 
@@ -216,11 +200,11 @@ void dvbpsi_atsc_mgt_delete(dvbpsi_atsc_mgt_t *p_mgt)
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_MGTAddDescriptor
+ * dvbpsi_atsc_mgt_descriptor_add
  *****************************************************************************
  * Add a descriptor to the MGT table.
  *****************************************************************************/
-static dvbpsi_descriptor_t *dvbpsi_atsc_MGTAddDescriptor(
+dvbpsi_descriptor_t *dvbpsi_atsc_mgt_descriptor_add(
                                                dvbpsi_atsc_mgt_t *p_mgt,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
@@ -240,11 +224,11 @@ static dvbpsi_descriptor_t *dvbpsi_atsc_MGTAddDescriptor(
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_MGTAddTable
+ * dvbpsi_atsc_mgt_table_add
  *****************************************************************************
  * Add a Table description at the end of the MGT.
  *****************************************************************************/
-static dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_MGTAddTable(dvbpsi_atsc_mgt_t* p_mgt,
+dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_mgt_table_add(dvbpsi_atsc_mgt_t* p_mgt,
 						 uint16_t i_table_type,
 						 uint16_t i_table_type_pid,
 						 uint8_t  i_table_type_version,
@@ -279,11 +263,11 @@ static dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_MGTAddTable(dvbpsi_atsc_mgt_t* p_mgt
 }
 
 /*****************************************************************************
- * dvbpsi_MGTTableAddDescriptor
+ * dvbpsi_atsc_mgt_table_descriptor_add
  *****************************************************************************
  * Add a descriptor in the MGT table description.
  *****************************************************************************/
-static dvbpsi_descriptor_t *dvbpsi_atsc_MGTTableAddDescriptor(
+dvbpsi_descriptor_t *dvbpsi_atsc_mgt_table_descriptor_add(
                                                dvbpsi_atsc_mgt_table_t *p_table,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
@@ -487,11 +471,19 @@ static void dvbpsi_atsc_GatherMGTSections(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section
         p_mgt_decoder->current_mgt = *p_mgt_decoder->p_building_mgt;
         p_mgt_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_atsc_DecodeMGTSections(p_mgt_decoder->p_building_mgt,
                                       p_mgt_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new MGT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_mgt_decoder->pf_mgt_callback(p_mgt_decoder->p_priv,
                                        p_mgt_decoder->p_building_mgt);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitMGT(p_mgt_decoder, false);
         assert(p_mgt_decoder->p_sections == NULL);
@@ -531,7 +523,7 @@ static void dvbpsi_atsc_DecodeMGTSections(dvbpsi_atsc_mgt_t* p_mgt,
                                         ((uint32_t)(p_byte[8]));
         i_length = ((uint16_t)(p_byte[9] & 0xf) <<8) | p_byte[10];
 
-        p_table = dvbpsi_atsc_MGTAddTable(p_mgt,
+        p_table = dvbpsi_atsc_mgt_table_add(p_mgt,
 					  i_table_type,
 					  i_table_type_pid,
 					  i_table_type_version,
@@ -547,7 +539,7 @@ static void dvbpsi_atsc_DecodeMGTSections(dvbpsi_atsc_mgt_t* p_mgt,
             uint8_t i_tag = p_byte[0];
             uint8_t i_len = p_byte[1];
             if(i_len + 2 <= p_end - p_byte)
-              dvbpsi_atsc_MGTTableAddDescriptor(p_table, i_tag, i_len, p_byte + 2);
+              dvbpsi_atsc_mgt_table_descriptor_add(p_table, i_tag, i_len, p_byte + 2);
             p_byte += 2 + i_len;
         }
     }
@@ -561,10 +553,128 @@ static void dvbpsi_atsc_DecodeMGTSections(dvbpsi_atsc_mgt_t* p_mgt,
     {
         uint8_t i_tag = p_byte[0];
         uint8_t i_len = p_byte[1];
-        if(i_length + 2 <= p_end - p_byte)
-          dvbpsi_atsc_MGTAddDescriptor(p_mgt, i_tag, i_len, p_byte + 2);
+        if(i_len + 2 <= p_end - p_byte)
+          dvbpsi_atsc_mgt_descriptor_add(p_mgt, i_tag, i_len, p_byte + 2);
         p_byte += 2 + i_len;
     }
     p_section = p_section->p_next;
   }
 }
+
+/*****************************************************************************
+ * dvbpsi_atsc_mgt_sections_generate
+ *****************************************************************************
+ * Generate MGT sections based on the dvbpsi_atsc_mgt_t structure.
+ *****************************************************************************/
+dvbpsi_psi_section_t *dvbpsi_atsc_mgt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_mgt_t *p_mgt)
+{
+    dvbpsi_psi_section_t *p_result = dvbpsi_NewPSISection(4096);
+    dvbpsi_atsc_mgt_table_t *p_table = p_mgt->p_first_table;
+    dvbpsi_descriptor_t *p_descriptor;
+    uint16_t i_tables_defined = 0;
+    uint16_t i_length;
+    uint8_t *p_start;
+
+    if (p_result == NULL)
+        return NULL;
+
+    p_result->i_table_id = 0xC7;
+    p_result->b_syntax_indicator = true;
+    p_result->b_private_indicator = true;
+    p_result->i_length = 12;                    /* header + CRC_32 */
+    p_result->i_extension = p_mgt->i_extension; /* table_id_extension, 0x0000 */
+    p_result->i_version = p_mgt->i_version;
+    p_result->b_current_next = p_mgt->b_current_next;
+    p_result->i_number = 0;                     /* MGT is a single section */
+    p_result->i_last_number = 0;
+    p_result->p_payload_end += 11;              /* just after tables_defined */
+    p_result->p_payload_start = p_result->p_data + 8;
+
+    /* protocol_version */
+    p_result->p_data[8] = p_mgt->i_protocol;
+
+    /* Tables, keeping 2 bytes for descriptors_length and 4 for the CRC_32 */
+    while (p_table != NULL)
+    {
+        i_length = 11;
+        for (p_descriptor = p_table->p_first_descriptor; p_descriptor;
+             p_descriptor = p_descriptor->p_next)
+            i_length += p_descriptor->i_length + 2;
+
+        if ((p_result->p_payload_end - p_result->p_data) + i_length > 4090)
+        {
+            dvbpsi_error(p_dvbpsi, "ATSC MGT generator", "unable to carry all the tables");
+            break;
+        }
+
+        p_start = p_result->p_payload_end;
+        /* table_type */
+        p_start[0] = p_table->i_table_type >> 8;
+        p_start[1] = p_table->i_table_type;
+        /* reserved | table_type_PID */
+        p_start[2] = 0xe0 | ((p_table->i_table_type_pid >> 8) & 0x1f);
+        p_start[3] = p_table->i_table_type_pid;
+        /* reserved | table_type_version_number */
+        p_start[4] = 0xe0 | (p_table->i_table_type_version & 0x1f);
+        /* number_bytes */
+        p_start[5] = p_table->i_number_bytes >> 24;
+        p_start[6] = p_table->i_number_bytes >> 16;
+        p_start[7] = p_table->i_number_bytes >> 8;
+        p_start[8] = p_table->i_number_bytes;
+
+        p_result->p_payload_end += 11;
+        p_result->i_length += 11;
+
+        for (p_descriptor = p_table->p_first_descriptor; p_descriptor;
+             p_descriptor = p_descriptor->p_next)
+        {
+            p_result->p_payload_end[0] = p_descriptor->i_tag;
+            p_result->p_payload_end[1] = p_descriptor->i_length;
+            memcpy(p_result->p_payload_end + 2, p_descriptor->p_data, p_descriptor->i_length);
+            p_result->p_payload_end += p_descriptor->i_length + 2;
+            p_result->i_length += p_descriptor->i_length + 2;
+        }
+
+        /* reserved | table_type_descriptors_length */
+        i_length = p_result->p_payload_end - p_start - 11;
+        p_start[9] = 0xf0 | ((i_length >> 8) & 0x0f);
+        p_start[10] = i_length;
+
+        i_tables_defined++;
+        p_table = p_table->p_next;
+    }
+
+    /* tables_defined */
+    p_result->p_data[9] = i_tables_defined >> 8;
+    p_result->p_data[10] = i_tables_defined;
+
+    /* MGT descriptors */
+    p_start = p_result->p_payload_end;
+    p_result->p_payload_end += 2;
+    p_result->i_length += 2;
+
+    p_descriptor = p_mgt->p_first_descriptor;
+    while ((p_descriptor != NULL) &&
+           ((p_result->p_payload_end - p_result->p_data) + p_descriptor->i_length + 2 <= 4092))
+    {
+        p_result->p_payload_end[0] = p_descriptor->i_tag;
+        p_result->p_payload_end[1] = p_descriptor->i_length;
+        memcpy(p_result->p_payload_end + 2, p_descriptor->p_data, p_descriptor->i_length);
+        p_result->p_payload_end += p_descriptor->i_length + 2;
+        p_result->i_length += p_descriptor->i_length + 2;
+        p_descriptor = p_descriptor->p_next;
+    }
+
+    if (p_descriptor != NULL)
+        dvbpsi_error(p_dvbpsi, "ATSC MGT generator", "unable to carry all the descriptors");
+
+    /* reserved | descriptors_length */
+    i_length = p_result->p_payload_end - p_start - 2;
+    p_start[0] = 0xf0 | ((i_length >> 8) & 0x0f);
+    p_start[1] = i_length;
+
+    /* Finalization */
+    dvbpsi_BuildPSISection(p_dvbpsi, p_result);
+    return p_result;
+}
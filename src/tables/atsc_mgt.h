@@ -277,6 +277,85 @@ inline void dvbpsi_atsc_DeleteMGT(dvbpsi_atsc_mgt_t *p_mgt)
     dvbpsi_atsc_mgt_delete(p_mgt);
 }
 
+/*****************************************************************************
+ * dvbpsi_atsc_mgt_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_mgt_descriptor_add(dvbpsi_atsc_mgt_t *p_mgt,
+                                                          uint8_t i_tag, uint8_t i_length,
+                                                          uint8_t *p_data)
+ * \brief Add a descriptor to the MGT.
+ * \param p_mgt pointer to the MGT structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_mgt_descriptor_add(dvbpsi_atsc_mgt_t *p_mgt,
+                                                   uint8_t i_tag, uint8_t i_length,
+                                                   uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_mgt_table_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_mgt_table_add(dvbpsi_atsc_mgt_t* p_mgt,
+                                                         uint16_t i_table_type,
+                                                         uint16_t i_table_type_pid,
+                                                         uint8_t  i_table_type_version,
+                                                         uint32_t i_number_bytes)
+ * \brief Add a table description at the end of the MGT.
+ * \param p_mgt pointer to the MGT structure
+ * \param i_table_type type of table
+ * \param i_table_type_pid PID of table
+ * \param i_table_type_version version of table
+ * \param i_number_bytes bytes used for table
+ * \return a pointer to the added table description.
+ */
+dvbpsi_atsc_mgt_table_t *dvbpsi_atsc_mgt_table_add(dvbpsi_atsc_mgt_t* p_mgt,
+                                                 uint16_t i_table_type,
+                                                 uint16_t i_table_type_pid,
+                                                 uint8_t  i_table_type_version,
+                                                 uint32_t i_number_bytes);
+
+/*****************************************************************************
+ * dvbpsi_atsc_mgt_table_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_mgt_table_descriptor_add(
+                                               dvbpsi_atsc_mgt_table_t *p_table,
+                                               uint8_t i_tag, uint8_t i_length,
+                                               uint8_t *p_data)
+ * \brief Add a descriptor in the MGT table description.
+ * \param p_table pointer to the table description structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_mgt_table_descriptor_add(
+                                               dvbpsi_atsc_mgt_table_t *p_table,
+                                               uint8_t i_tag, uint8_t i_length,
+                                               uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_mgt_sections_generate
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_psi_section_t *dvbpsi_atsc_mgt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                              dvbpsi_atsc_mgt_t *p_mgt)
+ * \brief MGT generator
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_mgt MGT structure
+ * \return a pointer to the generated PSI section.
+ *
+ * Generate the MGT section based on the dvbpsi_atsc_mgt_t structure. The MGT
+ * always fits in a single section of at most 4096 bytes, tables which do not
+ * fit are dropped.
+ */
+dvbpsi_psi_section_t *dvbpsi_atsc_mgt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_mgt_t *p_mgt);
+
 #ifdef __cplusplus
 };
 #endif
@@ -54,10 +54,6 @@ typedef struct dvbpsi_atsc_stt_decoder_s
 
 } dvbpsi_atsc_stt_decoder_t;
 
-dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor(dvbpsi_atsc_stt_t *p_stt,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
 static void dvbpsi_atsc_GatherSTTSections(dvbpsi_t* p_dvbpsi,
                                           dvbpsi_psi_section_t* p_section);
 
@@ -161,6 +157,7 @@ void dvbpsi_atsc_stt_init(dvbpsi_atsc_stt_t *p_stt, uint8_t i_table_id,
 
     p_stt->i_version = i_version;
     p_stt->b_current_next = b_current_next;
+    p_stt->i_protocol = 0;
 
     p_stt->p_first_descriptor = NULL;
 }
@@ -205,11 +202,11 @@ void dvbpsi_atsc_stt_delete(dvbpsi_atsc_stt_t *p_stt)
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_STTAddDescriptor
+ * dvbpsi_atsc_stt_descriptor_add
  *****************************************************************************
  * Add a descriptor to the STT table.
  *****************************************************************************/
-dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor( dvbpsi_atsc_stt_t *p_stt,
+dvbpsi_descriptor_t *dvbpsi_atsc_stt_descriptor_add(dvbpsi_atsc_stt_t *p_stt,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
 {
@@ -226,6 +223,14 @@ dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor( dvbpsi_atsc_stt_t *p_stt,
     return p_descriptor;
 }
 
+/* Deprecated name of dvbpsi_atsc_stt_descriptor_add(), kept for the ABI */
+dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor(dvbpsi_atsc_stt_t *p_stt,
+                                                  uint8_t i_tag, uint8_t i_length,
+                                                  uint8_t *p_data)
+{
+    return dvbpsi_atsc_stt_descriptor_add(p_stt, i_tag, i_length, p_data);
+}
+
 /*****************************************************************************
  * dvbpsi_ReInitSTT                                                          *
  *****************************************************************************/
@@ -394,11 +399,19 @@ static void dvbpsi_atsc_GatherSTTSections(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section
         p_stt_decoder->current_stt = *p_stt_decoder->p_building_stt;
         p_stt_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_atsc_DecodeSTTSections(p_stt_decoder->p_building_stt,
                                       p_stt_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new STT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_stt_decoder->pf_stt_callback(p_stt_decoder->p_priv,
                                        p_stt_decoder->p_building_stt);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitSTT(p_stt_decoder, false);
         assert(p_stt_decoder->p_sections == NULL);
@@ -416,13 +429,14 @@ static void dvbpsi_atsc_DecodeSTTSections(dvbpsi_atsc_stt_t* p_stt,
     uint8_t *p_byte, *p_end;
     uint16_t i_length = 0;
 
+    p_stt->i_protocol = p_section->p_payload_start[0];
     p_byte = p_section->p_payload_start + 1;
     p_stt->i_system_time = (((uint32_t)p_byte[0]) << 24) |
                            (((uint32_t)p_byte[1]) << 16) |
                            (((uint32_t)p_byte[2]) <<  8) |
                            ((uint32_t)p_byte[3]);
     p_stt->i_gps_utc_offset = p_byte[4];
-    p_stt->i_daylight_savings = (((uint16_t)p_byte[5]) << 16) |
+    p_stt->i_daylight_savings = (((uint16_t)p_byte[5]) << 8) |
                                  ((uint16_t)p_byte[6]);
     p_byte += 7;
     /* Table descriptors */
@@ -434,7 +448,98 @@ static void dvbpsi_atsc_DecodeSTTSections(dvbpsi_atsc_stt_t* p_stt,
         uint8_t i_tag = p_byte[0];
         uint8_t i_len = p_byte[1];
         if (i_len + 2 <= p_end - p_byte)
-            dvbpsi_atsc_STTAddDescriptor(p_stt, i_tag, i_len, p_byte + 2);
+            dvbpsi_atsc_stt_descriptor_add(p_stt, i_tag, i_len, p_byte + 2);
         p_byte += 2 + i_len;
     }
 }
+
+/*****************************************************************************
+ * EncodeSTTTime
+ *****************************************************************************
+ * Helper function which encodes the time fields of the STT.
+ *****************************************************************************/
+static inline void EncodeSTTTime(const dvbpsi_atsc_stt_t *p_stt, uint8_t *p_byte)
+{
+    /* system_time */
+    p_byte[0] = p_stt->i_system_time >> 24;
+    p_byte[1] = p_stt->i_system_time >> 16;
+    p_byte[2] = p_stt->i_system_time >> 8;
+    p_byte[3] = p_stt->i_system_time;
+    /* GPS_UTC_offset */
+    p_byte[4] = p_stt->i_gps_utc_offset;
+    /* daylight_savings */
+    p_byte[5] = p_stt->i_daylight_savings >> 8;
+    p_byte[6] = p_stt->i_daylight_savings;
+}
+
+/*****************************************************************************
+ * dvbpsi_atsc_stt_sections_generate
+ *****************************************************************************
+ * Generate STT section based on the dvbpsi_atsc_stt_t structure.
+ *****************************************************************************/
+dvbpsi_psi_section_t *dvbpsi_atsc_stt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_stt_t *p_stt)
+{
+    dvbpsi_psi_section_t *p_result = dvbpsi_NewPSISection(1024);
+    dvbpsi_descriptor_t *p_descriptor = p_stt->p_first_descriptor;
+
+    if (p_result == NULL)
+        return NULL;
+
+    p_result->i_table_id = 0xCD;
+    p_result->b_syntax_indicator = true;
+    p_result->b_private_indicator = true;
+    p_result->i_length = 17;                    /* header + CRC_32 */
+    p_result->i_extension = 0;                  /* table_id_extension */
+    p_result->i_version = p_stt->i_version;
+    p_result->b_current_next = true;
+    p_result->i_number = 0;                     /* STT is a single section */
+    p_result->i_last_number = 0;
+    p_result->p_payload_end += 16;              /* just after daylight_savings */
+    p_result->p_payload_start = p_result->p_data + 8;
+
+    /* protocol_version */
+    p_result->p_data[8] = p_stt->i_protocol;
+    EncodeSTTTime(p_stt, p_result->p_data + 9);
+
+    while ((p_descriptor != NULL) &&
+           ((p_result->p_payload_end - p_result->p_data) + p_descriptor->i_length + 2 <= 1020))
+    {
+        p_result->p_payload_end[0] = p_descriptor->i_tag;
+        p_result->p_payload_end[1] = p_descriptor->i_length;
+        memcpy(p_result->p_payload_end + 2, p_descriptor->p_data, p_descriptor->i_length);
+        p_result->p_payload_end += p_descriptor->i_length + 2;
+        p_result->i_length += p_descriptor->i_length + 2;
+        p_descriptor = p_descriptor->p_next;
+    }
+
+    if (p_descriptor != NULL)
+        dvbpsi_error(p_dvbpsi, "ATSC STT generator", "unable to carry all the descriptors");
+
+    /* Finalization */
+    dvbpsi_BuildPSISection(p_dvbpsi, p_result);
+    return p_result;
+}
+
+/*****************************************************************************
+ * dvbpsi_atsc_stt_section_update
+ *****************************************************************************
+ * Refresh the time fields of a generated STT section in place.
+ *****************************************************************************/
+bool dvbpsi_atsc_stt_section_update(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section,
+                                    const dvbpsi_atsc_stt_t *p_stt)
+{
+    assert(p_section);
+    assert(p_stt);
+
+    if ((p_section->i_table_id != 0xCD) ||
+        (p_section->p_payload_end - p_section->p_data < 16))
+    {
+        dvbpsi_error(p_dvbpsi, "ATSC STT generator", "not a generated STT section");
+        return false;
+    }
+
+    EncodeSTTTime(p_stt, p_section->p_data + 9);
+    dvbpsi_BuildPSISection(p_dvbpsi, p_section);
+    return true;
+}
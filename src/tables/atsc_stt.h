@@ -50,7 +50,7 @@ typedef struct dvbpsi_atsc_stt_s
     uint8_t                 i_table_id;         /*!< Table id */
     uint16_t                i_extension;        /*!< Subtable id */
 
-    uint8_t                 i_version;          /*!< PSIP Protocol version */
+    uint8_t                 i_version;          /*!< version_number */
     bool                    b_current_next;     /*!< current_next_indicator */
 
     uint32_t                i_system_time;      /*!< GPS seconds since 1 January 1980 00:00:00 UTC. */
@@ -58,6 +58,8 @@ typedef struct dvbpsi_atsc_stt_s
     uint16_t                i_daylight_savings; /*!< Daylight savings control bytes. */
 
     dvbpsi_descriptor_t    *p_first_descriptor; /*!< First descriptor. */
+
+    uint8_t                 i_protocol;         /*!< PSIP Protocol version */
 } dvbpsi_atsc_stt_t;
 
 /*****************************************************************************
@@ -245,6 +247,78 @@ inline void dvbpsi_atsc_DeleteSTT(dvbpsi_atsc_stt_t *p_stt)
     dvbpsi_atsc_stt_delete(p_stt);
 }
 
+/*****************************************************************************
+ * dvbpsi_atsc_stt_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_stt_descriptor_add(dvbpsi_atsc_stt_t *p_stt,
+                                                        uint8_t i_tag, uint8_t i_length,
+                                                        uint8_t *p_data)
+ * \brief Add a descriptor in the STT.
+ * \param p_stt pointer to the STT structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_stt_descriptor_add(dvbpsi_atsc_stt_t *p_stt,
+                                                    uint8_t i_tag, uint8_t i_length,
+                                                    uint8_t *p_data);
+
+/*!
+ * \fn __attribute__((deprecated)) dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor(
+ *                                             dvbpsi_atsc_stt_t *p_stt,
+ *                                             uint8_t i_tag, uint8_t i_length,
+ *                                             uint8_t *p_data)
+ * \brief dvbpsi_atsc_STTAddDescriptor is deprecated use
+ * @see dvbpsi_atsc_stt_descriptor_add() instead.
+ * \param p_stt pointer to the STT structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+__attribute__((deprecated))
+dvbpsi_descriptor_t *dvbpsi_atsc_STTAddDescriptor(dvbpsi_atsc_stt_t *p_stt,
+                                                  uint8_t i_tag, uint8_t i_length,
+                                                  uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_stt_sections_generate
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_psi_section_t *dvbpsi_atsc_stt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                             dvbpsi_atsc_stt_t *p_stt)
+ * \brief STT generator
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_stt STT structure
+ * \return a pointer to the list of generated PSI sections.
+ *
+ * Generate STT sections based on the dvbpsi_atsc_stt_t structure.
+ */
+dvbpsi_psi_section_t *dvbpsi_atsc_stt_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_stt_t *p_stt);
+
+/*****************************************************************************
+ * dvbpsi_atsc_stt_section_update
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_atsc_stt_section_update(dvbpsi_t *p_dvbpsi,
+                                         dvbpsi_psi_section_t *p_section,
+                                         const dvbpsi_atsc_stt_t *p_stt)
+ * \brief Refresh a generated STT section in place.
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_section section returned by dvbpsi_atsc_stt_sections_generate()
+ * \param p_stt STT structure holding the new time fields
+ * \return true if the section was updated else false
+ *
+ * Rewrites system_time, GPS_UTC_offset and daylight_savings and recomputes
+ * the CRC_32 without allocating, so the STT can be refreshed every second.
+ * Descriptors are not re-encoded; regenerate the section when they change.
+ */
+bool dvbpsi_atsc_stt_section_update(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_section,
+                                    const dvbpsi_atsc_stt_t *p_stt);
+
 #ifdef __cplusplus
 };
 #endif
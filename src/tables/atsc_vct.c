@@ -53,33 +53,6 @@ typedef struct dvbpsi_atsc_vct_decoder_s
 
 } dvbpsi_atsc_vct_decoder_t;
 
-static dvbpsi_descriptor_t *dvbpsi_atsc_VCTAddDescriptor(
-                                               dvbpsi_atsc_vct_t *p_vct,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
-static dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_VCTAddChannel(dvbpsi_atsc_vct_t* p_vct,
-                                            uint8_t *p_short_name,
-                                            uint16_t i_major_number,
-                                            uint16_t i_minor_number,
-                                            uint8_t  i_modulation,
-                                            uint32_t i_carrier_freq,
-                                            uint16_t i_channel_tsid,
-                                            uint16_t i_program_number,
-                                            uint8_t  i_etm_location,
-                                            int      b_access_controlled,
-                                            int      b_hidden,
-                                            int      b_path_select,
-                                            int      b_out_of_band,
-                                            int      b_hide_guide,
-                                            uint8_t  i_service_type,
-                                            uint16_t i_source_id);
-
-static dvbpsi_descriptor_t *dvbpsi_atsc_VCTChannelAddDescriptor(
-                                               dvbpsi_atsc_vct_channel_t *p_table,
-                                               uint8_t i_tag, uint8_t i_length,
-                                               uint8_t *p_data);
-
 static void dvbpsi_atsc_GatherVCTSections(dvbpsi_t * p_dvbpsi,
                                           dvbpsi_psi_section_t * p_section);
 
@@ -237,11 +210,11 @@ void dvbpsi_atsc_vct_delete(dvbpsi_atsc_vct_t *p_vct)
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_VCTAddDescriptor
+ * dvbpsi_atsc_vct_descriptor_add
  *****************************************************************************
  * Add a descriptor to the VCT table.
  *****************************************************************************/
-static dvbpsi_descriptor_t *dvbpsi_atsc_VCTAddDescriptor(dvbpsi_atsc_vct_t *p_vct,
+dvbpsi_descriptor_t *dvbpsi_atsc_vct_descriptor_add(dvbpsi_atsc_vct_t *p_vct,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
 {
@@ -260,11 +233,11 @@ static dvbpsi_descriptor_t *dvbpsi_atsc_VCTAddDescriptor(dvbpsi_atsc_vct_t *p_vc
 }
 
 /*****************************************************************************
- * dvbpsi_atsc_VCTAddChannel
+ * dvbpsi_atsc_vct_channel_add
  *****************************************************************************
  * Add a Channel description at the end of the VCT.
  *****************************************************************************/
-static dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_VCTAddChannel(dvbpsi_atsc_vct_t* p_vct,
+dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_vct_channel_add(dvbpsi_atsc_vct_t* p_vct,
                                             uint8_t *p_short_name,
                                             uint16_t i_major_number,
                                             uint16_t i_minor_number,
@@ -273,11 +246,11 @@ static dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_VCTAddChannel(dvbpsi_atsc_vct_t* p
                                             uint16_t i_channel_tsid,
                                             uint16_t i_program_number,
                                             uint8_t  i_etm_location,
-                                            int      b_access_controlled,
-                                            int      b_hidden,
-                                            int      b_path_select,
-                                            int      b_out_of_band,
-                                            int      b_hide_guide,
+                                            bool     b_access_controlled,
+                                            bool     b_hidden,
+                                            bool     b_path_select,
+                                            bool     b_out_of_band,
+                                            bool     b_hide_guide,
                                             uint8_t  i_service_type,
                                             uint16_t i_source_id)
 {
@@ -321,11 +294,11 @@ static dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_VCTAddChannel(dvbpsi_atsc_vct_t* p
 }
 
 /*****************************************************************************
- * dvbpsi_VCTTableAddDescriptor
+ * dvbpsi_atsc_vct_channel_descriptor_add
  *****************************************************************************
  * Add a descriptor in the VCT table description.
  *****************************************************************************/
-static dvbpsi_descriptor_t *dvbpsi_atsc_VCTChannelAddDescriptor(
+dvbpsi_descriptor_t *dvbpsi_atsc_vct_channel_descriptor_add(
                                                dvbpsi_atsc_vct_channel_t *p_channel,
                                                uint8_t i_tag, uint8_t i_length,
                                                uint8_t *p_data)
@@ -532,11 +505,19 @@ static void dvbpsi_atsc_GatherVCTSections(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section
         p_vct_decoder->current_vct = *p_vct_decoder->p_building_vct;
         p_vct_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_atsc_DecodeVCTSections(p_vct_decoder->p_building_vct,
                                       p_vct_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new VCT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_vct_decoder->pf_vct_callback(p_vct_decoder->p_priv,
                                        p_vct_decoder->p_building_vct);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitVCT(p_vct_decoder, false);
         assert(p_vct_decoder->p_sections == NULL);
@@ -583,7 +564,7 @@ static void dvbpsi_atsc_DecodeVCTSections(dvbpsi_atsc_vct_t* p_vct,
             uint16_t i_source_id         = ((uint16_t)(p_byte[28] << 8)) |  ((uint16_t)p_byte[29]);
             i_length = ((uint16_t)(p_byte[30] & 0x3) <<8) | p_byte[31];
 
-            p_channel = dvbpsi_atsc_VCTAddChannel(p_vct, p_byte,
+            p_channel = dvbpsi_atsc_vct_channel_add(p_vct, p_byte,
                                                   i_major_number, i_minor_number,
                                                   i_modulation, i_carrier_freq,
                                                   i_channel_tsid, i_program_number,
@@ -601,7 +582,7 @@ static void dvbpsi_atsc_DecodeVCTSections(dvbpsi_atsc_vct_t* p_vct,
                 uint8_t i_tag = p_byte[0];
                 uint8_t i_len = p_byte[1];
                 if(i_len + 2 <= p_end - p_byte)
-                    dvbpsi_atsc_VCTChannelAddDescriptor(p_channel, i_tag, i_len, p_byte + 2);
+                    dvbpsi_atsc_vct_channel_descriptor_add(p_channel, i_tag, i_len, p_byte + 2);
                 p_byte += 2 + i_len;
             }
         }
@@ -616,9 +597,215 @@ static void dvbpsi_atsc_DecodeVCTSections(dvbpsi_atsc_vct_t* p_vct,
             uint8_t i_tag = p_byte[0];
             uint8_t i_len = p_byte[1];
             if(i_len + 2 <= p_end - p_byte)
-                dvbpsi_atsc_VCTAddDescriptor(p_vct, i_tag, i_len, p_byte + 2);
+                dvbpsi_atsc_vct_descriptor_add(p_vct, i_tag, i_len, p_byte + 2);
             p_byte += 2 + i_len;
         }
         p_section = p_section->p_next;
     }
 }
+
+/*****************************************************************************
+ * NewVCTSection
+ *****************************************************************************
+ * Helper function which allocates and initializes a new PSI section suitable
+ * for carrying VCT data.
+ *****************************************************************************/
+static dvbpsi_psi_section_t *NewVCTSection(dvbpsi_atsc_vct_t *p_vct,
+                                           uint8_t i_section_number)
+{
+    dvbpsi_psi_section_t *p_section = dvbpsi_NewPSISection(1024);
+    if (p_section == NULL)
+        return NULL;
+
+    p_section->i_table_id = p_vct->b_cable_vct ? 0xC9 : 0xC8;
+    p_section->b_syntax_indicator = true;
+    p_section->b_private_indicator = true;
+    p_section->i_length = 11;                   /* header + CRC_32 */
+    p_section->i_extension = p_vct->i_extension; /* transport_stream_id */
+    p_section->i_version = p_vct->i_version;
+    p_section->b_current_next = p_vct->b_current_next;
+    p_section->i_number = i_section_number;
+    p_section->p_payload_end += 10;              /* just after num_channels_in_section */
+    p_section->p_payload_start = p_section->p_data + 8;
+
+    /* protocol_version */
+    p_section->p_data[8] = p_vct->i_protocol;
+    /* num_channels_in_section is filled in while adding channels */
+    p_section->p_data[9] = 0;
+
+    return p_section;
+}
+
+/*****************************************************************************
+ * EncodeVCTDescriptors
+ *****************************************************************************
+ * Helper function which appends a descriptor loop to a section and returns
+ * the first descriptor which did not fit in.
+ *****************************************************************************/
+static dvbpsi_descriptor_t *EncodeVCTDescriptors(dvbpsi_psi_section_t *p_section,
+                                                 dvbpsi_descriptor_t *p_descriptor,
+                                                 int i_max_size)
+{
+    while ((p_descriptor != NULL) &&
+           ((p_section->p_payload_end - p_section->p_data)
+                    + p_descriptor->i_length + 2 <= i_max_size))
+    {
+        p_section->p_payload_end[0] = p_descriptor->i_tag;
+        p_section->p_payload_end[1] = p_descriptor->i_length;
+        memcpy(p_section->p_payload_end + 2, p_descriptor->p_data, p_descriptor->i_length);
+        p_section->p_payload_end += p_descriptor->i_length + 2;
+        p_section->i_length += p_descriptor->i_length + 2;
+        p_descriptor = p_descriptor->p_next;
+    }
+    return p_descriptor;
+}
+
+/*****************************************************************************
+ * dvbpsi_atsc_vct_sections_generate
+ *****************************************************************************
+ * Generate VCT sections based on the dvbpsi_atsc_vct_t structure.
+ *****************************************************************************/
+dvbpsi_psi_section_t *dvbpsi_atsc_vct_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_vct_t *p_vct)
+{
+    dvbpsi_psi_section_t *p_result = NewVCTSection(p_vct, 0);
+    dvbpsi_psi_section_t *p_current = p_result;
+    dvbpsi_psi_section_t *p_prev;
+    dvbpsi_atsc_vct_channel_t *p_channel = p_vct->p_first_channel;
+    dvbpsi_descriptor_t *p_descriptor;
+    int i_additional_length = 0;
+
+    if (p_result == NULL)
+        return NULL;
+
+    /* Reserve room in every section for the additional_descriptors_length
+     * field, the additional descriptors themselves only go to the last one */
+    for (p_descriptor = p_vct->p_first_descriptor; p_descriptor;
+         p_descriptor = p_descriptor->p_next)
+        i_additional_length += p_descriptor->i_length + 2;
+
+    while (p_channel != NULL)
+    {
+        uint8_t *p_channel_start;
+        uint16_t i_channel_length = 32;
+
+        for (p_descriptor = p_channel->p_first_descriptor; p_descriptor;
+             p_descriptor = p_descriptor->p_next)
+            i_channel_length += p_descriptor->i_length + 2;
+
+        /* Start a new section when this channel does not fit (1024 minus
+         * additional_descriptors_length and CRC_32) */
+        if ((p_current->p_data[9] == 0xff) ||
+            ((p_current->p_data[9] > 0) &&
+             ((p_current->p_payload_end - p_current->p_data) + i_channel_length > 1018)))
+        {
+            if (p_current->i_number == 0xff)
+            {
+                dvbpsi_error(p_dvbpsi, "ATSC VCT generator", "too many channels");
+                break;
+            }
+            p_prev = p_current;
+            p_current = NewVCTSection(p_vct, p_prev->i_number + 1);
+            if (p_current == NULL)
+            {
+                p_current = p_prev;
+                break;
+            }
+            p_prev->p_next = p_current;
+        }
+
+        p_channel_start = p_current->p_payload_end;
+
+        /* short_name */
+        memcpy(p_channel_start, p_channel->i_short_name, 14);
+        /* reserved | major_channel_number | minor_channel_number */
+        p_channel_start[14] = 0xf0 | ((p_channel->i_major_number >> 6) & 0x0f);
+        p_channel_start[15] = ((p_channel->i_major_number & 0x3f) << 2)
+                            | ((p_channel->i_minor_number >> 8) & 0x03);
+        p_channel_start[16] = p_channel->i_minor_number;
+        /* modulation_mode */
+        p_channel_start[17] = p_channel->i_modulation;
+        /* carrier_frequency */
+        p_channel_start[18] = p_channel->i_carrier_freq >> 24;
+        p_channel_start[19] = p_channel->i_carrier_freq >> 16;
+        p_channel_start[20] = p_channel->i_carrier_freq >> 8;
+        p_channel_start[21] = p_channel->i_carrier_freq;
+        /* channel_TSID */
+        p_channel_start[22] = p_channel->i_channel_tsid >> 8;
+        p_channel_start[23] = p_channel->i_channel_tsid;
+        /* program_number */
+        p_channel_start[24] = p_channel->i_program_number >> 8;
+        p_channel_start[25] = p_channel->i_program_number;
+        /* ETM_location | access_controlled | hidden | path_select |
+           out_of_band | hide_guide | reserved */
+        p_channel_start[26] = ((p_channel->i_etm_location & 0x3) << 6)
+                            | (p_channel->b_access_controlled ? 0x20 : 0x00)
+                            | (p_channel->b_hidden ? 0x10 : 0x00)
+                            | (p_channel->b_path_select ? 0x08 : 0x00)
+                            | (p_channel->b_out_of_band ? 0x04 : 0x00)
+                            | (p_channel->b_hide_guide ? 0x02 : 0x00)
+                            | 0x01;
+        /* reserved | service_type */
+        p_channel_start[27] = 0xc0 | (p_channel->i_service_type & 0x3f);
+        /* source_id */
+        p_channel_start[28] = p_channel->i_source_id >> 8;
+        p_channel_start[29] = p_channel->i_source_id;
+
+        p_current->p_payload_end += 32;
+        p_current->i_length += 32;
+
+        /* Channel descriptors */
+        p_descriptor = EncodeVCTDescriptors(p_current, p_channel->p_first_descriptor, 1018);
+        if (p_descriptor != NULL)
+            dvbpsi_error(p_dvbpsi, "ATSC VCT generator", "unable to carry all the descriptors");
+
+        /* reserved | descriptors_length */
+        i_channel_length = p_current->p_payload_end - p_channel_start - 32;
+        p_channel_start[30] = 0xfc | ((i_channel_length >> 8) & 0x03);
+        p_channel_start[31] = i_channel_length;
+
+        /* num_channels_in_section */
+        p_current->p_data[9]++;
+
+        p_channel = p_channel->p_next;
+    }
+
+    /* Additional descriptors go to the last section, open a new one if
+     * they do not fit in */
+    if ((i_additional_length > 0) &&
+        ((p_current->p_payload_end - p_current->p_data) + i_additional_length > 1018) &&
+        (p_current->i_number < 0xff))
+    {
+        p_prev = p_current;
+        p_current = NewVCTSection(p_vct, p_prev->i_number + 1);
+        if (p_current == NULL)
+            p_current = p_prev;
+        else
+            p_prev->p_next = p_current;
+    }
+
+    /* Finalization */
+    for (p_prev = p_result; p_prev != NULL; p_prev = p_prev->p_next)
+    {
+        uint8_t *p_length = p_prev->p_payload_end;
+        p_prev->p_payload_end += 2;
+        p_prev->i_length += 2;
+
+        if (p_prev == p_current)
+        {
+            p_descriptor = EncodeVCTDescriptors(p_prev, p_vct->p_first_descriptor, 1020);
+            if (p_descriptor != NULL)
+                dvbpsi_error(p_dvbpsi, "ATSC VCT generator", "unable to carry all the descriptors");
+        }
+
+        /* reserved | additional_descriptors_length */
+        i_additional_length = p_prev->p_payload_end - p_length - 2;
+        p_length[0] = 0xfc | ((i_additional_length >> 8) & 0x03);
+        p_length[1] = i_additional_length;
+
+        p_prev->i_last_number = p_current->i_number;
+        dvbpsi_BuildPSISection(p_dvbpsi, p_prev);
+    }
+
+    return p_result;
+}
@@ -299,6 +299,110 @@ inline void dvbpsi_atsc_DeleteVCT(dvbpsi_atsc_vct_t *p_vct)
 {
     dvbpsi_atsc_vct_delete(p_vct);
 }
+
+/*****************************************************************************
+ * dvbpsi_atsc_vct_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_vct_descriptor_add(dvbpsi_atsc_vct_t *p_vct,
+                                                          uint8_t i_tag, uint8_t i_length,
+                                                          uint8_t *p_data)
+ * \brief Add an additional descriptor to the VCT.
+ * \param p_vct pointer to the VCT structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_vct_descriptor_add(dvbpsi_atsc_vct_t *p_vct,
+                                                   uint8_t i_tag, uint8_t i_length,
+                                                   uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_vct_channel_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_vct_channel_add(dvbpsi_atsc_vct_t* p_vct,
+            uint8_t *p_short_name, uint16_t i_major_number, uint16_t i_minor_number,
+            uint8_t i_modulation, uint32_t i_carrier_freq, uint16_t i_channel_tsid,
+            uint16_t i_program_number, uint8_t i_etm_location, bool b_access_controlled,
+            bool b_hidden, bool b_path_select, bool b_out_of_band, bool b_hide_guide,
+            uint8_t i_service_type, uint16_t i_source_id)
+ * \brief Add a channel at the end of the VCT.
+ * \param p_vct pointer to the VCT structure
+ * \param p_short_name channel name (7*UTF16-BE, 14 bytes)
+ * \param i_major_number channel major number
+ * \param i_minor_number channel minor number
+ * \param i_modulation modulation mode
+ * \param i_carrier_freq carrier center frequency
+ * \param i_channel_tsid channel transport stream id
+ * \param i_program_number channel MPEG program number
+ * \param i_etm_location extended text message location
+ * \param b_access_controlled whether the channel is scrambled
+ * \param b_hidden not accessible directly by the user
+ * \param b_path_select path selection, only used by CVCT
+ * \param b_out_of_band carried on the out-of-band channel, only used by CVCT
+ * \param b_hide_guide whether the channel should not be displayed in the guide
+ * \param i_service_type channel type
+ * \param i_source_id programming source associated with the channel
+ * \return a pointer to the added channel.
+ */
+dvbpsi_atsc_vct_channel_t *dvbpsi_atsc_vct_channel_add(dvbpsi_atsc_vct_t* p_vct,
+                                            uint8_t *p_short_name,
+                                            uint16_t i_major_number,
+                                            uint16_t i_minor_number,
+                                            uint8_t  i_modulation,
+                                            uint32_t i_carrier_freq,
+                                            uint16_t i_channel_tsid,
+                                            uint16_t i_program_number,
+                                            uint8_t  i_etm_location,
+                                            bool     b_access_controlled,
+                                            bool     b_hidden,
+                                            bool     b_path_select,
+                                            bool     b_out_of_band,
+                                            bool     b_hide_guide,
+                                            uint8_t  i_service_type,
+                                            uint16_t i_source_id);
+
+/*****************************************************************************
+ * dvbpsi_atsc_vct_channel_descriptor_add
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_descriptor_t *dvbpsi_atsc_vct_channel_descriptor_add(
+                                               dvbpsi_atsc_vct_channel_t *p_channel,
+                                               uint8_t i_tag, uint8_t i_length,
+                                               uint8_t *p_data)
+ * \brief Add a descriptor in the VCT channel.
+ * \param p_channel pointer to the channel structure
+ * \param i_tag descriptor's tag
+ * \param i_length descriptor's length
+ * \param p_data descriptor's data
+ * \return a pointer to the added descriptor.
+ */
+dvbpsi_descriptor_t *dvbpsi_atsc_vct_channel_descriptor_add(
+                                               dvbpsi_atsc_vct_channel_t *p_channel,
+                                               uint8_t i_tag, uint8_t i_length,
+                                               uint8_t *p_data);
+
+/*****************************************************************************
+ * dvbpsi_atsc_vct_sections_generate
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_psi_section_t *dvbpsi_atsc_vct_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                              dvbpsi_atsc_vct_t *p_vct)
+ * \brief VCT generator
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_vct VCT structure
+ * \return a pointer to the list of generated PSI sections.
+ *
+ * Generate VCT sections based on the dvbpsi_atsc_vct_t structure. A TVCT
+ * (0xC8) or CVCT (0xC9) is generated depending on b_cable_vct. Channels are
+ * spread over as many 1024 bytes sections as needed, the additional
+ * descriptors are carried in the last section.
+ */
+dvbpsi_psi_section_t *dvbpsi_atsc_vct_sections_generate(dvbpsi_t *p_dvbpsi,
+                                                       dvbpsi_atsc_vct_t *p_vct);
+
 #ifdef __cplusplus
 };
 #endif
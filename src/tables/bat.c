@@ -446,11 +446,19 @@ void dvbpsi_bat_sections_gather(dvbpsi_t *p_dvbpsi,
         p_bat_decoder->current_bat = *p_bat_decoder->p_building_bat;
         p_bat_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_bat_sections_decode(p_bat_decoder->p_building_bat,
                                    p_bat_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new BAT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_bat_decoder->pf_bat_callback(p_bat_decoder->p_priv,
                                        p_bat_decoder->p_building_bat);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitBAT(p_bat_decoder, false);
         assert(p_bat_decoder->p_sections == NULL);
@@ -630,7 +638,8 @@ dvbpsi_psi_section_t* dvbpsi_bat_sections_generate(dvbpsi_t *p_dvbpsi, dvbpsi_ba
         /* Can the current section carry all the descriptors ? */
         p_descriptor = p_ts->p_first_descriptor;
         while(    (p_descriptor != NULL)
-               && ((p_ts_start - p_current->p_data) + i_transport_descriptors_length <= 1020))
+               && ((p_ts_start - p_current->p_data) + i_transport_descriptors_length
+                   + p_descriptor->i_length + 2 <= 1020))
         {
             i_transport_descriptors_length += p_descriptor->i_length + 2;
             p_descriptor = p_descriptor->p_next;
@@ -641,7 +650,7 @@ dvbpsi_psi_section_t* dvbpsi_bat_sections_generate(dvbpsi_t *p_dvbpsi, dvbpsi_ba
            then create a new section */
         if(    (p_descriptor != NULL)
             && (p_ts_start - p_current->p_data != 12)
-            && (i_transport_descriptors_length <= 1008))
+            && (i_transport_descriptors_length + p_descriptor->i_length + 2 <= 1008))
         {
             /* transport_stream_loop_length */
             i_transport_stream_loop_length = (p_current->p_payload_end - p_transport_stream_loop_length) - 2;
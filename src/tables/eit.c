@@ -77,8 +77,11 @@ bool dvbpsi_eit_attach(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extens
 
     /* EIT decoder information */
     p_eit_decoder->pf_eit_callback = pf_callback;
+    p_eit_decoder->pf_segment_callback = NULL;
     p_eit_decoder->p_priv = p_priv;
     p_eit_decoder->p_building_eit = NULL;
+    p_eit_decoder->i_segments_known = 0;
+    p_eit_decoder->i_segments_signalled = 0;
 
     p_eit_decoder->i_table_id = i_table_id;
     p_eit_decoder->i_extension = i_extension;
@@ -93,6 +96,32 @@ bool dvbpsi_eit_attach(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extens
     return true;
 }
 
+/*****************************************************************************
+ * dvbpsi_eit_segment_callback_set
+ *****************************************************************************
+ * Set the callback signalling complete EIT segments.
+ *****************************************************************************/
+bool dvbpsi_eit_segment_callback_set(dvbpsi_t *p_dvbpsi, uint8_t i_table_id,
+                                     uint16_t i_extension,
+                                     dvbpsi_eit_segment_callback pf_callback)
+{
+    assert(p_dvbpsi);
+
+    dvbpsi_decoder_t *p_dec = dvbpsi_decoder_chain_get(p_dvbpsi, i_table_id, i_extension);
+    if ((p_dec == NULL) || (p_dec->pf_gather != dvbpsi_eit_sections_gather))
+    {
+        dvbpsi_error(p_dvbpsi, "EIT Decoder",
+                     "No such EIT decoder (table_id == 0x%02x,"
+                     "extension == 0x%02x)",
+                     i_table_id, i_extension);
+        return false;
+    }
+
+    dvbpsi_eit_decoder_t* p_eit_decoder = (dvbpsi_eit_decoder_t*)p_dec;
+    p_eit_decoder->pf_segment_callback = pf_callback;
+    return true;
+}
+
 /*****************************************************************************
  * dvbpsi_eit_detach
  *****************************************************************************
@@ -287,6 +316,8 @@ static void dvbpsi_ReInitEIT(dvbpsi_eit_decoder_t* p_decoder, const bool b_force
             dvbpsi_eit_delete(p_decoder->p_building_eit);
     }
     p_decoder->p_building_eit = NULL;
+    p_decoder->i_segments_known = 0;
+    p_decoder->i_segments_signalled = 0;
 }
 
 static bool dvbpsi_CheckEIT(dvbpsi_t *p_dvbpsi, dvbpsi_eit_decoder_t *p_eit_decoder,
@@ -324,56 +355,125 @@ static bool dvbpsi_CheckEIT(dvbpsi_t *p_dvbpsi, dvbpsi_eit_decoder_t *p_eit_deco
     return b_reinit;
 }
 
-static bool dvbpsi_IsCompleteEIT(dvbpsi_eit_decoder_t* p_eit_decoder, dvbpsi_psi_section_t* p_section)
+/*****************************************************************************
+ * dvbpsi_IsCompleteSegmentEIT
+ *****************************************************************************
+ * ETSI EN 300 468 section 5.2.4 splits EIT sections into segments of 8, the
+ * section_number of the first section of a segment being a multiple of 8.
+ * A segment only holds sections up to its segment_last_section_number, so
+ * there may be gaps in section_number between segments; ETSI TS 101 211
+ * requires each segment to be signalled by at least one (possibly empty)
+ * section.
+ *****************************************************************************/
+static bool dvbpsi_IsCompleteSegmentEIT(dvbpsi_eit_decoder_t* p_eit_decoder,
+                                        const uint8_t i_segment)
+{
+    if (!(p_eit_decoder->i_segments_known & (UINT32_C(1) << i_segment)))
+        return false;
+
+    /* A segment lies within a single word of the received bitmap */
+    const unsigned int i_count = p_eit_decoder->ai_segment_last[i_segment] - (i_segment << 3) + 1;
+    const uint64_t i_mask = ((UINT64_C(1) << i_count) - 1) << ((i_segment << 3) & 63);
+    return ((p_eit_decoder->ai_sections_received[i_segment >> 3] & i_mask) == i_mask);
+}
+
+/*****************************************************************************
+ * dvbpsi_UpdateSegmentEIT
+ *****************************************************************************
+ * Record the segment_last_section_number of p_section. Returns true if its
+ * segment just became complete and was not signalled yet.
+ *****************************************************************************/
+static bool dvbpsi_UpdateSegmentEIT(dvbpsi_eit_decoder_t* p_eit_decoder,
+                                    dvbpsi_psi_section_t* p_section)
+{
+    const uint8_t i_segment = p_section->i_number >> 3;
+    const uint32_t i_segment_bit = UINT32_C(1) << i_segment;
+
+    if (p_section->i_number > p_eit_decoder->i_last_section_number)
+        return false;
+
+    /* Keep segment_last_section_number within the segment and the table */
+    uint8_t i_segment_last = p_section->p_payload_start[4];
+    if (i_segment_last < p_section->i_number)
+        i_segment_last = p_section->i_number;
+    if (i_segment_last > (i_segment << 3) + 7)
+        i_segment_last = (i_segment << 3) + 7;
+    if (i_segment_last > p_eit_decoder->i_last_section_number)
+        i_segment_last = p_eit_decoder->i_last_section_number;
+
+    p_eit_decoder->ai_segment_last[i_segment] = i_segment_last;
+    p_eit_decoder->i_segments_known |= i_segment_bit;
+
+    if ((p_eit_decoder->i_segments_signalled & i_segment_bit) ||
+        !dvbpsi_IsCompleteSegmentEIT(p_eit_decoder, i_segment))
+        return false;
+
+    p_eit_decoder->i_segments_signalled |= i_segment_bit;
+    return true;
+}
+
+/*****************************************************************************
+ * dvbpsi_IsCompleteEIT
+ *****************************************************************************
+ * The table is complete once every segment up to last_section_number is.
+ *****************************************************************************/
+static bool dvbpsi_IsCompleteEIT(dvbpsi_eit_decoder_t* p_eit_decoder)
 {
     assert(p_eit_decoder);
 
-    bool b_complete = false;
-
-    /* As there may be gaps in the section_number fields (see below), we
-     * have to wait until we have received a section_number twice or
-     * until we have a received a section_number which is
-     * first_received_section_number - 1;
-     * if the first_received_section_number is 0, it's enough to wait
-     * until the last_section_number has been received;
-     * this is the only way to be sure that a complete table has been
-     * sent! */
-    if ((p_eit_decoder->i_first_received_section_number > 0 &&
-        (p_section->i_number == p_eit_decoder->i_first_received_section_number ||
-         p_section->i_number == p_eit_decoder->i_first_received_section_number - 1)) ||
-        (p_eit_decoder->i_first_received_section_number == 0 &&
-         p_section->i_number == p_eit_decoder->i_last_section_number))
+    for (uint8_t i_segment = 0;
+         i_segment <= (p_eit_decoder->i_last_section_number >> 3); i_segment++)
     {
-        dvbpsi_psi_section_t *p = p_eit_decoder->p_sections;
-        while (p)
-        {
-            if (p->i_number == p_eit_decoder->i_last_section_number)
-            {
-                b_complete = true;
-                break;
-            }
+        if (!dvbpsi_IsCompleteSegmentEIT(p_eit_decoder, i_segment))
+            return false;
+    }
+    return true;
+}
 
-            /* ETSI EN 300 468 V1.5.1 section 5.2.4 says that the EIT
-             * sections may be structured into a number of segments and
-             * that there may be a gap in the section_number between
-             * two segments (but not within a single segment); thus at
-             * the end of a segment (indicated by
-             * section_number == segment_last_section_number)
-             * we have to search for the beginning of the next segment) */
-            if (p->i_number == p->p_payload_start[4])
-            {
-                while (p->p_next &&
-                      (p->p_next->i_number < p_eit_decoder->i_last_section_number))
-                {
-                    p = p->p_next;
-                }
-            }
+/*****************************************************************************
+ * dvbpsi_SignalSegmentEIT
+ *****************************************************************************
+ * Decode the sections of a complete segment and signal them.
+ *****************************************************************************/
+static void dvbpsi_SignalSegmentEIT(dvbpsi_t *p_dvbpsi, dvbpsi_eit_decoder_t* p_eit_decoder,
+                                    const uint8_t i_segment)
+{
+    const dvbpsi_eit_t *p_building = p_eit_decoder->p_building_eit;
+    const uint8_t i_first = i_segment << 3;
+    const uint8_t i_last = p_eit_decoder->ai_segment_last[i_segment];
+
+    dvbpsi_psi_section_t *p_first = p_eit_decoder->p_sections;
+    while (p_first && (p_first->i_number < i_first))
+        p_first = p_first->p_next;
+    if (!p_first)
+        return;
 
-            p = p->p_next;
-        }
-    }
+    dvbpsi_psi_section_t *p_last = p_first;
+    while (p_last->p_next && (p_last->p_next->i_number <= i_last))
+        p_last = p_last->p_next;
+
+    dvbpsi_eit_t *p_eit = dvbpsi_eit_new(p_building->i_table_id, p_building->i_extension,
+                                         p_building->i_version, p_building->b_current_next,
+                                         p_building->i_ts_id, p_building->i_network_id,
+                                         i_last, p_building->i_last_table_id);
+    if (!p_eit)
+        return;
 
-    return b_complete;
+    /* Decode the segment only */
+    dvbpsi_psi_section_t *p_next = p_last->p_next;
+    p_last->p_next = NULL;
+    dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                       p_first->i_table_id, p_first->i_extension);
+    dvbpsi_eit_sections_decode(p_dvbpsi, p_eit, p_first);
+    dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                     p_first->i_table_id, p_first->i_extension);
+    p_last->p_next = p_next;
+
+    dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                       p_first->i_table_id, p_first->i_extension);
+    p_eit_decoder->pf_segment_callback(p_eit_decoder->p_priv, p_eit, i_segment);
+    dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                     p_first->i_table_id, p_first->i_extension);
 }
 
 static bool dvbpsi_AddSectionEIT(dvbpsi_t *p_dvbpsi, dvbpsi_eit_decoder_t *p_eit_decoder,
@@ -398,9 +498,6 @@ static bool dvbpsi_AddSectionEIT(dvbpsi_t *p_dvbpsi, dvbpsi_eit_decoder_t *p_eit
                                 p_section->p_payload_start[4],
                                 p_section->p_payload_start[5]);
 
-        p_eit_decoder->i_last_section_number = p_section->i_last_number;
-        p_eit_decoder->i_first_received_section_number = p_section->i_number;
-
         if (p_eit_decoder->p_building_eit == NULL)
             return false;
         p_eit_decoder->i_last_section_number = p_section->i_last_number;
@@ -473,8 +570,6 @@ void dvbpsi_eit_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_sect
         }
     }
 
-    bool b_complete = dvbpsi_IsCompleteEIT(p_eit_decoder, p_section);
-
     /* Add section to EIT */
     if (!dvbpsi_AddSectionEIT(p_dvbpsi, p_eit_decoder, p_section))
     {
@@ -484,8 +579,14 @@ void dvbpsi_eit_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_sect
         return;
     }
 
+    /* Signal the segment as soon as it is complete */
+    const uint8_t i_segment = p_section->i_number >> 3;
+    if (dvbpsi_UpdateSegmentEIT(p_eit_decoder, p_section) &&
+        p_eit_decoder->pf_segment_callback)
+        dvbpsi_SignalSegmentEIT(p_dvbpsi, p_eit_decoder, i_segment);
+
     /* Check if we have all the sections */
-    if (b_complete)
+    if (dvbpsi_IsCompleteEIT(p_eit_decoder))
     {
         assert(p_eit_decoder->pf_eit_callback);
 
@@ -494,12 +595,20 @@ void dvbpsi_eit_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_sect
         p_eit_decoder->b_current_valid = true;
 
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_eit_sections_decode(p_dvbpsi,
                                    p_eit_decoder->p_building_eit,
                                    p_eit_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
 
         /* signal the new EIT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_eit_decoder->pf_eit_callback(p_eit_decoder->p_priv, p_eit_decoder->p_building_eit);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
 
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitEIT(p_eit_decoder, false);
@@ -109,6 +109,21 @@ typedef struct dvbpsi_eit_s
  */
 typedef void (* dvbpsi_eit_callback)(void* p_priv, dvbpsi_eit_t* p_new_eit);
 
+/*****************************************************************************
+ * dvbpsi_eit_segment_callback
+ *****************************************************************************/
+/*!
+ * \typedef void (* dvbpsi_eit_segment_callback)(void* p_priv, dvbpsi_eit_t* p_new_eit,
+                                                uint8_t i_segment)
+ * \brief Segment callback type definition.
+ *
+ * p_new_eit only holds the events of segment i_segment, that is sections
+ * 8 * i_segment up to its segment_last_section_number. Delete it with
+ * dvbpsi_eit_delete().
+ */
+typedef void (* dvbpsi_eit_segment_callback)(void* p_priv, dvbpsi_eit_t* p_new_eit,
+                                             uint8_t i_segment);
+
 /*****************************************************************************
  * dvbpsi_AttachEIT
  *****************************************************************************/
@@ -127,6 +142,28 @@ typedef void (* dvbpsi_eit_callback)(void* p_priv, dvbpsi_eit_t* p_new_eit);
 bool dvbpsi_eit_attach(dvbpsi_t *p_dvbpsi, uint8_t i_table_id, uint16_t i_extension,
                        dvbpsi_eit_callback pf_callback, void* p_priv);
 
+/*****************************************************************************
+ * dvbpsi_eit_segment_callback_set
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_eit_segment_callback_set(dvbpsi_t *p_dvbpsi, uint8_t i_table_id,
+          uint16_t i_extension, dvbpsi_eit_segment_callback pf_callback)
+ * \brief Signal each EIT segment as soon as it is complete.
+ * \param p_dvbpsi dvbpsi handle pointing to Subtable demultiplexor to which the
+                   eit decoder is attached.
+ * \param i_table_id Table ID, 0x4E, 0x4F, or 0x50-0x6F.
+ * \param i_extension Table ID extension, here service ID.
+ * \param pf_callback function to call back on each complete segment, NULL to
+ *        disable. It is given the p_priv of dvbpsi_eit_attach().
+ * \return true on success, false if there is no such EIT decoder.
+ *
+ * Each segment of a table version is signalled once, before the complete
+ * table is signalled to the dvbpsi_eit_attach() callback.
+ */
+bool dvbpsi_eit_segment_callback_set(dvbpsi_t *p_dvbpsi, uint8_t i_table_id,
+                                     uint16_t i_extension,
+                                     dvbpsi_eit_segment_callback pf_callback);
+
 /*****************************************************************************
  * dvbpsi_eit_detach
  *****************************************************************************/
@@ -38,11 +38,15 @@ typedef struct dvbpsi_eit_decoder_s
     DVBPSI_DECODER_COMMON
 
     dvbpsi_eit_callback           pf_eit_callback;
+    dvbpsi_eit_segment_callback   pf_segment_callback;
 
     dvbpsi_eit_t                  current_eit;
     dvbpsi_eit_t *                p_building_eit;
 
-    uint8_t                       i_first_received_section_number;
+    /* Segments of 8 sections, see ETSI TS 101 211 */
+    uint8_t                       ai_segment_last[32];  /* segment_last_section_number */
+    uint32_t                      i_segments_known;     /* segments with a section */
+    uint32_t                      i_segments_signalled; /* segments signalled complete */
 
 } dvbpsi_eit_decoder_t;
 
@@ -439,11 +439,19 @@ void dvbpsi_nit_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_sect
         p_nit_decoder->b_current_valid = true;
 
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_nit_sections_decode(p_nit_decoder->p_building_nit,
                                    p_nit_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new NIT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_nit_decoder->pf_nit_callback(p_nit_decoder->p_priv,
                                        p_nit_decoder->p_building_nit);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitNIT(p_nit_decoder, false);
         assert(p_nit_decoder->p_sections == NULL);
@@ -611,7 +619,8 @@ dvbpsi_psi_section_t* dvbpsi_nit_sections_generate(dvbpsi_t *p_dvbpsi,
         /* Can the current section carry all the descriptors ? */
         p_descriptor = p_ts->p_first_descriptor;
         while(    (p_descriptor != NULL)
-               && ((p_ts_start - p_current->p_data) + i_ts_length <= 1020))
+               && ((p_ts_start - p_current->p_data) + i_ts_length
+                   + p_descriptor->i_length + 2 <= 1020))
         {
             i_ts_length += p_descriptor->i_length + 2;
             p_descriptor = p_descriptor->p_next;
@@ -622,7 +631,7 @@ dvbpsi_psi_section_t* dvbpsi_nit_sections_generate(dvbpsi_t *p_dvbpsi,
            then create a new section */
         if(    (p_descriptor != NULL)
             && (p_ts_start - p_current->p_data != 12)
-            && (i_ts_length <= 1008))
+            && (i_ts_length + p_descriptor->i_length + 2 <= 1008))
         {
             /* transport_stream_loop_length */
             i_transport_stream_loop_length = (p_current->p_payload_end - p_transport_stream_loop_length) - 2;
@@ -372,14 +372,24 @@ void dvbpsi_pat_sections_gather(dvbpsi_t* p_dvbpsi, dvbpsi_psi_section_t* p_sect
         p_pat_decoder->current_pat = *p_pat_decoder->p_building_pat;
 
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         if (dvbpsi_pat_sections_decode(p_pat_decoder->p_building_pat,
                                        p_pat_decoder->p_sections))
             p_pat_decoder->b_current_valid = true;
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
 
         /* signal the new PAT */
         if (p_pat_decoder->b_current_valid)
+        {
+            dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                               p_section->i_table_id, p_section->i_extension);
             p_pat_decoder->pf_pat_callback(p_pat_decoder->p_priv,
                                            p_pat_decoder->p_building_pat);
+            dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                             p_section->i_table_id, p_section->i_extension);
+        }
 
         /* Delete sectioins and Reinitialize the structures */
         dvbpsi_ReInitPAT(p_pat_decoder, !p_pat_decoder->b_current_valid);
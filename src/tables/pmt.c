@@ -428,11 +428,19 @@ void dvbpsi_pmt_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t* p_sect
         p_pmt_decoder->current_pmt = *p_pmt_decoder->p_building_pmt;
         p_pmt_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_pmt_sections_decode(p_pmt_decoder->p_building_pmt,
                                    p_pmt_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new PMT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_pmt_decoder->pf_pmt_callback(p_pmt_decoder->p_priv,
                                        p_pmt_decoder->p_building_pmt);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitPMT(p_pmt_decoder, false);
         assert(p_pmt_decoder->p_sections == NULL);
@@ -451,10 +459,18 @@ void dvbpsi_pmt_sections_decode(dvbpsi_pmt_t* p_pmt,
 
     while (p_section)
     {
+        if (p_section->p_payload_end - p_section->p_payload_start < 4)
+        {
+            p_section = p_section->p_next;
+            continue;
+        }
+
         /* - PMT descriptors */
         p_byte = p_section->p_payload_start + 4;
         p_end = p_byte + (   ((uint16_t)(p_section->p_payload_start[2] & 0x0f) << 8)
                            | p_section->p_payload_start[3]);
+        if (p_end > p_section->p_payload_end)
+            p_end = p_section->p_payload_end;
         while (p_byte + 2 <= p_end)
         {
             uint8_t i_tag = p_byte[0];
@@ -581,7 +597,8 @@ dvbpsi_psi_section_t* dvbpsi_pmt_sections_generate(dvbpsi_t *p_dvbpsi, dvbpsi_pm
         /* Can the current section carry all the descriptors ? */
         p_descriptor = p_es->p_first_descriptor;
         while(    (p_descriptor != NULL)
-               && ((p_es_start - p_current->p_data) + i_es_length <= 1020))
+               && ((p_es_start - p_current->p_data) + i_es_length
+                   + p_descriptor->i_length + 2 <= 1020))
         {
             i_es_length += p_descriptor->i_length + 2;
             p_descriptor = p_descriptor->p_next;
@@ -592,7 +609,7 @@ dvbpsi_psi_section_t* dvbpsi_pmt_sections_generate(dvbpsi_t *p_dvbpsi, dvbpsi_pm
            then create a new section */
         if(    (p_descriptor != NULL)
             && (p_es_start - p_current->p_data != 12)
-            && (i_es_length <= 1008))
+            && (i_es_length + p_descriptor->i_length + 2 <= 1008))
         {
             /* will put more descriptors in an empty section */
             dvbpsi_debug(p_dvbpsi, "PMT generator",
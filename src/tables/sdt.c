@@ -415,11 +415,19 @@ void dvbpsi_sdt_sections_gather(dvbpsi_t *p_dvbpsi, dvbpsi_psi_section_t *p_sect
         p_sdt_decoder->current_sdt = *p_sdt_decoder->p_building_sdt;
         p_sdt_decoder->b_current_valid = true;
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_sdt_sections_decode(p_sdt_decoder->p_building_sdt,
                                    p_sdt_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new SDT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_sdt_decoder->pf_sdt_callback(p_sdt_decoder->p_priv,
                                        p_sdt_decoder->p_building_sdt);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitSDT(p_sdt_decoder, false);
         assert(p_sdt_decoder->p_sections == NULL);
@@ -506,13 +514,15 @@ dvbpsi_psi_section_t *dvbpsi_sdt_sections_generate(dvbpsi_t *p_dvbpsi, dvbpsi_sd
 
         dvbpsi_descriptor_t * p_descriptor = p_service->p_first_descriptor;
 
-        while ((p_descriptor != NULL)&& ((p_service_start - p_current->p_data) + i_service_length <= 1020))
+        while ((p_descriptor != NULL)&& ((p_service_start - p_current->p_data) + i_service_length
+                                         + p_descriptor->i_length + 2 <= 1020))
         {
             i_service_length += p_descriptor->i_length + 2;
             p_descriptor = p_descriptor->p_next;
         }
 
-        if ((p_descriptor != NULL) && (p_service_start - p_current->p_data != 11) && (i_service_length <= 1009))
+        if ((p_descriptor != NULL) && (p_service_start - p_current->p_data != 11)
+            && (i_service_length + p_descriptor->i_length + 2 <= 1009))
         {
             /* will put more descriptors in an empty section */
             dvbpsi_debug(p_dvbpsi, "SDT generator","create a new section to carry more Service descriptors");
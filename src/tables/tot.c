@@ -380,11 +380,19 @@ void dvbpsi_tot_sections_gather(dvbpsi_t* p_dvbpsi,
         p_tot_decoder->b_current_valid = true;
 
         /* Decode the sections */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                           p_section->i_table_id, p_section->i_extension);
         dvbpsi_tot_sections_decode(p_dvbpsi, p_tot_decoder->p_building_tot,
                                    p_tot_decoder->p_sections);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_DECODE,
+                         p_section->i_table_id, p_section->i_extension);
         /* signal the new TOT */
+        dvbpsi_trace_begin(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                           p_section->i_table_id, p_section->i_extension);
         p_tot_decoder->pf_tot_callback(p_tot_decoder->p_priv,
                                        p_tot_decoder->p_building_tot);
+        dvbpsi_trace_end(p_dvbpsi, DVBPSI_TRACE_CALLBACK,
+                         p_section->i_table_id, p_section->i_extension);
         /* Delete sections and Reinitialize the structures */
         dvbpsi_ReInitTOT(p_tot_decoder, false);
         assert(p_tot_decoder->p_sections == NULL);
@@ -0,0 +1,791 @@
+/*****************************************************************************
+ * text.c: DVB strings and ATSC multiple string structures to UTF-8
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ * Most broadcast text is printable ASCII, which every supported single byte
+ * table and UTF-8 leave unchanged: such runs are found 16 bytes at a time
+ * and copied as is, the other characters go through the tables.
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "dvbpsi.h"
+#include "descriptor.h"
+#include "text.h"
+#include "text_tables.h"
+
+#define TEXT_REPLACEMENT    0xfffd
+#define TEXT_ATSC_ESCAPE    27
+#define TEXT_BUCKETS        256
+
+/* Huffman codes may be a single bit per character of up to 2 UTF-8 bytes */
+#define TEXT_ATSC_SIZE(n)   (16 * (n) + 1)
+
+typedef struct text_out_s
+{
+    char           *p_utf8;
+    size_t          i_room;         /* NUL excluded */
+    size_t          i_length;
+    bool            b_full;
+} text_out_t;
+
+typedef struct text_string_s
+{
+    struct text_string_s *p_next;
+    uint32_t        i_hash;
+    size_t          i_key;          /* kind, language and raw string */
+    uint8_t         p_key[];        /* followed by the UTF-8 string */
+} text_string_t;
+
+struct dvbpsi_text_s
+{
+    uint8_t        *ap_huffman[2];  /* by compression_type - 1 */
+    size_t          ai_huffman[2];
+
+    text_string_t **pp_buckets;
+    size_t          i_buckets;      /* power of 2 */
+    size_t          i_strings;
+    size_t          i_bytes;
+    uint64_t        i_lookups;
+    uint64_t        i_hits;
+};
+
+/*****************************************************************************
+ * text_ascii_run
+ *****************************************************************************
+ * Number of leading bytes of p in 0x20 to 0x7f.
+ *****************************************************************************/
+static inline size_t text_ascii_run(const uint8_t *p, const size_t i_length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= i_length; i += 16)
+    {
+        /* Signed compare: 0x80 to 0xff are negative */
+        const __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        const unsigned int i_other = ~_mm_movemask_epi8(_mm_cmpgt_epi8(v, ctrl)) & 0xffff;
+        if (i_other)
+            return i + __builtin_ctz(i_other);
+    }
+#elif defined(__ARM_NEON)
+    const int8x16_t ctrl = vdupq_n_s8(0x1f);
+    for (; i + 16 <= i_length; i += 16)
+    {
+        const uint8x16_t ok = vcgtq_s8(vreinterpretq_s8_u8(vld1q_u8(p + i)), ctrl);
+        /* Narrow each byte to a nibble, NEON has no movemask */
+        const uint64_t i_other = ~vget_lane_u64(vreinterpret_u64_u8(
+                                     vshrn_n_u16(vreinterpretq_u16_u8(ok), 4)), 0);
+        if (i_other)
+            return i + __builtin_ctzll(i_other) / 4;
+    }
+#endif
+    while ((i < i_length) && (p[i] >= 0x20) && (p[i] < 0x80))
+        i++;
+    return i;
+}
+
+static void text_out_init(text_out_t *p_out, char *psz_utf8, const size_t i_size)
+{
+    p_out->p_utf8 = psz_utf8;
+    p_out->i_room = (i_size > 0) ? i_size - 1 : 0;
+    p_out->i_length = 0;
+    p_out->b_full = (i_size == 0);
+}
+
+static void text_put_ascii(text_out_t *p_out, const uint8_t *p, size_t i_length)
+{
+    if (p_out->i_length + i_length > p_out->i_room)
+    {
+        i_length = p_out->i_room - p_out->i_length;
+        p_out->b_full = true;
+    }
+    if (i_length == 0)
+        return;
+    memcpy(p_out->p_utf8 + p_out->i_length, p, i_length);
+    p_out->i_length += i_length;
+}
+
+static void text_put(text_out_t *p_out, const uint32_t i_char)
+{
+    uint8_t p_char[4];
+    size_t i_bytes;
+
+    if (i_char < 0x80)
+    {
+        p_char[0] = i_char;
+        i_bytes = 1;
+    }
+    else if (i_char < 0x800)
+    {
+        p_char[0] = 0xc0 | (i_char >> 6);
+        p_char[1] = 0x80 | (i_char & 0x3f);
+        i_bytes = 2;
+    }
+    else if (i_char < 0x10000)
+    {
+        p_char[0] = 0xe0 | (i_char >> 12);
+        p_char[1] = 0x80 | ((i_char >> 6) & 0x3f);
+        p_char[2] = 0x80 | (i_char & 0x3f);
+        i_bytes = 3;
+    }
+    else
+    {
+        p_char[0] = 0xf0 | (i_char >> 18);
+        p_char[1] = 0x80 | ((i_char >> 12) & 0x3f);
+        p_char[2] = 0x80 | ((i_char >> 6) & 0x3f);
+        p_char[3] = 0x80 | (i_char & 0x3f);
+        i_bytes = 4;
+    }
+
+    if (p_out->b_full || (p_out->i_length + i_bytes > p_out->i_room))
+    {
+        p_out->b_full = true;
+        return;
+    }
+    memcpy(p_out->p_utf8 + p_out->i_length, p_char, i_bytes);
+    p_out->i_length += i_bytes;
+}
+
+/* ISO/IEC 6937 diacritical mark i_mark at p[i - 1], applied to p[i] */
+static size_t text_iso6937_mark(text_out_t *p_out, const uint8_t *p, const size_t i_length,
+                                size_t i, const uint8_t i_mark)
+{
+    const uint16_t i_combining = ai_text_iso6937_marks[i_mark - 0xc1];
+    if (i >= i_length)
+        return i;
+
+    const uint8_t i_base = p[i];
+    int i_letter = -1;
+    if ((i_base >= 'A') && (i_base <= 'Z'))
+        i_letter = i_base - 'A';
+    else if ((i_base >= 'a') && (i_base <= 'z'))
+        i_letter = i_base - 'a' + 26;
+
+    if ((i_letter >= 0) && ai_text_iso6937_composed[i_mark - 0xc1][i_letter])
+    {
+        text_put(p_out, ai_text_iso6937_composed[i_mark - 0xc1][i_letter]);
+        return i + 1;
+    }
+    /* Not precomposed: base character followed by the combining one */
+    if ((i_base >= 0x20) && (i_base < 0x80))
+    {
+        text_put(p_out, i_base);
+        i++;
+    }
+    if (i_combining)
+        text_put(p_out, i_combining);
+    return i;
+}
+
+/* Single byte table: p_table holds 0xa0 to 0xff, 0x80 to 0x9f are the DVB
+ * control codes when b_dvb, else ISO/IEC 6429 C1 controls kept as such */
+static void text_8bit(text_out_t *p_out, const uint8_t *p, const size_t i_length,
+                      const uint16_t *p_table, const bool b_iso6937, const bool b_dvb)
+{
+    size_t i = 0;
+    while ((i < i_length) && !p_out->b_full)
+    {
+        const size_t i_run = text_ascii_run(p + i, i_length - i);
+        if (i_run > 0)
+        {
+            text_put_ascii(p_out, p + i, i_run);
+            i += i_run;
+            continue;
+        }
+
+        const uint8_t i_byte = p[i++];
+        if (i_byte < 0x20)
+        {
+            if (i_byte != 0)
+                text_put(p_out, i_byte);
+        }
+        else if (i_byte < 0xa0)
+        {
+            /* Emphasis on/off and the others are dropped */
+            if (!b_dvb)
+                text_put(p_out, i_byte);
+            else if (i_byte == 0x8a)
+                text_put(p_out, '\n');
+        }
+        else if (b_iso6937 && (i_byte >= 0xc1) && (i_byte <= 0xcf))
+            i = text_iso6937_mark(p_out, p, i_length, i, i_byte);
+        else
+            text_put(p_out, p_table[i_byte - 0xa0] ? p_table[i_byte - 0xa0] : TEXT_REPLACEMENT);
+    }
+}
+
+/* Big endian UTF-16, with the DVB control codes in the private use area */
+static void text_utf16(text_out_t *p_out, const uint8_t *p, const size_t i_length,
+                       const bool b_dvb)
+{
+    for (size_t i = 0; (i + 1 < i_length) && !p_out->b_full; i += 2)
+    {
+        uint32_t i_char = (p[i] << 8) | p[i + 1];
+
+        if ((i_char >= 0xd800) && (i_char < 0xdc00) && (i + 3 < i_length))
+        {
+            const uint32_t i_low = (p[i + 2] << 8) | p[i + 3];
+            if ((i_low >= 0xdc00) && (i_low < 0xe000))
+            {
+                i_char = 0x10000 + ((i_char - 0xd800) << 10) + (i_low - 0xdc00);
+                i += 2;
+            }
+        }
+
+        if ((i_char >= 0xd800) && (i_char < 0xe000))
+            i_char = TEXT_REPLACEMENT;
+        else if (b_dvb && ((i_char == 0xe086) || (i_char == 0xe087)))
+            continue;
+        else if (b_dvb && (i_char == 0xe08a))
+            i_char = '\n';
+        else if (i_char == 0)
+            continue;
+        text_put(p_out, i_char);
+    }
+}
+
+static void text_utf8(text_out_t *p_out, const uint8_t *p, const size_t i_length)
+{
+    size_t i = 0;
+    while ((i < i_length) && !p_out->b_full)
+    {
+        const size_t i_run = text_ascii_run(p + i, i_length - i);
+        if (i_run > 0)
+        {
+            text_put_ascii(p_out, p + i, i_run);
+            i += i_run;
+            continue;
+        }
+
+        const uint8_t i_lead = p[i++];
+        if (i_lead < 0x80)
+        {
+            if (i_lead != 0)
+                text_put(p_out, i_lead);
+            continue;
+        }
+
+        size_t i_bytes;
+        uint32_t i_char, i_min;
+        if ((i_lead >= 0xc2) && (i_lead <= 0xdf))
+            i_bytes = 1, i_char = i_lead & 0x1f, i_min = 0x80;
+        else if ((i_lead >= 0xe0) && (i_lead <= 0xef))
+            i_bytes = 2, i_char = i_lead & 0x0f, i_min = 0x800;
+        else if ((i_lead >= 0xf0) && (i_lead <= 0xf4))
+            i_bytes = 3, i_char = i_lead & 0x07, i_min = 0x10000;
+        else
+        {
+            text_put(p_out, TEXT_REPLACEMENT);
+            continue;
+        }
+
+        size_t k = 0;
+        while ((k < i_bytes) && (i + k < i_length) && ((p[i + k] & 0xc0) == 0x80))
+            i_char = (i_char << 6) | (p[i + k++] & 0x3f);
+        if ((k < i_bytes) || (i_char < i_min) || (i_char > 0x10ffff)
+            || ((i_char >= 0xd800) && (i_char < 0xe000)))
+        {
+            text_put(p_out, TEXT_REPLACEMENT);
+            i += k;
+            continue;
+        }
+        i += k;
+
+        if ((i_char == 0xe086) || (i_char == 0xe087))
+            continue;
+        text_put(p_out, (i_char == 0xe08a) ? '\n' : i_char);
+    }
+}
+
+/* ETSI EN 300 468 annex A.2 */
+static bool text_dvb(text_out_t *p_out, const uint8_t *p, const size_t i_length)
+{
+    if (i_length == 0)
+        return true;
+
+    const uint8_t i_table = p[0];
+    unsigned int i_part;
+    size_t i_skip = 1;
+
+    if (i_table >= 0x20)
+    {
+        text_8bit(p_out, p, i_length, ai_text_iso6937, true, true);
+        return true;
+    }
+    else if ((i_table >= 0x01) && (i_table <= 0x0b))
+        i_part = i_table + 4;
+    else if (i_table == 0x10)
+    {
+        if ((i_length < 3) || (p[1] != 0x00))
+            return false;
+        i_part = p[2];
+        i_skip = 3;
+    }
+    else if (i_table == 0x11)
+    {
+        text_utf16(p_out, p + 1, i_length - 1, true);
+        return true;
+    }
+    else if (i_table == 0x15)
+    {
+        text_utf8(p_out, p + 1, i_length - 1);
+        return true;
+    }
+    else
+        return false;
+
+    if ((i_part < 1) || (i_part > 16) || (i_part == 12))
+        return false;
+    text_8bit(p_out, p + i_skip, i_length - i_skip, ai_text_iso8859[i_part - 1], false, true);
+    return true;
+}
+
+/*****************************************************************************
+ * text_huffman
+ *****************************************************************************
+ * ATSC A/65 annex C: each character is decoded with the tree of the
+ * previous one, the first one with the tree of the terminator. A tree is an
+ * array of node pairs, branch 0 then 1, leaves having their top bit set.
+ *****************************************************************************/
+static bool text_huffman(text_out_t *p_out, const uint8_t *p_table, const size_t i_table,
+                         const uint8_t *p, const size_t i_length)
+{
+    const size_t i_bits = i_length * 8;
+    size_t i_bit = 0;
+    uint8_t i_prior = 0;
+
+    while ((i_bit < i_bits) && !p_out->b_full)
+    {
+        const size_t i_tree = (p_table[2 * i_prior] << 8) | p_table[2 * i_prior + 1];
+        uint8_t i_node = 0;
+        int i_symbol = -1;
+
+        while (i_bit < i_bits)
+        {
+            const unsigned int i_branch = (p[i_bit >> 3] >> (7 - (i_bit & 7))) & 1;
+            i_bit++;
+
+            const size_t i_entry = i_tree + 2 * i_node + i_branch;
+            if (i_entry >= i_table)
+                return false;
+            if (p_table[i_entry] & 0x80)
+            {
+                i_symbol = p_table[i_entry] & 0x7f;
+                break;
+            }
+            i_node = p_table[i_entry];
+        }
+
+        /* Padding bits or terminator */
+        if (i_symbol <= 0)
+            break;
+
+        if (i_symbol == TEXT_ATSC_ESCAPE)
+        {
+            /* Uncompressed 8 bit character */
+            if (i_bit + 8 > i_bits)
+                break;
+            uint8_t i_char = 0;
+            for (unsigned int k = 0; k < 8; k++, i_bit++)
+                i_char = (i_char << 1) | ((p[i_bit >> 3] >> (7 - (i_bit & 7))) & 1);
+            if (i_char != 0)
+                text_put(p_out, i_char);
+            i_prior = i_char & 0x7f;
+            continue;
+        }
+
+        text_put(p_out, i_symbol);
+        i_prior = i_symbol;
+    }
+    return true;
+}
+
+/* ATSC A/65 table 6.41 */
+static bool text_atsc_mode_valid(const uint8_t i_mode)
+{
+    return (i_mode <= 0x06) || ((i_mode >= 0x09) && (i_mode <= 0x10))
+           || ((i_mode >= 0x20) && (i_mode <= 0x27)) || ((i_mode >= 0x30) && (i_mode <= 0x33));
+}
+
+static bool text_atsc_segment(const dvbpsi_text_t *p_text, text_out_t *p_out,
+                              const uint8_t i_compression, const uint8_t i_mode,
+                              const uint8_t *p, const size_t i_length)
+{
+    if (i_compression == 0x00)
+    {
+        if (i_mode == 0x3f)
+            text_utf16(p_out, p, i_length, false);
+        else if (i_mode == 0x00)
+            text_8bit(p_out, p, i_length, ai_text_iso8859[0], false, false);
+        else if (text_atsc_mode_valid(i_mode))
+        {
+            for (size_t i = 0; (i < i_length) && !p_out->b_full; i++)
+                text_put(p_out, (i_mode << 8) | p[i]);
+        }
+        else
+            return false;
+        return true;
+    }
+
+    /* Huffman coding only applies to the ISO/IEC 8859-1 mode */
+    if (((i_compression == 0x01) || (i_compression == 0x02)) && (i_mode == 0x00)
+        && p_text && p_text->ap_huffman[i_compression - 1])
+        return text_huffman(p_out, p_text->ap_huffman[i_compression - 1],
+                            p_text->ai_huffman[i_compression - 1], p, i_length);
+    return false;
+}
+
+/* Decode the string at i_pos when p_out is set, return the position after it */
+static size_t text_atsc_string(const dvbpsi_text_t *p_text, text_out_t *p_out,
+                               const uint8_t *p, const size_t i_length, size_t i_pos,
+                               bool *pb_supported)
+{
+    const unsigned int i_segments = p[i_pos + 3];
+    i_pos += 4;
+
+    for (unsigned int i = 0; (i < i_segments) && (i_pos + 3 <= i_length); i++)
+    {
+        const uint8_t i_compression = p[i_pos];
+        const uint8_t i_mode = p[i_pos + 1];
+        size_t i_bytes = p[i_pos + 2];
+        i_pos += 3;
+        if (i_pos + i_bytes > i_length)
+            i_bytes = i_length - i_pos;
+
+        if (p_out && !text_atsc_segment(p_text, p_out, i_compression, i_mode,
+                                        p + i_pos, i_bytes))
+            *pb_supported = false;
+        i_pos += i_bytes;
+    }
+    return i_pos;
+}
+
+/* ATSC A/65 section 6.10 */
+static bool text_atsc(const dvbpsi_text_t *p_text, text_out_t *p_out,
+                      const uint8_t *p, const size_t i_length, const uint8_t *p_language)
+{
+    if (i_length < 1)
+        return true;
+
+    const unsigned int i_strings = p[0];
+    size_t i_pos = 1, i_string = 0;
+    for (unsigned int i = 0; (i < i_strings) && (i_pos + 4 <= i_length); i++)
+    {
+        if (i == 0)
+            i_string = i_pos;
+        if (p_language && (memcmp(p + i_pos, p_language, 3) == 0))
+        {
+            i_string = i_pos;
+            break;
+        }
+        i_pos = text_atsc_string(p_text, NULL, p, i_length, i_pos, NULL);
+    }
+    if (i_string == 0)
+        return true;
+
+    bool b_supported = true;
+    text_atsc_string(p_text, p_out, p, i_length, i_string, &b_supported);
+    return b_supported;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_dvb_to_utf8
+ *****************************************************************************/
+ssize_t dvbpsi_text_dvb_to_utf8(const uint8_t *p_text, size_t i_length,
+                                char *psz_utf8, size_t i_size)
+{
+    assert(p_text || i_length == 0);
+    assert(psz_utf8 || i_size == 0);
+
+    text_out_t out;
+    text_out_init(&out, psz_utf8, i_size);
+    const bool b_supported = text_dvb(&out, p_text, i_length);
+    if (i_size > 0)
+        psz_utf8[out.i_length] = '\0';
+    return b_supported ? (ssize_t)out.i_length : -1;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_to_utf8
+ *****************************************************************************/
+ssize_t dvbpsi_text_atsc_to_utf8(const dvbpsi_text_t *p_text,
+                                 const uint8_t *p_mss, size_t i_length,
+                                 const uint8_t *p_language,
+                                 char *psz_utf8, size_t i_size)
+{
+    assert(p_mss || i_length == 0);
+    assert(psz_utf8 || i_size == 0);
+
+    text_out_t out;
+    text_out_init(&out, psz_utf8, i_size);
+    const bool b_supported = text_atsc(p_text, &out, p_mss, i_length, p_language);
+    if (i_size > 0)
+        psz_utf8[out.i_length] = '\0';
+    return b_supported ? (ssize_t)out.i_length : -1;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_new
+ *****************************************************************************/
+dvbpsi_text_t *dvbpsi_text_new(void)
+{
+    dvbpsi_text_t *p_text = calloc(1, sizeof(dvbpsi_text_t));
+    if (p_text == NULL)
+        return NULL;
+    p_text->pp_buckets = calloc(TEXT_BUCKETS, sizeof(text_string_t *));
+    if (p_text->pp_buckets == NULL)
+    {
+        free(p_text);
+        return NULL;
+    }
+    p_text->i_buckets = TEXT_BUCKETS;
+    return p_text;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_delete
+ *****************************************************************************/
+void dvbpsi_text_delete(dvbpsi_text_t *p_text)
+{
+    if (p_text == NULL)
+        return;
+
+    dvbpsi_text_flush(p_text);
+    free(p_text->pp_buckets);
+    free(p_text->ap_huffman[0]);
+    free(p_text->ap_huffman[1]);
+    free(p_text);
+}
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_huffman_set
+ *****************************************************************************/
+bool dvbpsi_text_atsc_huffman_set(dvbpsi_text_t *p_text, uint8_t i_compression_type,
+                                  const uint8_t *p_table, size_t i_size)
+{
+    assert(p_text);
+    assert(p_table);
+
+    if ((i_compression_type != 0x01) && (i_compression_type != 0x02))
+        return false;
+    if (i_size < 256)
+        return false;
+    for (unsigned int i = 0; i < 128; i++)
+    {
+        const size_t i_tree = (p_table[2 * i] << 8) | p_table[2 * i + 1];
+        if ((i_tree < 256) || (i_tree + 2 > i_size))
+            return false;
+    }
+
+    uint8_t *p_copy = malloc(i_size);
+    if (p_copy == NULL)
+        return false;
+    memcpy(p_copy, p_table, i_size);
+
+    free(p_text->ap_huffman[i_compression_type - 1]);
+    p_text->ap_huffman[i_compression_type - 1] = p_copy;
+    p_text->ai_huffman[i_compression_type - 1] = i_size;
+    return true;
+}
+
+/* FNV-1a */
+static uint32_t text_hash(uint32_t i_hash, const uint8_t *p, const size_t i_length)
+{
+    for (size_t i = 0; i < i_length; i++)
+        i_hash = (i_hash ^ p[i]) * UINT32_C(16777619);
+    return i_hash;
+}
+
+static bool text_grow(dvbpsi_text_t *p_text)
+{
+    const size_t i_buckets = 2 * p_text->i_buckets;
+    text_string_t **pp_buckets = calloc(i_buckets, sizeof(text_string_t *));
+    if (pp_buckets == NULL)
+        return false;
+
+    for (size_t i = 0; i < p_text->i_buckets; i++)
+    {
+        text_string_t *p_string = p_text->pp_buckets[i];
+        while (p_string)
+        {
+            text_string_t *p_next = p_string->p_next;
+            text_string_t **pp_bucket = &pp_buckets[p_string->i_hash & (i_buckets - 1)];
+            p_string->p_next = *pp_bucket;
+            *pp_bucket = p_string;
+            p_string = p_next;
+        }
+    }
+    free(p_text->pp_buckets);
+    p_text->pp_buckets = pp_buckets;
+    p_text->i_buckets = i_buckets;
+    return true;
+}
+
+/* The key is the kind of string, its language and the raw string */
+static const char *text_intern(dvbpsi_text_t *p_text, const uint8_t i_kind,
+                               const uint8_t *p_language,
+                               const uint8_t *p_raw, const size_t i_length)
+{
+    uint8_t p_prefix[4] = { i_kind, 0, 0, 0 };
+    if (p_language)
+        memcpy(p_prefix + 1, p_language, 3);
+    const uint32_t i_hash = text_hash(text_hash(UINT32_C(2166136261), p_prefix, 4),
+                                      p_raw, i_length);
+    const size_t i_key = 4 + i_length;
+
+    p_text->i_lookups++;
+    for (text_string_t *p_string = p_text->pp_buckets[i_hash & (p_text->i_buckets - 1)];
+         p_string; p_string = p_string->p_next)
+    {
+        if ((p_string->i_hash == i_hash) && (p_string->i_key == i_key)
+            && (memcmp(p_string->p_key, p_prefix, 4) == 0)
+            && (memcmp(p_string->p_key + 4, p_raw, i_length) == 0))
+        {
+            p_text->i_hits++;
+            return (const char *)p_string->p_key + i_key;
+        }
+    }
+
+    const size_t i_size = (i_kind == 0) ? DVBPSI_TEXT_DVB_SIZE(i_length)
+                                        : TEXT_ATSC_SIZE(i_length);
+    text_string_t *p_string = malloc(sizeof(text_string_t) + i_key + i_size);
+    if (p_string == NULL)
+        return NULL;
+
+    text_out_t out;
+    text_out_init(&out, (char *)p_string->p_key + i_key, i_size);
+    const bool b_supported = (i_kind == 0) ? text_dvb(&out, p_raw, i_length)
+                                           : text_atsc(p_text, &out, p_raw, i_length, p_language);
+    if (!b_supported)
+    {
+        free(p_string);
+        return NULL;
+    }
+    out.p_utf8[out.i_length] = '\0';
+
+    /* Give back the room left */
+    const size_t i_bytes = sizeof(text_string_t) + i_key + out.i_length + 1;
+    text_string_t *p_shrunk = realloc(p_string, i_bytes);
+    if (p_shrunk)
+        p_string = p_shrunk;
+
+    if ((p_text->i_strings >= p_text->i_buckets) && !text_grow(p_text))
+    {
+        free(p_string);
+        return NULL;
+    }
+
+    p_string->i_hash = i_hash;
+    p_string->i_key = i_key;
+    memcpy(p_string->p_key, p_prefix, 4);
+    memcpy(p_string->p_key + 4, p_raw, i_length);
+
+    text_string_t **pp_bucket = &p_text->pp_buckets[i_hash & (p_text->i_buckets - 1)];
+    p_string->p_next = *pp_bucket;
+    *pp_bucket = p_string;
+    p_text->i_strings++;
+    p_text->i_bytes += i_bytes;
+    return (const char *)p_string->p_key + i_key;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_dvb_intern
+ *****************************************************************************/
+const char *dvbpsi_text_dvb_intern(dvbpsi_text_t *p_text,
+                                   const uint8_t *p_string, size_t i_length)
+{
+    assert(p_text);
+    assert(p_string || i_length == 0);
+
+    return text_intern(p_text, 0, NULL, p_string, i_length);
+}
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_intern
+ *****************************************************************************/
+const char *dvbpsi_text_atsc_intern(dvbpsi_text_t *p_text,
+                                    const uint8_t *p_mss, size_t i_length,
+                                    const uint8_t *p_language)
+{
+    assert(p_text);
+    assert(p_mss || i_length == 0);
+
+    return text_intern(p_text, 1, p_language, p_mss, i_length);
+}
+
+/*****************************************************************************
+ * dvbpsi_text_flush
+ *****************************************************************************/
+void dvbpsi_text_flush(dvbpsi_text_t *p_text)
+{
+    assert(p_text);
+
+    for (size_t i = 0; i < p_text->i_buckets; i++)
+    {
+        text_string_t *p_string = p_text->pp_buckets[i];
+        while (p_string)
+        {
+            text_string_t *p_next = p_string->p_next;
+            free(p_string);
+            p_string = p_next;
+        }
+        p_text->pp_buckets[i] = NULL;
+    }
+    p_text->i_strings = 0;
+    p_text->i_bytes = 0;
+}
+
+/*****************************************************************************
+ * dvbpsi_text_stats
+ *****************************************************************************/
+void dvbpsi_text_stats(const dvbpsi_text_t *p_text, dvbpsi_text_stats_t *p_stats)
+{
+    assert(p_text);
+    assert(p_stats);
+
+    p_stats->i_lookups = p_text->i_lookups;
+    p_stats->i_hits = p_text->i_hits;
+    p_stats->i_strings = p_text->i_strings;
+    p_stats->i_bytes = p_text->i_bytes;
+}
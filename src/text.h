@@ -0,0 +1,238 @@
+/*****************************************************************************
+ * text.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <text.h>
+ * \brief DVB strings and ATSC multiple string structures to UTF-8.
+ *
+ * DVB strings (ETSI EN 300 468 annex A) of the ISO/IEC 6937 default table,
+ * ISO/IEC 8859 parts 1 to 16, ISO/IEC 10646 BMP and UTF-8 are supported;
+ * the Korean, Chinese and encoding_type_id ones are not. Emphasis control
+ * codes are dropped and CR/LF becomes a line feed.
+ *
+ * ATSC multiple string structures (ATSC A/65 section 6.10) are decoded
+ * with their 8 bit modes and UTF-16; the DVB control codes do not apply to
+ * them. The Huffman compressed ones require the decode tree tables of A/65
+ * annex C, which are not shipped with libdvbpsi and are loaded with
+ * dvbpsi_text_atsc_huffman_set().
+ *
+ * A text context also interns the converted strings, so that the same raw
+ * string, repeated by every EIT cycle, is converted once. Contexts are not
+ * thread safe. Include descriptor.h before this header.
+ */
+
+#ifndef _DVBPSI_TEXT_H_
+#define _DVBPSI_TEXT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \def DVBPSI_TEXT_DVB_SIZE(n)
+ * \brief Size of a buffer always large enough for a DVB string of n bytes.
+ */
+#define DVBPSI_TEXT_DVB_SIZE(n)     (3 * (n) + 1)
+
+/*!
+ * \typedef struct dvbpsi_text_s dvbpsi_text_t
+ * \brief Opaque text context.
+ */
+typedef struct dvbpsi_text_s dvbpsi_text_t;
+
+/*!
+ * \struct dvbpsi_text_stats_s
+ * \brief Counters of the interned strings of a text context.
+ */
+/*!
+ * \typedef struct dvbpsi_text_stats_s dvbpsi_text_stats_t
+ * \brief dvbpsi_text_stats_t type definition.
+ */
+typedef struct dvbpsi_text_stats_s
+{
+    uint64_t     i_lookups;         /*!< Strings interned */
+    uint64_t     i_hits;            /*!< Strings already converted */
+    size_t       i_strings;         /*!< Strings held */
+    size_t       i_bytes;           /*!< Memory held by the strings */
+} dvbpsi_text_stats_t;
+
+/*****************************************************************************
+ * dvbpsi_text_dvb_to_utf8
+ *****************************************************************************/
+/*!
+ * \fn ssize_t dvbpsi_text_dvb_to_utf8(const uint8_t *p_text, size_t i_length,
+ *                                     char *psz_utf8, size_t i_size)
+ * \brief Convert a DVB string to UTF-8.
+ * \param p_text string, starting with its character table selection if any
+ * \param i_length length of p_text
+ * \param psz_utf8 receives the NUL terminated UTF-8 string
+ * \param i_size size of psz_utf8, DVBPSI_TEXT_DVB_SIZE(i_length) avoids any
+ * truncation
+ * \return length of psz_utf8, -1 for an unsupported character table.
+ *
+ * A string too long for psz_utf8 is cut between two characters.
+ */
+ssize_t dvbpsi_text_dvb_to_utf8(const uint8_t *p_text, size_t i_length,
+                                char *psz_utf8, size_t i_size);
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_to_utf8
+ *****************************************************************************/
+/*!
+ * \fn ssize_t dvbpsi_text_atsc_to_utf8(const dvbpsi_text_t *p_text,
+ *                                      const uint8_t *p_mss, size_t i_length,
+ *                                      const uint8_t *p_language,
+ *                                      char *psz_utf8, size_t i_size)
+ * \brief Convert a string of an ATSC multiple string structure to UTF-8.
+ * \param p_text context holding the Huffman tables, may be NULL
+ * \param p_mss multiple string structure
+ * \param i_length length of p_mss
+ * \param p_language ISO 639 code of the string, NULL or not found for the
+ * first one
+ * \param psz_utf8 receives the NUL terminated UTF-8 string
+ * \param i_size size of psz_utf8
+ * \return length of psz_utf8, -1 if a segment of the string is compressed
+ * or encoded in an unsupported way, the others being converted.
+ *
+ * A string too long for psz_utf8 is cut between two characters.
+ */
+ssize_t dvbpsi_text_atsc_to_utf8(const dvbpsi_text_t *p_text,
+                                 const uint8_t *p_mss, size_t i_length,
+                                 const uint8_t *p_language,
+                                 char *psz_utf8, size_t i_size);
+
+/*****************************************************************************
+ * dvbpsi_text_new
+ *****************************************************************************/
+/*!
+ * \fn dvbpsi_text_t *dvbpsi_text_new(void)
+ * \brief Create a text context.
+ * \return pointer to the context, NULL on allocation failure.
+ */
+dvbpsi_text_t *dvbpsi_text_new(void);
+
+/*****************************************************************************
+ * dvbpsi_text_delete
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_text_delete(dvbpsi_text_t *p_text)
+ * \brief Delete a text context and its interned strings.
+ * \param p_text context to delete
+ * \return nothing
+ */
+void dvbpsi_text_delete(dvbpsi_text_t *p_text);
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_huffman_set
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_text_atsc_huffman_set(dvbpsi_text_t *p_text,
+ *                                       uint8_t i_compression_type,
+ *                                       const uint8_t *p_table, size_t i_size)
+ * \brief Load the Huffman tables of a compression_type.
+ * \param p_text context
+ * \param i_compression_type 0x01 for program titles, 0x02 for program
+ * descriptions
+ * \param p_table ATSC A/65 tables C.4 then C.5 for titles, C.6 then C.7 for
+ * descriptions: 128 decode tree byte offsets of 16 bits, big endian,
+ * followed by the decode trees
+ * \param i_size size of p_table
+ * \return false for an invalid table or on allocation failure.
+ */
+bool dvbpsi_text_atsc_huffman_set(dvbpsi_text_t *p_text, uint8_t i_compression_type,
+                                  const uint8_t *p_table, size_t i_size);
+
+/*****************************************************************************
+ * dvbpsi_text_dvb_intern
+ *****************************************************************************/
+/*!
+ * \fn const char *dvbpsi_text_dvb_intern(dvbpsi_text_t *p_text,
+ *                                        const uint8_t *p_string,
+ *                                        size_t i_length)
+ * \brief Convert a DVB string to UTF-8 once for all.
+ * \param p_text context
+ * \param p_string string, starting with its character table selection if any
+ * \param i_length length of p_string
+ * \return the UTF-8 string, NULL for an unsupported character table or on
+ * allocation failure.
+ *
+ * The same raw string always gives the same pointer, valid until
+ * dvbpsi_text_flush() or dvbpsi_text_delete().
+ */
+const char *dvbpsi_text_dvb_intern(dvbpsi_text_t *p_text,
+                                   const uint8_t *p_string, size_t i_length);
+
+/*****************************************************************************
+ * dvbpsi_text_atsc_intern
+ *****************************************************************************/
+/*!
+ * \fn const char *dvbpsi_text_atsc_intern(dvbpsi_text_t *p_text,
+ *                                         const uint8_t *p_mss, size_t i_length,
+ *                                         const uint8_t *p_language)
+ * \brief Convert a string of an ATSC multiple string structure once for all.
+ * \param p_text context
+ * \param p_mss multiple string structure
+ * \param i_length length of p_mss
+ * \param p_language ISO 639 code of the string, NULL or not found for the
+ * first one
+ * \return the UTF-8 string, NULL if it cannot be fully decoded or on
+ * allocation failure.
+ *
+ * The same pointer lifetime as dvbpsi_text_dvb_intern() applies.
+ */
+const char *dvbpsi_text_atsc_intern(dvbpsi_text_t *p_text,
+                                    const uint8_t *p_mss, size_t i_length,
+                                    const uint8_t *p_language);
+
+/*****************************************************************************
+ * dvbpsi_text_flush
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_text_flush(dvbpsi_text_t *p_text)
+ * \brief Free the interned strings, invalidating the pointers to them.
+ * \param p_text context
+ * \return nothing
+ */
+void dvbpsi_text_flush(dvbpsi_text_t *p_text);
+
+/*****************************************************************************
+ * dvbpsi_text_stats
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_text_stats(const dvbpsi_text_t *p_text,
+ *                            dvbpsi_text_stats_t *p_stats)
+ * \brief Get the counters of the interned strings, to decide when to flush.
+ * \param p_text context
+ * \param p_stats receives the counters
+ * \return nothing
+ */
+void dvbpsi_text_stats(const dvbpsi_text_t *p_text, dvbpsi_text_stats_t *p_stats);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of text.h"
+#endif
@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * trace.c: latency histograms of the dvbpsi_packet_push() stages
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#include "dvbpsi.h"
+#include "trace.h"
+
+static const char *const ppsz_stage_names[DVBPSI_TRACE_STAGES] =
+{
+    "reassembly", "crc", "gather", "decode", "callback"
+};
+
+static uint64_t trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static unsigned int trace_bucket(uint64_t i_ns)
+{
+    unsigned int i_bucket = 0;
+    while ((i_ns >>= 1) && (i_bucket < DVBPSI_TRACE_BUCKETS - 1))
+        i_bucket++;
+    return i_bucket;
+}
+
+static void trace_account(dvbpsi_trace_histogram_t *p_histogram,
+                          const dvbpsi_trace_stage_t i_stage, const uint64_t i_ns)
+{
+    p_histogram->ai_count[i_stage][trace_bucket(i_ns)]++;
+    p_histogram->ai_total_ns[i_stage] += i_ns;
+    if (i_ns > p_histogram->ai_max_ns[i_stage])
+        p_histogram->ai_max_ns[i_stage] = i_ns;
+}
+
+/*****************************************************************************
+ * Hooks: a stage that ends without having begun, like a section whose first
+ * packet was pushed before the hooks were set, is not counted
+ *****************************************************************************/
+static void trace_begin(void *p_cb_data, const dvbpsi_trace_event_t *p_event)
+{
+    dvbpsi_trace_histogram_t *p_histogram = (dvbpsi_trace_histogram_t *)p_cb_data;
+
+    if (p_event->i_stage == DVBPSI_TRACE_REASSEMBLY)
+        p_histogram->ai_reassembly_ns[p_event->i_pid & 0x1fff] = trace_now();
+    else
+        p_histogram->ai_begin_ns[p_event->i_stage] = trace_now();
+}
+
+static void trace_end(void *p_cb_data, const dvbpsi_trace_event_t *p_event)
+{
+    dvbpsi_trace_histogram_t *p_histogram = (dvbpsi_trace_histogram_t *)p_cb_data;
+    uint64_t *p_begin;
+
+    if (p_event->i_stage == DVBPSI_TRACE_REASSEMBLY)
+        p_begin = &p_histogram->ai_reassembly_ns[p_event->i_pid & 0x1fff];
+    else
+        p_begin = &p_histogram->ai_begin_ns[p_event->i_stage];
+    if (*p_begin == 0)
+        return;
+
+    trace_account(p_histogram, p_event->i_stage, trace_now() - *p_begin);
+    *p_begin = 0;
+}
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_init
+ *****************************************************************************/
+void dvbpsi_trace_histogram_init(dvbpsi_trace_histogram_t *p_histogram,
+                                 dvbpsi_trace_t *p_trace)
+{
+    assert(p_histogram);
+    assert(p_trace);
+
+    memset(p_histogram, 0, sizeof(dvbpsi_trace_histogram_t));
+    p_trace->pf_begin = trace_begin;
+    p_trace->pf_end = trace_end;
+    p_trace->p_cb_data = p_histogram;
+}
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_percentile
+ *****************************************************************************/
+uint64_t dvbpsi_trace_histogram_percentile(const dvbpsi_trace_histogram_t *p_histogram,
+                                           const dvbpsi_trace_stage_t i_stage,
+                                           const unsigned int i_percent)
+{
+    assert(i_stage < DVBPSI_TRACE_STAGES);
+
+    const uint64_t *pi_count = p_histogram->ai_count[i_stage];
+    uint64_t i_total = 0;
+    for (unsigned int b = 0; b < DVBPSI_TRACE_BUCKETS; b++)
+        i_total += pi_count[b];
+    if (i_total == 0)
+        return 0;
+
+    /* Rank of the percentile, rounded up so that 100 is the last sample */
+    const uint64_t i_rank = (i_total * (i_percent > 100 ? 100 : i_percent) + 99) / 100;
+    uint64_t i_seen = 0;
+    for (unsigned int b = 0; b < DVBPSI_TRACE_BUCKETS - 1; b++)
+    {
+        i_seen += pi_count[b];
+        if (i_seen >= i_rank && i_seen > 0)
+            return UINT64_C(2) << b;
+    }
+    return p_histogram->ai_max_ns[i_stage];
+}
+
+/*****************************************************************************
+ * dvbpsi_trace_stage_name
+ *****************************************************************************/
+const char *dvbpsi_trace_stage_name(const dvbpsi_trace_stage_t i_stage)
+{
+    if (i_stage >= DVBPSI_TRACE_STAGES)
+        return "unknown";
+    return ppsz_stage_names[i_stage];
+}
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_dump
+ *****************************************************************************/
+void dvbpsi_trace_histogram_dump(const dvbpsi_trace_histogram_t *p_histogram,
+                                 FILE *p_file)
+{
+    fprintf(p_file, "%-10s %12s %12s %12s %12s %12s\n",
+            "stage", "count", "mean ns", "p50 ns", "p99 ns", "max ns");
+    for (int s = 0; s < DVBPSI_TRACE_STAGES; s++)
+    {
+        uint64_t i_count = 0;
+        for (unsigned int b = 0; b < DVBPSI_TRACE_BUCKETS; b++)
+            i_count += p_histogram->ai_count[s][b];
+
+        fprintf(p_file, "%-10s %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64"\n",
+                ppsz_stage_names[s], i_count,
+                i_count ? p_histogram->ai_total_ns[s] / i_count : 0,
+                dvbpsi_trace_histogram_percentile(p_histogram, s, 50),
+                dvbpsi_trace_histogram_percentile(p_histogram, s, 99),
+                p_histogram->ai_max_ns[s]);
+    }
+
+    for (int s = 0; s < DVBPSI_TRACE_STAGES; s++)
+    {
+        for (unsigned int b = 0; b < DVBPSI_TRACE_BUCKETS; b++)
+        {
+            if (p_histogram->ai_count[s][b] == 0)
+                continue;
+            if (b == DVBPSI_TRACE_BUCKETS - 1)
+                fprintf(p_file, "%-10s [%12"PRIu64",          ...) ns %12"PRIu64"\n",
+                        ppsz_stage_names[s], UINT64_C(1) << b, p_histogram->ai_count[s][b]);
+            else
+                fprintf(p_file, "%-10s [%12"PRIu64", %12"PRIu64") ns %12"PRIu64"\n",
+                        ppsz_stage_names[s], b ? UINT64_C(1) << b : 0,
+                        UINT64_C(2) << b, p_histogram->ai_count[s][b]);
+        }
+    }
+}
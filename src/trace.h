@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * trace.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <trace.h>
+ * \brief Latency histograms of the dvbpsi_packet_push() stages.
+ *
+ * A ready made pair of dvbpsi_trace_t hooks that time each stage with the
+ * monotonic clock and count the durations in power of two buckets.
+ */
+
+#ifndef _DVBPSI_TRACE_H_
+#define _DVBPSI_TRACE_H_
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \def DVBPSI_TRACE_BUCKETS
+ * \brief Number of histogram buckets, bucket b counts durations in
+ * [2^b, 2^(b+1)) ns, the first one also 0 ns and the last one everything
+ * longer.
+ */
+#define DVBPSI_TRACE_BUCKETS 32
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_t
+ *****************************************************************************/
+/*!
+ * \struct dvbpsi_trace_histogram_s
+ * \brief Duration histogram of each dvbpsi_trace_stage_t.
+ *
+ * Not thread safe: give each pushing thread its own histogram. One
+ * histogram may serve several handles pushed from the same thread, section
+ * reassembly is timed per PID.
+ */
+/*!
+ * \typedef struct dvbpsi_trace_histogram_s dvbpsi_trace_histogram_t
+ * \brief dvbpsi_trace_histogram_t type definition.
+ */
+typedef struct dvbpsi_trace_histogram_s
+{
+    uint64_t ai_count[DVBPSI_TRACE_STAGES][DVBPSI_TRACE_BUCKETS]; /*!< Durations per bucket */
+    uint64_t ai_total_ns[DVBPSI_TRACE_STAGES];  /*!< Sum of the durations */
+    uint64_t ai_max_ns[DVBPSI_TRACE_STAGES];    /*!< Longest duration */
+
+    uint64_t ai_begin_ns[DVBPSI_TRACE_STAGES];  /*!< Start of the running stages, private */
+    uint64_t ai_reassembly_ns[0x2000];          /*!< Start of the section of each PID, private */
+} dvbpsi_trace_histogram_t;
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_init
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_trace_histogram_init(dvbpsi_trace_histogram_t *p_histogram,
+ *                                      dvbpsi_trace_t *p_trace)
+ * \brief Clear a histogram and fill the hooks that feed it.
+ * \param p_histogram histogram to clear
+ * \param p_trace receives the hooks to give to dvbpsi_trace_set()
+ * \return nothing
+ */
+void dvbpsi_trace_histogram_init(dvbpsi_trace_histogram_t *p_histogram,
+                                 dvbpsi_trace_t *p_trace);
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_percentile
+ *****************************************************************************/
+/*!
+ * \fn uint64_t dvbpsi_trace_histogram_percentile(const dvbpsi_trace_histogram_t *p_histogram,
+ *                                                const dvbpsi_trace_stage_t i_stage,
+ *                                                const unsigned int i_percent)
+ * \brief Upper bound of the bucket holding a percentile of a stage.
+ * \param p_histogram histogram to read
+ * \param i_stage stage to read
+ * \param i_percent percentile, 0 to 100
+ * \return duration in ns, 0 when the stage was never timed.
+ */
+uint64_t dvbpsi_trace_histogram_percentile(const dvbpsi_trace_histogram_t *p_histogram,
+                                           const dvbpsi_trace_stage_t i_stage,
+                                           const unsigned int i_percent);
+
+/*****************************************************************************
+ * dvbpsi_trace_stage_name
+ *****************************************************************************/
+/*!
+ * \fn const char *dvbpsi_trace_stage_name(const dvbpsi_trace_stage_t i_stage)
+ * \brief Lower case name of a stage, "reassembly", "crc", ...
+ * \param i_stage stage
+ * \return static string, "unknown" for an invalid stage.
+ */
+const char *dvbpsi_trace_stage_name(const dvbpsi_trace_stage_t i_stage);
+
+/*****************************************************************************
+ * dvbpsi_trace_histogram_dump
+ *****************************************************************************/
+/*!
+ * \fn void dvbpsi_trace_histogram_dump(const dvbpsi_trace_histogram_t *p_histogram,
+ *                                      FILE *p_file)
+ * \brief Print count, mean, max and percentiles of each stage, followed by
+ * the non empty buckets.
+ * \param p_histogram histogram to print
+ * \param p_file output stream
+ * \return nothing
+ */
+void dvbpsi_trace_histogram_dump(const dvbpsi_trace_histogram_t *p_histogram,
+                                 FILE *p_file);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of trace.h"
+#endif
@@ -0,0 +1,375 @@
+/*****************************************************************************
+ * ts.c: MPEG transport stream packet helpers
+ *----------------------------------------------------------------------------
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *----------------------------------------------------------------------------
+ *
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(HAVE_INTTYPES_H)
+#include <inttypes.h>
+#elif defined(HAVE_STDINT_H)
+#include <stdint.h>
+#endif
+
+#include <assert.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "dvbpsi.h"
+#include "ts.h"
+
+#define TS_SYNC_BYTE 0x47
+
+static const unsigned int ai_ts_strides[] = { 188, 192, 204 };
+#define TS_MAX_STRIDE 204
+
+/*****************************************************************************
+ * ts_sync_mask
+ *****************************************************************************
+ * Test TS_SYNC_BLOCK consecutive candidate offsets at once: bit
+ * (i * TS_SYNC_BITS) of the result is set when p[i + k * i_stride] is a
+ * sync byte for every k < i_hits. Reads TS_SYNC_BLOCK bytes at each lattice
+ * point.
+ *****************************************************************************/
+#if defined(__AVX2__)
+#   define TS_SYNC_BLOCK 32
+#   define TS_SYNC_BITS  1
+static inline uint64_t ts_sync_mask(const uint8_t *p, const unsigned int i_stride,
+                                    const unsigned int i_hits)
+{
+    const __m256i sync = _mm256_set1_epi8(TS_SYNC_BYTE);
+    __m256i hits = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), sync);
+    for (unsigned int k = 1; k < i_hits; k++)
+    {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(p + k * i_stride));
+        hits = _mm256_and_si256(hits, _mm256_cmpeq_epi8(v, sync));
+    }
+    return (uint32_t)_mm256_movemask_epi8(hits);
+}
+#elif defined(__SSE2__)
+#   define TS_SYNC_BLOCK 16
+#   define TS_SYNC_BITS  1
+static inline uint64_t ts_sync_mask(const uint8_t *p, const unsigned int i_stride,
+                                    const unsigned int i_hits)
+{
+    const __m128i sync = _mm_set1_epi8(TS_SYNC_BYTE);
+    __m128i hits = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), sync);
+    for (unsigned int k = 1; k < i_hits; k++)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(p + k * i_stride));
+        hits = _mm_and_si128(hits, _mm_cmpeq_epi8(v, sync));
+    }
+    return (uint16_t)_mm_movemask_epi8(hits);
+}
+#elif defined(__ARM_NEON)
+#   define TS_SYNC_BLOCK 16
+#   define TS_SYNC_BITS  4
+static inline uint64_t ts_sync_mask(const uint8_t *p, const unsigned int i_stride,
+                                    const unsigned int i_hits)
+{
+    const uint8x16_t sync = vdupq_n_u8(TS_SYNC_BYTE);
+    uint8x16_t hits = vceqq_u8(vld1q_u8(p), sync);
+    for (unsigned int k = 1; k < i_hits; k++)
+        hits = vandq_u8(hits, vceqq_u8(vld1q_u8(p + k * i_stride), sync));
+    /* Narrow each byte to a nibble, NEON has no movemask */
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(hits), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+}
+#else
+#   define TS_SYNC_BLOCK 8
+#   define TS_SYNC_BITS  1
+static inline uint64_t ts_sync_mask(const uint8_t *p, const unsigned int i_stride,
+                                    const unsigned int i_hits)
+{
+    uint64_t i_mask = 0;
+    for (unsigned int i = 0; i < TS_SYNC_BLOCK; i++)
+    {
+        unsigned int k = 0;
+        while ((k < i_hits) && (p[i + k * i_stride] == TS_SYNC_BYTE))
+            k++;
+        if (k == i_hits)
+            i_mask |= UINT64_C(1) << i;
+    }
+    return i_mask;
+}
+#endif
+
+#if defined(__GNUC__)
+#   define ts_ctz64(x) __builtin_ctzll(x)
+#else
+static inline int ts_ctz64(uint64_t x)
+{
+    int i_ctz = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        i_ctz++;
+    }
+    return i_ctz;
+}
+#endif
+
+/*****************************************************************************
+ * ts_sync_lattice
+ *****************************************************************************
+ * Scalar check of i_hits sync bytes at i_stride.
+ *****************************************************************************/
+static inline bool ts_sync_lattice(const uint8_t *p, const unsigned int i_stride,
+                                   const unsigned int i_hits)
+{
+    for (unsigned int k = 0; k < i_hits; k++)
+    {
+        if (p[k * i_stride] != TS_SYNC_BYTE)
+            return false;
+    }
+    return true;
+}
+
+static inline void ts_sync_found(dvbpsi_ts_sync_t *p_sync, const size_t i_offset,
+                                 const unsigned int i_stride)
+{
+    p_sync->i_offset = i_offset;
+    p_sync->i_stride = i_stride;
+    /* The M2TS timestamp in front of the sync byte belongs to the packet */
+    if (i_stride == 192)
+        p_sync->i_lost = (i_offset >= 4) ? i_offset - 4 : 0;
+    else
+        p_sync->i_lost = i_offset;
+}
+
+/*****************************************************************************
+ * dvbpsi_ts_sync
+ *****************************************************************************/
+bool dvbpsi_ts_sync(const uint8_t *p_buf, const size_t i_length,
+                    const unsigned int i_hits, dvbpsi_ts_sync_t *p_sync)
+{
+    assert(p_buf);
+    assert(p_sync);
+
+    const unsigned int i_n = (i_hits > 0) ? i_hits : 1;
+    const size_t i_max_span = (size_t)(i_n - 1) * TS_MAX_STRIDE;
+    size_t i_pos = 0;
+
+    /* Blocks for which every stride fits in the buffer */
+    while (i_pos + i_max_span + TS_SYNC_BLOCK <= i_length)
+    {
+        const uint8_t *p = p_buf + i_pos;
+        unsigned int i_stride = 0;
+        int i_first = TS_SYNC_BLOCK;
+
+        for (unsigned int s = 0; s < sizeof(ai_ts_strides) / sizeof(ai_ts_strides[0]); s++)
+        {
+            uint64_t i_mask = ts_sync_mask(p, ai_ts_strides[s], i_n);
+            if (i_mask == 0)
+                continue;
+            int i_bit = ts_ctz64(i_mask) / TS_SYNC_BITS;
+            if (i_bit < i_first)
+            {
+                i_first = i_bit;
+                i_stride = ai_ts_strides[s];
+            }
+        }
+        if (i_stride)
+        {
+            ts_sync_found(p_sync, i_pos + i_first, i_stride);
+            return true;
+        }
+        i_pos += TS_SYNC_BLOCK;
+    }
+
+    /* Tail, one offset at a time for the strides that still fit */
+    for (; i_pos < i_length; i_pos++)
+    {
+        if (p_buf[i_pos] != TS_SYNC_BYTE)
+            continue;
+        for (unsigned int s = 0; s < sizeof(ai_ts_strides) / sizeof(ai_ts_strides[0]); s++)
+        {
+            if (i_pos + (size_t)(i_n - 1) * ai_ts_strides[s] >= i_length)
+                break;
+            if (ts_sync_lattice(p_buf + i_pos, ai_ts_strides[s], i_n))
+            {
+                ts_sync_found(p_sync, i_pos, ai_ts_strides[s]);
+                return true;
+            }
+        }
+    }
+
+    /* Offsets from which the longest lattice does not fit are undecided */
+    p_sync->i_offset = (i_length > i_max_span) ? i_length - i_max_span : 0;
+    p_sync->i_stride = 0;
+    p_sync->i_lost = p_sync->i_offset;
+    return false;
+}
+
+/*****************************************************************************
+ * ts_header_adaptation
+ *****************************************************************************
+ * Adaptation field part of the flags and the payload offset, once the
+ * other fields of packet n are set.
+ *****************************************************************************/
+static inline void ts_header_adaptation(const uint8_t *p, const size_t n,
+                                        dvbpsi_ts_headers_t *p_headers)
+{
+    uint8_t i_flags = p_headers->pi_flags[n];
+    unsigned int i_payload = 4;
+
+    if (p[3] & 0x20)
+    {
+        i_flags |= DVBPSI_TS_ADAPTATION;
+        i_payload = 5 + p[4];
+        if ((p[4] > 0) && (p[4] <= 183) && (p[5] & 0x80))
+            i_flags |= DVBPSI_TS_DISCONTINUITY;
+    }
+    if (!(i_flags & DVBPSI_TS_PAYLOAD) || (i_payload >= DVBPSI_TS_PACKET_SIZE))
+    {
+        /* no payload, no room left, or a broken adaptation_field_length */
+        i_flags &= ~DVBPSI_TS_PAYLOAD;
+        i_payload = DVBPSI_TS_PACKET_SIZE;
+    }
+    p_headers->pi_flags[n] = i_flags;
+    p_headers->pi_payload[n] = i_payload;
+}
+
+/*****************************************************************************
+ * ts_header_parse
+ *****************************************************************************
+ * Scalar decoding of the header of packet n, which has a sync byte.
+ *****************************************************************************/
+static inline void ts_header_parse(const uint8_t *p, const size_t n, const uint32_t i_offset,
+                                   dvbpsi_ts_headers_t *p_headers)
+{
+    uint8_t i_flags = p[1] & (DVBPSI_TS_TEI | DVBPSI_TS_PUSI | DVBPSI_TS_PRIORITY);
+    if (p[3] & 0xc0)
+        i_flags |= DVBPSI_TS_SCRAMBLED;
+    if (p[3] & 0x10)
+        i_flags |= DVBPSI_TS_PAYLOAD;
+
+    p_headers->pi_offset[n] = i_offset;
+    p_headers->pi_pid[n] = ((uint16_t)(p[1] & 0x1f) << 8) | p[2];
+    p_headers->pi_cc[n] = p[3] & 0x0f;
+    p_headers->pi_flags[n] = i_flags;
+    ts_header_adaptation(p, n, p_headers);
+}
+
+#if defined(__SSE2__)
+/*****************************************************************************
+ * ts_headers_parse4
+ *****************************************************************************
+ * Four packets whose first 4 bytes are in w[], all with a sync byte: PID,
+ * continuity counter and the flags of byte 1 and 3 are computed lane by
+ * lane and narrowed into the arrays.
+ *****************************************************************************/
+static inline void ts_headers_parse4(const uint32_t *w, const size_t n,
+                                     dvbpsi_ts_headers_t *p_headers)
+{
+    /* bytes 0..3 of a packet are bits 0..31 of its little endian lane */
+    const __m128i v = _mm_loadu_si128((const __m128i *)w);
+    const __m128i b1 = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xff));
+    const __m128i b3 = _mm_srli_epi32(v, 24);
+
+    __m128i pid = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0x1f00)),
+                               _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0xff)));
+    __m128i cc = _mm_and_si128(b3, _mm_set1_epi32(0x0f));
+
+    /* TEI, PUSI and priority in place, scrambling to 0x10, payload to 0x01 */
+    __m128i flags = _mm_and_si128(b1, _mm_set1_epi32(DVBPSI_TS_TEI | DVBPSI_TS_PUSI |
+                                                     DVBPSI_TS_PRIORITY));
+    __m128i scrambled = _mm_cmpeq_epi32(_mm_and_si128(b3, _mm_set1_epi32(0xc0)),
+                                        _mm_setzero_si128());
+    flags = _mm_or_si128(flags, _mm_andnot_si128(scrambled, _mm_set1_epi32(DVBPSI_TS_SCRAMBLED)));
+    flags = _mm_or_si128(flags, _mm_and_si128(_mm_srli_epi32(b3, 4),
+                                              _mm_set1_epi32(DVBPSI_TS_PAYLOAD)));
+
+    /* values fit in 16 bits, then in 8 for cc and flags */
+    pid = _mm_packs_epi32(pid, pid);
+    cc = _mm_packs_epi32(cc, cc);
+    cc = _mm_packus_epi16(cc, cc);
+    flags = _mm_packs_epi32(flags, flags);
+    flags = _mm_packus_epi16(flags, flags);
+
+    _mm_storel_epi64((__m128i *)&p_headers->pi_pid[n], pid);
+    uint32_t i_ccs = (uint32_t)_mm_cvtsi128_si32(cc);
+    uint32_t i_flags = (uint32_t)_mm_cvtsi128_si32(flags);
+    memcpy(&p_headers->pi_cc[n], &i_ccs, 4);
+    memcpy(&p_headers->pi_flags[n], &i_flags, 4);
+}
+#endif
+
+/*****************************************************************************
+ * dvbpsi_ts_headers_parse
+ *****************************************************************************/
+size_t dvbpsi_ts_headers_parse(const uint8_t *p_buf, const size_t i_length,
+                               const unsigned int i_stride, const size_t i_max,
+                               dvbpsi_ts_headers_t *p_headers)
+{
+    assert(p_buf);
+    assert(p_headers);
+    assert(i_stride >= DVBPSI_TS_PACKET_SIZE);
+
+    /* packets that fit in the buffer */
+    size_t i_packets = (i_length >= DVBPSI_TS_PACKET_SIZE) ?
+                       (i_length - DVBPSI_TS_PACKET_SIZE) / i_stride + 1 : 0;
+    if (i_packets > i_max)
+        i_packets = i_max;
+
+    size_t n = 0;
+#if defined(__SSE2__)
+    while (n + 4 <= i_packets)
+    {
+        uint32_t w[4];
+        for (unsigned int k = 0; k < 4; k++)
+            memcpy(&w[k], &p_buf[(n + k) * i_stride], 4);
+        if (((w[0] & 0xff) != TS_SYNC_BYTE) || ((w[1] & 0xff) != TS_SYNC_BYTE) ||
+            ((w[2] & 0xff) != TS_SYNC_BYTE) || ((w[3] & 0xff) != TS_SYNC_BYTE))
+            break;
+
+        ts_headers_parse4(w, n, p_headers);
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            const uint32_t i_offset = (uint32_t)((n + k) * i_stride);
+            p_headers->pi_offset[n + k] = i_offset;
+            ts_header_adaptation(&p_buf[i_offset], n + k, p_headers);
+        }
+        n += 4;
+    }
+#endif
+    for (; n < i_packets; n++)
+    {
+        const uint8_t *p = &p_buf[n * i_stride];
+        if (p[0] != TS_SYNC_BYTE)
+            break;
+        ts_header_parse(p, n, (uint32_t)(n * i_stride), p_headers);
+    }
+
+    p_headers->i_count = n;
+    return n;
+}
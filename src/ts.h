@@ -0,0 +1,204 @@
+/*****************************************************************************
+ * ts.h
+ *
+ * Copyright (C) 2026 VideoLAN
+ * $Id$
+ *
+ * Authors: Jean-Paul Saman <jpsaman@videolan.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+/*!
+ * \file <ts.h>
+ * \brief MPEG transport stream packet helpers.
+ *
+ * Helpers for applications feeding TS packets to libdvbpsi: locking onto
+ * the packet boundaries of a byte stream and recovering from corruption.
+ */
+
+#ifndef _DVBPSI_TS_H_
+#define _DVBPSI_TS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \def DVBPSI_TS_PACKET_SIZE
+ * \brief Size of a MPEG transport stream packet.
+ */
+#define DVBPSI_TS_PACKET_SIZE 188
+
+/* dvbpsi_t of dvbpsi.h, so that this header does not depend on it */
+struct dvbpsi_s;
+
+/*****************************************************************************
+ * dvbpsi_ts_sync_t
+ *****************************************************************************/
+/*!
+ * \struct dvbpsi_ts_sync_s
+ * \brief Result of a TS packet synchronisation search.
+ *
+ * The stride is 188 for plain TS, 192 for M2TS (a 4 byte timestamp precedes
+ * each packet) and 204 for TS with 16 bytes of Reed-Solomon parity.
+ */
+/*!
+ * \typedef struct dvbpsi_ts_sync_s dvbpsi_ts_sync_t
+ * \brief dvbpsi_ts_sync_t type definition.
+ */
+typedef struct dvbpsi_ts_sync_s
+{
+    size_t       i_offset;  /*!< Offset of the first sync byte of the lattice,
+                                 or of the first byte not ruled out if none */
+    unsigned int i_stride;  /*!< Distance between packets: 188, 192 or 204,
+                                 0 if no lattice was found */
+    size_t       i_lost;    /*!< Bytes before i_offset that belong to no packet */
+} dvbpsi_ts_sync_t;
+
+/*****************************************************************************
+ * dvbpsi_ts_sync
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_ts_sync(const uint8_t *p_buf, const size_t i_length,
+ *                         const unsigned int i_hits, dvbpsi_ts_sync_t *p_sync)
+ * \brief Find the first offset where TS packets are aligned.
+ * \param p_buf buffer to search
+ * \param i_length number of bytes in p_buf
+ * \param i_hits number of consecutive 0x47 sync bytes at the packet stride
+ *        required to lock, at least 1
+ * \param p_sync pointer to the result
+ * \return true if a lattice of i_hits sync bytes was found, false otherwise.
+ *
+ * Strides 188, 192 and 204 are tried at every offset, the lowest offset
+ * wins and 188 is preferred on ties. When nothing is found, bytes before
+ * p_sync->i_offset can be dropped: a lattice can only start at or after it
+ * once more data is appended.
+ *
+ * Uses AVX2, SSE2 or NEON when the library is built for them, testing a
+ * block of 32 or 16 candidate offsets with i_hits vector compares.
+ */
+bool dvbpsi_ts_sync(const uint8_t *p_buf, const size_t i_length,
+                    const unsigned int i_hits, dvbpsi_ts_sync_t *p_sync);
+
+/*****************************************************************************
+ * dvbpsi_ts_headers_t
+ *****************************************************************************/
+/*!
+ * \def DVBPSI_TS_TEI
+ * \brief transport_error_indicator is set.
+ */
+#define DVBPSI_TS_TEI           0x80
+/*!
+ * \def DVBPSI_TS_PUSI
+ * \brief payload_unit_start_indicator is set.
+ */
+#define DVBPSI_TS_PUSI          0x40
+/*!
+ * \def DVBPSI_TS_PRIORITY
+ * \brief transport_priority is set.
+ */
+#define DVBPSI_TS_PRIORITY      0x20
+/*!
+ * \def DVBPSI_TS_SCRAMBLED
+ * \brief transport_scrambling_control is not 00.
+ */
+#define DVBPSI_TS_SCRAMBLED     0x10
+/*!
+ * \def DVBPSI_TS_DISCONTINUITY
+ * \brief discontinuity_indicator of the adaptation field is set.
+ */
+#define DVBPSI_TS_DISCONTINUITY 0x08
+/*!
+ * \def DVBPSI_TS_ADAPTATION
+ * \brief The packet has an adaptation field.
+ */
+#define DVBPSI_TS_ADAPTATION    0x02
+/*!
+ * \def DVBPSI_TS_PAYLOAD
+ * \brief The packet has at least one payload byte.
+ */
+#define DVBPSI_TS_PAYLOAD       0x01
+
+/*!
+ * \struct dvbpsi_ts_headers_s
+ * \brief Headers of a batch of TS packets, one array per field.
+ *
+ * The arrays are owned by the caller and hold room for the number of packets
+ * given to dvbpsi_ts_headers_parse().
+ */
+/*!
+ * \typedef struct dvbpsi_ts_headers_s dvbpsi_ts_headers_t
+ * \brief dvbpsi_ts_headers_t type definition.
+ */
+typedef struct dvbpsi_ts_headers_s
+{
+    size_t    i_count;      /*!< Number of packets parsed */
+    uint32_t *pi_offset;    /*!< Offset of each packet in the parsed buffer */
+    uint16_t *pi_pid;       /*!< PID */
+    uint8_t  *pi_flags;     /*!< DVBPSI_TS_* flags */
+    uint8_t  *pi_cc;        /*!< continuity_counter */
+    uint8_t  *pi_payload;   /*!< Offset of the payload in the packet,
+                                 DVBPSI_TS_PACKET_SIZE if there is none */
+} dvbpsi_ts_headers_t;
+
+/*****************************************************************************
+ * dvbpsi_ts_headers_parse
+ *****************************************************************************/
+/*!
+ * \fn size_t dvbpsi_ts_headers_parse(const uint8_t *p_buf, const size_t i_length,
+ *                                    const unsigned int i_stride, const size_t i_max,
+ *                                    dvbpsi_ts_headers_t *p_headers)
+ * \brief Decode the headers of consecutive TS packets.
+ * \param p_buf first packet, at its sync byte
+ * \param i_length number of bytes in p_buf
+ * \param i_stride distance between packets: 188, 192 or 204
+ * \param i_max room in the arrays of p_headers
+ * \param p_headers pointer to the arrays to fill
+ * \return number of packets decoded, also stored in p_headers->i_count.
+ *
+ * Stops at i_max packets, at the end of the buffer or at the first packet
+ * that does not start with a sync byte. Uses SSE2 for four packets at a time
+ * when the library is built for it.
+ */
+size_t dvbpsi_ts_headers_parse(const uint8_t *p_buf, const size_t i_length,
+                               const unsigned int i_stride, const size_t i_max,
+                               dvbpsi_ts_headers_t *p_headers);
+
+/*****************************************************************************
+ * dvbpsi_ts_packet_push
+ *****************************************************************************/
+/*!
+ * \fn bool dvbpsi_ts_packet_push(struct dvbpsi_s *p_dvbpsi, const uint8_t *p_buf,
+ *                                const dvbpsi_ts_headers_t *p_headers,
+ *                                const size_t i_packet)
+ * \brief dvbpsi_packet_push() of a packet whose header was already decoded.
+ * \param p_dvbpsi handle to dvbpsi with attached decoder
+ * \param p_buf buffer given to dvbpsi_ts_headers_parse()
+ * \param p_headers its result
+ * \param i_packet index of the packet in p_headers
+ * \return true when the packet was handled, false otherwise
+ */
+bool dvbpsi_ts_packet_push(struct dvbpsi_s *p_dvbpsi, const uint8_t *p_buf,
+                           const dvbpsi_ts_headers_t *p_headers, const size_t i_packet);
+
+#ifdef __cplusplus
+};
+#endif
+
+#else
+#error "Multiple inclusions of ts.h"
+#endif